@@ -211,8 +211,8 @@ public:
   /// Stop this run
   void Stop();
 
-  /// Print some run statics to cout
-  void DumpRunStatistics(double CPUTime = 0.0);
+  /// Print some run statics to cout, NSteps is the number of simulation steps of the run
+  void DumpRunStatistics(double CPUTime = 0.0, unsigned long long NSteps = 0);
 
   /// ID for number of triggers stop condition
   static const int c_StopByTriggers;
@@ -32,8 +32,16 @@
 
 // Standard lib:
 #include <vector>
+#include <unordered_map>
 using namespace std;
 
+// Forward declarations:
+class G4VProcess;
+class G4ParticleDefinition;
+class G4VPhysicalVolume;
+class G4VTouchable;
+class G4Region;
+
 /******************************************************************************/
 
 class MCSteppingAction : public G4UserSteppingAction
@@ -51,6 +59,11 @@ public:
   /// Prepare for the nect event
   void PrepareForNextEvent() { m_PreventLastDecayBug = ""; }
 
+  /// Return the number of steps since the last reset
+  unsigned long long GetNSteps() const { return m_NSteps; }
+  /// Reset the number of steps, e.g. at the start of a run
+  void ResetNSteps() { m_NSteps = 0; }
+
   /// Set the number of initial particles
   void SetInitialParticles(vector<int> InitialParticles) { m_InitialParticles = InitialParticles; m_InteractionId = m_InitialParticles.size(); }
 
@@ -93,8 +106,14 @@ public:
 protected:
   /// Return the ID of the detector, we are currently in
   int GetDetectorId(const G4StepPoint* StepPoint);
-  /// Return the Process ID
+  /// Return the process ID of a process - cached by process
+  int GetProcessId(const G4VProcess* Process);
+  /// Return the process ID from the process name
   int GetProcessId(const G4String& Name);
+  /// Return the MEGAlib internal particle type - cached by particle definition
+  int GetCachedParticleType(G4ParticleDefinition* Definition);
+  /// Determine in which watched volumes and black absorbers the touchable is located
+  void ClassifyTouchable(const G4VTouchable* Touchable, vector<bool>& InWatchedVolume, vector<bool>& InBlackAbsorber);
 
   // protected members:
 protected:
@@ -146,15 +165,38 @@ private:
   vector<G4String> m_KnownProcess;
   /// Process IDs of all known process names
   vector<int> m_KnownProcessID;
-  /// Usage frequency of all known process names
-  vector<unsigned long long> m_KnownProcessFrequency;
-  /// A global process counter
-  unsigned long long m_KnownProcessCounter;
-  /// A global process update counter
-  unsigned long long m_KnownProcessUpdateCounter;
   
   /// List of the available regions
   vector<MCRegion> m_Regions;
+
+  /// The watched volumes and black absorbers a physical volume belongs to
+  struct MCVolumeClassification {
+    /// Indices into m_WatchedVolumes
+    vector<unsigned int> m_WatchedVolumes;
+    /// Indices into m_BlackAbsorbers
+    vector<unsigned int> m_BlackAbsorbers;
+  };
+
+  /// Cache: process --> process ID, filled when a process is seen for the first time
+  unordered_map<const G4VProcess*, int> m_ProcessIdCache;
+  /// Cache: particle definition --> MEGAlib particle type
+  unordered_map<const G4ParticleDefinition*, int> m_ParticleTypeCache;
+  /// Cache: physical volume --> watched volumes and black absorbers with this name
+  unordered_map<const G4VPhysicalVolume*, MCVolumeClassification> m_VolumeCache;
+  /// Cache: region --> true if all secondaries are cut in this region
+  unordered_map<const G4Region*, bool> m_RegionCutAllSecondariesCache;
+
+  /// The pre-step point is in the watched volume with this index
+  vector<bool> m_PreInWatchedVolume;
+  /// The post-step point is in the watched volume with this index
+  vector<bool> m_PostInWatchedVolume;
+  /// The pre-step point is in the black absorber with this index
+  vector<bool> m_PreInBlackAbsorber;
+  /// The post-step point is in the black absorber with this index
+  vector<bool> m_PostInBlackAbsorber;
+
+  /// The number of steps since the last reset
+  unsigned long long m_NSteps;
   
 };
 
@@ -151,6 +151,8 @@ bool MCEventAction::NextRun()
     }
     m_OutFileName = FileName.str().c_str();
 
+    // Formatting stays in the simulation thread, writing and compressing goes into the background
+    m_OutFile.SetBackgroundWriting(true);
     m_OutFile.Open(m_OutFileName, MFile::c_Write, m_StoreBinary);
 
     if (m_OutFile.IsOpen() == false) {
@@ -493,7 +493,7 @@ void MCRun::Stop()
 /******************************************************************************
  * Dump a Run statistics
  */
-void MCRun::DumpRunStatistics(double CPUTime)
+void MCRun::DumpRunStatistics(double CPUTime, unsigned long long NSteps)
 {
   // Use cout to make sure it is also dumped in "-v 0" mode
 
@@ -522,6 +522,12 @@ void MCRun::DumpRunStatistics(double CPUTime)
   } else {
     cout<<"Time spent per event:                    "<<0<<" sec"<<endl;
   }
+  if (NSteps > 0) {
+    cout<<"Number of simulation steps:              "<<NSteps<<endl;
+    if (CPUTime > 0) {
+      cout<<"Simulation steps per second:             "<<NSteps/CPUTime<<endl;
+    }
+  }
   cout<<endl;
   cout<<"Observation time:                        "<<m_SimulatedTime/s<<" sec"<<endl;
   cout<<endl;
@@ -115,6 +115,8 @@ void MCRunManager::StartBeam()
     // This takes care of the initilizations
     G4RunManager::BeamOn(0);
 
+    GetSteppingAction()->ResetNSteps();
+    
     MTimer RunTimer;
     RunTimer.Start();
 
@@ -133,7 +135,7 @@ void MCRunManager::StartBeam()
     }
     RunTimer.Pause();
 
-    m_RunParameters.GetCurrentRun().DumpRunStatistics(RunTimer.GetElapsed());
+    m_RunParameters.GetCurrentRun().DumpRunStatistics(RunTimer.GetElapsed(), GetSteppingAction()->GetNSteps());
     m_RunParameters.GetCurrentRun().SaveIsotopeStore();
 
     if (m_RunParameters.GetCurrentRun().CheckStopConditions() == false) {
@@ -33,6 +33,10 @@
 #include "G4StepPoint.hh"
 #include "G4TrackStatus.hh"
 #include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VTouchable.hh"
+#include "G4VProcess.hh"
+#include "G4Region.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
 #include "G4EventManager.hh"
@@ -81,7 +85,7 @@ const int MCSteppingAction::c_ProcessIDTransportation         = 14;
 MCSteppingAction::MCSteppingAction(MCParameterFile& RunParameters) : 
   G4UserSteppingAction(), m_InteractionId(0), m_TrackId(0), 
   m_NSecondaries(0), m_DecayMode(MCParameterFile::c_DecayModeIgnore), 
-  m_ParticleOriginIsBuildUpSource(false)
+  m_ParticleOriginIsBuildUpSource(false), m_NSteps(0)
 {
   // Retrieve some additonal data from the parameter file
 
@@ -101,6 +105,11 @@ MCSteppingAction::MCSteppingAction(MCParameterFile& RunParameters) :
 
   m_BlackAbsorbers = RunParameters.GetBlackAbsorbers();
 
+  m_PreInWatchedVolume.resize(m_WatchedVolumes.size(), false);
+  m_PostInWatchedVolume.resize(m_WatchedVolumes.size(), false);
+  m_PreInBlackAbsorber.resize(m_BlackAbsorbers.size(), false);
+  m_PostInBlackAbsorber.resize(m_BlackAbsorbers.size(), false);
+
   m_DecayMode = RunParameters.GetDecayMode();
 
   m_DetectorTimeConstant = RunParameters.GetDetectorTimeConstant();
@@ -208,13 +217,6 @@ MCSteppingAction::MCSteppingAction(MCParameterFile& RunParameters) :
 
   m_KnownProcess.push_back("Transportation"); m_KnownProcessID.push_back(c_ProcessIDTransportation);
 
-  // To lower all processes:
-  for (unsigned int i = 0; i < m_KnownProcess.size(); ++i) m_KnownProcessFrequency.push_back(0);  
-  
-  for (unsigned int i = 0; i < m_KnownProcess.size(); ++i) m_KnownProcessFrequency.push_back(0);
-  m_KnownProcessCounter = 0;
-  m_KnownProcessUpdateCounter = 1000;
-  
   m_PreventEventStuckBugCounter = 0;
 }
 
@@ -239,6 +241,8 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
 
   massert(Track->GetUserInformation() != 0);
   
+  ++m_NSteps;
+  
   if (Track->GetTrackID() != m_TrackId) {
     m_NSecondaries = 0;
     m_TrackId = Track->GetTrackID();
@@ -284,9 +288,10 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
   }
 
   // Prepare the IA interactions:
-  if (Step->GetPostStepPoint()->GetProcessDefinedStep() != 0) {
-    G4String ProcessName = Step->GetPostStepPoint()->GetProcessDefinedStep()->GetProcessName();
-    int ProcessID = GetProcessId(ProcessName);
+  const G4VProcess* Process = Step->GetPostStepPoint()->GetProcessDefinedStep();
+  if (Process != 0) {
+    const G4String& ProcessName = Process->GetProcessName();
+    int ProcessID = GetProcessId(Process);
 
       /*
       for (int ss = (int) fpSteppingManager->GetSecondary()->size()-1; 
@@ -353,7 +358,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              Track->GetMomentumDirection(),
                              Track->GetPolarization(),
                              Track->GetKineticEnergy(),
-                             GetParticleType(TrackA->GetDefinition()),
+                             GetCachedParticleType(TrackA->GetDefinition()),
                              TrackA->GetMomentumDirection(),
                              TrackA->GetPolarization(),
                              TrackA->GetKineticEnergy());
@@ -392,7 +397,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            G4ThreeVector(0.0, 0.0, 0.0),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            0.0,
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            TrackA->GetKineticEnergy());
@@ -422,11 +427,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            TrackA->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            0.0,
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            TrackA->GetPolarization(),
                            TrackA->GetKineticEnergy());
@@ -447,7 +452,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            Track->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            Track->GetMomentumDirection(),
                            Track->GetPolarization(),
                            Track->GetKineticEnergy(),
@@ -473,11 +478,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPreStepPoint()),
                              Time,
                              TrackA->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Track->GetMomentumDirection(),
                              Track->GetPolarization(),
                              Track->GetKineticEnergy(),
-                             GetParticleType(TrackA->GetDefinition()),
+                             GetCachedParticleType(TrackA->GetDefinition()),
                              TrackA->GetMomentumDirection(),
                              TrackA->GetPolarization(),
                              TrackA->GetKineticEnergy());
@@ -565,7 +570,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              G4ThreeVector(0.0, 0.0, 0.0),
                              G4ThreeVector(0.0, 0.0, 0.0),
                              0.0,
-                             GetParticleType(TrackA->GetDefinition()),
+                             GetCachedParticleType(TrackA->GetDefinition()),
                              TrackA->GetMomentumDirection(),
                              TrackA->GetPolarization(),
                              TrackA->GetKineticEnergy());
@@ -597,13 +602,13 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            Track->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            Track->GetMomentumDirection(),
                            Track->GetPolarization(),
                            Track->GetKineticEnergy(),
                            //TrackA->GetDefinition()->GetExcitationEnergy(),
                            //((MString(Track->GetDefinition()->GetParticleName().c_str()).Contains("[") == true) ? dynamic_cast<G4Ions*>(TrackA->GetDefinition())->GetExcitationEnergy() : 0.0),
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            TrackA->GetPolarization(),
                            TrackA->GetKineticEnergy());
@@ -620,7 +625,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                           GetDetectorId(Step->GetPreStepPoint()),
                           Time,
                           Track->GetPosition(),
-                          GetParticleType(Track->GetDefinition()),
+                          GetCachedParticleType(Track->GetDefinition()),
                           Track->GetMomentumDirection(),
                           Track->GetPolarization(),
                           Track->GetKineticEnergy(),
@@ -647,13 +652,13 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                             GetDetectorId(Step->GetPreStepPoint()),
                             Time,
                             Track->GetPosition(),
-                            GetParticleType(Track->GetDefinition()),
+                            GetCachedParticleType(Track->GetDefinition()),
                             Track->GetMomentumDirection(),
                             Track->GetPolarization(),
                             Track->GetKineticEnergy(),
                             //TrackA->GetDefinition()->GetExcitationEnergy(),
                             //((MString(Track->GetDefinition()->GetParticleName().c_str()).Contains("[") == true) ? dynamic_cast<G4Ions*>(TrackA->GetDefinition())->GetExcitationEnergy() : 0.0),
-                            GetParticleType(TrackA->GetDefinition()),
+                            GetCachedParticleType(TrackA->GetDefinition()),
                             TrackA->GetMomentumDirection(),
                             TrackA->GetPolarization(),
                             TrackA->GetKineticEnergy());
@@ -685,13 +690,13 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            Track->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            Track->GetMomentumDirection(),
                            Track->GetPolarization(),
                            Track->GetKineticEnergy(),
                            //TrackA->GetDefinition()->GetExcitationEnergy(),
                            //((MString(Track->GetDefinition()->GetParticleName().c_str()).Contains("[") == true) ? dynamic_cast<G4Ions*>(TrackA->GetDefinition())->GetExcitationEnergy() : 0.0),
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            TrackA->GetPolarization(),
                            TrackA->GetKineticEnergy());
@@ -724,11 +729,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            TrackA->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            0.0,
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            TrackA->GetPolarization(),
                            TrackA->GetKineticEnergy());
@@ -738,7 +743,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
 
       // There always has to be a generated secondary, since something decays into something else
       // "19" doesn't generate secondaries in Geant4... 
-      if (GeneratedSecondaries == 0 && GetParticleType(Track->GetDefinition()) != 19) {
+      if (GeneratedSecondaries == 0 && GetCachedParticleType(Track->GetDefinition()) != 19) {
         mout<<"The the decay of "<<Track->GetDefinition()->GetParticleName()<<" didn't generate secondaries! Either your thresholds for generating secondaires are too high or a simulation issue occurred!"<<endl;
       }
 
@@ -761,11 +766,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            TrackA->GetPosition(),
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            G4ThreeVector(0.0, 0.0, 0.0),
                            0.0,
-                           GetParticleType(TrackA->GetDefinition()),
+                           GetCachedParticleType(TrackA->GetDefinition()),
                            TrackA->GetMomentumDirection(),
                            TrackA->GetPolarization(),
                            TrackA->GetKineticEnergy());
@@ -802,7 +807,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
         if (m_ParticleOriginIsBuildUpSource == true) {
           if (((MCTrackInformation*) Track->GetUserInformation())->GetOriginId() <= int(m_InitialParticles.size())) {
             for (unsigned int i = 0; i < m_InitialParticles.size(); ++i) {
-              if (GetParticleType(Track->GetDefinition()) == m_InitialParticles[i]) {
+              if (GetCachedParticleType(Track->GetDefinition()) == m_InitialParticles[i]) {
                 IsInitialParticleFromBuildUpSource = true;
                 break;
               }
@@ -969,12 +974,12 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                                GetDetectorId(Step->GetPreStepPoint()),
                                TrackA->GetGlobalTime()/second,
                                TrackA->GetPosition(),
-                               GetParticleType(Track->GetDefinition()),
+                               GetCachedParticleType(Track->GetDefinition()),
                                G4ThreeVector(0.0, 0.0, 0.0),
                                G4ThreeVector(0.0, 0.0, 0.0),
                                //dynamic_cast<G4Ions*>(Track->GetDefinition())->GetExcitationEnergy(),
                                0.0,
-                               GetParticleType(TrackA->GetDefinition()),
+                               GetCachedParticleType(TrackA->GetDefinition()),
                                TrackA->GetMomentumDirection(),
                                TrackA->GetPolarization(),
                                TrackA->GetKineticEnergy());
@@ -1041,7 +1046,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                            GetDetectorId(Step->GetPreStepPoint()),
                            Time,
                            Track->GetPosition(), // This is the Step->GetPostStepPoint()
-                           GetParticleType(Track->GetDefinition()),
+                           GetCachedParticleType(Track->GetDefinition()),
                            Track->GetMomentumDirection(),
                            Track->GetPolarization(),
                            Track->GetKineticEnergy(),
@@ -1071,11 +1076,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPreStepPoint()),
                              Time,
                              TrackA->GetPosition(), // This is the Step->GetPostStepPoint()
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Track->GetMomentumDirection(),
                              Track->GetPolarization(),
                              Track->GetKineticEnergy(),
-                             GetParticleType(TrackA->GetDefinition()),
+                             GetCachedParticleType(TrackA->GetDefinition()),
                              TrackA->GetMomentumDirection(),
                              TrackA->GetPolarization(), 
                              TrackA->GetKineticEnergy());
@@ -1102,7 +1107,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPreStepPoint()),
                              Time,
                              Track->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Track->GetMomentumDirection(),
                              Track->GetPolarization(),
                              Track->GetKineticEnergy(),
@@ -1130,11 +1135,11 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPreStepPoint()),
                              Time,
                              TrackA->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Track->GetMomentumDirection(),
                              Track->GetPolarization(),
                              Track->GetKineticEnergy(),
-                             GetParticleType(TrackA->GetDefinition()),
+                             GetCachedParticleType(TrackA->GetDefinition()),
                              TrackA->GetMomentumDirection(),
                              TrackA->GetPolarization(), 
                              TrackA->GetKineticEnergy());
@@ -1178,7 +1183,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                        GetDetectorId(Step->GetPreStepPoint()),
                        Time,
                        Track->GetPosition(),
-                       GetParticleType(Track->GetDefinition()),
+                       GetCachedParticleType(Track->GetDefinition()),
                        Track->GetMomentumDirection(),
                        Track->GetPolarization(),
                        Track->GetKineticEnergy(),
@@ -1193,30 +1198,19 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
     //cout<<Track->GetNextVolume()->GetName()<<endl;
   }
 
+  // Determine once in which watched volumes and black absorbers we are before and after the step: 
+  bool VolumeChanged = (Step->GetPreStepPoint()->GetPhysicalVolume() != Step->GetPostStepPoint()->GetPhysicalVolume());
+  if (VolumeChanged == true && (m_WatchedVolumes.size() > 0 || m_BlackAbsorbers.size() > 0)) {
+    ClassifyTouchable(Step->GetPreStepPoint()->GetTouchable(), m_PreInWatchedVolume, m_PreInBlackAbsorber);
+    ClassifyTouchable(Step->GetPostStepPoint()->GetTouchable(), m_PostInWatchedVolume, m_PostInBlackAbsorber);
+  }
+  
   // Check if we enter or leave one of the watched volumes: 
   if (m_WatchedVolumes.size() > 0) {
-    if (Step->GetPreStepPoint()->GetPhysicalVolume() != Step->GetPostStepPoint()->GetPhysicalVolume()) {
+    if (VolumeChanged == true) {
       for (unsigned int w = 0; w < m_WatchedVolumes.size(); ++w) {
-        bool FoundInPre = false;
-        bool FoundInPost = false;
-        
-        const G4VTouchable* Touchable = Step->GetPreStepPoint()->GetTouchable();
-        for (int h = 0; h < Touchable->GetHistoryDepth(); ++h) {
-          if (Touchable->GetVolume(h)->GetLogicalVolume()->GetName().c_str() == m_WatchedVolumesLog[w] ||
-              Touchable->GetVolume(h)->GetName().c_str() == m_WatchedVolumes[w]) {
-            FoundInPre = true;
-            break;
-          }
-        }
-        
-        Touchable = Step->GetPostStepPoint()->GetTouchable();
-        for (int h = 0; h < Touchable->GetHistoryDepth(); ++h) {
-          if (Touchable->GetVolume(h)->GetLogicalVolume()->GetName().c_str() == m_WatchedVolumesLog[w] ||
-              Touchable->GetVolume(h)->GetName().c_str() == m_WatchedVolumes[w]) {
-            FoundInPost = true;
-            break;
-          }
-        }
+        bool FoundInPre = m_PreInWatchedVolume[w];
+        bool FoundInPost = m_PostInWatchedVolume[w];
 
         if (FoundInPre == false && FoundInPost == true) {
 
@@ -1228,7 +1222,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPostStepPoint()),
                              Time,
                              Step->GetPostStepPoint()->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Step->GetPostStepPoint()->GetMomentumDirection(),
                              Step->GetPostStepPoint()->GetPolarization(),
                              Step->GetPostStepPoint()->GetKineticEnergy(),
@@ -1248,7 +1242,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPreStepPoint()),
                              Time,
                              Step->GetPostStepPoint()->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Step->GetPostStepPoint()->GetMomentumDirection(),
                              Step->GetPostStepPoint()->GetPolarization(),
                              Step->GetPostStepPoint()->GetKineticEnergy(),
@@ -1264,24 +1258,10 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
 
   // Check if we enter a black absorber:
   if (m_BlackAbsorbers.size() > 0) {
-    if (Step->GetPreStepPoint()->GetPhysicalVolume() != Step->GetPostStepPoint()->GetPhysicalVolume()) {
+    if (VolumeChanged == true) {
       for (unsigned int w = 0; w < m_BlackAbsorbers.size(); ++w) {
-        bool FoundInPre = false;
-        bool FoundInPost = false;
-        
-        for (int h = 0; h < Step->GetPreStepPoint()->GetTouchable()->GetHistoryDepth(); ++h) {
-          if (Step->GetPreStepPoint()->GetTouchable()->GetVolume(h)->GetName().c_str() == m_BlackAbsorbers[w]) {
-            FoundInPre = true;
-            break;
-          }
-        }
-        
-        for (int h = 0; h < Step->GetPostStepPoint()->GetTouchable()->GetHistoryDepth(); ++h) {
-          if (Step->GetPostStepPoint()->GetTouchable()->GetVolume(h)->GetName().c_str() == m_BlackAbsorbers[w]) {
-            FoundInPost = true;
-            break;
-          }
-        }
+        bool FoundInPre = m_PreInBlackAbsorber[w];
+        bool FoundInPost = m_PostInBlackAbsorber[w];
 
         if (FoundInPre == false && FoundInPost == true) {
 
@@ -1293,7 +1273,7 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
                              GetDetectorId(Step->GetPostStepPoint()),
                              Time,
                              Step->GetPostStepPoint()->GetPosition(),
-                             GetParticleType(Track->GetDefinition()),
+                             GetCachedParticleType(Track->GetDefinition()),
                              Step->GetPostStepPoint()->GetMomentumDirection(),
                              Step->GetPostStepPoint()->GetPolarization(),
                              Step->GetPostStepPoint()->GetKineticEnergy(),
@@ -1310,17 +1290,23 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
   }
 
   // Check region - cut all secondaries
-  G4Region* Region = Step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
-  for (auto& R: m_Regions) {
-    if (R.GetName() == Region->GetName().c_str()) {
-      if (R.GetCutAllSecondaries() == true) {
-        if (GeneratedSecondaries > 0) {
-          for (int se = (int) fpSteppingManager->GetSecondary()->size() - GeneratedSecondaries; 
-             se < (int) fpSteppingManager->GetSecondary()->size(); ++se) {
-            fpSteppingManager->GetSecondary()->at(se)->SetTrackStatus(fStopAndKill);
-          }
+  if (GeneratedSecondaries > 0 && m_Regions.size() > 0) {
+    G4Region* Region = Step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+    auto Iter = m_RegionCutAllSecondariesCache.find(Region);
+    if (Iter == m_RegionCutAllSecondariesCache.end()) {
+      bool CutAllSecondaries = false;
+      for (auto& R: m_Regions) {
+        if (R.GetName() == Region->GetName().c_str() && R.GetCutAllSecondaries() == true) {
+          CutAllSecondaries = true;
         }
       }
+      Iter = m_RegionCutAllSecondariesCache.insert(make_pair(Region, CutAllSecondaries)).first;
+    }
+    if ((*Iter).second == true) {
+      for (int se = (int) fpSteppingManager->GetSecondary()->size() - GeneratedSecondaries; 
+           se < (int) fpSteppingManager->GetSecondary()->size(); ++se) {
+        fpSteppingManager->GetSecondary()->at(se)->SetTrackStatus(fStopAndKill);
+      }
     }
   }
   
@@ -1356,62 +1342,53 @@ void MCSteppingAction::UserSteppingAction(const G4Step* Step)
 
 
 /******************************************************************************
- * Return the Process ID
+ * Return the process ID of a process - the string comparison is only done
+ * the first time a process is seen
  */
-struct MCSteppingActionCompareDesc { 
-  vector<unsigned long long> V;
-  bool operator() (unsigned int i1, unsigned int i2) { return V[i1] > V[i2]; }
-} MyCompareDesc;
-
-int MCSteppingAction::GetProcessId(const G4String& Name)
+int MCSteppingAction::GetProcessId(const G4VProcess* Process)
 {
-  // Attention: In theory m_KnownProcessCounter and m_KnownProcessFrequency can overflow, but...
-  
-  if (m_KnownProcessCounter % m_KnownProcessUpdateCounter == 0) {
-    // Do some simple sorting...
-    vector<unsigned int> KnownProcessOrder;
-    for(unsigned int i = 0; i < m_KnownProcess.size(); ++i) { KnownProcessOrder.push_back(i); }
-    
-    // Sort decending...
-    /*struct CompareDesc { 
-      //CompareDesc(vector<unsigned long long> v) : V(v) {}
-      vector<unsigned long long> V;
-      bool operator() (unsigned int i1, unsigned int i2) { return V[i1] > V[i2]; }
-    } MyCompareDesc; */
-    MyCompareDesc.V = m_KnownProcessFrequency;
-    sort(KnownProcessOrder.begin(), KnownProcessOrder.end(), MyCompareDesc);
-    
-    vector<G4String> tKnownProcess = m_KnownProcess;
-    vector<int> tKnownProcessID = m_KnownProcessID;
-    vector<unsigned long long> tKnownProcessFrequency = m_KnownProcessFrequency;
-    for (unsigned int i = 0; i < m_KnownProcess.size(); ++i) {
-      m_KnownProcess[i] = tKnownProcess[KnownProcessOrder[i]];
-      m_KnownProcessID[i] = tKnownProcessID[KnownProcessOrder[i]];
-      m_KnownProcessFrequency[i] = tKnownProcessFrequency[KnownProcessOrder[i]];
-    }
-    
-    /*
-    cout<<endl;
-    cout<<"Newly sorted process IDs for speed up:"<<endl;
-    for (unsigned int i = 0; i < m_KnownProcess.size(); ++i) {
-      cout<<m_KnownProcess[i]<<" --> "<<m_KnownProcessFrequency[i]<<endl;
-    }
-    cout<<endl;
-    */
-    
-    m_KnownProcessUpdateCounter *= 10;
+  auto Iter = m_ProcessIdCache.find(Process);
+  if (Iter != m_ProcessIdCache.end()) {
+    return (*Iter).second;
   }
   
+  int ID = GetProcessId(Process->GetProcessName());
+  m_ProcessIdCache[Process] = ID;
+  
+  return ID;
+}
+
+
+/******************************************************************************
+ * Return the process ID from the process name
+ */
+int MCSteppingAction::GetProcessId(const G4String& Name)
+{
   for (unsigned int i = 0; i < m_KnownProcess.size(); ++i) {
     if (Name == m_KnownProcess[i]) {
-      ++m_KnownProcessCounter;
-      ++m_KnownProcessFrequency[i];
       return m_KnownProcessID[i];
     }
   }
   
   return c_ProcessIDUncovered;
 }
+
+
+/******************************************************************************
+ * Return the cosima particle type ID - cached by particle definition
+ */
+int MCSteppingAction::GetCachedParticleType(G4ParticleDefinition* Definition)
+{
+  auto Iter = m_ParticleTypeCache.find(Definition);
+  if (Iter != m_ParticleTypeCache.end()) {
+    return (*Iter).second;
+  }
+  
+  int Type = GetParticleType(Definition);
+  m_ParticleTypeCache[Definition] = Type;
+  
+  return Type;
+}
   
 
 /******************************************************************************
@@ -1896,6 +1873,48 @@ G4ParticleDefinition* MCSteppingAction::GetParticleDefinition(int ID, double Exc
 }
 
 
+/******************************************************************************
+ * Determine in which watched volumes and black absorbers the touchable is located
+ * The names of each physical volume are only compared the first time it is seen
+ */
+void MCSteppingAction::ClassifyTouchable(const G4VTouchable* Touchable, vector<bool>& InWatchedVolume, vector<bool>& InBlackAbsorber)
+{
+  fill(InWatchedVolume.begin(), InWatchedVolume.end(), false);
+  fill(InBlackAbsorber.begin(), InBlackAbsorber.end(), false);
+  
+  if (Touchable == 0) return;
+  
+  for (int h = 0; h < Touchable->GetHistoryDepth(); ++h) {
+    const G4VPhysicalVolume* Volume = Touchable->GetVolume(h);
+    if (Volume == 0) continue;
+    
+    auto Iter = m_VolumeCache.find(Volume);
+    if (Iter == m_VolumeCache.end()) {
+      MCVolumeClassification Classification;
+      for (unsigned int w = 0; w < m_WatchedVolumes.size(); ++w) {
+        if (Volume->GetLogicalVolume()->GetName().c_str() == m_WatchedVolumesLog[w] ||
+            Volume->GetName().c_str() == m_WatchedVolumes[w]) {
+          Classification.m_WatchedVolumes.push_back(w);
+        }
+      }
+      for (unsigned int b = 0; b < m_BlackAbsorbers.size(); ++b) {
+        if (Volume->GetName().c_str() == m_BlackAbsorbers[b]) {
+          Classification.m_BlackAbsorbers.push_back(b);
+        }
+      }
+      Iter = m_VolumeCache.insert(make_pair(Volume, Classification)).first;
+    }
+    
+    for (unsigned int w: (*Iter).second.m_WatchedVolumes) {
+      InWatchedVolume[w] = true;
+    }
+    for (unsigned int b: (*Iter).second.m_BlackAbsorbers) {
+      InBlackAbsorber[b] = true;
+    }
+  }
+}
+
+
 /******************************************************************************
  * Return the Id of the detector, we are currently in
  */
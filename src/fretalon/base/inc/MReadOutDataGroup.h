@@ -17,6 +17,9 @@
 
 
 // Standard libs:
+#include <cstdint>
+#include <vector>
+using namespace std;
 
 // ROOT libs:
 #include "TH1.h"
@@ -33,6 +36,9 @@
 
 
 //! A group of read-out datas 
+//! The by far most common data - an ADC value, optionally with a temperature - is stored packed in contiguous arrays
+//! instead of one heap-allocated (and wrapped) MReadOutData object per read out.
+//! Any other data type switches the group to the generic storage, as does a call to GetReadOutData().
 class MReadOutDataGroup
 {
   // public interface:
@@ -59,19 +65,43 @@ class MReadOutDataGroup
   void Move(MReadOutDataGroup& RODG);
     
   //! Return the number of available read-out data's
-  unsigned int GetNumberOfReadOutDatas() const { return m_RODs.size(); }
+  unsigned int GetNumberOfReadOutDatas() const { return IsPacked() == true ? m_ADCValues.size() : m_RODs.size(); }
   
   //! Return a specific read-out data, in case it doesn't exist throw the exception MExceptionIndexOutOfBounds
+  //! If the data is packed, the group is converted to the generic (slower and larger) storage first
   MReadOutData& GetReadOutData(unsigned int i);
   //! Return a specific read-out data, in case it doesn't exist throw the exception MExceptionIndexOutOfBounds
+  //! If the data is packed, the group is converted to the generic (slower and larger) storage first
   const MReadOutData& GetReadOutData(unsigned int i) const;
   
+  //! Return true if the data is stored packed
+  bool IsPacked() const { return m_Storage == c_StoragePackedADC || m_Storage == c_StoragePackedADCTemperature; }
+  //! Get the ADC value of read-out data i - return false if it has none
+  //! This works for both storage types, in case i doesn't exist throw the exception MExceptionIndexOutOfBounds
+  bool GetADCValue(unsigned int i, unsigned int& ADCValue) const;
+  //! Get the temperature of read-out data i - return false if it has none
+  //! This works for both storage types, in case i doesn't exist throw the exception MExceptionIndexOutOfBounds
+  bool GetTemperature(unsigned int i, double& Temperature) const;
+  
   //! Dump a string
   virtual MString ToString() const;
   
+  //! ID for an empty group - the storage is not yet determined
+  static const unsigned int c_StorageEmpty = 0;
+  //! ID for the packed storage of pure ADC values
+  static const unsigned int c_StoragePackedADC = 1;
+  //! ID for the packed storage of ADC values with temperatures
+  static const unsigned int c_StoragePackedADCTemperature = 2;
+  //! ID for the generic storage of any read-out data
+  static const unsigned int c_StorageGeneric = 3;
+  
+  
   // protected methods:
  protected:
-
+  //! Determine the packed storage type for this read-out data and return its values -- c_StorageGeneric if it cannot be packed
+  static unsigned int DeterminePackedStorage(const MReadOutData& ROD, unsigned int& ADCValue, double& Temperature);
+  //! Convert the packed into the generic storage
+  void Unpack();
    
   // private methods:
  private:
@@ -87,9 +117,19 @@ class MReadOutDataGroup
   //! Name of this group
   MString m_Name;
    
-  //! A list of all data
+  //! The storage type
+  unsigned int m_Storage;
+  
+  //! Generic storage: A list of all data
   vector<MReadOutData*> m_RODs;
   
+  //! Packed storage: The ADC values
+  vector<uint16_t> m_ADCValues;
+  //! Packed storage: The temperatures
+  vector<float> m_Temperatures;
+  //! Packed storage: The first read-out data, which determines type and wrapping order when unpacking
+  MReadOutData* m_Prototype;
+  
   
 #ifdef ___CLING___
  public:
@@ -54,6 +54,8 @@ class MReadOutElement
   virtual bool operator==(const MReadOutElement& R) const;
   //! Smaller than operator
   virtual bool operator<(const MReadOutElement& R) const;
+  //! Return a hash value -- identical read-out elements must have identical hashes
+  virtual size_t GetHash() const;
 
   //! Return true if this read-out element is of the given type
   virtual bool IsOfType(const MString& String) const;
@@ -17,6 +17,10 @@
 
 
 // Standard libs:
+#include <memory>
+#include <unordered_map>
+#include <vector>
+using namespace std;
 
 // ROOT libs:
 
@@ -34,6 +38,8 @@
 
 //! Store a sequence of read outs in read-out collections (read outs stored by their read out element, i.e. channel)
 //! Provide methods to retrieve the data for calibration and to store it
+//! The collections are found via a hash index on the read-out element. New collections are appended and
+//! the collections are only sorted by read-out element when they are accessed by index the next time.
 class MReadOutStore
 {
   // public interface:
@@ -83,6 +89,14 @@ class MReadOutStore
 
   // private methods:
  private:
+  //! Return the current position of the collection with the given read-out element via the hash index
+  //! If there is none return g_UnsignedIntNotDefined
+  unsigned int Find(const MReadOutElement& ROE) const;
+  //! Append a new collection for the given read-out element and return its position
+  unsigned int Create(const MReadOutElement& ROE);
+  //! Sort the collections by read-out element and rebuild the index -- if collections have been appended since the last sort
+  //! This only changes the order, not the content, thus it is const
+  void Sort() const;
 
 
 
@@ -93,7 +107,11 @@ class MReadOutStore
   // private members:
  private:
   //! The actual read-out collections
-  vector<MReadOutCollection> m_Collection;
+  mutable vector<unique_ptr<MReadOutCollection>> m_Collection;
+  //! The hash index: hash of the read-out element to the position in m_Collection
+  mutable unordered_multimap<size_t, unsigned int> m_Index;
+  //! True if the collections are sorted
+  mutable bool m_IsSorted;
 
   //! The read-out group names
   vector<MString> m_ReadOutDataGroups;
@@ -69,10 +69,11 @@ TH1D* MCalibrateEnergy::CreateHistogramCountsBinned(MReadOutDataGroup& G, double
 {
   // Make local copy of the read-out datas ADC values
   vector<double> Data;
+  Data.reserve(G.GetNumberOfReadOutDatas());
   for (unsigned int d = 0; d < G.GetNumberOfReadOutDatas(); ++d) {
-    MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(G.GetReadOutData(d).Get(MReadOutDataADCValue::m_TypeID));
-    if (ADC != nullptr) {
-      Data.push_back(ADC->GetADCValue());
+    unsigned int ADCValue = 0;
+    if (G.GetADCValue(d, ADCValue) == true) {
+      Data.push_back(ADCValue);
     }
   }
 
@@ -130,16 +130,16 @@ bool MCalibrateEnergyFindLines::FindPeaks(unsigned int ROGID)
   Binner.SetMinMax(m_RangeMinimum, m_RangeMaximum);
   Binner.SetPrior(m_Prior);
   for (unsigned int d = 0; d < m_ROGs[ROGID]->GetNumberOfReadOutDatas(); ++d) {
-    MReadOutDataTemperature* T = dynamic_cast<MReadOutDataTemperature*>(m_ROGs[ROGID]->GetReadOutData(d).Get(MReadOutDataTemperature::m_TypeID));
-    if (T != nullptr) {
-      if (T->GetTemperature() < m_TemperatureMin || T->GetTemperature() > m_TemperatureMax) {
+    double Temperature = 0;
+    if (m_ROGs[ROGID]->GetTemperature(d, Temperature) == true) {
+      if (Temperature < m_TemperatureMin || Temperature > m_TemperatureMax) {
         continue; 
       }
     }
     
-    MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(m_ROGs[ROGID]->GetReadOutData(d).Get(MReadOutDataADCValue::m_TypeID));
-    if (ADC != nullptr) {
-      Binner.Add(ADC->GetADCValue());
+    unsigned int ADCValue = 0;
+    if (m_ROGs[ROGID]->GetADCValue(d, ADCValue) == true) {
+      Binner.Add(ADCValue);
     }
   }
   TH1D* Data = Binner.GetNormalizedHistogram(MString("Data ") + ROGID, "ADC Values", "counts / ADC value");
@@ -310,12 +310,12 @@ bool MCalibrateEnergyFindLines::FindPeaks(unsigned int ROGID)
       double Total = 0.0;
       unsigned int TotalCounts = 0;
       for (unsigned int d = 0; d < m_ROGs[ROGID]->GetNumberOfReadOutDatas(); ++d) {
-        MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(m_ROGs[ROGID]->GetReadOutData(d).Get(MReadOutDataADCValue::m_TypeID));
-        if (ADC != nullptr) {
-          if (ADC->GetADCValue() >= Data->GetBinLowEdge(PeakBin) && 
-              ADC->GetADCValue() < Data->GetBinLowEdge(PeakBin) + Data->GetBinWidth(PeakBin)) {
+        unsigned int ADCValue = 0;
+        if (m_ROGs[ROGID]->GetADCValue(d, ADCValue) == true) {
+          if (ADCValue >= Data->GetBinLowEdge(PeakBin) && 
+              ADCValue < Data->GetBinLowEdge(PeakBin) + Data->GetBinWidth(PeakBin)) {
             TotalCounts++;
-            Total += ADC->GetADCValue();
+            Total += ADCValue;
           }
         }
       }
@@ -524,9 +524,9 @@ bool MCalibrateEnergyFindLines::FitPeaks(unsigned int ROGID)
     FitBinner.SetMinMax(m_RangeMinimum, m_RangeMaximum);
     
     for (unsigned int d = 0; d < m_ROGs[ROGID]->GetNumberOfReadOutDatas(); ++d) {
-        MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(m_ROGs[ROGID]->GetReadOutData(d).Get(MReadOutDataADCValue::m_TypeID));
-      if (ADC != nullptr) {
-        FitBinner.Add(ADC->GetADCValue());
+      unsigned int ADCValue = 0;
+      if (m_ROGs[ROGID]->GetADCValue(d, ADCValue) == true) {
+        FitBinner.Add(ADCValue);
       }
     }
     TH1D* FitData = FitBinner.GetNormalizedHistogram("Data - fitting resolution", "ADC Values", "counts / ADC value");
@@ -28,6 +28,7 @@
 
 // Standard libs:
 #include <algorithm>
+#include <limits>
 using namespace std;
 
 // ROOT libs:
@@ -36,6 +37,8 @@ using namespace std;
 
 // MEGAlib libs:
 #include "MExceptions.h"
+#include "MReadOutDataADCValue.h"
+#include "MReadOutDataTemperature.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +56,8 @@ ClassImp(MReadOutDataGroup)
 MReadOutDataGroup::MReadOutDataGroup() 
 {
   m_Name = "";
+  m_Storage = c_StorageEmpty;
+  m_Prototype = nullptr;
 }
 
 
@@ -63,6 +68,8 @@ MReadOutDataGroup::MReadOutDataGroup()
 MReadOutDataGroup::MReadOutDataGroup(const MString & Name) 
 {
   m_Name = Name;
+  m_Storage = c_StorageEmpty;
+  m_Prototype = nullptr;
 }
 
 
@@ -72,11 +79,9 @@ MReadOutDataGroup::MReadOutDataGroup(const MString & Name)
 //! The copy constructor 
 MReadOutDataGroup::MReadOutDataGroup(const MReadOutDataGroup& ReadOutDataGroup)
 {
-  m_Name = ReadOutDataGroup.m_Name;
+  m_Prototype = nullptr;
   
-  for (unsigned int d = 0; d < ReadOutDataGroup.m_RODs.size(); ++d) {
-    m_RODs.push_back(ReadOutDataGroup.m_RODs[d]->Clone());
-  }
+  *this = ReadOutDataGroup;
 }
 
 
@@ -90,6 +95,8 @@ MReadOutDataGroup::~MReadOutDataGroup()
     delete m_RODs[i];
   }
   m_RODs.clear();
+  
+  delete m_Prototype;
 }
 
 
@@ -99,7 +106,10 @@ MReadOutDataGroup::~MReadOutDataGroup()
 //! Assignment operator
 MReadOutDataGroup& MReadOutDataGroup::operator=(const MReadOutDataGroup& ReadOutDataGroup)
 {
+  if (this == &ReadOutDataGroup) return *this;
+  
   m_Name = ReadOutDataGroup.m_Name;
+  m_Storage = ReadOutDataGroup.m_Storage;
   
   for (unsigned int i = 0; i < m_RODs.size(); ++i) {
     delete m_RODs[i];
@@ -110,6 +120,12 @@ MReadOutDataGroup& MReadOutDataGroup::operator=(const MReadOutDataGroup& ReadOut
     m_RODs.push_back(ReadOutDataGroup.m_RODs[d]->Clone());
   }
   
+  m_ADCValues = ReadOutDataGroup.m_ADCValues;
+  m_Temperatures = ReadOutDataGroup.m_Temperatures;
+  
+  delete m_Prototype;
+  m_Prototype = (ReadOutDataGroup.m_Prototype != nullptr) ? ReadOutDataGroup.m_Prototype->Clone() : nullptr;
+  
   return *this;
 }
 
@@ -117,10 +133,89 @@ MReadOutDataGroup& MReadOutDataGroup::operator=(const MReadOutDataGroup& ReadOut
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Determine the packed storage type for this read-out data and return its values
+unsigned int MReadOutDataGroup::DeterminePackedStorage(const MReadOutData& ROD, unsigned int& ADCValue, double& Temperature)
+{
+  // Get() does not modify anything, it just is not declared const
+  MReadOutData& R = const_cast<MReadOutData&>(ROD);
+  
+  MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(R.Get(MReadOutDataADCValue::m_TypeID));
+  if (ADC == nullptr || ADC->GetADCValue() > numeric_limits<uint16_t>::max()) {
+    return c_StorageGeneric;
+  }
+  ADCValue = ADC->GetADCValue();
+  
+  // The number of parsable elements tells us if anything else is wrapped in addition
+  MReadOutDataTemperature* T = dynamic_cast<MReadOutDataTemperature*>(R.Get(MReadOutDataTemperature::m_TypeID));
+  if (T == nullptr) {
+    return (ROD.GetNumberOfParsableElements() == 1) ? c_StoragePackedADC : c_StorageGeneric;
+  }
+  Temperature = T->GetTemperature();
+  
+  return (ROD.GetNumberOfParsableElements() == 2) ? c_StoragePackedADCTemperature : c_StorageGeneric;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Add this read-out data 
 void MReadOutDataGroup::Add(const MReadOutData& ROD)
 {
-  m_RODs.push_back(ROD.Clone());
+  if (m_Storage == c_StorageGeneric) {
+    m_RODs.push_back(ROD.Clone());
+    return;
+  }
+  
+  unsigned int ADCValue = 0;
+  double Temperature = 0;
+  unsigned int Storage = DeterminePackedStorage(ROD, ADCValue, Temperature);
+  
+  if (m_Storage == c_StorageEmpty && Storage != c_StorageGeneric) {
+    m_Storage = Storage;
+    delete m_Prototype;
+    m_Prototype = ROD.Clone();
+  }
+  
+  if (Storage != m_Storage) {
+    Unpack();
+    m_RODs.push_back(ROD.Clone());
+    return;
+  }
+  
+  m_ADCValues.push_back(ADCValue);
+  if (m_Storage == c_StoragePackedADCTemperature) {
+    m_Temperatures.push_back(Temperature);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Convert the packed into the generic storage
+void MReadOutDataGroup::Unpack()
+{
+  if (IsPacked() == true) {
+    m_RODs.reserve(m_RODs.size() + m_ADCValues.size());
+    for (unsigned int d = 0; d < m_ADCValues.size(); ++d) {
+      MReadOutData* ROD = m_Prototype->Clone();
+      dynamic_cast<MReadOutDataADCValue*>(ROD->Get(MReadOutDataADCValue::m_TypeID))->SetADCValue(m_ADCValues[d]);
+      if (m_Storage == c_StoragePackedADCTemperature) {
+        dynamic_cast<MReadOutDataTemperature*>(ROD->Get(MReadOutDataTemperature::m_TypeID))->SetTemperature(m_Temperatures[d]);
+      }
+      m_RODs.push_back(ROD);
+    }
+  }
+  
+  m_ADCValues.clear();
+  m_ADCValues.shrink_to_fit();
+  m_Temperatures.clear();
+  m_Temperatures.shrink_to_fit();
+  delete m_Prototype;
+  m_Prototype = nullptr;
+  
+  m_Storage = c_StorageGeneric;
 }
 
 
@@ -130,8 +225,31 @@ void MReadOutDataGroup::Add(const MReadOutData& ROD)
 //! Move the content from the given into this read-out data group
 void MReadOutDataGroup::Move(MReadOutDataGroup& RODG)
 {
-  m_RODs.insert(m_RODs.end(), RODG.m_RODs.begin(), RODG.m_RODs.end());
-  RODG.m_RODs.clear();
+  if (RODG.m_Storage == c_StorageEmpty) return;
+  
+  // Both packed the same way (or we are still empty): just append the arrays 
+  if (RODG.IsPacked() == true && (m_Storage == c_StorageEmpty || m_Storage == RODG.m_Storage)) {
+    if (m_Storage == c_StorageEmpty) {
+      m_Storage = RODG.m_Storage;
+      m_Prototype = RODG.m_Prototype;
+      RODG.m_Prototype = nullptr;
+    }
+    m_ADCValues.insert(m_ADCValues.end(), RODG.m_ADCValues.begin(), RODG.m_ADCValues.end());
+    m_Temperatures.insert(m_Temperatures.end(), RODG.m_Temperatures.begin(), RODG.m_Temperatures.end());
+  } else {
+    Unpack();
+    RODG.Unpack();
+    m_RODs.insert(m_RODs.end(), RODG.m_RODs.begin(), RODG.m_RODs.end());
+    RODG.m_RODs.clear();
+  }
+  
+  RODG.m_ADCValues.clear();
+  RODG.m_ADCValues.shrink_to_fit();
+  RODG.m_Temperatures.clear();
+  RODG.m_Temperatures.shrink_to_fit();
+  delete RODG.m_Prototype;
+  RODG.m_Prototype = nullptr;
+  RODG.m_Storage = c_StorageEmpty;
 }
 
 
@@ -141,6 +259,8 @@ void MReadOutDataGroup::Move(MReadOutDataGroup& RODG)
 //! Return a specific read-out data, in case it doesn't exist throw the exception MExceptionIndexOutOfBounds
 MReadOutData& MReadOutDataGroup::GetReadOutData(unsigned int d)
 {
+  if (IsPacked() == true) Unpack();
+  
   if (d < m_RODs.size()) {
     return *m_RODs[d]; 
   }
@@ -158,6 +278,9 @@ MReadOutData& MReadOutDataGroup::GetReadOutData(unsigned int d)
 //! Return a specific read-out data, in case it doesn't exist throw the exception MExceptionIndexOutOfBounds
 const MReadOutData& MReadOutDataGroup::GetReadOutData(unsigned int d) const
 {
+  // Unpacking does not change the content, just its representation
+  if (IsPacked() == true) const_cast<MReadOutDataGroup*>(this)->Unpack();
+  
   if (d < m_RODs.size()) {
     return *m_RODs[d]; 
   }
@@ -172,11 +295,66 @@ const MReadOutData& MReadOutDataGroup::GetReadOutData(unsigned int d) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Get the ADC value of read-out data d - return false if it has none
+bool MReadOutDataGroup::GetADCValue(unsigned int d, unsigned int& ADCValue) const
+{
+  if (IsPacked() == true) {
+    if (d < m_ADCValues.size()) {
+      ADCValue = m_ADCValues[d];
+      return true;
+    }
+    throw MExceptionIndexOutOfBounds(0, m_ADCValues.size(), d);
+  }
+  
+  if (d < m_RODs.size()) {
+    MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(m_RODs[d]->Get(MReadOutDataADCValue::m_TypeID));
+    if (ADC == nullptr) return false;
+    ADCValue = ADC->GetADCValue();
+    return true;
+  }
+  
+  throw MExceptionIndexOutOfBounds(0, m_RODs.size(), d);
+  
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Get the temperature of read-out data d - return false if it has none
+bool MReadOutDataGroup::GetTemperature(unsigned int d, double& Temperature) const
+{
+  if (IsPacked() == true) {
+    if (d < m_ADCValues.size()) {
+      if (m_Storage != c_StoragePackedADCTemperature) return false;
+      Temperature = m_Temperatures[d];
+      return true;
+    }
+    throw MExceptionIndexOutOfBounds(0, m_ADCValues.size(), d);
+  }
+  
+  if (d < m_RODs.size()) {
+    MReadOutDataTemperature* T = dynamic_cast<MReadOutDataTemperature*>(m_RODs[d]->Get(MReadOutDataTemperature::m_TypeID));
+    if (T == nullptr) return false;
+    Temperature = T->GetTemperature();
+    return true;
+  }
+  
+  throw MExceptionIndexOutOfBounds(0, m_RODs.size(), d);
+  
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Dump the content into a string
 MString MReadOutDataGroup::ToString() const
 {
   ostringstream os;
-  os<<"Data group with "<<m_RODs.size()<<" entries";
+  os<<"Data group with "<<GetNumberOfReadOutDatas()<<" entries";
   return os.str();
 }
 
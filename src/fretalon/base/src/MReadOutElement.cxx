@@ -116,6 +116,16 @@ bool MReadOutElement::operator<(const MReadOutElement& R) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Return a hash value -- identical read-out elements must have identical hashes
+size_t MReadOutElement::GetHash() const
+{
+  return m_DetectorID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Return true if this read-out element is of the given type
 bool MReadOutElement::IsOfType(const MString& String) const
 { 
@@ -151,6 +151,16 @@ bool MReadOutElementDoubleStrip::operator<(const MReadOutElement& R) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return a hash value -- identical read-out elements must have identical hashes
+size_t MReadOutElementDoubleStrip::GetHash() const
+{
+  return (MReadOutElementStrip::GetHash() << 1) | (m_IsLowVoltageStrip == true ? 1 : 0);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
  
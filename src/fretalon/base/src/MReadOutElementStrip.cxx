@@ -149,6 +149,16 @@ bool MReadOutElementStrip::operator<(const MReadOutElement& R) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return a hash value -- identical read-out elements must have identical hashes
+size_t MReadOutElementStrip::GetHash() const
+{
+  return (size_t(m_DetectorID) << 20) ^ m_StripID;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
  
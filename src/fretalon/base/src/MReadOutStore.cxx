@@ -50,6 +50,7 @@ ClassImp(MReadOutStore)
 //! Default constructor
 MReadOutStore::MReadOutStore()
 {
+  m_IsSorted = true;
 }
 
 
@@ -69,6 +70,8 @@ MReadOutStore::~MReadOutStore()
 void MReadOutStore::Clear()
 {
   m_Collection.clear();
+  m_Index.clear();
+  m_IsSorted = true;
   m_ReadOutDataGroups.clear();
 }
 
@@ -81,11 +84,67 @@ unsigned int MReadOutStore::AddReadOutDataGroup(const MString& Name)
 {
   m_ReadOutDataGroups.push_back(Name);
   for (unsigned int c = 0; c < m_Collection.size(); ++c) {
-    m_Collection[c].AddReadOutDataGroup(Name);
+    m_Collection[c]->AddReadOutDataGroup(Name);
   }
   return m_ReadOutDataGroups.size() - 1;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the current position of the collection with the given read-out element via the hash index
+unsigned int MReadOutStore::Find(const MReadOutElement& ROE) const
+{
+  auto Range = m_Index.equal_range(ROE.GetHash());
+  for (auto I = Range.first; I != Range.second; ++I) {
+    if (m_Collection[I->second]->HasIdenticalReadOutElement(ROE) == true) {
+      return I->second;
+    }
+  }
+  
+  return g_UnsignedIntNotDefined;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Append a new collection for the given read-out element and return its position
+unsigned int MReadOutStore::Create(const MReadOutElement& ROE)
+{
+  m_Collection.emplace_back(new MReadOutCollection(ROE));
+  m_Collection.back()->AddReadOutDataGroups(m_ReadOutDataGroups);
+  
+  unsigned int Position = m_Collection.size() - 1;
+  m_Index.emplace(ROE.GetHash(), Position);
+  
+  if (Position > 0) m_IsSorted = false;
+  
+  return Position;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Sort the collections by read-out element and rebuild the index
+void MReadOutStore::Sort() const
+{
+  if (m_IsSorted == true) return;
+  
+  stable_sort(m_Collection.begin(), m_Collection.end(), 
+              [](const unique_ptr<MReadOutCollection>& A, const unique_ptr<MReadOutCollection>& B) { return *A < *B; });
+  
+  m_Index.clear();
+  m_Index.reserve(m_Collection.size());
+  for (unsigned int c = 0; c < m_Collection.size(); ++c) {
+    m_Index.emplace(m_Collection[c]->GetReadOutElement().GetHash(), c);
+  }
+  
+  m_IsSorted = true;
+}
+
   
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -104,16 +163,12 @@ bool MReadOutStore::Move(MReadOutStore& Store, unsigned int GroupID)
   }
   
   for (unsigned int c = 0; c < Store.m_Collection.size(); ++c) {
-    MReadOutCollection C(Store.m_Collection[c].GetReadOutElement());
-    vector<MReadOutCollection>::iterator I = lower_bound(m_Collection.begin(), m_Collection.end(), C);
-    // We have a lower bound, i.e. the first which is not "<", so we might not yet have found it and we have to check a final time:
-    if (I == m_Collection.end() || !((*I).GetReadOutElement() == Store.m_Collection[c].GetReadOutElement())) {
-      vector<MReadOutCollection>::iterator New = m_Collection.insert(I, C);
-      (*New).AddReadOutDataGroups(m_ReadOutDataGroups);
-      (*New).Move(Store.m_Collection[c].GetReadOutDataGroup(0), GroupID);
-    } else {
-      (*I).Move(Store.m_Collection[c].GetReadOutDataGroup(0), GroupID);
+    const MReadOutElement& ROE = Store.m_Collection[c]->GetReadOutElement();
+    unsigned int Position = Find(ROE);
+    if (Position == g_UnsignedIntNotDefined) {
+      Position = Create(ROE);
     }
+    m_Collection[Position]->Move(Store.m_Collection[c]->GetReadOutDataGroup(0), GroupID);
   }
   
   return true;
@@ -127,25 +182,13 @@ bool MReadOutStore::Move(MReadOutStore& Store, unsigned int GroupID)
 bool MReadOutStore::Add(const MReadOutSequence& Sequence, unsigned int Group)
 {
   if (Group < m_ReadOutDataGroups.size()) {
-    // Loop over all collections and try to add the sequence data
     for (unsigned int r = 0; r < Sequence.GetNumberOfReadOuts(); ++r) { 
-      /*
-      bool Found = false;
-      for (unsigned int c = 0; c < m_Collection.size(); ++c) {
-        Found = m_Collection[c].Add(Sequence.GetReadOut(r), Group);
-        if (Found == true) break;
-      }
-      */
-      
-      MReadOutCollection C(Sequence.GetReadOut(r).GetReadOutElement());
-      vector<MReadOutCollection>::iterator I = lower_bound(m_Collection.begin(), m_Collection.end(), C);
-      // We have a lower bound, i.e. the first which is not "<", so we might not yet have found it and we have to check a final time:
-      if (I == m_Collection.end() || (*I).Add(Sequence.GetReadOut(r), Group) == false) {
-        C.AddReadOutDataGroups(m_ReadOutDataGroups);
-        C.Add(Sequence, Group);
-        m_Collection.insert(I, C);
-        //cout<<ToString()<<endl;
+      const MReadOut& RO = Sequence.GetReadOut(r);
+      unsigned int Position = Find(RO.GetReadOutElement());
+      if (Position == g_UnsignedIntNotDefined) {
+        Position = Create(RO.GetReadOutElement());
       }
+      m_Collection[Position]->Add(RO.GetReadOutData(), Group);
     }
     return true;
   }
@@ -160,14 +203,9 @@ bool MReadOutStore::Add(const MReadOutSequence& Sequence, unsigned int Group)
 //! Check if the given read-out element is in the collection
 unsigned int MReadOutStore::FindReadOutCollection(const MReadOutElement& ROE) const
 {
-  // Loop over all collection and try to add the sequence data
-  for (unsigned int s = 0; s < m_Collection.size(); ++s) {
-    if (m_Collection[s].HasIdenticalReadOutElement(ROE) == true) {
-      return s;
-    }
-  }
+  Sort();
   
-  return g_UnsignedIntNotDefined;
+  return Find(ROE);
 }
 
 
@@ -177,12 +215,15 @@ unsigned int MReadOutStore::FindReadOutCollection(const MReadOutElement& ROE) co
 //! Get a read-out collection
 MReadOutCollection& MReadOutStore::GetReadOutCollection(unsigned int s)
 {
-  if (s < m_Collection.size()) return m_Collection[s]; 
+  if (s < m_Collection.size()) {
+    Sort();
+    return *m_Collection[s]; 
+  }
   
   throw MExceptionIndexOutOfBounds(0, m_Collection.size(), s);
   
   // We still need a return value...
-  return m_Collection[0];
+  return *m_Collection[0];
 }
 
 /*
@@ -216,9 +257,10 @@ void MReadOutStore::RemoveCollectionsWithNoPositiveEntries()
 MString MReadOutStore::ToString() const
 {
   ostringstream os;
+  Sort();
   os<<"ROS - number of collections = "<<m_Collection.size()<<endl;
   for (unsigned int c = 0; c < m_Collection.size(); ++c) {
-    os<<m_Collection[c]<<endl;  
+    os<<*m_Collection[c]<<endl;  
   }
   return os.str();
 }
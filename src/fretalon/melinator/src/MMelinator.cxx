@@ -1197,9 +1197,9 @@ TH1D* MMelinator::CreateSpectrum(const MString& Title, MReadOutDataGroup& G, dou
 
   Binner->SetMinMax(Min, Max);
   for (unsigned int d = 0; d < G.GetNumberOfReadOutDatas(); ++d) {
-    MReadOutDataADCValue* ADC = dynamic_cast<MReadOutDataADCValue*>(G.GetReadOutData(d).Get(MReadOutDataADCValue::m_TypeID));
-    if (ADC != nullptr) {
-      Binner->Add(ADC->GetADCValue());
+    unsigned int ADCValue = 0;
+    if (G.GetADCValue(d, ADCValue) == true) {
+      Binner->Add(ADCValue);
     }
   }
 
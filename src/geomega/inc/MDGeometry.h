@@ -39,10 +39,13 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <string>
+#include <unordered_map>
 using std::vector;
 
 
 // Forward declarations:
+class MTimer;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +63,19 @@ class MDGeometry
   //! If VirtualizeNonDetectorVolumes is true, all non-detector volumes are eliminated from the volume tree
   bool ScanSetupFile(MString FileName = "", bool CreateNodes = true, bool VirtualizeNonDetectorVolumes = false, bool AllowCrossSectionCreation = true);
   
+  //! Use (default) or do not use the cache of the preprocessed setup file
+  //! The cache contains the setup file after including all files and resolving all constants, vectors, maths, loops, and if clauses,
+  //! and it is only used if none of the files it has been created from has changed.
+  //! The volumes, materials, detectors and cross sections are still created from the preprocessed lines.
+  //! Setting the environment variable MEGALIB_GEOMETRYCACHE to "off" also switches the cache off.
+  static void UseCache(bool UseCache) { s_UseCache = UseCache; }
+  //! Return true if the cache of the preprocessed setup files is used
+  static bool IsCacheUsed();
+  //! Set the directory of the cache files - default: $MEGALIB_GEOMETRYCACHE, $XDG_CACHE_HOME/megalib/geomega, or ~/.cache/megalib/geomega
+  static void SetCacheDirectory(const MString& Directory) { s_CacheDirectory = Directory; }
+  //! Return the directory of the cache files
+  static MString GetCacheDirectory();
+  
   //! Draws the geometry
   //! WARNING: This is NOT reentrant, you cannot draw two different geometries!
   virtual bool DrawGeometry(TCanvas* Canvas = nullptr, bool RestoreView = false, MString Mode = "ogle");
@@ -99,7 +115,7 @@ class MDGeometry
 
   void AddVolume(MDVolume* Volume);
   MDVolume* GetVolumeAt(const unsigned int i) const;
-  MDVolume* GetVolume(const MString& Name);
+  MDVolume* GetVolume(const MString& Name) const;
   unsigned int GetVolumeIndex(const MString& Name);
   unsigned int GetNVolumes() const;
   MDVolume* GetWorldVolume();
@@ -110,14 +126,14 @@ class MDGeometry
 
   void AddMaterial(MDMaterial* Material);
   MDMaterial* GetMaterialAt(unsigned int i);
-  MDMaterial* GetMaterial(const MString& Name);
+  MDMaterial* GetMaterial(const MString& Name) const;
   unsigned int GetMaterialIndex(const MString& Name);
   unsigned int GetNMaterials();
   vector<MDMaterial*> GetMaterialList() const { return m_MaterialList; }
   
   void AddDetector(MDDetector* Detector);
   MDDetector* GetDetectorAt(unsigned int i);
-  MDDetector* GetDetector(const MString& Name);
+  MDDetector* GetDetector(const MString& Name) const;
   MDDetector* GetDetector(MVector Position);
   unsigned int GetDetectorIndex(const MString& Name);
   unsigned int GetNDetectors();
@@ -127,14 +143,14 @@ class MDGeometry
   bool AddShape(const MString& Type, const MString& Name);
   void AddShape(MDShape* Shape);
   MDShape* GetShapeAt(unsigned int i);
-  MDShape* GetShape(const MString& Name);
+  MDShape* GetShape(const MString& Name) const;
   unsigned int GetShapeIndex(const MString& Name);
   unsigned int GetNShapes();
   vector<MDShape*> GetShapeList() const { return m_ShapeList; }
   
   void AddOrientation(MDOrientation* Orientation);
   MDOrientation* GetOrientationAt(unsigned int i);
-  MDOrientation* GetOrientation(const MString& Name);
+  MDOrientation* GetOrientation(const MString& Name) const;
   unsigned int GetOrientationIndex(const MString& Name);
   unsigned int GetNOrientations();
   vector<MDOrientation*> GetOrientationList() const { return m_OrientationList; }
@@ -143,7 +159,7 @@ class MDGeometry
 
   void AddTrigger(MDTrigger* Trigger);
   MDTrigger* GetTriggerAt(unsigned int i);
-  MDTrigger* GetTrigger(const MString& Name);
+  MDTrigger* GetTrigger(const MString& Name) const;
   unsigned int GetTriggerIndex(const MString& Name);
   unsigned int GetNTriggers();
   vector<MDTrigger*> GetTriggerList() const { return m_TriggerList; }
@@ -155,7 +171,7 @@ class MDGeometry
   
   void AddVector(MDVector* Vector);
   MDVector* GetVectorAt(unsigned int i);
-  MDVector* GetVector(const MString& Name);
+  MDVector* GetVector(const MString& Name) const;
   unsigned int GetVectorIndex(const MString& Name);
   unsigned int GetNVectors();
 
@@ -201,6 +217,15 @@ class MDGeometry
  protected:
   //! Add an "Include"-ed file
   bool AddFile(MString Filename, list<MDDebugInfo>& DebugInfos);
+  //! Read all files and resolve all constants, maths, for loops, random numbers and if clauses
+  bool PreprocessSetupFile(list<MDDebugInfo>& FileContent, bool& FoundDeprecated, int& Stage, MTimer& Timer);
+  
+  //! Return the name of the cache file
+  MString GetCacheFileName() const;
+  //! Read the preprocessed setup file from the cache - returns false if there is no valid cache
+  bool ReadCache(list<MDDebugInfo>& FileContent, bool& FoundDeprecated);
+  //! Write the preprocessed setup file to the cache
+  bool WriteCache(const list<MDDebugInfo>& FileContent, bool FoundDeprecated);
   //! Import a GDML file
   bool ImportGDML(MString Filename, list<MDDebugInfo>& DebugInfos);
   
@@ -211,8 +236,8 @@ class MDGeometry
   
   // private methods:
  private:
-   
-   
+  //! Rebuild all name indices from the lists
+  void BuildNameIndices();
    
 
   // protected members:
@@ -311,8 +336,25 @@ class MDGeometry
   
   // private members:
  private:
-  list<MDVolume*> m_LastVolumes;
-  unsigned int m_LastVolumePosition;
+  //! True if the cache of the preprocessed setup file is used
+  static bool s_UseCache;
+  //! The directory of the cache files - empty for the default
+  static MString s_CacheDirectory;
+  //! The identifier of a cache file
+  static const unsigned int c_CacheMagic = 0x4D444743;
+  //! The version of the cache file format - increase whenever the preprocessing changes
+  static const unsigned int c_CacheVersion = 1;
+  //! The number of stages of the preprocessing
+  static const int c_NPreprocessingStages = 6;
+
+  //! The name indices for the Get...(Name) lookups - they are only read after the scan, thus these lookups are reentrant
+  std::unordered_map<std::string, MDVolume*> m_VolumeIndex;
+  std::unordered_map<std::string, MDMaterial*> m_MaterialIndex;
+  std::unordered_map<std::string, MDDetector*> m_DetectorIndex;
+  std::unordered_map<std::string, MDShape*> m_ShapeIndex;
+  std::unordered_map<std::string, MDOrientation*> m_OrientationIndex;
+  std::unordered_map<std::string, MDTrigger*> m_TriggerIndex;
+  std::unordered_map<std::string, MDVector*> m_VectorIndex;
 
   //! The random number generator for GetRandomPositionInVolume
   TRandom3 m_RandomPositionInVolumeRNG;
@@ -30,6 +30,7 @@
 // Standard libs::
 #include <vector>
 #include <map>
+#include <functional>
 using namespace std;
 
 // Forward declarations:
@@ -94,11 +95,48 @@ class MDGeometryQuest : public MDGeometry
   bool GetComptonIntersection(const MComptonEvent& Compton);
   map<MDMaterial*, double> GetPathLengths(MVector Start, MVector Stop);
 
+  // Batched absorption interface:
+  //! Determine the path lengths of one ray in all materials: Lengths[m] is the path length in the material with geometry index m
+  bool GetPathLengths(const MVector& Start, const MVector& Stop, vector<double>& Lengths);
+  //! Determine the path lengths in all materials for many rays at once:
+  //! Lengths[r*GetNMaterials() + m] is the path length of ray r in the material with geometry index m (see MDMaterial::GetGeometryIndex())
+  //! The rays are distributed over NThreads threads, 0 means as many as there are cores --
+  //! but only if the TGeoManager has been set up for multi-threading (TGeoManager::SetMaxThreads with enough threads), otherwise one thread is used
+  bool GetPathLengths(const vector<MVector>& Starts, const vector<MVector>& Stops, vector<double>& Lengths, unsigned int NThreads = 1);
+  //! Determine the absorption probabilities (Mode: one of the c_Absorption... IDs) for many rays at once
+  //! The rays are distributed over NThreads threads like in GetPathLengths
+  bool GetAbsorptionProbabilities(const vector<MVector>& Starts, const vector<MVector>& Stops, const vector<double>& Energies, 
+                                  vector<double>& Probabilities, int Mode = c_AbsorptionTotal, unsigned int NThreads = 1);
+  //! Determine the absorption probability from the path lengths of one ray (GetNMaterials() entries),
+  //! e.g. to reuse one ray tracing for several energies or processes
+  double GetAbsorptionProbability(const double* Lengths, double Energy, int Mode = c_AbsorptionTotal);
+
+  //! ID of the total absorption probability
+  static const int c_AbsorptionTotal = 0;
+  //! ID of the photo absorption probability
+  static const int c_AbsorptionPhoto = 1;
+  //! ID of the Compton absorption probability
+  static const int c_AbsorptionCompton = 2;
+  //! ID of the pair absorption probability
+  static const int c_AbsorptionPair = 3;
+  //! ID of the Rayleigh absorption probability
+  static const int c_AbsorptionRayleigh = 4;
+
 
   // protected methods:
  protected:
   double GetAbsorptionProbability(MVector Start, MVector Stop, double Energy, int Mode);
 
+  //! Return the absorption coefficient of the given material for the Mode (one of the c_Absorption... IDs)
+  double GetAbsorptionCoefficient(MDMaterial* Material, double Energy, int Mode);
+  //! Return the number of threads to use for the batched ray tracing of NRays rays -- one, if TGeo is not set up for multi-threading
+  unsigned int GetNRayTracingThreads(unsigned int NThreads, unsigned int NRays);
+  //! Run the function for the ray ranges [Start, Stop[ in NThreads threads
+  void RunRayTracingThreads(unsigned int NThreads, unsigned int NRays, const function<void(unsigned int, unsigned int)>& Function);
+
+  //! The minimum number of rays per thread for the batched ray tracing
+  static const unsigned int c_MinimumRaysPerThread = 16;
+
 
   // private methods:
  private:
@@ -118,6 +156,9 @@ class MDGeometryQuest : public MDGeometry
   bool m_AllwaysAssumeTrigger;
   bool m_ActivateNoising;
 
+  //! True if we already told the user that the ray tracing falls back to one thread
+  bool m_RayTracingThreadsWarningShown;
+
 
 
 #ifdef ___CLING___
@@ -116,6 +116,11 @@ class MDMaterial
   //! Return the unique ID of the material
   int GetID() const { return m_ID; }
 
+  //! Set the index of this material in the material list of its geometry
+  void SetGeometryIndex(unsigned int Index) { m_GeometryIndex = Index; }
+  //! Return the index of this material in the material list of its geometry (used for flat, material-indexed arrays)
+  unsigned int GetGeometryIndex() const { return m_GeometryIndex; }
+
   // Determine the main component of this material and return its atomic number:
   int GetAtomicNumberMainComponent() const;
 
@@ -175,6 +180,8 @@ class MDMaterial
 
   //! The unique ID of the material
   int m_ID;
+  //! The index of this material in the material list of its geometry
+  unsigned int m_GeometryIndex;
   
   //! The material in ROOT notation
   TGeoMedium* m_GeoMedium;
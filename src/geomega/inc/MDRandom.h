@@ -0,0 +1,97 @@
+/*
+ * MDRandom.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MDRandom__
+#define __MDRandom__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <atomic>
+using namespace std;
+
+// ROOT libs:
+#include <TRandom.h>
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The random number generator for noising hits in the detectors:
+//! The main thread uses gRandom as before, thus seeds set via gRandom still apply there.
+//! Every other thread gets its own generator, thus several threads can noise hits with the same geometry
+//! without sharing (and racing on) gRandom. Its seed is only reproducible if the thread declares its worker ID,
+//! since the order in which threads first draw a number is not.
+//! While a stream is set, the calling thread instead uses a counter-based generator keyed by the stream seed,
+//! the run ID (e.g. derived from the input file name), the stream ID (e.g. the event ID) and the sub-stream ID
+//! (e.g. the hit index): The noising then gives bit-identical results independent of the number of threads and
+//! the order in which the events are processed, while different input files and seeds give independent noise.
+class MDRandom
+{
+  // public interface:
+ public:
+  //! Return the random number generator of the calling thread
+  static TRandom* Get();
+  //! Set the seed of the random number generator of the calling thread
+  static void SetSeed(unsigned int Seed);
+  //! Set the base seed for the generators of the worker threads:
+  //! Worker N is seeded with BaseSeed + N + 1, with 0 (default) each generator gets a unique random seed
+  static void SetThreadBaseSeed(unsigned int BaseSeed) { s_ThreadBaseSeed = BaseSeed; }
+  //! Declare the calling thread as worker WorkerID (e.g. its index in the thread pool) and restart its
+  //! generator with BaseSeed + WorkerID + 1 - threads which do not call this get a unique random seed
+  static void SetWorkerID(unsigned int WorkerID);
+
+  //! Let the calling thread use the counter-based stream RunID/StreamID/SubStreamID (restarted) until ClearStream is called
+  static void SetStream(unsigned long StreamID, unsigned int SubStreamID = 0, unsigned int RunID = 0);
+  //! Let the calling thread use its default generator again
+  static void ClearStream();
+  //! Return true if the calling thread uses a counter-based stream
+  static bool HasStream();
+  //! Set the seed of all counter-based streams (default: 0)
+  static void SetStreamSeed(unsigned int Seed) { s_StreamSeed = Seed; }
+  //! Return the seed of all counter-based streams
+  static unsigned int GetStreamSeed() { return s_StreamSeed; }
+  //! Return a run ID for the streams of the given file: A hash of its name without the directory,
+  //! thus the result does not depend on where the file is stored
+  static unsigned int GetStreamRunID(const MString& FileName);
+
+  // private methods:
+ private:
+  //! Only static members
+  MDRandom() {}
+
+  // private members:
+ private:
+  //! The base seed for the generators of new threads
+  static atomic<unsigned int> s_ThreadBaseSeed;
+  //! The seed of the counter-based streams
+  static atomic<unsigned int> s_StreamSeed;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MDRandom, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
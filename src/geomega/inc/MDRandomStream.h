@@ -0,0 +1,93 @@
+/*
+ * MDRandomStream.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MDRandomStream__
+#define __MDRandomStream__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstdint>
+using namespace std;
+
+// ROOT libs:
+#include <TRandom.h>
+
+// MEGAlib libs:
+#include "MGlobal.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A counter-based random number generator (Philox4x32-10):
+//! The n-th random number is a pure function of the seed, the run ID, the stream ID, the sub-stream ID and n.
+//! Thus noising an event with its own stream (e.g. keyed by the input file, the event ID and the hit index)
+//! gives the same result independent of the thread which does it, and of the order of the events.
+//! Each stream has 2^33 random numbers before it repeats.
+class MDRandomStream : public TRandom
+{
+  // public interface:
+ public:
+  //! Default constructor - seed, stream and sub-stream are zero
+  MDRandomStream();
+  //! Default destructor
+  virtual ~MDRandomStream();
+
+  //! Select the stream and restart it at its first random number
+  void SetStream(unsigned int Seed, unsigned long StreamID, unsigned int SubStreamID = 0, unsigned int RunID = 0);
+
+  //! Return a uniformly distributed random number in ]0, 1[
+  virtual Double_t Rndm();
+  //! Fill the array with N uniformly distributed random numbers in ]0, 1[
+  virtual void RndmArray(Int_t N, Float_t* Array);
+  //! Fill the array with N uniformly distributed random numbers in ]0, 1[
+  virtual void RndmArray(Int_t N, Double_t* Array);
+
+  //! Set the seed but keep the run, stream and sub-stream, and restart the stream
+  virtual void SetSeed(ULong_t Seed = 0);
+  //! Return the seed
+  virtual UInt_t GetSeed() const { return m_Seed; }
+
+  // private methods:
+ private:
+  //! Calculate the next block of four 32-bit random numbers and increase the counter
+  void NextBlock();
+
+  // private members:
+ private:
+  //! The seed
+  uint32_t m_Seed;
+  //! The key: the stream ID
+  uint32_t m_Key[2];
+  //! The counter: the block number, the run ID, the sub-stream ID, and the seed
+  uint32_t m_Counter[4];
+  //! The current block of random numbers
+  uint32_t m_Block[4];
+  //! The position of the next unused pair of numbers in the block
+  unsigned int m_BlockPosition;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MDRandomStream, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
@@ -63,6 +63,9 @@ class MDTrigger
   //! Default destructor
   virtual ~MDTrigger();
 
+  //! Return a copy of this trigger with its own event data
+  virtual MDTrigger* Clone() const = 0;
+
   //! Return the name of this trigger
   MString GetName() const { return m_Name; }
   
@@ -82,6 +85,11 @@ class MDTrigger
   //! Return true if this trigger is vetoing
   virtual bool IsVetoing(MDDetector*) const { return false; }
   
+  //! Return true if AddHit would accept a hit in this detector
+  virtual bool AcceptsHit(MDDetector*) const { return false; }
+  //! Return true if AddGuardRingHit would accept a hit in the guard ring of this detector
+  virtual bool AcceptsGuardRingHit(MDDetector*) const { return false; }
+  
   //! Returns true if the hit could be added 
   virtual bool AddHit(MDVolumeSequence&) { return false; }
   //! Returns true if the hit could be added 
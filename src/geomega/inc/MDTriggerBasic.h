@@ -44,6 +44,9 @@ class MDTriggerBasic : public MDTrigger
   //! Default destructor
   virtual ~MDTriggerBasic();
 
+  //! Return a copy of this trigger with its own event data
+  virtual MDTrigger* Clone() const { return new MDTriggerBasic(*this); }
+
   //! Return the name of this trigger
   virtual MString GetName() const;
 
@@ -90,6 +93,10 @@ class MDTriggerBasic : public MDTrigger
   
   //! Return true if this trigger applies to the detector
   bool Applies(MDDetector* D) const;
+  //! Return true if AddHit would accept a hit in this detector
+  bool AcceptsHit(MDDetector* D) const { return Accepts(D, c_Detector); }
+  //! Return true if AddGuardRingHit would accept a hit in the guard ring of this detector
+  bool AcceptsGuardRingHit(MDDetector* D) const { return Accepts(D, c_GuardRing); }
 
   //! Returns true if the hit could be added 
   bool AddHit(MDVolumeSequence& VS);
@@ -116,7 +123,8 @@ class MDTriggerBasic : public MDTrigger
 
   // private methods:
  private:
-
+  //! Return true if the hit matching of AddHit (Type: c_Detector) or AddGuardRingHit (Type: c_GuardRing) accepts this detector
+  bool Accepts(MDDetector* D, int Type) const;
 
 
   // protected members:
@@ -45,6 +45,9 @@ class MDTriggerMap : public MDTrigger
   //! Default destructor
   virtual ~MDTriggerMap();
 
+  //! Return a copy of this trigger with its own event data
+  virtual MDTrigger* Clone() const { return new MDTriggerMap(*this); }
+
   //! Read the triggers for a trigger map
   bool ReadTriggerMap(MString FileName);
   //! Write the trigger map to a file
@@ -75,6 +78,10 @@ class MDTriggerMap : public MDTrigger
 
   //! Return true if this trigger applies to the detector
   virtual bool Applies(MDDetector* D) const;
+  //! Return true if AddHit would accept a hit in this detector
+  virtual bool AcceptsHit(MDDetector* D) const { return Applies(D); }
+  //! Return true if AddGuardRingHit would accept a hit in the guard ring of this detector
+  virtual bool AcceptsGuardRingHit(MDDetector* D) const;
 
   //! Returns true if the hit could be added 
   virtual bool AddHit(MDVolumeSequence& VS);
@@ -18,6 +18,8 @@
 
 // Standard libs:
 #include <vector>
+#include <cstdint>
+#include <unordered_map>
 using namespace std;
 
 // ROOT libs:
@@ -40,14 +42,20 @@ class MDTriggerUnit
  public:
   //! Standard constructor
   MDTriggerUnit(MDGeometry* Geometry);
+  //! Copy constructor: The copy evaluates its own copies of the geometry's triggers,
+  //! thus each thread (or other user) sharing one geometry can work on its own trigger unit
+  MDTriggerUnit(const MDTriggerUnit& TriggerUnit);
   //! Default destructor
   virtual ~MDTriggerUnit();
 
   //! Reset the stored event data - call before each new event
   void Reset();
   
-  //! Validate the trigger unit
-  bool Validate() const;
+  //! Validate the trigger unit and compile the trigger tables
+  bool Validate();
+  
+  //! Use the compiled trigger tables (default), or loop over all triggers for each hit and decision
+  void UseCompiledEvaluation(bool UseCompiled);
   
   //! Return true if this detector is never triggering
   bool IsNeverTriggering(MDDetector* D) const;
@@ -85,11 +93,25 @@ class MDTriggerUnit
   // protected methods:
  protected:
   //MDTriggerUnit() {};
-  //MDTriggerUnit(const MDTriggerUnit& DTriggerUnit) {};
 
   // private methods:
  private:
-
+  //! No assignment
+  MDTriggerUnit& operator=(const MDTriggerUnit&) = delete;
+  //! Return the trigger at position t - our own copy if we have one, otherwise the geometry's
+  MDTrigger* GetTriggerAt(unsigned int t) const;
+  //! Return the number of triggers
+  unsigned int GetNTriggers() const;
+  //! Build the detector -> affected-triggers tables and the trigger masks of an empty event
+  void Compile();
+  //! Return true if the compiled tables can be used
+  bool IsCompiled() const;
+  //! Mark the trigger as touched by the current event
+  void Touch(unsigned int t);
+  //! Evaluate the touched triggers and update the trigger masks
+  void Decide();
+  //! Return true if any bit in the mask is set
+  static bool Any(const vector<uint64_t>& Mask);
 
 
   // protected members:
@@ -100,6 +122,8 @@ class MDTriggerUnit
  private:
   //! The geometry
   MDGeometry* m_Geometry;
+  //! Our own copies of the geometry's triggers - empty if we use the ones of the geometry
+  vector<MDTrigger*> m_Triggers;
 
   //! If this DEBUGGING flag is set always assume we had a trigger 
   bool m_AlwaysAssumeTrigger;
@@ -111,6 +135,32 @@ class MDTriggerUnit
   //! Ignore thresholds, i.e. assume they are zero
   bool m_IgnoreThresholds;
 
+  //! Use the compiled tables
+  bool m_UseCompiledEvaluation;
+  //! True if the tables have been compiled
+  bool m_IsCompiled;
+  //! The number of triggers when the tables have been compiled
+  unsigned int m_NCompiledTriggers;
+  //! The indices of the triggers accepting a hit in the detector
+  unordered_map<MDDetector*, vector<unsigned int>> m_HitTriggers;
+  //! The indices of the triggers accepting a hit in the guard ring of the detector
+  unordered_map<MDDetector*, vector<unsigned int>> m_GuardRingHitTriggers;
+
+  //! Bit mask of the triggers which have triggered, non-vetoably triggered, vetoed without any hits
+  vector<uint64_t> m_EmptyTriggered;
+  vector<uint64_t> m_EmptyNonVetoablyTriggered;
+  vector<uint64_t> m_EmptyVetoed;
+  //! Bit mask of the triggers which have triggered, non-vetoably triggered, vetoed in the current event
+  vector<uint64_t> m_Triggered;
+  vector<uint64_t> m_NonVetoablyTriggered;
+  vector<uint64_t> m_Vetoed;
+  //! Bit mask of the triggers which received hits in the current event
+  vector<uint64_t> m_Touched;
+  //! The indices of the triggers which received hits in the current event
+  vector<unsigned int> m_TouchedTriggers;
+  //! True if the trigger masks are up to date with the added hits
+  bool m_IsDecided;
+
   // private members:
  private:
   friend ostream& operator<<(ostream& os, const MDTriggerUnit& T);
@@ -193,6 +193,10 @@ class MDVolume
   //! FILL the PATH lengths in the different materials between the positions start and stop
   //! The return value is for internal purposes only (volume (cm3) of the last volume)
   double GetAbsorptionLengths(map<MDMaterial*, double>& Lengths, MVector Start, MVector Stop);
+  //! ADD the PATH lengths in the different materials between the positions start and stop to the flat array,
+  //! which is indexed by the geometry index of the materials (MDMaterial::GetGeometryIndex()) 
+  //! The return value is for internal purposes only
+  double GetAbsorptionLengths(double* Lengths, const MVector& Start, const MVector& Stop);
   //! FILL the masses sorted by material
   //! The return value is for internal purposes only (volume (cm3) of the last volume)
   double GetMasses(map<MDMaterial*, double>& Materials);
@@ -239,6 +243,10 @@ class MDVolume
  protected:
   MDVolume* Clone(MString Name); // use only in remove virtual volume!!!!
 
+  //! Return the length of the path from start to stop (in this volumes coordinate system) inside the shape, ignoring the daughters
+  double GetPathLengthInShape(const MVector& Start, const MVector& Stop);
+  //! Warn if the daughters contain more path length than this volume
+  void CheckLengthInDaughters(const MVector& Start, const MVector& Stop, double Length, double LengthInDaughters);
 
 
   // private methods:
@@ -36,6 +36,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,7 +124,7 @@ void MDACS::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volume)
   if (m_NoiseActive == false) return;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -280,12 +281,12 @@ bool MDACS::IsVeto(const MVector& Position, const double Energy) const
   // if (m_NoiseActive == false) return;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     return false;
   }
 
   // Ignore if we are below threshold:
-  if (Energy < gRandom->Gaus(m_TriggerThreshold, m_TriggerThresholdSigma)) {
+  if (Energy < MDRandom::Get()->Gaus(m_TriggerThreshold, m_TriggerThresholdSigma)) {
     return false;
   }
 
@@ -35,6 +35,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,7 +204,7 @@ void MDAngerCamera::Noise(MVector& Pos, double& Energy, double& Time, MDVolume*
   if (m_NoiseActive == false) return;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -233,21 +234,21 @@ void MDAngerCamera::Noise(MVector& Pos, double& Energy, double& Time, MDVolume*
   do {
     if (m_PositionResolutionType == c_PositionResolutionXY) {
       // Randomly determine an angle:
-      double Angle = 2*c_Pi*gRandom->Rndm();
+      double Angle = 2*c_Pi*MDRandom::Get()->Rndm();
       NewPosition.SetXYZ(cos(Angle), sin(Angle), 0.0);
-      NewPosition *= gRandom->Gaus(0.0, m_PositionResolution.Evaluate(Energy));
+      NewPosition *= MDRandom::Get()->Gaus(0.0, m_PositionResolution.Evaluate(Energy));
       NewPosition += Pos;
     } else if (m_PositionResolutionType == c_PositionResolutionXYZ) {
       // Randomly determine an angle:
-      NewPosition.SetMagThetaPhi(gRandom->Gaus(0.0, m_PositionResolution.Evaluate(Energy)),
-                                 c_Pi*gRandom->Rndm(), 
-                                 2*c_Pi*gRandom->Rndm());
+      NewPosition.SetMagThetaPhi(MDRandom::Get()->Gaus(0.0, m_PositionResolution.Evaluate(Energy)),
+                                 c_Pi*MDRandom::Get()->Rndm(), 
+                                 2*c_Pi*MDRandom::Get()->Rndm());
       NewPosition += Pos;
     } else if (m_PositionResolutionType == c_PositionResolutionXYZIndependent) {
       // X, Y & Z axes are independently measured and independent Gaussians:
-      NewPosition.SetXYZ(gRandom->Gaus(0.0, m_PositionResolutionX.Evaluate(Energy)),
-                         gRandom->Gaus(0.0, m_PositionResolutionY.Evaluate(Energy)),
-                         gRandom->Gaus(0.0, m_PositionResolutionZ.Evaluate(Energy)));
+      NewPosition.SetXYZ(MDRandom::Get()->Gaus(0.0, m_PositionResolutionX.Evaluate(Energy)),
+                         MDRandom::Get()->Gaus(0.0, m_PositionResolutionY.Evaluate(Energy)),
+                         MDRandom::Get()->Gaus(0.0, m_PositionResolutionZ.Evaluate(Energy)));
       
       // Add the original position
       NewPosition += Pos;
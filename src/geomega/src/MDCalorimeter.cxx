@@ -37,6 +37,7 @@ using namespace std;
 #include "MStreams.h"
 #include "MAssert.h"
 #include "MDShapeBRIK.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -168,7 +169,7 @@ void MDCalorimeter::Noise(MVector& Pos, double& Energy, double& Time, MDVolume*
   bool IsOverflow = false;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -196,7 +197,7 @@ void MDCalorimeter::Noise(MVector& Pos, double& Energy, double& Time, MDVolume*
       int Trials = 5;
       double Sigma;
       do {
-        Sigma = gRandom->Gaus(m_DepthResolution.Evaluate(Energy), 
+        Sigma = MDRandom::Get()->Gaus(m_DepthResolution.Evaluate(Energy), 
                               m_DepthResolutionSigma.Evaluate(Energy));
         Trials--;
       } while (Sigma < 0 && Trials >= 0);
@@ -206,7 +207,7 @@ void MDCalorimeter::Noise(MVector& Pos, double& Energy, double& Time, MDVolume*
 
       Trials = 10;
       double z = numeric_limits<double>::max();      
-      z = gRandom->Gaus(Pos[2], Sigma);
+      z = MDRandom::Get()->Gaus(Pos[2], Sigma);
       if (z < -Size[2]) {
         z = -0.9999*Size[2];
       }
@@ -39,6 +39,7 @@ using namespace std;
 #include "MStreams.h"
 #include "MDShapeBRIK.h"
 #include "MDGuardRing.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -666,7 +667,7 @@ bool MDDetector::ApplyEnergyResolution(double& Energy, const MVector& Position)
     // do nothing
   } else if (m_EnergyResolutionType == c_EnergyResolutionTypeGauss) {
     Energy = GetEnergyResolutionPeak1(Energy, Position) + 
-      gRandom->Gaus(0.0, GetEnergyResolutionWidth1(Energy, Position));
+      MDRandom::Get()->Gaus(0.0, GetEnergyResolutionWidth1(Energy, Position));
 
   } else if (m_EnergyResolutionType == c_EnergyResolutionTypeLorentz) {
 
@@ -680,11 +681,11 @@ bool MDDetector::ApplyEnergyResolution(double& Energy, const MVector& Position)
 
     // sample the Lorentz distribution
     do {
-      E = gRandom->Rndm()*CutOff;
+      E = MDRandom::Get()->Rndm()*CutOff;
       Height = Width*Width/(Width*Width + E*E);
-    } while (gRandom->Rndm() > Height);
+    } while (MDRandom::Get()->Rndm() > Height);
 
-    if (gRandom->Rndm() >= 0.5) {
+    if (MDRandom::Get()->Rndm() >= 0.5) {
       Energy = Peak+E;
     } else {
       Energy = Peak-E;      
@@ -715,7 +716,7 @@ bool MDDetector::ApplyEnergyResolution(double& Energy, const MVector& Position)
     int Trials = 0;
     do {
       // x-value:
-      E = gRandom->Rndm()*(EMax - EMin) + EMin;
+      E = MDRandom::Get()->Rndm()*(EMax - EMin) + EMin;
       arg = (E - MeanGauss)/SigmaGauss;
       Random = 0.0;
       Random += ScalerGauss*TMath::Exp(-0.5*arg*arg); 
@@ -725,7 +726,7 @@ bool MDDetector::ApplyEnergyResolution(double& Energy, const MVector& Position)
         MeanGauss = 0;
         break;
       }
-    } while (Random < gRandom->Rndm()*Max);
+    } while (Random < MDRandom::Get()->Rndm()*Max);
     
     Energy = E;
     
@@ -765,7 +766,7 @@ bool MDDetector::ApplyTimeResolution(double& Time, const double Energy) const
   } else if (m_TimeResolutionType == c_TimeResolutionTypeIdeal) {
     // do nothing
   } else if (m_TimeResolutionType == c_TimeResolutionTypeGauss) {
-    Time = gRandom->Gaus(Time, GetTimeResolution(Energy));
+    Time = MDRandom::Get()->Gaus(Time, GetTimeResolution(Energy));
   } else {
     merr<<"Unknown time resolution type: "<<m_TimeResolutionType<<endl;
     return false;
@@ -786,9 +787,9 @@ bool MDDetector::ApplyNoiseThreshold(double& Energy, const MVector& Position) co
   
   if (m_NoiseThresholdEqualsTriggerThreshold == true) {
     // If the flag is set no own noise threshold is given...
-    NoiseThreshold = gRandom->Gaus(GetTriggerThreshold(Position), m_TriggerThresholdSigma);
+    NoiseThreshold = MDRandom::Get()->Gaus(GetTriggerThreshold(Position), m_TriggerThresholdSigma);
   } else {
-    NoiseThreshold = gRandom->Gaus(GetNoiseThreshold(Position), m_NoiseThresholdSigma);
+    NoiseThreshold = MDRandom::Get()->Gaus(GetNoiseThreshold(Position), m_NoiseThresholdSigma);
   }
 
   if (Energy < NoiseThreshold) {
@@ -807,7 +808,7 @@ bool MDDetector::ApplyOverflow(double& Energy) const
 {
   // Test if the energy is in the overflow and apply it     
 
-  double Overflow = gRandom->Gaus(m_Overflow, m_OverflowSigma);
+  double Overflow = MDRandom::Get()->Gaus(m_Overflow, m_OverflowSigma);
 
   if (Energy > Overflow) {
     Energy = Overflow;
@@ -839,7 +840,7 @@ bool MDDetector::IsAboveTriggerThreshold(const double& Energy, const MDGridPoint
 
   // If you change anything here, make sure to change GetSecureUpperLimitTriggerThreshold !!!!
   double NoisedThreshold = 
-    gRandom->Gaus(GetTriggerThreshold(MVector(0.0, 0.0, Point.GetPosition().Z())), 
+    MDRandom::Get()->Gaus(GetTriggerThreshold(MVector(0.0, 0.0, Point.GetPosition().Z())), 
                   m_TriggerThresholdSigma);
 
   if (Energy > NoisedThreshold) {
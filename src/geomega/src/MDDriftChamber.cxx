@@ -35,6 +35,7 @@ using namespace std;
 
 // MEGAlib libs:
 #include "MAssert.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -192,7 +193,7 @@ bool MDDriftChamber::NoiseLightEnergy(double& Energy) const
   if (m_LightEnergyResolutionType == c_LightEnergyResolutionTypeIdeal) {
     // do nothing
   } else if (m_LightEnergyResolutionType == c_LightEnergyResolutionTypeGauss) {
-    Energy = gRandom->Gaus(Energy, GetLightEnergyResolution(Energy));
+    Energy = MDRandom::Get()->Gaus(Energy, GetLightEnergyResolution(Energy));
   } else {
     mout<<"   ***  Error  ***  in detector "<<m_Name<<endl;
     mout<<"Unknown light energy resolution type: "<<m_LightEnergyResolutionType<<endl;
@@ -282,13 +283,13 @@ vector<MDGridPoint> MDDriftChamber::Discretize(const MVector& PosInDetectorVolum
     // Randomize x, y position:
 
     // Original but much too narrow distribution:
-    // DriftRadius = gRandom->Gaus(0, DriftRadiusSigma);
-    // DriftAngle = gRandom->Rndm() * c_Pi;
+    // DriftRadius = MDRandom::Get()->Gaus(0, DriftRadiusSigma);
+    // DriftAngle = MDRandom::Get()->Rndm() * c_Pi;
     // DriftX = DriftRadius*cos(DriftAngle);
     // DriftY = DriftRadius*sin(DriftAngle);
 
     // Real 2D Gaussian ("Rannor" gives 1 sigma distributions):
-    gRandom->Rannor(DriftX, DriftY);
+    MDRandom::Get()->Rannor(DriftX, DriftY);
     DriftX *= DriftRadiusSigma;
     DriftY *= DriftRadiusSigma;
 
@@ -35,6 +35,8 @@
 #include <cctype>
 #include <cmath>
 #include <iterator>
+#include <cstdint>
+#include <cstdio>
 using namespace std;
 
 // ROOT libs:
@@ -100,6 +102,13 @@ ClassImp(MDGeometry)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MDGeometry::s_UseCache = true;
+MString MDGeometry::s_CacheDirectory = "";
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 MDGeometry::MDGeometry()
 {
   // default constructor
@@ -123,9 +132,6 @@ MDGeometry::MDGeometry()
   m_GeoView = 0;
   m_Geometry = 0;
 
-  m_LastVolumes.clear();
-  m_LastVolumePosition = 0;
-
   m_TriggerUnit = new MDTriggerUnit(this);
   m_System = new MDSystem("NoName");
 
@@ -284,8 +290,13 @@ void MDGeometry::Reset()
   m_ComplexER = true;
   m_VirtualizeNonDetectorVolumes = false;
 
-  m_LastVolumes.clear();
-  m_LastVolumePosition = 0;
+  m_VolumeIndex.clear();
+  m_MaterialIndex.clear();
+  m_DetectorIndex.clear();
+  m_ShapeIndex.clear();
+  m_OrientationIndex.clear();
+  m_TriggerIndex.clear();
+  m_VectorIndex.clear();
 
   m_DetectorSearchTolerance = 0.000001;
 
@@ -327,8 +338,6 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
   //  mout<<"Loading geometry file: "<<FileName<<endl;
   //}
 
-  bool DebugParsing = false;
-  
   int Stage = 0;
   MTimer Timer;
   double TimeLimit = 0;
@@ -379,7 +388,6 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
   MDDetector* D = 0;
   MDTrigger* T = 0;
   MDSystem* S = 0;
-  MDVector* Vector = 0;
   MDShape* Shape = 0;
   MDOrientation* Orientation = 0;
 
@@ -389,800 +397,350 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
 
   // Since the geometry-file can include other geometry files,
   // we have to store the whole file in memory
+  // If the preprocessed content of exactly these files has been cached, we start from there
 
   list<MDDebugInfo> FileContent;
-  if (AddFile(m_FileName, FileContent) == false) {
-    mout<<"   *** Error reading included files. Aborting!"<<endl;
-    return false;
-  }
-
-  // Now scan the data and search for "Include" files and add them
-  // to the original stored file content
-
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
-    if (Tokenizer.GetNTokens() == 0) {
-      continue;
+  bool UseCache = IsCacheUsed();
+  if (UseCache == true && ReadCache(FileContent, FoundDeprecated) == true) {
+    Stage = c_NPreprocessingStages;
+    if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+      mout<<"Stage "<<Stage<<" (reading the preprocessed geometry from the cache "<<GetCacheFileName()<<") finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
     }
-    
-    if (Tokenizer.IsTokenAt(0, "Include") == true) {
-      
-      // Test for old material path
-      if (Tokenizer.GetTokenAt(1).EndsWith("resource/geometries/materials/Materials.geo") == true) {
-        mout<<" *** Deprectiated *** "<<endl;
-        mout<<"You are using the old MEGAlib material path:"<<endl;
-        mout<<m_DebugInfo.GetText()<<endl;
-        mout<<"Please update to the new path now!"<<endl;
-        mout<<"Change: resource/geometries To: resource/examples/geomega "<<endl;
-        mout<<endl;
-        FoundDeprecated = true;
-      }
-      
-      MString FileName = Tokenizer.GetTokenAt(1);
-      if (MFile::ExpandFileName(FileName, m_FileName) == false) {
-        Typo("Unable to expand file name");
-        return false;
-      }
-      
-      if (MFile::Exists(FileName) == false) {
-        mout<<"   *** Error finding file "<<FileName<<endl;
-        Typo("File IO error");
-        return false;
-      }
-      
-      list<MDDebugInfo> AddFileContent;
-      if (AddFile(FileName, AddFileContent) == false) {
-        mout<<"   *** Error reading file "<<FileName<<endl;
-        Typo("File IO error");
-        return false;
-      }
-      
-      (*ContentIter).SetText("");
-      auto BackToStartIter = ContentIter;
-      for (auto AddIter = AddFileContent.begin(); AddIter != AddFileContent.end(); ++AddIter) {
-        ContentIter = FileContent.insert(next(ContentIter), (*AddIter));
-      }
-      ContentIter = BackToStartIter;
+  } else {
+    if (PreprocessSetupFile(FileContent, FoundDeprecated, Stage, Timer) == false) {
+      return false;
     }
-    
-    if (Tokenizer.IsTokenAt(0, "Import") == true) {
-      
-      if (Tokenizer.GetNTokens() != 3) {
-        Typo("Line must contain three entries, e.g. \"Import GDML MyGDML.gdml\"");
-        return false;
-      }
-      
-      if (Tokenizer.IsTokenAt(1, "GDML") == true) {
-        MString FileName = Tokenizer.GetTokenAt(2);
-        if (MFile::ExpandFileName(FileName, m_FileName) == false) {
-          mout<<"   *** Error expanding file "<<FileName<<endl;
-          Typo("Unable to expand file name");
-          return false;
-        }
-      
-        if (MFile::Exists(FileName) == false) {
-          mout<<"   *** Error finding file "<<FileName<<endl;
-          Typo("File IO error");
-          return false;
-        }
-      
-        list<MDDebugInfo> AddFileContent;
-        if (ImportGDML(FileName, AddFileContent) == false) {
-          mout<<"   *** Error reading file "<<FileName<<endl;
-          Typo("File IO error");
-          return false;
-        }
-      
-        (*ContentIter).SetText("");
-        auto BackToStartIter = ContentIter;
-        for (auto AddIter = AddFileContent.begin(); AddIter != AddFileContent.end(); ++AddIter) {
-          ContentIter = FileContent.insert(next(ContentIter), (*AddIter));
-        }
-        ContentIter = BackToStartIter;
-      } else {
-        mout<<"   *** Error unknown import file type "<<Tokenizer.GetTokenAt(1)<<endl;
-        Typo("Import error");
-      }
+    if (UseCache == true) {
+      WriteCache(FileContent, FoundDeprecated);
     }
-    
-  }
-
-  if (FileContent.size() == 0) {
-    mgui<<"File is \""<<m_FileName<<"\" empty or binary!"<<error;
-    return false;
   }
   
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (reading of file(s)) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
   
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file reading *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
-    }
-  }
   
-
-
-  // Find lines which are continued in a second line by the "\\" keyword
-
+  // All constants and for loops are expanded, let's print some text ;-)
   for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
     m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
+    if ((*ContentIter).IsTokenizerValid() == false) {
+      Typo("Parsing of the line failed.");
+      return false;
+    }
+        
     if (Tokenizer.GetNTokens() == 0) continue;
 
-    // Of course the real token is "\\"
-    if (Tokenizer.IsTokenAt(Tokenizer.GetNTokens()-1, "\\\\") == true) {
-      //cout<<"Found \\\\: "<<Tokenizer.ToString()<<endl;
-      // Prepend this text to the next line
-      if (next(ContentIter, 1) != FileContent.end()) {
-        //cout<<"Next: "<<FileContent[i+1].GetText()<<endl;
-        MString Prepend = "";
-        for (unsigned int t = 0; t < Tokenizer.GetNTokens()-1; ++t) {
-          Prepend += Tokenizer.GetTokenAt(t);
-          Prepend += " ";
-        }
-        (*(next(ContentIter, 1))).Prepend(Prepend);
-        (*ContentIter).SetText("");
+    if (Tokenizer.IsTokenAt(0, "Print") == true ||
+        Tokenizer.IsTokenAt(0, "Echo") == true) {
+      if (Tokenizer.GetNTokens() < 2) {
+        Typo("Line must contain at least two entries, e.g. \"Print Me!\"");
+        return false;
+      }
+
+      //mout<<"   *** User Info start ***"<<endl;
+      mout<<"   *** User Info: ";
+      for (unsigned int t = 1; t < Tokenizer.GetNTokens(); ++t) {
+        mout<<Tokenizer.GetTokenAt(t)<<"  ";
       }
+      mout<<endl;
+      //mout<<"   *** User Info end ***"<<endl;
     }
   }
 
 
-
-  // Find constants
+  // First loop:
+  // Find the master keyword, volumes, material, detectors
   //
 
   for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
     m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
+    if ((*ContentIter).IsTokenizerValid() == false) {
+      Typo("Parsing of the line failed.");
+      return false;
+    }
+       
     if (Tokenizer.GetNTokens() == 0) continue;
 
-    // Constants
-    if (Tokenizer.IsTokenAt(0, "Constant") == true) {
-      if (Tokenizer.GetNTokens() != 3) {
-        Typo("Line must contain three entries, e.g. \"Constant Distance 10.5\"");
-        return false;
-      }
-      if (Tokenizer.GetTokenAt(1) == Tokenizer.GetTokenAt(2)) {
-        Typo("The constant name and replacement are identical!");
-        return false;
-      }
-      vector<MString>::iterator VIter = find(m_BlockedConstants.begin(), m_BlockedConstants.end(), Tokenizer.GetTokenAt(1));
-      if (VIter != m_BlockedConstants.end()) {
-        Typo("Constant has a reserved name, and thus cannot be used!");
+    // Let's scan for first order keywords:
+    // Here we have:
+    // - Name
+    // - Version
+    // - Material
+    // - Volume
+    // - Detector
+    // - Trigger
+    // - System
+    // - Vector
+    // - Shape
+    // - Orientation
+
+    // Volume (Most frequent, so start with this one)
+    if (Tokenizer.IsTokenAt(0, "Volume") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Volume D1Main\"");
         return false;
       }
-      map<MString, MString>::iterator Iter = m_ConstantMap.find(Tokenizer.GetTokenAt(1));
-      if (Iter != m_ConstantMap.end()) {
-        if (m_ConstantMap[Tokenizer.GetTokenAt(1)] != Tokenizer.GetTokenAt(2)) {
-          Typo("Constant has already been defined and both are not identical!");
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
           return false;
         }
       }
-      m_ConstantMap[Tokenizer.GetTokenAt(1)] = Tokenizer.GetTokenAt(2);
-      m_ConstantList.push_back(Tokenizer.GetTokenAt(1));
+
+      AddVolume(new MDVolume(Tokenizer.GetTokenAt(1)));
+      continue;
     }
-  }
 
-  // Take care of maths and constants containing constants, containing constants...
-  bool ConstantChanged = true;
-  while (ConstantChanged == true) {
-    // Step 1: Solve maths:
-    for (map<MString, MString>::iterator Iter1 = m_ConstantMap.begin();
-         Iter1 != m_ConstantMap.end();
-         ++Iter1) {
-      if (MTokenizer::IsMaths((*Iter1).second) == true) {
-        bool ContainsConstant = false;
-        for (map<MString, MString>::iterator Iter2 = m_ConstantMap.begin();
-             Iter2 != m_ConstantMap.end();
-             ++Iter2) {
-          if (ContainsReplacableConstant((*Iter1).second, (*Iter2).first) == true) {
-            ContainsConstant = true;
-            //cout<<"Replaceable constant: "<<(*Iter1).second<<" (namely:"<<(*Iter2).first<<")"<<endl;
-            break;
-          } else {
-            //cout<<"No replaceable constant: "<<(*Iter1).second<<" (test:"<<(*Iter2).first<<")"<<endl;
-          }
-        }
-        if (ContainsConstant == false) {
-          MString Constant = (*Iter1).second;
-          if ( MTokenizer::CheckMaths(Constant) == false) {
-            mout<<"   *** Error ***"<<endl;
-            mout<<"Maths in constant cannot be evaluated: "<<(*Iter1).first<<" "<<Constant<<endl;
-            return false;
-          }
-          MTokenizer::EvaluateMaths(Constant);
-          (*Iter1).second = Constant;
-        }
+    // Name
+    else if (Tokenizer.IsTokenAt(0, "Name") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Name MEGA\"");
+        return false;
       }
+      m_Name = Tokenizer.GetTokenAt(1);
+      m_Geometry->SetNameTitle(m_Name, "A Geomega geometry");
+      continue;
     }
 
-    // Step 2: Replace constants in constants
-    bool ConstantChangableWithMath = false;
-    ConstantChanged = false;
-    for (map<MString, MString>::iterator Iter1 = m_ConstantMap.begin(); Iter1 != m_ConstantMap.end(); ++Iter1) {
-      //cout<<"Checking for replacement: "<<(*Iter1).first<<" with "<<(*Iter1).second<<endl;
-      for (map<MString, MString>::iterator Iter2 = m_ConstantMap.begin(); Iter2 != m_ConstantMap.end(); ++Iter2) {
-        //cout<<"Map size: "<<m_ConstantMap.size()<<endl;
-        if (ContainsReplacableConstant((*Iter1).second, (*Iter2).first) == true) {
-          //cout<<"   ---> "<<(*Iter2).first<<" - "<<(*Iter2).second<<endl;
-          //cout<<(*Iter1).second<<" contains "<<(*Iter2).first<<endl;
-          if (MTokenizer::IsMaths((*Iter2).second) == false) {
-            MString Constant = (*Iter1).second;
-            ReplaceWholeWords(Constant, (*Iter2).first, (*Iter2).second);
-            (*Iter1).second = Constant;
-            ConstantChanged = true;
-          } else {
-            ConstantChangableWithMath = true;
-          }
-        }
+    // Version
+    else if (Tokenizer.IsTokenAt(0, "Version") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Version 1.1.123\"");
+        return false;
       }
+      m_Version = Tokenizer.GetTokenAt(1);
+      continue;
     }
 
-    if (ConstantChanged == false &&  ConstantChangableWithMath == true) {
-      mout<<"   *** Error ***"<<endl;
-      mout<<"Recursively defined constant found!"<<endl;
-      return false;
-    }
-  }
+    // Surrounding sphere
+    else if (Tokenizer.IsTokenAt(0, "SurroundingSphere") == true) {
+      if (FoundSurroundingSphere == true) {
+        Typo("You have multiple surrounding spheres defined in your code. The ones read later overwrite the original one. This is too error prone to be allowed.");
+        return false;
+      }
 
-  // Do the final replace:
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
-    if (Tokenizer.GetNTokens() == 0) continue;
+      if (Tokenizer.GetNTokens() != 6) {
+        Typo("Line must contain five values: Radius, xPos, yPos, zPos of sphere center, Distance to sphere center");
+        return false;
+      }
+
+      m_SurroundingSphereRadius = Tokenizer.GetTokenAtAsDouble(1);
+      m_SurroundingSpherePosition = MVector(Tokenizer.GetTokenAtAsDouble(2),
+                                 Tokenizer.GetTokenAtAsDouble(3),
+                                 Tokenizer.GetTokenAtAsDouble(4));
+      m_SurroundingSphereDistance = Tokenizer.GetTokenAtAsDouble(5);
+
+      if (m_SurroundingSphereRadius != m_SurroundingSphereDistance) {
+        Typo("Limitation: Concerning your surrounding sphere: The sphere radius must equal the distance to the sphere for the time being. Sorry.");
+        return false;
+      }
+
+      FoundSurroundingSphere = true;
 
-    MString Init = Tokenizer.GetTokenAt(0);
-    if (Init == "Volume" ||
-      Init == "Material" ||
-      Init == "Trigger" ||
-      Init == "TriggerBasic" ||
-      Init == "TriggerMap" ||
-      Init == "System" ||
-      Init == "Strip2D" ||
-      Init == "MDStrip2D" ||
-      Init == "Strip3D" ||
-      Init == "MDStrip3D" ||
-      Init == "Strip3DDirectional" ||
-      Init == "MDStrip3DDirectional" ||
-      Init == "DriftChamber" ||
-      Init == "MDDriftChamber" ||
-      Init == "AngerCamera" ||
-      Init == "MDAngerCamera" ||
-      Init == "Simple" ||
-      Init == "Scintillator" ||
-      Init == "ACS" ||
-      Init == "MDACS" ||
-      Init == "Calorimeter" ||
-      Init == "MDCalorimeter" ||
-      Init == "Voxel3D" ||
-      Init == "MDVoxel3D") {
       continue;
     }
 
-    for (map<MString, MString>::iterator Iter = m_ConstantMap.begin();
-         Iter != m_ConstantMap.end(); ++Iter) {
-      (*ContentIter).Replace((*Iter).first, (*Iter).second, true);
-    }
-  }
+    // Show the surrounding sphere
+    else if (Tokenizer.IsTokenAt(0, "ShowSurroundingSphere") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: ShowSurroundingSphere true/false");
+        return false;
+      }
 
+      m_SurroundingSphereShow = Tokenizer.GetTokenAtAsBoolean(1);
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (evaluating constants and maths) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-  
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file evaluating constants and maths *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
+      continue;
     }
-  }
-  
-
-  // Check for Vectors FIRST since those are used in ForVector loops...
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
-    if (Tokenizer.GetNTokens() == 0) continue;
 
-    if (Tokenizer.IsTokenAt(0, "Vector") == true) {
+    // Show volumes
+    else if (Tokenizer.IsTokenAt(0, "ShowVolumes") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Vector MyMatrix\"");
+        Typo("Line must contain two values: ShowVolumes false");
         return false;
       }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
 
-      AddVector(new MDVector(Tokenizer.GetTokenAt(1)));
+      m_ShowVolumes = Tokenizer.GetTokenAtAsBoolean(1);
+
       continue;
     }
-  }
-  
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
-    if (Tokenizer.GetNTokens() == 0) continue;
-
-    if ((Vector = GetVector(Tokenizer.GetTokenAt(0))) != 0) {
-      MTokenizer& Tokenizer2 = m_DebugInfo.GetTokenizer(true);  // Let's do some maths
 
-      if (Tokenizer2.IsTokenAt(1, "Matrix") == true) {
-        // We need at least 9 keywords:
-        if (Tokenizer2.GetNTokens() < 9) {
-          Typo("Vector.Matrix must contain at least nine keywords,"
-               " e.g. \"MaskMatrix.Matrix  3 1.0  3 1.0  1 0.0  1 0 1 0 1 0 1 0 1\"");
-          return false;
-        }
-        unsigned int x_max = Tokenizer2.GetTokenAtAsUnsignedInt(2);
-        unsigned int y_max = Tokenizer2.GetTokenAtAsUnsignedInt(4);
-        unsigned int z_max = Tokenizer2.GetTokenAtAsUnsignedInt(6);
-        double dx = Tokenizer2.GetTokenAtAsDouble(3);
-        double dy = Tokenizer2.GetTokenAtAsDouble(5);
-        double dz = Tokenizer2.GetTokenAtAsDouble(7);
+    // Show volumes
+    else if (Tokenizer.IsTokenAt(0, "ShowOnlySensitiveVolumes") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: ShowOnlySensitiveVolumes false");
+        return false;
+      }
 
-        // Now we know the real number of keywords:
-        if (Tokenizer2.GetNTokens() != 8+x_max*y_max*z_max) {
-          Typo("This version of Vector.Matrix does not contain the right amount of numbers\"");
-          return false;
-        }
+      ShowOnlySensitiveVolumes = Tokenizer.GetTokenAtAsBoolean(1);
 
-        for (unsigned int z = 0; z < z_max; ++z) {
-          for (unsigned int y = 0; y < y_max; ++y) {
-            for (unsigned int x = 0; x < x_max; ++x) {
-              Vector->Add(MVector(x*dx, y*dy, z*dz), Tokenizer2.GetTokenAtAsDouble(8 + x + y*x_max + z*x_max*y_max));
-            }
-          }
-        }
+      continue;
+    }
 
-      } else {
-        Typo("Unrecognized vector option");
+    // Do Sanity checks
+    else if (Tokenizer.IsTokenAt(0, "DoSanityChecks") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: DoSanityChecks false");
         return false;
       }
-    }
-  }
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (evaluating vectors) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-  
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file evaluating vectors *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
-    }
-  }
-  
-  // Check for "For"-loops as well as the special "ForVector"-loop
-  int ForDepth = 0;
-  int CurrentDepth = 0;
-  
-  
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); /* ++ContentIter erase */) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      m_DoSanityChecks = Tokenizer.GetTokenAtAsBoolean(1);
 
-    if (Tokenizer.GetNTokens() == 0) {
-      ++ContentIter;
       continue;
     }
 
-    // For
-    auto BackToStartIter = ContentIter;
-    if (Tokenizer.IsTokenAt(0, "For") == true || Tokenizer.IsTokenAt(0, "for") == true) {
-      MTokenizer& TokenizerMaths = m_DebugInfo.GetTokenizer(true); // redo for math's evaluation just here
-
-      CurrentDepth = ForDepth;
-      ForDepth++;
-      if (TokenizerMaths.GetNTokens() != 5) {
-        Typo("Line must contain five entries, e.g. \"For I 3 -11.0 11.0\"");
+    // Virtualize all non detector volumes
+    else if (Tokenizer.IsTokenAt(0, "VirtualizeNonDetectorVolumes") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: VirtualizeNonDetectorVolumes false");
         return false;
       }
 
-      MString Index = TokenizerMaths.GetTokenAt(1);
-      if (TokenizerMaths.GetTokenAtAsInt(2) < 0 || TokenizerMaths.GetTokenAtAsInt(2) != TokenizerMaths.GetTokenAtAsDouble(2) || std::isnan(TokenizerMaths.GetTokenAtAsDouble(2))) { // std:: is required
-        Typo("Loop number in for loop must be a positive integer");
+      m_VirtualizeNonDetectorVolumes = Tokenizer.GetTokenAtAsBoolean(1);
+
+      continue;
+    }
+
+    // Complex event reconstruction
+    else if (Tokenizer.IsTokenAt(0, "ComplexER") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: ComplexER false");
         return false;
       }
-      unsigned int Loops = TokenizerMaths.GetTokenAtAsUnsignedInt(2);
-      double Start = TokenizerMaths.GetTokenAtAsDouble(3);
-      double Step = TokenizerMaths.GetTokenAtAsDouble(4);
 
-      // Erase the for line
-      (*ContentIter).SetText("");
+      m_ComplexER = Tokenizer.GetTokenAtAsBoolean(1);
 
-      // Store content of for loop:
-      list<MDDebugInfo> ForLoopContent;
-      for (; ContentIter != FileContent.end(); /* ++ContentIter erase */) {
-        m_DebugInfo = (*ContentIter);
-        MTokenizer& TokenizerFor = (*ContentIter).GetTokenizer(false);
+      continue;
+    }
 
-        if (TokenizerFor.GetNTokens() == 0) {
-          ContentIter++;
-          continue;
-        }
-        if (TokenizerFor.IsTokenAt(0, "For") == true || TokenizerFor.IsTokenAt(0, "for") == true) {
-          ForDepth++;
-        }
-        if (TokenizerFor.IsTokenAt(0, "Done") == true || TokenizerFor.IsTokenAt(0, "done") == true) {
-          ForDepth--;
-          if (ForDepth == CurrentDepth) {
-            (*ContentIter).SetText("");
-            break;
-          }
-        }
-
-        ForLoopContent.push_back(m_DebugInfo);
-        (*ContentIter).SetText("");
-      }
+    // Ignore short names
+    else if (Tokenizer.IsTokenAt(0, "IgnoreShortNames") == true) {
+      mout<<" *** Outdated *** "<<endl;
+      mout<<"The \"IgnoreShortNames\" keyword is no longer supported!"<<endl;
 
-      // Add new content at the same place:
-      list<MDDebugInfo>::iterator LastIter = ContentIter;
-      int Position = 0;
-      for (unsigned int l = 1; l <= Loops; ++l) {
-        MString LoopString;
-        LoopString += l;
-        MString ValueString;
-        ValueString += (Start + (l-1)*Step);
+      continue;
+    }
 
+    // Default color
+    else if (Tokenizer.IsTokenAt(0, "DefaultColor") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: DefaultColor  3");
+        return false;
+      }
 
-        list<MDDebugInfo>::iterator ForIter;
-        for (ForIter = ForLoopContent.begin();
-             ForIter != ForLoopContent.end();
-             ++ForIter) {
-          m_DebugInfo = (*ForIter);
-          m_DebugInfo.Replace(MString("%") + Index, LoopString);
-          m_DebugInfo.Replace(MString("$") + Index, ValueString);
+      m_DefaultColor = Tokenizer.GetTokenAtAsInt(1);
 
-          LastIter = FileContent.insert(next(LastIter), m_DebugInfo);
-          Position++;
-        }
-      }
-      ContentIter = BackToStartIter; // Multiple fors -- have to go back where we started
-            
       continue;
     }
 
-    // ForVector
-    BackToStartIter = ContentIter;
-    if (Tokenizer.IsTokenAt(0, "ForVector") == true) {
+    // Detector search tolerance
+    else if (Tokenizer.IsTokenAt(0, "DetectorSearchTolerance") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: DetectorSearchTolerance 0.000001");
+        return false;
+      }
 
-      // Take care of nesting
-      CurrentDepth = ForDepth;
-      ForDepth++;
+      m_DetectorSearchTolerance = Tokenizer.GetTokenAtAsDouble(1);
 
+      continue;
+    }
 
-      if (Tokenizer.GetNTokens() != 6) {
-        Typo("The ForVector-line must contain six entries, e.g. \"ForVector MyVector X Y Z V\"");
+    // General absorption file directory
+    else if (Tokenizer.IsTokenAt(0, "AbsorptionFileDirectory") == true ||
+             Tokenizer.IsTokenAt(0, "CrossSectionFilesDirectory") == true ||
+             Tokenizer.IsTokenAt(0, "CrossSectionPath") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two values: CrossSectionPath auxiliary");
         return false;
       }
 
-      // Retrieve data:
-      Vector = GetVector(Tokenizer.GetTokenAt(1));
-      if (Vector == 0) {
-        Typo("ForVector-line: cannot find vector\"");
+      // We have to use TString
+      MString Name = Tokenizer.GetTokenAtAsString(1).Data();
+      if (MFile::ExpandFileName(Name) == false) {
+        Typo("Unable to expand file name");
         return false;
       }
 
-      MString XIndex = Tokenizer.GetTokenAt(2);
-      MString YIndex = Tokenizer.GetTokenAt(3);
-      MString ZIndex = Tokenizer.GetTokenAt(4);
-      MString VIndex = Tokenizer.GetTokenAt(5);
-
-      // Erase the for line
-      (*ContentIter).SetText("");
-      
-      // Store content of ForVector loop:
-      list<MDDebugInfo> ForLoopContent;
-      for (; ContentIter != FileContent.end(); /* ++ContentIter erase */) {
-        m_DebugInfo = (*ContentIter);
-        MTokenizer& TokenizerFor = m_DebugInfo.GetTokenizer(false);
+      if (gSystem->IsAbsoluteFileName(Name) == false) {
+        Name.Prepend("/");
+        Name.Prepend(MFile::GetDirectoryName(m_FileName));
 
-        if (TokenizerFor.GetNTokens() == 0) {
-          ContentIter++;
-          continue;
-        }
-        if (TokenizerFor.IsTokenAt(0, "ForVector") == true) {
-          ForDepth++;
-        }
-        if (TokenizerFor.IsTokenAt(0, "DoneVector") == true) {
-          ForDepth--;
-          if (ForDepth == CurrentDepth) {
-            (*ContentIter).SetText("");
-            break;
-          }
+        if (MFile::ExpandFileName(Name) == false) {
+          Typo("Unable to expand cross-section path to absolute path");
+          return false;
         }
-
-        ForLoopContent.push_back(m_DebugInfo);
-        (*ContentIter).SetText("");
       }
 
-      // Add new content at the same place:
-      list<MDDebugInfo>::iterator LastIter = ContentIter;
-      int Position = 0;
-      for (unsigned int l = 1; l <= Vector->GetSize(); ++l) {
-        //cout<<"Vector loc: "<<l<<endl;
-        
-        MString LoopString;
-        LoopString += l;
-        MString XValueString;
-        XValueString += Vector->GetPosition(l-1).X();
-        MString YValueString;
-        YValueString += Vector->GetPosition(l-1).Y();
-        MString ZValueString;
-        ZValueString += Vector->GetPosition(l-1).Z();
-        MString ValueString;
-        ValueString += Vector->GetValue(l-1);
+      m_CrossSectionFileDirectory = Name;
 
-        list<MDDebugInfo>::iterator ForIter;
-        for (ForIter = ForLoopContent.begin();
-             ForIter != ForLoopContent.end();
-             ++ForIter) {
-          m_DebugInfo = (*ForIter);
-          m_DebugInfo.Replace(MString("%") + XIndex, LoopString);
-          m_DebugInfo.Replace(MString("$") + XIndex, XValueString);
-          m_DebugInfo.Replace(MString("%") + YIndex, LoopString);
-          m_DebugInfo.Replace(MString("$") + YIndex, YValueString);
-          m_DebugInfo.Replace(MString("%") + ZIndex, LoopString);
-          m_DebugInfo.Replace(MString("$") + ZIndex, ZValueString);
-          m_DebugInfo.Replace(MString("%") + VIndex, LoopString);
-          m_DebugInfo.Replace(MString("$") + VIndex, ValueString);
+      continue;
+    }
 
-          LastIter = FileContent.insert(next(LastIter), m_DebugInfo);
-          Position++;
+    // Material
+    else if (Tokenizer.IsTokenAt(0, "Material") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Material Aluminimum\"");
+        return false;
+      }
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
         }
       }
-      ContentIter = BackToStartIter;
-      continue;
-    }
-    ++ContentIter;
-  }
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (evaluating for loops) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-  
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file evaluating for loops *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
+      AddMaterial(new MDMaterial(Tokenizer.GetTokenAt(1)));
+      continue;
     }
-  }
-  
 
-  // Find random numbers
-  TRandom3 R;
-  R.SetSeed(11031879); // Do never modify!!!!
-  
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    while ((*ContentIter).Contains("RandomDouble") == true) {
-      //cout<<"Before: "<<(*ContentIter).GetText()<<endl;
-      (*ContentIter).ReplaceFirst("RandomDouble", R.Rndm());
-      //cout<<"after: "<<(*ContentIter).GetText()<<endl;
-    }
-  }
+    // Shape
+    else if (Tokenizer.IsTokenAt(0, "Shape") == true) {
+      if (Tokenizer.GetNTokens() != 3) {
+        Typo("Line must contain three strings, e.g. \"Shape BOX RedBox\"");
+        return false;
+      }
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(2)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(2)) == true) {
+          return false;
+        }
+      }
 
+      AddShape(Tokenizer.GetTokenAt(1), Tokenizer.GetTokenAt(2));
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (evaluating random numbers) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-  
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file evaluating random numbers *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
-    }
-  }
-  
-    
-  // Do a final maths check:
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-    
-    if (Tokenizer.CheckAllMaths() == false) {
-      Typo("Cannot parse maths -- typo or unsupported maths function.");
-      return false;
-    }
-  }
-  
-  // Check for "If"-clauses
-  int IfDepth = 0;
-  int ElseDepth = 0;
-  int CurrentIfDepth = 0;
-  bool InsideElse = false;
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
-    if ((*ContentIter).IsTokenizerValid() == false) {
-      Typo("Parsing of the line failed.");
-      return false;
-    }
-   
-    if (Tokenizer.GetNTokens() == 0) {
       continue;
     }
 
-    if (Tokenizer.IsTokenAt(0, "If") == true) {
-
-      // Take care of nesting
-      CurrentIfDepth = IfDepth;
-      IfDepth++;
 
-      // Take care of else
-      InsideElse = false;
-      
+    // Orientation
+    else if (Tokenizer.IsTokenAt(0, "Orientation") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("The If-line must contain two entries, the last one must be math, e.g. \"If { 1 == 2 } or If { $Value > 0 } \"");
+        Typo("Line must contain two strings, e.g. \"Orientation RedBoxOrientation\"");
         return false;
       }
-
-      // Retrieve data:
-      bool IfStatement = Tokenizer.GetTokenAtAsBoolean(1);
-
-      // Clear the if line
-      //cout<<"Erasing (if): "<<(*ContentIter).GetText()<<endl;
-      (*ContentIter).SetText("");
-
-      // Forward its endif:
-      for (auto NewContentIter = next(ContentIter, 1); NewContentIter != FileContent.end(); ++NewContentIter) {
-        MTokenizer& TokenizerIf = (*NewContentIter).GetTokenizer(false);
-        if (TokenizerIf.GetNTokens() == 0) {
-          continue;
-        }
-        if (TokenizerIf.IsTokenAt(0, "If") == true || TokenizerIf.IsTokenAt(0, "if") == true) {
-          IfDepth++;
-        }
-        if (TokenizerIf.IsTokenAt(0, "Else") == true || TokenizerIf.IsTokenAt(0, "else") == true) {
-          InsideElse = true;
-          ElseDepth++;
-          if (IfDepth == CurrentIfDepth && IfDepth == ElseDepth) {
-            //cout<<"Erasing (else): "<<(*NewContentIter).GetText()<<endl;
-            (*NewContentIter).SetText("");
-          }
-        }
-        if (TokenizerIf.IsTokenAt(0, "EndIf") == true || TokenizerIf.IsTokenAt(0, "Endif") == true || TokenizerIf.IsTokenAt(0, "endif") == true) {
-          IfDepth--;
-          if (IfDepth == CurrentIfDepth) {
-            //cout<<"Erasing (endif): "<<(*NewContentIter).GetText()<<endl;
-            (*NewContentIter).SetText("");
-            break;
-          }
-        }
-        if (IfStatement == false && InsideElse == false) {
-          //cout<<"Erasing (if is false): "<<(*NewContentIter).GetText()<<endl;
-          (*NewContentIter).SetText("");
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
         }
-        if (IfStatement == true && InsideElse == true) {
-          //cout<<"Erasing (else is false): "<<(*NewContentIter).GetText()<<endl;
-          (*NewContentIter).SetText("");
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
         }
       }
-      // ContentIter is not changed since we stay at the same level to all subsequent if's
-    } // Is if
-  } // global loop
-
-  // Clean empty lines:
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ) {
-    if ((*ContentIter).GetText() == "") {
-      ContentIter = FileContent.erase(ContentIter);
-    } else {
-      ++ContentIter;
-    }
-  }
-  
-  
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (evaluating if clauses + initial maths evaluation) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-  
-  if (DebugParsing == true) {
-    cout<<endl<<endl<<endl<<endl;
-    cout<<"***** After file evaluating if clauses *****"<<endl;
-    cout<<endl<<endl;
-    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
-      cout<<Tokenizer.ToCompactString()<<endl;
-    }
-  }
-  
-  
-  
-  // All constants and for loops are expanded, let's print some text ;-)
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
-    if ((*ContentIter).IsTokenizerValid() == false) {
-      Typo("Parsing of the line failed.");
-      return false;
-    }
-        
-    if (Tokenizer.GetNTokens() == 0) continue;
-
-    if (Tokenizer.IsTokenAt(0, "Print") == true ||
-        Tokenizer.IsTokenAt(0, "Echo") == true) {
-      if (Tokenizer.GetNTokens() < 2) {
-        Typo("Line must contain at least two entries, e.g. \"Print Me!\"");
-        return false;
-      }
 
-      //mout<<"   *** User Info start ***"<<endl;
-      mout<<"   *** User Info: ";
-      for (unsigned int t = 1; t < Tokenizer.GetNTokens(); ++t) {
-        mout<<Tokenizer.GetTokenAt(t)<<"  ";
-      }
-      mout<<endl;
-      //mout<<"   *** User Info end ***"<<endl;
-    }
-  }
-
-
-  // First loop:
-  // Find the master keyword, volumes, material, detectors
-  //
+      AddOrientation(new MDOrientation(Tokenizer.GetTokenAt(1)));
 
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
-    if ((*ContentIter).IsTokenizerValid() == false) {
-      Typo("Parsing of the line failed.");
-      return false;
+      continue;
     }
-       
-    if (Tokenizer.GetNTokens() == 0) continue;
-
-    // Let's scan for first order keywords:
-    // Here we have:
-    // - Name
-    // - Version
-    // - Material
-    // - Volume
-    // - Detector
-    // - Trigger
-    // - System
-    // - Vector
-    // - Shape
-    // - Orientation
 
-    // Volume (Most frequent, so start with this one)
-    if (Tokenizer.IsTokenAt(0, "Volume") == true) {
+    // Trigger
+    else if (Tokenizer.IsTokenAt(0, "Trigger") == true ||
+      Tokenizer.IsTokenAt(0, "TriggerBasic") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Volume D1Main\"");
+        Typo("Line must contain two strings, e.g. \"Trigger D1D2\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
@@ -1194,198 +752,113 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      AddVolume(new MDVolume(Tokenizer.GetTokenAt(1)));
+      AddTrigger(dynamic_cast<MDTrigger*>(new MDTriggerBasic(Tokenizer.GetTokenAt(1))));
       continue;
-    }
+      }
 
-    // Name
-    else if (Tokenizer.IsTokenAt(0, "Name") == true) {
+    // Trigger
+    else if (Tokenizer.IsTokenAt(0, "TriggerMap") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Name MEGA\"");
+        Typo("Line must contain two strings, e.g. \"TriggerMap T\"");
         return false;
       }
-      m_Name = Tokenizer.GetTokenAt(1);
-      m_Geometry->SetNameTitle(m_Name, "A Geomega geometry");
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
+      }
+
+      AddTrigger(dynamic_cast<MDTrigger*>(new MDTriggerMap(Tokenizer.GetTokenAt(1))));
       continue;
     }
 
-    // Version
-    else if (Tokenizer.IsTokenAt(0, "Version") == true) {
+    // System
+    else if (Tokenizer.IsTokenAt(0, "System") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Version 1.1.123\"");
+        Typo("Line must contain two strings, e.g. \"System D1D2\"");
         return false;
       }
-      m_Version = Tokenizer.GetTokenAt(1);
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
+      }
+
+      m_System = new MDSystem(Tokenizer.GetTokenAt(1));
       continue;
     }
 
-    // Surrounding sphere
-    else if (Tokenizer.IsTokenAt(0, "SurroundingSphere") == true) {
-      if (FoundSurroundingSphere == true) {
-        Typo("You have multiple surrounding spheres defined in your code. The ones read later overwrite the original one. This is too error prone to be allowed.");
-        return false;
-      }
-
-      if (Tokenizer.GetNTokens() != 6) {
-        Typo("Line must contain five values: Radius, xPos, yPos, zPos of sphere center, Distance to sphere center");
+    // Detectors: Strip2D
+    else if (Tokenizer.IsTokenAt(0, "Strip2D") == true ||
+             Tokenizer.IsTokenAt(0, "MDStrip2D") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Strip2D Tracker\"");
         return false;
       }
-
-      m_SurroundingSphereRadius = Tokenizer.GetTokenAtAsDouble(1);
-      m_SurroundingSpherePosition = MVector(Tokenizer.GetTokenAtAsDouble(2),
-                                 Tokenizer.GetTokenAtAsDouble(3),
-                                 Tokenizer.GetTokenAtAsDouble(4));
-      m_SurroundingSphereDistance = Tokenizer.GetTokenAtAsDouble(5);
-
-      if (m_SurroundingSphereRadius != m_SurroundingSphereDistance) {
-        Typo("Limitation: Concerning your surrounding sphere: The sphere radius must equal the distance to the sphere for the time being. Sorry.");
-        return false;
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
       }
 
-      FoundSurroundingSphere = true;
-
+      AddDetector(new MDStrip2D(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // Show the surrounding sphere
-    else if (Tokenizer.IsTokenAt(0, "ShowSurroundingSphere") == true) {
+    // Detectors: Strip3D
+    else if (Tokenizer.IsTokenAt(0, "Strip3D") == true ||
+             Tokenizer.IsTokenAt(0, "MDStrip3D") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: ShowSurroundingSphere true/false");
+        Typo("Line must contain two strings, e.g. \"Strip3D Germanium\"");
         return false;
       }
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
+      }
 
-      m_SurroundingSphereShow = Tokenizer.GetTokenAtAsBoolean(1);
-
+      AddDetector(new MDStrip3D(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // Show volumes
-    else if (Tokenizer.IsTokenAt(0, "ShowVolumes") == true) {
+    // Detectors: Strip3DDirectional
+    else if (Tokenizer.IsTokenAt(0, "Strip3DDirectional") == true ||
+             Tokenizer.IsTokenAt(0, "MDStrip3DDirectional") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: ShowVolumes false");
+        Typo("Line must contain two strings, e.g. \"Strip3DDirectional ThickSiliconWafer\"");
         return false;
       }
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
+      }
 
-      m_ShowVolumes = Tokenizer.GetTokenAtAsBoolean(1);
-
+      AddDetector(new MDStrip3DDirectional(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // Show volumes
-    else if (Tokenizer.IsTokenAt(0, "ShowOnlySensitiveVolumes") == true) {
+    // Detectors: DriftChamber
+    else if (Tokenizer.IsTokenAt(0, "DriftChamber") == true ||
+             Tokenizer.IsTokenAt(0, "MDDriftChamber") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: ShowOnlySensitiveVolumes false");
-        return false;
-      }
-
-      ShowOnlySensitiveVolumes = Tokenizer.GetTokenAtAsBoolean(1);
-
-      continue;
-    }
-
-    // Do Sanity checks
-    else if (Tokenizer.IsTokenAt(0, "DoSanityChecks") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: DoSanityChecks false");
-        return false;
-      }
-
-      m_DoSanityChecks = Tokenizer.GetTokenAtAsBoolean(1);
-
-      continue;
-    }
-
-    // Virtualize all non detector volumes
-    else if (Tokenizer.IsTokenAt(0, "VirtualizeNonDetectorVolumes") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: VirtualizeNonDetectorVolumes false");
-        return false;
-      }
-
-      m_VirtualizeNonDetectorVolumes = Tokenizer.GetTokenAtAsBoolean(1);
-
-      continue;
-    }
-
-    // Complex event reconstruction
-    else if (Tokenizer.IsTokenAt(0, "ComplexER") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: ComplexER false");
-        return false;
-      }
-
-      m_ComplexER = Tokenizer.GetTokenAtAsBoolean(1);
-
-      continue;
-    }
-
-    // Ignore short names
-    else if (Tokenizer.IsTokenAt(0, "IgnoreShortNames") == true) {
-      mout<<" *** Outdated *** "<<endl;
-      mout<<"The \"IgnoreShortNames\" keyword is no longer supported!"<<endl;
-
-      continue;
-    }
-
-    // Default color
-    else if (Tokenizer.IsTokenAt(0, "DefaultColor") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: DefaultColor  3");
-        return false;
-      }
-
-      m_DefaultColor = Tokenizer.GetTokenAtAsInt(1);
-
-      continue;
-    }
-
-    // Detector search tolerance
-    else if (Tokenizer.IsTokenAt(0, "DetectorSearchTolerance") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: DetectorSearchTolerance 0.000001");
-        return false;
-      }
-
-      m_DetectorSearchTolerance = Tokenizer.GetTokenAtAsDouble(1);
-
-      continue;
-    }
-
-    // General absorption file directory
-    else if (Tokenizer.IsTokenAt(0, "AbsorptionFileDirectory") == true ||
-             Tokenizer.IsTokenAt(0, "CrossSectionFilesDirectory") == true ||
-             Tokenizer.IsTokenAt(0, "CrossSectionPath") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two values: CrossSectionPath auxiliary");
-        return false;
-      }
-
-      // We have to use TString
-      MString Name = Tokenizer.GetTokenAtAsString(1).Data();
-      if (MFile::ExpandFileName(Name) == false) {
-        Typo("Unable to expand file name");
-        return false;
-      }
-
-      if (gSystem->IsAbsoluteFileName(Name) == false) {
-        Name.Prepend("/");
-        Name.Prepend(MFile::GetDirectoryName(m_FileName));
-
-        if (MFile::ExpandFileName(Name) == false) {
-          Typo("Unable to expand cross-section path to absolute path");
-          return false;
-        }
-      }
-
-      m_CrossSectionFileDirectory = Name;
-
-      continue;
-    }
-
-    // Material
-    else if (Tokenizer.IsTokenAt(0, "Material") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Material Aluminimum\"");
+        Typo("Line must contain two strings, e.g. \"DriftChamber Xenon\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
@@ -1397,35 +870,38 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      AddMaterial(new MDMaterial(Tokenizer.GetTokenAt(1)));
+      AddDetector(new MDDriftChamber(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // Shape
-    else if (Tokenizer.IsTokenAt(0, "Shape") == true) {
-      if (Tokenizer.GetNTokens() != 3) {
-        Typo("Line must contain three strings, e.g. \"Shape BOX RedBox\"");
+    // Detectors: AngerCamera
+    else if (Tokenizer.IsTokenAt(0, "AngerCamera") == true ||
+             Tokenizer.IsTokenAt(0, "MDAngerCamera") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"AngerCamera Angers\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(2)) == false) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
           return false;
         }
-        if (NameExists(Tokenizer.GetTokenAt(2)) == true) {
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
           return false;
         }
       }
 
-      AddShape(Tokenizer.GetTokenAt(1), Tokenizer.GetTokenAt(2));
-
+      AddDetector(new MDAngerCamera(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
 
-    // Orientation
-    else if (Tokenizer.IsTokenAt(0, "Orientation") == true) {
+    // Detectors: ACS
+    else if (Tokenizer.IsTokenAt(0, "Scintillator") == true ||
+             Tokenizer.IsTokenAt(0, "Simple") == true ||
+             Tokenizer.IsTokenAt(0, "ACS") == true ||
+             Tokenizer.IsTokenAt(0, "MDACS") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Orientation RedBoxOrientation\"");
+        Typo("Line must contain two strings, e.g. \"Scintillator ACS1\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
@@ -1437,16 +913,15 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      AddOrientation(new MDOrientation(Tokenizer.GetTokenAt(1)));
-
+      AddDetector(new MDACS(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // Trigger
-    else if (Tokenizer.IsTokenAt(0, "Trigger") == true ||
-      Tokenizer.IsTokenAt(0, "TriggerBasic") == true) {
+    // Detectors: Calorimeter
+    else if (Tokenizer.IsTokenAt(0, "Calorimeter") == true ||
+             Tokenizer.IsTokenAt(0, "MDCalorimeter") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Trigger D1D2\"");
+        Typo("Line must contain two strings, e.g. \"Calorimeter athena\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
@@ -1458,14 +933,15 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      AddTrigger(dynamic_cast<MDTrigger*>(new MDTriggerBasic(Tokenizer.GetTokenAt(1))));
+      AddDetector(new MDCalorimeter(Tokenizer.GetTokenAt(1)));
       continue;
-      }
+    }
 
-    // Trigger
-    else if (Tokenizer.IsTokenAt(0, "TriggerMap") == true) {
+    // Detectors: Voxel3D
+    else if (Tokenizer.IsTokenAt(0, "Voxel3D") == true ||
+             Tokenizer.IsTokenAt(0, "MDVoxel3D") == true) {
       if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"TriggerMap T\"");
+        Typo("Line must contain two strings, e.g. \"Voxel3D MyVoxler\"");
         return false;
       }
       if (m_DoSanityChecks == true) {
@@ -1477,255 +953,73 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      AddTrigger(dynamic_cast<MDTrigger*>(new MDTriggerMap(Tokenizer.GetTokenAt(1))));
+      AddDetector(new MDVoxel3D(Tokenizer.GetTokenAt(1)));
       continue;
     }
 
-    // System
-    else if (Tokenizer.IsTokenAt(0, "System") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"System D1D2\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+  }
+
+  // Now we can do some basic evaluation of the input:
+
+  if (m_SurroundingSphereRadius == DBL_MAX) {
+    Typo("You have to define a surrounding sphere!");
+    return false;
+  }
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (analyzing primary keywords) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+
+  //
+  // Second loop:
+  // Search for copies/clones of different volumes and named detectors
+  //
+  //
+
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
+    
+    if (Tokenizer.GetNTokens() < 3) continue;
+
+
+    // Check for volumes with copies
+    if (Tokenizer.IsTokenAt(1, "Copy") == true) {
+      if ((V = GetVolume(Tokenizer.GetTokenAt(0))) != 0) {
+        if (GetVolume(Tokenizer.GetTokenAt(2)) != 0) {
+          Typo("Copy: A volume of this name already exists!");
           return false;
         }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+        if (V->IsClone() == true) {
+          Typo("You cannot create a copy of a copy...");
           return false;
         }
-      }
 
-      m_System = new MDSystem(Tokenizer.GetTokenAt(1));
-      continue;
-    }
+        VCopy = new MDVolume(Tokenizer.GetTokenAt(2));
 
-    // Detectors: Strip2D
-    else if (Tokenizer.IsTokenAt(0, "Strip2D") == true ||
-             Tokenizer.IsTokenAt(0, "MDStrip2D") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Strip2D Tracker\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+        AddVolume(VCopy);
+        V->AddClone(VCopy);
+      } else if ((M = GetMaterial(Tokenizer.GetTokenAt(0))) != 0) {
+        if (GetMaterial(Tokenizer.GetTokenAt(2)) != 0) {
+          Typo("A material of this name already exists!");
           return false;
         }
-      }
 
-      AddDetector(new MDStrip2D(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
+        MCopy = new MDMaterial(Tokenizer.GetTokenAt(2));
 
-    // Detectors: Strip3D
-    else if (Tokenizer.IsTokenAt(0, "Strip3D") == true ||
-             Tokenizer.IsTokenAt(0, "MDStrip3D") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Strip3D Germanium\"");
-        return false;
+        AddMaterial(MCopy);
+        M->AddClone(MCopy);
       }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+    } else if (Tokenizer.IsTokenAt(1, "NamedDetector") == true || Tokenizer.IsTokenAt(1, "Named") == true) {
+      if ((D = GetDetector(Tokenizer.GetTokenAt(0))) != 0) {
+        if (D->IsNamedDetector() == true) {
+          Typo("You cannot add a named detector to a named detector!");
           return false;
         }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDStrip3D(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-    // Detectors: Strip3DDirectional
-    else if (Tokenizer.IsTokenAt(0, "Strip3DDirectional") == true ||
-             Tokenizer.IsTokenAt(0, "MDStrip3DDirectional") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Strip3DDirectional ThickSiliconWafer\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDStrip3DDirectional(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-    // Detectors: DriftChamber
-    else if (Tokenizer.IsTokenAt(0, "DriftChamber") == true ||
-             Tokenizer.IsTokenAt(0, "MDDriftChamber") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"DriftChamber Xenon\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDDriftChamber(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-    // Detectors: AngerCamera
-    else if (Tokenizer.IsTokenAt(0, "AngerCamera") == true ||
-             Tokenizer.IsTokenAt(0, "MDAngerCamera") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"AngerCamera Angers\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDAngerCamera(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-
-    // Detectors: ACS
-    else if (Tokenizer.IsTokenAt(0, "Scintillator") == true ||
-             Tokenizer.IsTokenAt(0, "Simple") == true ||
-             Tokenizer.IsTokenAt(0, "ACS") == true ||
-             Tokenizer.IsTokenAt(0, "MDACS") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Scintillator ACS1\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDACS(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-    // Detectors: Calorimeter
-    else if (Tokenizer.IsTokenAt(0, "Calorimeter") == true ||
-             Tokenizer.IsTokenAt(0, "MDCalorimeter") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Calorimeter athena\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDCalorimeter(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-    // Detectors: Voxel3D
-    else if (Tokenizer.IsTokenAt(0, "Voxel3D") == true ||
-             Tokenizer.IsTokenAt(0, "MDVoxel3D") == true) {
-      if (Tokenizer.GetNTokens() != 2) {
-        Typo("Line must contain two strings, e.g. \"Voxel3D MyVoxler\"");
-        return false;
-      }
-      if (m_DoSanityChecks == true) {
-        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
-          return false;
-        }
-        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
-          return false;
-        }
-      }
-
-      AddDetector(new MDVoxel3D(Tokenizer.GetTokenAt(1)));
-      continue;
-    }
-
-  }
-
-  // Now we can do some basic evaluation of the input:
-
-  if (m_SurroundingSphereRadius == DBL_MAX) {
-    Typo("You have to define a surrounding sphere!");
-    return false;
-  }
-
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (analyzing primary keywords) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
-  }
-
-  //
-  // Second loop:
-  // Search for copies/clones of different volumes and named detectors
-  //
-  //
-
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
-    
-    if (Tokenizer.GetNTokens() < 3) continue;
-
-
-    // Check for volumes with copies
-    if (Tokenizer.IsTokenAt(1, "Copy") == true) {
-      if ((V = GetVolume(Tokenizer.GetTokenAt(0))) != 0) {
-        if (GetVolume(Tokenizer.GetTokenAt(2)) != 0) {
-          Typo("Copy: A volume of this name already exists!");
-          return false;
-        }
-        if (V->IsClone() == true) {
-          Typo("You cannot create a copy of a copy...");
-          return false;
-        }
-
-        VCopy = new MDVolume(Tokenizer.GetTokenAt(2));
-
-        AddVolume(VCopy);
-        V->AddClone(VCopy);
-      } else if ((M = GetMaterial(Tokenizer.GetTokenAt(0))) != 0) {
-        if (GetMaterial(Tokenizer.GetTokenAt(2)) != 0) {
-          Typo("A material of this name already exists!");
-          return false;
-        }
-
-        MCopy = new MDMaterial(Tokenizer.GetTokenAt(2));
-
-        AddMaterial(MCopy);
-        M->AddClone(MCopy);
-      }
-    } else if (Tokenizer.IsTokenAt(1, "NamedDetector") == true || Tokenizer.IsTokenAt(1, "Named") == true) {
-      if ((D = GetDetector(Tokenizer.GetTokenAt(0))) != 0) {
-        if (D->IsNamedDetector() == true) {
-          Typo("You cannot add a named detector to a named detector!");
-          return false;
-        }
-        if (Tokenizer.GetNTokens() != 3) {
-         Typo("Line must contain three strings, e.g. MyStripDetector.Named Strip1. Are you using the old NamedDetector format?");
-         return false;
+        if (Tokenizer.GetNTokens() != 3) {
+         Typo("Line must contain three strings, e.g. MyStripDetector.Named Strip1. Are you using the old NamedDetector format?");
+         return false;
         }
 
         if (m_DoSanityChecks == true) {
@@ -3960,198 +3254,1246 @@ bool MDGeometry::ScanSetupFile(MString FileName, bool CreateNodes, bool Virtuali
         }
       }
 
-      if (m_DetectorList[i]->GetCommonVolume() == nullptr) {
-        mout<<"   ***  Error  ***  Multiple sensitive volumes per detector restriction for "<<m_DetectorList[i]->GetName()<<endl;
-        mout<<"If your detector has multiple sensitive volumes, those must have a common volume and there are no copies allowed starting with the sensitive volume up to the common volume."<<endl;
-        mout<<"Stopping to scan geometry file!"<<endl;
-        Reset();
-        return false;
-      }
-    }
-    // The common volume is automatically set to the detector volume in MDetector::Validate(), if there is only one sensitive volume
+      if (m_DetectorList[i]->GetCommonVolume() == nullptr) {
+        mout<<"   ***  Error  ***  Multiple sensitive volumes per detector restriction for "<<m_DetectorList[i]->GetName()<<endl;
+        mout<<"If your detector has multiple sensitive volumes, those must have a common volume and there are no copies allowed starting with the sensitive volume up to the common volume."<<endl;
+        mout<<"Stopping to scan geometry file!"<<endl;
+        Reset();
+        return false;
+      }
+    }
+    // The common volume is automatically set to the detector volume in MDetector::Validate(), if there is only one sensitive volume
+
+    // Make sure there is always only one sensitive volume of a certain type in the common volume
+    // Due to the above checks it is enough to simply check the number of sensitive volumes in the common volume
+    if (m_DetectorList[i]->GetNSensitiveVolumes() > 1 && m_DetectorList[i]->GetNSensitiveVolumes() != m_DetectorList[i]->GetCommonVolume()->GetNSensitiveVolumes()) {
+      mout<<"   ***  Error  ***  Multiple sensitive volumes per detector restriction for "<<m_DetectorList[i]->GetName()<<endl;
+      mout<<"If your detector has multiple sensitive volumes, those must have a common volume, in which exactly one of those volumes is positioned, and in addition no other sensitive volume. The latter is not the case."<<endl;
+      mout<<"Stopping to scan geometry file!"<<endl;
+      Reset();
+      return false;
+    }
+  }
+
+  bool IsValid = true;
+  for (unsigned int i = 0; i < GetNDetectors(); i++) {
+    if (m_DetectorList[i]->Validate() == false) {
+      IsValid = false;
+    }
+    m_NDetectorTypes[m_DetectorList[i]->GetType()]++;
+  }
+
+  // Special detector loop for blocked channels:
+
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
+    
+    if (Tokenizer.GetNTokens() < 2) continue;
+
+    // Check for detectors:
+    if ((D = GetDetector(Tokenizer.GetTokenAt(0))) != 0) {
+      // Check for simulation in voxels instead of a junk volume
+      if (Tokenizer.IsTokenAt(1, "BlockTrigger") == true) {
+        if (Tokenizer.GetNTokens() != 4) {
+          Typo("Line must contain two strings and 2 integerd,"
+               " e.g. \"Wafer.BlockTrigger 0 0 \"");
+          return false;
+        }
+        D->BlockTriggerChannel(Tokenizer.GetTokenAtAsInt(2),
+                               Tokenizer.GetTokenAtAsInt(3));
+      }
+    }
+  }
+
+
+  // Trigger sanity checks:
+  for (unsigned int i = 0; i < GetNTriggers(); i++) {
+    if (m_TriggerList[i]->Validate() == false) {
+      IsValid = false;
+    }
+  }
+  if (m_TriggerUnit->Validate() == false) {
+    IsValid = false;
+  }
+
+
+  // Material sanity checks
+  for (unsigned int i = 0; i < GetNMaterials(); i++) {
+    m_MaterialList[i]->SetDefaultCrossSectionFileDirectory(m_DefaultCrossSectionFileDirectory);
+    m_MaterialList[i]->SetCrossSectionFileDirectory(m_CrossSectionFileDirectory);
+    if (m_MaterialList[i]->Validate() == false) {
+      IsValid = false;
+    }
+  }
+
+  // Check if all cross sections are present if not try to create them
+  bool CrossSectionsPresent = true;
+  for (unsigned int i = 0; i < GetNMaterials(); i++) {
+    if (m_MaterialList[i]->AreCrossSectionsPresent() == false) {
+      CrossSectionsPresent = false;
+      break;
+    }
+  }
+  if (CrossSectionsPresent == false && AllowCrossSectionCreation == true) {
+    if (CreateCrossSectionFiles() == false) {
+      mout<<"   ***  Warning  ***  "<<endl;
+      mout<<"Not all cross section files are present!"<<endl;
+    }
+  }
+
+
+  // Check if we can apply the keyword komplex ER
+  // Does not cover all possibilities (e.g. rotated detector etc.)
+  if (m_ComplexER == false) {
+    int NTrackers = 0;
+    for (unsigned int i = 0; i < GetNDetectors(); i++) {
+      if (m_DetectorList[i]->GetType() == MDDetector::c_Strip2D) {
+        if (dynamic_cast<MDStrip2D*>(m_DetectorList[i])->GetOrientation() != 2) {
+          mout<<"   ***  Error  ***  ComplexER"<<endl;
+          mout<<"This keyword can only be applied for tracker which are oriented in z-axis!"<<endl;
+          IsValid = false;
+        } else {
+          NTrackers++;
+        }
+      }
+    }
+    if (NTrackers > 1) {
+      mout<<"   ***  Error  ***  ComplexER"<<endl;
+      mout<<"This keyword can only be applied if only one or none tracker is available!"<<endl;
+      Reset();
+      return false;
+    }
+  }
+
+
+  // We need a trigger criteria
+  if (GetNTriggers() == 0) {
+    mout<<"   ***  Warning  ***  "<<endl;
+    mout<<"You have not defined any trigger criteria!!"<<endl;
+  } else {
+    // Check if each detector has a trigger criterion:
+    for (unsigned int i = 0; i < GetNDetectors(); ++i) {
+      // Guard ring trigger criteria are optional...
+      if (m_DetectorList[i]->GetType() == MDDetector::c_GuardRing) continue;
+
+      bool Found = false;
+      for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+        if (m_TriggerList[t]->Applies(m_DetectorList[i]) == true) {
+          Found = true;
+          break;
+        }
+        // If we have a named detectors, in case the "named after detector" has a trigger criteria, we are fine
+        if (m_DetectorList[i]->IsNamedDetector() == true) {
+          if (m_TriggerList[t]->Applies(m_DetectorList[i]->GetNamedAfterDetector()) == true) {
+            Found = true;
+            break;
+          }
+        }
+        // If the detector has named detectors which have a trigger criteria, we are fine to
+        if (m_DetectorList[i]->HasNamedDetectors() == true) {
+          for (unsigned int n = 0; n < m_DetectorList[i]->GetNNamedDetectors(); ++n) {
+            for (unsigned int t2 = 0; t2 < GetNTriggers(); ++t2) {
+              if (m_TriggerList[t2]->Applies(GetDetector(m_DetectorList[i]->GetNamedDetectorName(n))) == true) {
+                Found = true;
+                break;
+              }
+            }
+          }
+        }
+      }
+      if (Found == false) {
+        mout<<"   ***  Warning  ***  "<<endl;
+        mout<<"You have not defined any trigger criterion for detector: "<<m_DetectorList[i]->GetName()<<endl;
+      }
+    }
+  }
+
+  if (IsValid == false) {
+    mout<<"   ***  Error  ***  "<<endl;
+    mout<<"There were errors while scanning this file. Correct them first!!"<<endl;
+    Reset();
+    return false;
+  }
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (validation & post-processing) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+
+  // Geant4 requires that the world volume is the first volume in the list
+  // Thus resort the list
+  m_VolumeList.erase(find(m_VolumeList.begin(), m_VolumeList.end(), m_WorldVolume));
+  m_VolumeList.insert(m_VolumeList.begin(), m_WorldVolume);
+
+  // The last stage is to optimize the geometry for hit searches:
+  m_WorldVolume->OptimizeVolumeTree();
+
+  // Make sure the name indices reflect the final lists
+  BuildNameIndices();
+
+  m_GeometryScanned = true;
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (volume tree optimization) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+ }
+
+  if (g_Verbosity >= c_Info) {
+    mout<<"Geometry "<<m_FileName<<" successfully scanned within "<<Timer.ElapsedTime()<<"s"<<endl;
+    mout<<"It contains "<<GetNVolumes()<<" volumes"<<endl;
+  }
+
+  if (FoundDeprecated == true) {
+    mgui<<"Your geometry contains deprecated information (see console output for details)."<<endl;
+    mgui<<"Please update it now to the latest conventions!"<<show;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometry::PreprocessSetupFile(list<MDDebugInfo>& FileContent, bool& FoundDeprecated, int& Stage, MTimer& Timer)
+{
+  // Read the setup file and all included files, and resolve all constants, maths, for loops, random numbers and if clauses
+
+  bool DebugParsing = false;
+  double TimeLimit = 0;
+  MDVector* Vector = 0;
+
+  if (AddFile(m_FileName, FileContent) == false) {
+    mout<<"   *** Error reading included files. Aborting!"<<endl;
+    return false;
+  }
+
+  // Now scan the data and search for "Include" files and add them
+  // to the original stored file content
+
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) {
+      continue;
+    }
+    
+    if (Tokenizer.IsTokenAt(0, "Include") == true) {
+      
+      // Test for old material path
+      if (Tokenizer.GetTokenAt(1).EndsWith("resource/geometries/materials/Materials.geo") == true) {
+        mout<<" *** Deprectiated *** "<<endl;
+        mout<<"You are using the old MEGAlib material path:"<<endl;
+        mout<<m_DebugInfo.GetText()<<endl;
+        mout<<"Please update to the new path now!"<<endl;
+        mout<<"Change: resource/geometries To: resource/examples/geomega "<<endl;
+        mout<<endl;
+        FoundDeprecated = true;
+      }
+      
+      MString FileName = Tokenizer.GetTokenAt(1);
+      if (MFile::ExpandFileName(FileName, m_FileName) == false) {
+        Typo("Unable to expand file name");
+        return false;
+      }
+      
+      if (MFile::Exists(FileName) == false) {
+        mout<<"   *** Error finding file "<<FileName<<endl;
+        Typo("File IO error");
+        return false;
+      }
+      
+      list<MDDebugInfo> AddFileContent;
+      if (AddFile(FileName, AddFileContent) == false) {
+        mout<<"   *** Error reading file "<<FileName<<endl;
+        Typo("File IO error");
+        return false;
+      }
+      
+      (*ContentIter).SetText("");
+      auto BackToStartIter = ContentIter;
+      for (auto AddIter = AddFileContent.begin(); AddIter != AddFileContent.end(); ++AddIter) {
+        ContentIter = FileContent.insert(next(ContentIter), (*AddIter));
+      }
+      ContentIter = BackToStartIter;
+    }
+    
+    if (Tokenizer.IsTokenAt(0, "Import") == true) {
+      
+      if (Tokenizer.GetNTokens() != 3) {
+        Typo("Line must contain three entries, e.g. \"Import GDML MyGDML.gdml\"");
+        return false;
+      }
+      
+      if (Tokenizer.IsTokenAt(1, "GDML") == true) {
+        MString FileName = Tokenizer.GetTokenAt(2);
+        if (MFile::ExpandFileName(FileName, m_FileName) == false) {
+          mout<<"   *** Error expanding file "<<FileName<<endl;
+          Typo("Unable to expand file name");
+          return false;
+        }
+      
+        if (MFile::Exists(FileName) == false) {
+          mout<<"   *** Error finding file "<<FileName<<endl;
+          Typo("File IO error");
+          return false;
+        }
+      
+        list<MDDebugInfo> AddFileContent;
+        if (ImportGDML(FileName, AddFileContent) == false) {
+          mout<<"   *** Error reading file "<<FileName<<endl;
+          Typo("File IO error");
+          return false;
+        }
+      
+        (*ContentIter).SetText("");
+        auto BackToStartIter = ContentIter;
+        for (auto AddIter = AddFileContent.begin(); AddIter != AddFileContent.end(); ++AddIter) {
+          ContentIter = FileContent.insert(next(ContentIter), (*AddIter));
+        }
+        ContentIter = BackToStartIter;
+      } else {
+        mout<<"   *** Error unknown import file type "<<Tokenizer.GetTokenAt(1)<<endl;
+        Typo("Import error");
+      }
+    }
+    
+  }
+
+  if (FileContent.size() == 0) {
+    mgui<<"File is \""<<m_FileName<<"\" empty or binary!"<<error;
+    return false;
+  }
+  
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (reading of file(s)) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file reading *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+  
+
+
+  // Find lines which are continued in a second line by the "\\" keyword
+
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) continue;
+
+    // Of course the real token is "\\"
+    if (Tokenizer.IsTokenAt(Tokenizer.GetNTokens()-1, "\\\\") == true) {
+      //cout<<"Found \\\\: "<<Tokenizer.ToString()<<endl;
+      // Prepend this text to the next line
+      if (next(ContentIter, 1) != FileContent.end()) {
+        //cout<<"Next: "<<FileContent[i+1].GetText()<<endl;
+        MString Prepend = "";
+        for (unsigned int t = 0; t < Tokenizer.GetNTokens()-1; ++t) {
+          Prepend += Tokenizer.GetTokenAt(t);
+          Prepend += " ";
+        }
+        (*(next(ContentIter, 1))).Prepend(Prepend);
+        (*ContentIter).SetText("");
+      }
+    }
+  }
+
+
+
+  // Find constants
+  //
+
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) continue;
+
+    // Constants
+    if (Tokenizer.IsTokenAt(0, "Constant") == true) {
+      if (Tokenizer.GetNTokens() != 3) {
+        Typo("Line must contain three entries, e.g. \"Constant Distance 10.5\"");
+        return false;
+      }
+      if (Tokenizer.GetTokenAt(1) == Tokenizer.GetTokenAt(2)) {
+        Typo("The constant name and replacement are identical!");
+        return false;
+      }
+      vector<MString>::iterator VIter = find(m_BlockedConstants.begin(), m_BlockedConstants.end(), Tokenizer.GetTokenAt(1));
+      if (VIter != m_BlockedConstants.end()) {
+        Typo("Constant has a reserved name, and thus cannot be used!");
+        return false;
+      }
+      map<MString, MString>::iterator Iter = m_ConstantMap.find(Tokenizer.GetTokenAt(1));
+      if (Iter != m_ConstantMap.end()) {
+        if (m_ConstantMap[Tokenizer.GetTokenAt(1)] != Tokenizer.GetTokenAt(2)) {
+          Typo("Constant has already been defined and both are not identical!");
+          return false;
+        }
+      }
+      m_ConstantMap[Tokenizer.GetTokenAt(1)] = Tokenizer.GetTokenAt(2);
+      m_ConstantList.push_back(Tokenizer.GetTokenAt(1));
+    }
+  }
+
+  // Take care of maths and constants containing constants, containing constants...
+  bool ConstantChanged = true;
+  while (ConstantChanged == true) {
+    // Step 1: Solve maths:
+    for (map<MString, MString>::iterator Iter1 = m_ConstantMap.begin();
+         Iter1 != m_ConstantMap.end();
+         ++Iter1) {
+      if (MTokenizer::IsMaths((*Iter1).second) == true) {
+        bool ContainsConstant = false;
+        for (map<MString, MString>::iterator Iter2 = m_ConstantMap.begin();
+             Iter2 != m_ConstantMap.end();
+             ++Iter2) {
+          if (ContainsReplacableConstant((*Iter1).second, (*Iter2).first) == true) {
+            ContainsConstant = true;
+            //cout<<"Replaceable constant: "<<(*Iter1).second<<" (namely:"<<(*Iter2).first<<")"<<endl;
+            break;
+          } else {
+            //cout<<"No replaceable constant: "<<(*Iter1).second<<" (test:"<<(*Iter2).first<<")"<<endl;
+          }
+        }
+        if (ContainsConstant == false) {
+          MString Constant = (*Iter1).second;
+          if ( MTokenizer::CheckMaths(Constant) == false) {
+            mout<<"   *** Error ***"<<endl;
+            mout<<"Maths in constant cannot be evaluated: "<<(*Iter1).first<<" "<<Constant<<endl;
+            return false;
+          }
+          MTokenizer::EvaluateMaths(Constant);
+          (*Iter1).second = Constant;
+        }
+      }
+    }
+
+    // Step 2: Replace constants in constants
+    bool ConstantChangableWithMath = false;
+    ConstantChanged = false;
+    for (map<MString, MString>::iterator Iter1 = m_ConstantMap.begin(); Iter1 != m_ConstantMap.end(); ++Iter1) {
+      //cout<<"Checking for replacement: "<<(*Iter1).first<<" with "<<(*Iter1).second<<endl;
+      for (map<MString, MString>::iterator Iter2 = m_ConstantMap.begin(); Iter2 != m_ConstantMap.end(); ++Iter2) {
+        //cout<<"Map size: "<<m_ConstantMap.size()<<endl;
+        if (ContainsReplacableConstant((*Iter1).second, (*Iter2).first) == true) {
+          //cout<<"   ---> "<<(*Iter2).first<<" - "<<(*Iter2).second<<endl;
+          //cout<<(*Iter1).second<<" contains "<<(*Iter2).first<<endl;
+          if (MTokenizer::IsMaths((*Iter2).second) == false) {
+            MString Constant = (*Iter1).second;
+            ReplaceWholeWords(Constant, (*Iter2).first, (*Iter2).second);
+            (*Iter1).second = Constant;
+            ConstantChanged = true;
+          } else {
+            ConstantChangableWithMath = true;
+          }
+        }
+      }
+    }
+
+    if (ConstantChanged == false &&  ConstantChangableWithMath == true) {
+      mout<<"   *** Error ***"<<endl;
+      mout<<"Recursively defined constant found!"<<endl;
+      return false;
+    }
+  }
+
+  // Do the final replace:
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) continue;
+
+    MString Init = Tokenizer.GetTokenAt(0);
+    if (Init == "Volume" ||
+      Init == "Material" ||
+      Init == "Trigger" ||
+      Init == "TriggerBasic" ||
+      Init == "TriggerMap" ||
+      Init == "System" ||
+      Init == "Strip2D" ||
+      Init == "MDStrip2D" ||
+      Init == "Strip3D" ||
+      Init == "MDStrip3D" ||
+      Init == "Strip3DDirectional" ||
+      Init == "MDStrip3DDirectional" ||
+      Init == "DriftChamber" ||
+      Init == "MDDriftChamber" ||
+      Init == "AngerCamera" ||
+      Init == "MDAngerCamera" ||
+      Init == "Simple" ||
+      Init == "Scintillator" ||
+      Init == "ACS" ||
+      Init == "MDACS" ||
+      Init == "Calorimeter" ||
+      Init == "MDCalorimeter" ||
+      Init == "Voxel3D" ||
+      Init == "MDVoxel3D") {
+      continue;
+    }
+
+    for (map<MString, MString>::iterator Iter = m_ConstantMap.begin();
+         Iter != m_ConstantMap.end(); ++Iter) {
+      (*ContentIter).Replace((*Iter).first, (*Iter).second, true);
+    }
+  }
+
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (evaluating constants and maths) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file evaluating constants and maths *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+  
+
+  // Check for Vectors FIRST since those are used in ForVector loops...
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) continue;
+
+    if (Tokenizer.IsTokenAt(0, "Vector") == true) {
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("Line must contain two strings, e.g. \"Vector MyMatrix\"");
+        return false;
+      }
+      if (m_DoSanityChecks == true) {
+        if (ValidName(Tokenizer.GetTokenAt(1)) == false) {
+          return false;
+        }
+        if (NameExists(Tokenizer.GetTokenAt(1)) == true) {
+          return false;
+        }
+      }
+
+      AddVector(new MDVector(Tokenizer.GetTokenAt(1)));
+      continue;
+    }
+  }
+  
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.GetNTokens() == 0) continue;
+
+    if ((Vector = GetVector(Tokenizer.GetTokenAt(0))) != 0) {
+      MTokenizer& Tokenizer2 = m_DebugInfo.GetTokenizer(true);  // Let's do some maths
+
+      if (Tokenizer2.IsTokenAt(1, "Matrix") == true) {
+        // We need at least 9 keywords:
+        if (Tokenizer2.GetNTokens() < 9) {
+          Typo("Vector.Matrix must contain at least nine keywords,"
+               " e.g. \"MaskMatrix.Matrix  3 1.0  3 1.0  1 0.0  1 0 1 0 1 0 1 0 1\"");
+          return false;
+        }
+        unsigned int x_max = Tokenizer2.GetTokenAtAsUnsignedInt(2);
+        unsigned int y_max = Tokenizer2.GetTokenAtAsUnsignedInt(4);
+        unsigned int z_max = Tokenizer2.GetTokenAtAsUnsignedInt(6);
+        double dx = Tokenizer2.GetTokenAtAsDouble(3);
+        double dy = Tokenizer2.GetTokenAtAsDouble(5);
+        double dz = Tokenizer2.GetTokenAtAsDouble(7);
+
+        // Now we know the real number of keywords:
+        if (Tokenizer2.GetNTokens() != 8+x_max*y_max*z_max) {
+          Typo("This version of Vector.Matrix does not contain the right amount of numbers\"");
+          return false;
+        }
+
+        for (unsigned int z = 0; z < z_max; ++z) {
+          for (unsigned int y = 0; y < y_max; ++y) {
+            for (unsigned int x = 0; x < x_max; ++x) {
+              Vector->Add(MVector(x*dx, y*dy, z*dz), Tokenizer2.GetTokenAtAsDouble(8 + x + y*x_max + z*x_max*y_max));
+            }
+          }
+        }
+
+      } else {
+        Typo("Unrecognized vector option");
+        return false;
+      }
+    }
+  }
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (evaluating vectors) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file evaluating vectors *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+  
+  // Check for "For"-loops as well as the special "ForVector"-loop
+  int ForDepth = 0;
+  int CurrentDepth = 0;
+  
+  
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); /* ++ContentIter erase */) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+
+    if (Tokenizer.GetNTokens() == 0) {
+      ++ContentIter;
+      continue;
+    }
+
+    // For
+    auto BackToStartIter = ContentIter;
+    if (Tokenizer.IsTokenAt(0, "For") == true || Tokenizer.IsTokenAt(0, "for") == true) {
+      MTokenizer& TokenizerMaths = m_DebugInfo.GetTokenizer(true); // redo for math's evaluation just here
+
+      CurrentDepth = ForDepth;
+      ForDepth++;
+      if (TokenizerMaths.GetNTokens() != 5) {
+        Typo("Line must contain five entries, e.g. \"For I 3 -11.0 11.0\"");
+        return false;
+      }
+
+      MString Index = TokenizerMaths.GetTokenAt(1);
+      if (TokenizerMaths.GetTokenAtAsInt(2) < 0 || TokenizerMaths.GetTokenAtAsInt(2) != TokenizerMaths.GetTokenAtAsDouble(2) || std::isnan(TokenizerMaths.GetTokenAtAsDouble(2))) { // std:: is required
+        Typo("Loop number in for loop must be a positive integer");
+        return false;
+      }
+      unsigned int Loops = TokenizerMaths.GetTokenAtAsUnsignedInt(2);
+      double Start = TokenizerMaths.GetTokenAtAsDouble(3);
+      double Step = TokenizerMaths.GetTokenAtAsDouble(4);
+
+      // Erase the for line
+      (*ContentIter).SetText("");
+
+      // Store content of for loop:
+      list<MDDebugInfo> ForLoopContent;
+      for (; ContentIter != FileContent.end(); /* ++ContentIter erase */) {
+        m_DebugInfo = (*ContentIter);
+        MTokenizer& TokenizerFor = (*ContentIter).GetTokenizer(false);
+
+        if (TokenizerFor.GetNTokens() == 0) {
+          ContentIter++;
+          continue;
+        }
+        if (TokenizerFor.IsTokenAt(0, "For") == true || TokenizerFor.IsTokenAt(0, "for") == true) {
+          ForDepth++;
+        }
+        if (TokenizerFor.IsTokenAt(0, "Done") == true || TokenizerFor.IsTokenAt(0, "done") == true) {
+          ForDepth--;
+          if (ForDepth == CurrentDepth) {
+            (*ContentIter).SetText("");
+            break;
+          }
+        }
+
+        ForLoopContent.push_back(m_DebugInfo);
+        (*ContentIter).SetText("");
+      }
+
+      // Add new content at the same place:
+      list<MDDebugInfo>::iterator LastIter = ContentIter;
+      int Position = 0;
+      for (unsigned int l = 1; l <= Loops; ++l) {
+        MString LoopString;
+        LoopString += l;
+        MString ValueString;
+        ValueString += (Start + (l-1)*Step);
+
+
+        list<MDDebugInfo>::iterator ForIter;
+        for (ForIter = ForLoopContent.begin();
+             ForIter != ForLoopContent.end();
+             ++ForIter) {
+          m_DebugInfo = (*ForIter);
+          m_DebugInfo.Replace(MString("%") + Index, LoopString);
+          m_DebugInfo.Replace(MString("$") + Index, ValueString);
+
+          LastIter = FileContent.insert(next(LastIter), m_DebugInfo);
+          Position++;
+        }
+      }
+      ContentIter = BackToStartIter; // Multiple fors -- have to go back where we started
+            
+      continue;
+    }
+
+    // ForVector
+    BackToStartIter = ContentIter;
+    if (Tokenizer.IsTokenAt(0, "ForVector") == true) {
+
+      // Take care of nesting
+      CurrentDepth = ForDepth;
+      ForDepth++;
+
+
+      if (Tokenizer.GetNTokens() != 6) {
+        Typo("The ForVector-line must contain six entries, e.g. \"ForVector MyVector X Y Z V\"");
+        return false;
+      }
+
+      // Retrieve data:
+      Vector = GetVector(Tokenizer.GetTokenAt(1));
+      if (Vector == 0) {
+        Typo("ForVector-line: cannot find vector\"");
+        return false;
+      }
+
+      MString XIndex = Tokenizer.GetTokenAt(2);
+      MString YIndex = Tokenizer.GetTokenAt(3);
+      MString ZIndex = Tokenizer.GetTokenAt(4);
+      MString VIndex = Tokenizer.GetTokenAt(5);
+
+      // Erase the for line
+      (*ContentIter).SetText("");
+      
+      // Store content of ForVector loop:
+      list<MDDebugInfo> ForLoopContent;
+      for (; ContentIter != FileContent.end(); /* ++ContentIter erase */) {
+        m_DebugInfo = (*ContentIter);
+        MTokenizer& TokenizerFor = m_DebugInfo.GetTokenizer(false);
+
+        if (TokenizerFor.GetNTokens() == 0) {
+          ContentIter++;
+          continue;
+        }
+        if (TokenizerFor.IsTokenAt(0, "ForVector") == true) {
+          ForDepth++;
+        }
+        if (TokenizerFor.IsTokenAt(0, "DoneVector") == true) {
+          ForDepth--;
+          if (ForDepth == CurrentDepth) {
+            (*ContentIter).SetText("");
+            break;
+          }
+        }
+
+        ForLoopContent.push_back(m_DebugInfo);
+        (*ContentIter).SetText("");
+      }
+
+      // Add new content at the same place:
+      list<MDDebugInfo>::iterator LastIter = ContentIter;
+      int Position = 0;
+      for (unsigned int l = 1; l <= Vector->GetSize(); ++l) {
+        //cout<<"Vector loc: "<<l<<endl;
+        
+        MString LoopString;
+        LoopString += l;
+        MString XValueString;
+        XValueString += Vector->GetPosition(l-1).X();
+        MString YValueString;
+        YValueString += Vector->GetPosition(l-1).Y();
+        MString ZValueString;
+        ZValueString += Vector->GetPosition(l-1).Z();
+        MString ValueString;
+        ValueString += Vector->GetValue(l-1);
+
+        list<MDDebugInfo>::iterator ForIter;
+        for (ForIter = ForLoopContent.begin();
+             ForIter != ForLoopContent.end();
+             ++ForIter) {
+          m_DebugInfo = (*ForIter);
+          m_DebugInfo.Replace(MString("%") + XIndex, LoopString);
+          m_DebugInfo.Replace(MString("$") + XIndex, XValueString);
+          m_DebugInfo.Replace(MString("%") + YIndex, LoopString);
+          m_DebugInfo.Replace(MString("$") + YIndex, YValueString);
+          m_DebugInfo.Replace(MString("%") + ZIndex, LoopString);
+          m_DebugInfo.Replace(MString("$") + ZIndex, ZValueString);
+          m_DebugInfo.Replace(MString("%") + VIndex, LoopString);
+          m_DebugInfo.Replace(MString("$") + VIndex, ValueString);
+
+          LastIter = FileContent.insert(next(LastIter), m_DebugInfo);
+          Position++;
+        }
+      }
+      ContentIter = BackToStartIter;
+      continue;
+    }
+    ++ContentIter;
+  }
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (evaluating for loops) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file evaluating for loops *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+  
+
+  // Find random numbers
+  TRandom3 R;
+  R.SetSeed(11031879); // Do never modify!!!!
+  
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    while ((*ContentIter).Contains("RandomDouble") == true) {
+      //cout<<"Before: "<<(*ContentIter).GetText()<<endl;
+      (*ContentIter).ReplaceFirst("RandomDouble", R.Rndm());
+      //cout<<"after: "<<(*ContentIter).GetText()<<endl;
+    }
+  }
+
+
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (evaluating random numbers) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file evaluating random numbers *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+  
+    
+  // Do a final maths check:
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+    
+    if (Tokenizer.CheckAllMaths() == false) {
+      Typo("Cannot parse maths -- typo or unsupported maths function.");
+      return false;
+    }
+  }
+  
+  // Check for "If"-clauses
+  int IfDepth = 0;
+  int ElseDepth = 0;
+  int CurrentIfDepth = 0;
+  bool InsideElse = false;
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+    m_DebugInfo = (*ContentIter);
+    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
+    if ((*ContentIter).IsTokenizerValid() == false) {
+      Typo("Parsing of the line failed.");
+      return false;
+    }
+   
+    if (Tokenizer.GetNTokens() == 0) {
+      continue;
+    }
+
+    if (Tokenizer.IsTokenAt(0, "If") == true) {
+
+      // Take care of nesting
+      CurrentIfDepth = IfDepth;
+      IfDepth++;
+
+      // Take care of else
+      InsideElse = false;
+      
+      if (Tokenizer.GetNTokens() != 2) {
+        Typo("The If-line must contain two entries, the last one must be math, e.g. \"If { 1 == 2 } or If { $Value > 0 } \"");
+        return false;
+      }
+
+      // Retrieve data:
+      bool IfStatement = Tokenizer.GetTokenAtAsBoolean(1);
+
+      // Clear the if line
+      //cout<<"Erasing (if): "<<(*ContentIter).GetText()<<endl;
+      (*ContentIter).SetText("");
+
+      // Forward its endif:
+      for (auto NewContentIter = next(ContentIter, 1); NewContentIter != FileContent.end(); ++NewContentIter) {
+        MTokenizer& TokenizerIf = (*NewContentIter).GetTokenizer(false);
+        if (TokenizerIf.GetNTokens() == 0) {
+          continue;
+        }
+        if (TokenizerIf.IsTokenAt(0, "If") == true || TokenizerIf.IsTokenAt(0, "if") == true) {
+          IfDepth++;
+        }
+        if (TokenizerIf.IsTokenAt(0, "Else") == true || TokenizerIf.IsTokenAt(0, "else") == true) {
+          InsideElse = true;
+          ElseDepth++;
+          if (IfDepth == CurrentIfDepth && IfDepth == ElseDepth) {
+            //cout<<"Erasing (else): "<<(*NewContentIter).GetText()<<endl;
+            (*NewContentIter).SetText("");
+          }
+        }
+        if (TokenizerIf.IsTokenAt(0, "EndIf") == true || TokenizerIf.IsTokenAt(0, "Endif") == true || TokenizerIf.IsTokenAt(0, "endif") == true) {
+          IfDepth--;
+          if (IfDepth == CurrentIfDepth) {
+            //cout<<"Erasing (endif): "<<(*NewContentIter).GetText()<<endl;
+            (*NewContentIter).SetText("");
+            break;
+          }
+        }
+        if (IfStatement == false && InsideElse == false) {
+          //cout<<"Erasing (if is false): "<<(*NewContentIter).GetText()<<endl;
+          (*NewContentIter).SetText("");
+        }
+        if (IfStatement == true && InsideElse == true) {
+          //cout<<"Erasing (else is false): "<<(*NewContentIter).GetText()<<endl;
+          (*NewContentIter).SetText("");
+        }
+      }
+      // ContentIter is not changed since we stay at the same level to all subsequent if's
+    } // Is if
+  } // global loop
+
+  // Clean empty lines:
+  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ) {
+    if ((*ContentIter).GetText() == "") {
+      ContentIter = FileContent.erase(ContentIter);
+    } else {
+      ++ContentIter;
+    }
+  }
+  
+  
+  ++Stage;
+  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
+    mout<<"Stage "<<Stage<<" (evaluating if clauses + initial maths evaluation) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  }
+  
+  if (DebugParsing == true) {
+    cout<<endl<<endl<<endl<<endl;
+    cout<<"***** After file evaluating if clauses *****"<<endl;
+    cout<<endl<<endl;
+    for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
+      MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(false);
+      cout<<Tokenizer.ToCompactString()<<endl;
+    }
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometry::IsCacheUsed()
+{
+  // Return true if the cache of the preprocessed setup files is used
+
+  if (s_UseCache == false) return false;
+
+  const char* Environment = getenv("MEGALIB_GEOMETRYCACHE");
+  if (Environment != nullptr) {
+    MString Value = Environment;
+    Value.ToLowerInPlace();
+    if (Value == "off" || Value == "0" || Value == "false" || Value == "no") return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
 
-    // Make sure there is always only one sensitive volume of a certain type in the common volume
-    // Due to the above checks it is enough to simply check the number of sensitive volumes in the common volume
-    if (m_DetectorList[i]->GetNSensitiveVolumes() > 1 && m_DetectorList[i]->GetNSensitiveVolumes() != m_DetectorList[i]->GetCommonVolume()->GetNSensitiveVolumes()) {
-      mout<<"   ***  Error  ***  Multiple sensitive volumes per detector restriction for "<<m_DetectorList[i]->GetName()<<endl;
-      mout<<"If your detector has multiple sensitive volumes, those must have a common volume, in which exactly one of those volumes is positioned, and in addition no other sensitive volume. The latter is not the case."<<endl;
-      mout<<"Stopping to scan geometry file!"<<endl;
-      Reset();
-      return false;
+MString MDGeometry::GetCacheDirectory()
+{
+  // Return the directory of the cache files: a per-user directory, not the directory of the setup files,
+  // which might not be writable or shared between users and machines
+
+  MString Directory = s_CacheDirectory;
+  if (Directory.IsEmpty() == true) {
+    const char* Environment = getenv("MEGALIB_GEOMETRYCACHE");
+    if (Environment != nullptr && Environment[0] == '/') {
+      Directory = Environment;
     }
   }
-
-  bool IsValid = true;
-  for (unsigned int i = 0; i < GetNDetectors(); i++) {
-    if (m_DetectorList[i]->Validate() == false) {
-      IsValid = false;
+  if (Directory.IsEmpty() == true) {
+    const char* XDG = getenv("XDG_CACHE_HOME");
+    if (XDG != nullptr && XDG[0] == '/') {
+      Directory = MString(XDG) + "/megalib/geomega";
+    } else {
+      Directory = MString(gSystem->HomeDirectory()) + "/.cache/megalib/geomega";
     }
-    m_NDetectorTypes[m_DetectorList[i]->GetType()]++;
   }
+  MFile::ExpandFileName(Directory);
 
-  // Special detector loop for blocked channels:
+  return Directory;
+}
 
-  for (auto ContentIter = FileContent.begin(); ContentIter != FileContent.end(); ++ContentIter) {
-    m_DebugInfo = (*ContentIter);
-    MTokenizer& Tokenizer = (*ContentIter).GetTokenizer(true);
-    
-    if (Tokenizer.GetNTokens() < 2) continue;
 
-    // Check for detectors:
-    if ((D = GetDetector(Tokenizer.GetTokenAt(0))) != 0) {
-      // Check for simulation in voxels instead of a junk volume
-      if (Tokenizer.IsTokenAt(1, "BlockTrigger") == true) {
-        if (Tokenizer.GetNTokens() != 4) {
-          Typo("Line must contain two strings and 2 integerd,"
-               " e.g. \"Wafer.BlockTrigger 0 0 \"");
-          return false;
-        }
-        D->BlockTriggerChannel(Tokenizer.GetTokenAtAsInt(2),
-                               Tokenizer.GetTokenAtAsInt(3));
-      }
-    }
-  }
+////////////////////////////////////////////////////////////////////////////////
 
 
-  // Trigger sanity checks:
-  for (unsigned int i = 0; i < GetNTriggers(); i++) {
-    if (m_TriggerList[i]->Validate() == false) {
-      IsValid = false;
-    }
+MString MDGeometry::GetCacheFileName() const
+{
+  // Return the name of the cache file of the preprocessed setup file:
+  // Its base name and the hash of its full path, thus setup files with the same name in different directories do not collide
+
+  TMD5 MD5;
+  MD5.Update(reinterpret_cast<const UChar_t*>(m_FileName.Data()), m_FileName.Length());
+  MD5.Final();
+
+  return GetCacheDirectory() + "/" + MFile::GetBaseName(m_FileName) + "." + MD5.AsString() + ".cache";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a string into the binary cache
+static void WriteCacheString(ofstream& Out, const MString& String)
+{
+  uint32_t Length = String.Length();
+  Out.write(reinterpret_cast<const char*>(&Length), sizeof(Length));
+  Out.write(String.Data(), Length);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read a string from the binary cache
+static bool ReadCacheString(ifstream& In, MString& String)
+{
+  uint32_t Length = 0;
+  if (!In.read(reinterpret_cast<char*>(&Length), sizeof(Length))) return false;
+  string Buffer(Length, ' ');
+  if (Length > 0 && !In.read(&Buffer[0], Length)) return false;
+  String = Buffer;
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometry::WriteCache(const list<MDDebugInfo>& FileContent, bool FoundDeprecated)
+{
+  // Write the preprocessed content of the setup file together with the hashes of all files it has been created from
+  // Several processes might do this at the same time, thus write a temporary file and rename it
+
+  MString FileName = GetCacheFileName();
+  MString TemporaryFileName = FileName + "." + MString(gSystem->GetPid()) + ".tmp";
+
+  // Quietly, a missing cache is not a problem
+  MString Directory = MFile::GetDirectoryName(FileName);
+  if (gSystem->AccessPathName(Directory) == kTRUE && gSystem->mkdir(Directory, kTRUE) != 0) {
+    return false;
   }
-  if (m_TriggerUnit->Validate() == false) {
-    IsValid = false;
+
+  ofstream Out(TemporaryFileName.Data(), ios::binary);
+  if (Out.is_open() == false) {
+    // Not a problem, e.g. the directory is not writable
+    return false;
   }
 
+  uint32_t Magic = c_CacheMagic;
+  Out.write(reinterpret_cast<const char*>(&Magic), sizeof(Magic));
+  uint32_t Version = c_CacheVersion;
+  Out.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+  WriteCacheString(Out, g_VersionString);
+  WriteCacheString(Out, g_MEGAlibPath);
+  WriteCacheString(Out, m_FileName);
 
-  // Material sanity checks
-  for (unsigned int i = 0; i < GetNMaterials(); i++) {
-    m_MaterialList[i]->SetDefaultCrossSectionFileDirectory(m_DefaultCrossSectionFileDirectory);
-    m_MaterialList[i]->SetCrossSectionFileDirectory(m_CrossSectionFileDirectory);
-    if (m_MaterialList[i]->Validate() == false) {
-      IsValid = false;
-    }
+  uint32_t Size = m_IncludeList.size();
+  Out.write(reinterpret_cast<const char*>(&Size), sizeof(Size));
+  for (unsigned int i = 0; i < m_IncludeList.size(); ++i) {
+    WriteCacheString(Out, m_IncludeList[i]);
+    WriteCacheString(Out, m_IncludeListHashes[i]);
   }
 
-  // Check if all cross sections are present if not try to create them
-  bool CrossSectionsPresent = true;
-  for (unsigned int i = 0; i < GetNMaterials(); i++) {
-    if (m_MaterialList[i]->AreCrossSectionsPresent() == false) {
-      CrossSectionsPresent = false;
-      break;
-    }
+  Size = m_ConstantList.size();
+  Out.write(reinterpret_cast<const char*>(&Size), sizeof(Size));
+  for (const MString& C: m_ConstantList) {
+    WriteCacheString(Out, C);
   }
-  if (CrossSectionsPresent == false && AllowCrossSectionCreation == true) {
-    if (CreateCrossSectionFiles() == false) {
-      mout<<"   ***  Warning  ***  "<<endl;
-      mout<<"Not all cross section files are present!"<<endl;
-    }
+  Size = m_ConstantMap.size();
+  Out.write(reinterpret_cast<const char*>(&Size), sizeof(Size));
+  for (auto Iter = m_ConstantMap.begin(); Iter != m_ConstantMap.end(); ++Iter) {
+    WriteCacheString(Out, (*Iter).first);
+    WriteCacheString(Out, (*Iter).second);
   }
 
-
-  // Check if we can apply the keyword komplex ER
-  // Does not cover all possibilities (e.g. rotated detector etc.)
-  if (m_ComplexER == false) {
-    int NTrackers = 0;
-    for (unsigned int i = 0; i < GetNDetectors(); i++) {
-      if (m_DetectorList[i]->GetType() == MDDetector::c_Strip2D) {
-        if (dynamic_cast<MDStrip2D*>(m_DetectorList[i])->GetOrientation() != 2) {
-          mout<<"   ***  Error  ***  ComplexER"<<endl;
-          mout<<"This keyword can only be applied for tracker which are oriented in z-axis!"<<endl;
-          IsValid = false;
-        } else {
-          NTrackers++;
-        }
-      }
-    }
-    if (NTrackers > 1) {
-      mout<<"   ***  Error  ***  ComplexER"<<endl;
-      mout<<"This keyword can only be applied if only one or none tracker is available!"<<endl;
-      Reset();
-      return false;
+  Size = m_VectorList.size();
+  Out.write(reinterpret_cast<const char*>(&Size), sizeof(Size));
+  for (MDVector* V: m_VectorList) {
+    WriteCacheString(Out, V->GetName());
+    uint32_t NEntries = V->GetSize();
+    Out.write(reinterpret_cast<const char*>(&NEntries), sizeof(NEntries));
+    for (unsigned int e = 0; e < NEntries; ++e) {
+      double Data[4] = { V->GetPosition(e).X(), V->GetPosition(e).Y(), V->GetPosition(e).Z(), V->GetValue(e) };
+      Out.write(reinterpret_cast<const char*>(Data), sizeof(Data));
     }
   }
 
+  uint8_t Deprecated = (FoundDeprecated == true) ? 1 : 0;
+  Out.write(reinterpret_cast<const char*>(&Deprecated), sizeof(Deprecated));
 
-  // We need a trigger criteria
-  if (GetNTriggers() == 0) {
-    mout<<"   ***  Warning  ***  "<<endl;
-    mout<<"You have not defined any trigger criteria!!"<<endl;
-  } else {
-    // Check if each detector has a trigger criterion:
-    for (unsigned int i = 0; i < GetNDetectors(); ++i) {
-      // Guard ring trigger criteria are optional...
-      if (m_DetectorList[i]->GetType() == MDDetector::c_GuardRing) continue;
-
-      bool Found = false;
-      for (unsigned int t = 0; t < GetNTriggers(); ++t) {
-        if (m_TriggerList[t]->Applies(m_DetectorList[i]) == true) {
-          Found = true;
-          break;
-        }
-        // If we have a named detectors, in case the "named after detector" has a trigger criteria, we are fine
-        if (m_DetectorList[i]->IsNamedDetector() == true) {
-          if (m_TriggerList[t]->Applies(m_DetectorList[i]->GetNamedAfterDetector()) == true) {
-            Found = true;
-            break;
-          }
-        }
-        // If the detector has named detectors which have a trigger criteria, we are fine to
-        if (m_DetectorList[i]->HasNamedDetectors() == true) {
-          for (unsigned int n = 0; n < m_DetectorList[i]->GetNNamedDetectors(); ++n) {
-            for (unsigned int t2 = 0; t2 < GetNTriggers(); ++t2) {
-              if (m_TriggerList[t2]->Applies(GetDetector(m_DetectorList[i]->GetNamedDetectorName(n))) == true) {
-                Found = true;
-                break;
-              }
-            }
-          }
-        }
-      }
-      if (Found == false) {
-        mout<<"   ***  Warning  ***  "<<endl;
-        mout<<"You have not defined any trigger criterion for detector: "<<m_DetectorList[i]->GetName()<<endl;
-      }
-    }
+  Size = FileContent.size();
+  Out.write(reinterpret_cast<const char*>(&Size), sizeof(Size));
+  for (auto Iter = FileContent.begin(); Iter != FileContent.end(); ++Iter) {
+    WriteCacheString(Out, (*Iter).GetText());
+    WriteCacheString(Out, (*Iter).GetFileName());
+    int32_t Line = (*Iter).GetLine();
+    Out.write(reinterpret_cast<const char*>(&Line), sizeof(Line));
   }
 
-  if (IsValid == false) {
-    mout<<"   ***  Error  ***  "<<endl;
-    mout<<"There were errors while scanning this file. Correct them first!!"<<endl;
-    Reset();
+  Out.close();
+  if (Out.fail() == true) {
+    MFile::Remove(TemporaryFileName);
     return false;
   }
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (validation & post-processing) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
+  if (rename(TemporaryFileName.Data(), FileName.Data()) != 0) {
+    MFile::Remove(TemporaryFileName);
+    return false;
   }
 
-  // Geant4 requires that the world volume is the first volume in the list
-  // Thus resort the list
-  m_VolumeList.erase(find(m_VolumeList.begin(), m_VolumeList.end(), m_WorldVolume));
-  m_VolumeList.insert(m_VolumeList.begin(), m_WorldVolume);
+  return true;
+}
 
-  // The last stage is to optimize the geometry for hit searches:
-  m_WorldVolume->OptimizeVolumeTree();
 
-  m_GeometryScanned = true;
+////////////////////////////////////////////////////////////////////////////////
 
-  ++Stage;
-  if (g_Verbosity >= c_Info || Timer.ElapsedTime() > TimeLimit) {
-    mout<<"Stage "<<Stage<<" (volume tree optimization) finished after "<<Timer.ElapsedTime()<<" sec"<<endl;
- }
 
-  if (g_Verbosity >= c_Info) {
-    mout<<"Geometry "<<m_FileName<<" successfully scanned within "<<Timer.ElapsedTime()<<"s"<<endl;
-    mout<<"It contains "<<GetNVolumes()<<" volumes"<<endl;
+bool MDGeometry::ReadCache(list<MDDebugInfo>& FileContent, bool& FoundDeprecated)
+{
+  // Read the preprocessed content of the setup file from the cache
+  // The cache is only used if it was created by this version from exactly the same files
+  // Return false if there is no valid cache - then nothing has been changed
+
+  ifstream In(GetCacheFileName().Data(), ios::binary);
+  if (In.is_open() == false) {
+    return false;
   }
 
-  if (FoundDeprecated == true) {
-    mgui<<"Your geometry contains deprecated information (see console output for details)."<<endl;
-    mgui<<"Please update it now to the latest conventions!"<<show;
+  uint32_t Magic = 0;
+  uint32_t Version = 0;
+  if (!In.read(reinterpret_cast<char*>(&Magic), sizeof(Magic)) || Magic != c_CacheMagic) return false;
+  if (!In.read(reinterpret_cast<char*>(&Version), sizeof(Version)) || Version != c_CacheVersion) return false;
+
+  MString String;
+  if (ReadCacheString(In, String) == false || String != g_VersionString) return false;
+  if (ReadCacheString(In, String) == false || String != g_MEGAlibPath) return false;
+  if (ReadCacheString(In, String) == false || String != m_FileName) return false;
+
+  // The key: all included files with their hashes
+  uint32_t Size = 0;
+  if (!In.read(reinterpret_cast<char*>(&Size), sizeof(Size)) || Size == 0) return false;
+  vector<MString> IncludeList(Size);
+  vector<MString> IncludeListHashes(Size);
+  for (unsigned int i = 0; i < Size; ++i) {
+    if (ReadCacheString(In, IncludeList[i]) == false) return false;
+    if (ReadCacheString(In, IncludeListHashes[i]) == false) return false;
+    if (IncludeListHashes[i] == "") return false;
+
+    TMD5* MD5 = TMD5::FileChecksum(IncludeList[i]);
+    if (MD5 == nullptr) return false;
+    MString Hash = MD5->AsString();
+    delete MD5;
+    if (Hash != IncludeListHashes[i]) {
+      if (g_Verbosity >= c_Info) {
+        mout<<"Info: File "<<IncludeList[i]<<" changed since the geometry cache has been created"<<endl;
+      }
+      return false;
+    }
+  }
+
+  vector<MString> ConstantList;
+  if (!In.read(reinterpret_cast<char*>(&Size), sizeof(Size))) return false;
+  for (unsigned int i = 0; i < Size; ++i) {
+    if (ReadCacheString(In, String) == false) return false;
+    ConstantList.push_back(String);
+  }
+  map<MString, MString> ConstantMap;
+  if (!In.read(reinterpret_cast<char*>(&Size), sizeof(Size))) return false;
+  for (unsigned int i = 0; i < Size; ++i) {
+    MString Value;
+    if (ReadCacheString(In, String) == false || ReadCacheString(In, Value) == false) return false;
+    ConstantMap[String] = Value;
+  }
+
+  vector<MDVector*> Vectors;
+  bool VectorsValid = true;
+  if (!In.read(reinterpret_cast<char*>(&Size), sizeof(Size))) return false;
+  for (unsigned int i = 0; i < Size && VectorsValid == true; ++i) {
+    uint32_t NEntries = 0;
+    if (ReadCacheString(In, String) == false || !In.read(reinterpret_cast<char*>(&NEntries), sizeof(NEntries))) {
+      VectorsValid = false;
+      break;
+    }
+    MDVector* V = new MDVector(String);
+    Vectors.push_back(V);
+    for (unsigned int e = 0; e < NEntries; ++e) {
+      double Data[4];
+      if (!In.read(reinterpret_cast<char*>(Data), sizeof(Data))) {
+        VectorsValid = false;
+        break;
+      }
+      V->Add(MVector(Data[0], Data[1], Data[2]), Data[3]);
+    }
+  }
+  if (VectorsValid == false) {
+    for (MDVector* V: Vectors) delete V;
+    return false;
+  }
+
+  uint8_t Deprecated = 0;
+  list<MDDebugInfo> Content;
+  bool ContentValid = true;
+  if (!In.read(reinterpret_cast<char*>(&Deprecated), sizeof(Deprecated)) || !In.read(reinterpret_cast<char*>(&Size), sizeof(Size))) {
+    ContentValid = false;
+  }
+  for (unsigned int i = 0; i < Size && ContentValid == true; ++i) {
+    MString Text;
+    MString FileName;
+    int32_t Line = 0;
+    if (ReadCacheString(In, Text) == false || ReadCacheString(In, FileName) == false || !In.read(reinterpret_cast<char*>(&Line), sizeof(Line))) {
+      ContentValid = false;
+      break;
+    }
+    Content.push_back(MDDebugInfo(Text, FileName, Line));
+  }
+  if (ContentValid == false) {
+    for (MDVector* V: Vectors) delete V;
+    return false;
   }
 
+  // Everything is fine - take it over
+  m_IncludeList = IncludeList;
+  m_IncludeListHashes = IncludeListHashes;
+  m_ConstantList = ConstantList;
+  m_ConstantMap = ConstantMap;
+  for (MDVector* V: Vectors) AddVector(V);
+  FoundDeprecated = (Deprecated == 1);
+  FileContent.swap(Content);
+
   return true;
 }
 
@@ -4820,6 +5162,7 @@ void MDGeometry::AddVolume(MDVolume* Volume)
   // Add a volume to the list
 
   m_VolumeList.push_back(Volume);
+  m_VolumeIndex.emplace(Volume->GetName().GetString(), Volume);
 }
 
 
@@ -4853,52 +5196,16 @@ MDVolume* MDGeometry::GetVolumeAt(const unsigned int i) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDVolume* MDGeometry::GetVolume(const MString& Name)
+MDVolume* MDGeometry::GetVolume(const MString& Name) const
 {
   // Return the volume with name Name or 0 if it does not exist
+  // This function is reentrant, since it only reads the name index
 
-  // This function is not reentrant!!!!
-
-  // ---> begin extremely time critical
-  const unsigned int Size = 20;
-
-  list<MDVolume*>::iterator I;
-  for (I = m_LastVolumes.begin(); I != m_LastVolumes.end(); ++I) {
-    if ((*I)->GetName().AreIdentical(Name)) {
-      return (*I);
-    }
-  }
-
-  unsigned int i, i_max = m_VolumeList.size();
-  for (i = m_LastVolumePosition; i < i_max; ++i) {
-    if (m_VolumeList[i]->GetName().AreIdentical(Name)) {
-      m_LastVolumes.push_front(m_VolumeList[i]);
-      if (m_LastVolumes.size() > Size) m_LastVolumes.pop_back();
-      m_LastVolumePosition = i;
-      return m_VolumeList[i];
-    }
-  }
-  for (i = 0; i < m_LastVolumePosition; ++i) {
-    if (m_VolumeList[i]->GetName().AreIdentical(Name)) {
-      m_LastVolumes.push_front(m_VolumeList[i]);
-      if (m_LastVolumes.size() > Size) m_LastVolumes.pop_back();
-      m_LastVolumePosition = i;
-      return m_VolumeList[i];
-    }
+  auto Iter = m_VolumeIndex.find(Name.GetString());
+  if (Iter != m_VolumeIndex.end()) {
+    return Iter->second;
   }
 
-  // Not optimized:
-  //unsigned int i, i_max = m_VolumeList.size();
-  //for (i = 0; i < i_max; ++i) {
-  //  if (Name == m_VolumeList[i]->GetName()) {
-  //    return m_VolumeList[i];
-  //  }
-  //}
-
-  // Infos: CompareTo is faster than ==
-
-  // <--- end extremely time critical
-
   return 0;
 }
 
@@ -4935,11 +5242,36 @@ unsigned int MDGeometry::GetNVolumes() const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void MDGeometry::BuildNameIndices()
+{
+  // Rebuild all name indices from the lists - as the linear search before, the first entry of a name wins
+
+  m_VolumeIndex.clear();
+  for (MDVolume* V: m_VolumeList) m_VolumeIndex.emplace(V->GetName().GetString(), V);
+  m_MaterialIndex.clear();
+  for (MDMaterial* M: m_MaterialList) m_MaterialIndex.emplace(M->GetName().GetString(), M);
+  m_DetectorIndex.clear();
+  for (MDDetector* D: m_DetectorList) m_DetectorIndex.emplace(D->GetName().GetString(), D);
+  m_ShapeIndex.clear();
+  for (MDShape* S: m_ShapeList) m_ShapeIndex.emplace(S->GetName().GetString(), S);
+  m_OrientationIndex.clear();
+  for (MDOrientation* O: m_OrientationList) m_OrientationIndex.emplace(O->GetName().GetString(), O);
+  m_TriggerIndex.clear();
+  for (MDTrigger* T: m_TriggerList) m_TriggerIndex.emplace(T->GetName().GetString(), T);
+  m_VectorIndex.clear();
+  for (MDVector* V: m_VectorList) m_VectorIndex.emplace(V->GetName().GetString(), V);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void MDGeometry::AddDetector(MDDetector* Detector)
 {
   // Add a volume to the list
 
   m_DetectorList.push_back(Detector);
+  m_DetectorIndex.emplace(Detector->GetName().GetString(), Detector);
 }
 
 
@@ -4962,14 +5294,13 @@ MDDetector* MDGeometry::GetDetectorAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDDetector* MDGeometry::GetDetector(const MString& Name)
+MDDetector* MDGeometry::GetDetector(const MString& Name) const
 {
   // Return the detector with name Name or 0 if it does not exist
 
-  for (unsigned int i = 0; i < GetNDetectors(); i++) {
-    if (Name == m_DetectorList[i]->GetName()) {
-      return m_DetectorList[i];
-    }
+  auto Iter = m_DetectorIndex.find(Name.GetString());
+  if (Iter != m_DetectorIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
@@ -5083,6 +5414,7 @@ void MDGeometry::AddShape(MDShape* Shape)
   // Add a shape to the list
 
   m_ShapeList.push_back(Shape);
+  m_ShapeIndex.emplace(Shape->GetName().GetString(), Shape);
 }
 
 
@@ -5105,14 +5437,13 @@ MDShape* MDGeometry::GetShapeAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDShape* MDGeometry::GetShape(const MString& Name)
+MDShape* MDGeometry::GetShape(const MString& Name) const
 {
   // Return the shape with name Name or 0 if it does not exist
 
-  for (unsigned int i = 0; i < GetNShapes(); i++) {
-    if (Name == m_ShapeList[i]->GetName()) {
-      return m_ShapeList[i];
-    }
+  auto Iter = m_ShapeIndex.find(Name.GetString());
+  if (Iter != m_ShapeIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
@@ -5155,6 +5486,7 @@ void MDGeometry::AddOrientation(MDOrientation* Orientation)
   // Add an orientation to the list
 
   m_OrientationList.push_back(Orientation);
+  m_OrientationIndex.emplace(Orientation->GetName().GetString(), Orientation);
 }
 
 
@@ -5177,14 +5509,13 @@ MDOrientation* MDGeometry::GetOrientationAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDOrientation* MDGeometry::GetOrientation(const MString& Name)
+MDOrientation* MDGeometry::GetOrientation(const MString& Name) const
 {
   // Return the orientation with name Name or 0 if it does not exist
 
-  for (unsigned int i = 0; i < GetNOrientations(); i++) {
-    if (Name == m_OrientationList[i]->GetName()) {
-      return m_OrientationList[i];
-    }
+  auto Iter = m_OrientationIndex.find(Name.GetString());
+  if (Iter != m_OrientationIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
@@ -5226,7 +5557,9 @@ void MDGeometry::AddMaterial(MDMaterial* Material)
 {
   // Add a material to the list
 
+  Material->SetGeometryIndex(m_MaterialList.size());
   m_MaterialList.push_back(Material);
+  m_MaterialIndex.emplace(Material->GetName().GetString(), Material);
 }
 
 
@@ -5249,14 +5582,13 @@ MDMaterial* MDGeometry::GetMaterialAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDMaterial* MDGeometry::GetMaterial(const MString& Name)
+MDMaterial* MDGeometry::GetMaterial(const MString& Name) const
 {
   // Return the material with name Name or 0 if it does not exist
 
-  for (unsigned int i = 0; i < GetNMaterials(); i++) {
-    if (Name == m_MaterialList[i]->GetName()) {
-      return m_MaterialList[i];
-    }
+  auto Iter = m_MaterialIndex.find(Name.GetString());
+  if (Iter != m_MaterialIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
@@ -5300,6 +5632,7 @@ void MDGeometry::AddTrigger(MDTrigger* Trigger)
   // Add a material to the list
 
   m_TriggerList.push_back(Trigger);
+  m_TriggerIndex.emplace(Trigger->GetName().GetString(), Trigger);
 }
 
 
@@ -5322,15 +5655,13 @@ MDTrigger* MDGeometry::GetTriggerAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDTrigger* MDGeometry::GetTrigger(const MString& Name)
+MDTrigger* MDGeometry::GetTrigger(const MString& Name) const
 {
   // Return the material with name Name or 0 if it does not exist
 
-  unsigned int i;
-  for (i = 0; i < GetNTriggers(); i++) {
-    if (Name == m_TriggerList[i]->GetName()) {
-      return m_TriggerList[i];
-    }
+  auto Iter = m_TriggerIndex.find(Name.GetString());
+  if (Iter != m_TriggerIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
@@ -5389,6 +5720,7 @@ void MDGeometry::AddVector(MDVector* Vector)
   // Add a vector to the list
 
   m_VectorList.push_back(Vector);
+  m_VectorIndex.emplace(Vector->GetName().GetString(), Vector);
 }
 
 
@@ -5411,15 +5743,13 @@ MDVector* MDGeometry::GetVectorAt(unsigned int i)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MDVector* MDGeometry::GetVector(const MString& Name)
+MDVector* MDGeometry::GetVector(const MString& Name) const
 {
   // Return the vector with name Name or 0 if it does not exist
 
-  unsigned int i;
-  for (i = 0; i < GetNVectors(); i++) {
-    if (Name == m_VectorList[i]->GetName()) {
-      return m_VectorList[i];
-    }
+  auto Iter = m_VectorIndex.find(Name.GetString());
+  if (Iter != m_VectorIndex.end()) {
+    return Iter->second;
   }
 
   return 0;
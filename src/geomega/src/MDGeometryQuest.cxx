@@ -30,6 +30,10 @@
 #include <iostream>
 #include <iomanip>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
 using namespace std;
 
 // ROOT libs:
@@ -55,7 +59,7 @@ ClassImp(MDGeometryQuest)
 
 
 MDGeometryQuest::MDGeometryQuest() : 
-  m_AllwaysAssumeTrigger(false), m_ActivateNoising(true)
+  m_AllwaysAssumeTrigger(false), m_ActivateNoising(true), m_RayTracingThreadsWarningShown(false)
 {
   // default constructor  
 
@@ -495,7 +499,7 @@ void MDGeometryQuest::GetResolutions(MVector Position, double Energy, double Tim
 double MDGeometryQuest::GetAbsorptionProbability(MVector Start, MVector Stop, 
                                                  double Energy)
 {
-  return GetAbsorptionProbability(Start, Stop, Energy, 0);
+  return GetAbsorptionProbability(Start, Stop, Energy, c_AbsorptionTotal);
 }
 
 
@@ -505,7 +509,7 @@ double MDGeometryQuest::GetAbsorptionProbability(MVector Start, MVector Stop,
 double MDGeometryQuest::GetPhotoAbsorptionProbability(MVector Start, MVector Stop, 
                                                       double Energy)
 {
-  return GetAbsorptionProbability(Start, Stop, Energy, 1);
+  return GetAbsorptionProbability(Start, Stop, Energy, c_AbsorptionPhoto);
 }
 
 
@@ -515,7 +519,7 @@ double MDGeometryQuest::GetPhotoAbsorptionProbability(MVector Start, MVector Sto
 double MDGeometryQuest::GetComptonAbsorptionProbability(MVector Start, MVector Stop, 
                                                         double Energy)
 {
-  return GetAbsorptionProbability(Start, Stop, Energy, 2);
+  return GetAbsorptionProbability(Start, Stop, Energy, c_AbsorptionCompton);
 }
 
 
@@ -525,7 +529,7 @@ double MDGeometryQuest::GetComptonAbsorptionProbability(MVector Start, MVector S
 double MDGeometryQuest::GetPairAbsorptionProbability(MVector Start, MVector Stop, 
                                                       double Energy)
 {
-  return GetAbsorptionProbability(Start, Stop, Energy, 3);
+  return GetAbsorptionProbability(Start, Stop, Energy, c_AbsorptionPair);
 }
 
 
@@ -535,7 +539,7 @@ double MDGeometryQuest::GetPairAbsorptionProbability(MVector Start, MVector Stop
 double MDGeometryQuest::GetRayleighAbsorptionProbability(MVector Start, MVector Stop, 
                                                  double Energy)
 {
-  return GetAbsorptionProbability(Start, Stop, Energy, 4);
+  return GetAbsorptionProbability(Start, Stop, Energy, c_AbsorptionRayleigh);
 }
 
 
@@ -587,23 +591,23 @@ double MDGeometryQuest::GetAbsorptionProbability(MVector Start, MVector Stop,
           <<" Res: "<<exp(-(*LengthsIter).first->GetPhotoAbsorptionCoefficient(Energy)*(*LengthsIter).second)<<endl;
       continue;
     }
-    if (Mode == 1) {
+    if (Mode == c_AbsorptionPhoto) {
       AbsProp *= exp(-(*LengthsIter).first->GetPhotoAbsorptionCoefficient(Energy)*(*LengthsIter).second);
       //cout<<" Mat: "<<(*LengthsIter).first->GetName()
       //    <<" Length: "<<(*LengthsIter).second
       //    <<" Energy: "<<Energy
       //    <<" Coe: "<<(*LengthsIter).first->GetPhotoAbsorptionCoefficient(Energy)
       //    <<" Res: "<<exp(-(*LengthsIter).first->GetPhotoAbsorptionCoefficient(Energy)*(*LengthsIter).second)<<endl;
-    } else if (Mode == 2) {
+    } else if (Mode == c_AbsorptionCompton) {
       AbsProp *= exp(-(*LengthsIter).first->GetComptonAbsorptionCoefficient(Energy)*(*LengthsIter).second);
        //cout<<" Mat: "<<(*LengthsIter).first->GetName()
        //    <<" Length: "<<(*LengthsIter).second
        //    <<" Energy: "<<Energy
        //    <<" Coe: "<<(*LengthsIter).first->GetComptonAbsorptionCoefficient(Energy)
        //    <<" Res: "<<exp(-(*LengthsIter).first->GetComptonAbsorptionCoefficient(Energy)*(*LengthsIter).second)<<endl;
-    } else if (Mode == 3) {
+    } else if (Mode == c_AbsorptionPair) {
       AbsProp *= exp(-(*LengthsIter).first->GetPairAbsorptionCoefficient(Energy)*(*LengthsIter).second);
-    } else if (Mode == 4) {
+    } else if (Mode == c_AbsorptionRayleigh) {
       AbsProp *= exp(-(*LengthsIter).first->GetRayleighAbsorptionCoefficient(Energy)*(*LengthsIter).second);
     } else {
       AbsProp *= exp(-(*LengthsIter).first->GetAbsorptionCoefficient(Energy)*(*LengthsIter).second);
@@ -626,6 +630,224 @@ double MDGeometryQuest::GetAbsorptionProbability(MVector Start, MVector Stop,
 ////////////////////////////////////////////////////////////////////////////////
 
 
+double MDGeometryQuest::GetAbsorptionCoefficient(MDMaterial* Material, double Energy, int Mode)
+{
+  // Return the absorption coefficient of the given material for the Mode
+
+  if (Mode == c_AbsorptionPhoto) {
+    return Material->GetPhotoAbsorptionCoefficient(Energy);
+  } else if (Mode == c_AbsorptionCompton) {
+    return Material->GetComptonAbsorptionCoefficient(Energy);
+  } else if (Mode == c_AbsorptionPair) {
+    return Material->GetPairAbsorptionCoefficient(Energy);
+  } else if (Mode == c_AbsorptionRayleigh) {
+    return Material->GetRayleighAbsorptionCoefficient(Energy);
+  }
+
+  return Material->GetAbsorptionCoefficient(Energy);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MDGeometryQuest::GetAbsorptionProbability(const double* Lengths, double Energy, int Mode)
+{
+  // Return the absorption probability from the path lengths of one ray
+  // Remark: The density has already been incorporated into the coefficient!
+
+  double Exponent = 0.0;
+  for (unsigned int m = 0; m < m_MaterialList.size(); ++m) {
+    if (Lengths[m] > 0) {
+      Exponent += GetAbsorptionCoefficient(m_MaterialList[m], Energy, Mode)*Lengths[m];
+    }
+  }
+
+  double AbsProp = exp(-Exponent);
+  if (AbsProp < 0.0) AbsProp = 0.0;
+  if (AbsProp > 1.0) AbsProp = 1.0;
+
+  return 1.0 - AbsProp;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MDGeometryQuest::GetNRayTracingThreads(unsigned int NThreads, unsigned int NRays)
+{
+  // Return the number of threads to use for the batched ray tracing
+  // The shapes are evaluated by ROOT's TGeo, which is only thread safe if the TGeoManager has been set up for
+  // multi-threading -- Geomega does not do this by default, thus we stay in the calling thread then
+
+  if (NThreads != 1 && (m_Geometry == nullptr || m_Geometry->IsMultiThread() == false)) {
+    if (m_RayTracingThreadsWarningShown == false) {
+      mout<<"Info: The geometry is not set up for multi-threaded navigation - the ray tracing uses one thread"<<endl;
+      m_RayTracingThreadsWarningShown = true;
+    }
+    return 1;
+  }
+
+  if (NThreads == 0) {
+    NThreads = thread::hardware_concurrency();
+    if (NThreads == 0) NThreads = 1;
+  }
+  unsigned int MaximumThreads = NRays / c_MinimumRaysPerThread;
+  if (NThreads > MaximumThreads) NThreads = MaximumThreads;
+  if (NThreads == 0) NThreads = 1;
+
+  return NThreads;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDGeometryQuest::RunRayTracingThreads(unsigned int NThreads, unsigned int NRays, const function<void(unsigned int, unsigned int)>& Function)
+{
+  // Run the function for the ray ranges [Start, Stop[ in NThreads threads
+  // The calling thread processes the first range itself
+
+  NThreads = GetNRayTracingThreads(NThreads, NRays);
+  if (NThreads == 1) {
+    Function(0, NRays);
+    return;
+  }
+
+  // Each additional thread needs its own TGeo navigator
+  auto Worker = [&](unsigned int Start, unsigned int Stop) {
+    TGeoNavigator* Navigator = m_Geometry->AddNavigator();
+    Function(Start, Stop);
+    m_Geometry->RemoveNavigator(Navigator);
+  };
+
+  vector<thread> Threads;
+  unsigned int RaysPerThread = (NRays + NThreads - 1) / NThreads;
+  for (unsigned int t = 1; t < NThreads; ++t) {
+    unsigned int Start = t*RaysPerThread;
+    unsigned int Stop = min(NRays, Start + RaysPerThread);
+    if (Start >= Stop) break;
+    Threads.emplace_back(Worker, Start, Stop);
+  }
+  Function(0, min(NRays, RaysPerThread));
+
+  for (thread& T: Threads) T.join();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometryQuest::GetPathLengths(const MVector& Start, const MVector& Stop, vector<double>& Lengths)
+{
+  // Determine the path lengths of one ray in all materials
+
+  if (m_WorldVolume == nullptr) {
+    merr<<"The geometry has not been scanned!"<<show;
+    return false;
+  }
+
+  Lengths.assign(m_MaterialList.size(), 0.0);
+  m_WorldVolume->GetAbsorptionLengths(Lengths.data(), Start, Stop);
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometryQuest::GetPathLengths(const vector<MVector>& Starts, const vector<MVector>& Stops, vector<double>& Lengths, unsigned int NThreads)
+{
+  // Determine the path lengths in all materials for many rays at once
+  // Lengths[r*GetNMaterials() + m] is the path length of ray r in the material with geometry index m
+
+  if (Starts.size() != Stops.size()) {
+    merr<<"The number of start ("<<Starts.size()<<") and stop ("<<Stops.size()<<") positions is not identical!"<<show;
+    return false;
+  }
+  if (m_WorldVolume == nullptr) {
+    merr<<"The geometry has not been scanned!"<<show;
+    return false;
+  }
+
+  unsigned int NMaterials = m_MaterialList.size();
+  unsigned int NRays = Starts.size();
+
+  Lengths.assign(NRays*NMaterials, 0.0);
+
+  RunRayTracingThreads(NThreads, NRays, [&](unsigned int First, unsigned int Last) {
+    for (unsigned int r = First; r < Last; ++r) {
+      m_WorldVolume->GetAbsorptionLengths(Lengths.data() + r*NMaterials, Starts[r], Stops[r]);
+    }
+  });
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDGeometryQuest::GetAbsorptionProbabilities(const vector<MVector>& Starts, const vector<MVector>& Stops, const vector<double>& Energies, 
+                                                 vector<double>& Probabilities, int Mode, unsigned int NThreads)
+{
+  // Determine the absorption probabilities for many rays at once
+  // The absorption coefficients are only looked up again when the energy changes from one ray to the next
+
+  if (Starts.size() != Stops.size() || Starts.size() != Energies.size()) {
+    merr<<"The number of start ("<<Starts.size()<<"), stop ("<<Stops.size()<<") positions and energies ("<<Energies.size()<<") is not identical!"<<show;
+    return false;
+  }
+  if (m_WorldVolume == nullptr) {
+    merr<<"The geometry has not been scanned!"<<show;
+    return false;
+  }
+
+  unsigned int NMaterials = m_MaterialList.size();
+  unsigned int NRays = Starts.size();
+
+  Probabilities.assign(NRays, 0.0);
+
+  RunRayTracingThreads(NThreads, NRays, [&](unsigned int First, unsigned int Last) {
+    vector<double> Lengths(NMaterials);
+    // The coefficients for the current energy - NaN if not yet looked up
+    vector<double> Coefficients(NMaterials);
+    double CoefficientEnergy = numeric_limits<double>::quiet_NaN();
+
+    for (unsigned int r = First; r < Last; ++r) {
+      fill(Lengths.begin(), Lengths.end(), 0.0);
+      m_WorldVolume->GetAbsorptionLengths(Lengths.data(), Starts[r], Stops[r]);
+
+      if (Energies[r] != CoefficientEnergy) {
+        fill(Coefficients.begin(), Coefficients.end(), numeric_limits<double>::quiet_NaN());
+        CoefficientEnergy = Energies[r];
+      }
+
+      double Exponent = 0.0;
+      for (unsigned int m = 0; m < NMaterials; ++m) {
+        if (Lengths[m] > 0) {
+          if (std::isnan(Coefficients[m]) == true) {
+            Coefficients[m] = GetAbsorptionCoefficient(m_MaterialList[m], Energies[r], Mode);
+          }
+          Exponent += Coefficients[m]*Lengths[m];
+        }
+      }
+
+      double AbsProp = exp(-Exponent);
+      if (AbsProp < 0.0) AbsProp = 0.0;
+      if (AbsProp > 1.0) AbsProp = 1.0;
+      Probabilities[r] = 1.0 - AbsProp;
+    }
+  });
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MDGeometryQuest::GetComptonIntersection(const MComptonEvent& Compton)
 {
   // A Compton cone is parametrized in the following way:
@@ -36,6 +36,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -125,7 +126,7 @@ void MDGuardRing::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Vo
   if (m_NoiseActive == false) return;
   
   // Test for failure:SetNoiseThresholdEqualsTriggerThreshold
-  if (m_FailureRate > 0 && gRandom->Rndm() < m_FailureRate) {
+  if (m_FailureRate > 0 && MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
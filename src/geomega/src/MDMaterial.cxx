@@ -86,6 +86,8 @@ MDMaterial::MDMaterial()
   m_Hash = 0;
   
   m_GeoMedium = 0;
+
+  m_GeometryIndex = g_UnsignedIntNotDefined;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -114,6 +116,8 @@ MDMaterial::MDMaterial(MString Name)
   m_Hash = 0;
   
   m_GeoMedium = 0;
+
+  m_GeometryIndex = g_UnsignedIntNotDefined;
 }
 
 
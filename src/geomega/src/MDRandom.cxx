@@ -0,0 +1,175 @@
+/*
+ * MDRandom.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MDRandom
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MDRandom.h"
+
+// Standard libs:
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+using namespace std;
+
+// ROOT libs:
+#include <TRandom3.h>
+
+// MEGAlib libs:
+#include "MDRandomStream.h"
+#include "MFile.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MDRandom)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The thread which loaded the library - it keeps using gRandom
+static const thread::id g_MDRandomMainThreadID = this_thread::get_id();
+//! The generator of all other threads
+static thread_local unique_ptr<TRandom3> g_ThreadRandom;
+//! The counter-based stream of the calling thread, used while g_UseStream is set
+static thread_local unique_ptr<MDRandomStream> g_Stream;
+//! True if the calling thread uses its counter-based stream
+static thread_local bool g_UseStream = false;
+
+atomic<unsigned int> MDRandom::s_ThreadBaseSeed(0);
+atomic<unsigned int> MDRandom::s_StreamSeed(0);
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+TRandom* MDRandom::Get()
+{
+  // Return the random number generator of the calling thread
+
+  if (g_UseStream == true) {
+    return g_Stream.get();
+  }
+  if (g_ThreadRandom != nullptr) {
+    return g_ThreadRandom.get();
+  }
+  if (this_thread::get_id() == g_MDRandomMainThreadID) {
+    return gRandom;
+  }
+
+  // Without a worker ID there is nothing reproducible to derive the seed from
+  g_ThreadRandom.reset(new TRandom3(0));
+
+  return g_ThreadRandom.get();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandom::SetWorkerID(unsigned int WorkerID)
+{
+  // Declare the calling thread as worker WorkerID and restart its generator
+
+  unsigned int BaseSeed = s_ThreadBaseSeed;
+  g_ThreadRandom.reset(new TRandom3(BaseSeed == 0 ? 0 : BaseSeed + WorkerID + 1));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandom::SetSeed(unsigned int Seed)
+{
+  // Set the seed of the random number generator of the calling thread
+
+  Get()->SetSeed(Seed);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandom::SetStream(unsigned long StreamID, unsigned int SubStreamID, unsigned int RunID)
+{
+  // Let the calling thread use the counter-based stream RunID/StreamID/SubStreamID (restarted) until ClearStream is called
+
+  if (g_Stream == nullptr) {
+    g_Stream.reset(new MDRandomStream());
+  }
+  g_Stream->SetStream(s_StreamSeed, StreamID, SubStreamID, RunID);
+  g_UseStream = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandom::ClearStream()
+{
+  // Let the calling thread use its default generator again
+
+  g_UseStream = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDRandom::HasStream()
+{
+  // Return true if the calling thread uses a counter-based stream
+
+  return g_UseStream;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MDRandom::GetStreamRunID(const MString& FileName)
+{
+  // Return a run ID for the streams of the given file (FNV-1a hash of the base name)
+
+  MString BaseName = MFile::GetBaseName(FileName);
+
+  uint32_t Hash = 2166136261U;
+  for (size_t c = 0; c < BaseName.Length(); ++c) {
+    Hash ^= static_cast<unsigned char>(BaseName[c]);
+    Hash *= 16777619U;
+  }
+
+  return Hash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// MDRandom.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,201 @@
+/*
+ * MDRandomStream.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MDRandomStream
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MDRandomStream.h"
+
+// Standard libs:
+
+// ROOT libs:
+
+// MEGAlib libs:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MDRandomStream)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The Philox multipliers and Weyl constants (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011)
+static const uint32_t c_PhiloxM0 = 0xD2511F53;
+static const uint32_t c_PhiloxM1 = 0xCD9E8D57;
+static const uint32_t c_PhiloxW0 = 0x9E3779B9;
+static const uint32_t c_PhiloxW1 = 0xBB67AE85;
+//! The number of Philox rounds
+static const unsigned int c_PhiloxRounds = 10;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MDRandomStream::MDRandomStream() : TRandom(0)
+{
+  // Construct an instance of MDRandomStream
+
+  SetName("MDRandomStream");
+  SetTitle("Philox4x32-10 counter-based random number generator");
+
+  SetStream(0, 0, 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MDRandomStream::~MDRandomStream()
+{
+  // Delete this instance of MDRandomStream
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandomStream::SetStream(unsigned int Seed, unsigned long StreamID, unsigned int SubStreamID, unsigned int RunID)
+{
+  // Select the stream and restart it at its first random number
+
+  m_Seed = Seed;
+
+  uint64_t ID = StreamID;
+  m_Key[0] = static_cast<uint32_t>(ID);
+  m_Key[1] = static_cast<uint32_t>(ID >> 32);
+
+  m_Counter[0] = 0;
+  m_Counter[1] = RunID;
+  m_Counter[2] = SubStreamID;
+  m_Counter[3] = m_Seed;
+
+  // Start with an exhausted block
+  m_BlockPosition = 4;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandomStream::SetSeed(ULong_t Seed)
+{
+  // Set the seed but keep the run, stream and sub-stream, and restart the stream
+
+  m_Seed = static_cast<uint32_t>(Seed);
+  m_Counter[0] = 0;
+  m_Counter[3] = m_Seed;
+  m_BlockPosition = 4;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandomStream::NextBlock()
+{
+  // Calculate the next block of four 32-bit random numbers and increase the counter
+
+  uint32_t C[4] = { m_Counter[0], m_Counter[1], m_Counter[2], m_Counter[3] };
+  uint32_t K[2] = { m_Key[0], m_Key[1] };
+
+  for (unsigned int r = 0; r < c_PhiloxRounds; ++r) {
+    uint64_t P0 = static_cast<uint64_t>(c_PhiloxM0) * C[0];
+    uint64_t P1 = static_cast<uint64_t>(c_PhiloxM1) * C[2];
+    uint32_t Hi0 = static_cast<uint32_t>(P0 >> 32);
+    uint32_t Lo0 = static_cast<uint32_t>(P0);
+    uint32_t Hi1 = static_cast<uint32_t>(P1 >> 32);
+    uint32_t Lo1 = static_cast<uint32_t>(P1);
+
+    C[0] = Hi1 ^ C[1] ^ K[0];
+    C[1] = Lo1;
+    C[2] = Hi0 ^ C[3] ^ K[1];
+    C[3] = Lo0;
+
+    K[0] += c_PhiloxW0;
+    K[1] += c_PhiloxW1;
+  }
+
+  m_Block[0] = C[0];
+  m_Block[1] = C[1];
+  m_Block[2] = C[2];
+  m_Block[3] = C[3];
+  m_BlockPosition = 0;
+
+  // The block number wraps around after 2^32 blocks, it must not run into the run ID
+  ++m_Counter[0];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+Double_t MDRandomStream::Rndm()
+{
+  // Return a uniformly distributed random number in ]0, 1[
+
+  if (m_BlockPosition >= 4) NextBlock();
+
+  // 53 random bits, centered in their interval, thus never exactly 0 or 1
+  uint64_t Bits = ((static_cast<uint64_t>(m_Block[m_BlockPosition]) << 32) | m_Block[m_BlockPosition+1]) >> 11;
+  m_BlockPosition += 2;
+
+  return (Bits + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandomStream::RndmArray(Int_t N, Float_t* Array)
+{
+  // Fill the array with N uniformly distributed random numbers in ]0, 1[
+
+  for (Int_t i = 0; i < N; ++i) {
+    // Values very close to 1 round to 1 as float, thus redraw those
+    do {
+      Array[i] = static_cast<Float_t>(Rndm());
+    } while (Array[i] >= 1.0f);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDRandomStream::RndmArray(Int_t N, Double_t* Array)
+{
+  // Fill the array with N uniformly distributed random numbers in ]0, 1[
+
+  for (Int_t i = 0; i < N; ++i) {
+    Array[i] = Rndm();
+  }
+}
+
+
+// MDRandomStream.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +45,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -225,9 +226,9 @@ MVector MDShape::GetRandomPositionInside()
 
   unsigned long Counter = 0;
   do {
-    R.SetX((2.0*gRandom->Rndm()-1.0)*BBox->GetDX() + BBox->GetOrigin()[0]);
-    R.SetY((2.0*gRandom->Rndm()-1.0)*BBox->GetDY() + BBox->GetOrigin()[1]);
-    R.SetZ((2.0*gRandom->Rndm()-1.0)*BBox->GetDZ() + BBox->GetOrigin()[2]);
+    R.SetX((2.0*MDRandom::Get()->Rndm()-1.0)*BBox->GetDX() + BBox->GetOrigin()[0]);
+    R.SetY((2.0*MDRandom::Get()->Rndm()-1.0)*BBox->GetDY() + BBox->GetOrigin()[1]);
+    R.SetZ((2.0*MDRandom::Get()->Rndm()-1.0)*BBox->GetDZ() + BBox->GetOrigin()[2]);
 
     Counter++;
 
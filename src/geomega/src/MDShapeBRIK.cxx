@@ -36,6 +36,7 @@ using namespace std;
 
 // MEGAlib libs:
 #include "MStreams.h"
+#include "MDRandom.h"
 #include "MAssert.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -345,9 +346,9 @@ MVector MDShapeBRIK::GetRandomPositionInside()
 {
   // Return a random position inside this shape
 
-  return MVector((2.0*gRandom->Rndm()-1.0)*m_Dx, 
-                 (2.0*gRandom->Rndm()-1.0)*m_Dy, 
-                 (2.0*gRandom->Rndm()-1.0)*m_Dz);
+  return MVector((2.0*MDRandom::Get()->Rndm()-1.0)*m_Dx, 
+                 (2.0*MDRandom::Get()->Rndm()-1.0)*m_Dy, 
+                 (2.0*MDRandom::Get()->Rndm()-1.0)*m_Dz);
 }
 
 
@@ -38,6 +38,7 @@ using namespace std;
 // MEGALib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -142,10 +143,10 @@ bool MDShapeSubtraction::Validate()
     m_Geo = new TGeoCompositeShape(m_Name, Node);
     
     // Determine an almost unique position inside this shape:
-    unsigned int Seed = gRandom->GetSeed();
-    gRandom->SetSeed(12345678);
+    unsigned int Seed = MDRandom::Get()->GetSeed();
+    MDRandom::Get()->SetSeed(12345678);
     m_AlmostUniquePosition = GetRandomPositionInside();
-    gRandom->SetSeed(Seed);
+    MDRandom::Get()->SetSeed(Seed);
     
     m_IsValidated = true;
   }
@@ -37,6 +37,7 @@ using namespace std;
 // MEGALib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -340,9 +341,9 @@ MVector MDShapeTUBS::GetRandomPositionInside()
 {
   // Return a random position inside this shape
 
-  double Phi = m_Phi1 + gRandom->Rndm()*(m_Phi2-m_Phi1);
-  double R = sqrt(m_Rmin*m_Rmin + (m_Rmax*m_Rmax-m_Rmin*m_Rmin)*gRandom->Rndm());
-  double H = (2*gRandom->Rndm()-1)*m_HalfHeight;
+  double Phi = m_Phi1 + MDRandom::Get()->Rndm()*(m_Phi2-m_Phi1);
+  double R = sqrt(m_Rmin*m_Rmin + (m_Rmax*m_Rmax-m_Rmin*m_Rmin)*MDRandom::Get()->Rndm());
+  double H = (2*MDRandom::Get()->Rndm()-1)*m_HalfHeight;
 
   return MVector(R*cos(Phi*c_Rad), R*sin(Phi*c_Rad), H);
 }
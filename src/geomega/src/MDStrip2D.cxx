@@ -41,6 +41,7 @@ using namespace std;
 #include "MDShapeSubtraction.h"
 #include "MDShapeIntersection.h"
 #include "MDGuardRing.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -199,7 +200,7 @@ void MDStrip2D::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volu
   if (m_NoiseActive == false) return;
 
   // Test for failure:
-  if (m_FailureRate > 0 && gRandom->Rndm() < m_FailureRate) {
+  if (m_FailureRate > 0 && MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -703,25 +704,25 @@ bool MDStrip2D::Validate()
           return false;        
         }
         
-        if (gRandom->Rndm() < 0.5) {
-          if (gRandom->Rndm() < 0.5) {
-            UniqueGuardRingPosition.SetXYZ(m_WidthX*(gRandom->Rndm()-0.5),
-                                             +0.5*m_WidthY - gRandom->Rndm()*m_OffsetY,
-                                             m_StructuralDimension.Z()*(gRandom->Rndm()-0.5));
+        if (MDRandom::Get()->Rndm() < 0.5) {
+          if (MDRandom::Get()->Rndm() < 0.5) {
+            UniqueGuardRingPosition.SetXYZ(m_WidthX*(MDRandom::Get()->Rndm()-0.5),
+                                             +0.5*m_WidthY - MDRandom::Get()->Rndm()*m_OffsetY,
+                                             m_StructuralDimension.Z()*(MDRandom::Get()->Rndm()-0.5));
           } else {
-            UniqueGuardRingPosition.SetXYZ(m_WidthX*(gRandom->Rndm()-0.5),
-                                             -0.5*m_WidthY + gRandom->Rndm()*m_OffsetY,
-                                             m_StructuralDimension.Z()*(gRandom->Rndm()-0.5));
+            UniqueGuardRingPosition.SetXYZ(m_WidthX*(MDRandom::Get()->Rndm()-0.5),
+                                             -0.5*m_WidthY + MDRandom::Get()->Rndm()*m_OffsetY,
+                                             m_StructuralDimension.Z()*(MDRandom::Get()->Rndm()-0.5));
           }
         } else {
-          if (gRandom->Rndm() < 0.5) {
-            UniqueGuardRingPosition.SetXYZ(+0.5*m_WidthX - gRandom->Rndm()*m_OffsetX,
-                                             m_WidthY*(gRandom->Rndm()-0.5),
-                                             m_StructuralDimension.Z()*(gRandom->Rndm()-0.5));
+          if (MDRandom::Get()->Rndm() < 0.5) {
+            UniqueGuardRingPosition.SetXYZ(+0.5*m_WidthX - MDRandom::Get()->Rndm()*m_OffsetX,
+                                             m_WidthY*(MDRandom::Get()->Rndm()-0.5),
+                                             m_StructuralDimension.Z()*(MDRandom::Get()->Rndm()-0.5));
           } else {
-            UniqueGuardRingPosition.SetXYZ(-0.5*m_WidthX + gRandom->Rndm()*m_OffsetX,
-                                             m_WidthY*(gRandom->Rndm()-0.5),
-                                             m_StructuralDimension.Z()*(gRandom->Rndm()-0.5));
+            UniqueGuardRingPosition.SetXYZ(-0.5*m_WidthX + MDRandom::Get()->Rndm()*m_OffsetX,
+                                             m_WidthY*(MDRandom::Get()->Rndm()-0.5),
+                                             m_StructuralDimension.Z()*(MDRandom::Get()->Rndm()-0.5));
           }
         }
       }
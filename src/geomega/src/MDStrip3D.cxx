@@ -35,6 +35,7 @@ using namespace std;
 
 // MEGAlib libs:
 #include "MAssert.h"
+#include "MDRandom.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -543,7 +544,7 @@ void MDStrip3D::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volu
   bool IsOverflow = false;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -568,7 +569,7 @@ void MDStrip3D::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volu
     int Trials = 5;
     double Sigma;
     do {
-      Sigma = gRandom->Gaus(m_DepthResolution.Evaluate(Energy), 
+      Sigma = MDRandom::Get()->Gaus(m_DepthResolution.Evaluate(Energy), 
                             m_DepthResolutionSigma.Evaluate(Energy));
       Trials--;
     } while (Sigma < 0 && Trials >= 0);
@@ -579,7 +580,7 @@ void MDStrip3D::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volu
     // Step 2: Determine the position
     double z = numeric_limits<double>::max();
     while (z < -m_StructuralSize[2] || z > m_StructuralSize[2]) {
-      z = gRandom->Gaus(Pos[2], Sigma);
+      z = MDRandom::Get()->Gaus(Pos[2], Sigma);
     }
     Pos[2] = z;
   }
@@ -35,6 +35,7 @@ using namespace std;
 
 // MEGAlib libs:
 #include "MAssert.h"
+#include "MDRandom.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -197,7 +198,7 @@ bool MDStrip3DDirectional::NoiseDirection(MVector& Dir, double Energy) const
     int Trials = 5;
     double Sigma;
     do {
-      Sigma = gRandom->Gaus(m_DirectionalResolution.Evaluate(Energy), 
+      Sigma = MDRandom::Get()->Gaus(m_DirectionalResolution.Evaluate(Energy), 
                             m_DirectionalResolutionSigma.Evaluate(Energy));
       Trials--;
     } while (Sigma < 0 && Trials >= 0);
@@ -205,7 +206,7 @@ bool MDStrip3DDirectional::NoiseDirection(MVector& Dir, double Energy) const
       Sigma = m_DirectionalResolution.Evaluate(Energy);
     }
   
-    Angle = gRandom->Gaus(Angle, Sigma);
+    Angle = MDRandom::Get()->Gaus(Angle, Sigma);
 
     // Back to x and y: 
     Dir[0] = cos(Angle);
@@ -36,6 +36,7 @@ using namespace std;
 #include "MAssert.h"
 #include "MStreams.h"
 #include "MDDetector.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,7 +99,7 @@ void MDSystem::NoiseTime(MTime& Time)
 
   if (m_TimeResolutionType == c_TimeResolutionTypeGauss) {
     MTime Noise;
-    double Diff = gRandom->Gaus(0.0, m_TimeResolutionGaussSigma);
+    double Diff = MDRandom::Get()->Gaus(0.0, m_TimeResolutionGaussSigma);
     Noise.Set(Diff);
     Time += Noise;
   }
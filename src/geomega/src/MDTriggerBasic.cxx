@@ -460,6 +460,34 @@ bool MDTriggerBasic::Applies(MDDetector* Detector) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MDTriggerBasic::Accepts(MDDetector* Detector, int Type) const
+{
+  //! Return true if the hit matching of AddHit (Type: c_Detector) or AddGuardRingHit (Type: c_GuardRing) accepts this detector
+
+  if (Detector == 0) return false;
+  if (Detector->IsNamedDetector() == true) Detector = Detector->GetNamedAfterDetector();
+
+  if (m_DetectorTypes.size() != 0) {
+    for (unsigned int i = 0; i < m_DetectorTypes.size(); ++i) {
+      if (m_DetectorTypes[i] == Detector->GetType() && m_Types[i] == Type) {
+        return true;
+      }
+    }
+  } else {
+    for (unsigned int i = 0; i < m_Detectors.size(); ++i) {
+      if (m_Detectors[i]->GetName() == Detector->GetName() && m_Types[i] == Type) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MDTriggerBasic::IncludesDetectorAsPositiveTrigger(MDDetector* Detector)
 {
   //! Return true, if this detector is part of this trigger, excluding vetoes and guard rings
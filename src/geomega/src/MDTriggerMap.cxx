@@ -598,6 +598,21 @@ bool MDTriggerMap::Applies(MDDetector* Detector) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MDTriggerMap::AcceptsGuardRingHit(MDDetector* Detector) const
+{
+  //! Return true if AddGuardRingHit would accept a hit in the guard ring of this detector
+
+  if (Detector == nullptr || Detector->HasGuardRing() == false || Detector->GetGuardRing() == nullptr) {
+    return false;
+  }
+  
+  return Applies(Detector->GetGuardRing());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 MString MDTriggerMap::GetGeomega() const
 {
   // Return as Geomega type volume tree
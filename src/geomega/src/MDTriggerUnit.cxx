@@ -27,6 +27,8 @@
 #include "MDTriggerUnit.h"
 
 // Standard libs:
+#include <algorithm>
+using namespace std;
 
 // ROOT libs:
 
@@ -65,6 +67,49 @@ MDTriggerUnit::MDTriggerUnit(MDGeometry* Geometry)
 
   m_IgnoreVetoes = false;
   m_IgnoreThresholds = false;
+
+  m_UseCompiledEvaluation = true;
+  m_IsCompiled = false;
+  m_NCompiledTriggers = 0;
+  m_IsDecided = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MDTriggerUnit::MDTriggerUnit(const MDTriggerUnit& TriggerUnit)
+{
+  // Copy the settings and the compiled tables - the triggers, which store the event data, are cloned
+
+  m_Geometry = TriggerUnit.m_Geometry;
+
+  for (unsigned int t = 0; t < TriggerUnit.GetNTriggers(); ++t) {
+    m_Triggers.push_back(TriggerUnit.GetTriggerAt(t)->Clone());
+    m_Triggers.back()->Reset();
+  }
+
+  m_AlwaysAssumeTrigger = TriggerUnit.m_AlwaysAssumeTrigger;
+  m_AlwaysAssumeVeto = TriggerUnit.m_AlwaysAssumeVeto;
+
+  m_IgnoreVetoes = TriggerUnit.m_IgnoreVetoes;
+  m_IgnoreThresholds = TriggerUnit.m_IgnoreThresholds;
+
+  m_UseCompiledEvaluation = TriggerUnit.m_UseCompiledEvaluation;
+  m_IsCompiled = TriggerUnit.m_IsCompiled;
+  m_NCompiledTriggers = TriggerUnit.m_NCompiledTriggers;
+  m_HitTriggers = TriggerUnit.m_HitTriggers;
+  m_GuardRingHitTriggers = TriggerUnit.m_GuardRingHitTriggers;
+
+  m_EmptyTriggered = TriggerUnit.m_EmptyTriggered;
+  m_EmptyNonVetoablyTriggered = TriggerUnit.m_EmptyNonVetoablyTriggered;
+  m_EmptyVetoed = TriggerUnit.m_EmptyVetoed;
+  m_Triggered = m_EmptyTriggered;
+  m_NonVetoablyTriggered = m_EmptyNonVetoablyTriggered;
+  m_Vetoed = m_EmptyVetoed;
+  m_Touched.assign(TriggerUnit.m_Touched.size(), 0);
+  m_TouchedTriggers.reserve(m_Triggers.size());
+  m_IsDecided = false;
 }
 
 
@@ -75,6 +120,9 @@ MDTriggerUnit::~MDTriggerUnit()
 {
   // Delete this instance of MDTriggerUnit
   
+  for (MDTrigger* T: m_Triggers) {
+    delete T;
+  }
   m_Geometry = 0;
 }
 
@@ -82,26 +130,87 @@ MDTriggerUnit::~MDTriggerUnit()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+MDTrigger* MDTriggerUnit::GetTriggerAt(unsigned int t) const
+{
+  // Return the trigger at position t - our own copy if we have one, otherwise the geometry's
+
+  if (m_Triggers.empty() == false) {
+    return m_Triggers[t];
+  }
+  return m_Geometry->GetTriggerAt(t);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MDTriggerUnit::GetNTriggers() const
+{
+  // Return the number of triggers
+
+  if (m_Triggers.empty() == false) {
+    return m_Triggers.size();
+  }
+  return m_Geometry->GetNTriggers();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void MDTriggerUnit::Reset()
 {
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    m_Geometry->GetTriggerAt(t)->Reset();
+  // Reset the stored event data - with the compiled tables only the triggers which received hits
+
+  if (IsCompiled() == true) {
+    for (unsigned int t: m_TouchedTriggers) {
+      GetTriggerAt(t)->Reset();
+    }
+  } else {
+    for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+      GetTriggerAt(t)->Reset();
+    }
   }
+
+  fill(m_Touched.begin(), m_Touched.end(), 0);
+  m_TouchedTriggers.clear();
+  m_IsDecided = false;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool MDTriggerUnit::Validate() const
+void MDTriggerUnit::UseCompiledEvaluation(bool UseCompiled)
 {
-  // Validate the trigger unit
+  // Use the compiled trigger tables, or loop over all triggers for each hit and decision
+
+  m_UseCompiledEvaluation = UseCompiled;
+
+  // Start from a clean state, since the other mode does not know which triggers received hits
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    GetTriggerAt(t)->Reset();
+  }
+  fill(m_Touched.begin(), m_Touched.end(), 0);
+  m_TouchedTriggers.clear();
+  m_IsDecided = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDTriggerUnit::Validate()
+{
+  // Validate the trigger unit and compile the trigger tables
+
+  m_IsCompiled = false;
   
   // Check that we do not mix Basic and Universal triggers classes
-  if (m_Geometry->GetNTriggers() > 0) {
-    MDTriggerType Type = m_Geometry->GetTriggerAt(0)->GetType();
-    for (unsigned int t = 1; t < m_Geometry->GetNTriggers(); ++t) {
-      if (m_Geometry->GetTriggerAt(t)->GetType() != Type) {
+  if (GetNTriggers() > 0) {
+    MDTriggerType Type = GetTriggerAt(0)->GetType();
+    for (unsigned int t = 1; t < GetNTriggers(); ++t) {
+      if (GetTriggerAt(t)->GetType() != Type) {
         mout<<"   ***  Error  ***  in trigger unit"<<endl;
         mout<<"You cannot mix trigger class (e.g. basic and universal)"<<endl;
         return false;
@@ -110,9 +219,9 @@ bool MDTriggerUnit::Validate() const
   }
   
   // Check if all detectors are existing for universal triggers
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    if (m_Geometry->GetTriggerAt(t)->GetType() == MDTriggerType::c_Universal) {
-      vector<MString> DetectorNames = dynamic_cast<MDTriggerMap*>(m_Geometry->GetTriggerAt(t))->GetDetectors();
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->GetType() == MDTriggerType::c_Universal) {
+      vector<MString> DetectorNames = dynamic_cast<MDTriggerMap*>(GetTriggerAt(t))->GetDetectors();
       
       vector<MDDetector*> Detectors = m_Geometry->GetDetectorList();
       for (MString Name: DetectorNames) {
@@ -124,7 +233,7 @@ bool MDTriggerUnit::Validate() const
           }
         }
         if (Found == false) {
-          mout<<"   ***  Error  ***  in trigger "<<m_Geometry->GetTriggerAt(t)->GetName()<<endl;
+          mout<<"   ***  Error  ***  in trigger "<<GetTriggerAt(t)->GetName()<<endl;
           mout<<"Unknown detector: "<<Name<<endl;
           return false;          
         }
@@ -136,11 +245,11 @@ bool MDTriggerUnit::Validate() const
   for (unsigned int d = 0; d < m_Geometry->GetNDetectors(); ++d) {
     int NVetoes = 0;
     int NTriggers = 0;
-    for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-      if (m_Geometry->GetTriggerAt(t)->IsVetoing(m_Geometry->GetDetectorAt(d)) == true) {
+    for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+      if (GetTriggerAt(t)->IsVetoing(m_Geometry->GetDetectorAt(d)) == true) {
         NVetoes++;
       }
-      if (m_Geometry->GetTriggerAt(t)->IsTriggering(m_Geometry->GetDetectorAt(d)) == true) {
+      if (GetTriggerAt(t)->IsTriggering(m_Geometry->GetDetectorAt(d)) == true) {
         NTriggers++; 
       }
     }
@@ -151,6 +260,7 @@ bool MDTriggerUnit::Validate() const
     }
   }  
   
+  Compile();
   
   return true;
 }
@@ -159,12 +269,142 @@ bool MDTriggerUnit::Validate() const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void MDTriggerUnit::Compile()
+{
+  // Build the detector -> affected-triggers tables and the trigger masks of an empty event
+  // Afterwards AddHit only has to touch the triggers which can accept the hit, 
+  // and the decisions only have to re-evaluate the triggers which received hits
+
+  unsigned int NTriggers = GetNTriggers();
+  unsigned int NWords = (NTriggers + 63)/64;
+
+  m_HitTriggers.clear();
+  m_GuardRingHitTriggers.clear();
+
+  vector<MDDetector*> Detectors = m_Geometry->GetDetectorList();
+  for (MDDetector* D: Detectors) {
+    vector<unsigned int>& HitTriggers = m_HitTriggers[D];
+    for (unsigned int t = 0; t < NTriggers; ++t) {
+      if (GetTriggerAt(t)->AcceptsHit(D) == true) {
+        HitTriggers.push_back(t);
+      }
+    }
+    if (D->HasGuardRing() == true) {
+      vector<unsigned int>& GuardRingHitTriggers = m_GuardRingHitTriggers[D];
+      for (unsigned int t = 0; t < NTriggers; ++t) {
+        if (GetTriggerAt(t)->AcceptsGuardRingHit(D) == true) {
+          GuardRingHitTriggers.push_back(t);
+        }
+      }
+    }
+  }
+
+  // The state of the triggers without any hits (e.g. a trigger requiring zero hits)
+  m_EmptyTriggered.assign(NWords, 0);
+  m_EmptyNonVetoablyTriggered.assign(NWords, 0);
+  m_EmptyVetoed.assign(NWords, 0);
+  for (unsigned int t = 0; t < NTriggers; ++t) {
+    MDTrigger* T = GetTriggerAt(t);
+    T->Reset();
+    if (T->HasTriggered() == true) m_EmptyTriggered[t/64] |= uint64_t(1) << (t%64);
+    if (T->HasNonVetoablyTriggered() == true) m_EmptyNonVetoablyTriggered[t/64] |= uint64_t(1) << (t%64);
+    if (T->HasVetoed() == true) m_EmptyVetoed[t/64] |= uint64_t(1) << (t%64);
+  }
+
+  m_Triggered = m_EmptyTriggered;
+  m_NonVetoablyTriggered = m_EmptyNonVetoablyTriggered;
+  m_Vetoed = m_EmptyVetoed;
+  m_Touched.assign(NWords, 0);
+  m_TouchedTriggers.clear();
+  m_TouchedTriggers.reserve(NTriggers);
+  m_IsDecided = true;
+
+  m_NCompiledTriggers = NTriggers;
+  m_IsCompiled = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDTriggerUnit::IsCompiled() const
+{
+  // Return true if the compiled tables can be used, i.e. they exist and the triggers have not changed since
+
+  return m_UseCompiledEvaluation == true && m_IsCompiled == true && m_NCompiledTriggers == GetNTriggers();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDTriggerUnit::Touch(unsigned int t)
+{
+  // Mark the trigger as touched by the current event
+
+  uint64_t Bit = uint64_t(1) << (t%64);
+  if ((m_Touched[t/64] & Bit) == 0) {
+    m_Touched[t/64] |= Bit;
+    m_TouchedTriggers.push_back(t);
+  }
+  m_IsDecided = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDTriggerUnit::Decide()
+{
+  // Evaluate the touched triggers and update the trigger masks
+
+  if (m_IsDecided == true) return;
+
+  m_Triggered = m_EmptyTriggered;
+  m_NonVetoablyTriggered = m_EmptyNonVetoablyTriggered;
+  m_Vetoed = m_EmptyVetoed;
+
+  for (unsigned int t: m_TouchedTriggers) {
+    MDTrigger* T = GetTriggerAt(t);
+    uint64_t Bit = uint64_t(1) << (t%64);
+    if (T->HasTriggered() == true) m_Triggered[t/64] |= Bit; else m_Triggered[t/64] &= ~Bit;
+    if (T->HasNonVetoablyTriggered() == true) m_NonVetoablyTriggered[t/64] |= Bit; else m_NonVetoablyTriggered[t/64] &= ~Bit;
+    if (T->HasVetoed() == true) m_Vetoed[t/64] |= Bit; else m_Vetoed[t/64] &= ~Bit;
+  }
+
+  m_IsDecided = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MDTriggerUnit::Any(const vector<uint64_t>& Mask)
+{
+  // Return true if any bit in the mask is set
+
+  for (uint64_t Word: Mask) {
+    if (Word != 0) return true;
+  }
+
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Set a flag indicating that vetoes are ignored and transfer it to all triggers
 void MDTriggerUnit::IgnoreVetoes(bool IgnoreVetoesFlag) 
 { 
   m_IgnoreVetoes = IgnoreVetoesFlag; 
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    m_Geometry->GetTriggerAt(t)->IgnoreVetoes(m_IgnoreVetoes);
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    GetTriggerAt(t)->IgnoreVetoes(m_IgnoreVetoes);
+  }
+
+  // The veto decisions of the triggers have changed, thus the empty-event masks too
+  if (m_IsCompiled == true) {
+    Compile();
   }
 }
 
@@ -175,8 +415,8 @@ void MDTriggerUnit::IgnoreVetoes(bool IgnoreVetoesFlag)
 //! Return true if this detector is never triggering
 bool MDTriggerUnit::IsNeverTriggering(MDDetector* D) const
 {
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    if (m_Geometry->GetTriggerAt(t)->IsTriggering(D) == true) {
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->IsTriggering(D) == true) {
       return false;
     }
   }
@@ -203,21 +443,42 @@ bool MDTriggerUnit::AddHit(const double& Energy, MDVolumeSequence& V)
 {
   bool Added = false;
 
-  if (V.GetDetector() != 0) {
-    for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-      mdebug<<"Trying to a hit with "<<Energy<<" keV in detector "<<V.GetDetector()->GetName()<<" to trigger "<<m_Geometry->GetTriggerAt(t)->GetName()<<endl;
-      if (m_IgnoreThresholds == true || V.GetDetector()->IsAboveTriggerThreshold(Energy, V.GetGridPoint()) == true) { 
-        mdebug<<" --> Above trigger threshold ";
-        if (m_Geometry->GetTriggerAt(t)->AddHit(V) == true) {
-          mdebug<<" and added"<<endl;
+  if (V.GetDetector() == 0) {
+    merr<<"MDTriggerUnit: No detector for hit at position: "<<V.GetPositionAt(0)<<show;
+    return false;
+  }
+
+  // The noised trigger threshold is drawn once per hit and used for all triggers,
+  // thus the compiled evaluation and the loop below use the same random numbers
+  bool Above = (GetNTriggers() > 0 && (m_IgnoreThresholds == true || V.GetDetector()->IsAboveTriggerThreshold(Energy, V.GetGridPoint()) == true));
+
+  // Only the triggers which can accept a hit in this detector are asked
+  if (IsCompiled() == true) {
+    auto Iter = m_HitTriggers.find(V.GetDetector());
+    if (Iter != m_HitTriggers.end()) {
+      if (Above == false) return false;
+      for (unsigned int t: Iter->second) {
+        if (GetTriggerAt(t)->AddHit(V) == true) {
           Added = true;
-        } else {
-          mdebug<<" but NOT added"<<endl;
         }
+        Touch(t);
+      }
+      return Added;
+    }
+  }
+
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    mdebug<<"Trying to a hit with "<<Energy<<" keV in detector "<<V.GetDetector()->GetName()<<" to trigger "<<GetTriggerAt(t)->GetName()<<endl;
+    if (Above == true) { 
+      mdebug<<" --> Above trigger threshold ";
+      if (GetTriggerAt(t)->AddHit(V) == true) {
+        mdebug<<" and added"<<endl;
+        Added = true;
+        if (IsCompiled() == true) Touch(t);
+      } else {
+        mdebug<<" but NOT added"<<endl;
       }
     }
-  } else {
-    merr<<"MDTriggerUnit: No detector for hit at position: "<<V.GetPositionAt(0)<<show;
   }
 
   return Added;
@@ -243,17 +504,40 @@ bool MDTriggerUnit::AddGuardRingHit(const double& Energy, MDVolumeSequence& V)
 {
   bool Added = false;
 
-  if (V.GetDetector() != 0) {
-    for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-      if (V.GetDetector()->HasGuardRing() == true) {
-        if (m_IgnoreThresholds == true || V.GetDetector()->GetGuardRing()->IsAboveTriggerThreshold(Energy, V.GetGridPoint()) == true) { 
-          if (m_Geometry->GetTriggerAt(t)->AddGuardRingHit(V) == true) {
-            Added = true;
-          }
+  if (V.GetDetector() == 0) return false;
+
+  if (V.GetDetector()->HasGuardRing() == false) {
+    if (GetNTriggers() > 0) {
+      merr<<"Detector "<<V.GetDetector()->GetName()<<" has no guardring ?? !!"<<endl;
+    }
+    return false;
+  }
+
+  // The noised trigger threshold is drawn once per hit and used for all triggers,
+  // thus the compiled evaluation and the loop below use the same random numbers
+  bool Above = (GetNTriggers() > 0 && (m_IgnoreThresholds == true || V.GetDetector()->GetGuardRing()->IsAboveTriggerThreshold(Energy, V.GetGridPoint()) == true));
+
+  // Only the triggers which can accept a hit in the guard ring of this detector are asked
+  if (IsCompiled() == true) {
+    auto Iter = m_GuardRingHitTriggers.find(V.GetDetector());
+    if (Iter != m_GuardRingHitTriggers.end()) {
+      if (Above == false) return false;
+      for (unsigned int t: Iter->second) {
+        if (GetTriggerAt(t)->AddGuardRingHit(V) == true) {
+          Added = true;
         }
-      } else {
-        merr<<"Detector "<<V.GetDetector()->GetName()<<" has no guardring ?? !!"<<endl;
+        Touch(t);
       }
+      return Added;
+    }
+  }
+
+  if (Above == false) return false;
+
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->AddGuardRingHit(V) == true) {
+      Added = true;
+      if (IsCompiled() == true) Touch(t);
     }
   }
 
@@ -276,16 +560,24 @@ bool MDTriggerUnit::HasTriggered()
   }
 
   // If no triggers are defined then we have not vetoed but triggered 
-  if (m_Geometry->GetNTriggers() == 0) {
+  if (GetNTriggers() == 0) {
     mdebug<<"No triggers defined!"<<endl;
     return true;
   }
 
+  if (IsCompiled() == true) {
+    Decide();
+    // A non-vetoable trigger wins, then any veto, then any trigger
+    if (Any(m_NonVetoablyTriggered) == true) return true;
+    if (m_IgnoreVetoes == false && Any(m_Vetoed) == true) return false;
+    return Any(m_Triggered);
+  }
+
   // If we have a non-vetoable trigger, we have triggered
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<": Non-vetoably triggered? "<<(m_Geometry->GetTriggerAt(t)->HasNonVetoablyTriggered() == true ? "yes" : "no")<<endl;
-    if (m_Geometry->GetTriggerAt(t)->HasNonVetoablyTriggered() == true) {
-      mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" triggered!"<<endl;
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    mdebug<<GetTriggerAt(t)->GetName()<<": Non-vetoably triggered? "<<(GetTriggerAt(t)->HasNonVetoablyTriggered() == true ? "yes" : "no")<<endl;
+    if (GetTriggerAt(t)->HasNonVetoablyTriggered() == true) {
+      mdebug<<GetTriggerAt(t)->GetName()<<" triggered!"<<endl;
       return true;
     }
   }
@@ -293,20 +585,20 @@ bool MDTriggerUnit::HasTriggered()
   
   // If we have one veto then we have not triggered
   if (m_IgnoreVetoes == false) { // This should not be neceassary since the triggers handle it...
-    for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-      mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" vetoed? "<<(m_Geometry->GetTriggerAt(t)->HasVetoed() == true ? "yes" : "no")<<endl;
-      if (m_Geometry->GetTriggerAt(t)->HasVetoed() == true) {
-        mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" vetoed!"<<endl;
+    for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+      mdebug<<GetTriggerAt(t)->GetName()<<" vetoed? "<<(GetTriggerAt(t)->HasVetoed() == true ? "yes" : "no")<<endl;
+      if (GetTriggerAt(t)->HasVetoed() == true) {
+        mdebug<<GetTriggerAt(t)->GetName()<<" vetoed!"<<endl;
         return false;
       }
     }
   }
 
   // Check for real triggers:
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" triggered? "<<(m_Geometry->GetTriggerAt(t)->HasTriggered() == true ? "yes" : "no")<<endl;
-    if (m_Geometry->GetTriggerAt(t)->HasTriggered() == true) {
-      mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" triggered!"<<endl;
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    mdebug<<GetTriggerAt(t)->GetName()<<" triggered? "<<(GetTriggerAt(t)->HasTriggered() == true ? "yes" : "no")<<endl;
+    if (GetTriggerAt(t)->HasTriggered() == true) {
+      mdebug<<GetTriggerAt(t)->GetName()<<" triggered!"<<endl;
       return true;
     }
   }
@@ -333,23 +625,29 @@ bool MDTriggerUnit::HasVetoed()
   }
 
   // If no triggers are defined then we have not vetoed but triggered 
-  if (m_Geometry->GetNTriggers() == 0) {
+  if (GetNTriggers() == 0) {
     return false;
   }
+
+  if (IsCompiled() == true) {
+    Decide();
+    if (Any(m_NonVetoablyTriggered) == true) return false;
+    return Any(m_Vetoed);
+  }
   
   // If we have a non-vetoable trigger, we have not vetoed
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" non-vetoably triggered? "<<(m_Geometry->GetTriggerAt(t)->HasNonVetoablyTriggered() == true ? "yes" : "no")<<endl;
-    if (m_Geometry->GetTriggerAt(t)->HasNonVetoablyTriggered() == true) {
-      mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" no vetoed!"<<endl;
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    mdebug<<GetTriggerAt(t)->GetName()<<" non-vetoably triggered? "<<(GetTriggerAt(t)->HasNonVetoablyTriggered() == true ? "yes" : "no")<<endl;
+    if (GetTriggerAt(t)->HasNonVetoablyTriggered() == true) {
+      mdebug<<GetTriggerAt(t)->GetName()<<" no vetoed!"<<endl;
       return false;
     }
   }
   
   // If we have one veto then we have not triggered
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    if (m_Geometry->GetTriggerAt(t)->HasVetoed() == true) {
-      mdebug<<m_Geometry->GetTriggerAt(t)->GetName()<<" vetoed!"<<endl;
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->HasVetoed() == true) {
+      mdebug<<GetTriggerAt(t)->GetName()<<" vetoed!"<<endl;
       return true;
     }
   }
@@ -366,9 +664,19 @@ vector<MString> MDTriggerUnit::GetTriggerNameList()
 {
   vector<MString> List;
   
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    if (m_Geometry->GetTriggerAt(t)->HasTriggered() == true) {
-      List.push_back(m_Geometry->GetTriggerAt(t)->GetName());
+  if (IsCompiled() == true) {
+    Decide();
+    for (unsigned int t = 0; t < m_NCompiledTriggers; ++t) {
+      if ((m_Triggered[t/64] & (uint64_t(1) << (t%64))) != 0) {
+        List.push_back(GetTriggerAt(t)->GetName());
+      }
+    }
+    return List;
+  }
+  
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->HasTriggered() == true) {
+      List.push_back(GetTriggerAt(t)->GetName());
     }
   }
   
@@ -384,10 +692,20 @@ vector<MString> MDTriggerUnit::GetVetoNameList()
 {
   vector<MString> List;
   
+  if (IsCompiled() == true) {
+    Decide();
+    for (unsigned int t = 0; t < m_NCompiledTriggers; ++t) {
+      if ((m_Vetoed[t/64] & (uint64_t(1) << (t%64))) != 0) {
+        List.push_back(GetTriggerAt(t)->GetName());
+      }
+    }
+    return List;
+  }
+  
   // Check for vetoes:
-  for (unsigned int t = 0; t < m_Geometry->GetNTriggers(); ++t) {
-    if (m_Geometry->GetTriggerAt(t)->HasVetoed() == true) {
-      List.push_back(m_Geometry->GetTriggerAt(t)->GetName());
+  for (unsigned int t = 0; t < GetNTriggers(); ++t) {
+    if (GetTriggerAt(t)->HasVetoed() == true) {
+      List.push_back(GetTriggerAt(t)->GetName());
     }
   }
   
@@ -403,8 +721,8 @@ ostream& operator<<(ostream& os, const MDTriggerUnit& R)
   os<<"Trigger unit:"<<endl;
   
   // Check for vetoes:
-  for (unsigned int t = 0; t < R.m_Geometry->GetNTriggers(); ++t) {
-    os<<*(R.m_Geometry->GetTriggerAt(t));
+  for (unsigned int t = 0; t < R.GetNTriggers(); ++t) {
+    os<<*(R.GetTriggerAt(t));
   }
 
   return os;
@@ -2449,8 +2449,79 @@ double MDVolume::GetAbsorptionLengths(map<MDMaterial*, double>& Lengths,
     m_RotMatrix.Rotate(Stop);    // rotate
   }
 
+  double Length = GetPathLengthInShape(Start, Stop);
+
+  if (Length > 0) {
+    double LengthInDaughters = 0;
+    unsigned int i_max = m_Daughters.size();
+    for (unsigned int i = 0; i < i_max; i++) {
+      LengthInDaughters += m_Daughters[i]->GetAbsorptionLengths(Lengths, Start, Stop);
+    }
+
+    if (Length - LengthInDaughters > 0) {
+      Lengths[GetMaterial()] += (Length - LengthInDaughters);
+    } else {
+      CheckLengthInDaughters(Start, Stop, Length, LengthInDaughters);
+    }
+  }
+
+  return Length;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MDVolume::GetAbsorptionLengths(double* Lengths, const MVector& MotherStart, const MVector& MotherStop)
+{
+  // Identical to the version above, but the lengths are added to a flat array indexed by the 
+  // geometry index of the material, which avoids all map operations during the ray tracing
+
+  if (m_DoAbsorptions == false) {
+    return 0;
+  }
+
+  MVector Start = MotherStart - m_Position;
+  MVector Stop = MotherStop - m_Position;
+  if (m_IsRotated == true) {
+    m_RotMatrix.Rotate(Start);    // rotate
+    m_RotMatrix.Rotate(Stop);    // rotate
+  }
+
+  double Length = GetPathLengthInShape(Start, Stop);
+
+  if (Length > 0) {
+    double LengthInDaughters = 0;
+    unsigned int i_max = m_Daughters.size();
+    for (unsigned int i = 0; i < i_max; i++) {
+      LengthInDaughters += m_Daughters[i]->GetAbsorptionLengths(Lengths, Start, Stop);
+    }
+
+    if (Length - LengthInDaughters > 0) {
+      unsigned int Index = GetMaterial()->GetGeometryIndex();
+      if (Index != g_UnsignedIntNotDefined) {
+        Lengths[Index] += (Length - LengthInDaughters);
+      } else {
+        merr<<"Material "<<GetMaterial()->GetName()<<" of volume "<<m_Name<<" is not part of the geometry's material list - ignoring its path length"<<endl;
+      }
+    } else {
+      CheckLengthInDaughters(Start, Stop, Length, LengthInDaughters);
+    }
+  }
+
+  return Length;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MDVolume::GetPathLengthInShape(const MVector& Start, const MVector& Stop)
+{
+  // Return the length of the path from start to stop (in this volumes coordinate system)
+  // inside the shape of this volume, ignoring any daughters
+
   double Length = 0;
-  double LengthInDaughters = 0;
   const double Tolerance = 0.0000001;
 
 
@@ -2525,25 +2596,27 @@ double MDVolume::GetAbsorptionLengths(map<MDMaterial*, double>& Lengths,
     }
   }
 
-  if (Length > 0) {
-    unsigned int i_max = m_Daughters.size();
-    for (unsigned int i = 0; i < i_max; i++) {
-      LengthInDaughters += m_Daughters[i]->GetAbsorptionLengths(Lengths, Start, Stop);
-    }
+  return Length;
+}
 
-    if (Length - LengthInDaughters > 0) {
-      Lengths[GetMaterial()] += (Length - LengthInDaughters);
-    } else if (Length - LengthInDaughters < -Tolerance) {
-      // Use cout
-      cout<<"Warning: Negative length in volume: "<<m_Name<<": "<<Length - LengthInDaughters<<endl;
-      cout<<"         Start: "<<Start<<"   Stop: "<<Stop<<endl;
-      cout<<"         Total length in volume: "<<Length<<endl;
-      cout<<"         Total length in daughters: "<<LengthInDaughters<<endl;
-      cout<<"         --> It is extremely likely that you have overlaps in your geometry!"<<endl;
-    }
-  }
 
-  return Length;
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MDVolume::CheckLengthInDaughters(const MVector& Start, const MVector& Stop, double Length, double LengthInDaughters)
+{
+  // Warn if the daughters contain more path length than this volume, i.e. we have overlaps
+
+  const double Tolerance = 0.0000001;
+
+  if (Length - LengthInDaughters < -Tolerance) {
+    // Use cout
+    cout<<"Warning: Negative length in volume: "<<m_Name<<": "<<Length - LengthInDaughters<<endl;
+    cout<<"         Start: "<<Start<<"   Stop: "<<Stop<<endl;
+    cout<<"         Total length in volume: "<<Length<<endl;
+    cout<<"         Total length in daughters: "<<LengthInDaughters<<endl;
+    cout<<"         --> It is extremely likely that you have overlaps in your geometry!"<<endl;
+  }
 }
 
 
@@ -41,6 +41,7 @@ using namespace std;
 #include "MDShapeSubtraction.h"
 #include "MDShapeIntersection.h"
 #include "MDGuardRing.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -214,7 +215,7 @@ void MDVoxel3D::Noise(MVector& Pos, double& Energy, double& Time, MDVolume* Volu
   if (m_NoiseActive == false) return;
 
   // Test for failure:
-  if (gRandom->Rndm() < m_FailureRate) {
+  if (MDRandom::Get()->Rndm() < m_FailureRate) {
     Energy = 0;
     return;
   }
@@ -47,6 +47,7 @@ using namespace std;
 #include "MAssert.h"
 #include "MFile.h"
 #include "MStreams.h"
+#include "MDGeometry.h"
 #include "MDVolume.h"
 #include "MDCalorimeter.h"
 #include "MDStrip2D.h"
@@ -130,6 +131,8 @@ bool MInterfaceGeomega::ParseCommandLine(int argc, char** argv)
   Usage<<endl;
   Usage<<"         --create-cross-sections:"<<endl;
   Usage<<"             Create cross section files"<<endl;
+  Usage<<"         --no-geometry-cache:"<<endl;
+  Usage<<"             Do not read or write the cache of the preprocessed setup file"<<endl;
   Usage<<endl;
 
   // Store some options temporarily:
@@ -183,6 +186,9 @@ bool MInterfaceGeomega::ParseCommandLine(int argc, char** argv)
     } else if (Option == "--debug" || Option == "-d") {
       if (g_Verbosity < c_Warning) g_Verbosity = c_Warning;
       cout<<"Command-line parser: Use debug mode"<<endl;
+    } else if (Option == "--no-geometry-cache") {
+      MDGeometry::UseCache(false);
+      cout<<"Command-line parser: Do not use the geometry cache"<<endl;
     } else if (Option == "--configuration" || Option == "-c") {
       m_Data->Read(argv[++i]);
       cout<<"Command-line parser: Use configuration file "<<m_Data->GetSettingsFileName()<<endl;
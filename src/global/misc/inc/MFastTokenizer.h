@@ -0,0 +1,133 @@
+/*
+ * MFastTokenizer.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MFastTokenizer__
+#define __MFastTokenizer__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A tokenizer for the (hot) event parsing loops:
+//! In contrast to MTokenizer::AnalyzeFast it does not copy the tokens, but only stores views into the analyzed line,
+//! and converts them with std::from_chars, which neither allocates nor depends on the locale
+//! (floating point numbers fall back to strtod where the library does not provide from_chars for them).
+//! The line must therefore stay alive and unchanged as long as the tokens are accessed.
+//! The static Parse... functions read numbers directly from a character range for fixed-layout lines such as "CD" or "HTsim".
+class MFastTokenizer
+{
+  // public interface:
+ public:
+  //! Standard constructor - Separator is the separator between the tokens in addition to tabs
+  MFastTokenizer(const char Separator = ' ');
+  //! Default destuctor
+  virtual ~MFastTokenizer();
+
+  //! Set the separator between the tokens (default: space)
+  void SetSeparator(const char Separator) { m_Separator = Separator; }
+
+  //! Split the line into tokens - parsing stops at the end of the line, a new line, or a comment ("//" or "#")
+  bool Analyze(const char* Line, size_t Length);
+  //! Split the line into tokens
+  bool Analyze(const char* Line);
+  //! Split the line into tokens
+  bool Analyze(const MString& Line) { return Analyze(Line.Data(), Line.Length()); }
+
+  //! Return the number of tokens
+  unsigned int GetNTokens() const { return m_Tokens.size(); }
+  //! Return the token at position i - no range check
+  string_view GetTokenAt(const unsigned int i) const { return m_Tokens[i]; }
+  //! Check if the given token is at position i
+  bool IsTokenAt(const unsigned int i, const char* Token) const;
+  //! Return the token at position i as MString - this copies
+  MString GetTokenAtAsString(const unsigned int i) const;
+  //! Return the remaining line starting with token i (excluding comments)
+  string_view GetTokenAfter(const unsigned int i) const;
+
+  //! Return the token at position i as double - the return value is zero if it cannot be converted
+  double GetTokenAtAsDouble(const unsigned int i) const;
+  //! Return the token at position i as float - the return value is zero if it cannot be converted
+  float GetTokenAtAsFloat(const unsigned int i) const;
+  //! Return the token at position i as int - the return value is zero if it cannot be converted
+  int GetTokenAtAsInt(const unsigned int i) const;
+  //! Return the token at position i as unsigned int - the return value is zero if it cannot be converted
+  unsigned int GetTokenAtAsUnsignedInt(const unsigned int i) const;
+  //! Return the token at position i as long - the return value is zero if it cannot be converted
+  long GetTokenAtAsLong(const unsigned int i) const;
+  //! Return the token at position i as unsigned long - the return value is zero if it cannot be converted
+  unsigned long GetTokenAtAsUnsignedLong(const unsigned int i) const;
+  //! Return the token at position i as boolean, i.e. "true" or a non-zero number
+  bool GetTokenAtAsBoolean(const unsigned int i) const;
+
+  //! Parse a double at Position and move Position behind it
+  //! Leading blanks and tabs, and one separator (if it is not a blank) are skipped
+  static bool ParseDouble(const char*& Position, const char* End, double& Value, const char Separator = ' ');
+  //! Parse an int at Position and move Position behind it - see ParseDouble
+  static bool ParseInt(const char*& Position, const char* End, int& Value, const char Separator = ' ');
+  //! Parse a long at Position and move Position behind it - see ParseDouble
+  static bool ParseLong(const char*& Position, const char* End, long& Value, const char Separator = ' ');
+  //! Parse an unsigned long at Position and move Position behind it - see ParseDouble
+  static bool ParseUnsignedLong(const char*& Position, const char* End, unsigned long& Value, const char Separator = ' ');
+  //! Parse N doubles, return the number of successfully parsed values
+  static unsigned int ParseDoubles(const char*& Position, const char* End, double* Values, const unsigned int N, const char Separator = ' ');
+
+
+  // protected methods:
+ protected:
+  //! Skip the blanks and one separator in front of a number and handle a leading '+' which from_chars does not accept
+  static void SkipToNumber(const char*& Position, const char* End, const char Separator);
+
+
+  // private methods:
+ private:
+
+
+
+  // protected members:
+ protected:
+
+
+  // private members:
+ private:
+  //! The separator e.g. a space
+  char m_Separator;
+  //! The tokens - views into the analyzed line
+  vector<string_view> m_Tokens;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MFastTokenizer, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
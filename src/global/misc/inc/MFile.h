@@ -24,11 +24,21 @@
 // MEGAlib libs:
 #include "MGlobal.h"
 #include "MBinaryStore.h"
+#include "MFileBGZF.h"
+#include "MFileMapped.h"
 
 // Standard libs:
 #include <fstream>
 #include <sstream>
 #include <streambuf>
+#include <string>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 using namespace std;
 
 // Forward declarations:
@@ -73,6 +83,29 @@ class MFile
   
   //! Set the compression level
   virtual void SetCompressionLevel(unsigned int CompressionLevel = 6);
+  //! Write .gz files as blocked gzip (BGZF): still readable by gunzip, but decompressed in parallel and seekable
+  //! Reading always detects blocked gzip files automatically
+  void SetBlockedCompression(bool UseBlockedCompression = true) { m_UseBlockedCompression = UseBlockedCompression; }
+  //! Return true if .gz files are written as blocked gzip
+  bool UsesBlockedCompression() const { return m_UseBlockedCompression; }
+  //! Set the number of decompression threads for blocked gzip files (0: automatic)
+  void SetNumberOfCompressionThreads(unsigned int NThreads) { m_NCompressionThreads = NThreads; }
+  //! Return true if the open file is a blocked gzip file
+  bool IsBlockedCompressed() const { return m_BlockedZipFile != nullptr; }
+  //! Write (and compress) in a background thread: the written text is collected in large blocks,
+  //! which a dedicated thread writes into the file - the file content is identical
+  //! Must be set before the file is opened for writing. In this mode Flush() only hands over the data
+  //! when the current block is full -- everything is written at the latest when the file is closed
+  void SetBackgroundWriting(bool UseBackgroundWriting = true) { m_UseBackgroundWriting = UseBackgroundWriting; }
+  //! Return true if the file is written in a background thread
+  bool UsesBackgroundWriting() const { return m_UseBackgroundWriting; }
+  //! Read .gz files via their decompressed copy in the event cache (see MFileEventCache), if the cache is enabled
+  //! Must be set before the file is opened
+  void SetEventCache(bool UseEventCache = true) { m_UseEventCache = UseEventCache; }
+  //! Return true if .gz files are read via the event cache
+  bool UsesEventCache() const { return m_UseEventCache; }
+  //! Return true if the open file is read from its decompressed copy in the event cache
+  bool IsReadFromEventCache() const { return m_CachedFile != nullptr; }
   
   //! Return the file length on disk
   virtual streampos GetFileLength(bool Redetermine = false);
@@ -92,6 +125,25 @@ class MFile
   //! Seek the given position
   virtual void Seek(streamoff Offset, ios_base::seekdir Way);
 
+  //! Create a seek point while writing and return its uncompressed and compressed (on disk) offset
+  //! For gzip'ed files the current gzip member is finished and a new one is started,
+  //! thus a reader can start decompressing at the returned compressed offset
+  //! With background writer this waits until everything handed over has been written -- use RequestSeekPoint instead
+  virtual bool CreateSeekPoint(streampos& UncompressedOffset, streampos& CompressedOffset);
+  //! Request a seek point at the current end of the written data without waiting for the background writer:
+  //! The background writer creates it in order with the data, its offsets are returned by GetSeekPoints
+  virtual bool RequestSeekPoint();
+  //! Return the uncompressed and compressed offsets of the seek points requested since opening the file in request order
+  //! A seek point which could not be created is missing, with background writer all are available after Close()
+  vector<pair<streampos, streampos>> GetSeekPoints();
+  //! Jump to a seek point created by CreateSeekPoint while reading
+  virtual bool JumpToSeekPoint(streampos UncompressedOffset, streampos CompressedOffset);
+  //! Return the current position as virtual offset: For blocked gzip files this is
+  //! (start of the compressed block << 16) | position within the block, otherwise the uncompressed position
+  virtual uint64_t GetVirtualFilePosition();
+  //! Seek a virtual offset returned by GetVirtualFilePosition -- constant time for blocked gzip files
+  virtual bool SeekVirtualFilePosition(uint64_t VirtualOffset);
+
   //! Write a new line
   virtual void WriteLine();
   //! Write some text and clear the stream
@@ -209,6 +261,34 @@ class MFile
  private:
   //! Construct a randomized temporary path under the requested directory
   static MString MakeTemporaryPath(const MString& Name, unsigned int NumberOfRandomChars, const MString& Directory);
+  //! Reopen a gzip'ed file for reading starting at the given compressed offset, which must be the start of a gzip member -- no locking
+  bool ReopenZipFileNoLock(streampos UncompressedOffset, streampos CompressedOffset);
+
+  //! Compressed file access for either zlib streams, blocked gzip, or the decompressed copy in the event cache -- no locking
+  int ZipGetc() { return (m_BlockedZipFile != nullptr) ? m_BlockedZipFile->Getc() : (m_CachedFile != nullptr) ? m_CachedFile->Getc() : gzgetc(m_ZipFile); }
+  //! Compressed file access for either zlib streams, blocked gzip, or the decompressed copy in the event cache -- no locking
+  char* ZipGets(char* Buffer, int Length) { return (m_BlockedZipFile != nullptr) ? m_BlockedZipFile->Gets(Buffer, Length) : (m_CachedFile != nullptr) ? m_CachedFile->Gets(Buffer, Length) : gzgets(m_ZipFile, Buffer, Length); }
+  //! Compressed file access for either zlib streams, blocked gzip, or the decompressed copy in the event cache -- no locking
+  bool ZipEof() { return (m_BlockedZipFile != nullptr) ? m_BlockedZipFile->Eof() || m_BlockedZipFile->HasError() : (m_CachedFile != nullptr) ? m_CachedFile->Eof() : gzeof(m_ZipFile) != 0; }
+  //! Compressed file access for either zlib streams, blocked gzip, or the decompressed copy in the event cache -- no locking
+  MString ZipError();
+
+  //! Write the data into the file or the block of the background writer -- no locking
+  void WriteNoLock(const char* Data, size_t Length);
+  //! Write the data directly into the file -- no locking
+  void WriteDirectNoLock(const char* Data, size_t Length);
+  //! Write the end of a line -- without background writer, uncompressed files are flushed as with endl
+  void WriteEndOfLineNoLock();
+  //! Create a seek point in the file itself and return its offsets -- no locking
+  bool CreateSeekPointNoLock(streampos& UncompressedOffset, streampos& CompressedOffset);
+  //! Hand the current block over to the background writer -- no locking
+  void HandOverWriteBlockNoLock();
+  //! Wait until the background writer has written everything handed over to it -- no locking
+  void WaitForBackgroundWriterNoLock();
+  //! Write everything and stop the background writer -- no locking
+  void StopBackgroundWriterNoLock();
+  //! Main loop of the background writer thread
+  void BackgroundWriterLoop();
 
   //public members
  public:
@@ -261,6 +341,43 @@ class MFile
   fstream m_File;
   //! The basic file stream for zlib
   gzFile m_ZipFile;
+  //! The blocked gzip file -- used instead of m_ZipFile if not nullptr
+  MFileBGZF* m_BlockedZipFile;
+  //! The decompressed copy in the event cache -- used instead of m_ZipFile and m_BlockedZipFile if not nullptr
+  MFileMapped* m_CachedFile;
+  //! True if .gz files are read via the event cache
+  bool m_UseEventCache;
+  //! True if .gz files are written as blocked gzip
+  bool m_UseBlockedCompression;
+  //! The number of decompression threads for blocked gzip (0: automatic)
+  unsigned int m_NCompressionThreads;
+
+  //! True if the file is written in a background thread
+  bool m_UseBackgroundWriting;
+  //! The background writer thread -- only running while a file is open for writing
+  thread m_BackgroundWriter;
+  //! The block which is currently filled
+  string m_WriteBlock;
+  //! The blocks waiting to be written by the background writer -- an empty block requests a seek point
+  deque<string> m_WriteQueue;
+  //! The seek points created via RequestSeekPoint (uncompressed and compressed offsets) -- guarded by the write queue mutex
+  vector<pair<streampos, streampos>> m_SeekPoints;
+  //! The mutex guarding the write queue
+  mutex m_WriteQueueMutex;
+  //! Signals new blocks or the stop request to the background writer
+  condition_variable m_WriteQueueFilled;
+  //! Signals to the writing threads that a block has been written
+  condition_variable m_WriteQueueDrained;
+  //! True while the background writer writes a block
+  bool m_BackgroundWriterBusy;
+  //! Flag to stop the background writer
+  bool m_StopBackgroundWriter;
+  //! True if the background writer was unable to write
+  atomic<bool> m_BackgroundWriterFailed;
+  //! The size of a block handed over to the background writer
+  static const size_t c_WriteBlockSize = 1 << 20;
+  //! The maximum number of blocks waiting for the background writer, before the writing threads have to wait
+  static const unsigned int c_MaximumWriteQueueLength = 8;
 
   //! The file mutex
   TMutex m_FileMutex;
@@ -285,6 +402,8 @@ class MFile
 
   //! Compression level (gzip: 1..9)
   unsigned int m_CompressionLevel;
+  //! The uncompressed offset at which the current gzip reading stream started (non-zero after a jump to a seek point)
+  streampos m_UncompressedOffsetBase;
   
   
 #ifdef ___CLING___
@@ -0,0 +1,237 @@
+/*
+ * MFileBGZF.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MFileBGZF__
+#define __MFileBGZF__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Blocked gzip (BGZF) file access:
+//! The file is a series of independent gzip members of at most 64 kB, each with the "BC" extra field storing
+//! its compressed size. Thus it is still a valid gzip file (gunzip, zcat), but the blocks can be decompressed
+//! in parallel and every position can be reached without decompressing everything before it.
+//! The block index is written as htslib-compatible ".gzi" file, and rebuilt from the block headers if it is missing.
+//! Positions can also be given as virtual offsets: (compressed block start << 16) | offset within the block
+class MFileBGZF
+{
+  // public interface:
+ public:
+  //! Default constructor
+  MFileBGZF();
+  //! Default destuctor
+  virtual ~MFileBGZF();
+
+  //! Return true if the file starts with a BGZF block header
+  static bool IsBGZF(const MString& FileName);
+  //! Return the name of the block index file
+  static MString GetIndexFileName(const MString& FileName) { return FileName + ".gzi"; }
+
+  //! Open the file for reading with the given number of decompression threads (0: automatic)
+  bool OpenForReading(const MString& FileName, unsigned int NThreads = 0);
+  //! Open the file for writing with the given compression level (1..9)
+  bool OpenForWriting(const MString& FileName, unsigned int CompressionLevel = 6);
+  //! Close the file -- in write mode this writes the last block, the end-of-file marker and the block index
+  bool Close();
+  //! Return true if the file is open
+  bool IsOpen() const { return m_IsOpen; }
+
+  //! Write data
+  bool Write(const char* Data, size_t Length);
+  //! Write a zero-terminated string
+  bool Puts(const char* String);
+  //! Write a character
+  bool Putc(char c);
+  //! Complete the current block -- the next data starts a new block
+  bool FlushBlock();
+
+  //! Read one character, -1 at the end of the file
+  int Getc();
+  //! Read up to Length-1 characters until and including a new line, like gzgets - returns nullptr at the end of the file
+  char* Gets(char* Buffer, int Length);
+  //! Read up to Length characters, return the number of characters read
+  size_t Read(char* Buffer, size_t Length);
+  //! Return true if we tried to read beyond the end of the file
+  bool Eof() const { return m_EOF; }
+  //! Return true if an error occured (corrupt block, I/O error)
+  bool HasError() const { return m_HasError; }
+
+  //! Return the current position as if the file were uncompressed
+  uint64_t Tell() const;
+  //! Return the current position on disk, i.e. the start of the current block
+  uint64_t GetCompressedPosition() const;
+  //! Return the current position as virtual offset
+  uint64_t GetVirtualOffset() const;
+  //! Seek to a position as if the file were uncompressed
+  bool Seek(uint64_t UncompressedPosition);
+  //! Seek to a virtual offset
+  bool SeekVirtualOffset(uint64_t VirtualOffset);
+  //! Go back to the start of the file
+  bool Rewind() { return Seek(0); }
+
+  //! Return the uncompressed length of the file
+  uint64_t GetUncompressedLength() const;
+  //! Return the length of the file on disk
+  uint64_t GetCompressedLength() const;
+
+  //! The maximum size of one compressed block
+  static const unsigned int c_MaximumBlockSize;
+  //! The maximum uncompressed data in one block, such that the compressed block always fits
+  static const unsigned int c_MaximumUncompressedBlockSize;
+
+  // protected methods:
+ protected:
+  //! One block of the file
+  struct MBlock {
+    //! The start of the block on disk
+    uint64_t m_CompressedOffset;
+    //! The size of the block on disk
+    uint32_t m_CompressedSize;
+    //! The start of the block as if the file were uncompressed
+    uint64_t m_UncompressedOffset;
+    //! The uncompressed size of the block
+    uint32_t m_UncompressedSize;
+  };
+
+  //! The decompressed data of one block
+  struct MDecompressedBlock {
+    //! The block ID
+    uint64_t m_Block;
+    //! The decompressed data
+    vector<char> m_Data;
+    //! True if the decompression has finished
+    bool m_Done;
+    //! True if the decompression failed
+    bool m_Failed;
+  };
+
+  //! Build the block index from the index file, or if that fails from the block headers
+  bool BuildBlockIndex();
+  //! Read the block index file
+  bool ReadIndexFile();
+  //! Write the block index file
+  bool WriteIndexFile();
+  //! Read and check a block header at the given offset, return the block size and its uncompressed size
+  bool ReadBlockHeader(uint64_t Offset, uint32_t& CompressedSize, uint32_t& UncompressedSize);
+  //! Decompress one block -- thread safe
+  bool Decompress(uint64_t Block, vector<char>& Data) const;
+  //! Compress the buffered data into one block and write it
+  bool CompressAndWriteBlock();
+
+  //! Make sure we have data available at the current position - returns false at the end of the file
+  bool EnsureData();
+  //! Load the decompressed data of the current block - either directly or from the read-ahead queue
+  bool LoadCurrentBlock();
+  //! Start and stop the decompression threads
+  void StartWorkers();
+  void StopWorkers();
+  //! Main loop of a decompression thread
+  void WorkerLoop();
+
+  // private methods:
+ private:
+
+
+
+  // protected members:
+ protected:
+
+
+  // private members:
+ private:
+  //! The file name
+  MString m_FileName;
+  //! True if the file is open
+  bool m_IsOpen;
+  //! True if we are writing
+  bool m_IsWriting;
+  //! True if we tried to read beyond the end of the file
+  bool m_EOF;
+  //! True if an error occured
+  bool m_HasError;
+
+  //! Write mode: The file
+  FILE* m_WriteFile;
+  //! Write mode: The compression level
+  int m_CompressionLevel;
+  //! Write mode: The not yet compressed data
+  vector<char> m_WriteBuffer;
+  //! Write mode: The compressed output buffer
+  vector<unsigned char> m_CompressedBuffer;
+
+  //! Read mode: The file descriptor -- we use pread which is safe for concurrent access
+  int m_FileDescriptor;
+  //! The length of the file on disk
+  uint64_t m_CompressedLength;
+  //! The blocks -- in write mode the already written blocks
+  vector<MBlock> m_Blocks;
+  //! The current block ID
+  uint64_t m_CurrentBlock;
+  //! The decompressed data of the current block, or nullptr if not yet loaded
+  shared_ptr<MDecompressedBlock> m_Current;
+  //! The position within the current block
+  uint32_t m_CurrentPosition;
+
+  //! The number of decompression threads
+  unsigned int m_NThreads;
+  //! The decompression threads
+  vector<thread> m_Workers;
+  //! The blocks being decompressed, in file order
+  deque<shared_ptr<MDecompressedBlock>> m_ReadAhead;
+  //! The next block to hand to the decompression threads
+  uint64_t m_NextReadAheadBlock;
+  //! The blocks not yet picked up by a decompression thread
+  deque<shared_ptr<MDecompressedBlock>> m_Jobs;
+  //! Guards the read-ahead and job queues
+  mutex m_JobMutex;
+  //! Signals a new job to the decompression threads
+  condition_variable m_JobAvailable;
+  //! Signals a finished block to the reader
+  condition_variable m_JobDone;
+  //! Flag to stop the decompression threads
+  bool m_StopWorkers;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MFileBGZF, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
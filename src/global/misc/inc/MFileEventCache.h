@@ -0,0 +1,130 @@
+/*
+ * MFileEventCache.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MFileEventCache__
+#define __MFileEventCache__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstdint>
+#include <mutex>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A cache of decompressed event files (tra, sim) shared between all programs of a user:
+//! When a compressed event file is read, its decompressed content is stored in the cache directory
+//! (by default in shared memory, /dev/shm), and later runs on the same file read this copy instead of decompressing again.
+//! An entry is only used if size, modification time, and a hash of the beginning and the end of the original file match.
+//! The cache has a maximum size, the least recently used entries are removed first.
+//! Files which do not fit into the cache are recognized before decompressing them where possible (block index of blocked gzip
+//! files, size field of gzip files), otherwise this is recorded in their entry, thus they are decompressed at most once.
+class MFileEventCache
+{
+  // public interface:
+ public:
+  //! Enable the cache in the given directory (empty: default directory) with the given maximum size in bytes
+  static bool Enable(const MString& Directory = "", uint64_t MaximumSize = c_DefaultMaximumSize);
+  //! Disable the cache -- existing entries are kept
+  static void Disable();
+  //! Return true if the cache is enabled
+  static bool IsEnabled();
+  //! Enable the cache if the environment variable MEGALIB_EVENTCACHE is set (to a directory or "default"),
+  //! MEGALIB_EVENTCACHE_SIZE can give the maximum size in MB
+  static void EnableFromEnvironment();
+
+  //! Return the cache directory
+  static MString GetDirectory();
+  //! Return the maximum size of the cache in bytes
+  static uint64_t GetMaximumSize();
+  //! Return the total size of all cached files in bytes
+  static uint64_t GetSize();
+  //! Return the number of cached files
+  static unsigned int GetNEntries();
+
+  //! Return the name of the decompressed copy of the compressed file, and create it if it does not exist yet
+  //! Returns an empty string if the cache is disabled or the file cannot be cached
+  static MString Attach(const MString& FileName);
+  //! Remove all entries from the cache
+  static void Clear();
+
+  //! The default directory: a user specific directory in /dev/shm, or if that does not exist in the temporary directory
+  static MString GetDefaultDirectory();
+  //! The default maximum size
+  static const uint64_t c_DefaultMaximumSize;
+
+  // protected methods:
+ protected:
+  //! Determine size, modification time and a hash of the first and last part of the file
+  static bool GetFingerprint(const MString& FileName, uint64_t& Size, int64_t& ModificationTime, uint64_t& Hash);
+  //! Return the base name of the entry belonging to a file (without directory and extension)
+  static MString GetEntryName(const MString& FileName);
+  //! Check if the entry is valid for the file with the given fingerprint
+  //! If the entry records that the file is too large for the cache, TooLargeSize is its (minimum) uncompressed size, otherwise zero
+  static bool IsValid(const MString& DescriptionFileName, const MString& DataFileName, const MString& FileName, uint64_t Size, int64_t ModificationTime, uint64_t Hash, uint64_t& TooLargeSize);
+  //! Write the description of an entry -- if TooLarge is true, the entry only records that the file does not fit into the cache
+  static bool WriteDescription(const MString& DescriptionFileName, const MString& EntryName, const MString& FileName, uint64_t Size, int64_t ModificationTime, uint64_t Hash, uint64_t UncompressedSize, bool TooLarge);
+  //! Determine the uncompressed size without decompressing: exact for blocked gzip files (block index),
+  //! a lower limit for gzip files (size field modulo 4 GB of the last member)
+  static bool GetUncompressedSize(const MString& FileName, uint64_t& UncompressedSize);
+  //! Decompress the file into DataFileName, fails if more than MaximumSize bytes would be written
+  static bool Decompress(const MString& FileName, const MString& DataFileName, uint64_t MaximumSize, uint64_t& UncompressedSize);
+  //! Remove least recently used entries until Required additional bytes fit into the cache -- Keep is never removed
+  //! Files which are currently decompressed into the cache count against its maximum size
+  static bool MakeRoom(uint64_t Required, const MString& Keep);
+
+  // private members:
+ private:
+  //! The mutex guarding the configuration and all changes of the cache in this process
+  static mutex s_Mutex;
+  //! True if the cache is enabled
+  static bool s_Enabled;
+  //! The cache directory
+  static MString s_Directory;
+  //! The maximum size of the cache in bytes
+  static uint64_t s_MaximumSize;
+
+  //! The number of bytes at the beginning and the end of the file which enter the hash
+  static const uint64_t c_HashedBytes = 1 << 16;
+  //! The extension of the decompressed files
+  static const MString c_DataExtension;
+  //! The extension of the description files
+  static const MString c_DescriptionExtension;
+  //! The extension of files which are being written
+  static const MString c_TemporaryExtension;
+  //! Temporary files older than this (in seconds) are left over from crashed processes and are removed
+  static const int c_StaleTemporaryAge = 3600;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MFileEventCache, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
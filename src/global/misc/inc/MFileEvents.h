@@ -22,6 +22,8 @@
 #include "MGlobal.h"
 #include "MFile.h"
 #include "MTime.h"
+#include "MGTI.h"
+#include "MFileTimeIndex.h"
 
 // Forward declarations:
 
@@ -47,6 +49,9 @@ class MFileEvents : public MFile
   //! The Open method has to be derived to initialize the include file:
   virtual bool Open(MString FileName) { return Open(FileName, MFile::c_Read, false); }
 
+  //! Close the file -- in write mode this also saves the time index
+  virtual bool Close();
+
   //! Update the progress dialog GUI -- allow to skip a certain amount of updates
   virtual bool UpdateProgress(unsigned int UpdatesToSkip = 0);
 
@@ -84,6 +89,16 @@ class MFileEvents : public MFile
   //! Set the observation time 
   void SetObservationTime(MTime ObservationTime) { m_ObservationTime = ObservationTime; m_HasObservationTime = true; }
 
+  //! Set if a time index (<file name>.tidx) is written alongside the event file (default: true)
+  void SetWriteTimeIndex(bool WriteTimeIndex) { m_WriteTimeIndex = WriteTimeIndex; }
+  //! Set the number of events per time index block
+  void SetTimeIndexEventsPerBlock(unsigned long EventsPerBlock) { m_TimeIndex.SetEventsPerBlock(EventsPerBlock); }
+  //! Set a time selection: If a time index exists, the readers jump directly to the blocks containing
+  //! events which might be within the good time intervals -- the events still have to be checked individually
+  void SetTimeSelection(const MGTI& TimeSelection);
+  //! Remove the time selection
+  void ClearTimeSelection();
+
   // protected methods:
  protected:
   //! Open a file given by the "NF" keyword
@@ -106,6 +121,16 @@ class MFileEvents : public MFile
   bool ReadFooter(bool Continue = false);
   //! Parse the special information at the end of file -- add your special parsing in there
   virtual bool ParseFooter(const MString& Line);
+
+  //! Load the time index of the current file in read mode and determine the selected blocks
+  bool LoadTimeIndex();
+  //! Add an event time to the time index in write mode -- call before the event is written
+  void AddToTimeIndex(const MTime& Time);
+  //! Add a final seek point without events (the footer) to the time index -- call before "EN" is written
+  void CloseTimeIndex();
+  //! In read mode, jump to the next selected time index block if the current one is not selected
+  //! Returns true if a jump happened; NoMoreBlocks is set if there are no more selected blocks
+  bool SkipUnselectedTimeBlocks(bool& NoMoreBlocks);
   
   //! ID indicating there is no ID
   static const int c_NoId;
@@ -157,6 +182,23 @@ class MFileEvents : public MFile
   bool m_HasObservationTime;
   //! The total observation time
   MTime m_ObservationTime;
+
+  //! True if a time index is written in write mode
+  bool m_WriteTimeIndex;
+  //! The time index (written or loaded)
+  MFileTimeIndex m_TimeIndex;
+  //! In write mode, the time index blocks in the order of their requested seek points -- the offsets are filled in at closing
+  vector<unsigned int> m_TimeIndexSeekPointBlocks;
+  //! True if a time selection is set
+  bool m_HasTimeSelection;
+  //! The time selection
+  MGTI m_TimeSelection;
+  //! True if the time index of the current file is used for reading
+  bool m_UseTimeIndex;
+  //! Flag for each time index block whether it overlaps with the time selection
+  vector<bool> m_TimeIndexSelected;
+  //! The time index block we are currently reading, or -1 if we are still in the header
+  int m_TimeIndexBlock;
   
   // private members:
  private:
@@ -0,0 +1,112 @@
+/*
+ * MFileMapped.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MFileMapped__
+#define __MFileMapped__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstdint>
+#include <string>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read-only access to a memory mapped file with the same character interface as MFileBGZF:
+//! Used for the decompressed copies in the event cache, which reside in shared memory and thus
+//! are read without any copy into a file buffer
+class MFileMapped
+{
+  // public interface:
+ public:
+  //! Default constructor
+  MFileMapped();
+  //! Default destructor
+  virtual ~MFileMapped();
+
+  //! Map the file
+  bool Open(const MString& FileName);
+  //! Unmap the file
+  bool Close();
+  //! Return true if the file is open
+  bool IsOpen() const { return m_IsOpen; }
+
+  //! Return the next character or -1 at the end of the file
+  int Getc();
+  //! Read up to Length-1 characters until and including the next new line, as gzgets
+  char* Gets(char* Buffer, int Length);
+  //! Read up to Length bytes and return how many have been read
+  uint64_t Read(char* Buffer, uint64_t Length);
+  //! Read the next line without the new line character, return false at the end of the file
+  bool ReadLine(string& Line);
+
+  //! Return true if we tried to read beyond the end of the file
+  bool Eof() const { return m_EOF; }
+
+  //! Return the current position
+  uint64_t Tell() const { return m_Position; }
+  //! Go to the given position, return false if it is beyond the end of the file
+  bool Seek(uint64_t Position);
+  //! Go to the beginning of the file
+  bool Rewind() { return Seek(0); }
+  //! Return the length of the file
+  uint64_t GetLength() const { return m_Length; }
+
+  // protected methods:
+ protected:
+
+  // private methods:
+ private:
+
+
+
+  // protected members:
+ protected:
+
+
+  // private members:
+ private:
+  //! True if the file is open
+  bool m_IsOpen;
+  //! The mapped data -- nullptr for an empty file
+  const char* m_Data;
+  //! The length of the file
+  uint64_t m_Length;
+  //! The current position
+  uint64_t m_Position;
+  //! True if we tried to read beyond the end of the file
+  bool m_EOF;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MFileMapped, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,135 @@
+/*
+ * MFileTimeIndex.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MFileTimeIndex__
+#define __MFileTimeIndex__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <vector>
+#include <fstream>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+#include "MTime.h"
+#include "MGTI.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! One block of events in an event file: its time range and where it starts
+struct MFileTimeIndexBlock
+{
+  //! The smallest event time in this block
+  MTime m_MinimumTime;
+  //! The largest event time in this block
+  MTime m_MaximumTime;
+  //! The start of the block as if the file were uncompressed
+  streampos m_UncompressedOffset;
+  //! The start of the block on disk - for gzip'ed files this is the start of a gzip member
+  streampos m_CompressedOffset;
+  //! The number of events in this block
+  unsigned long m_NEvents;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A sidecar time index of an event file (tra, sim):
+//! The events are grouped into blocks, for each block we store its time range and its seek point,
+//! which allows the readers to jump directly to the blocks overlapping a time selection
+class MFileTimeIndex
+{
+  // public interface:
+ public:
+  //! Default constructor
+  MFileTimeIndex();
+  //! Default destuctor 
+  virtual ~MFileTimeIndex();
+
+  //! Reset to an empty index
+  void Reset();
+
+  //! Set the number of events per block
+  void SetEventsPerBlock(unsigned long EventsPerBlock) { m_EventsPerBlock = (EventsPerBlock > 0) ? EventsPerBlock : 1; }
+  //! Get the number of events per block
+  unsigned long GetEventsPerBlock() const { return m_EventsPerBlock; }
+
+  //! Start a new block at the given seek point
+  void StartBlock(streampos UncompressedOffset, streampos CompressedOffset);
+  //! Set the seek point of a block, if it was not yet known when the block was started
+  void SetSeekPoint(unsigned int Block, streampos UncompressedOffset, streampos CompressedOffset);
+  //! Add an event time to the current block
+  void AddEvent(const MTime& Time);
+  //! Return true if the current block has reached the number of events per block (or there is none)
+  bool IsBlockFull() const { return m_Blocks.size() == 0 || m_Blocks.back().m_NEvents >= m_EventsPerBlock; }
+
+  //! Return the number of blocks
+  unsigned int GetNBlocks() const { return m_Blocks.size(); }
+  //! Return a block
+  const MFileTimeIndexBlock& GetBlock(unsigned int i) const { return m_Blocks[i]; }
+
+  //! Return for each block true if any part of its time range overlaps with the GTI
+  vector<bool> SelectBlocks(const MGTI& GTI) const;
+
+  //! Save the index for the given event file
+  bool Save(const MString& IndexFileName, const MString& EventFileName) const;
+  //! Load the index for the given event file -- fails if the event file has changed since the index was written
+  bool Load(const MString& IndexFileName, const MString& EventFileName);
+
+  //! Return the name of the index file belonging to an event file
+  static MString GetIndexFileName(const MString& EventFileName) { return EventFileName + ".tidx"; }
+
+  //! The default number of events per block
+  static const unsigned long c_DefaultEventsPerBlock;
+
+  // protected methods:
+ protected:
+
+  // private methods:
+ private:
+
+
+
+  // protected members:
+ protected:
+
+
+  // private members:
+ private:
+  //! The number of events per block
+  unsigned long m_EventsPerBlock;
+  //! The blocks
+  vector<MFileTimeIndexBlock> m_Blocks;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MFileTimeIndex, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
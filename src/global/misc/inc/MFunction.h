@@ -27,6 +27,8 @@
 
 // Standard libs:
 #include <vector>
+#include <atomic>
+#include <mutex>
 using namespace std;
 
 // Forward declarations:
@@ -72,6 +74,8 @@ class MFunction
   void ScaleY(long double Scaler);
 
   //! Evaluate the data for a specific x value
+  //! The interval is found via binary search (or directly for uniform and log-uniform grids),
+  //! and the interpolation coefficients per interval are cached at the first call
   long double Evaluate(long double x) const;
 
   //! Deprectad - Evaluate the data for a specific x value
@@ -84,6 +88,7 @@ class MFunction
   long double Integrate(long double XMin, long double XMax) const;
 
   //! Return a random number distributed as the underlying function
+  //! The interval is drawn in constant time from an alias table, the position within via inverting its integral
   long double GetRandom();
 
   //! Return a random number distributed as the underlying function times the x-value
@@ -145,6 +150,17 @@ class MFunction
  protected:
   //! The interpolation stage of the GetRandom() function
   long double GetRandomInterpolate(long double Itot);
+  //! The interpolation stage of the GetRandom() function when the bin (upper data point) is already known
+  long double GetRandomInterpolate(long double Itot, int Bin);
+
+  //! Clear all data derived from the data points (cumulative function, alias table, interpolation coefficients)
+  void ClearCache();
+  //! Determine the grid type and the interpolation coefficients of all intervals, if not yet done
+  void PrepareEvaluation() const;
+  //! Return the index of the last data point with an x-value smaller or equal x, or -1 if there is none
+  int FindPosition(long double x) const;
+  //! Determine the cumulative function and the alias table for GetRandom(), if not yet done
+  void PrepareRandom();
 
   //! Implementation of Lambert's W function branches 0 and -1
   long double LambertW(long double x, int Branch);
@@ -174,7 +190,34 @@ class MFunction
   // For random number generation:
   //! The function as cumulative distribution:
   vector<long double> m_Cumulative;
-  
+  //! The alias table: the probability to keep the drawn interval
+  vector<double> m_AliasProbability;
+  //! The alias table: the interval to take instead
+  vector<unsigned int> m_AliasIndex;
+
+  // For the evaluation:
+  //! True if the grid type and the interpolation coefficients have been determined
+  mutable atomic<bool> m_EvaluationPrepared;
+  //! Protects the preparation, since Evaluate can be called from several threads
+  mutable mutex m_EvaluationMutex;
+  //! The grid type: irregular, uniform, or uniform in log(x)
+  mutable unsigned int m_GridType;
+  //! The first grid point (or its log) for uniform grids
+  mutable long double m_GridStart;
+  //! The inverse step size (in x or log(x)) for uniform grids
+  mutable long double m_GridInverseStep;
+  //! The slopes of the interpolation lines of all intervals (in the respective lin/log space)
+  mutable vector<long double> m_Slopes;
+  //! The offsets of the interpolation lines of all intervals (in the respective lin/log space)
+  mutable vector<long double> m_Offsets;
+
+  //! ID representing an irregular grid
+  static const unsigned int c_GridIrregular = 0;
+  //! ID representing a grid with equidistant x-values
+  static const unsigned int c_GridUniform = 1;
+  //! ID representing a grid with equidistant log(x)-values
+  static const unsigned int c_GridLogUniform = 2;
+
 
 #ifdef ___CLING___
  public:
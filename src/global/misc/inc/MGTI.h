@@ -47,16 +47,39 @@ class MGTI
 
   //! Add this GTI file's intervals
   void Add(const MGTI& GTI);
-  
+  //! Add a good time interval
+  void AddGoodTimeInterval(const MTime& Start, const MTime& Stop);
+  //! Add a bad time interval
+  void AddBadTimeInterval(const MTime& Start, const MTime& Stop);
+
   //! Check if the time is withing a good interval 
   //! In case of failure, we create a single time interval from 0 to 2,000,000,000
+  //! This is a binary search in the merged intervals
   bool IsGood(const MTime& Time) const;
+  //! Check if the time is within a good interval for a time-ordered stream:
+  //! The search starts at the interval given by the cursor, which is updated and owned by the caller
+  //! Start with a cursor of 0 -- if the time jumps backwards we fall back to a binary search
+  bool IsGood(const MTime& Time, unsigned int& Cursor) const;
+  //! Check if any part of the time range [Start, Stop] is within a good interval
+  //! The cursor is used as above for time-ordered ranges
+  bool Overlaps(const MTime& Start, const MTime& Stop, unsigned int& Cursor) const;
+
+  //! Return the number of merged good intervals, i.e. the good intervals without the bad intervals
+  unsigned int GetNMergedIntervals() const { return m_MergedStart.size(); }
+  //! Return the start of a merged good interval
+  MTime GetMergedIntervalStart(unsigned int i) const { return m_MergedStart[i]; }
+  //! Return the stop of a merged good interval
+  MTime GetMergedIntervalStop(unsigned int i) const { return m_MergedStop[i]; }
 
   //! Load the good time interval data
   bool Load(const MString& FileName);
   
   // protected methods:
  protected:
+  //! Build the sorted and merged good intervals from the good and bad time intervals
+  void Merge();
+  //! Return the index of the last merged interval starting at or before Time, or -1 if there is none
+  int FindMergedInterval(const MTime& Time) const;
 
   // private methods:
  private:
@@ -79,6 +102,11 @@ class MGTI
   //! Start of a bad time interval
   vector<MTime> m_BadStop;
 
+  //! Start of the sorted, disjoint good intervals with the bad intervals already removed
+  vector<MTime> m_MergedStart;
+  //! Stop of the sorted, disjoint good intervals with the bad intervals already removed
+  vector<MTime> m_MergedStop;
+
 
 #ifdef ___CLING___
  public:
@@ -21,6 +21,7 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <utility>
 using namespace std;
 
 // MEGAlib libs:
@@ -103,7 +104,7 @@ class MResponseMatrixON : public MResponseMatrix
   virtual unsigned long GetNBins() const { return m_NumberOfBins; }
   
   //! Return the number of sparse bins
-  virtual unsigned long GetNumberOfSparseBins() const { return m_BinsSparse.size(); }
+  virtual unsigned long GetNumberOfSparseBins() const { MergePendingSparse(); return m_BinsSparse.size(); }
   
   //! Return the number of axes
   unsigned int GetNumberOfAxes() { return m_Axes.size(); }
@@ -186,6 +187,10 @@ class MResponseMatrixON : public MResponseMatrix
   
   // Miscellaneous
   
+  //! Merge the buffered sparse additions into the sorted sparse arrays
+  //! This is done automatically before any access, but call it before reading the matrix from several threads
+  void MergePendingSparse() const;
+  
   //! Find the maximum value 
   virtual float GetMaximum() const;
   //! Find the minimum value
@@ -248,9 +253,14 @@ class MResponseMatrixON : public MResponseMatrix
   vector<float> m_Values;
   
   //! The data in sparse mode
-  vector<float> m_ValuesSparse;
+  mutable vector<float> m_ValuesSparse;
   //! Axis values in sparse mode
-  vector<unsigned long> m_BinsSparse;
+  mutable vector<unsigned long> m_BinsSparse;
+  //! Sparse mode: the additions (bin, value) in the order they were made, which are not yet merged into the sorted arrays
+  mutable vector<pair<unsigned long, float>> m_PendingSparse;
+  
+  //! The minimum number of buffered sparse additions before they are merged
+  static const unsigned long c_MinimumPendingSparse = 1UL << 22;
 
   //! Indicator if the threads are running
   vector<bool> m_ThreadRunning;
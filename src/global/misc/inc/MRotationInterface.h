@@ -60,6 +60,8 @@ class MRotationInterface
   //! Stream to a file
   //! Reading has to be done in the derived class
   void Stream(ostringstream& S) const;
+  //! Append the same text as Stream(ostringstream&) to the string -- much faster
+  void Stream(MString& S) const;
 
   //! Retrieve the *key* content from binary
   bool ParseBinary(MBinaryStore& Out, const bool HasGalacticPointing, const bool HasDetectorRotation, const bool HasHorizonPointing, const int BinaryPrecision = 32, const int Version = 25);
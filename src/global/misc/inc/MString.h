@@ -180,16 +180,39 @@ class MString
   MString& operator+=(const char* S) { m_String += S; return *this; }
   MString& operator+=(const MString& S) { m_String += S.m_String; return *this; }
   MString& operator+=(const string& S) { m_String += S; return *this; }
-  MString& operator+=(short N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
-  MString& operator+=(unsigned short N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
-  MString& operator+=(int N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
-  MString& operator+=(unsigned int N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
-  MString& operator+=(long N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
-  MString& operator+=(unsigned long N) { ostringstream out; out<<N; m_String += out.str(); return *this; }
+  MString& operator+=(short N) { return AppendInteger(N); }
+  MString& operator+=(unsigned short N) { return AppendInteger(N); }
+  MString& operator+=(int N) { return AppendInteger(N); }
+  MString& operator+=(unsigned int N) { return AppendInteger(N); }
+  MString& operator+=(long N) { return AppendInteger(N); }
+  MString& operator+=(unsigned long N) { return AppendInteger(N); }
   MString& operator+=(float N) { ostringstream out; out.precision(8); out<<N; m_String += out.str(); return *this; }
   MString& operator+=(double N) { ostringstream out; out.precision(15); out<<N; m_String += out.str(); return *this; }
   MString& operator+=(long double N) { ostringstream out; (sizeof(long double) == 128) ? out.precision(31) : out.precision(15); out<<N; m_String += out.str(); return *this; }
 
+  //! Reserve memory for the given number of characters
+  void Reserve(size_t Size) { m_String.reserve(Size); }
+
+  //! Fast number formatting without streams - the output is identical to an ostream in the default locale
+  //! Append an integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(long long Value, int Width = 0);
+  //! Append an unsigned integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(unsigned long long Value, int Width = 0);
+  //! Append an integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(int Value, int Width = 0) { return AppendInteger((long long) Value, Width); }
+  //! Append an unsigned integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(unsigned int Value, int Width = 0) { return AppendInteger((unsigned long long) Value, Width); }
+  //! Append an integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(long Value, int Width = 0) { return AppendInteger((long long) Value, Width); }
+  //! Append an unsigned integer, like ostream<<setw(Width)<<Value
+  MString& AppendInteger(unsigned long Value, int Width = 0) { return AppendInteger((unsigned long long) Value, Width); }
+  //! Append a floating point number, like ostream<<fixed<<setprecision(Precision)<<setw(Width)<<Value
+  MString& AppendFixed(double Value, int Precision, int Width = 0);
+  //! Append a floating point number, like ostream<<scientific<<setprecision(Precision)<<setw(Width)<<Value
+  MString& AppendScientific(double Value, int Precision, int Width = 0);
+  //! Append a floating point number in the default ostream notation, like ostream<<setprecision(Precision)<<setw(Width)<<Value
+  MString& AppendGeneral(double Value, int Precision = 6, int Width = 0);
+
 
   //! Remove all characters from Start to the End
   void RemoveInPlace(size_t Start) { if (Start >= Length()) return; m_String.erase(Start, Length() - Start); }
@@ -28,6 +28,7 @@
 
 // Standard libs:
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 using namespace std;
 
@@ -39,6 +40,7 @@ using namespace std;
 #include "MGlobal.h"
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MFastTokenizer.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1141,47 +1143,58 @@ MString MComptonEvent::ToTraString() const
 {
   //! Stream the content into a tra-file compatible string
 
+  // This is called for every event, thus the numbers are formatted directly and not via streams
+  // The output is identical to the default notation of an ostream
   MString T;
+  T.Reserve(1024 + 128*m_Hits.size());
   T += MPhysicalEvent::ToTraString();
 
-  ostringstream S;
+  auto AppendVector = [&T](const MVector& V) {
+    T.AppendGeneral(V[0]); T += ' '; T.AppendGeneral(V[1]); T += ' '; T.AppendGeneral(V[2]);
+  };
 
-  if (m_ClusteringQualityFactor != 0) S<<"PQ "<<m_ClusteringQualityFactor<<endl;
-  S<<"SQ "<<m_SequenceLength<<endl;
-  S<<"CT "<<m_ComptonQualityFactor1<<" "<<m_ComptonQualityFactor2<<endl;
-  S<<"TL "<<m_TrackLength<<endl;
-  S<<"TE "<<m_TrackInitialDeposit<<endl;
+  if (m_ClusteringQualityFactor != 0) {
+    T += "PQ "; T.AppendGeneral(m_ClusteringQualityFactor); T += '\n';
+  }
+  T += "SQ "; T += m_SequenceLength; T += '\n';
+  T += "CT "; T.AppendGeneral(m_ComptonQualityFactor1); T += ' '; T.AppendGeneral(m_ComptonQualityFactor2); T += '\n';
+  T += "TL "; T += m_TrackLength; T += '\n';
+  T += "TE "; T.AppendGeneral(m_TrackInitialDeposit); T += '\n';
   if (m_TrackQualityFactor1 != 0 || m_TrackQualityFactor2 != 0) {
-    S<<"TQ "<<m_TrackQualityFactor1<<" "<<m_TrackQualityFactor2<<endl;
+    T += "TQ "; T.AppendGeneral(m_TrackQualityFactor1); T += ' '; T.AppendGeneral(m_TrackQualityFactor2); T += '\n';
   }
-  S<<"CE "<<m_Eg<<" "<<m_dEg<<"   "<<m_Ee<<" "<<m_dEe<<endl;
-  S<<"CD "<<m_C1[0]<<" "<<m_C1[1]<<" "<<m_C1[2]<<"   ";
-  S<<m_dC1[0]<<" "<<m_dC1[1]<<" "<<m_dC1[2]<<"   ";
-  S<<m_C2[0]<<" "<<m_C2[1]<<" "<<m_C2[2]<<"   ";
-  S<<m_dC2[0]<<" "<<m_dC2[1]<<" "<<m_dC2[2]<<"   ";
-  S<<m_De[0]<<" "<<m_De[1]<<" "<<m_De[2]<<"   ";
-  S<<m_dDe[0]<<" "<<m_dDe[1]<<" "<<m_dDe[2]<<endl;
+  T += "CE "; T.AppendGeneral(m_Eg); T += ' '; T.AppendGeneral(m_dEg); T += "   "; T.AppendGeneral(m_Ee); T += ' '; T.AppendGeneral(m_dEe); T += '\n';
+  T += "CD ";
+  AppendVector(m_C1); T += "   ";
+  AppendVector(m_dC1); T += "   ";
+  AppendVector(m_C2); T += "   ";
+  AppendVector(m_dC2); T += "   ";
+  AppendVector(m_De); T += "   ";
+  AppendVector(m_dDe); T += '\n';
   if (m_ToF != 0 || m_dToF != 0) {
-    S<<"TF "<<m_ToF<<" "<<m_dToF<<endl;
+    T += "TF "; T.AppendGeneral(m_ToF); T += ' '; T.AppendGeneral(m_dToF); T += '\n';
+  }
+  T += "LA "; T.AppendGeneral(m_LeverArm); T += '\n';
+  if (m_CoincidenceWindow != 0) {
+    ostringstream S;
+    S<<"CW "<<m_CoincidenceWindow<<endl;
+    T += S.str();
   }
-  S<<"LA "<<m_LeverArm<<endl;
-  if (m_CoincidenceWindow != 0) S<<"CW "<<m_CoincidenceWindow<<endl;
   for (unsigned int h = 0; h < m_Hits.size(); ++h) {
-    S<<"CH "<<h
-     <<" "<<m_Hits[h].GetPosition().GetX()
-     <<" "<<m_Hits[h].GetPosition().GetY()
-     <<" "<<m_Hits[h].GetPosition().GetZ()
-     <<" "<<m_Hits[h].GetEnergy()
-     <<" "<<m_Hits[h].GetTime().GetAsDouble()
-     <<" "<<m_Hits[h].GetPositionUncertainty().GetX()
-     <<" "<<m_Hits[h].GetPositionUncertainty().GetY()
-     <<" "<<m_Hits[h].GetPositionUncertainty().GetZ()
-     <<" "<<m_Hits[h].GetEnergyUncertainty()
-     <<" "<<m_Hits[h].GetTimeUncertainty().GetAsDouble()<<endl;
+    T += "CH "; T += h;
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPosition().GetX());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPosition().GetY());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPosition().GetZ());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetEnergy());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetTime().GetAsDouble());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPositionUncertainty().GetX());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPositionUncertainty().GetY());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetPositionUncertainty().GetZ());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetEnergyUncertainty());
+    T += ' '; T.AppendGeneral(m_Hits[h].GetTimeUncertainty().GetAsDouble());
+    T += '\n';
   }
 
-  T += S.str();
-
   return T;
 }
 
@@ -1204,47 +1217,37 @@ int MComptonEvent::ParseLine(const char* Line, bool Fast)
   Ret = 0;
 
   if (Line[0] == 'C' && Line[1] == 'E') {
-    if (Fast == true) {
-      char* p;
-      m_Eg = strtod(Line+3, &p);
-      m_dEg = strtod(p, &p);
-      m_Ee = strtod(p, &p);
-      m_dEe = strtod(p, NULL);
+    // The most frequent lines have a fixed layout, thus parse them directly without sscanf/strtod
+    const char* Position = Line + 2;
+    const char* End = Position + strlen(Position);
+    double Values[4];
+    if (MFastTokenizer::ParseDoubles(Position, End, Values, 4) == 4) {
+      m_Eg = Values[0];
+      m_dEg = Values[1];
+      m_Ee = Values[2];
+      m_dEe = Values[3];
     } else {
-      if (sscanf(Line, "CE %lf %lf %lf %lf", &m_Eg, &m_dEg, &m_Ee, &m_dEe) != 4) {
+      if (Fast == false) {
         mout<<"Unable to parse CE of event "<<m_Id<<"!"<<endl;
-        Ret = 1;
       }
+      Ret = 1;
     }
   } else if (Line[0] == 'C' && Line[1] == 'D') {
-    if (Fast == true) {
-      char* p;
-      m_C1[0] = strtod(Line+3, &p);
-      m_C1[1] = strtod(p, &p);
-      m_C1[2] = strtod(p, &p);
-      m_dC1[0] = strtod(p, &p);
-      m_dC1[1] = strtod(p, &p);
-      m_dC1[2] = strtod(p, &p);
-      m_C2[0] = strtod(p, &p);
-      m_C2[1] = strtod(p, &p);
-      m_C2[2] = strtod(p, &p);
-      m_dC2[0] = strtod(p, &p);
-      m_dC2[1] = strtod(p, &p);
-      m_dC2[2] = strtod(p, &p);
-      m_De[0] = strtod(p, &p);
-      m_De[1] = strtod(p, &p);
-      m_De[2] = strtod(p, &p);
-      m_dDe[0] = strtod(p, &p);
-      m_dDe[1] = strtod(p, &p);
-      m_dDe[2] = strtod(p, NULL);
+    const char* Position = Line + 2;
+    const char* End = Position + strlen(Position);
+    double Values[18];
+    if (MFastTokenizer::ParseDoubles(Position, End, Values, 18) == 18) {
+      m_C1.SetXYZ(Values[0], Values[1], Values[2]);
+      m_dC1.SetXYZ(Values[3], Values[4], Values[5]);
+      m_C2.SetXYZ(Values[6], Values[7], Values[8]);
+      m_dC2.SetXYZ(Values[9], Values[10], Values[11]);
+      m_De.SetXYZ(Values[12], Values[13], Values[14]);
+      m_dDe.SetXYZ(Values[15], Values[16], Values[17]);
     } else {
-      if (sscanf(Line, "CD %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", 
-                 &m_C1[0], &m_C1[1], &m_C1[2], &m_dC1[0], &m_dC1[1], &m_dC1[2], 
-                 &m_C2[0], &m_C2[1], &m_C2[2], &m_dC2[0], &m_dC2[1], &m_dC2[2], 
-                 &m_De[0], &m_De[1], &m_De[2], &m_dDe[0], &m_dDe[1], &m_dDe[2]) != 18) {
-        cout<<"Unable to parse CD of event "<<m_Id<<"!"<<endl;
-        Ret = 1;
+      if (Fast == false) {
+        mout<<"Unable to parse CD of event "<<m_Id<<"!"<<endl;
       }
+      Ret = 1;
     }
   } else if (Line[0] == 'C' && Line[1] == 'H') {
     if (Fast == true) {
@@ -0,0 +1,385 @@
+/*
+ * MFastTokenizer.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MFastTokenizer
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MFastTokenizer.h"
+
+// Standard libs:
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MFastTokenizer)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MFastTokenizer::MFastTokenizer(const char Separator) : m_Separator(Separator)
+{
+  // Construct an instance of MFastTokenizer
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MFastTokenizer::~MFastTokenizer()
+{
+  // Delete this instance of MFastTokenizer
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::Analyze(const char* Line)
+{
+  // Split the line into tokens
+
+  return Analyze(Line, strlen(Line));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::Analyze(const char* Line, size_t Length)
+{
+  // Split the line into tokens - the same rules as MTokenizer::AnalyzeFast
+
+  m_Tokens.clear();
+
+  const char* Position = Line;
+  const char* End = Line + Length;
+
+  while (Position < End) {
+    // Skip the separators
+    while (Position < End && (*Position == m_Separator || *Position == '\t' || *Position == '\r')) ++Position;
+    if (Position == End || *Position == '\n' || *Position == '\0') break;
+
+    // Comments end the line
+    if (*Position == '#' || (*Position == '/' && Position + 1 < End && Position[1] == '/')) break;
+
+    const char* TokenStart = Position;
+    while (Position < End && *Position != m_Separator && *Position != '\t' && *Position != '\r' && *Position != '\n' && *Position != '\0') ++Position;
+    m_Tokens.emplace_back(TokenStart, Position - TokenStart);
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::IsTokenAt(const unsigned int i, const char* Token) const
+{
+  // Check if the given token is at position i
+
+  if (i >= m_Tokens.size()) return false;
+
+  return m_Tokens[i] == Token;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MFastTokenizer::GetTokenAtAsString(const unsigned int i) const
+{
+  // Return the token at position i as MString
+
+  if (i >= m_Tokens.size()) return MString();
+
+  return MString(m_Tokens[i].data(), m_Tokens[i].size());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+string_view MFastTokenizer::GetTokenAfter(const unsigned int i) const
+{
+  // Return the remaining line starting with token i
+
+  if (i >= m_Tokens.size()) return string_view();
+
+  const char* Start = m_Tokens[i].data();
+  const char* End = m_Tokens.back().data() + m_Tokens.back().size();
+
+  return string_view(Start, End - Start);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MFastTokenizer::GetTokenAtAsDouble(const unsigned int i) const
+{
+  // Return the token at position i as double
+
+  if (i >= m_Tokens.size()) return 0.0;
+
+  const char* Position = m_Tokens[i].data();
+  double Value = 0.0;
+  ParseDouble(Position, Position + m_Tokens[i].size(), Value);
+
+  return Value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+float MFastTokenizer::GetTokenAtAsFloat(const unsigned int i) const
+{
+  // Return the token at position i as float
+
+  return float(GetTokenAtAsDouble(i));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MFastTokenizer::GetTokenAtAsInt(const unsigned int i) const
+{
+  // Return the token at position i as int
+
+  if (i >= m_Tokens.size()) return 0;
+
+  const char* Position = m_Tokens[i].data();
+  int Value = 0;
+  ParseInt(Position, Position + m_Tokens[i].size(), Value);
+
+  return Value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MFastTokenizer::GetTokenAtAsUnsignedInt(const unsigned int i) const
+{
+  // Return the token at position i as unsigned int
+
+  return (unsigned int) GetTokenAtAsUnsignedLong(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+long MFastTokenizer::GetTokenAtAsLong(const unsigned int i) const
+{
+  // Return the token at position i as long
+
+  if (i >= m_Tokens.size()) return 0;
+
+  const char* Position = m_Tokens[i].data();
+  const char* End = Position + m_Tokens[i].size();
+  SkipToNumber(Position, End, ' ');
+
+  long Value = 0;
+  from_chars(Position, End, Value);
+
+  return Value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned long MFastTokenizer::GetTokenAtAsUnsignedLong(const unsigned int i) const
+{
+  // Return the token at position i as unsigned long
+
+  if (i >= m_Tokens.size()) return 0;
+
+  const char* Position = m_Tokens[i].data();
+  unsigned long Value = 0;
+  ParseUnsignedLong(Position, Position + m_Tokens[i].size(), Value);
+
+  return Value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::GetTokenAtAsBoolean(const unsigned int i) const
+{
+  // Return the token at position i as boolean
+
+  if (i >= m_Tokens.size()) return false;
+
+  if (m_Tokens[i] == "true" || m_Tokens[i] == "TRUE" || m_Tokens[i] == "True") return true;
+  if (m_Tokens[i] == "false" || m_Tokens[i] == "FALSE" || m_Tokens[i] == "False") return false;
+
+  return GetTokenAtAsInt(i) != 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFastTokenizer::SkipToNumber(const char*& Position, const char* End, const char Separator)
+{
+  // Skip the blanks and one separator in front of a number
+
+  while (Position < End && (*Position == ' ' || *Position == '\t')) ++Position;
+  if (Separator != ' ' && Position < End && *Position == Separator) {
+    ++Position;
+    while (Position < End && (*Position == ' ' || *Position == '\t')) ++Position;
+  }
+  if (Position + 1 < End && *Position == '+' && Position[1] != '-') ++Position;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::ParseDouble(const char*& Position, const char* End, double& Value, const char Separator)
+{
+  // Parse a double at Position and move Position behind it
+
+  SkipToNumber(Position, End, Separator);
+
+#if defined(__cpp_lib_to_chars)
+  from_chars_result Result = from_chars(Position, End, Value);
+  if (Result.ec == errc::invalid_argument) return false;
+  if (Result.ec == errc()) {
+    Position = Result.ptr;
+    return true;
+  }
+  // Out of range: let strtod decide, which accepts subnormal numbers and only rejects overflows
+#endif
+
+  // strtod is also the fall back if floating point from_chars is not available (e.g. gcc < 11, Apple libc++)
+  // It needs a terminated string, thus copy the number
+  char Buffer[64];
+  size_t Length = min(size_t(End - Position), sizeof(Buffer) - 1);
+  memcpy(Buffer, Position, Length);
+  Buffer[Length] = '\0';
+
+  char* Stop = nullptr;
+  errno = 0;
+  double Parsed = strtod(Buffer, &Stop);
+  if (Stop == Buffer) return false;
+
+  Position += Stop - Buffer;
+  if (errno == ERANGE && fabs(Parsed) == HUGE_VAL) return false;
+
+  Value = Parsed;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::ParseInt(const char*& Position, const char* End, int& Value, const char Separator)
+{
+  // Parse an int at Position and move Position behind it
+
+  SkipToNumber(Position, End, Separator);
+
+  from_chars_result Result = from_chars(Position, End, Value);
+  if (Result.ec == errc::invalid_argument) return false;
+
+  Position = Result.ptr;
+
+  return Result.ec == errc();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::ParseLong(const char*& Position, const char* End, long& Value, const char Separator)
+{
+  // Parse a long at Position and move Position behind it
+
+  SkipToNumber(Position, End, Separator);
+
+  from_chars_result Result = from_chars(Position, End, Value);
+  if (Result.ec == errc::invalid_argument) return false;
+
+  Position = Result.ptr;
+
+  return Result.ec == errc();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFastTokenizer::ParseUnsignedLong(const char*& Position, const char* End, unsigned long& Value, const char Separator)
+{
+  // Parse an unsigned long at Position and move Position behind it
+
+  SkipToNumber(Position, End, Separator);
+
+  from_chars_result Result = from_chars(Position, End, Value);
+  if (Result.ec == errc::invalid_argument) return false;
+
+  Position = Result.ptr;
+
+  return Result.ec == errc();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MFastTokenizer::ParseDoubles(const char*& Position, const char* End, double* Values, const unsigned int N, const char Separator)
+{
+  // Parse N doubles, return the number of successfully parsed values
+
+  for (unsigned int i = 0; i < N; ++i) {
+    if (ParseDouble(Position, End, Values[i], Separator) == false) return i;
+  }
+
+  return N;
+}
+
+
+// MFastTokenizer.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,7 @@
 #include "MGlobal.h"
 #include "MAssert.h"
 #include "MFile.h"
+#include "MFileEventCache.h"
 #include "MTimer.h"
 #include "MStreams.h"
 #include "MGUIProgressBar.h"
@@ -38,6 +39,8 @@
 #include <cstdio>
 #include <filesystem>
 #include <random>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 
 
@@ -70,6 +73,15 @@ MFile::MFile()
 
   m_Progress = nullptr;
   m_ZipFile = 0;
+  m_BlockedZipFile = nullptr;
+  m_CachedFile = nullptr;
+  m_UseBlockedCompression = false;
+  m_UseEventCache = false;
+  m_NCompressionThreads = 0;
+  m_UseBackgroundWriting = false;
+  m_BackgroundWriterBusy = false;
+  m_StopBackgroundWriter = false;
+  m_BackgroundWriterFailed = false;
   m_IsOpen = false;
   m_IsBinary = false;
   m_ReadLineBufferLength = 0;
@@ -141,6 +153,8 @@ void MFile::Reset()
   m_UncompressedFileLength = 0;
   m_HasUncompressedFileLength = false;
 
+  m_UncompressedOffsetBase = 0;
+
   // The maximum allowed file length
   m_MaxFileLength = numeric_limits<streamsize>::max()/100*95;
   //m_MaxFileLength = 100000;
@@ -371,6 +385,8 @@ bool MFile::Open(MString FileName, unsigned int Way, bool IsBinary)
   m_UncompressedFileLength = 0;
   m_HasUncompressedFileLength = false;
 
+  m_UncompressedOffsetBase = 0;
+
   m_FileName = FileName;
   if (m_FileName == "") {
     mgui<<"You need to give a file name, before I can open a file."<<error;
@@ -399,13 +415,42 @@ bool MFile::Open(MString FileName, unsigned int Way, bool IsBinary)
 
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    if (Way == c_Read) {
-      m_ZipFile = gzopen(m_FileName, "rb");
+  // Read compressed files from their decompressed copy in the event cache if possible
+  if (m_WasZipped == true && Way == c_Read && m_UseEventCache == true && MFileEventCache::IsEnabled() == true) {
+    MString CachedFileName = MFileEventCache::Attach(m_FileName);
+    if (CachedFileName != "") {
+      m_CachedFile = new MFileMapped();
+      if (m_CachedFile->Open(CachedFileName) == false) {
+        delete m_CachedFile;
+        m_CachedFile = nullptr;
+      }
+    }
+  }
+
+  if (m_CachedFile != nullptr) {
+    // Nothing else to open
+  } else if (m_WasZipped == true) {
+    bool IsZipOpen = false;
+    if ((Way == c_Read && MFileBGZF::IsBGZF(m_FileName) == true) || (Way != c_Read && m_UseBlockedCompression == true)) {
+      m_BlockedZipFile = new MFileBGZF();
+      if (Way == c_Read) {
+        IsZipOpen = m_BlockedZipFile->OpenForReading(m_FileName, m_NCompressionThreads);
+      } else {
+        IsZipOpen = m_BlockedZipFile->OpenForWriting(m_FileName, m_CompressionLevel);
+      }
+      if (IsZipOpen == false) {
+        delete m_BlockedZipFile;
+        m_BlockedZipFile = nullptr;
+      }
     } else {
-      m_ZipFile = gzopen(m_FileName, MString("wb") + m_CompressionLevel); // Maxmimum compression level is OK, since it is negligible compared to data analysis
+      if (Way == c_Read) {
+        m_ZipFile = gzopen(m_FileName, "rb");
+      } else {
+        m_ZipFile = gzopen(m_FileName, MString("wb") + m_CompressionLevel); // Maxmimum compression level is OK, since it is negligible compared to data analysis
+      }
+      IsZipOpen = (m_ZipFile != NULL);
     }
-    if (m_ZipFile == NULL) {
+    if (IsZipOpen == false) {
       mgui<<"Unable to open file \""<<m_FileName<<"\""<<endl;
       m_FileMutex.UnLock();
       return false;
@@ -428,6 +473,15 @@ bool MFile::Open(MString FileName, unsigned int Way, bool IsBinary)
   m_IsOpen = true;
   m_Way = Way;
   m_IsBinary = IsBinary;
+  m_SeekPoints.clear();
+
+  if (m_Way != c_Read && m_UseBackgroundWriting == true) {
+    m_WriteBlock.clear();
+    m_WriteBlock.reserve(c_WriteBlockSize + c_WriteBlockSize/8);
+    m_StopBackgroundWriter = false;
+    m_BackgroundWriterFailed = false;
+    m_BackgroundWriter = thread(&MFile::BackgroundWriterLoop, this);
+  }
   
   m_FileMutex.UnLock();
 
@@ -449,8 +503,16 @@ bool MFile::Rewind(bool ResetProgressStatistics)
     return false;
   }
 
-  if (m_WasZipped == true) {
-    gzrewind(m_ZipFile);
+  if (m_BlockedZipFile != nullptr) {
+    m_BlockedZipFile->Rewind();
+  } else if (m_CachedFile != nullptr) {
+    m_CachedFile->Rewind();
+  } else if (m_WasZipped == true) {
+    if (m_UncompressedOffsetBase != 0) {
+      ReopenZipFileNoLock(0, 0);
+    } else {
+      gzrewind(m_ZipFile);
+    }
   } else {
     m_File.clear();
     m_File.seekg(0);
@@ -488,8 +550,19 @@ bool MFile::Close()
     return true;
   }
 
+  // Write everything still pending
+  StopBackgroundWriterNoLock();
+
   // Close the file first
-  if (m_WasZipped == true) {
+  if (m_BlockedZipFile != nullptr) {
+    m_BlockedZipFile->Close();
+    delete m_BlockedZipFile;
+    m_BlockedZipFile = nullptr;
+  } else if (m_CachedFile != nullptr) {
+    m_CachedFile->Close();
+    delete m_CachedFile;
+    m_CachedFile = nullptr;
+  } else if (m_WasZipped == true) {
     gzclose(m_ZipFile);
   } else {
     m_File.close();
@@ -531,8 +604,11 @@ bool MFile::IsGoodNoLock()
 {
   bool IsGood = false;
 
-  if (m_WasZipped == true) {
-    IsGood = (gzeof(m_ZipFile) == 0 ? true : false);
+  if (m_BackgroundWriter.joinable() == true) {
+    // The file itself is only accessed by the background writer
+    IsGood = (m_BackgroundWriterFailed == false);
+  } else if (m_WasZipped == true) {
+    IsGood = (ZipEof() == false ? true : false);
   } else {
     IsGood = m_File.good();
   }
@@ -567,8 +643,16 @@ void MFile::Seek(streampos Pos)
 
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzseek(m_ZipFile, Pos, SEEK_SET);
+  if (m_BlockedZipFile != nullptr) {
+    m_BlockedZipFile->Seek(Pos);
+  } else if (m_CachedFile != nullptr) {
+    m_CachedFile->Seek(Pos);
+  } else if (m_WasZipped == true) {
+    // After a jump to a seek point we can only seek forward from its start
+    if (Pos < m_UncompressedOffsetBase) {
+      ReopenZipFileNoLock(0, 0);
+    }
+    gzseek(m_ZipFile, Pos - m_UncompressedOffsetBase, SEEK_SET);
   } else {
     m_File.seekg(Pos);
   }
@@ -585,9 +669,28 @@ void MFile::Seek(streamoff Offset, ios_base::seekdir Way)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
+  if (m_BlockedZipFile != nullptr) {
+    if (Way == ios_base::beg) {
+      m_BlockedZipFile->Seek(Offset);
+    } else if (Way == ios_base::cur) {
+      m_BlockedZipFile->Seek(m_BlockedZipFile->Tell() + Offset);
+    } else if (Way == ios_base::end) {
+      m_BlockedZipFile->Seek(m_BlockedZipFile->GetUncompressedLength() + Offset);
+    }
+  } else if (m_CachedFile != nullptr) {
     if (Way == ios_base::beg) {
-      gzseek(m_ZipFile, (z_off_t) Offset, SEEK_SET);
+      m_CachedFile->Seek(Offset);
+    } else if (Way == ios_base::cur) {
+      m_CachedFile->Seek(m_CachedFile->Tell() + Offset);
+    } else if (Way == ios_base::end) {
+      m_CachedFile->Seek(m_CachedFile->GetLength() + Offset);
+    }
+  } else if (m_WasZipped == true) {
+    if (Way == ios_base::beg) {
+      if (Offset < m_UncompressedOffsetBase) {
+        ReopenZipFileNoLock(0, 0);
+      }
+      gzseek(m_ZipFile, (z_off_t) (Offset - m_UncompressedOffsetBase), SEEK_SET);
     } else if (Way == ios_base::cur) {
       gzseek(m_ZipFile, (z_off_t) Offset, SEEK_CUR);
     } else if (Way == ios_base::end) {
@@ -604,35 +707,273 @@ void MFile::Seek(streamoff Offset, ios_base::seekdir Way)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-//! Write some text and clear the stream
-void MFile::WriteLine()
+bool MFile::CreateSeekPoint(streampos& UncompressedOffset, streampos& CompressedOffset)
 {
+  // Create a seek point while writing and return its uncompressed and compressed offset
+
   m_FileMutex.Lock();
+  WaitForBackgroundWriterNoLock();
 
-  if (m_WasZipped == true) {
-    gzputs(m_ZipFile, "\n");
+  if (m_IsOpen == false || m_Way == c_Read) {
+    m_FileMutex.UnLock();
+    return false;
+  }
+
+  bool Return = CreateSeekPointNoLock(UncompressedOffset, CompressedOffset);
+
+  m_FileMutex.UnLock();
+
+  return Return;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFile::RequestSeekPoint()
+{
+  // Request a seek point at the current end of the written data
+  // With background writer only a marker is queued behind the data, thus the calling thread does not wait for the writer
+
+  m_FileMutex.Lock();
+
+  if (m_IsOpen == false || m_Way == c_Read) {
+    m_FileMutex.UnLock();
+    return false;
+  }
+
+  bool Return = true;
+  if (m_BackgroundWriter.joinable() == true) {
+    HandOverWriteBlockNoLock();
+    {
+      lock_guard<mutex> Lock(m_WriteQueueMutex);
+      m_WriteQueue.push_back(string());
+    }
+    m_WriteQueueFilled.notify_one();
   } else {
-    m_File<<endl;
+    streampos UncompressedOffset;
+    streampos CompressedOffset;
+    Return = CreateSeekPointNoLock(UncompressedOffset, CompressedOffset);
+    if (Return == true) {
+      lock_guard<mutex> Lock(m_WriteQueueMutex);
+      m_SeekPoints.push_back(make_pair(UncompressedOffset, CompressedOffset));
+    }
   }
 
   m_FileMutex.UnLock();
+
+  return Return;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 
 
-//! Write some text and clear the stream
-void MFile::Write(const ostringstream& S)
+vector<pair<streampos, streampos>> MFile::GetSeekPoints()
+{
+  // Return the offsets of the seek points created via RequestSeekPoint
+
+  lock_guard<mutex> Lock(m_WriteQueueMutex);
+  return m_SeekPoints;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFile::CreateSeekPointNoLock(streampos& UncompressedOffset, streampos& CompressedOffset)
 {
+  // Create a seek point in the file itself
+  // Only called by the background writer while it is running, otherwise by the thread holding the file mutex
+
+  if (m_BlockedZipFile != nullptr) {
+    // Complete the current block - the seek point is the start of the next one
+    if (m_BlockedZipFile->FlushBlock() == false) return false;
+    UncompressedOffset = (streampos) m_BlockedZipFile->Tell();
+    CompressedOffset = (streampos) m_BlockedZipFile->GetCompressedPosition();
+  } else if (m_WasZipped == true) {
+    // Complete the current gzip member -- the next write starts a new one,
+    // which can be decompressed independently of everything before it
+    if (gzflush(m_ZipFile, Z_FINISH) != Z_OK) return false;
+    UncompressedOffset = (streampos) gztell(m_ZipFile);
+    CompressedOffset = (streampos) gzoffset(m_ZipFile);
+  } else {
+    UncompressedOffset = m_File.tellp();
+    CompressedOffset = UncompressedOffset;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFile::JumpToSeekPoint(streampos UncompressedOffset, streampos CompressedOffset)
+{
+  // Jump to a seek point created with CreateSeekPoint while reading
+
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzputs(m_ZipFile, S.str().c_str());
+  if (m_IsOpen == false || m_Way != c_Read) {
+    m_FileMutex.UnLock();
+    return false;
+  }
+
+  bool Return = true;
+  if (m_BlockedZipFile != nullptr) {
+    // The compressed offset is a block start, i.e. the virtual offset is just shifted
+    Return = m_BlockedZipFile->SeekVirtualOffset((uint64_t) streamoff(CompressedOffset) << 16);
+  } else if (m_CachedFile != nullptr) {
+    Return = m_CachedFile->Seek(streamoff(UncompressedOffset));
+  } else if (m_WasZipped == true) {
+    Return = ReopenZipFileNoLock(UncompressedOffset, CompressedOffset);
   } else {
-    m_File<<S.str();
+    m_File.clear();
+    m_File.seekg(UncompressedOffset);
+    Return = m_File.good();
+  }
+
+  m_FileMutex.UnLock();
+
+  return Return;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFile::ReopenZipFileNoLock(streampos UncompressedOffset, streampos CompressedOffset)
+{
+  // Reopen the gzip'ed file at the start of a gzip member
+  // zlib cannot restart decompression in the middle of a stream, thus we open a new stream at the given member
+
+  gzclose(m_ZipFile);
+  m_ZipFile = NULL;
+  m_UncompressedOffsetBase = 0;
+
+  int FileDescriptor = open(m_FileName.Data(), O_RDONLY);
+  if (FileDescriptor < 0) {
+    merr<<"Unable to reopen file \""<<m_FileName<<"\""<<show;
+    m_IsOpen = false;
+    return false;
+  }
+  if (lseek(FileDescriptor, (off_t) CompressedOffset, SEEK_SET) != (off_t) CompressedOffset) {
+    merr<<"Unable to seek to position "<<CompressedOffset<<" in file \""<<m_FileName<<"\""<<show;
+    close(FileDescriptor);
+    m_IsOpen = false;
+    return false;
+  }
+
+  m_ZipFile = gzdopen(FileDescriptor, "rb");
+  if (m_ZipFile == NULL) {
+    merr<<"Unable to reopen file \""<<m_FileName<<"\""<<show;
+    close(FileDescriptor);
+    m_IsOpen = false;
+    return false;
+  }
+  m_UncompressedOffsetBase = UncompressedOffset;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+uint64_t MFile::GetVirtualFilePosition()
+{
+  // Return the current position as virtual offset
+
+  m_FileMutex.Lock();
+  WaitForBackgroundWriterNoLock();
+
+  uint64_t Position = 0;
+  if (m_IsOpen == true) {
+    if (m_BlockedZipFile != nullptr) {
+      Position = m_BlockedZipFile->GetVirtualOffset();
+    } else if (m_CachedFile != nullptr) {
+      Position = m_CachedFile->Tell();
+    } else if (m_WasZipped == true) {
+      Position = streamoff(m_UncompressedOffsetBase) + gztell(m_ZipFile);
+    } else {
+      Position = (m_Way == c_Read) ? streamoff(m_File.tellg()) : streamoff(m_File.tellp());
+    }
+  }
+
+  m_FileMutex.UnLock();
+
+  return Position;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFile::SeekVirtualFilePosition(uint64_t VirtualOffset)
+{
+  // Seek a virtual offset returned by GetVirtualFilePosition
+
+  if (m_IsOpen == false || m_Way != c_Read) return false;
+
+  if (m_BlockedZipFile != nullptr) {
+    m_FileMutex.Lock();
+    bool Return = m_BlockedZipFile->SeekVirtualOffset(VirtualOffset);
+    m_FileMutex.UnLock();
+    return Return;
+  }
+
+  // Everything else is just the uncompressed position
+  Seek((streampos) VirtualOffset);
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MFile::ZipError()
+{
+  // Return the error message of the compressed stream
+
+  if (m_BlockedZipFile != nullptr) {
+    return m_BlockedZipFile->HasError() ? "Corrupt or unreadable block" : "";
+  }
+  if (m_CachedFile != nullptr) {
+    return "";
   }
 
+  int ErrorCode = 0;
+  return gzerror(m_ZipFile, &ErrorCode);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write some text and clear the stream
+void MFile::WriteLine()
+{
+  m_FileMutex.Lock();
+
+  WriteEndOfLineNoLock();
+
+  m_FileMutex.UnLock();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write some text and clear the stream
+void MFile::Write(const ostringstream& S)
+{
+  m_FileMutex.Lock();
+
+  string Text = S.str();
+  WriteNoLock(Text.data(), Text.size());
+
   m_FileMutex.UnLock();
 }
 
@@ -645,12 +986,9 @@ void MFile::WriteLine(const ostringstream& S)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzputs(m_ZipFile, S.str().c_str());
-    gzputs(m_ZipFile, "\n");
-  } else {
-    m_File<<S.str()<<endl;
-  }
+  string Text = S.str();
+  WriteNoLock(Text.data(), Text.size());
+  WriteEndOfLineNoLock();
 
   m_FileMutex.UnLock();
 }
@@ -664,11 +1002,7 @@ void MFile::Write(const MString& S)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzputs(m_ZipFile, S);
-  } else {
-    m_File<<S;
-  }
+  WriteNoLock(S.Data(), S.Length());
 
   m_FileMutex.UnLock();
 }
@@ -682,11 +1016,8 @@ void MFile::WriteLine(const MString& S)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzputs(m_ZipFile, S + "\n");
-  } else {
-    m_File<<S<<endl;
-  }
+  WriteNoLock(S.Data(), S.Length());
+  WriteEndOfLineNoLock();
 
   m_FileMutex.UnLock();
 }
@@ -700,13 +1031,9 @@ void MFile::Write(const double d)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    ostringstream out;
-    out<<d;
-    gzputs(m_ZipFile, out.str().c_str());
-  } else {
-    m_File<<d;
-  }
+  MString Text;
+  Text.AppendGeneral(d);
+  WriteNoLock(Text.Data(), Text.Length());
 
   m_FileMutex.UnLock();
 }
@@ -721,11 +1048,7 @@ void MFile::Write(const char c)
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
-    gzputc(m_ZipFile, c);
-  } else {
-    m_File<<c;
-  }
+  WriteNoLock(&c, 1);
 
   m_FileMutex.UnLock();
 }
@@ -739,12 +1062,8 @@ void MFile::Write(MBinaryStore& Store)
   m_FileMutex.Lock();
   
   for (unsigned int c = 0; c < Store.GetArraySize(); ++c) {
-   if (m_WasZipped == true) {
-      gzputc(m_ZipFile, Store.GetArrayValue(c));
-    } else {
-      uint8_t ui = Store.GetArrayValue(c);
-      m_File.write(reinterpret_cast<char*>(&ui), 1);
-    }
+    char Value = (char) Store.GetArrayValue(c);
+    WriteNoLock(&Value, 1);
   }
   
   m_FileMutex.UnLock();
@@ -759,7 +1078,9 @@ void MFile::Flush()
 {
   m_FileMutex.Lock();
 
-  if (m_WasZipped == true) {
+  if (m_BackgroundWriter.joinable() == true) {
+    // The background writer writes as soon as a block is full, and everything when the file is closed
+  } else if (m_WasZipped == true) {
     // We do not want to do this, since it degrades perfromance...
   } else {
     m_File<<flush;
@@ -786,11 +1107,10 @@ bool MFile::Get(char& c)
 
   if (m_WasZipped == true) {
     c = '\0';
-    int i = gzgetc(m_ZipFile);
+    int i = ZipGetc();
     if (i == -1) {
-      if (gzeof(m_ZipFile) == 0) {
-        int ErrorCode = 0;
-        cout<<"Error in MFile::Get(char& c): "<<gzerror(m_ZipFile, &ErrorCode)<<endl;
+      if (ZipEof() == false) {
+        cout<<"Error in MFile::Get(char& c): "<<ZipError()<<endl;
       }
       m_FileMutex.UnLock();
       return false;
@@ -827,12 +1147,11 @@ bool MFile::Get(float& f)
     f = 0;
     string temp;
     int i;
-    while (gzeof(m_ZipFile) == 0) {
-      i = gzgetc(m_ZipFile);
+    while (ZipEof() == false) {
+      i = ZipGetc();
       if (i == -1) {
-        if (gzeof(m_ZipFile) == 0) {
-          int ErrorCode = 0;
-          cout<<"Error: "<<gzerror(m_ZipFile, &ErrorCode)<<endl;
+        if (ZipEof() == false) {
+          cout<<"Error: "<<ZipError()<<endl;
         }
         m_FileMutex.UnLock();
         return false;
@@ -871,7 +1190,13 @@ bool MFile::ReadLine(MString& String)
 
   String.Clear();
 
-  if (m_WasZipped == true) {
+  if (m_CachedFile != nullptr) {
+    // The line can be taken directly from the mapped memory
+    if (m_CachedFile->ReadLine(String.GetStringRef()) == false) {
+      m_FileMutex.UnLock();
+      return false;
+    }
+  } else if (m_WasZipped == true) {
     if (m_ReadLineBufferLength == 0) {  // micro chance of a race condition --- but as long as the class is used as designed it will never happen
       m_ReadLineBufferLength = 1000;
       m_ReadLineBuffer = new char[m_ReadLineBufferLength];
@@ -880,12 +1205,11 @@ bool MFile::ReadLine(MString& String)
 
     do {
       m_ReadLineBuffer[0] = '\0';
-      Return = gzgets(m_ZipFile, m_ReadLineBuffer, m_ReadLineBufferLength-1);
+      Return = ZipGets(m_ReadLineBuffer, m_ReadLineBufferLength-1);
       if (Return == Z_NULL) {
-        if (gzeof(m_ZipFile) == 0) {
-          int ErrorCode;
+        if (ZipEof() == false) {
           cout<<"Error reading compressed file: "<<endl;
-          cout<<"   "<<gzerror(m_ZipFile, &ErrorCode)<<endl;
+          cout<<"   "<<ZipError()<<endl;
         }
         m_FileMutex.UnLock();
         return false;
@@ -923,7 +1247,7 @@ bool MFile::ReadLine(char* String, streamsize Size, char Delimeter)
   //! Read one line
   if (m_WasZipped == true) {
     for (streamsize i = 0; i < Size; ++i) {
-      int c = gzgetc(m_ZipFile);
+      int c = ZipGetc();
       if (c == -1 || (char) c == Delimeter) {
         String[i] = '\0';
         m_FileMutex.UnLock();
@@ -958,7 +1282,7 @@ bool MFile::Read(MBinaryStore& Store, unsigned int CharactersToRead)
   //! Read one line
   if (m_WasZipped == true) {
     for (unsigned int i = 0; i < CharactersToRead; ++i) {
-      int c = gzgetc(m_ZipFile);
+      int c = ZipGetc();
       if (c == -1) {
         m_FileMutex.UnLock();
         return true;
@@ -1368,10 +1692,22 @@ streampos MFile::GetUncompressedFileLength(bool Redetermine)
     return 0;
   }
 
+  WaitForBackgroundWriterNoLock();
+
   streampos Length;
-  if (m_WasZipped == true) {
+  if (m_BlockedZipFile != nullptr) {
+    // Known from the block index
+    Length = (streampos) m_BlockedZipFile->GetUncompressedLength();
+  } else if (m_CachedFile != nullptr) {
+    Length = (streampos) m_CachedFile->GetLength();
+  } else if (m_WasZipped == true) {
     if (m_Way == c_Read) {
 
+      // The uncompressed length is determined from the start of the file
+      if (m_UncompressedOffsetBase != 0) {
+        ReopenZipFileNoLock(0, 0);
+      }
+
       // First get the compressed file size
       ifstream in;
       in.open(m_FileName);
@@ -1445,9 +1781,13 @@ streampos MFile::GetFileLength(bool Redetermine)
     return 0;
   }
 
+  WaitForBackgroundWriterNoLock();
 
   streampos Length;
-  if (m_WasZipped == true) {
+  if (m_CachedFile != nullptr) {
+    // We read from the decompressed copy, thus file length and position (for the progress) refer to it
+    Length = (streampos) m_CachedFile->GetLength();
+  } else if (m_WasZipped == true) {
     if (m_Way == c_Read) {
       // First get the compressed file size
       ifstream in;
@@ -1455,6 +1795,8 @@ streampos MFile::GetFileLength(bool Redetermine)
       in.seekg(0, ios_base::end);
       Length = in.tellg();
       in.close();
+    } else if (m_BlockedZipFile != nullptr) {
+      Length = (streampos) m_BlockedZipFile->GetCompressedLength();
     } else {
       Length = (streampos) gzoffset(m_ZipFile); // We are already at the end
     }
@@ -1487,6 +1829,7 @@ streampos MFile::GetFilePosition()
   // Since this is a random access operation it should be very fast...
 
   m_FileMutex.Lock();
+  WaitForBackgroundWriterNoLock();
 
   if (IsOpen() == false) {
     merr<<"File "<<m_FileName<<" not open!"<<show;
@@ -1495,7 +1838,11 @@ streampos MFile::GetFilePosition()
   }
 
   streampos Pos = 0;
-  if (m_WasZipped == true) {
+  if (m_BlockedZipFile != nullptr) {
+    Pos = (streampos) m_BlockedZipFile->GetCompressedPosition();
+  } else if (m_CachedFile != nullptr) {
+    Pos = (streampos) m_CachedFile->Tell();
+  } else if (m_WasZipped == true) {
     Pos = (streampos) gzoffset(m_ZipFile);
   } else {
     Pos = m_File.tellg();
@@ -1516,6 +1863,7 @@ streampos MFile::GetUncompressedFilePosition()
   // Since this is a random access operation it should be very fast...
 
   m_FileMutex.Lock();
+  WaitForBackgroundWriterNoLock();
 
   if (IsOpen() == false) {
     merr<<"File "<<m_FileName<<" not open!"<<show;
@@ -1524,8 +1872,12 @@ streampos MFile::GetUncompressedFilePosition()
   }
 
   streampos Pos;
-  if (m_WasZipped == true) {
-    Pos = (streampos) gztell(m_ZipFile);
+  if (m_BlockedZipFile != nullptr) {
+    Pos = (streampos) m_BlockedZipFile->Tell();
+  } else if (m_CachedFile != nullptr) {
+    Pos = (streampos) m_CachedFile->Tell();
+  } else if (m_WasZipped == true) {
+    Pos = m_UncompressedOffsetBase + (streampos) gztell(m_ZipFile);
   } else {
     Pos = m_File.tellg();
   }
@@ -1536,5 +1888,168 @@ streampos MFile::GetUncompressedFilePosition()
 }
 
 
+void MFile::WriteNoLock(const char* Data, size_t Length)
+{
+  // Write the data into the file or the block of the background writer
+
+  if (m_BackgroundWriter.joinable() == true) {
+    m_WriteBlock.append(Data, Length);
+    if (m_WriteBlock.size() >= c_WriteBlockSize) {
+      HandOverWriteBlockNoLock();
+    }
+  } else {
+    WriteDirectNoLock(Data, Length);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::WriteEndOfLineNoLock()
+{
+  // Write the end of a line
+  // Without background writer, uncompressed files are flushed line by line as before,
+  // thus partially written files are complete up to the last line, e.g. after a crash
+
+  WriteNoLock("\n", 1);
+  if (m_BackgroundWriter.joinable() == false && m_WasZipped == false && m_BlockedZipFile == nullptr) {
+    m_File.flush();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::WriteDirectNoLock(const char* Data, size_t Length)
+{
+  // Write the data directly into the file
+
+  if (Length == 0) return;
+
+  if (m_BlockedZipFile != nullptr) {
+    m_BlockedZipFile->Write(Data, Length);
+  } else if (m_WasZipped == true) {
+    gzwrite(m_ZipFile, Data, Length);
+  } else {
+    m_File.write(Data, Length);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::HandOverWriteBlockNoLock()
+{
+  // Hand the current block over to the background writer
+  // If the writer is too far behind, wait - otherwise we would just fill up the memory
+
+  if (m_WriteBlock.empty() == true) return;
+
+  unique_lock<mutex> Lock(m_WriteQueueMutex);
+  m_WriteQueueDrained.wait(Lock, [this] { return m_WriteQueue.size() < c_MaximumWriteQueueLength; });
+  m_WriteQueue.push_back(move(m_WriteBlock));
+  Lock.unlock();
+  m_WriteQueueFilled.notify_one();
+
+  m_WriteBlock = string();
+  m_WriteBlock.reserve(c_WriteBlockSize + c_WriteBlockSize/8);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::WaitForBackgroundWriterNoLock()
+{
+  // Wait until the background writer has written everything - afterwards the file can be accessed directly
+
+  if (m_BackgroundWriter.joinable() == false) return;
+
+  HandOverWriteBlockNoLock();
+
+  unique_lock<mutex> Lock(m_WriteQueueMutex);
+  m_WriteQueueDrained.wait(Lock, [this] { return m_WriteQueue.empty() == true && m_BackgroundWriterBusy == false; });
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::StopBackgroundWriterNoLock()
+{
+  // Write everything and stop the background writer
+
+  if (m_BackgroundWriter.joinable() == false) return;
+
+  HandOverWriteBlockNoLock();
+
+  {
+    lock_guard<mutex> Lock(m_WriteQueueMutex);
+    m_StopBackgroundWriter = true;
+  }
+  m_WriteQueueFilled.notify_one();
+  m_BackgroundWriter.join();
+
+  m_WriteBlock = string();
+
+  if (m_BackgroundWriterFailed == true) {
+    merr<<"Unable to write all data to file \""<<m_FileName<<"\""<<show;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFile::BackgroundWriterLoop()
+{
+  // Main loop of the background writer thread: write (and compress) the blocks in the order they have been handed over
+  // The file is only accessed here while the thread is running, except when the queue is empty and the writer is idle
+
+  while (true) {
+    string Block;
+    {
+      unique_lock<mutex> Lock(m_WriteQueueMutex);
+      m_WriteQueueFilled.wait(Lock, [this] { return m_WriteQueue.empty() == false || m_StopBackgroundWriter == true; });
+      if (m_WriteQueue.empty() == true) {
+        // Stop requested and everything is written
+        break;
+      }
+      Block = move(m_WriteQueue.front());
+      m_WriteQueue.pop_front();
+      m_BackgroundWriterBusy = true;
+    }
+
+    // An empty block is a seek point request behind all data handed over before it
+    bool SeekPointCreated = false;
+    streampos UncompressedOffset;
+    streampos CompressedOffset;
+    if (Block.empty() == true) {
+      SeekPointCreated = CreateSeekPointNoLock(UncompressedOffset, CompressedOffset);
+    } else {
+      WriteDirectNoLock(Block.data(), Block.size());
+      if ((m_WasZipped == false && m_File.good() == false) || (m_BlockedZipFile != nullptr && m_BlockedZipFile->HasError() == true)) {
+        m_BackgroundWriterFailed = true;
+      }
+    }
+
+    {
+      lock_guard<mutex> Lock(m_WriteQueueMutex);
+      if (SeekPointCreated == true) {
+        m_SeekPoints.push_back(make_pair(UncompressedOffset, CompressedOffset));
+      }
+      m_BackgroundWriterBusy = false;
+    }
+    m_WriteQueueDrained.notify_all();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 // MFile.cxx: the end...
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,984 @@
+/*
+ * MFileBGZF.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MFileBGZF
+//
+// Reading and writing of blocked gzip (BGZF) files.
+//
+// Each block is a complete gzip member with the extra subfield "BC" holding
+// the compressed block size minus one. The uncompressed size of each block
+// is limited to 0xff00 bytes, which guarantees that the compressed block
+// never exceeds 64 kB. The file ends with an empty block (the EOF marker).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MFileBGZF.h"
+
+// Standard libs:
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+using namespace std;
+
+// ROOT libs:
+#include "zlib.h"
+
+// MEGAlib libs:
+#include "MStreams.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MFileBGZF)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+const unsigned int MFileBGZF::c_MaximumBlockSize = 65536;
+const unsigned int MFileBGZF::c_MaximumUncompressedBlockSize = 0xff00;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The size of the header we write: 12 bytes gzip header + 6 bytes extra field
+static const unsigned int g_BGZFHeaderSize = 18;
+//! The size of the gzip footer: CRC32 + ISIZE
+static const unsigned int g_BGZFFooterSize = 8;
+//! The empty block at the end of each BGZF file
+static const unsigned char g_BGZFEOFMarker[28] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read a little-endian 16-bit integer
+static inline uint32_t BGZFGetUInt16(const unsigned char* Data)
+{
+  return (uint32_t) Data[0] | ((uint32_t) Data[1] << 8);
+}
+
+
+//! Read a little-endian 32-bit integer
+static inline uint32_t BGZFGetUInt32(const unsigned char* Data)
+{
+  return (uint32_t) Data[0] | ((uint32_t) Data[1] << 8) | ((uint32_t) Data[2] << 16) | ((uint32_t) Data[3] << 24);
+}
+
+
+//! Write a little-endian integer of the given number of bytes
+static inline void BGZFPutUInt(unsigned char* Data, uint64_t Value, unsigned int Bytes)
+{
+  for (unsigned int b = 0; b < Bytes; ++b) {
+    Data[b] = (unsigned char) ((Value >> (8*b)) & 0xff);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default constructor
+MFileBGZF::MFileBGZF()
+{
+  m_IsOpen = false;
+  m_IsWriting = false;
+  m_EOF = false;
+  m_HasError = false;
+
+  m_WriteFile = nullptr;
+  m_CompressionLevel = 6;
+
+  m_FileDescriptor = -1;
+  m_CompressedLength = 0;
+  m_CurrentBlock = 0;
+  m_CurrentPosition = 0;
+
+  m_NThreads = 1;
+  m_NextReadAheadBlock = 0;
+  m_StopWorkers = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default destructor
+MFileBGZF::~MFileBGZF()
+{
+  Close();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return true if the file starts with a BGZF block header
+bool MFileBGZF::IsBGZF(const MString& FileName)
+{
+  ifstream in;
+  in.open(FileName.Data(), ios_base::in|ios_base::binary);
+  if (in.is_open() == false) return false;
+
+  unsigned char Header[g_BGZFHeaderSize];
+  in.read((char*) Header, g_BGZFHeaderSize);
+  if (in.gcount() != g_BGZFHeaderSize) return false;
+
+  // gzip magic, deflate, FEXTRA flag, and the BC subfield as first extra field
+  return Header[0] == 0x1f && Header[1] == 0x8b && Header[2] == 8 && (Header[3] & 4) != 0 &&
+         BGZFGetUInt16(Header + 10) >= 6 && Header[12] == 'B' && Header[13] == 'C' && BGZFGetUInt16(Header + 14) == 2;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Open the file for reading with the given number of decompression threads (0: automatic)
+bool MFileBGZF::OpenForReading(const MString& FileName, unsigned int NThreads)
+{
+  Close();
+
+  m_FileName = FileName;
+  m_IsWriting = false;
+  m_EOF = false;
+  m_HasError = false;
+
+  m_FileDescriptor = open(m_FileName.Data(), O_RDONLY);
+  if (m_FileDescriptor < 0) {
+    return false;
+  }
+
+  struct stat Status;
+  if (fstat(m_FileDescriptor, &Status) != 0) {
+    close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+    return false;
+  }
+  m_CompressedLength = Status.st_size;
+
+  if (BuildBlockIndex() == false) {
+    close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+    return false;
+  }
+
+  m_CurrentBlock = 0;
+  m_Current.reset();
+  m_CurrentPosition = 0;
+
+  if (NThreads == 0) {
+    NThreads = thread::hardware_concurrency();
+    if (NThreads > 8) NThreads = 8; // More does not help since the reader cannot parse faster anyway
+  }
+  if (NThreads == 0) NThreads = 1;
+  m_NThreads = NThreads;
+
+  m_IsOpen = true;
+
+  if (m_NThreads > 1) {
+    StartWorkers();
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Open the file for writing with the given compression level (1..9)
+bool MFileBGZF::OpenForWriting(const MString& FileName, unsigned int CompressionLevel)
+{
+  Close();
+
+  m_FileName = FileName;
+  m_IsWriting = true;
+  m_EOF = false;
+  m_HasError = false;
+
+  m_CompressionLevel = (CompressionLevel > 9) ? 9 : CompressionLevel;
+
+  m_WriteFile = fopen(m_FileName.Data(), "wb");
+  if (m_WriteFile == nullptr) {
+    return false;
+  }
+
+  m_Blocks.clear();
+  m_CompressedLength = 0;
+  m_WriteBuffer.clear();
+  m_WriteBuffer.reserve(c_MaximumUncompressedBlockSize);
+  m_CompressedBuffer.resize(c_MaximumBlockSize);
+
+  m_IsOpen = true;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Close the file
+bool MFileBGZF::Close()
+{
+  if (m_IsOpen == false) return true;
+
+  bool Return = true;
+  if (m_IsWriting == true) {
+    Return = FlushBlock();
+    if (fwrite(g_BGZFEOFMarker, 1, sizeof(g_BGZFEOFMarker), m_WriteFile) != sizeof(g_BGZFEOFMarker)) {
+      Return = false;
+    }
+    m_CompressedLength += sizeof(g_BGZFEOFMarker);
+    if (fclose(m_WriteFile) != 0) {
+      Return = false;
+    }
+    m_WriteFile = nullptr;
+
+    if (Return == true) {
+      WriteIndexFile();
+    }
+  } else {
+    StopWorkers();
+    close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+    m_Current.reset();
+  }
+
+  m_Blocks.clear();
+  m_WriteBuffer.clear();
+  m_IsOpen = false;
+
+  return Return;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write data
+bool MFileBGZF::Write(const char* Data, size_t Length)
+{
+  if (m_IsOpen == false || m_IsWriting == false) return false;
+
+  while (Length > 0) {
+    size_t Copy = min((size_t) (c_MaximumUncompressedBlockSize - m_WriteBuffer.size()), Length);
+    m_WriteBuffer.insert(m_WriteBuffer.end(), Data, Data + Copy);
+    Data += Copy;
+    Length -= Copy;
+
+    if (m_WriteBuffer.size() >= c_MaximumUncompressedBlockSize) {
+      if (CompressAndWriteBlock() == false) return false;
+    }
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a zero-terminated string
+bool MFileBGZF::Puts(const char* String)
+{
+  return Write(String, strlen(String));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a character
+bool MFileBGZF::Putc(char c)
+{
+  return Write(&c, 1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Complete the current block
+bool MFileBGZF::FlushBlock()
+{
+  if (m_IsOpen == false || m_IsWriting == false) return false;
+  if (m_WriteBuffer.size() == 0) return true;
+
+  return CompressAndWriteBlock();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Compress the buffered data into one block and write it
+bool MFileBGZF::CompressAndWriteBlock()
+{
+  z_stream Stream;
+  memset(&Stream, 0, sizeof(Stream));
+  if (deflateInit2(&Stream, m_CompressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    merr<<"Unable to initialize compression for "<<m_FileName<<show;
+    m_HasError = true;
+    return false;
+  }
+
+  unsigned char* Block = m_CompressedBuffer.data();
+
+  Stream.next_in = (Bytef*) m_WriteBuffer.data();
+  Stream.avail_in = m_WriteBuffer.size();
+  Stream.next_out = Block + g_BGZFHeaderSize;
+  Stream.avail_out = c_MaximumBlockSize - g_BGZFHeaderSize - g_BGZFFooterSize;
+
+  // With at most 0xff00 input bytes the output always fits, even if the data is incompressible
+  int Status = deflate(&Stream, Z_FINISH);
+  uint32_t CompressedDataSize = Stream.total_out;
+  deflateEnd(&Stream);
+  if (Status != Z_STREAM_END) {
+    merr<<"Unable to compress block for "<<m_FileName<<show;
+    m_HasError = true;
+    return false;
+  }
+
+  uint32_t BlockSize = g_BGZFHeaderSize + CompressedDataSize + g_BGZFFooterSize;
+
+  // The gzip header with the BC extra subfield
+  Block[0] = 0x1f;
+  Block[1] = 0x8b;
+  Block[2] = 8;    // deflate
+  Block[3] = 4;    // FEXTRA
+  BGZFPutUInt(Block + 4, 0, 4); // MTIME
+  Block[8] = 0;    // XFL
+  Block[9] = 0xff; // OS: unknown
+  BGZFPutUInt(Block + 10, 6, 2); // XLEN
+  Block[12] = 'B';
+  Block[13] = 'C';
+  BGZFPutUInt(Block + 14, 2, 2);
+  BGZFPutUInt(Block + 16, BlockSize - 1, 2);
+
+  // The footer
+  uint32_t CRC = crc32(crc32(0L, Z_NULL, 0), (const Bytef*) m_WriteBuffer.data(), m_WriteBuffer.size());
+  BGZFPutUInt(Block + BlockSize - 8, CRC, 4);
+  BGZFPutUInt(Block + BlockSize - 4, m_WriteBuffer.size(), 4);
+
+  if (fwrite(Block, 1, BlockSize, m_WriteFile) != BlockSize) {
+    merr<<"Unable to write to "<<m_FileName<<show;
+    m_HasError = true;
+    return false;
+  }
+
+  MBlock B;
+  B.m_CompressedOffset = m_CompressedLength;
+  B.m_CompressedSize = BlockSize;
+  B.m_UncompressedOffset = (m_Blocks.size() == 0) ? 0 : m_Blocks.back().m_UncompressedOffset + m_Blocks.back().m_UncompressedSize;
+  B.m_UncompressedSize = m_WriteBuffer.size();
+  m_Blocks.push_back(B);
+
+  m_CompressedLength += BlockSize;
+  m_WriteBuffer.clear();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write the block index file in the format of htslib's bgzip:
+//! The number of entries, followed by (compressed offset, uncompressed offset) of all blocks but the first one
+bool MFileBGZF::WriteIndexFile()
+{
+  ofstream out;
+  out.open(GetIndexFileName(m_FileName).Data(), ios_base::out|ios_base::binary);
+  if (out.is_open() == false) return false;
+
+  unsigned char Buffer[16];
+  uint64_t NEntries = (m_Blocks.size() > 0) ? m_Blocks.size() - 1 : 0;
+  BGZFPutUInt(Buffer, NEntries, 8);
+  out.write((char*) Buffer, 8);
+  for (unsigned int b = 1; b < m_Blocks.size(); ++b) {
+    BGZFPutUInt(Buffer, m_Blocks[b].m_CompressedOffset, 8);
+    BGZFPutUInt(Buffer + 8, m_Blocks[b].m_UncompressedOffset, 8);
+    out.write((char*) Buffer, 16);
+  }
+  out.close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read and check a block header, return the block size and its uncompressed size
+bool MFileBGZF::ReadBlockHeader(uint64_t Offset, uint32_t& CompressedSize, uint32_t& UncompressedSize)
+{
+  unsigned char Header[12];
+  if (Offset + 12 > m_CompressedLength) return false;
+  if (pread(m_FileDescriptor, Header, 12, Offset) != 12) return false;
+  if (Header[0] != 0x1f || Header[1] != 0x8b || Header[2] != 8 || (Header[3] & 4) == 0) return false;
+
+  uint32_t XLength = BGZFGetUInt16(Header + 10);
+  vector<unsigned char> Extra(XLength);
+  if (pread(m_FileDescriptor, Extra.data(), XLength, Offset + 12) != (ssize_t) XLength) return false;
+
+  // Search the BC subfield
+  bool Found = false;
+  uint32_t p = 0;
+  while (p + 4 <= XLength) {
+    uint32_t SubLength = BGZFGetUInt16(Extra.data() + p + 2);
+    if (Extra[p] == 'B' && Extra[p+1] == 'C' && SubLength == 2 && p + 6 <= XLength) {
+      CompressedSize = BGZFGetUInt16(Extra.data() + p + 4) + 1;
+      Found = true;
+      break;
+    }
+    p += 4 + SubLength;
+  }
+  if (Found == false) return false;
+  if (CompressedSize < 12 + XLength + g_BGZFFooterSize || Offset + CompressedSize > m_CompressedLength) return false;
+
+  unsigned char Footer[4];
+  if (pread(m_FileDescriptor, Footer, 4, Offset + CompressedSize - 4) != 4) return false;
+  UncompressedSize = BGZFGetUInt32(Footer);
+  if (UncompressedSize > c_MaximumBlockSize) return false;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read the block index file
+bool MFileBGZF::ReadIndexFile()
+{
+  ifstream in;
+  in.open(GetIndexFileName(m_FileName).Data(), ios_base::in|ios_base::binary);
+  if (in.is_open() == false) return false;
+
+  unsigned char Buffer[16];
+  in.read((char*) Buffer, 8);
+  if (in.gcount() != 8) return false;
+  uint64_t NEntries = 0;
+  for (unsigned int b = 0; b < 8; ++b) NEntries |= (uint64_t) Buffer[b] << (8*b);
+
+  // A block has at least 28 bytes
+  if (NEntries > m_CompressedLength / 28) return false;
+
+  vector<uint64_t> CompressedOffsets(1, 0);
+  vector<uint64_t> UncompressedOffsets(1, 0);
+  for (uint64_t e = 0; e < NEntries; ++e) {
+    in.read((char*) Buffer, 16);
+    if (in.gcount() != 16) return false;
+    uint64_t C = 0;
+    uint64_t U = 0;
+    for (unsigned int b = 0; b < 8; ++b) {
+      C |= (uint64_t) Buffer[b] << (8*b);
+      U |= (uint64_t) Buffer[8+b] << (8*b);
+    }
+    if (C <= CompressedOffsets.back() || C - CompressedOffsets.back() > c_MaximumBlockSize || U < UncompressedOffsets.back()) return false;
+    CompressedOffsets.push_back(C);
+    UncompressedOffsets.push_back(U);
+  }
+
+  m_Blocks.clear();
+  for (unsigned int b = 0; b + 1 < CompressedOffsets.size(); ++b) {
+    MBlock B;
+    B.m_CompressedOffset = CompressedOffsets[b];
+    B.m_CompressedSize = CompressedOffsets[b+1] - CompressedOffsets[b];
+    B.m_UncompressedOffset = UncompressedOffsets[b];
+    B.m_UncompressedSize = UncompressedOffsets[b+1] - UncompressedOffsets[b];
+    m_Blocks.push_back(B);
+  }
+
+  // The remaining blocks (the last data block and the EOF marker) are read from their headers
+  // This also checks that the index belongs to this file
+  uint64_t Offset = CompressedOffsets.back();
+  uint64_t UncompressedOffset = UncompressedOffsets.back();
+  while (Offset < m_CompressedLength) {
+    MBlock B;
+    if (ReadBlockHeader(Offset, B.m_CompressedSize, B.m_UncompressedSize) == false) {
+      m_Blocks.clear();
+      return false;
+    }
+    B.m_CompressedOffset = Offset;
+    B.m_UncompressedOffset = UncompressedOffset;
+    m_Blocks.push_back(B);
+
+    Offset += B.m_CompressedSize;
+    UncompressedOffset += B.m_UncompressedSize;
+
+    // More than the last block and the EOF marker means the index is incomplete
+    if (m_Blocks.size() > CompressedOffsets.size() + 1) {
+      m_Blocks.clear();
+      return false;
+    }
+  }
+
+  // Spot-check the first block
+  uint32_t CompressedSize = 0;
+  uint32_t UncompressedSize = 0;
+  if (ReadBlockHeader(0, CompressedSize, UncompressedSize) == false ||
+      CompressedSize != m_Blocks[0].m_CompressedSize || UncompressedSize != m_Blocks[0].m_UncompressedSize) {
+    m_Blocks.clear();
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Build the block index from the index file, or if that fails from the block headers
+bool MFileBGZF::BuildBlockIndex()
+{
+  m_Blocks.clear();
+
+  if (ReadIndexFile() == true) return true;
+
+  // Walk through the block headers -- each one tells us where the next one starts
+  uint64_t Offset = 0;
+  uint64_t UncompressedOffset = 0;
+  while (Offset < m_CompressedLength) {
+    MBlock B;
+    if (ReadBlockHeader(Offset, B.m_CompressedSize, B.m_UncompressedSize) == false) {
+      if (m_Blocks.size() == 0) return false;
+      mout<<"Warning: "<<m_FileName<<" is truncated or has a corrupt block at position "<<Offset<<" - ignoring the rest of the file"<<endl;
+      break;
+    }
+    B.m_CompressedOffset = Offset;
+    B.m_UncompressedOffset = UncompressedOffset;
+    m_Blocks.push_back(B);
+
+    Offset += B.m_CompressedSize;
+    UncompressedOffset += B.m_UncompressedSize;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Decompress one block -- thread safe, since it only uses pread and the (constant) block index
+bool MFileBGZF::Decompress(uint64_t Block, vector<char>& Data) const
+{
+  const MBlock& B = m_Blocks[Block];
+
+  Data.resize(B.m_UncompressedSize);
+  if (B.m_UncompressedSize == 0) return true;
+
+  vector<unsigned char> Compressed(B.m_CompressedSize);
+  if (pread(m_FileDescriptor, Compressed.data(), B.m_CompressedSize, B.m_CompressedOffset) != (ssize_t) B.m_CompressedSize) {
+    return false;
+  }
+
+  uint32_t HeaderSize = 12 + BGZFGetUInt16(Compressed.data() + 10);
+  if (HeaderSize + g_BGZFFooterSize > B.m_CompressedSize) return false;
+
+  z_stream Stream;
+  memset(&Stream, 0, sizeof(Stream));
+  if (inflateInit2(&Stream, -15) != Z_OK) return false;
+
+  Stream.next_in = Compressed.data() + HeaderSize;
+  Stream.avail_in = B.m_CompressedSize - HeaderSize - g_BGZFFooterSize;
+  Stream.next_out = (Bytef*) Data.data();
+  Stream.avail_out = B.m_UncompressedSize;
+
+  int Status = inflate(&Stream, Z_FINISH);
+  uint32_t Size = Stream.total_out;
+  inflateEnd(&Stream);
+
+  if (Status != Z_STREAM_END || Size != B.m_UncompressedSize) return false;
+
+  uint32_t CRC = crc32(crc32(0L, Z_NULL, 0), (const Bytef*) Data.data(), Size);
+  if (CRC != BGZFGetUInt32(Compressed.data() + B.m_CompressedSize - 8)) return false;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Start the decompression threads
+void MFileBGZF::StartWorkers()
+{
+  m_StopWorkers = false;
+  m_NextReadAheadBlock = 0;
+  for (unsigned int t = 0; t < m_NThreads; ++t) {
+    m_Workers.push_back(thread(&MFileBGZF::WorkerLoop, this));
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Stop the decompression threads
+void MFileBGZF::StopWorkers()
+{
+  {
+    lock_guard<mutex> Lock(m_JobMutex);
+    m_StopWorkers = true;
+    m_Jobs.clear();
+  }
+  m_JobAvailable.notify_all();
+
+  for (auto& W: m_Workers) {
+    W.join();
+  }
+  m_Workers.clear();
+  m_ReadAhead.clear();
+  m_StopWorkers = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main loop of a decompression thread
+void MFileBGZF::WorkerLoop()
+{
+  while (true) {
+    shared_ptr<MDecompressedBlock> Job;
+    {
+      unique_lock<mutex> Lock(m_JobMutex);
+      m_JobAvailable.wait(Lock, [this]() { return m_StopWorkers == true || m_Jobs.empty() == false; });
+      if (m_StopWorkers == true) return;
+      Job = m_Jobs.front();
+      m_Jobs.pop_front();
+    }
+
+    vector<char> Data;
+    bool Success = Decompress(Job->m_Block, Data);
+
+    {
+      lock_guard<mutex> Lock(m_JobMutex);
+      Job->m_Data.swap(Data);
+      Job->m_Failed = !Success;
+      Job->m_Done = true;
+    }
+    m_JobDone.notify_all();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Load the decompressed data of the current block
+bool MFileBGZF::LoadCurrentBlock()
+{
+  if (m_NThreads <= 1) {
+    shared_ptr<MDecompressedBlock> B = make_shared<MDecompressedBlock>();
+    B->m_Block = m_CurrentBlock;
+    B->m_Failed = !Decompress(m_CurrentBlock, B->m_Data);
+    B->m_Done = true;
+    m_Current = B;
+    return !B->m_Failed;
+  }
+
+  // Keep the next blocks in the decompression pipeline
+  unsigned int Window = 2*m_NThreads;
+
+  unique_lock<mutex> Lock(m_JobMutex);
+
+  // After a seek the read-ahead blocks are useless
+  if (m_ReadAhead.empty() == true || m_ReadAhead.front()->m_Block != m_CurrentBlock) {
+    m_Jobs.clear();
+    m_ReadAhead.clear();
+    m_NextReadAheadBlock = m_CurrentBlock;
+  }
+
+  bool NewJobs = false;
+  for (unsigned int Round = 0; Round < 2; ++Round) {
+    while (m_ReadAhead.size() < Window && m_NextReadAheadBlock < m_Blocks.size()) {
+      shared_ptr<MDecompressedBlock> B = make_shared<MDecompressedBlock>();
+      B->m_Block = m_NextReadAheadBlock++;
+      B->m_Done = false;
+      B->m_Failed = false;
+      m_ReadAhead.push_back(B);
+      m_Jobs.push_back(B);
+      NewJobs = true;
+    }
+    // Take the current block out of the pipeline and refill it once more
+    if (Round == 0) {
+      m_Current = m_ReadAhead.front();
+      m_ReadAhead.pop_front();
+    }
+  }
+  if (NewJobs == true) {
+    m_JobAvailable.notify_all();
+  }
+
+  shared_ptr<MDecompressedBlock> Current = m_Current;
+  m_JobDone.wait(Lock, [&Current]() { return Current->m_Done; });
+
+  return !Current->m_Failed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Make sure we have data available at the current position
+bool MFileBGZF::EnsureData()
+{
+  if (m_IsOpen == false || m_IsWriting == true || m_HasError == true) return false;
+
+  while (m_CurrentBlock < m_Blocks.size()) {
+    if (m_Current == nullptr) {
+      if (LoadCurrentBlock() == false) {
+        merr<<"Unable to decompress block "<<m_CurrentBlock<<" of "<<m_FileName<<show;
+        m_Current.reset();
+        m_HasError = true;
+        return false;
+      }
+    }
+    if (m_CurrentPosition < m_Current->m_Data.size()) return true;
+
+    ++m_CurrentBlock;
+    m_Current.reset();
+    m_CurrentPosition = 0;
+  }
+
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read one character
+int MFileBGZF::Getc()
+{
+  if (EnsureData() == false) {
+    m_EOF = true;
+    return -1;
+  }
+
+  return (unsigned char) m_Current->m_Data[m_CurrentPosition++];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read up to Length-1 characters until and including a new line
+char* MFileBGZF::Gets(char* Buffer, int Length)
+{
+  if (Length <= 0) return nullptr;
+
+  int Read = 0;
+  while (Read < Length - 1) {
+    if (EnsureData() == false) {
+      m_EOF = true;
+      break;
+    }
+    const char* Start = m_Current->m_Data.data() + m_CurrentPosition;
+    size_t Available = min(m_Current->m_Data.size() - m_CurrentPosition, (size_t) (Length - 1 - Read));
+    const char* NewLine = (const char*) memchr(Start, '\n', Available);
+    size_t Copy = (NewLine != nullptr) ? (size_t) (NewLine - Start + 1) : Available;
+    memcpy(Buffer + Read, Start, Copy);
+    Read += Copy;
+    m_CurrentPosition += Copy;
+    if (NewLine != nullptr) break;
+  }
+  Buffer[Read] = '\0';
+
+  return (Read == 0) ? nullptr : Buffer;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read up to Length characters
+size_t MFileBGZF::Read(char* Buffer, size_t Length)
+{
+  size_t Read = 0;
+  while (Read < Length) {
+    if (EnsureData() == false) {
+      m_EOF = true;
+      break;
+    }
+    size_t Copy = min(m_Current->m_Data.size() - m_CurrentPosition, Length - Read);
+    memcpy(Buffer + Read, m_Current->m_Data.data() + m_CurrentPosition, Copy);
+    Read += Copy;
+    m_CurrentPosition += Copy;
+  }
+
+  return Read;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the current position as if the file were uncompressed
+uint64_t MFileBGZF::Tell() const
+{
+  if (m_IsWriting == true) {
+    uint64_t Written = (m_Blocks.size() == 0) ? 0 : m_Blocks.back().m_UncompressedOffset + m_Blocks.back().m_UncompressedSize;
+    return Written + m_WriteBuffer.size();
+  }
+
+  if (m_CurrentBlock < m_Blocks.size()) {
+    return m_Blocks[m_CurrentBlock].m_UncompressedOffset + m_CurrentPosition;
+  }
+
+  return GetUncompressedLength();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the current position on disk, i.e. the start of the current block
+uint64_t MFileBGZF::GetCompressedPosition() const
+{
+  if (m_IsWriting == false && m_CurrentBlock < m_Blocks.size()) {
+    return m_Blocks[m_CurrentBlock].m_CompressedOffset;
+  }
+
+  return m_CompressedLength;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the current position as virtual offset
+uint64_t MFileBGZF::GetVirtualOffset() const
+{
+  uint64_t WithinBlock = (m_IsWriting == true) ? m_WriteBuffer.size() : m_CurrentPosition;
+
+  return (GetCompressedPosition() << 16) | WithinBlock;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Seek to a position as if the file were uncompressed
+bool MFileBGZF::Seek(uint64_t UncompressedPosition)
+{
+  if (m_IsOpen == false || m_IsWriting == true) return false;
+
+  m_EOF = false;
+
+  if (UncompressedPosition >= GetUncompressedLength()) {
+    m_CurrentBlock = m_Blocks.size();
+    m_Current.reset();
+    m_CurrentPosition = 0;
+    return UncompressedPosition == GetUncompressedLength();
+  }
+
+  // The last block starting at or before the position
+  auto Iter = upper_bound(m_Blocks.begin(), m_Blocks.end(), UncompressedPosition,
+                          [](uint64_t Position, const MBlock& B) { return Position < B.m_UncompressedOffset; });
+  uint64_t Block = (Iter - m_Blocks.begin()) - 1;
+
+  if (Block != m_CurrentBlock) {
+    m_CurrentBlock = Block;
+    m_Current.reset();
+  }
+  m_CurrentPosition = UncompressedPosition - m_Blocks[Block].m_UncompressedOffset;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Seek to a virtual offset
+bool MFileBGZF::SeekVirtualOffset(uint64_t VirtualOffset)
+{
+  if (m_IsOpen == false || m_IsWriting == true) return false;
+
+  m_EOF = false;
+
+  uint64_t CompressedOffset = VirtualOffset >> 16;
+  uint32_t WithinBlock = VirtualOffset & 0xffff;
+
+  if (CompressedOffset >= m_CompressedLength) {
+    m_CurrentBlock = m_Blocks.size();
+    m_Current.reset();
+    m_CurrentPosition = 0;
+    return true;
+  }
+
+  auto Iter = lower_bound(m_Blocks.begin(), m_Blocks.end(), CompressedOffset,
+                          [](const MBlock& B, uint64_t Offset) { return B.m_CompressedOffset < Offset; });
+  if (Iter == m_Blocks.end() || Iter->m_CompressedOffset != CompressedOffset || WithinBlock > Iter->m_UncompressedSize) {
+    merr<<"Invalid virtual offset "<<VirtualOffset<<" for "<<m_FileName<<show;
+    return false;
+  }
+
+  uint64_t Block = Iter - m_Blocks.begin();
+  if (Block != m_CurrentBlock) {
+    m_CurrentBlock = Block;
+    m_Current.reset();
+  }
+  m_CurrentPosition = WithinBlock;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the uncompressed length of the file
+uint64_t MFileBGZF::GetUncompressedLength() const
+{
+  if (m_IsWriting == true) return Tell();
+
+  if (m_Blocks.size() == 0) return 0;
+
+  return m_Blocks.back().m_UncompressedOffset + m_Blocks.back().m_UncompressedSize;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the length of the file on disk
+uint64_t MFileBGZF::GetCompressedLength() const
+{
+  return m_CompressedLength;
+}
+
+
+// MFileBGZF.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,676 @@
+/*
+ * MFileEventCache.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// Include the header:
+#include "MFileEventCache.h"
+
+// Standard libs:
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <zlib.h>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MStreams.h"
+#include "MFile.h"
+#include "MFileBGZF.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MFileEventCache)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+const uint64_t MFileEventCache::c_DefaultMaximumSize = uint64_t(4) << 30;
+const MString MFileEventCache::c_DataExtension = ".data";
+const MString MFileEventCache::c_DescriptionExtension = ".ecache";
+const MString MFileEventCache::c_TemporaryExtension = ".tmp";
+
+mutex MFileEventCache::s_Mutex;
+bool MFileEventCache::s_Enabled = false;
+MString MFileEventCache::s_Directory = "";
+uint64_t MFileEventCache::s_MaximumSize = MFileEventCache::c_DefaultMaximumSize;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! FNV-1a hash, continuing from Hash
+static uint64_t MFileEventCacheHash(const char* Data, size_t Length, uint64_t Hash = 14695981039346656037ULL)
+{
+  for (size_t i = 0; i < Length; ++i) {
+    Hash ^= (unsigned char) Data[i];
+    Hash *= 1099511628211ULL;
+  }
+  return Hash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Enable the cache in the given directory (empty: default directory) with the given maximum size in bytes
+bool MFileEventCache::Enable(const MString& Directory, uint64_t MaximumSize)
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  MString CacheDirectory = Directory;
+  if (CacheDirectory.IsEmpty() == true) {
+    CacheDirectory = GetDefaultDirectory();
+  }
+  MFile::ExpandFileName(CacheDirectory);
+
+  if (MFile::CreateDirectory(CacheDirectory) == false) {
+    merr<<"Unable to create the event cache directory "<<CacheDirectory<<" - the event cache is disabled"<<show;
+    s_Enabled = false;
+    return false;
+  }
+
+  s_Directory = CacheDirectory;
+  s_MaximumSize = MaximumSize;
+  s_Enabled = true;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Disable the cache -- existing entries are kept
+void MFileEventCache::Disable()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  s_Enabled = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return true if the cache is enabled
+bool MFileEventCache::IsEnabled()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  return s_Enabled;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Enable the cache if the environment variable MEGALIB_EVENTCACHE is set
+void MFileEventCache::EnableFromEnvironment()
+{
+  const char* Directory = getenv("MEGALIB_EVENTCACHE");
+  if (Directory == nullptr || Directory[0] == '\0') return;
+
+  MString CacheDirectory = Directory;
+  if (CacheDirectory == "default" || CacheDirectory == "1") {
+    CacheDirectory = "";
+  }
+
+  uint64_t MaximumSize = c_DefaultMaximumSize;
+  const char* Size = getenv("MEGALIB_EVENTCACHE_SIZE");
+  if (Size != nullptr) {
+    char* End = nullptr;
+    unsigned long long MB = strtoull(Size, &End, 10);
+    if (End != Size && MB > 0) {
+      MaximumSize = uint64_t(MB) << 20;
+    } else {
+      mout<<"Info: Cannot interpret MEGALIB_EVENTCACHE_SIZE=\""<<Size<<"\" as size in MB - using the default"<<endl;
+    }
+  }
+
+  Enable(CacheDirectory, MaximumSize);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the cache directory
+MString MFileEventCache::GetDirectory()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  return s_Directory;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the maximum size of the cache in bytes
+uint64_t MFileEventCache::GetMaximumSize()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  return s_MaximumSize;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The default directory: a user specific directory in /dev/shm, or if that does not exist in the temporary directory
+MString MFileEventCache::GetDefaultDirectory()
+{
+  error_code Error;
+  MString Base;
+  if (filesystem::is_directory("/dev/shm", Error) == true) {
+    Base = "/dev/shm";
+  } else {
+    Base = filesystem::temp_directory_path(Error).string();
+    if (Error) Base = "/tmp";
+  }
+
+  return Base + "/MEGAlib_EventCache_" + MString((unsigned long) getuid());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the total size of all cached files in bytes
+uint64_t MFileEventCache::GetSize()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  uint64_t Size = 0;
+  error_code Error;
+  for (auto& E: filesystem::directory_iterator(s_Directory.Data(), Error)) {
+    if (E.path().extension().string() != c_DataExtension.Data()) continue;
+    filesystem::path Description = E.path();
+    Description.replace_extension(c_DescriptionExtension.Data());
+    if (filesystem::exists(Description, Error) == false) continue;
+    Size += E.file_size(Error);
+  }
+
+  return Size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the number of cached files
+unsigned int MFileEventCache::GetNEntries()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  // Entries which only record that a file is too large for the cache have no data file
+  unsigned int N = 0;
+  error_code Error;
+  for (auto& E: filesystem::directory_iterator(s_Directory.Data(), Error)) {
+    if (E.path().extension().string() != c_DescriptionExtension.Data()) continue;
+    filesystem::path Data = E.path();
+    Data.replace_extension(c_DataExtension.Data());
+    if (filesystem::exists(Data, Error) == true) ++N;
+  }
+
+  return N;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Remove all entries from the cache
+void MFileEventCache::Clear()
+{
+  lock_guard<mutex> Lock(s_Mutex);
+
+  if (s_Directory.IsEmpty() == true) return;
+
+  error_code Error;
+  vector<filesystem::path> Files;
+  for (auto& E: filesystem::directory_iterator(s_Directory.Data(), Error)) {
+    string Extension = E.path().extension().string();
+    if (Extension == c_DataExtension.Data() || Extension == c_DescriptionExtension.Data()) {
+      Files.push_back(E.path());
+    }
+  }
+  for (auto& F: Files) {
+    filesystem::remove(F, Error);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Determine size, modification time and a hash of the first and last part of the file
+bool MFileEventCache::GetFingerprint(const MString& FileName, uint64_t& Size, int64_t& ModificationTime, uint64_t& Hash)
+{
+  error_code Error;
+  Size = filesystem::file_size(FileName.Data(), Error);
+  if (Error) return false;
+  ModificationTime = filesystem::last_write_time(FileName.Data(), Error).time_since_epoch().count();
+  if (Error) return false;
+
+  ifstream in(FileName.Data(), ios_base::in | ios_base::binary);
+  if (in.is_open() == false) return false;
+
+  uint64_t NHashed = min(Size, (uint64_t) c_HashedBytes);
+  vector<char> Buffer(NHashed);
+  in.read(Buffer.data(), NHashed);
+  if (in.gcount() != (streamsize) NHashed) return false;
+  Hash = MFileEventCacheHash(Buffer.data(), NHashed);
+
+  in.seekg(Size - NHashed);
+  in.read(Buffer.data(), NHashed);
+  if (in.gcount() != (streamsize) NHashed) return false;
+  Hash = MFileEventCacheHash(Buffer.data(), NHashed, Hash);
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the base name of the entry belonging to a file (without directory and extension)
+MString MFileEventCache::GetEntryName(const MString& FileName)
+{
+  error_code Error;
+  string Path = filesystem::absolute(FileName.Data(), Error).lexically_normal().string();
+  if (Error) Path = FileName.Data();
+
+  char Name[17];
+  snprintf(Name, sizeof(Name), "%016llx", (unsigned long long) MFileEventCacheHash(Path.c_str(), Path.size()));
+
+  return Name;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check if the entry is valid for the file with the given fingerprint
+bool MFileEventCache::IsValid(const MString& DescriptionFileName, const MString& DataFileName, const MString& FileName, uint64_t Size, int64_t ModificationTime, uint64_t Hash, uint64_t& TooLargeSize)
+{
+  TooLargeSize = 0;
+
+  ifstream in(DescriptionFileName.Data());
+  if (in.is_open() == false) return false;
+
+  MString Name;
+  uint64_t EntrySize = 0, EntryHash = 0, UncompressedSize = 0, EntryTooLargeSize = 0;
+  int64_t EntryModificationTime = 0;
+  bool FoundType = false, FoundEnd = false;
+  string Line;
+  while (getline(in, Line)) {
+    if (Line.size() < 2) continue;
+    string Key = Line.substr(0, 2);
+    string Value = (Line.size() > 3) ? Line.substr(3) : "";
+    if (Key == "TY") {
+      FoundType = (Value == "ecache");
+    } else if (Key == "FN") {
+      Name = Value;
+    } else if (Key == "FS") {
+      EntrySize = strtoull(Value.c_str(), nullptr, 10);
+    } else if (Key == "MT") {
+      EntryModificationTime = strtoll(Value.c_str(), nullptr, 10);
+    } else if (Key == "HA") {
+      EntryHash = strtoull(Value.c_str(), nullptr, 16);
+    } else if (Key == "US") {
+      UncompressedSize = strtoull(Value.c_str(), nullptr, 10);
+    } else if (Key == "TL") {
+      EntryTooLargeSize = strtoull(Value.c_str(), nullptr, 10);
+    } else if (Key == "EN") {
+      FoundEnd = true;
+      break;
+    }
+  }
+
+  if (FoundType == false || FoundEnd == false) return false;
+  if (Name != FileName || EntrySize != Size || EntryModificationTime != ModificationTime || EntryHash != Hash) return false;
+
+  if (EntryTooLargeSize > 0) {
+    TooLargeSize = EntryTooLargeSize;
+    return true;
+  }
+
+  error_code Error;
+  if (filesystem::file_size(DataFileName.Data(), Error) != UncompressedSize || Error) return false;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write the description of an entry -- if TooLarge is true, the entry only records that the file does not fit into the cache
+bool MFileEventCache::WriteDescription(const MString& DescriptionFileName, const MString& EntryName, const MString& FileName, uint64_t Size, int64_t ModificationTime, uint64_t Hash, uint64_t UncompressedSize, bool TooLarge)
+{
+  // Write a temporary file and move it in place afterwards, thus other processes never see an incomplete description
+  MString TemporaryDescription = MFile::CreateTemporaryFile(EntryName + c_DescriptionExtension + c_TemporaryExtension, 10, s_Directory);
+  if (TemporaryDescription.IsEmpty() == true) return false;
+
+  ofstream out(TemporaryDescription.Data());
+  out<<"TY ecache"<<endl;
+  out<<"VE 1"<<endl;
+  out<<"FN "<<FileName<<endl;
+  out<<"FS "<<Size<<endl;
+  out<<"MT "<<ModificationTime<<endl;
+  char HashString[17];
+  snprintf(HashString, sizeof(HashString), "%016llx", (unsigned long long) Hash);
+  out<<"HA "<<HashString<<endl;
+  if (TooLarge == true) {
+    out<<"TL "<<UncompressedSize<<endl;
+  } else {
+    out<<"US "<<UncompressedSize<<endl;
+  }
+  out<<"EN"<<endl;
+  out.close();
+
+  error_code Error;
+  if (out.fail() == true) {
+    filesystem::remove(TemporaryDescription.Data(), Error);
+    return false;
+  }
+  filesystem::rename(TemporaryDescription.Data(), DescriptionFileName.Data(), Error);
+  if (Error) {
+    filesystem::remove(TemporaryDescription.Data(), Error);
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Determine the uncompressed size without decompressing: exact for blocked gzip files (block index),
+//! a lower limit for gzip files (size field modulo 4 GB of the last member)
+bool MFileEventCache::GetUncompressedSize(const MString& FileName, uint64_t& UncompressedSize)
+{
+  UncompressedSize = 0;
+
+  if (MFileBGZF::IsBGZF(FileName) == true) {
+    // The block index is read from the index file, or built from the block headers without decompressing
+    MFileBGZF In;
+    if (In.OpenForReading(FileName, 1) == false) return false;
+    UncompressedSize = In.GetUncompressedLength();
+    In.Close();
+    return true;
+  }
+
+  // The last four bytes of a gzip file are the uncompressed size of its last member modulo 2^32 (little endian)
+  ifstream in(FileName.Data(), ios_base::in | ios_base::binary);
+  if (in.is_open() == false) return false;
+  in.seekg(-4, ios_base::end);
+  unsigned char Bytes[4];
+  in.read(reinterpret_cast<char*>(Bytes), 4);
+  if (in.gcount() != 4) return false;
+  UncompressedSize = uint64_t(Bytes[0]) | (uint64_t(Bytes[1]) << 8) | (uint64_t(Bytes[2]) << 16) | (uint64_t(Bytes[3]) << 24);
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Decompress the file into DataFileName, fails if more than MaximumSize bytes would be written
+bool MFileEventCache::Decompress(const MString& FileName, const MString& DataFileName, uint64_t MaximumSize, uint64_t& UncompressedSize)
+{
+  UncompressedSize = 0;
+
+  ofstream out(DataFileName.Data(), ios_base::out | ios_base::binary | ios_base::trunc);
+  if (out.is_open() == false) return false;
+
+  const size_t BufferSize = 1 << 22;
+  vector<char> Buffer(BufferSize);
+
+  bool Success = true;
+  if (MFileBGZF::IsBGZF(FileName) == true) {
+    // Blocked gzip files are decompressed in parallel
+    MFileBGZF In;
+    if (In.OpenForReading(FileName) == false) return false;
+    while (true) {
+      size_t Length = In.Read(Buffer.data(), BufferSize);
+      if (In.HasError() == true) {
+        Success = false;
+        break;
+      }
+      if (Length == 0) break;
+      UncompressedSize += Length;
+      if (UncompressedSize > MaximumSize) {
+        Success = false;
+        break;
+      }
+      out.write(Buffer.data(), Length);
+      if (out.good() == false) {
+        Success = false;
+        break;
+      }
+    }
+    In.Close();
+  } else {
+    gzFile In = gzopen(FileName.Data(), "rb");
+    if (In == NULL) return false;
+    gzbuffer(In, 1 << 18);
+    while (true) {
+      int Length = gzread(In, Buffer.data(), (unsigned int) BufferSize);
+      if (Length < 0) {
+        Success = false;
+        break;
+      }
+      if (Length == 0) break;
+      UncompressedSize += Length;
+      if (UncompressedSize > MaximumSize) {
+        Success = false;
+        break;
+      }
+      out.write(Buffer.data(), Length);
+      if (out.good() == false) {
+        Success = false;
+        break;
+      }
+    }
+    gzclose(In);
+  }
+
+  out.close();
+  if (out.fail() == true) Success = false;
+
+  return Success;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Remove least recently used entries until Required additional bytes fit into the cache -- Keep is never removed
+bool MFileEventCache::MakeRoom(uint64_t Required, const MString& Keep)
+{
+  if (Required > s_MaximumSize) return false;
+
+  struct Entry {
+    filesystem::file_time_type m_LastUse;
+    uint64_t m_Size;
+    filesystem::path m_Description;
+  };
+
+  error_code Error;
+  vector<Entry> Entries;
+  vector<filesystem::path> StaleFiles;
+  uint64_t Total = 0;
+  auto StaleTime = filesystem::file_time_type::clock::now() - chrono::seconds(c_StaleTemporaryAge);
+  for (auto& E: filesystem::directory_iterator(s_Directory.Data(), Error)) {
+    // Files which are currently decompressed, by this or other processes, will soon be entries
+    if (E.path().extension().string() == c_TemporaryExtension.Data()) {
+      if (E.path().stem().extension().string() != c_DataExtension.Data()) continue;
+      if (filesystem::last_write_time(E.path(), Error) < StaleTime && !Error) {
+        StaleFiles.push_back(E.path());
+        continue;
+      }
+      uint64_t Size = filesystem::file_size(E.path(), Error);
+      if (!Error) Total += Size;
+      continue;
+    }
+    if (E.path().extension().string() != c_DescriptionExtension.Data()) continue;
+    filesystem::path Data = E.path();
+    Data.replace_extension(c_DataExtension.Data());
+    Entry New;
+    New.m_LastUse = filesystem::last_write_time(E.path(), Error);
+    New.m_Size = filesystem::file_size(Data, Error);
+    if (Error) New.m_Size = 0;
+    New.m_Description = E.path();
+    Total += New.m_Size;
+    if (E.path().stem().string() == Keep.Data()) continue;
+    Entries.push_back(New);
+  }
+
+  // Left over from crashed processes
+  for (auto& F: StaleFiles) {
+    filesystem::remove(F, Error);
+  }
+
+  // The description file is touched at each use, thus the oldest one is the least recently used entry
+  sort(Entries.begin(), Entries.end(), [](const Entry& A, const Entry& B) { return A.m_LastUse < B.m_LastUse; });
+
+  for (auto& E: Entries) {
+    if (Total + Required <= s_MaximumSize) break;
+    filesystem::path Data = E.m_Description;
+    Data.replace_extension(c_DataExtension.Data());
+    // Readers in other processes which have the file already open can continue reading
+    filesystem::remove(E.m_Description, Error);
+    filesystem::remove(Data, Error);
+    Total -= E.m_Size;
+  }
+
+  return Total + Required <= s_MaximumSize;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the name of the decompressed copy of the compressed file, and create it if it does not exist yet
+MString MFileEventCache::Attach(const MString& FileName)
+{
+  unique_lock<mutex> Lock(s_Mutex);
+
+  if (s_Enabled == false) return "";
+
+  MString Name = FileName;
+  MFile::ExpandFileName(Name);
+
+  uint64_t Size = 0;
+  int64_t ModificationTime = 0;
+  uint64_t Hash = 0;
+  if (GetFingerprint(Name, Size, ModificationTime, Hash) == false) return "";
+
+  MString Directory = s_Directory;
+  MString EntryName = GetEntryName(Name);
+  MString DataFileName = Directory + "/" + EntryName + c_DataExtension;
+  MString DescriptionFileName = Directory + "/" + EntryName + c_DescriptionExtension;
+
+  error_code Error;
+  uint64_t TooLargeSize = 0;
+  if (IsValid(DescriptionFileName, DataFileName, Name, Size, ModificationTime, Hash, TooLargeSize) == true) {
+    if (TooLargeSize == 0) {
+      // Mark as recently used
+      filesystem::last_write_time(DescriptionFileName.Data(), filesystem::file_time_type::clock::now(), Error);
+      return DataFileName;
+    }
+    // Known to be too large, unless the cache has been enlarged since
+    if (TooLargeSize > s_MaximumSize) return "";
+  }
+
+  // An outdated entry of this file is replaced
+  filesystem::remove(DescriptionFileName.Data(), Error);
+  filesystem::remove(DataFileName.Data(), Error);
+
+  // Do not start decompressing files which are known to be too large
+  uint64_t ExpectedSize = 0;
+  if (GetUncompressedSize(Name, ExpectedSize) == false) return "";
+  if (ExpectedSize > s_MaximumSize) {
+    WriteDescription(DescriptionFileName, EntryName, Name, Size, ModificationTime, Hash, ExpectedSize, true);
+    return "";
+  }
+  if (MakeRoom(ExpectedSize, EntryName) == false) return "";
+
+  // Decompress into a temporary file in the cache directory and move it in place afterwards,
+  // thus other processes never see an incomplete entry
+  MString Temporary = MFile::CreateTemporaryFile(EntryName + c_DataExtension + c_TemporaryExtension, 10, Directory);
+  if (Temporary.IsEmpty() == true) return "";
+
+  // Decompressing takes a while, meanwhile the other threads can use the cache
+  uint64_t MaximumSize = s_MaximumSize;
+  uint64_t UncompressedSize = 0;
+  Lock.unlock();
+  bool Decompressed = Decompress(Name, Temporary, MaximumSize, UncompressedSize);
+  Lock.lock();
+
+  if (Decompressed == false) {
+    filesystem::remove(Temporary.Data(), Error);
+    if (UncompressedSize > MaximumSize && s_Directory == Directory) {
+      // E.g. a gzip file larger than 4 GB: record it, thus it is not decompressed again
+      WriteDescription(DescriptionFileName, EntryName, Name, Size, ModificationTime, Hash, UncompressedSize, true);
+    }
+    return "";
+  }
+
+  // The cache might have been disabled or moved in the mean time
+  // Otherwise the decompressed file now counts against the maximum size
+  if (s_Enabled == false || s_Directory != Directory || MakeRoom(0, EntryName) == false) {
+    filesystem::remove(Temporary.Data(), Error);
+    return "";
+  }
+
+  filesystem::rename(Temporary.Data(), DataFileName.Data(), Error);
+  if (Error) {
+    filesystem::remove(Temporary.Data(), Error);
+    return "";
+  }
+
+  if (WriteDescription(DescriptionFileName, EntryName, Name, Size, ModificationTime, Hash, UncompressedSize, false) == false) {
+    filesystem::remove(DataFileName.Data(), Error);
+    return "";
+  }
+
+  return DataFileName;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// MFileEventCache.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -81,6 +81,16 @@ MFileEvents::MFileEvents() : MFile()
 
   m_NIncludeFiles = 0;
   m_NOpenedIncludeFiles = 0;
+
+  // Event files are written as blocked gzip: decompressed in parallel and seekable via the time index
+  SetBlockedCompression(true);
+  // Compressed event files are read via the event cache, if it is enabled
+  SetEventCache(true);
+
+  m_WriteTimeIndex = true;
+  m_HasTimeSelection = false;
+  m_UseTimeIndex = false;
+  m_TimeIndexBlock = -1;
 }
 
 
@@ -91,6 +101,9 @@ MFileEvents::~MFileEvents()
 {
   // Delete this instance of MFileEvents
 
+  // The base class destructor cannot call our Close() anymore
+  Close();
+
   delete m_IncludeFile;
 }
 
@@ -98,6 +111,40 @@ MFileEvents::~MFileEvents()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MFileEvents::Close()
+{
+  // Close the file and save the time index in write mode
+
+  bool SaveIndex = (m_IsOpen == true && m_Way != c_Read && m_WriteTimeIndex == true && m_TimeIndex.GetNBlocks() > 0);
+  MString FileName = m_FileName;
+
+  bool Return = MFile::Close();
+
+  if (SaveIndex == true) {
+    // The seek points were created by the background writer, thus their offsets are only known now
+    vector<pair<streampos, streampos>> SeekPoints = GetSeekPoints();
+    if (SeekPoints.size() == m_TimeIndexSeekPointBlocks.size()) {
+      for (unsigned int s = 0; s < SeekPoints.size(); ++s) {
+        m_TimeIndex.SetSeekPoint(m_TimeIndexSeekPointBlocks[s], SeekPoints[s].first, SeekPoints[s].second);
+      }
+      m_TimeIndex.Save(MFileTimeIndex::GetIndexFileName(FileName), FileName);
+    } else {
+      mout<<"Unable to create all seek points in "<<FileName<<" - no time index will be written"<<endl;
+    }
+  }
+  m_TimeIndex.Reset();
+  m_TimeIndexSeekPointBlocks.clear();
+  m_UseTimeIndex = false;
+  m_TimeIndexSelected.clear();
+  m_TimeIndexBlock = -1;
+
+  return Return;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MFileEvents::Open(MString FileName, unsigned int Way, bool IsBinary)
 {
   // Open the file and read some basic data common to all MEGAlib event files
@@ -227,6 +274,158 @@ bool MFileEvents::Open(MString FileName, unsigned int Way, bool IsBinary)
   // Now rewind - don't use the local one, since it reopens the file...
   MFile::Rewind();
 
+  m_TimeIndex.Reset();
+  m_TimeIndexSeekPointBlocks.clear();
+  m_UseTimeIndex = false;
+  m_TimeIndexSelected.clear();
+  m_TimeIndexBlock = -1;
+  if (Way == c_Read && m_HasTimeSelection == true) {
+    LoadTimeIndex();
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFileEvents::SetTimeSelection(const MGTI& TimeSelection)
+{
+  // Set a time selection used to skip blocks of events via the time index
+
+  m_TimeSelection = TimeSelection;
+  m_HasTimeSelection = true;
+
+  if (m_IsOpen == true && m_Way == c_Read) {
+    LoadTimeIndex();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFileEvents::ClearTimeSelection()
+{
+  // Remove the time selection - all blocks are read again
+
+  m_HasTimeSelection = false;
+  m_UseTimeIndex = false;
+  m_TimeIndexSelected.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFileEvents::LoadTimeIndex()
+{
+  // Load the time index of the current file and determine which blocks to read
+
+  m_UseTimeIndex = false;
+  m_TimeIndexSelected.clear();
+  m_TimeIndexBlock = -1;
+
+  if (m_HasTimeSelection == false || m_IsBinary == true) return false;
+
+  if (m_TimeIndex.Load(MFileTimeIndex::GetIndexFileName(m_FileName), m_FileName) == false) {
+    return false;
+  }
+
+  m_TimeIndexSelected = m_TimeIndex.SelectBlocks(m_TimeSelection);
+  m_UseTimeIndex = true;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFileEvents::AddToTimeIndex(const MTime& Time)
+{
+  // Add an event to the time index - a new block starts at a fresh seek point
+  // The seek point is only requested here, thus the background writer keeps compressing while we continue
+
+  if (m_WriteTimeIndex == false || m_IsBinary == true) return;
+
+  if (m_TimeIndex.IsBlockFull() == true) {
+    if (RequestSeekPoint() == false) {
+      mout<<"Unable to create a seek point in "<<m_FileName<<" - no time index will be written"<<endl;
+      m_WriteTimeIndex = false;
+      m_TimeIndex.Reset();
+      m_TimeIndexSeekPointBlocks.clear();
+      return;
+    }
+    m_TimeIndexSeekPointBlocks.push_back(m_TimeIndex.GetNBlocks());
+    m_TimeIndex.StartBlock(0, 0);
+  }
+  m_TimeIndex.AddEvent(Time);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFileEvents::CloseTimeIndex()
+{
+  // Add a seek point to the footer, thus a reader skipping the last blocks still finds the footer
+
+  if (m_WriteTimeIndex == false || m_IsBinary == true || m_TimeIndex.GetNBlocks() == 0) return;
+
+  if (RequestSeekPoint() == true) {
+    m_TimeIndexSeekPointBlocks.push_back(m_TimeIndex.GetNBlocks());
+    m_TimeIndex.StartBlock(0, 0);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MFileEvents::SkipUnselectedTimeBlocks(bool& NoMoreBlocks)
+{
+  // If the current time index block is not selected, jump to the next selected one
+
+  NoMoreBlocks = false;
+
+  if (m_UseTimeIndex == false || m_TimeIndex.GetNBlocks() == 0) return false;
+
+  // Determine the current block from the position - the position only moves forward while reading,
+  // but start over in case somebody seeked backwards
+  streampos Position = GetUncompressedFilePosition();
+  if (m_TimeIndexBlock >= 0 && Position < m_TimeIndex.GetBlock(m_TimeIndexBlock).m_UncompressedOffset) {
+    m_TimeIndexBlock = -1;
+  }
+  while (m_TimeIndexBlock + 1 < (int) m_TimeIndex.GetNBlocks() && m_TimeIndex.GetBlock(m_TimeIndexBlock + 1).m_UncompressedOffset <= Position) {
+    ++m_TimeIndexBlock;
+  }
+
+  // In the header or in a selected block, continue reading
+  if (m_TimeIndexBlock < 0) {
+    if (m_TimeIndexSelected[0] == true) return false;
+  } else if (m_TimeIndexSelected[m_TimeIndexBlock] == true) {
+    return false;
+  }
+
+  // Find the next selected block
+  unsigned int Next = m_TimeIndexBlock + 1;
+  while (Next < m_TimeIndexSelected.size() && m_TimeIndexSelected[Next] == false) ++Next;
+
+  if (Next >= m_TimeIndexSelected.size()) {
+    NoMoreBlocks = true;
+    return false;
+  }
+
+  const MFileTimeIndexBlock& Block = m_TimeIndex.GetBlock(Next);
+  if (JumpToSeekPoint(Block.m_UncompressedOffset, Block.m_CompressedOffset) == false) {
+    // Fall back to reading everything
+    m_UseTimeIndex = false;
+    return false;
+  }
+  m_TimeIndexBlock = Next;
+
   return true;
 }
 
@@ -451,6 +650,8 @@ bool MFileEvents::CloseEventList()
     return false;
   }
 
+  CloseTimeIndex();
+
   ostringstream ToWrite;
   ToWrite<<"EN"<<endl;
   ToWrite<<endl;
@@ -610,6 +811,12 @@ bool MFileEvents::CreateIncludeFile()
     // And rename it:
     IncludeFileName = CreateIncludeFileName(m_FileName);
     gSystem->Rename(m_FileName, IncludeFileName);
+    if (MFile::Exists(MFileTimeIndex::GetIndexFileName(m_FileName)) == true) {
+      gSystem->Rename(MFileTimeIndex::GetIndexFileName(m_FileName), MFileTimeIndex::GetIndexFileName(IncludeFileName));
+    }
+    if (MFile::Exists(MFileBGZF::GetIndexFileName(m_FileName)) == true) {
+      gSystem->Rename(MFileBGZF::GetIndexFileName(m_FileName), MFileBGZF::GetIndexFileName(IncludeFileName));
+    }
 
     // Reopen it as new and write the header:
     if (MFile::Open(m_FileName, c_Write) == false) {
@@ -638,6 +845,7 @@ bool MFileEvents::CreateIncludeFile()
   cout<<"Changing to new include file "<<MFile::RelativeFileName(NewFileName, m_FileName)<<endl;
 
   // Open new file
+  m_IncludeFile->SetWriteTimeIndex(m_WriteTimeIndex);
   if (m_IncludeFile->Open(NewFileName, c_Write) == false) {
     return false;
   }
@@ -700,6 +908,11 @@ bool MFileEvents::OpenIncludeFile(const MString& Line)
   CloseIncludeFile(); // Updates also observation time
   m_IncludeFileUsed = true;
 
+  if (m_HasTimeSelection == true) {
+    m_IncludeFile->SetTimeSelection(m_TimeSelection);
+  } else {
+    m_IncludeFile->ClearTimeSelection();
+  }
   if (m_IncludeFile->Open(FileName) == false) {
     m_IncludeFileUsed = false;
     return false;
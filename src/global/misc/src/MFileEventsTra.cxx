@@ -350,6 +350,11 @@ MPhysicalEvent* MFileEventsTra::ReadNextEvent()
     }
   }
 
+  // Jump over blocks of events outside the time selection
+  bool NoMoreBlocks = false;
+  SkipUnselectedTimeBlocks(NoMoreBlocks);
+  if (NoMoreBlocks == true) return nullptr;
+
   m_EventType = MPhysicalEvent::c_Unknown;
 
   // Read until we reach a CO or PA or <to be continued>
@@ -496,6 +501,7 @@ bool MFileEventsTra::AddEvent(MPhysicalEvent* Tra)
       return CreateIncludeFile();
     }
   } else {
+    AddToTimeIndex(Tra->GetTime());
     ostringstream out;
     out<<"SE"<<endl;
     Write(out);
@@ -0,0 +1,251 @@
+/*
+ * MFileMapped.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MFileMapped
+//
+// Read-only access to a memory mapped file.
+//
+// The end-of-file flag behaves as the one of gzip and BGZF files: it is only
+// set once a read goes beyond the end of the file, thus MFile returns the same
+// lines from the mapped file as from the compressed one.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MFileMapped.h"
+
+// Standard libs:
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MStreams.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MFileMapped)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default constructor
+MFileMapped::MFileMapped()
+{
+  m_IsOpen = false;
+  m_Data = nullptr;
+  m_Length = 0;
+  m_Position = 0;
+  m_EOF = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default destructor
+MFileMapped::~MFileMapped()
+{
+  Close();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Map the file
+bool MFileMapped::Open(const MString& FileName)
+{
+  Close();
+
+  int FileDescriptor = open(FileName.Data(), O_RDONLY);
+  if (FileDescriptor < 0) return false;
+
+  struct stat Status;
+  if (fstat(FileDescriptor, &Status) != 0) {
+    close(FileDescriptor);
+    return false;
+  }
+
+  m_Length = Status.st_size;
+  if (m_Length > 0) {
+    void* Data = mmap(nullptr, m_Length, PROT_READ, MAP_SHARED, FileDescriptor, 0);
+    if (Data == MAP_FAILED) {
+      close(FileDescriptor);
+      m_Length = 0;
+      return false;
+    }
+    madvise(Data, m_Length, MADV_SEQUENTIAL);
+    m_Data = static_cast<const char*>(Data);
+  }
+  // The mapping stays valid without the descriptor
+  close(FileDescriptor);
+
+  m_Position = 0;
+  m_EOF = false;
+  m_IsOpen = true;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Unmap the file
+bool MFileMapped::Close()
+{
+  if (m_Data != nullptr) {
+    munmap(const_cast<char*>(m_Data), m_Length);
+    m_Data = nullptr;
+  }
+  m_IsOpen = false;
+  m_Length = 0;
+  m_Position = 0;
+  m_EOF = false;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the next character or -1 at the end of the file
+int MFileMapped::Getc()
+{
+  if (m_Position >= m_Length) {
+    m_EOF = true;
+    return -1;
+  }
+
+  return static_cast<unsigned char>(m_Data[m_Position++]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read up to Length-1 characters until and including the next new line, as gzgets
+char* MFileMapped::Gets(char* Buffer, int Length)
+{
+  if (Buffer == nullptr || Length < 1) return nullptr;
+
+  if (m_Position >= m_Length) {
+    m_EOF = true;
+    Buffer[0] = '\0';
+    return nullptr;
+  }
+
+  uint64_t Size = min(static_cast<uint64_t>(Length - 1), m_Length - m_Position);
+  const char* NewLine = static_cast<const char*>(memchr(m_Data + m_Position, '\n', Size));
+  if (NewLine != nullptr) {
+    Size = NewLine - (m_Data + m_Position) + 1;
+  } else if (m_Position + Size == m_Length) {
+    m_EOF = true;
+  }
+
+  memcpy(Buffer, m_Data + m_Position, Size);
+  Buffer[Size] = '\0';
+  m_Position += Size;
+
+  return Buffer;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read up to Length bytes and return how many have been read
+uint64_t MFileMapped::Read(char* Buffer, uint64_t Length)
+{
+  uint64_t Available = (m_Position < m_Length) ? m_Length - m_Position : 0;
+  if (Length > Available) {
+    Length = Available;
+    m_EOF = true;
+  }
+  if (Length > 0) {
+    memcpy(Buffer, m_Data + m_Position, Length);
+    m_Position += Length;
+  }
+
+  return Length;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read the next line without the new line character, return false at the end of the file
+bool MFileMapped::ReadLine(string& Line)
+{
+  if (m_Position >= m_Length) {
+    m_EOF = true;
+    Line.clear();
+    return false;
+  }
+
+  const char* Start = m_Data + m_Position;
+  const char* NewLine = static_cast<const char*>(memchr(Start, '\n', m_Length - m_Position));
+  if (NewLine != nullptr) {
+    Line.assign(Start, NewLine - Start);
+    m_Position += NewLine - Start + 1;
+  } else {
+    Line.assign(Start, m_Length - m_Position);
+    m_Position = m_Length;
+    m_EOF = true;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Go to the given position, return false if it is beyond the end of the file
+bool MFileMapped::Seek(uint64_t Position)
+{
+  if (m_IsOpen == false) return false;
+
+  m_EOF = false;
+  if (Position > m_Length) {
+    m_Position = m_Length;
+    return false;
+  }
+  m_Position = Position;
+
+  return true;
+}
+
+
+// MFileMapped.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
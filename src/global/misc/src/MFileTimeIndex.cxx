@@ -0,0 +1,250 @@
+/*
+ * MFileTimeIndex.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// Include the header:
+#include "MFileTimeIndex.h"
+
+// Standard libs:
+#include <filesystem>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MStreams.h"
+#include "MParser.h"
+#include "MFile.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MFileTimeIndex)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+const unsigned long MFileTimeIndex::c_DefaultEventsPerBlock = 1000;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default constructor
+MFileTimeIndex::MFileTimeIndex()
+{
+  m_EventsPerBlock = c_DefaultEventsPerBlock;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default destructor
+MFileTimeIndex::~MFileTimeIndex()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Reset to an empty index
+void MFileTimeIndex::Reset()
+{
+  m_Blocks.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Start a new block at the given seek point
+void MFileTimeIndex::StartBlock(streampos UncompressedOffset, streampos CompressedOffset)
+{
+  MFileTimeIndexBlock Block;
+  Block.m_MinimumTime = MTime(0);
+  Block.m_MaximumTime = MTime(0);
+  Block.m_UncompressedOffset = UncompressedOffset;
+  Block.m_CompressedOffset = CompressedOffset;
+  Block.m_NEvents = 0;
+
+  m_Blocks.push_back(Block);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Set the seek point of a block, if it was not yet known when the block was started
+void MFileTimeIndex::SetSeekPoint(unsigned int Block, streampos UncompressedOffset, streampos CompressedOffset)
+{
+  if (Block >= m_Blocks.size()) return;
+
+  m_Blocks[Block].m_UncompressedOffset = UncompressedOffset;
+  m_Blocks[Block].m_CompressedOffset = CompressedOffset;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Add an event time to the current block
+void MFileTimeIndex::AddEvent(const MTime& Time)
+{
+  if (m_Blocks.size() == 0) {
+    StartBlock(0, 0);
+  }
+
+  MFileTimeIndexBlock& Block = m_Blocks.back();
+  if (Block.m_NEvents == 0) {
+    Block.m_MinimumTime = Time;
+    Block.m_MaximumTime = Time;
+  } else {
+    // Events are not required to be time-ordered, thus store the full range
+    if (Time < Block.m_MinimumTime) Block.m_MinimumTime = Time;
+    if (Time > Block.m_MaximumTime) Block.m_MaximumTime = Time;
+  }
+  ++Block.m_NEvents;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return for each block true if any part of its time range overlaps with the GTI
+vector<bool> MFileTimeIndex::SelectBlocks(const MGTI& GTI) const
+{
+  vector<bool> Selected(m_Blocks.size(), false);
+
+  unsigned int Cursor = 0;
+  for (unsigned int b = 0; b < m_Blocks.size(); ++b) {
+    // Blocks without events only contain header/footer data - keep them
+    if (m_Blocks[b].m_NEvents == 0) {
+      Selected[b] = true;
+      continue;
+    }
+    Selected[b] = GTI.Overlaps(m_Blocks[b].m_MinimumTime, m_Blocks[b].m_MaximumTime, Cursor);
+  }
+
+  return Selected;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Save the index for the given event file
+bool MFileTimeIndex::Save(const MString& IndexFileName, const MString& EventFileName) const
+{
+  error_code Error;
+  uintmax_t FileSize = filesystem::file_size(EventFileName.Data(), Error);
+  if (Error) {
+    merr<<"Unable to determine the size of "<<EventFileName<<" - time index not written"<<show;
+    return false;
+  }
+
+  ofstream out;
+  out.open(IndexFileName);
+  if (out.is_open() == false) {
+    merr<<"Unable to open time index file "<<IndexFileName<<show;
+    return false;
+  }
+
+  out<<"TY tidx"<<endl;
+  out<<"VE 1"<<endl;
+  out<<"FS "<<FileSize<<endl;
+  out<<"BS "<<m_EventsPerBlock<<endl;
+  out<<endl;
+  for (auto& B: m_Blocks) {
+    out<<"TI "<<B.m_MinimumTime<<" "<<B.m_MaximumTime<<" "<<streamoff(B.m_UncompressedOffset)<<" "<<streamoff(B.m_CompressedOffset)<<" "<<B.m_NEvents<<endl;
+  }
+  out<<"EN"<<endl;
+
+  out.close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Load the index for the given event file -- fails if the event file has changed since the index was written
+bool MFileTimeIndex::Load(const MString& IndexFileName, const MString& EventFileName)
+{
+  Reset();
+
+  if (MFile::Exists(IndexFileName) == false) return false;
+
+  MParser P;
+  if (P.Open(IndexFileName, MFile::c_Read) == false) {
+    return false;
+  }
+
+  bool FoundEnd = false;
+  uintmax_t FileSize = 0;
+  for (unsigned int l = 0; l < P.GetNLines(); ++l) {
+    MTokenizer* T = P.GetTokenizerAt(l);
+    if (T->GetNTokens() == 0) continue;
+
+    if (T->IsTokenAt(0, "TY") == true) {
+      if (T->GetNTokens() != 2 || T->GetTokenAtAsString(1) != "tidx") {
+        Reset();
+        return false;
+      }
+    } else if (T->IsTokenAt(0, "FS") == true && T->GetNTokens() == 2) {
+      FileSize = T->GetTokenAtAsUnsignedLong(1);
+    } else if (T->IsTokenAt(0, "BS") == true && T->GetNTokens() == 2) {
+      SetEventsPerBlock(T->GetTokenAtAsUnsignedLong(1));
+    } else if (T->IsTokenAt(0, "TI") == true && T->GetNTokens() == 6) {
+      MFileTimeIndexBlock Block;
+      Block.m_MinimumTime = T->GetTokenAtAsTime(1);
+      Block.m_MaximumTime = T->GetTokenAtAsTime(2);
+      Block.m_UncompressedOffset = streamoff(T->GetTokenAtAsLong(3));
+      Block.m_CompressedOffset = streamoff(T->GetTokenAtAsLong(4));
+      Block.m_NEvents = T->GetTokenAtAsUnsignedLong(5);
+      m_Blocks.push_back(Block);
+    } else if (T->IsTokenAt(0, "EN") == true) {
+      FoundEnd = true;
+      break;
+    }
+  }
+
+  // An index without end was not completely written
+  if (FoundEnd == false) {
+    Reset();
+    return false;
+  }
+
+  // The event file must not have changed since the index was created
+  error_code Error;
+  if (filesystem::file_size(EventFileName.Data(), Error) != FileSize || Error) {
+    mout<<"Info: The time index "<<IndexFileName<<" is outdated and will not be used"<<endl;
+    Reset();
+    return false;
+  }
+
+  return true;
+}
+
+
+// MFileTimeIndex.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
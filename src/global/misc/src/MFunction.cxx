@@ -68,7 +68,7 @@ const unsigned int MFunction::c_InterpolationSpline5  = 8;
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MFunction::MFunction() : m_InterpolationType(c_InterpolationLinLin)
+MFunction::MFunction() : m_InterpolationType(c_InterpolationLinLin), m_EvaluationPrepared(false)
 {
   // Construct an instance of MFunction
 
@@ -79,7 +79,7 @@ MFunction::MFunction() : m_InterpolationType(c_InterpolationLinLin)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MFunction::MFunction(const MFunction& F)
+MFunction::MFunction(const MFunction& F) : m_EvaluationPrepared(false)
 {
   // Copy-construct an instance of MFunction
 
@@ -88,6 +88,8 @@ MFunction::MFunction(const MFunction& F)
   m_X = F.m_X;
   m_Y = F.m_Y;
   m_Cumulative = F.m_Cumulative;
+  m_AliasProbability = F.m_AliasProbability;
+  m_AliasIndex = F.m_AliasIndex;
   m_YNonNegative = F.m_YNonNegative;
 }
 
@@ -113,8 +115,13 @@ const MFunction& MFunction::operator=(const MFunction& F)
   m_X = F.m_X;
   m_Y = F.m_Y;
   m_Cumulative = F.m_Cumulative;
+  m_AliasProbability = F.m_AliasProbability;
+  m_AliasIndex = F.m_AliasIndex;
   m_YNonNegative = F.m_YNonNegative;
 
+  // The interpolation coefficients are recalculated on demand
+  m_EvaluationPrepared = false;
+
   CheckDynamicRange();
 
   return *this;
@@ -235,7 +242,7 @@ bool MFunction::Set(const MString FileName, const MString KeyWord)
   }
 
   // Clean up:
-  m_Cumulative.clear();
+  ClearCache();
 
   CheckDynamicRange();
 
@@ -305,7 +312,7 @@ bool MFunction::Set(const MResponseMatrixO1& Response)
   }
 
   // Clean up:
-  m_Cumulative.clear();
+  ClearCache();
 
   CheckDynamicRange();
 
@@ -332,7 +339,7 @@ bool MFunction::Set(const vector<long double>& X, const vector<long double>& Y,
   }
 
   // Clean up:
-  m_Cumulative.clear();
+  ClearCache();
 
   CheckDynamicRange();
 
@@ -361,7 +368,7 @@ bool MFunction::Set(const vector<double>& X, const vector<double>& Y, unsigned i
   }
 
   // Clean up:
-  m_Cumulative.clear();
+  ClearCache();
 
   CheckDynamicRange();
 
@@ -401,9 +408,137 @@ bool MFunction::Add(const long double x, const long double y)
     }
   }
 
+  if (y < 0) m_YNonNegative = false;
+
+  ClearCache();
+
   return true;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFunction::ClearCache()
+{
+  //! Clear all data derived from the data points
+
+  m_Cumulative.clear();
+  m_AliasProbability.clear();
+  m_AliasIndex.clear();
+
+  m_EvaluationPrepared = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFunction::PrepareEvaluation() const
+{
+  //! Determine the grid type and the interpolation coefficients of all intervals, if not yet done
+
+  if (m_EvaluationPrepared == true) return;
+
+  lock_guard<mutex> Lock(m_EvaluationMutex);
+  if (m_EvaluationPrepared == true) return;
+
+  bool LogX = (m_InterpolationType == c_InterpolationLogLin || m_InterpolationType == c_InterpolationLogLog);
+  bool LogY = (m_InterpolationType == c_InterpolationLinLog || m_InterpolationType == c_InterpolationLogLog);
+
+  // The coefficients of the interpolation line in the respective lin/log space
+  // --- they are calculated exactly as the line was calculated before on each call
+  m_Slopes.clear();
+  m_Offsets.clear();
+  for (unsigned int i = 1; i < m_X.size(); ++i) {
+    long double x1 = m_X[i-1];
+    long double x2 = m_X[i];
+    long double y1 = m_Y[i-1];
+    long double y2 = m_Y[i];
+    if (LogY == true) {
+      y1 = log(y1);
+      y2 = log(y2);
+    }
+    if (LogX == true) {
+      x1 = log(x1);
+      x2 = log(x2);
+    }
+    long double m = (y2-y1)/(x2-x1);
+    m_Slopes.push_back(m);
+    m_Offsets.push_back(y2 - m*x2);
+  }
+
+  // Check if the grid is equidistant in x or log(x): Then the interval can be calculated directly.
+  // We only require the guessed index to be off by less than one, since it is corrected in FindPosition anyway
+  m_GridType = c_GridIrregular;
+  m_GridStart = 0;
+  m_GridInverseStep = 0;
+  if (m_X.size() >= 3) {
+    for (unsigned int Type: { c_GridUniform, c_GridLogUniform }) {
+      if (Type == c_GridLogUniform && m_X.front() <= 0) continue;
+      long double Start = (Type == c_GridUniform) ? m_X.front() : log(m_X.front());
+      long double Stop = (Type == c_GridUniform) ? m_X.back() : log(m_X.back());
+      long double Step = (Stop - Start)/(m_X.size() - 1);
+      if (Step <= 0 || std::isfinite(Step) == false) continue;
+
+      bool Equidistant = true;
+      for (unsigned int i = 0; i < m_X.size(); ++i) {
+        long double Value = (Type == c_GridUniform) ? m_X[i] : log(m_X[i]);
+        if (fabs(Value - (Start + i*Step)) > 0.25*Step) {
+          Equidistant = false;
+          break;
+        }
+      }
+      if (Equidistant == true) {
+        m_GridType = Type;
+        m_GridStart = Start;
+        m_GridInverseStep = 1.0/Step;
+        break;
+      }
+    }
+  }
+
+  m_EvaluationPrepared = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MFunction::FindPosition(long double x) const
+{
+  //! Return the index of the last data point with an x-value smaller or equal x, or -1 if there is none
+
+  int Size = m_X.size();
+
+  if (m_GridType == c_GridIrregular || std::isnan(x)) {
+    return int(upper_bound(m_X.begin(), m_X.end(), x) - m_X.begin()) - 1;
+  }
+
+  // Equidistant grids: calculate the index directly and correct it by at most one
+  long double Guess = 0;
+  if (m_GridType == c_GridUniform) {
+    Guess = (x - m_GridStart)*m_GridInverseStep;
+  } else {
+    if (x <= 0) return -1;
+    Guess = (log(x) - m_GridStart)*m_GridInverseStep;
+  }
+
+  int Position = 0;
+  if (Guess < 0) {
+    Position = -1;
+  } else if (Guess >= Size - 1) {
+    Position = Size - 1;
+  } else {
+    Position = int(Guess);
+  }
+
+  while (Position + 1 < Size && m_X[Position+1] <= x) ++Position;
+  while (Position >= 0 && m_X[Position] > x) --Position;
+
+  return Position;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 
@@ -452,7 +587,7 @@ void MFunction::ScaleY(long double Scaler)
   }
 
   // Clean up:
-  m_Cumulative.clear();
+  ClearCache();
 }
 
 
@@ -468,7 +603,7 @@ void MFunction::ScaleX(long double Scaler)
   }  
 
   // We clear the cumulative function:
-  m_Cumulative.clear();
+  ClearCache();
 }
 
 
@@ -502,16 +637,14 @@ long double MFunction::Evaluate(long double x) const
 
   if (m_InterpolationType == c_InterpolationConstant || m_X.size() == 1) {
     return m_Y[0];
-  } else if (m_InterpolationType == c_InterpolationNone) {
+  }
+
+  PrepareEvaluation();
+
+  if (m_InterpolationType == c_InterpolationNone) {
 
     // Get Position:
-    int xPosition = -1; 
-    for (unsigned int i = 0; i < m_X.size(); ++i) {
-      if (m_X[i] > x) {
-        break;
-      } 
-      xPosition = (int) i;
-    }
+    int xPosition = FindPosition(x);
 
     if (xPosition < 0) xPosition = 0;
     if (xPosition >= (int) m_X.size()-1) xPosition = (int) (m_X.size()-2);
@@ -528,50 +661,24 @@ long double MFunction::Evaluate(long double x) const
 
     long double y = 0.0;
 
-    int Position = -1; 
-    for (unsigned int i = 0; i < m_X.size(); ++i) {
-      if (m_X[i] > x) {
-        break;
-      } 
-      Position = (int) i;
-    }
-    
-    long double x1, x2, y1, y2;
-    // Position = -1: Extrapolate to lower x
-    if (Position == -1) {
-      x1 = m_X[0];
-      x2 = m_X[1];
-      y1 = m_Y[0];
-      y2 = m_Y[1];
-    } 
-    // Position = MAX: Extrapolate to higher x
-    else if (Position >= (int) m_X.size()-1) {
-      x1 = m_X[Position-1];
-      x2 = m_X[Position];
-      y1 = m_Y[Position-1];
-      y2 = m_Y[Position];
-    }
+    // Position = -1: Extrapolate to lower x with the first interval
+    // Position = MAX: Extrapolate to higher x with the last interval
     // Position = [0..MAX-1] : interpolate
-    else {
-      x1 = m_X[Position];
-      x2 = m_X[Position+1];
-      y1 = m_Y[Position];
-      y2 = m_Y[Position+1];
+    int Position = FindPosition(x);
+    unsigned int Interval = 0;
+    if (Position >= (int) m_X.size()-1) {
+      Interval = m_X.size()-2;
+    } else if (Position > 0) {
+      Interval = Position;
     }
 
     // Attention for log interpolation make sure all values are positive!
-    if (m_InterpolationType == c_InterpolationLinLog || m_InterpolationType == c_InterpolationLogLog) {
-      y1 = log(y1);
-      y2 = log(y2);
-    }
     if (m_InterpolationType == c_InterpolationLogLin || m_InterpolationType == c_InterpolationLogLog) {
       x = log(x);
-      x1 = log(x1);
-      x2 = log(x2);
     }
 
-    long double m = (y2-y1)/(x2-x1);
-    long double t = y2 - m*x2;
+    long double m = m_Slopes[Interval];
+    long double t = m_Offsets[Interval];
 
     if (m_InterpolationType == c_InterpolationLinLog || m_InterpolationType == c_InterpolationLogLog) {
       y = exp(m*x+t);
@@ -581,7 +688,7 @@ long double MFunction::Evaluate(long double x) const
     
     if (std::isnan(y)) { // std:: is required here due to multiple definitions
       merr<<"Interpolation error for interpolation type "<<m_InterpolationType<<": y is NaN!"<<endl;;
-      merr<<"   m="<<m<<"  t="<<t<<"  x1="<<x1<<"  y1="<<y1<<"  x2="<<x2<<"  y2="<<y2<<show;
+      merr<<"   m="<<m<<"  t="<<t<<"  x1="<<m_X[Interval]<<"  y1="<<m_Y[Interval]<<"  x2="<<m_X[Interval+1]<<"  y2="<<m_Y[Interval+1]<<show;
     }
 
     return y;
@@ -624,7 +731,7 @@ long double MFunction::Integrate(long double XMin, long double XMax) const
   int BinMin = 0;
   if (XMin > m_X.front()) {
     // BinMin = find_if(m_X.begin(), m_X.end(), bind2nd(greater<long double>(), XMin)) - m_X.begin() - 1;
-    BinMin = find_if(m_X.begin(), m_X.end(), bind(greater<long double>(), placeholders::_1, XMin)) - m_X.begin() - 1;
+    BinMin = upper_bound(m_X.begin(), m_X.end(), XMin) - m_X.begin() - 1;
 //     unsigned int upper = m_Cumulative.size();
 //     unsigned int center = 1;
 //     unsigned int lower = 0;
@@ -645,7 +752,7 @@ long double MFunction::Integrate(long double XMin, long double XMax) const
   int BinMax = m_X.size()-1;
   if (XMax < m_X.back()) {
     //BinMax = find_if(m_X.begin(), m_X.end(), bind2nd(greater_equal<long double>(), XMax)) - m_X.begin();
-    BinMax = find_if(m_X.begin(), m_X.end(), bind(greater_equal<long double>(), placeholders::_1, XMax)) - m_X.begin();
+    BinMax = lower_bound(m_X.begin(), m_X.end(), XMax) - m_X.begin();
 //     unsigned int upper = m_Cumulative.size();
 //     unsigned int center = 1;
 //     unsigned int lower = 0;
@@ -797,20 +904,86 @@ long double MFunction::GetRandom()
     return 0;
   }
 
-  // Check if we have to determine the cumulative function:
+  // Check if we have to determine the cumulative function and the alias table:
   if (m_Cumulative.size() == 0) {
-    if (m_Y.size() > 5000) {
-      mout<<"MFunction: Determining the cumulative function --- this can take a very long time, especially when MEGAlib was compiled in debug mode..."<<endl;
-    }
-    m_Cumulative.push_back(0);
-    for (unsigned int i = 1; i < m_Y.size(); ++i) {
-      m_Cumulative.push_back(m_Cumulative.back() + Integrate(m_X[i-1], m_X[i]));
-    }
+    PrepareRandom();
   }
 
-  // Find a random number on the total intensity scale and then (function call)
+  // Without alias table (no or only one data point, no content) fall back to the search in the cumulative function
+  if (m_AliasIndex.size() == 0) {
+    return GetRandomInterpolate(gRandom->Rndm()*m_Cumulative.back());
+  }
+
+  // Draw the interval from the alias table
+  unsigned int NIntervals = m_AliasIndex.size();
+  unsigned int Interval = (unsigned int) (gRandom->Rndm()*NIntervals);
+  if (Interval >= NIntervals) Interval = NIntervals - 1;
+  if (gRandom->Rndm() >= m_AliasProbability[Interval]) {
+    Interval = m_AliasIndex[Interval];
+  }
+
+  // Find a random number on the intensity scale of this interval and then (function call)
   // the appropriate x-value
-  return GetRandomInterpolate(gRandom->Rndm()*m_Cumulative.back());
+  long double Itot = m_Cumulative[Interval] + gRandom->Rndm()*(m_Cumulative[Interval+1] - m_Cumulative[Interval]);
+
+  return GetRandomInterpolate(Itot, Interval+1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MFunction::PrepareRandom()
+{
+  //! Determine the cumulative function and the alias table for GetRandom()
+  //! The alias table is created via Vose's variant of Walker's method
+
+  m_Cumulative.clear();
+  m_AliasProbability.clear();
+  m_AliasIndex.clear();
+
+  m_Cumulative.push_back(0);
+  for (unsigned int i = 1; i < m_Y.size(); ++i) {
+    m_Cumulative.push_back(m_Cumulative.back() + Integrate(m_X[i-1], m_X[i]));
+  }
+
+  unsigned int NIntervals = m_Cumulative.size() - 1;
+  long double Total = m_Cumulative.back();
+  if (NIntervals == 0 || Total <= 0 || std::isfinite(Total) == false) return;
+
+  // The content of each interval scaled to an average of one
+  vector<long double> Scaled(NIntervals);
+  vector<unsigned int> Small;
+  vector<unsigned int> Large;
+  for (unsigned int i = 0; i < NIntervals; ++i) {
+    Scaled[i] = (m_Cumulative[i+1] - m_Cumulative[i]) / Total * NIntervals;
+    if (Scaled[i] < 1) {
+      Small.push_back(i);
+    } else {
+      Large.push_back(i);
+    }
+  }
+
+  m_AliasProbability.resize(NIntervals, 1.0);
+  m_AliasIndex.resize(NIntervals);
+  for (unsigned int i = 0; i < NIntervals; ++i) m_AliasIndex[i] = i;
+
+  // Fill up each small interval with a part of a large one
+  while (Small.size() > 0 && Large.size() > 0) {
+    unsigned int S = Small.back();
+    Small.pop_back();
+    unsigned int L = Large.back();
+
+    m_AliasProbability[S] = Scaled[S];
+    m_AliasIndex[S] = L;
+
+    Scaled[L] = (Scaled[L] + Scaled[S]) - 1;
+    if (Scaled[L] < 1) {
+      Large.pop_back();
+      Small.push_back(L);
+    }
+  }
+  // The remaining ones are (within numerical precision) full and keep probability one
 }
 
 
@@ -828,10 +1001,7 @@ long double MFunction::GetRandomTimesX()
 
   // Check if we have to determine the cumulative function:
   if (m_Cumulative.size() == 0) {
-    m_Cumulative.push_back(0);
-    for (unsigned int i = 1; i < m_Y.size(); ++i) {
-      m_Cumulative.push_back(m_Cumulative.back() + Integrate(m_X[i-1], m_X[i]));
-    }
+    PrepareRandom();
   }
 
   // Find a random number on the total intensity scale and then (function call)
@@ -850,7 +1020,7 @@ long double MFunction::GetRandomInterpolate(long double Itot)
 
   // Find the correct bin in m_Cumulative
   //int Bin = find_if(m_Cumulative.begin(), m_Cumulative.end(), bind2nd(greater_equal<long double>(), Itot)) - m_Cumulative.begin();
-  int Bin = find_if(m_Cumulative.begin(), m_Cumulative.end(), bind(greater_equal<long double>(), placeholders::_1, Itot)) - m_Cumulative.begin();
+  int Bin = lower_bound(m_Cumulative.begin(), m_Cumulative.end(), Itot) - m_Cumulative.begin();
 
 //   // Binary search:
 //   unsigned int upper = m_Cumulative.size();
@@ -870,6 +1040,17 @@ long double MFunction::GetRandomInterpolate(long double Itot)
 //   }
 //   Bin = int(lower)+1;
 
+  return GetRandomInterpolate(Itot, Bin);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+long double MFunction::GetRandomInterpolate(long double Itot, int Bin)
+{
+  // Second stage of the GetRandom function, when the bin in m_Cumulative is already known
+  // Now find the correct x-value via interpolation
 
   // And the x-value via the given interpolation method:
   if (Bin == 0) {
@@ -898,35 +1079,12 @@ long double MFunction::GetRandomInterpolate(long double Itot)
              m_InterpolationType == c_InterpolationLogLin ||
              m_InterpolationType == c_InterpolationLogLog) {
 
-    long double x1, x2, y1, y2;
-    x1 = m_X[Bin-1];
-    y1 = m_Y[Bin-1];
-    x2 = m_X[Bin];
-    y2 = m_Y[Bin];
-    
-    // Attention for log interpolation make sure all values are positive!
-    if (m_InterpolationType == c_InterpolationLinLog || m_InterpolationType == c_InterpolationLogLog) {
-      y1 = log(y1);
-      y2 = log(y2);
-    }
-    if (m_InterpolationType == c_InterpolationLogLin || m_InterpolationType == c_InterpolationLogLog) {
-      x1 = log(x1);
-      x2 = log(x2);
-    }
-    
-    // Calculate m, t of the interpolation "line" (it's always a line in the respective mode) 
-    long double m = (y2-y1)/(x2-x1);
-    long double t = y2 - m*x2;
-    
-    // Switch back
-    if (m_InterpolationType == c_InterpolationLinLog || m_InterpolationType == c_InterpolationLogLog) {
-      y1 = exp(y1);
-      y2 = exp(y2);
-    }
-    if (m_InterpolationType == c_InterpolationLogLin || m_InterpolationType == c_InterpolationLogLog) {
-      x1 = exp(x1);
-      x2 = exp(x2);
-    }
+    long double x1 = m_X[Bin-1];
+
+    // The m, t of the interpolation "line" (it's always a line in the respective mode) 
+    PrepareEvaluation();
+    long double m = m_Slopes[Bin-1];
+    long double t = m_Offsets[Bin-1];
 
     // Relative intensity in this bin:
     long double I  = Itot - m_Cumulative[Bin-1];
@@ -1134,7 +1292,7 @@ long double MFunction::FindX(long double XStart, long double Integral, bool Cycl
   unsigned int BinStart = 0;
   if (X > m_X.front()) {
     //BinStart = find_if(m_X.begin(), m_X.end(), bind2nd(greater<long double>(), X)) - m_X.begin() - 1;
-    BinStart = find_if(m_X.begin(), m_X.end(), bind(greater<long double>(), placeholders::_1, X)) - m_X.begin() - 1;
+    BinStart = upper_bound(m_X.begin(), m_X.end(), X) - m_X.begin() - 1;
   }
 
   //cout<<"x: "<<X<<" Bin start: "<<BinStart<<endl;
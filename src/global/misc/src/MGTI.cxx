@@ -20,6 +20,8 @@
 #include "MGTI.h"
 
 // Standard libs:
+#include <algorithm>
+using namespace std;
 
 // ROOT libs:
 
@@ -43,6 +45,8 @@ MGTI::MGTI()
 {
   m_GoodStart.push_back(MTime(0));
   m_GoodStop.push_back(MTime(2000000000));
+
+  Merge();
 }
 
 
@@ -71,6 +75,8 @@ void MGTI::Reset(bool AllOpen)
     m_GoodStart.push_back(MTime(0));
     m_GoodStop.push_back(MTime(2000000000));
   }
+
+  Merge();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -79,24 +85,142 @@ void MGTI::Reset(bool AllOpen)
 //! Check if the time is withing a good interval 
 bool MGTI::IsGood(const MTime& Time) const
 {
-  bool InGood = false;
-  for (unsigned int i = 0; i < m_GoodStart.size(); ++i) {
-    //cout<<"GTI test: "<<m_GoodStart[i]<<"-"<<m_GoodStop[i]<<endl;
-    if (Time >= m_GoodStart[i] && Time <= m_GoodStop[i]) {
-      InGood = true;
-      break;
-    }
+  int i = FindMergedInterval(Time);
+  if (i < 0) return false;
+
+  return Time <= m_MergedStop[i];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check if the time is within a good interval for a time-ordered stream
+bool MGTI::IsGood(const MTime& Time, unsigned int& Cursor) const
+{
+  if (m_MergedStart.size() == 0) return false;
+
+  // Time went backwards or the cursor is invalid - start over with a binary search
+  if (Cursor >= m_MergedStart.size() || Time < m_MergedStart[Cursor]) {
+    int i = FindMergedInterval(Time);
+    Cursor = (i < 0) ? 0 : i;
   }
-  if (InGood == false) return false;
-  
-  for (unsigned int i = 0; i < m_BadStart.size(); ++i) {
-    //cout<<"BTI test: "<<m_BadStart[i]<<"-"<<m_BadStop[i]<<endl;
-    if (Time >= m_BadStart[i] && Time <= m_BadStop[i]) {
-      return false;
+
+  // Advance to the last interval starting at or before the time
+  while (Cursor + 1 < m_MergedStart.size() && m_MergedStart[Cursor + 1] <= Time) {
+    ++Cursor;
+  }
+
+  return Time >= m_MergedStart[Cursor] && Time <= m_MergedStop[Cursor];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check if any part of the time range [Start, Stop] is within a good interval
+bool MGTI::Overlaps(const MTime& Start, const MTime& Stop, unsigned int& Cursor) const
+{
+  if (m_MergedStart.size() == 0) return false;
+
+  // Place the cursor on the last interval starting at or before Start, or the first one
+  if (Cursor >= m_MergedStart.size() || Start < m_MergedStart[Cursor]) {
+    int i = FindMergedInterval(Start);
+    Cursor = (i < 0) ? 0 : i;
+  }
+  while (Cursor + 1 < m_MergedStart.size() && m_MergedStart[Cursor + 1] <= Start) {
+    ++Cursor;
+  }
+
+  // The intervals are disjoint and sorted: Either the cursor interval contains Start,
+  // or the next interval which starts after Start begins before Stop
+  if (m_MergedStart[Cursor] <= Start && m_MergedStop[Cursor] >= Start) return true;
+  if (m_MergedStart[Cursor] > Start) return m_MergedStart[Cursor] <= Stop;
+  if (Cursor + 1 < m_MergedStart.size() && m_MergedStart[Cursor + 1] <= Stop) return true;
+
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the index of the last merged interval starting at or before Time, or -1 if there is none
+int MGTI::FindMergedInterval(const MTime& Time) const
+{
+  auto Iter = upper_bound(m_MergedStart.begin(), m_MergedStart.end(), Time);
+  return int(Iter - m_MergedStart.begin()) - 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Build the sorted and merged good intervals from the good and bad time intervals
+void MGTI::Merge()
+{
+  // Sort and join the good and the bad intervals individually
+  auto Join = [](const vector<MTime>& Start, const vector<MTime>& Stop, vector<pair<MTime, MTime>>& Joined) {
+    vector<pair<MTime, MTime>> Intervals;
+    for (unsigned int i = 0; i < Start.size() && i < Stop.size(); ++i) {
+      if (Start[i] <= Stop[i]) {
+        Intervals.push_back(pair<MTime, MTime>(Start[i], Stop[i]));
+      }
+    }
+    sort(Intervals.begin(), Intervals.end(), [](const pair<MTime, MTime>& A, const pair<MTime, MTime>& B) { return A.first < B.first; });
+
+    Joined.clear();
+    for (auto& I: Intervals) {
+      if (Joined.size() > 0 && I.first <= Joined.back().second) {
+        if (I.second > Joined.back().second) Joined.back().second = I.second;
+      } else {
+        Joined.push_back(I);
+      }
+    }
+  };
+
+  vector<pair<MTime, MTime>> Good;
+  Join(m_GoodStart, m_GoodStop, Good);
+  vector<pair<MTime, MTime>> Bad;
+  Join(m_BadStart, m_BadStop, Bad);
+
+  // Cut out the bad intervals -- all intervals are closed, and times have nanosecond precision,
+  // thus the remaining pieces end/start one nanosecond before/after the bad interval
+  const MTime OneNanoSecond(0L, 1L);
+
+  m_MergedStart.clear();
+  m_MergedStop.clear();
+
+  unsigned int b = 0;
+  for (auto& G: Good) {
+    MTime Start = G.first;
+    MTime Stop = G.second;
+
+    // Skip all bad intervals ending before this good one
+    while (b < Bad.size() && Bad[b].second < Start) ++b;
+
+    unsigned int bb = b;
+    bool Remaining = true;
+    while (bb < Bad.size() && Bad[bb].first <= Stop) {
+      if (Bad[bb].first > Start) {
+        MTime PieceStop = Bad[bb].first;
+        PieceStop -= OneNanoSecond;
+        m_MergedStart.push_back(Start);
+        m_MergedStop.push_back(PieceStop);
+      }
+      if (Bad[bb].second >= Stop) {
+        Remaining = false;
+        break;
+      }
+      Start = Bad[bb].second;
+      Start += OneNanoSecond;
+      ++bb;
+    }
+    if (Remaining == true) {
+      m_MergedStart.push_back(Start);
+      m_MergedStop.push_back(Stop);
     }
   }
-  
-  return true;
 }
 
 
@@ -110,6 +234,34 @@ void MGTI::Add(const MGTI& GTI)
   m_GoodStop.insert(m_GoodStop.end(), GTI.m_GoodStop.begin(), GTI.m_GoodStop.end());
   m_BadStart.insert(m_BadStart.end(), GTI.m_BadStart.begin(), GTI.m_BadStart.end());
   m_BadStop.insert(m_BadStop.end(), GTI.m_BadStop.begin(), GTI.m_BadStop.end());
+
+  Merge();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Add a good time interval
+void MGTI::AddGoodTimeInterval(const MTime& Start, const MTime& Stop)
+{
+  m_GoodStart.push_back(Start);
+  m_GoodStop.push_back(Stop);
+
+  Merge();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Add a bad time interval
+void MGTI::AddBadTimeInterval(const MTime& Start, const MTime& Stop)
+{
+  m_BadStart.push_back(Start);
+  m_BadStop.push_back(Stop);
+
+  Merge();
 }
   
 
@@ -143,6 +295,7 @@ bool MGTI::Load(const MString& FileName)
         Add(GTI);
       } else {
         cout<<"Error: Unable to load GTI file: "<<Name<<endl;
+        Merge();
         return false;
       }
     }
@@ -157,7 +310,9 @@ bool MGTI::Load(const MString& FileName)
       m_BadStop.push_back(P.GetTokenizerAt(l)->GetTokenAtAsTime(2));
     }
   }
- 
+
+  Merge();
+
   return true;
 }
 
@@ -48,6 +48,7 @@ using namespace std;
 #include "MExceptions.h"
 #include "MStreams.h"
 #include "MFile.h"
+#include "MFileEventCache.h"
 #include "MSystem.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -167,6 +168,9 @@ bool MGlobal::Initialize(MString ProgramName, MString ProgramDescription)
   __merr.DumpToStdErr(true);
   __merr.DumpToStdOut(false);
 
+  // The optional cache of decompressed event files
+  MFileEventCache::EnableFromEnvironment();
+
   // Initilize some global ROOT variables:
   gEnv->SetValue("Gui.BackgroundColor", "#e3dfdf");
 
@@ -28,6 +28,7 @@
 
 // Standard libs:
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 using namespace std;
 
@@ -37,6 +38,7 @@ using namespace std;
 #include "MAssert.h"
 #include "MStreams.h"
 #include "MExceptions.h"
+#include "MFastTokenizer.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -269,58 +271,64 @@ MString MPhysicalEvent::ToTraString() const
 {
   //! Stream the content into a tra-file compatible string
 
-  ostringstream S;
+  // The numbers are formatted directly and not via streams, the output is identical
+  MString S;
+  S.Reserve(256);
   switch (m_EventType) {
   case c_Compton:
-    S<<"ET CO"<<endl;
+    S += "ET CO\n";
     break;
   case c_Pair:
-    S<<"ET PA"<<endl;
+    S += "ET PA\n";
     break;
   case c_Photo:
-    S<<"ET PH"<<endl;
+    S += "ET PH\n";
     break;
   case c_Muon:
-    S<<"ET MU"<<endl;
+    S += "ET MU\n";
     break;
   case c_Decay:
-    S<<"ET DY"<<endl;
+    S += "ET DY\n";
     break;
   case c_PET:
-    S<<"ET PT"<<endl;
+    S += "ET PT\n";
     break;
   case c_Multi:
-    S<<"ET MT"<<endl;
+    S += "ET MT\n";
     break;
   case c_Unidentifiable:
-    S<<"ET UN"<<endl;
+    S += "ET UN\n";
     break;
   default:
-    S<<"ET Unkown"<<endl;
+    S += "ET Unkown\n";
     break;
   }
-  S<<"ID "<<m_Id<<endl;
-  S<<"TI "<<m_Time.GetLongIntsString()<<endl;
+  S += "ID "; S += m_Id; S += '\n';
+  S += "TI "; S += m_Time.GetLongIntsString(); S += '\n';
   if (m_TimeWalk != -1) {
-    S<<"TW "<<m_TimeWalk<<endl;
+    S += "TW "; S += m_TimeWalk; S += '\n';
   }
 
   MRotationInterface::Stream(S);
 
   if (m_Bad == true) {
-    S<<"BD "<<m_BadString<<endl;
+    S += "BD "; S += m_BadString; S += '\n';
   }
   if (m_Decay == true) {
-    S<<"DC"<<endl;
+    S += "DC\n";
   }
   if (m_OIPosition != g_VectorNotDefined && m_OIDirection != g_VectorNotDefined && m_OIPolarization != g_VectorNotDefined) {
-    S<<"OI "<<m_OIPosition.X()<<" "<<m_OIPosition.Y()<<" "<<m_OIPosition.Z()<<" "<<m_OIDirection.X()<<" "<<m_OIDirection.Y()<<" "<<m_OIDirection.Z()<<" "<<m_OIPolarization.X()<<" "<<m_OIPolarization.Y()<<" "<<m_OIPolarization.Z()<<" "<<m_OIEnergy<<endl;
+    S += "OI ";
+    S.AppendGeneral(m_OIPosition.X()); S += ' '; S.AppendGeneral(m_OIPosition.Y()); S += ' '; S.AppendGeneral(m_OIPosition.Z()); S += ' ';
+    S.AppendGeneral(m_OIDirection.X()); S += ' '; S.AppendGeneral(m_OIDirection.Y()); S += ' '; S.AppendGeneral(m_OIDirection.Z()); S += ' ';
+    S.AppendGeneral(m_OIPolarization.X()); S += ' '; S.AppendGeneral(m_OIPolarization.Y()); S += ' '; S.AppendGeneral(m_OIPolarization.Z()); S += ' ';
+    S.AppendGeneral(m_OIEnergy); S += '\n';
   }
   for (unsigned int c = 0; c < m_Comments.size(); ++c) {
-    S<<"CC "<<m_Comments[c]<<endl;
+    S += "CC "; S += m_Comments[c]; S += '\n';
   }
 
-  return S.str();
+  return S;
 }
 
   
@@ -457,21 +465,15 @@ int MPhysicalEvent::ParseLine(const char* Line, bool Fast)
       }
     }
   } else if (Line[0] == 'I' && Line[1] == 'D') {
-    if (Fast == true) {
-      m_Id = strtol(Line+3, NULL, 10);
-    } else {
-      if (sscanf(Line, "ID %li", &m_Id) != 1) {
-        Ret = 1;
-      }
+    const char* Position = Line + 2;
+    if (MFastTokenizer::ParseLong(Position, Line + strlen(Line), m_Id) == false) {
+      Ret = 1;
     }
     MRotationInterface::m_Id = m_Id;
   } else if (Line[0] == 'T' && Line[1] == 'W') {
-    if (Fast == true) {
-      m_TimeWalk = strtol(Line+3, NULL, 10);
-    } else {
-      if (sscanf(Line, "TW %d", &m_TimeWalk) != 1) {
-        Ret = 1;
-      }
+    const char* Position = Line + 2;
+    if (MFastTokenizer::ParseInt(Position, Line + strlen(Line), m_TimeWalk) == false) {
+      Ret = 1;
     }
   } else if (Line[0] == 'R' && Line[1] == 'X') {
     MRotationInterface::ParseLine(Line, Fast);
@@ -516,22 +518,15 @@ int MPhysicalEvent::ParseLine(const char* Line, bool Fast)
     */
 
   } else if (Line[0] == 'O' && Line[1] == 'I') {
-    if (Fast == true) {
-      char* p;
-      m_OIPosition[0] = strtod(Line+3, &p);
-      m_OIPosition[1] = strtod(p, &p);
-      m_OIPosition[2] = strtod(p, &p);
-      m_OIDirection[0] = strtod(p, &p);
-      m_OIDirection[1] = strtod(p, &p);
-      m_OIDirection[2] = strtod(p, &p);
-      m_OIPolarization[0] = strtod(p, &p);
-      m_OIPolarization[1] = strtod(p, &p);
-      m_OIPolarization[2] = strtod(p, &p);
-      m_OIEnergy = strtod(p, NULL);
+    double Values[10];
+    const char* Position = Line + 2;
+    if (MFastTokenizer::ParseDoubles(Position, Line + strlen(Line), Values, 10) == 10) {
+      m_OIPosition.SetXYZ(Values[0], Values[1], Values[2]);
+      m_OIDirection.SetXYZ(Values[3], Values[4], Values[5]);
+      m_OIPolarization.SetXYZ(Values[6], Values[7], Values[8]);
+      m_OIEnergy = Values[9];
     } else {
-      if (sscanf(Line, "OI %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", &m_OIPosition[0], &m_OIPosition[1], &m_OIPosition[2], &m_OIDirection[0], &m_OIDirection[1], &m_OIDirection[2], &m_OIPolarization[0], &m_OIPolarization[1], &m_OIPolarization[2], &m_OIEnergy) != 10) {
-        Ret = 1;
-      }
+      Ret = 1;
     }
   } else if (Line[0] == 'D' && Line[1] == 'C') {
     m_Decay = true;
@@ -85,6 +85,8 @@ MResponseMatrixON::MResponseMatrixON(const MResponseMatrixON& M)
 {
   // copy constructor
   
+  M.MergePendingSparse();
+  
   m_NumberOfBins = M.m_NumberOfBins;
   m_Axes = M.m_Axes;
   m_NumberOfAxes = M.m_NumberOfAxes;
@@ -130,6 +132,7 @@ void MResponseMatrixON::Clear()
 
   m_ValuesSparse.clear();
   m_BinsSparse.clear();
+  m_PendingSparse.clear();
   
   MResponseMatrix::Clear();
 }
@@ -166,6 +169,8 @@ void MResponseMatrixON::SwitchToNonSparse()
 {
   if (m_IsSparse == false) return;
   
+  MergePendingSparse();
+  
   m_Values.clear();
   m_Values.resize(m_NumberOfBins, 0);
   
@@ -307,6 +312,8 @@ MResponseMatrixON& MResponseMatrixON::operator=(const MResponseMatrixON& M)
   // Assignment operator
   
   if (this != &M) { // no self-assignments
+    M.MergePendingSparse();
+    m_PendingSparse.clear();
     m_NumberOfBins = M.m_NumberOfBins;
     m_Axes = M.m_Axes;
     m_NumberOfAxes = M.m_NumberOfAxes;
@@ -336,6 +343,7 @@ MResponseMatrixON& MResponseMatrixON::operator+=(const MResponseMatrixON& R)
   if (*this == R) {
     if (m_IsSparse == false) {
       if (R.m_IsSparse == true) {
+        R.MergePendingSparse();
         for (unsigned long i = 0; i < R.m_BinsSparse.size(); ++i) {
           m_Values[R.m_BinsSparse[i]] += R.m_ValuesSparse[i];
         }
@@ -346,6 +354,7 @@ MResponseMatrixON& MResponseMatrixON::operator+=(const MResponseMatrixON& R)
       }
     } else {
       if (R.m_IsSparse == true) {
+        R.MergePendingSparse();
         for (unsigned long i = 0; i < R.m_BinsSparse.size(); ++i) {
           Add(R.m_BinsSparse[i], R.m_ValuesSparse[i]);
         }
@@ -375,6 +384,7 @@ MResponseMatrixON& MResponseMatrixON::operator-=(const MResponseMatrixON& R)
   if (*this == R) {
     if (m_IsSparse == false) {
       if (R.m_IsSparse == true) {
+        R.MergePendingSparse();
         for (unsigned long i = 0; i < R.m_BinsSparse.size(); ++i) {
           m_Values[R.m_BinsSparse[i]] -= R.m_ValuesSparse[i];
         }
@@ -385,6 +395,7 @@ MResponseMatrixON& MResponseMatrixON::operator-=(const MResponseMatrixON& R)
       }
     } else {
       if (R.m_IsSparse == true) {
+        R.MergePendingSparse();
         for (unsigned long i = 0; i < R.m_BinsSparse.size(); ++i) {
           Add(R.m_BinsSparse[i], -R.m_ValuesSparse[i]);
         }
@@ -423,6 +434,7 @@ MResponseMatrixON& MResponseMatrixON::operator/=(const MResponseMatrixON& R)
       }
     } else {
       // We just need to loop over the non-zeroes here
+      MergePendingSparse();
       for (unsigned long i = 0; i < m_BinsSparse.size(); ++i) {
         float RValue = R.Get(m_BinsSparse[i]); // R maybe sparse or not...
         if (RValue != 0) {
@@ -505,6 +517,7 @@ MResponseMatrixON& MResponseMatrixON::operator*=(const float& Value)
       m_Values[i] *= Value;
     }
   } else {
+    MergePendingSparse();
     for (unsigned long i = 0; i < m_BinsSparse.size(); ++i) {
       m_ValuesSparse[i] *= Value;
     }
@@ -534,6 +547,7 @@ MResponseMatrixON& MResponseMatrixON::operator/=(const float& Value)
       m_Values[i] /= Value;
     }
   } else {
+    MergePendingSparse();
     for (unsigned long i = 0; i < m_BinsSparse.size(); ++i) {
       m_ValuesSparse[i] /= Value;
     }
@@ -565,6 +579,7 @@ MResponseMatrixON MResponseMatrixON::Collapse(vector<bool> Collapse)
   // Loop over all bins
   vector<unsigned long> NewBin(New.m_NumberOfAxes);
   if (m_IsSparse == true) {
+    MergePendingSparse();
     for (unsigned long b = 0; b < m_BinsSparse.size(); ++b) {
 	    vector<unsigned long> OldBin = FindBins(m_BinsSparse[b]);
       unsigned int nb = 0;
@@ -653,6 +668,8 @@ vector<unsigned long> MResponseMatrixON::FindBins(unsigned long Bin) const
 //! Find the axes bins corresponding to the sparse Bin
 vector<unsigned long> MResponseMatrixON::FindBinsSparse(unsigned long SparseBin) const
 {
+  MergePendingSparse();
+  
   if (SparseBin < m_BinsSparse.size()) {
     return FindBins(m_BinsSparse[SparseBin]);
   } else {
@@ -829,6 +846,8 @@ void MResponseMatrixON::Set(unsigned long Bin, float Value)
   if (m_IsSparse == false) {
     m_Values[Bin] = Value;
   } else {
+    MergePendingSparse();
+    
     // Find the position in the sparse array which is greater or equal to Bin
     auto IterBins = lower_bound(m_BinsSparse.begin(), m_BinsSparse.end(), Bin);
     // Find the same position in the values vector
@@ -893,23 +912,19 @@ void MResponseMatrixON::Add(vector<double> X, float Value)
 
 //! Add to the content of a specific bin -- directly without error checks
 //! Logic: a1 + S1*a2 + S1*S2*a3 + S1*S2*S3*a4 + ....  
+//! In sparse mode the addition is only buffered, and merged in batches into the sorted arrays
 void MResponseMatrixON::Add(unsigned long Bin, float Value) 
 { 
   if (m_IsSparse == false) {
     m_Values[Bin] += Value;
   } else {
-    // Find the position in the sparse array which is greater or equal to Bin
-    auto IterBins = lower_bound(m_BinsSparse.begin(), m_BinsSparse.end(), Bin);
-    // Find the same position in the values vector
-    auto IterValues = m_ValuesSparse.begin();
-    advance(IterValues, distance(m_BinsSparse.begin(), IterBins));
+    m_PendingSparse.emplace_back(Bin, Value);
     
-    // If we have already an entry add, otherwise insert another entry sorted.
-    if (IterBins != m_BinsSparse.cend() && *IterBins == Bin) {
-      (*IterValues) += Value;
-    } else {
-      m_BinsSparse.insert(IterBins, Bin);
-      m_ValuesSparse.insert(IterValues, Value);
+    // Merge when the buffer becomes a sizable fraction of the sorted arrays - this keeps the amortized cost per addition constant
+    unsigned long Threshold = m_BinsSparse.size()/4;
+    if (Threshold < c_MinimumPendingSparse) Threshold = c_MinimumPendingSparse;
+    if (m_PendingSparse.size() >= Threshold) {
+      MergePendingSparse();
     }
   }
 }
@@ -937,6 +952,8 @@ void MResponseMatrixON::Add(vector<unsigned long> Bins, vector<float> Values)
 //! Set the content of a sparse bin
 void MResponseMatrixON::SetSparse(unsigned long SparseBin, float Value)
 {
+  MergePendingSparse();
+  
   if (m_IsSparse == true && SparseBin < m_BinsSparse.size()) {
     m_ValuesSparse[SparseBin] = Value;
   } else {
@@ -951,6 +968,8 @@ void MResponseMatrixON::SetSparse(unsigned long SparseBin, float Value)
 //! Add to the content of a sparse bin
 void MResponseMatrixON::AddSparse(unsigned long SparseBin, float Value)
 {
+  MergePendingSparse();
+  
   if (m_IsSparse == true && SparseBin < m_BinsSparse.size()) {
     m_ValuesSparse[SparseBin] += Value;
   } else {
@@ -989,6 +1008,8 @@ float MResponseMatrixON::Get(unsigned long Bin) const
   if (m_IsSparse == false) {
     return m_Values[Bin];
   } else {
+    MergePendingSparse();
+    
     // Find the position in the sparse array which is greater or equal to Bin
     auto IterBins = lower_bound(m_BinsSparse.cbegin(), m_BinsSparse.cend(), Bin);
     
@@ -1129,6 +1150,8 @@ float MResponseMatrixON::Get(vector<double> X) const
 //! Add to the content of a sparse bin
 float MResponseMatrixON::GetSparse(unsigned long SparseBin) const
 {
+  MergePendingSparse();
+  
   if (m_IsSparse == true && SparseBin < m_BinsSparse.size()) {
     return m_ValuesSparse[SparseBin];
   }
@@ -1180,6 +1203,7 @@ float MResponseMatrixON::GetMaximum() const
       }
     }
   } else {
+    MergePendingSparse();
     Max = 0;
     for (unsigned long i = 0; i < m_ValuesSparse.size(); ++i) {
       if (m_ValuesSparse[i] > Max) {
@@ -1208,6 +1232,7 @@ float MResponseMatrixON::GetMinimum() const
       }
     }
   } else {
+    MergePendingSparse();
     Min = 0;
     for (unsigned long i = 0; i < m_ValuesSparse.size(); ++i) {
       if (m_ValuesSparse[i] < Min) {
@@ -1234,6 +1259,7 @@ double MResponseMatrixON::GetSum() const
       Sum += m_Values[i];
     }
   } else {
+    MergePendingSparse();
     for (unsigned long i = 0; i < m_ValuesSparse.size(); ++i) {
       Sum += m_ValuesSparse[i];
     } 
@@ -1245,9 +1271,57 @@ double MResponseMatrixON::GetSum() const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Merge the buffered sparse additions into the sorted sparse arrays
+void MResponseMatrixON::MergePendingSparse() const
+{
+  if (m_PendingSparse.empty() == true) return;
+  
+  // Sort the additions by bin - stable to keep the order of the additions to the same bin, 
+  // thus the sums are bit-identical to adding them one by one
+  stable_sort(m_PendingSparse.begin(), m_PendingSparse.end(), [](const pair<unsigned long, float>& A, const pair<unsigned long, float>& B) { return A.first < B.first; } );
+  
+  // Merge both sorted lists in one linear pass
+  vector<unsigned long> MergedBins;
+  MergedBins.reserve(m_BinsSparse.size() + m_PendingSparse.size());
+  vector<float> MergedValues;
+  MergedValues.reserve(m_BinsSparse.size() + m_PendingSparse.size());
+  
+  unsigned long s = 0;
+  unsigned long p = 0;
+  while (s < m_BinsSparse.size() || p < m_PendingSparse.size()) {
+    unsigned long Bin = 0;
+    float Value = 0;
+    if (p == m_PendingSparse.size() || (s < m_BinsSparse.size() && m_BinsSparse[s] <= m_PendingSparse[p].first)) {
+      Bin = m_BinsSparse[s];
+      Value = m_ValuesSparse[s];
+      ++s;
+    } else {
+      Bin = m_PendingSparse[p].first;
+      Value = m_PendingSparse[p].second;
+      ++p;
+    }
+    while (p < m_PendingSparse.size() && m_PendingSparse[p].first == Bin) {
+      Value += m_PendingSparse[p].second;
+      ++p;
+    }
+    MergedBins.push_back(Bin);
+    MergedValues.push_back(Value);
+  }
+  
+  m_BinsSparse.swap(MergedBins);
+  m_ValuesSparse.swap(MergedValues);
+  m_PendingSparse.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Sort the sparse matrix
 void MResponseMatrixON::SortSparse()
 {
+  MergePendingSparse();
+  
   // Create a sort permutation:
   vector<unsigned long> Permutation(m_BinsSparse.size());
   iota(Permutation.begin(), Permutation.end(), 0);
@@ -1373,6 +1447,7 @@ bool MResponseMatrixON::ReadSpecific(MFileResponse& Parser,
             m_Values.clear();
             m_ValuesSparse.clear();
             m_BinsSparse.clear();
+            m_PendingSparse.clear();
             
             unsigned long StreamSize = T.GetTokenAtAsLong(1);
 
@@ -1420,6 +1495,7 @@ bool MResponseMatrixON::ReadSpecific(MFileResponse& Parser,
         m_Values.clear();
         m_ValuesSparse.clear();
         m_BinsSparse.clear();
+        m_PendingSparse.clear();
         
         // Keep this for debugging parallel mode
         bool Parallel = false;
@@ -1655,6 +1731,8 @@ bool MResponseMatrixON::Write(MString FileName, bool Stream)
     s<<"Type ResponseMatrixONSparse"<<endl;
     s<<endl;
     
+    MergePendingSparse();
+    
     bool IsParallel = false;
 
     if (IsParallel == false) {
@@ -2022,6 +2100,7 @@ MString MResponseMatrixON::GetStatistics() const
       }
     }
   } else {
+    MergePendingSparse();
     for (unsigned long i = 0; i < m_ValuesSparse.size(); ++i) {
       Sum += m_ValuesSparse[i];
       if (m_ValuesSparse[i] > Max) {
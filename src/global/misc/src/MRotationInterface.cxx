@@ -331,6 +331,30 @@ void MRotationInterface::Stream(ostringstream& S) const
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void MRotationInterface::Stream(MString& S) const
+{
+  if (m_HasGalacticPointing == true) {
+    double phi = m_GalacticPointingXAxis.Phi()*c_Deg;
+    while (phi < 0.0) phi += 360.0;
+    S += "GX "; S.AppendGeneral(phi); S += ' '; S.AppendGeneral(m_GalacticPointingXAxis.Theta()*c_Deg - 90); S += '\n';
+    phi = m_GalacticPointingZAxis.Phi()*c_Deg;
+    while (phi < 0.0) phi += 360.0;
+    S += "GZ "; S.AppendGeneral(phi); S += ' '; S.AppendGeneral(m_GalacticPointingZAxis.Theta()*c_Deg - 90); S += '\n';
+  } 
+  if (m_HasDetectorRotation == true) {
+    S += "RX "; S.AppendGeneral(m_DetectorRotationXAxis.X()); S += ' '; S.AppendGeneral(m_DetectorRotationXAxis.Y()); S += ' '; S.AppendGeneral(m_DetectorRotationXAxis.Z()); S += '\n';
+    S += "RZ "; S.AppendGeneral(m_DetectorRotationZAxis.X()); S += ' '; S.AppendGeneral(m_DetectorRotationZAxis.Y()); S += ' '; S.AppendGeneral(m_DetectorRotationZAxis.Z()); S += '\n';
+  }
+  if (m_HasHorizonPointing == true) {
+    S += "HX "; S.AppendGeneral(m_HorizonPointingXAxis.Phi()*c_Deg); S += ' '; S.AppendGeneral(90 - m_HorizonPointingXAxis.Theta()*c_Deg); S += '\n';
+    S += "HZ "; S.AppendGeneral(m_HorizonPointingZAxis.Phi()*c_Deg); S += ' '; S.AppendGeneral(90 - m_HorizonPointingZAxis.Theta()*c_Deg); S += '\n';
+  }  
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MRotationInterface::Validate()
 {
   //! Check if the data is OK
@@ -32,6 +32,8 @@
 #include <limits>
 #include <locale>
 #include <iomanip>
+#include <charconv>
+#include <system_error>
 using namespace std;
 
 // ROOT libs:
@@ -501,5 +503,123 @@ MString& MString::Format(const char* Format, ...)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Append the formatted characters right aligned in a field of the given width, like setw
+static inline void AppendAligned(string& String, const char* Begin, const char* End, int Width)
+{
+  int Length = End - Begin;
+  if (Width > Length) {
+    String.append(Width - Length, ' ');
+  }
+  String.append(Begin, Length);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Append a floating point number via to_chars, or via snprintf if it does not fit into the buffer
+//! or if the library does not provide floating point to_chars (e.g. gcc < 11, macOS < 13.3)
+//! PrintfFormat is one of "%.*f", "%.*e", "%.*g"
+static inline void AppendFloatingPoint(string& String, double Value, const char* PrintfFormat, int Precision, int Width)
+{
+  char Buffer[512];
+#if defined(__cpp_lib_to_chars)
+  chars_format Format = chars_format::general;
+  if (PrintfFormat[3] == 'f') {
+    Format = chars_format::fixed;
+  } else if (PrintfFormat[3] == 'e') {
+    Format = chars_format::scientific;
+  }
+  to_chars_result Result = to_chars(Buffer, Buffer + sizeof(Buffer), Value, Format, Precision);
+  if (Result.ec == errc()) {
+    AppendAligned(String, Buffer, Result.ptr, Width);
+    return;
+  }
+#endif
+  int Length = snprintf(Buffer, sizeof(Buffer), PrintfFormat, Precision, Value);
+  if (Length < int(sizeof(Buffer))) {
+    AppendAligned(String, Buffer, Buffer + Length, Width);
+  } else {
+    vector<char> Large(Length + 1);
+    snprintf(Large.data(), Large.size(), PrintfFormat, Precision, Value);
+    AppendAligned(String, Large.data(), Large.data() + Length, Width);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString& MString::AppendInteger(long long Value, int Width)
+{
+  //! Append an integer, like ostream<<setw(Width)<<Value
+
+  char Buffer[24];
+  to_chars_result Result = to_chars(Buffer, Buffer + sizeof(Buffer), Value);
+  AppendAligned(m_String, Buffer, Result.ptr, Width);
+
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString& MString::AppendInteger(unsigned long long Value, int Width)
+{
+  //! Append an unsigned integer, like ostream<<setw(Width)<<Value
+
+  char Buffer[24];
+  to_chars_result Result = to_chars(Buffer, Buffer + sizeof(Buffer), Value);
+  AppendAligned(m_String, Buffer, Result.ptr, Width);
+
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString& MString::AppendFixed(double Value, int Precision, int Width)
+{
+  //! Append a floating point number, like ostream<<fixed<<setprecision(Precision)<<setw(Width)<<Value
+
+  AppendFloatingPoint(m_String, Value, "%.*f", Precision, Width);
+
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString& MString::AppendScientific(double Value, int Precision, int Width)
+{
+  //! Append a floating point number, like ostream<<scientific<<setprecision(Precision)<<setw(Width)<<Value
+
+  AppendFloatingPoint(m_String, Value, "%.*e", Precision, Width);
+
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString& MString::AppendGeneral(double Value, int Precision, int Width)
+{
+  //! Append a floating point number in the default ostream notation, like ostream<<setprecision(Precision)<<setw(Width)<<Value
+
+  // ostream uses a precision of 1 if it is 0
+  if (Precision == 0) Precision = 1;
+  AppendFloatingPoint(m_String, Value, "%.*g", Precision, Width);
+
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 // MString.cxx: the end...
 ////////////////////////////////////////////////////////////////////////////////
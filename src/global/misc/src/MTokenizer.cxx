@@ -703,7 +703,7 @@ bool MTokenizer::IsComposited() const
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool MTokenizer::AnalyzeFast(MString Text)
+bool MTokenizer::AnalyzeFast(const MString& Text)
 {
   // Split the Text into its tokens
 
@@ -45,6 +45,9 @@ public:
   //! Set all parameters
   virtual void Set(double LearningRate, double Momentum, int NValues = 1, int NErrors = 1);
   
+  //! Return the learning rate
+  double GetLearningRate() const { return m_LearningRate; }
+  
   //! Learn
   virtual void Learn(int Mode = 0);
   //! Compute the error
@@ -43,6 +43,11 @@ public:
   //! Set the weight
   virtual void SetWeight(double Delta);
   
+  //! Return the last weight change (without momentum term)
+  double GetDelta() const { return m_Delta; }
+  //! Directly set the weight and the last weight change, e.g. after a dense mini-batch update
+  void SetWeightAndDelta(double Weight, double Delta) { m_Weight = Weight; m_Delta = Delta; }
+  
   //! Stream from the file
   virtual bool Stream(MFile& S, const int Version, const bool Read);
   //! Parse an individual line
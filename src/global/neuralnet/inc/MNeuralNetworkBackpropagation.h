@@ -18,6 +18,7 @@
 
 // Standard libs:
 #include <vector>
+#include <functional>
 using namespace std;
 
 // ROOT libs:
@@ -27,6 +28,7 @@ using namespace std;
 #include "MStreams.h"
 #include "MInputNeuron.h"
 #include "MNeuralNetwork.h"
+#include "MNeuralNetworkIO.h"
 #include "MBackpropagationMiddleNeuron.h"
 #include "MBackpropagationOutputNeuron.h"
 #include "MBackpropagationSynapse.h"
@@ -56,6 +58,15 @@ public:
   //! Create the neural network layout
   virtual bool Create();
   
+  //! Learn all samples in mini batches of BatchSize samples (the samples are not shuffled):
+  //! The weights are copied into dense matrices, the gradients of the samples of a batch are computed
+  //! in NThreads threads (0 means as many as there are cores), summed - thus the learning rate keeps its per-sample meaning -
+  //! and applied with the learning rate and momentum of the neurons. Afterwards the weights are copied back into the synapses.
+  //! With a batch size of one this is the same as SetInput - Run - SetOutputError - Learn per sample,
+  //! except that the error of the middle layer is computed with the weights before the update
+  //! Returns false if the samples do not fit the network or the network is not a three-layer network
+  bool LearnBatches(const vector<MNeuralNetworkIO>& Samples, unsigned int BatchSize = 32, unsigned int NThreads = 0);
+  
   //! Read/Write the data to file
   virtual bool Stream(const bool Read);
   
@@ -69,6 +80,10 @@ protected:
   
   // private methods:
 private:
+  //! Return the number of threads to use for a batch of NSamples samples
+  unsigned int GetNLearningThreads(unsigned int NThreads, unsigned int NSamples);
+  //! Run the function for the sample ranges [Start, Stop[ of a batch in NThreads threads with the thread ID as last argument
+  void RunLearningThreads(unsigned int NThreads, unsigned int NSamples, const function<void(unsigned int, unsigned int, unsigned int)>& Function);
   
   
   
@@ -82,6 +97,8 @@ protected:
   
   // private members:
 private:
+  //! The minimum number of samples of a batch per learning thread
+  static const unsigned int c_MinimumSamplesPerThread = 8;
   
   
   #ifdef ___CLING___
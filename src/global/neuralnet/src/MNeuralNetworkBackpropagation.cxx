@@ -27,6 +27,10 @@
 #include "MNeuralNetworkBackpropagation.h"
 
 // Standard libs:
+#include <cmath>
+#include <algorithm>
+#include <thread>
+using namespace std;
 
 // ROOT libs:
 
@@ -195,6 +199,249 @@ bool MNeuralNetworkBackpropagation::Create()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+unsigned int MNeuralNetworkBackpropagation::GetNLearningThreads(unsigned int NThreads, unsigned int NSamples)
+{
+  // Return the number of threads to use for a batch of NSamples samples
+
+  if (NThreads == 0) {
+    NThreads = thread::hardware_concurrency();
+    if (NThreads == 0) NThreads = 1;
+  }
+  unsigned int MaximumThreads = NSamples / c_MinimumSamplesPerThread;
+  if (NThreads > MaximumThreads) NThreads = MaximumThreads;
+  if (NThreads == 0) NThreads = 1;
+
+  return NThreads;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MNeuralNetworkBackpropagation::RunLearningThreads(unsigned int NThreads, unsigned int NSamples, const function<void(unsigned int, unsigned int, unsigned int)>& Function)
+{
+  // Run the function for the sample ranges [Start, Stop[ of a batch in NThreads threads
+  // The calling thread processes the first range itself
+
+  if (NThreads == 1) {
+    Function(0, NSamples, 0);
+    return;
+  }
+
+  vector<thread> Threads;
+  unsigned int SamplesPerThread = (NSamples + NThreads - 1) / NThreads;
+  for (unsigned int t = 1; t < NThreads; ++t) {
+    unsigned int Start = t*SamplesPerThread;
+    unsigned int Stop = min(NSamples, Start + SamplesPerThread);
+    if (Start >= Stop) break;
+    Threads.emplace_back(Function, Start, Stop, t);
+  }
+  Function(0, min(NSamples, SamplesPerThread), 0);
+
+  for (thread& T: Threads) T.join();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MNeuralNetworkBackpropagation::LearnBatches(const vector<MNeuralNetworkIO>& Samples, unsigned int BatchSize, unsigned int NThreads)
+{
+  //! Learn all samples in mini batches of BatchSize samples with dense matrices in several threads
+
+  if (m_IsCreated == false) {
+    merr<<"The neural network has not been created!"<<show;
+    return false;
+  }
+  if (Samples.size() == 0) return true;
+  if (BatchSize == 0) BatchSize = 1;
+
+  unsigned int NI = m_InputNodes.size();
+  unsigned int NM = m_MiddleNodes.size();
+  unsigned int NO = m_OutputNodes.size();
+
+  // Copy the samples into dense matrices - with the same checks as SetInput and SetOutputError
+  unsigned int NSamples = Samples.size();
+  vector<double> Inputs(NSamples*NI);
+  vector<double> Targets(NSamples*NO);
+  for (unsigned int s = 0; s < NSamples; ++s) {
+    if (Samples[s].GetNInputs() != NI || Samples[s].GetNOutputs() != NO) {
+      merr<<"Sample "<<s<<": Input/output node number not equal: Store="<<Samples[s].GetNInputs()<<"/"<<Samples[s].GetNOutputs()
+          <<", NN="<<NI<<"/"<<NO<<show;
+      return false;
+    }
+    for (unsigned int i = 0; i < NI; ++i) {
+      double Value = Samples[s].GetInput(i);
+      if (Value <= 0 || Value >= 1.0) {
+        merr<<"Sample "<<s<<": Input node "<<i<<"/"<<NI<<": value out of range: "<<Value<<"! Needs to be ]0..1["<<show;
+        return false;
+      }
+      Inputs[s*NI + i] = Value;
+    }
+    for (unsigned int o = 0; o < NO; ++o) {
+      Targets[s*NO + o] = Samples[s].GetOutput(o);
+    }
+  }
+
+  // Copy the synapses into dense weight matrices: row = receiving neuron, column = sending neuron
+  // Missing synapses are kept at zero weight and never updated
+  vector<MBackpropagationSynapse*> SynapsesIM(NM*NI, nullptr);
+  vector<MBackpropagationSynapse*> SynapsesMO(NO*NM, nullptr);
+  for (MSynapse* Synapse: m_Synapses) {
+    MBackpropagationSynapse* S = dynamic_cast<MBackpropagationSynapse*>(Synapse);
+    if (S == nullptr) {
+      merr<<"The network contains a synapse which is not a back-propagation synapse!"<<show;
+      return false;
+    }
+    unsigned int In = find(m_InputNodes.begin(), m_InputNodes.end(), S->GetInNeuron()) - m_InputNodes.begin();
+    unsigned int Middle = find(m_MiddleNodes.begin(), m_MiddleNodes.end(), S->GetOutNeuron()) - m_MiddleNodes.begin();
+    if (In < NI && Middle < NM) {
+      SynapsesIM[Middle*NI + In] = S;
+      continue;
+    }
+    Middle = find(m_MiddleNodes.begin(), m_MiddleNodes.end(), S->GetInNeuron()) - m_MiddleNodes.begin();
+    unsigned int Out = find(m_OutputNodes.begin(), m_OutputNodes.end(), S->GetOutNeuron()) - m_OutputNodes.begin();
+    if (Middle < NM && Out < NO) {
+      SynapsesMO[Out*NM + Middle] = S;
+      continue;
+    }
+    merr<<"Synapse "<<S->GetID()<<" does not connect input to middle or middle to output nodes!"<<show;
+    return false;
+  }
+
+  vector<double> WeightsIM(NM*NI, 0.0);
+  vector<double> DeltasIM(NM*NI, 0.0);
+  for (unsigned int w = 0; w < NM*NI; ++w) {
+    if (SynapsesIM[w] == nullptr) continue;
+    WeightsIM[w] = SynapsesIM[w]->GetWeight();
+    DeltasIM[w] = SynapsesIM[w]->GetDelta();
+  }
+  vector<double> WeightsMO(NO*NM, 0.0);
+  vector<double> DeltasMO(NO*NM, 0.0);
+  for (unsigned int w = 0; w < NO*NM; ++w) {
+    if (SynapsesMO[w] == nullptr) continue;
+    WeightsMO[w] = SynapsesMO[w]->GetWeight();
+    DeltasMO[w] = SynapsesMO[w]->GetDelta();
+  }
+
+  // The learning rate and momentum are the ones of the receiving neuron as in MBackpropagationOutputNeuron::Learn
+  vector<double> LearningRatesM(NM, m_LearningRate);
+  vector<double> MomentaM(NM, m_Momentum);
+  for (unsigned int m = 0; m < NM; ++m) {
+    MBackpropagationOutputNeuron* N = dynamic_cast<MBackpropagationOutputNeuron*>(m_MiddleNodes[m]);
+    if (N != nullptr) LearningRatesM[m] = N->GetLearningRate();
+    MomentaM[m] = m_MiddleNodes[m]->GetMomentum();
+  }
+  vector<double> LearningRatesO(NO, m_LearningRate);
+  vector<double> MomentaO(NO, m_Momentum);
+  for (unsigned int o = 0; o < NO; ++o) {
+    MBackpropagationOutputNeuron* N = dynamic_cast<MBackpropagationOutputNeuron*>(m_OutputNodes[o]);
+    if (N != nullptr) LearningRatesO[o] = N->GetLearningRate();
+    MomentaO[o] = m_OutputNodes[o]->GetMomentum();
+  }
+
+  // Each thread accumulates the gradients of its samples in its own matrices
+  unsigned int MaxThreads = GetNLearningThreads(NThreads, BatchSize);
+  vector<vector<double>> GradientsIM(MaxThreads, vector<double>(NM*NI));
+  vector<vector<double>> GradientsMO(MaxThreads, vector<double>(NO*NM));
+
+  auto Backpropagate = [&](unsigned int First, unsigned int Start, unsigned int Stop, unsigned int ThreadID) {
+    vector<double>& GradientIM = GradientsIM[ThreadID];
+    vector<double>& GradientMO = GradientsMO[ThreadID];
+
+    vector<double> Middle(NM);
+    vector<double> ErrorsM(NM);
+    vector<double> ErrorsO(NO);
+    for (unsigned int s = First + Start; s < First + Stop; ++s) {
+      const double* X = &Inputs[s*NI];
+      const double* T = &Targets[s*NO];
+
+      // Forward pass with the sigmoid of MBackpropagationNeuron::TransferFunction
+      for (unsigned int m = 0; m < NM; ++m) {
+        const double* W = &WeightsIM[m*NI];
+        double Sum = 0.0;
+        for (unsigned int i = 0; i < NI; ++i) Sum += W[i]*X[i];
+        Middle[m] = 1.0/(1.0+exp(-Sum));
+      }
+      for (unsigned int o = 0; o < NO; ++o) {
+        const double* W = &WeightsMO[o*NM];
+        double Sum = 0.0;
+        for (unsigned int m = 0; m < NM; ++m) Sum += W[m]*Middle[m];
+        double Out = 1.0/(1.0+exp(-Sum));
+        ErrorsO[o] = Out*(1.0-Out)*(T[o]-Out);
+      }
+
+      // Backward pass as in the ComputeError of the output and middle neurons
+      fill(ErrorsM.begin(), ErrorsM.end(), 0.0);
+      for (unsigned int o = 0; o < NO; ++o) {
+        const double* W = &WeightsMO[o*NM];
+        double* G = &GradientMO[o*NM];
+        for (unsigned int m = 0; m < NM; ++m) {
+          ErrorsM[m] += W[m]*ErrorsO[o];
+          G[m] += ErrorsO[o]*Middle[m];
+        }
+      }
+      for (unsigned int m = 0; m < NM; ++m) {
+        double Error = Middle[m]*(1.0-Middle[m])*ErrorsM[m];
+        double* G = &GradientIM[m*NI];
+        for (unsigned int i = 0; i < NI; ++i) G[i] += Error*X[i];
+      }
+    }
+  };
+
+  for (unsigned int First = 0; First < NSamples; First += BatchSize) {
+    unsigned int NBatch = min(BatchSize, NSamples - First);
+    unsigned int NBatchThreads = GetNLearningThreads(NThreads, NBatch);
+    for (unsigned int t = 0; t < NBatchThreads; ++t) {
+      fill(GradientsIM[t].begin(), GradientsIM[t].end(), 0.0);
+      fill(GradientsMO[t].begin(), GradientsMO[t].end(), 0.0);
+    }
+    RunLearningThreads(NBatchThreads, NBatch, [&](unsigned int Start, unsigned int Stop, unsigned int ThreadID) {
+      Backpropagate(First, Start, Stop, ThreadID);
+    });
+
+    // Reduce in a fixed order and apply the summed gradient as in MBackpropagationSynapse::SetWeight
+    for (unsigned int m = 0; m < NM; ++m) {
+      for (unsigned int i = 0; i < NI; ++i) {
+        unsigned int w = m*NI + i;
+        if (SynapsesIM[w] == nullptr) continue;
+        double Gradient = 0.0;
+        for (unsigned int t = 0; t < NBatchThreads; ++t) Gradient += GradientsIM[t][w];
+        double Delta = LearningRatesM[m]*Gradient;
+        WeightsIM[w] += Delta + MomentaM[m]*DeltasIM[w];
+        DeltasIM[w] = Delta;
+      }
+    }
+    for (unsigned int o = 0; o < NO; ++o) {
+      for (unsigned int m = 0; m < NM; ++m) {
+        unsigned int w = o*NM + m;
+        if (SynapsesMO[w] == nullptr) continue;
+        double Gradient = 0.0;
+        for (unsigned int t = 0; t < NBatchThreads; ++t) Gradient += GradientsMO[t][w];
+        double Delta = LearningRatesO[o]*Gradient;
+        WeightsMO[w] += Delta + MomentaO[o]*DeltasMO[w];
+        DeltasMO[w] = Delta;
+      }
+    }
+  }
+
+  // Copy the weights back into the synapses, thus streaming and the single-sample interface continue to work
+  for (unsigned int w = 0; w < NM*NI; ++w) {
+    if (SynapsesIM[w] != nullptr) SynapsesIM[w]->SetWeightAndDelta(WeightsIM[w], DeltasIM[w]);
+  }
+  for (unsigned int w = 0; w < NO*NM; ++w) {
+    if (SynapsesMO[w] != nullptr) SynapsesMO[w]->SetWeightAndDelta(WeightsMO[w], DeltasMO[w]);
+  }
+
+  m_NLearningRuns += NSamples;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MNeuralNetworkBackpropagation::Stream(const bool Read)
 {
   // Hopefully a faster way to stream data from and to a file than ROOT...
@@ -20,7 +20,7 @@
 #include <vector>
 #include <random>
 #include <mutex>
-#include <condition_variable>
+#include <atomic>
 using namespace std;
 
 // ROOT libs:
@@ -88,6 +88,17 @@ class MARMFitter
   //! If this is set we use an unbinned-likelihood fit
   void UseBinnedFitting(bool DoIt = true) { m_UnbinnedFitting = !DoIt; }
 
+  //! If this is set the bootstrap samples are drawn from the ARM histogram via multinomial draws
+  //! instead of resampling the individual ARM values. This implies binned fitting.
+  void UseBinnedBootstrapping(bool DoIt = true) { m_BinnedBootstrapping = DoIt; }
+
+  //! Set the seed of the bootstrap random streams - the same seed gives the same samples independent of the number of threads
+  //! By default the seed is random
+  void SetRandomSeed(unsigned int Seed) { m_RandomSeed = Seed; }
+
+  //! Set the number of threads used for the bootstrap fits, 0 means the number of cores
+  void SetNumberOfThreads(unsigned int NumberOfThreads = 0);
+
   //! Get a list of all fit functions:
   vector<MARMFitFunctionID> GetListOfFitFunctions() const;
 
@@ -191,10 +202,18 @@ class MARMFitter
   bool OptimizeBinning();
   //! Perform a single fit
   bool PerformFit(unsigned int FitID, vector<double>& ARMValues);
-  //! Thread entry for parallel fitting
-  void ParallelFitting(int id, condition_variable& CV);
-  //! Bootstrap the ARM values and return them as vector
-  vector<double> BootstrapARMValues();
+  //! Perform a single binned fit of the bin counts over [-MaxARM, MaxARM]
+  bool PerformBinnedFit(unsigned int FitID, const vector<double>& BinCounts);
+  //! Store the results of fit FitID
+  void StoreFitResults(unsigned int FitID, ROOT::Fit::Fitter& Fitter, TF1* FitFunction);
+  //! Histogram the ARM values into m_NumberOfBins bins over [-MaxARM, MaxARM]
+  void BinARMValues(const vector<double>& ARMValues, vector<double>& BinCounts) const;
+  //! Thread entry of the worker pool: perform fits until all fits are done
+  void ParallelFitting(atomic<unsigned int>& NextFitID, unsigned int NumberOfFits);
+  //! Bootstrap the ARM values into ARMValues using the given random stream
+  void BootstrapARMValues(mt19937& RandomStream, vector<double>& ARMValues) const;
+  //! Bootstrap the ARM histogram into BinCounts via multinomial draws using the given random stream
+  void BootstrapBinCounts(mt19937& RandomStream, vector<double>& BinCounts) const;
   //! Calculate the average metrics from boot strapping (FWHM & uncertainty)
   void CalculateBootStrappedMetrics();
   //! Calculate the metrics of the ARM (containment etc.)
@@ -248,12 +267,16 @@ class MARMFitter
   bool m_OptimizeBinning;
   //! Use unbinned fitting
   bool m_UnbinnedFitting;
+  //! Use binned bootstrapping
+  bool m_BinnedBootstrapping;
 
-  //! Random device
-  std::mt19937 m_MersenneTwister;
+  //! The seed of the random streams - each bootstrap fit has its own stream seeded with the seed and the fit ID
+  unsigned int m_RandomSeed;
 
   //! Store for the ARM values
   vector<double> m_OriginalARMValues;
+  //! The histogram of the original ARM values (binned bootstrapping only)
+  vector<double> m_OriginalBinCounts;
 
   //! The boot-strapped FWHM samples
   vector<double> m_BootStrappedFWHMSamples;
@@ -262,10 +285,8 @@ class MARMFitter
   //! The boot-strapped Baker-Cousins-Likelihood ratio values:
   vector<double> m_BootStrappedBakerCousins;
 
-  //! The maximum number of allowed threads
+  //! The number of threads in the worker pool
   unsigned int m_MaximumNumberOfThreads;
-  //! The number of currently running threads
-  unsigned int m_NumberOfRunningThreads;
   //! The global mutex
   std::mutex m_Mutex;
 
@@ -64,6 +64,8 @@ class MBPData
   static const int c_SparseImage       = 3;
   //! Reponse splice as a sparse array of 8bit values plus maximum
   static const int c_SparseImageOneBit = 4;
+  //! Reponse splice compressed per event: dense, occupancy bit mask, or delta-encoded runs of 1 or 4 byte values
+  static const int c_Compressed        = 5;
 
   // protected members:
  protected:
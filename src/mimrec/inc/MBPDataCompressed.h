@@ -0,0 +1,110 @@
+/*
+ * MBPDataCompressed.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MBPDataCompressed__
+#define __MBPDataCompressed__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstdint>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MBPData.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A backprojected event stored in the most compact of three representations, chosen per event:
+//! dense (all bins), an occupancy bit mask plus the used values, or runs of consecutive bins
+//! whose gaps and lengths are variable-length encoded plus the used values.
+//! All representations are decoded into runs of consecutive bins, which are processed in tight loops.
+class MBPDataCompressed : public MBPData
+{
+  // Public Interface:
+ public:
+  //! Default constructor - the values are stored as one byte relative to the maximum or as floats
+  MBPDataCompressed(bool OneByte = true);
+  //! Default destructor
+  ~MBPDataCompressed();
+
+  //! Initialize the store --- returns false in case we are out of memory
+  //! This has to be the first function to be called
+  //! For performance reasons, there are NO checks later if the arrays are initialized!
+  virtual bool Initialize(double* Image, int* Bins, int NBins, int NUsedBins, double Maximum);
+
+  //! Perform the list-mode deconvolution - attention the InvYnew is the inverted Yi
+  void Deconvolve(double* Expectation, double* InvYnew, int Event);
+  //! Perform the list-mode convolution
+  void Convolve(double* Ynew, int Event, double* Image, int NBins);
+  //! Just sum it up, i.e. add the content to the image
+  void Sum(double* Image, int NBins);
+
+  //! Return the number of bytes used by this image
+  virtual int GetUsedBytes() const;
+
+  //! Return the number of used bins
+  virtual int GetUsedBins() const { return m_NEntries; }
+
+  //! Return the chosen representation
+  int GetRepresentation() const { return m_Representation; }
+
+  // The representations:
+  //! All bins are stored
+  static const int c_Dense = 0;
+  //! One bit per bin marks the stored bins
+  static const int c_Mask = 1;
+  //! Runs of consecutive bins: gap to the previous run and length, both variable-length encoded
+  static const int c_Runs = 2;
+
+  // protected methods:
+ protected:
+  //! Call Operation(first bin, number of bins, index of the first value) for all runs of consecutive stored bins
+  template<class Operation> void ForEachRun(Operation Op) const;
+
+  // private members:
+ private:
+  // Remember: If you change something you have to add it to the GetUsedBytes-function!
+
+  //! The index (mask or runs) followed by the values
+  uint8_t* m_Data;
+  //! The number of bytes of the index at the start of m_Data
+  uint32_t m_IndexBytes;
+  //! The number of stored image pixels
+  uint32_t m_NEntries;
+  //! The number of image bins
+  uint32_t m_NBins;
+  //! The maximum image value, the one byte values are relative to it
+  float m_Maximum;
+  //! The representation
+  uint8_t m_Representation;
+  //! True if the values are stored as one byte
+  bool m_OneByte;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MBPDataCompressed, 0) // a backprojected event stored in a representation compressed per event
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
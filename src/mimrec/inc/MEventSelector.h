@@ -98,6 +98,8 @@ class MEventSelector
   void ApplyTime(MEventSelector& E) { E.SetTime(m_TimeMin, m_TimeMax); }
   void SetTimeFile(MString TimeFile);
   void ApplyTimeFile(MEventSelector& E) { E.SetTimeFile(m_TimeFile); }
+  //! Return the time selection as GTI - an all open one if there is no time selection
+  MGTI GetTimeSelection() const;
   
   
   void SetSourceWindow(bool Use) { m_UseSource = false; }
@@ -16,6 +16,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 
+// Standard libs:
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
 // ROOT libs:
 
 // MEGAlib libs:
@@ -52,6 +58,16 @@ class MExposure : public MViewPort
   //! Return the efficiency - might be nullptr if not-existent/loaded
   MEfficiency* GetEfficiency() { return m_Efficiency; }
 
+  //! Accumulate the dwell time in a binned attitude histogram first and calculate the exposure
+  //! only once per occupied attitude bin (far-field moving mode only)
+  //! The bin width (in radians) is the tolerance of the pointing axes within one attitude bin
+  void UseAttitudeHistogram(bool UseIt, double BinWidth = 1.0*c_Rad);
+  //! Return true if the attitude histogram mode is used
+  bool UsesAttitudeHistogram() const { return m_UseAttitudeHistogram; }
+
+  //! Set the number of threads used to calculate the exposure from the attitude histogram
+  void SetNumberOfThreads(unsigned int NThreads) { m_NThreads = (NThreads > 0) ? NThreads : 1; }
+
   //! Set the viewport / image dimensions
   virtual bool SetDimensions(double xMin, double xMax, unsigned int xNBins,
                              double yMin, double yMax, unsigned int yNBins,
@@ -74,6 +90,17 @@ class MExposure : public MViewPort
   //! The value is just the largest difference between the axis vectors
   double DistanceMetric(const MRotation& A, const MRotation& B);
 
+  //! Add the dwell time to the attitude bin of the given rotation
+  void AddDwellTime(const MRotation& Rotation, double DwellTime);
+  //! Return the key of the attitude bin of the given rotation
+  uint64_t GetAttitudeBinKey(const MRotation& Rotation) const;
+  //! Return the key of the direction bin (16 bit theta, 16 bit phi) of the given axis
+  uint32_t GetDirectionBinKey(const MVector& Axis) const;
+  //! Calculate the exposure of all occupied attitude bins and empty the attitude histogram
+  bool ApplyAttitudeHistogram();
+  //! Thread entry: Calculate the exposure of the attitude bins [Start, Stop] into the thread's own map
+  void ApplyAttitudeHistogramThreadEntry(unsigned int ThreadID, unsigned int Start, unsigned int Stop);
+
   // private methods:
  private:
 
@@ -114,6 +141,29 @@ class MExposure : public MViewPort
   //! The efficiency
   MEfficiency* m_Efficiency;
 
+  // Mode: Attitude histogram
+
+  //! One occupied bin of the attitude histogram
+  struct MAttitudeBin {
+    //! The representative rotation of this bin (the first one which fell into it)
+    MRotation m_Rotation;
+    //! The accumulated dwell time in seconds
+    double m_DwellTime;
+  };
+
+  //! True if the dwell time is first accumulated in the attitude histogram
+  bool m_UseAttitudeHistogram;
+  //! The width of the attitude bins in radians
+  double m_AttitudeBinWidth;
+  //! The occupied bins of the attitude histogram
+  unordered_map<uint64_t, MAttitudeBin> m_AttitudeHistogram;
+  //! The attitude bins flattened for the threads
+  vector<MAttitudeBin> m_ThreadAttitudeBins;
+  //! The exposure maps of the individual threads
+  vector<vector<double>> m_ThreadExposures;
+  //! The number of threads to use for calculating the exposure from the attitude histogram
+  unsigned int m_NThreads;
+
 #ifdef ___CLING___
  public:
   ClassDef(MExposure, 0) // no description
@@ -18,6 +18,7 @@
 
 // ROOT libs:
 #include <TGFrame.h>
+#include <TGButton.h>
 
 // MEGAlib libs:
 #include "MGlobal.h"
@@ -61,6 +62,13 @@ class MGUIExposure : public MGUIDialog
   TGLayoutHints* m_FileSelectorLayout;
   MGUIEFileSelector* m_FileSelector;
 
+  //! Check button to select the attitude histogram mode
+  TGCheckButton* m_UseAttitudeHistogram;
+  //! ID of the attitude histogram check button
+  const int m_UseAttitudeHistogramID = 140;
+  //! The attitude histogram bin width
+  MGUIEEntry* m_AttitudeBinWidth;
+
 
 #ifdef ___CLING___
  public:
@@ -29,6 +29,7 @@ using namespace std;
 #include "MGlobal.h"
 #include "MCoordinateSystem.h"
 #include "MVector.h"
+#include "MTime.h"
 #include "MBPDataImage.h"
 #include "MBackprojection.h"
 #include "MEventSelector.h"
@@ -42,6 +43,7 @@ using namespace std;
 
 // Forward declarations:
 class MBPData;
+class MPhysicalEvent;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,6 +125,49 @@ class MImager
   //! Reset the stop criterion
   void ResetStopCriterion() { if (m_EM != 0) m_EM->ResetStopCriterion(); }
 
+  // Image cube -- energy bands and time slices:
+
+  //! Set the edges of the energy bands in keV: with N+1 edges, N images are reconstructed from one pass through the event file
+  //! With less than 2 edges (the default) a single image is reconstructed from all events
+  void SetEnergyBands(const vector<double>& Edges);
+  //! Return true if the images are reconstructed in energy bands
+  bool UsesEnergyBands() const { return m_EnergyBands.size() >= 2; }
+  //! Return the number of energy bands (0 if no energy bands are used)
+  unsigned int GetNEnergyBands() const { return UsesEnergyBands() == true ? m_EnergyBands.size() - 1 : 0; }
+  //! Return the lower edge of the given energy band
+  double GetEnergyBandMinimum(unsigned int Band) const { return m_EnergyBands[Band]; }
+  //! Return the upper edge of the given energy band
+  double GetEnergyBandMaximum(unsigned int Band) const { return m_EnergyBands[Band+1]; }
+  //! Return the energy band of the event, or -1 if it is in none of them
+  int GetEnergyBand(MPhysicalEvent* Event) const;
+
+  //! Split the time from Start to Stop into NSlices equally long time slices, each of which is reconstructed from one pass through the event file
+  //! With zero slices or Stop <= Start (the default) a single image is reconstructed from all events
+  void SetTimeSlices(const MTime& Start, const MTime& Stop, unsigned int NSlices);
+  //! Return true if the images are reconstructed in time slices
+  bool UsesTimeSlices() const { return m_NTimeSlices > 0; }
+  //! Return the number of time slices (0 if no time slices are used)
+  unsigned int GetNTimeSlices() const { return m_NTimeSlices; }
+  //! Return the start of the given time slice
+  MTime GetTimeSliceMinimum(unsigned int Slice) const;
+  //! Return the end of the given time slice
+  MTime GetTimeSliceMaximum(unsigned int Slice) const { return GetTimeSliceMinimum(Slice+1); }
+  //! Return the time slice of the event, or -1 if it is in none of them
+  int GetTimeSlice(MPhysicalEvent* Event) const;
+  //! Start the deconvolution of every second time slice from the mean image of its two neighbours instead of a flat image
+  void SetTimeSliceWarmStart(bool WarmStart) { m_TimeSliceWarmStart = WarmStart; }
+
+  //! Return true if an image cube -- several energy bands and/or time slices -- is reconstructed
+  bool UsesImageCube() const { return UsesEnergyBands() == true || UsesTimeSlices() == true; }
+  //! Return the index of the event in the image cube (energy band * number of time slices + time slice), or -1 if it is in none of the images
+  int GetImageCubeIndex(MPhysicalEvent* Event) const;
+  //! Return a file name suffix for the image with the given image cube index, e.g. ".band1.slice12"
+  MString GetImageCubeSuffix(unsigned int Index) const;
+  //! Save all images of the image cube together with the number of events per image (i.e. the light curve) in one file
+  bool SaveImageCube(const MString& FileName);
+  //! The maximum number of images of the image cube which are displayed
+  static const unsigned int c_MaxNDisplayedCubeImages;
+
   // Exposure:
 
   //! Set the exposure mode efficiency file
@@ -170,6 +215,7 @@ class MImager
   bool Analyze(bool CalculateResponse = true);
 
   //! Return the number of stored images
+  //! In image cube mode these are the final images of all energy bands and time slices in the order of the image cube index
   unsigned int GetNImages() const { return m_Images.size(); }
   //! Return a specific image
   MImage* GetImage(unsigned int i) { if (i < GetNImages()) return m_Images[i]; return 0; }
@@ -190,8 +236,8 @@ class MImager
 
   //! Return the response slice corresponding to the i-th event
   MBPData* GetResponseSlice(unsigned int i);
-  //! Add a response slice
-  void AddResponseSlice(MBPData* Slice);
+  //! Add a response slice belonging to the given image of the image cube
+  void AddResponseSlice(MBPData* Slice, unsigned int CubeIndex = 0);
 
   //! Return the amount of RAM currently used for the response slices
   unsigned long GetUsedBytes() { return m_UsedBytes; }
@@ -201,6 +247,20 @@ class MImager
  protected:
   //! Create an image
   MImage* CreateImage(MString Title, double* Data);
+  //! Create a new deconvolution algorithm with the stored algorithm settings and stop criterion
+  MLMLAlgorithms* CreateDeconvolutionAlgorithm();
+  //! Deconvolve all images of the image cube concurrently, each with its own algorithm
+  bool AnalyzeImageCube();
+  //! Delete all response slices
+  void ClearResponseSlices();
+  //! Return a description of the image with the given image cube index, e.g. "energy band [200, 500] keV, time slice [10, 20] sec"
+  MString GetImageCubeDescription(unsigned int Index) const;
+  //! Create one exposure calculator per time slice with the settings of the main exposure calculator
+  bool CreateTimeSliceExposures();
+  //! Delete the exposure calculators of the time slices
+  void DeleteTimeSliceExposures();
+  //! Write one animation frame per time slice of each energy band of the image cube
+  void AnimateImageCube();
 
   // protected members:
  protected:
@@ -228,6 +288,11 @@ class MImager
   //! x3-axis: NBins
   int m_x3NBins;
 
+  //! The x-axis of the image coordinate system
+  MVector m_xAxis;
+  //! The z-axis of the image coordinate system
+  MVector m_zAxis;
+
   //! The ID of the palette
   int m_Palette;
   //! The ID of the draw mode
@@ -266,6 +331,24 @@ class MImager
 
   //! The response slices in list-mode
   vector<MBPData*> m_BPEvents;
+  //! The image cube index of each response slice
+  vector<unsigned int> m_BPEventCubeIndices;
+  //! The edges of the energy bands in keV
+  vector<double> m_EnergyBands;
+  //! The start of the first time slice
+  MTime m_TimeSliceStart;
+  //! The end of the last time slice
+  MTime m_TimeSliceStop;
+  //! The number of time slices
+  unsigned int m_NTimeSlices;
+  //! True if every second time slice starts from the mean image of its neighbours
+  bool m_TimeSliceWarmStart;
+  //! The data of each image of the image cube
+  vector<vector<double>> m_ImageCube;
+  //! The number of events in each image of the image cube
+  vector<unsigned int> m_ImageCubeNEvents;
+  //! The number of performed iterations of each image of the image cube
+  vector<unsigned int> m_ImageCubeNIterations;
   //! The backprojection algorithm classs --- one per thread
   vector<MBackprojection*> m_BPs;
 
@@ -284,12 +367,26 @@ class MImager
 
   //! The exposure calculator
   MExposure* m_Exposure;
+  //! The exposure calculators of the time slices, filled during the same pass through the events as the response slices
+  vector<MExposure*> m_TimeSliceExposures;
+  //! The efficiency file of the exposure calculation
+  MString m_ExposureEfficiencyFileName;
+  //! True if the exposure calculation uses an attitude histogram
+  bool m_ExposureUseAttitudeHistogram;
+  //! The bin width of the attitude histogram in radians
+  double m_ExposureAttitudeBinWidth;
 
 
   // Deconvolution:
 
   //! The EM algorithm
   MLMLAlgorithms* m_EM;
+  //! The ID of the EM algorithm
+  unsigned int m_EMAlgorithm;
+  //! The number of OSEM subsets
+  unsigned int m_EMNSubSets;
+  //! The number of iterations of the stop criterion
+  int m_EMNIterations;
 
 
   // Multi-threading:
@@ -58,6 +58,9 @@ class MLMLAlgorithms
 
   //! Return the current reconstructed image
   virtual double* GetImage();
+  //! Start the iterations from the given image instead of a flat one (warm start)
+  //! Has to be called after the response slices have been set
+  void SetInitialImage(const double* Image);
 
   //! Return the maximum number of iterations
   unsigned int GetMaxNIterations() const { return m_MaxNIterations; }
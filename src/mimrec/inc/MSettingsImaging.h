@@ -216,6 +216,12 @@ class MSettingsImaging : public MSettingsInterface
  
   MString GetExposureEfficiencyFile() const { return m_ExposureEfficiencyFile; }
   void SetExposureEfficiencyFile(MString ExposureEfficiencyFile) { m_ExposureEfficiencyFile = ExposureEfficiencyFile; }
+
+  bool GetExposureUseAttitudeHistogram() const { return m_ExposureUseAttitudeHistogram; }
+  void SetExposureUseAttitudeHistogram(bool ExposureUseAttitudeHistogram) { m_ExposureUseAttitudeHistogram = ExposureUseAttitudeHistogram; m_BackprojectionModified = true; }
+
+  double GetExposureAttitudeBinWidth() const { return m_ExposureAttitudeBinWidth; }
+  void SetExposureAttitudeBinWidth(double ExposureAttitudeBinWidth) { m_ExposureAttitudeBinWidth = ExposureAttitudeBinWidth; m_BackprojectionModified = true; }
   
   // Menu likelihood
 
@@ -236,6 +242,24 @@ class MSettingsImaging : public MSettingsInterface
   unsigned int GetNIterations() const { return m_NIterations; }
   void SetNIterations(unsigned int NIterations) { m_NIterations = NIterations; m_LikelihoodModified = true; }
 
+  //! The edges of the energy bands in keV for multi-band imaging -- with less than 2 edges a single image is reconstructed
+  vector<double> GetImagingEnergyBands() const { return m_ImagingEnergyBands; }
+  void SetImagingEnergyBands(const vector<double>& ImagingEnergyBands) { m_ImagingEnergyBands = ImagingEnergyBands; m_BackprojectionModified = true; }
+
+  //! The time slices for time-resolved imaging: NTimeSlices slices between start and stop (in seconds) -- with zero slices a single image is reconstructed
+  double GetImagingTimeSliceStart() const { return m_ImagingTimeSliceStart; }
+  void SetImagingTimeSliceStart(double ImagingTimeSliceStart) { m_ImagingTimeSliceStart = ImagingTimeSliceStart; m_BackprojectionModified = true; }
+
+  double GetImagingTimeSliceStop() const { return m_ImagingTimeSliceStop; }
+  void SetImagingTimeSliceStop(double ImagingTimeSliceStop) { m_ImagingTimeSliceStop = ImagingTimeSliceStop; m_BackprojectionModified = true; }
+
+  unsigned int GetImagingNTimeSlices() const { return m_ImagingNTimeSlices; }
+  void SetImagingNTimeSlices(unsigned int ImagingNTimeSlices) { m_ImagingNTimeSlices = ImagingNTimeSlices; m_BackprojectionModified = true; }
+
+  //! True if every second time slice is deconvolved starting from the mean image of its neighbours
+  bool GetImagingTimeSliceWarmStart() const { return m_ImagingTimeSliceWarmStart; }
+  void SetImagingTimeSliceWarmStart(bool ImagingTimeSliceWarmStart) { m_ImagingTimeSliceWarmStart = ImagingTimeSliceWarmStart; m_LikelihoodModified = true; }
+
   // Menu penalty
   int GetPenalty() const { return m_Penalty; }
   void SetPenalty(int Penalty) { m_Penalty = Penalty; m_LikelihoodModified = true; }
@@ -303,6 +327,11 @@ class MSettingsImaging : public MSettingsInterface
   int m_Penalty;
   double m_PenaltyAlpha;
   unsigned int m_NIterations;
+  vector<double> m_ImagingEnergyBands;
+  double m_ImagingTimeSliceStart;
+  double m_ImagingTimeSliceStop;
+  unsigned int m_ImagingNTimeSlices;
+  bool m_ImagingTimeSliceWarmStart;
 
   
   // Image dimensions spherical
@@ -361,6 +390,10 @@ class MSettingsImaging : public MSettingsInterface
   MExposureMode m_ExposureMode;
   //! The effificiency file from which the exposure can be calculated
   MString m_ExposureEfficiencyFile;
+  //! True if the exposure is calculated via a binned attitude histogram
+  bool m_ExposureUseAttitudeHistogram;
+  //! The bin width of the attitude histogram in degrees
+  double m_ExposureAttitudeBinWidth;
   
   
   // Animation options:
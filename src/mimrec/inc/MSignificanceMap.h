@@ -0,0 +1,146 @@
+/*
+ * MSignificanceMap.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MSignificanceMap__
+#define __MSignificanceMap__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <vector>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MVector.h"
+#include "MCoordinateSystem.h"
+#include "MComptonEvent.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Counts for the significance map:
+//! For each (longitude, latitude) bin, count the Compton events whose ARM for the bin center and for
+//! eight test points at a given distance around it is within a given radius.
+//! Per event only the bins in the band around the Compton cone are tested, and the events are distributed over several threads.
+class MSignificanceMap
+{
+  // public interface:
+ public:
+  //! Default constructor
+  MSignificanceMap();
+  //! Default destructor
+  virtual ~MSignificanceMap();
+
+  //! Set the binning in longitude (x) and latitude (y) in degrees
+  void SetBinning(double XMin, double XMax, unsigned int NBinsX, double YMin, double YMax, unsigned int NBinsY);
+  //! Set the maximum ARM (radius) and the distance of the test points from the bin center in degrees
+  void SetTestPoints(double Radius, double Distance);
+  //! Set the coordinate system in which the ARM is calculated
+  void SetCoordinateSystem(MCoordinateSystem CoordinateSystem) { m_CoordinateSystem = CoordinateSystem; }
+  //! Set the number of threads, 0 means as many as there are cores
+  void SetNumberOfThreads(unsigned int NThreads) { m_NThreads = NThreads; }
+
+  //! Calculate the bin center and test point vectors and reset all counts
+  void Initialize();
+
+  //! Count the events, the events are not deleted
+  void AddEvents(const vector<MComptonEvent*>& Events);
+
+  //! Return the number of events within the radius at the center of bin (x, y)
+  unsigned int GetCenterCounts(unsigned int x, unsigned int y) const { return GetCounts(c_Center, x, y); }
+  //! Return the number of events within the radius at test point TestPoint (1..8) of bin (x, y)
+  unsigned int GetTestPointCounts(unsigned int TestPoint, unsigned int x, unsigned int y) const { return GetCounts(c_TestPoint + TestPoint - 1, x, y); }
+  //! Return the number of events within the radius at the center and exactly NTestPoints (0..8) test points of bin (x, y)
+  unsigned int GetCenterAndTestPointsCounts(unsigned int NTestPoints, unsigned int x, unsigned int y) const { return GetCounts(c_CenterAndTestPoints + NTestPoints, x, y); }
+  //! Return the number of events within the radius not at the center but at exactly NTestPoints (1..8) test points of bin (x, y)
+  unsigned int GetNoCenterAndTestPointsCounts(unsigned int NTestPoints, unsigned int x, unsigned int y) const { return GetCounts(c_NoCenterAndTestPoints + NTestPoints - 1, x, y); }
+
+  //! Return the number of bins which have been tested
+  unsigned long GetNTestedBins() const;
+
+  // protected methods:
+ protected:
+  //! Return the counts of the given type in bin (x, y) summed over all threads
+  unsigned int GetCounts(unsigned int Type, unsigned int x, unsigned int y) const;
+
+  //! Thread entry: Count the events [Start, Stop[ into the thread's own counts
+  void AddEventsThreadEntry(unsigned int ThreadID, const vector<MComptonEvent*>* Events, unsigned int Start, unsigned int Stop);
+  //! Count one event into the given counts
+  void AddEvent(MComptonEvent* Event, vector<unsigned int>& Counts, unsigned long& NTestedBins);
+  //! Test the center and test points of one bin and count the event
+  void TestBin(MComptonEvent* Event, unsigned int Bin, vector<unsigned int>& Counts);
+
+  // private members:
+ private:
+  //! The count types: center, the 8 test points, center and 0..8 test points, no center and 1..8 test points
+  static const unsigned int c_Center = 0;
+  static const unsigned int c_TestPoint = 1;
+  static const unsigned int c_CenterAndTestPoints = 9;
+  static const unsigned int c_NoCenterAndTestPoints = 18;
+  static const unsigned int c_NCountTypes = 26;
+  //! The number of points per bin: the center and 8 test points
+  static const unsigned int c_NPoints = 9;
+
+  //! The lower edge of the longitude axis in degrees
+  double m_XMin;
+  //! The upper edge of the longitude axis in degrees
+  double m_XMax;
+  //! The number of longitude bins
+  unsigned int m_NBinsX;
+  //! The lower edge of the latitude axis in degrees
+  double m_YMin;
+  //! The upper edge of the latitude axis in degrees
+  double m_YMax;
+  //! The number of latitude bins
+  unsigned int m_NBinsY;
+  //! The maximum ARM in degrees
+  double m_Radius;
+  //! The distance of the test points from the bin center in degrees
+  double m_Distance;
+  //! The coordinate system
+  MCoordinateSystem m_CoordinateSystem;
+  //! The number of threads, 0 means as many as there are cores
+  unsigned int m_NThreads;
+
+  //! The bin center and test points (far away) per bin: bin x + y*NBinsX, point 0 is the center
+  vector<MVector> m_Points;
+  //! The unit vectors of the bin centers
+  vector<MVector> m_BinCenters;
+  //! The polar angle of the bin centers per latitude row in radians
+  vector<double> m_RowThetas;
+  //! The maximum angle between the test points and the bin center in radians
+  double m_MaximumOffset;
+
+  //! The counts per thread: type + c_NCountTypes*bin
+  vector<vector<unsigned int>> m_ThreadCounts;
+  //! The number of tested bins per thread
+  vector<unsigned long> m_ThreadNTestedBins;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MSignificanceMap, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
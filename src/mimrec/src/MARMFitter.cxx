@@ -71,7 +71,7 @@ MARMFitter::MARMFitter()
   ROOT::Math::MinimizerOptions::SetDefaultMaxFunctionCalls(250000);
 
   std::random_device RD; // <-- should use MEGAlib global
-  m_MersenneTwister.seed(RD());
+  m_RandomSeed = RD();
 
   m_NumberOfBins = 101;
   m_MaxARMValue = 180;
@@ -81,6 +81,7 @@ MARMFitter::MARMFitter()
   m_IsBinningOptimized = false;
 
   m_UnbinnedFitting = true;
+  m_BinnedBootstrapping = false;
 
   m_MinHeight = 0;
   m_MaxHeight = 1E20;
@@ -93,8 +94,7 @@ MARMFitter::MARMFitter()
   m_GuessHeight = 2;
   m_GuessScale = 2;
 
-  m_MaximumNumberOfThreads = 2*std::thread::hardware_concurrency();
-  if (m_MaximumNumberOfThreads < 1) m_MaximumNumberOfThreads = 1;
+  SetNumberOfThreads(0);
 
   Reset();
 }
@@ -141,6 +141,18 @@ void MARMFitter::SetMaximumARMValue(double MaxARMValue)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Set the number of threads used for the bootstrap fits, 0 means the number of cores
+void MARMFitter::SetNumberOfThreads(unsigned int NumberOfThreads)
+{
+  m_MaximumNumberOfThreads = NumberOfThreads;
+  if (m_MaximumNumberOfThreads == 0) m_MaximumNumberOfThreads = std::thread::hardware_concurrency();
+  if (m_MaximumNumberOfThreads < 1) m_MaximumNumberOfThreads = 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Set the test position, and its coordinate system
 void MARMFitter::SetTestPosition(MVector TestPosition, MCoordinateSystem CoordinateSystem)
 {
@@ -175,6 +187,7 @@ void MARMFitter::SetFitFunction(unsigned int ID)
 void MARMFitter::Reset()
 {
   m_OriginalARMValues.clear();
+  m_OriginalBinCounts.clear();
 
   m_BootStrappedFWHMSamples.clear();
   m_BootStrappedFitParameters.clear();
@@ -792,6 +805,12 @@ void MARMFitter::SetupARMFitAsymmetricGeneralizedNormalGeneralizedNormalGenerali
 //! Perform a series of fits to find the best match
 bool MARMFitter::PerformFit(unsigned int FitID, vector<double>& ARMValues)
 {
+  if (m_UnbinnedFitting == false || m_BinnedBootstrapping == true) {
+    vector<double> BinCounts;
+    BinARMValues(ARMValues, BinCounts);
+    return PerformBinnedFit(FitID, BinCounts);
+  }
+
   // Clean the data
   vector<double> CleanedData;
   CleanedData.reserve(ARMValues.size());
@@ -801,9 +820,35 @@ bool MARMFitter::PerformFit(unsigned int FitID, vector<double>& ARMValues)
     }
   }
 
+  // Set up for fitting
+  ROOT::Fit::DataRange Range(-m_MaxARMValue, m_MaxARMValue);
+
+  TF1* FitFunction = nullptr;
+  ROOT::Fit::Fitter Fitter; // need a new one every time
+  SetupARMFit(m_ARMFitFunction, Fitter, &FitFunction);
+
+  // Do the fitting
+  ROOT::Fit::UnBinData UnbinnedData(CleanedData.size(), CleanedData.data(), Range);
+  Fitter.LikelihoodFit(UnbinnedData, true);
+
+  StoreFitResults(FitID, Fitter, FitFunction);
+
+  delete FitFunction;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Perform a single binned fit of the bin counts over [-MaxARM, MaxARM]
+bool MARMFitter::PerformBinnedFit(unsigned int FitID, const vector<double>& BinCounts)
+{
   // Set up for fitting
   ROOT::Fit::DataOptions DataOptions;
   DataOptions.fIntegral = true;
+  DataOptions.fUseRange = true;
 
   ROOT::Fit::DataRange Range(-m_MaxARMValue, m_MaxARMValue);
 
@@ -811,39 +856,34 @@ bool MARMFitter::PerformFit(unsigned int FitID, vector<double>& ARMValues)
   ROOT::Fit::Fitter Fitter; // need a new one every time
   SetupARMFit(m_ARMFitFunction, Fitter, &FitFunction);
 
-  // Do the fitting
-  if (m_UnbinnedFitting == true) {
-    //cout<<"Unbinned fit"<<endl;
-    ROOT::Fit::UnBinData UnbinnedData(CleanedData.size(), CleanedData.data(), Range);
-    Fitter.LikelihoodFit(UnbinnedData, true);
-  } else {
-    DataOptions.fIntegral = true;
-    DataOptions.fUseRange = true;
+  // Fill BinData directly: bin center, bin content, half-bin-width (required by fIntegral), Poisson error.
+  // Empty bins are skipped, consistent with the default DataOptions.fUseEmpty = false.
+  // kCoordError is required to store both x (bin half-width) and y (Poisson) errors,
+  // which ROOT needs to integrate the fit function over each bin (fIntegral = true).
+  double BinWidth = 2.0 * m_MaxARMValue / BinCounts.size();
+  ROOT::Fit::BinData BinnedData(DataOptions, Range, BinCounts.size(), 1, ROOT::Fit::BinData::kCoordError);
+  for (unsigned int b = 0; b < BinCounts.size(); ++b) {
+    if (BinCounts[b] == 0) continue;
+    double BinCenter = -m_MaxARMValue + (b + 0.5) * BinWidth;
+    BinnedData.Add(BinCenter, BinCounts[b], 0.5 * BinWidth, sqrt(BinCounts[b]));
+  }
 
-    // Bin the data directly into a counts vector — one entry per bin over [-m_MaxARMValue, m_MaxARMValue]
-    double BinWidth = 2.0 * m_MaxARMValue / m_NumberOfBins;
-    vector<double> BinCounts(m_NumberOfBins, 0.0);
-    for (auto& V: CleanedData) {
-      int Bin = static_cast<int>((V + m_MaxARMValue) / BinWidth);
-      if (Bin >= 0 && Bin < static_cast<int>(m_NumberOfBins)) {
-        BinCounts[Bin]++;
-      }
-    }
+  Fitter.LikelihoodFit(BinnedData, true);
 
-    // Fill BinData directly: bin center, bin content, half-bin-width (required by fIntegral), Poisson error.
-    // Empty bins are skipped, consistent with the default DataOptions.fUseEmpty = false.
-    // kCoordError is required to store both x (bin half-width) and y (Poisson) errors,
-    // which ROOT needs to integrate the fit function over each bin (fIntegral = true).
-    ROOT::Fit::BinData BinnedData(DataOptions, Range, m_NumberOfBins, 1, ROOT::Fit::BinData::kCoordError);
-    for (unsigned int b = 0; b < m_NumberOfBins; ++b) {
-      if (BinCounts[b] == 0) continue;
-      double BinCenter = -m_MaxARMValue + (b + 0.5) * BinWidth;
-      BinnedData.Add(BinCenter, BinCounts[b], 0.5 * BinWidth, sqrt(BinCounts[b]));
-    }
+  StoreFitResults(FitID, Fitter, FitFunction);
 
-    Fitter.LikelihoodFit(BinnedData, true);
-  }
+  delete FitFunction;
 
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Store the results of fit FitID
+void MARMFitter::StoreFitResults(unsigned int FitID, ROOT::Fit::Fitter& Fitter, TF1* FitFunction)
+{
   // Retrieve results
   TFitResult Result = Fitter.Result();
 
@@ -852,24 +892,40 @@ bool MARMFitter::PerformFit(unsigned int FitID, vector<double>& ARMValues)
   // Calculate FWHM ...
   double FWHM = MInterface::GetFWHM(FitFunction, -m_MaxARMValue, m_MaxARMValue);
 
-  {
-    std::unique_lock<std::mutex> Lock(m_Mutex);
-
-    m_BootStrappedFWHMSamples[FitID] = FWHM;
+  // Each fit owns its slot in the (pre-sized) result vectors, the lock only serializes the printout
+  m_BootStrappedFWHMSamples[FitID] = FWHM;
 
-    m_BootStrappedFitParameters[FitID] = vector<double>();
-    for (unsigned int i = 0; i < GetARMFitFunctionNumberOfParameters(m_ARMFitFunction); ++i) {
-      m_BootStrappedFitParameters[FitID].push_back(Result.Parameter(i));
-    }
+  m_BootStrappedFitParameters[FitID] = vector<double>();
+  for (unsigned int i = 0; i < GetARMFitFunctionNumberOfParameters(m_ARMFitFunction); ++i) {
+    m_BootStrappedFitParameters[FitID].push_back(Result.Parameter(i));
+  }
 
-    m_BootStrappedBakerCousins[FitID] = Result.MinFcnValue();
+  m_BootStrappedBakerCousins[FitID] = Result.MinFcnValue();
 
+  {
+    std::unique_lock<std::mutex> Lock(m_Mutex);
     Result.Print();
   }
+}
 
-  delete FitFunction;
 
-  return true;
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Histogram the ARM values into m_NumberOfBins bins over [-MaxARM, MaxARM]
+void MARMFitter::BinARMValues(const vector<double>& ARMValues, vector<double>& BinCounts) const
+{
+  // Bin the data directly into a counts vector — one entry per bin over [-m_MaxARMValue, m_MaxARMValue]
+  double BinWidth = 2.0 * m_MaxARMValue / m_NumberOfBins;
+  BinCounts.assign(m_NumberOfBins, 0.0);
+  for (auto& V: ARMValues) {
+    if (V >= -m_MaxARMValue && V <= m_MaxARMValue) {
+      int Bin = static_cast<int>((V + m_MaxARMValue) / BinWidth);
+      if (Bin >= 0 && Bin < static_cast<int>(m_NumberOfBins)) {
+        BinCounts[Bin]++;
+      }
+    }
+  }
 }
 
 
@@ -943,22 +999,44 @@ bool MARMFitter::FitAll()
 ////////////////////////////////////////////////////////////////////////////////
 
 
-//! Bootstrap the ARM values and return them as vector
-vector<double> MARMFitter::BootstrapARMValues()
+//! Bootstrap the ARM values into ARMValues using the given random stream
+void MARMFitter::BootstrapARMValues(mt19937& RandomStream, vector<double>& ARMValues) const
 {
-  std::uniform_int_distribution<> Distributor(0, m_OriginalARMValues.size() - 1);
+  std::uniform_int_distribution<size_t> Distributor(0, m_OriginalARMValues.size() - 1);
 
   // Bootstrapping: sample with replacement.
-  // m_MersenneTwister is shared across threads, so all draws must be made under the mutex.
-  vector<double> ARMValues;
-  ARMValues.reserve(m_OriginalARMValues.size());
+  ARMValues.resize(m_OriginalARMValues.size());
   for (size_t i = 0; i < m_OriginalARMValues.size(); ++i) {
-    int D;
-    { std::unique_lock<std::mutex> Lock(m_Mutex); D = Distributor(m_MersenneTwister); }
-    ARMValues.push_back(m_OriginalARMValues[D]);
+    ARMValues[i] = m_OriginalARMValues[Distributor(RandomStream)];
   }
+}
 
-  return ARMValues;
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Bootstrap the ARM histogram into BinCounts via multinomial draws using the given random stream
+void MARMFitter::BootstrapBinCounts(mt19937& RandomStream, vector<double>& BinCounts) const
+{
+  // Drawing all N values with replacement and histogramming them is a multinomial draw over the bins,
+  // with one additional category for the values outside the ARM window.
+  // We draw it as a sequence of binomials: each bin gets Binomial(remaining draws, bin content / remaining content)
+  BinCounts.resize(m_OriginalBinCounts.size());
+
+  long RemainingDraws = m_OriginalARMValues.size();
+  double RemainingContent = m_OriginalARMValues.size();
+  for (size_t b = 0; b < m_OriginalBinCounts.size(); ++b) {
+    if (RemainingDraws <= 0 || m_OriginalBinCounts[b] <= 0) {
+      BinCounts[b] = 0;
+    } else if (m_OriginalBinCounts[b] >= RemainingContent) {
+      BinCounts[b] = RemainingDraws;
+    } else {
+      std::binomial_distribution<long> Binomial(RemainingDraws, m_OriginalBinCounts[b] / RemainingContent);
+      BinCounts[b] = Binomial(RandomStream);
+    }
+    RemainingDraws -= static_cast<long>(BinCounts[b]);
+    RemainingContent -= m_OriginalBinCounts[b];
+  }
 }
 
 
@@ -1114,22 +1192,26 @@ void MARMFitter::CalculateARMMetrics()
 ////////////////////////////////////////////////////////////////////////////////
 
 
-void MARMFitter::ParallelFitting(int FitID, std::condition_variable& CV)
+//! Thread entry of the worker pool: perform fits until all fits are done
+void MARMFitter::ParallelFitting(atomic<unsigned int>& NextFitID, unsigned int NumberOfFits)
 {
-  { // lock the mutex while we wait
-    std::unique_lock<std::mutex> Lock(m_Mutex);
-    CV.wait(Lock, [this]() { return m_NumberOfRunningThreads < m_MaximumNumberOfThreads; }); // the condition_variable releases the lock while waiting.
-    ++m_NumberOfRunningThreads;
-    //cout<<"Fit "<<FitID<<endl;
-  }
+  // The sample buffers are reused for all fits of this worker
+  vector<double> ARMValues;
+  vector<double> BinCounts;
 
-  vector<double> ARMValues = BootstrapARMValues();
-  PerformFit(FitID, ARMValues);
+  unsigned int FitID = 0;
+  while ((FitID = NextFitID++) < NumberOfFits) {
+    // Each fit has its own random stream, thus the samples do not depend on which worker performs the fit
+    seed_seq Seeds = { m_RandomSeed, FitID };
+    mt19937 RandomStream(Seeds);
 
-  { // lock the mutex while we wait
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    --m_NumberOfRunningThreads;
-    CV.notify_all();
+    if (m_BinnedBootstrapping == true) {
+      BootstrapBinCounts(RandomStream, BinCounts);
+      PerformBinnedFit(FitID, BinCounts);
+    } else {
+      BootstrapARMValues(RandomStream, ARMValues);
+      PerformFit(FitID, ARMValues);
+    }
   }
 }
 
@@ -1162,7 +1244,7 @@ bool MARMFitter::Fit(unsigned int NumberOfFits)
     }
   }
   m_MinHeight = 0;
-  if (m_UnbinnedFitting == false) {
+  if (m_UnbinnedFitting == false || m_BinnedBootstrapping == true) {
     m_MaxHeight = 1.25 * Hist->GetMaximum();
   } else {
     m_MaxHeight = 0.5*NEvents;
@@ -1190,13 +1272,17 @@ bool MARMFitter::Fit(unsigned int NumberOfFits)
   m_BootStrappedBakerCousins.resize(NumberOfFits);
 
   if (NumberOfFits > 1) {
-    // Start the threads
-    m_NumberOfRunningThreads = 0;
+    if (m_BinnedBootstrapping == true) {
+      BinARMValues(m_OriginalARMValues, m_OriginalBinCounts);
+    }
+
+    // Start a fixed pool of workers which pick up the fits one by one
+    atomic<unsigned int> NextFitID(0);
+    unsigned int NumberOfThreads = min(NumberOfFits, m_MaximumNumberOfThreads);
     vector<thread> Threads;
-    condition_variable CV;
 
-    for (unsigned int i = 0; i < NumberOfFits; ++i) {
-      Threads.emplace_back([this, &CV, i]() { this->ParallelFitting(i, CV); } );
+    for (unsigned int i = 0; i < NumberOfThreads; ++i) {
+      Threads.emplace_back([this, &NextFitID, NumberOfFits]() { this->ParallelFitting(NextFitID, NumberOfFits); } );
     }
 
     // Join all threads with the main thread
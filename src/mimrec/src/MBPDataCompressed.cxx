@@ -0,0 +1,418 @@
+/*
+ * MBPDataCompressed.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MBPDataCompressed.cxx
+//
+//
+// The MBPDataCompressed class stores a backprojected image (single event psf)
+// in whichever of three representations needs the fewest bytes:
+//
+// Dense: the values of all bins
+// Mask:  one bit per bin (in 64 bit words) followed by the values of the set bins
+// Runs:  for each run of consecutive bins the gap to the end of the previous run
+//        and the run length minus one, both as variable-length integers
+//        (7 bits per byte, the high bit marks that another byte follows),
+//        followed by the values
+//
+// Cone-like responses consist of a few long runs per image row, thus the runs
+// need only a few bytes, while scattered responses are cheaper as bit mask and
+// nearly full ones as dense image.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MBPDataCompressed.h"
+
+// Standard libs:
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+// MEGAlib:
+#include "MStreams.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MBPDataCompressed)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the number of bytes of a variable-length integer
+static inline uint32_t MBPDataCompressedVarintBytes(uint32_t Value)
+{
+  uint32_t Bytes = 1;
+  while (Value >= 0x80) {
+    Value >>= 7;
+    ++Bytes;
+  }
+  return Bytes;
+}
+
+
+//! Write a variable-length integer and advance the pointer
+static inline void MBPDataCompressedWriteVarint(uint8_t*& Data, uint32_t Value)
+{
+  while (Value >= 0x80) {
+    *Data++ = (uint8_t) (Value | 0x80);
+    Value >>= 7;
+  }
+  *Data++ = (uint8_t) Value;
+}
+
+
+//! Read a variable-length integer and advance the pointer
+static inline uint32_t MBPDataCompressedReadVarint(const uint8_t*& Data)
+{
+  uint32_t Value = *Data & 0x7f;
+  unsigned int Shift = 7;
+  while ((*Data++ & 0x80) != 0) {
+    Value |= (uint32_t) (*Data & 0x7f) << Shift;
+    Shift += 7;
+  }
+  return Value;
+}
+
+
+//! Sum of Values[i]*Image[i] over a run -- independent partial sums allow the compiler to vectorize
+template<class T> static inline double MBPDataCompressedDot(const T* Values, const double* Image, uint32_t Length)
+{
+  double S0 = 0, S1 = 0, S2 = 0, S3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= Length; i += 4) {
+    S0 += Values[i]*Image[i];
+    S1 += Values[i+1]*Image[i+1];
+    S2 += Values[i+2]*Image[i+2];
+    S3 += Values[i+3]*Image[i+3];
+  }
+  for (; i < Length; ++i) {
+    S0 += Values[i]*Image[i];
+  }
+  return (S0 + S1) + (S2 + S3);
+}
+
+
+//! Image[i] += Factor*Values[i] over a run
+template<class T> static inline void MBPDataCompressedAdd(double Factor, const T* Values, double* Image, uint32_t Length)
+{
+  for (uint32_t i = 0; i < Length; ++i) {
+    Image[i] += Factor*Values[i];
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MBPDataCompressed::MBPDataCompressed(bool OneByte) : MBPData()
+{
+  // Standard constructor
+
+  m_Type = c_Compressed;
+
+  m_Data = nullptr;
+  m_IndexBytes = 0;
+  m_NEntries = 0;
+  m_NBins = 0;
+  m_Maximum = 0.0;
+  m_Representation = c_Runs;
+  m_OneByte = OneByte;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MBPDataCompressed::~MBPDataCompressed()
+{
+  // Destruct an MBPDataCompressed
+
+  delete [] m_Data;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MBPDataCompressed::Initialize(double* Image, int* Bins, int NBins, int NUsedBins, double Maximum)
+{
+  // Constructs an event of type MBPDataCompressed:
+  //
+  // Image:      the values of the used bins
+  // Bins:       the bin IDs associated with the values
+  // NBins:      the number of bins in the image
+  // NUsedBins:  the number of used bins
+  // Maximum:    the maximum value
+
+  m_NBins = NBins;
+  m_Maximum = Maximum;
+
+  if (m_OneByte == true && m_Maximum <= 0 && NUsedBins > 0) {
+    cout<<"Storing images: The image is empty!"<<endl;
+  }
+
+  // The encoding requires the bins in ascending order without duplicates
+  const int* UsedBins = Bins;
+  const double* UsedValues = Image;
+  uint32_t NUsed = NUsedBins;
+
+  bool IsSorted = true;
+  for (int i = 1; i < NUsedBins; ++i) {
+    if (Bins[i] <= Bins[i-1]) {
+      IsSorted = false;
+      break;
+    }
+  }
+
+  vector<int> SortedBins;
+  vector<double> SortedValues;
+  if (IsSorted == false) {
+    vector<int> Order(NUsedBins);
+    iota(Order.begin(), Order.end(), 0);
+    sort(Order.begin(), Order.end(), [Bins](int A, int B) { return Bins[A] < Bins[B]; });
+    SortedBins.reserve(NUsedBins);
+    SortedValues.reserve(NUsedBins);
+    for (int i: Order) {
+      if (SortedBins.size() > 0 && SortedBins.back() == Bins[i]) {
+        SortedValues.back() += Image[i];
+      } else {
+        SortedBins.push_back(Bins[i]);
+        SortedValues.push_back(Image[i]);
+      }
+    }
+    UsedBins = SortedBins.data();
+    UsedValues = SortedValues.data();
+    NUsed = SortedBins.size();
+  }
+  m_NEntries = NUsed;
+
+  // Determine the size of each representation and choose the smallest one
+  uint32_t ValueBytes = (m_OneByte == true) ? sizeof(uint8_t) : sizeof(float);
+
+  uint32_t MaskBytes = ((m_NBins + 63)/64)*8;
+
+  uint32_t RunBytes = 0;
+  uint32_t End = 0;
+  for (uint32_t i = 0; i < NUsed; ) {
+    uint32_t Length = 1;
+    while (i + Length < NUsed && UsedBins[i + Length] == UsedBins[i] + (int) Length) ++Length;
+    RunBytes += MBPDataCompressedVarintBytes(UsedBins[i] - End) + MBPDataCompressedVarintBytes(Length - 1);
+    End = UsedBins[i] + Length;
+    i += Length;
+  }
+
+  uint64_t DenseSize = (uint64_t) m_NBins*ValueBytes;
+  uint64_t MaskSize = MaskBytes + (uint64_t) NUsed*ValueBytes;
+  uint64_t RunSize = RunBytes + (uint64_t) NUsed*ValueBytes;
+
+  if (DenseSize <= RunSize && DenseSize <= MaskSize) {
+    m_Representation = c_Dense;
+    m_IndexBytes = 0;
+  } else if (RunSize <= MaskSize) {
+    m_Representation = c_Runs;
+    m_IndexBytes = RunBytes;
+  } else {
+    m_Representation = c_Mask;
+    m_IndexBytes = MaskBytes;
+  }
+  // The float values are aligned
+  if (m_OneByte == false) {
+    m_IndexBytes = (m_IndexBytes + 3) & ~3U;
+  }
+
+  uint32_t NValues = (m_Representation == c_Dense) ? m_NBins : NUsed;
+  m_Data = new(nothrow) uint8_t[m_IndexBytes + NValues*ValueBytes];
+
+  // We are out of memory
+  if (m_Data == nullptr) {
+    cout<<"Storing images: Out of memory"<<endl;
+    return false;
+  }
+  memset(m_Data, 0, m_IndexBytes + NValues*ValueBytes);
+
+  // The index
+  if (m_Representation == c_Mask) {
+    vector<uint64_t> Words((m_NBins + 63)/64, 0);
+    for (uint32_t i = 0; i < NUsed; ++i) {
+      Words[UsedBins[i]/64] |= uint64_t(1) << (UsedBins[i]%64);
+    }
+    memcpy(m_Data, Words.data(), MaskBytes);
+  } else if (m_Representation == c_Runs) {
+    uint8_t* Index = m_Data;
+    End = 0;
+    for (uint32_t i = 0; i < NUsed; ) {
+      uint32_t Length = 1;
+      while (i + Length < NUsed && UsedBins[i + Length] == UsedBins[i] + (int) Length) ++Length;
+      MBPDataCompressedWriteVarint(Index, UsedBins[i] - End);
+      MBPDataCompressedWriteVarint(Index, Length - 1);
+      End = UsedBins[i] + Length;
+      i += Length;
+    }
+  }
+
+  // The values - in the dense representation at the position of their bin
+  if (m_OneByte == true) {
+    double InvMaximum = 255.0/m_Maximum;
+    uint8_t* Values = m_Data + m_IndexBytes;
+    for (uint32_t i = 0; i < NUsed; ++i) {
+      double Value = min(255.0, InvMaximum * UsedValues[i]);
+      Values[(m_Representation == c_Dense) ? UsedBins[i] : i] = (uint8_t) Value;
+    }
+  } else {
+    float* Values = reinterpret_cast<float*>(m_Data + m_IndexBytes);
+    for (uint32_t i = 0; i < NUsed; ++i) {
+      Values[(m_Representation == c_Dense) ? UsedBins[i] : i] = UsedValues[i];
+    }
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+template<class Operation> void MBPDataCompressed::ForEachRun(Operation Op) const
+{
+  //! Call Operation(first bin, number of bins, index of the first value) for all runs of consecutive stored bins
+
+  if (m_Representation == c_Dense) {
+    Op(0, m_NBins, 0);
+  } else if (m_Representation == c_Mask) {
+    uint32_t Value = 0;
+    uint32_t NWords = (m_NBins + 63)/64;
+    for (uint32_t w = 0; w < NWords; ++w) {
+      uint64_t Word;
+      memcpy(&Word, m_Data + 8*w, 8);
+      while (Word != 0) {
+        uint32_t Start = __builtin_ctzll(Word);
+        uint64_t Inverted = ~(Word >> Start);
+        uint32_t Length = (Inverted == 0) ? 64 : __builtin_ctzll(Inverted);
+        Op(64*w + Start, Length, Value);
+        Value += Length;
+        Word = (Start + Length == 64) ? 0 : Word & ~((uint64_t(1) << (Start + Length)) - 1);
+      }
+    }
+  } else {
+    const uint8_t* Index = m_Data;
+    uint32_t Bin = 0;
+    uint32_t Value = 0;
+    while (Value < m_NEntries) {
+      Bin += MBPDataCompressedReadVarint(Index);
+      uint32_t Length = MBPDataCompressedReadVarint(Index) + 1;
+      Op(Bin, Length, Value);
+      Bin += Length;
+      Value += Length;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MBPDataCompressed::Deconvolve(double* Expectation, double* InvYnew, int Event)
+{
+  //! Perform the list-mode deconvolution - attention the InvYnew is the inverted Yi
+
+  if (m_OneByte == true) {
+    double Factor = m_Maximum / 255.0 * InvYnew[Event];
+    const uint8_t* Values = m_Data + m_IndexBytes;
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { MBPDataCompressedAdd(Factor, Values + First, Expectation + Start, Length); });
+  } else {
+    double Factor = InvYnew[Event];
+    const float* Values = reinterpret_cast<const float*>(m_Data + m_IndexBytes);
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { MBPDataCompressedAdd(Factor, Values + First, Expectation + Start, Length); });
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MBPDataCompressed::Convolve(double* Ynew, int Event, double* Image, int NBins)
+{
+  //! Perform the list-mode convolution
+
+  double Sum = 0;
+
+  if (m_OneByte == true) {
+    const uint8_t* Values = m_Data + m_IndexBytes;
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { Sum += MBPDataCompressedDot(Values + First, Image + Start, Length); });
+    Sum *= m_Maximum / 255.0;
+  } else {
+    const float* Values = reinterpret_cast<const float*>(m_Data + m_IndexBytes);
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { Sum += MBPDataCompressedDot(Values + First, Image + Start, Length); });
+  }
+
+  Ynew[Event] = Sum;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MBPDataCompressed::Sum(double* Image, int NBins)
+{
+  // Just sum it up, i.e. add the content to the image
+
+  if (m_OneByte == true) {
+    double Factor = m_Maximum / 255.0;
+    const uint8_t* Values = m_Data + m_IndexBytes;
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { MBPDataCompressedAdd(Factor, Values + First, Image + Start, Length); });
+  } else {
+    const float* Values = reinterpret_cast<const float*>(m_Data + m_IndexBytes);
+    ForEachRun([&](uint32_t Start, uint32_t Length, uint32_t First) { MBPDataCompressedAdd(1.0, Values + First, Image + Start, Length); });
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MBPDataCompressed::GetUsedBytes() const
+{
+  // Return the number of bytes used by this image
+
+  int Bytes = 0;
+
+  Bytes += MBPData::GetUsedBytes();
+  Bytes += sizeof(void*); // Pointer to m_Data
+  Bytes += 3*sizeof(uint32_t); // m_IndexBytes, m_NEntries, m_NBins
+  Bytes += sizeof(float); // m_Maximum
+  Bytes += sizeof(uint8_t) + sizeof(bool); // m_Representation, m_OneByte
+  Bytes += m_IndexBytes; // the index
+  Bytes += ((m_Representation == c_Dense) ? m_NBins : m_NEntries) * ((m_OneByte == true) ? sizeof(uint8_t) : sizeof(float)); // the values
+
+  return Bytes;
+}
+
+
+// MBPDataCompressed: the end...
+////////////////////////////////////////////////////////////////////////////////
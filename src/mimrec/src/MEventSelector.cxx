@@ -1647,6 +1647,25 @@ void MEventSelector::SetTime(const MTime& Min, const MTime& Max)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+MGTI MEventSelector::GetTimeSelection() const
+{
+  // Return the time selection as GTI, e.g. to let the file readers skip unselected events
+
+  MGTI GTI;
+  if (m_TimeMode == 2) {
+    GTI = m_TimeGTI;
+  } else if (m_TimeMode == 1) {
+    GTI.Reset(false);
+    GTI.AddGoodTimeInterval(m_TimeMin, m_TimeMax);
+  }
+
+  return GTI;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void MEventSelector::SetTimeWalk(double Min, double Max)
 {
   // Set the range of time
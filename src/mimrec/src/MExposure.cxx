@@ -27,6 +27,9 @@
 #include "MExposure.h"
 
 // Standard libs:
+#include <thread>
+#include <algorithm>
+using namespace std;
 
 // ROOT libs:
 
@@ -43,10 +46,14 @@ ClassImp(MExposure)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-MExposure::MExposure() : m_Mode(MExposureMode::Flat), m_LastTime(0),  m_NExposureUpdates(0)
+MExposure::MExposure() : m_Mode(MExposureMode::Flat), m_LastTime(0), m_CurrentTime(0), m_NExposureUpdates(0)
 {
   m_Exposure = new double[1];
   m_Efficiency = nullptr;
+
+  m_UseAttitudeHistogram = false;
+  m_AttitudeBinWidth = 1.0*c_Rad;
+  m_NThreads = 1;
 }
 
 
@@ -82,6 +89,8 @@ bool MExposure::SetDimensions(double x1Min, double x1Max, unsigned int x1NBins,
     m_Exposure[i] = 0.0;
   }
 
+  m_AttitudeHistogram.clear();
+
   m_BinCenterVectors.resize(m_NImageBins);
   m_BinCenterVectorsNearField.resize(m_NImageBins);
   for (unsigned int x3 = 0; x3 < m_x3NBins; ++x3) { // z == radius
@@ -146,12 +155,58 @@ bool MExposure::SetEfficiencyFile(MString EfficiencyFile)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Accumulate the dwell time in a binned attitude histogram first and calculate the exposure
+//! only once per occupied attitude bin
+void MExposure::UseAttitudeHistogram(bool UseIt, double BinWidth)
+{
+  // Apply the dwell time still pending in the old mode -- only the moving far-field exposure accumulates any,
+  // and only once the dimensions have been set
+  if (m_Mode == MExposureMode::CalculateFromEfficiencyFarFieldMoving && m_BinCenterVectors.size() > 0) {
+    ApplyExposure();
+  }
+
+  // The bin keys store 16 bit per angle, thus limit the smallest bin width
+  const double MinimumBinWidth = 0.01*c_Rad;
+  if (BinWidth < MinimumBinWidth) {
+    mout<<"Exposure: The attitude bin width must be at least "<<MinimumBinWidth*c_Deg<<" deg - using that value"<<endl;
+    BinWidth = MinimumBinWidth;
+  }
+
+  m_UseAttitudeHistogram = UseIt;
+  m_AttitudeBinWidth = BinWidth;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Create the exposure for one event
 bool MExposure::Expose(MPhysicalEvent* Event)
 {
   if (m_Mode == MExposureMode::Flat) return true;
   if (m_Mode == MExposureMode::CalculateFromEfficiencyNearFieldStatic) return true;
 
+  if (m_UseAttitudeHistogram == true) {
+    MTime CurrentTime = Event->GetTime();
+    MRotation CurrentRotation = Event->GetGalacticPointingRotationMatrix();
+
+    // The dwell time since the last event is attributed to the current attitude,
+    // time jumps are not counted as in the standard mode
+    if (m_CurrentTime != MTime(0)) {
+      double TimeDiff = (CurrentTime - m_CurrentTime).GetAsSeconds();
+      if (TimeDiff > 60) {
+        cout<<"Exposure: Time jump: "<<m_CurrentTime<<" --> "<<CurrentTime<<endl;
+      } else if (TimeDiff > 0.0) {
+        AddDwellTime(CurrentRotation, TimeDiff);
+      }
+    }
+
+    m_CurrentTime = CurrentTime;
+    m_CurrentRotation = CurrentRotation;
+
+    return true;
+  }
+
   if (m_LastTime == MTime(0)) {
     m_LastTime = Event->GetTime();
     m_LastRotation = Event->GetGalacticPointingRotationMatrix();
@@ -200,7 +255,9 @@ bool MExposure::Expose(MPhysicalEvent* Event)
 //! Apply the exposure
 bool MExposure::ApplyExposure()
 {
-  if (m_Mode == MExposureMode::CalculateFromEfficiencyFarFieldMoving) {
+  if (m_Mode == MExposureMode::CalculateFromEfficiencyFarFieldMoving && m_UseAttitudeHistogram == true) {
+    return ApplyAttitudeHistogram();
+  } else if (m_Mode == MExposureMode::CalculateFromEfficiencyFarFieldMoving) {
 
     double TimeDiff = (m_CurrentTime - m_LastTime).GetAsSeconds();
 
@@ -292,5 +349,142 @@ double MExposure::DistanceMetric(const MRotation& A, const MRotation& B)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Add the dwell time to the attitude bin of the given rotation
+void MExposure::AddDwellTime(const MRotation& Rotation, double DwellTime)
+{
+  uint64_t Key = GetAttitudeBinKey(Rotation);
+
+  auto Iter = m_AttitudeHistogram.find(Key);
+  if (Iter != m_AttitudeHistogram.end()) {
+    (*Iter).second.m_DwellTime += DwellTime;
+  } else {
+    MAttitudeBin Bin;
+    Bin.m_Rotation = Rotation;
+    Bin.m_DwellTime = DwellTime;
+    m_AttitudeHistogram[Key] = Bin;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the key of the attitude bin of the given rotation
+//! The orientation is fully determined by the directions of the x and the z-axis,
+//! thus the key is composed of the direction bins of these two axes
+uint64_t MExposure::GetAttitudeBinKey(const MRotation& Rotation) const
+{
+  uint64_t XKey = GetDirectionBinKey(Rotation.GetX());
+  uint64_t ZKey = GetDirectionBinKey(Rotation.GetZ());
+
+  return (ZKey << 32) | XKey;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the key of the direction bin of the given axis
+//! The sphere is divided into theta rings of the attitude bin width, and each ring into
+//! phi bins of approximately the same arc length to have a near-equal-area binning
+uint32_t MExposure::GetDirectionBinKey(const MVector& Axis) const
+{
+  double Theta = Axis.Theta();
+  double Phi = Axis.Phi();
+  if (Phi < 0) Phi += c_TwoPi;
+
+  unsigned int NThetaBins = (unsigned int) ceil(c_Pi/m_AttitudeBinWidth);
+  unsigned int ThetaBin = (unsigned int) (Theta/m_AttitudeBinWidth);
+  if (ThetaBin >= NThetaBins) ThetaBin = NThetaBins - 1;
+
+  double ThetaCenter = (ThetaBin + 0.5)*m_AttitudeBinWidth;
+  unsigned int NPhiBins = (unsigned int) ceil(c_TwoPi*sin(ThetaCenter)/m_AttitudeBinWidth);
+  if (NPhiBins < 1) NPhiBins = 1;
+  unsigned int PhiBin = (unsigned int) (Phi/c_TwoPi*NPhiBins);
+  if (PhiBin >= NPhiBins) PhiBin = NPhiBins - 1;
+
+  return (uint32_t(ThetaBin) << 16) | uint32_t(PhiBin);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Calculate the exposure of all occupied attitude bins and empty the attitude histogram
+bool MExposure::ApplyAttitudeHistogram()
+{
+  if (m_AttitudeHistogram.size() == 0) return true;
+
+  m_ThreadAttitudeBins.clear();
+  m_ThreadAttitudeBins.reserve(m_AttitudeHistogram.size());
+  for (auto& Bin: m_AttitudeHistogram) {
+    m_ThreadAttitudeBins.push_back(Bin.second);
+  }
+  m_AttitudeHistogram.clear();
+
+  mout<<"Applying exposure for "<<m_ThreadAttitudeBins.size()<<" occupied attitude bins"<<endl;
+  m_NExposureUpdates += m_ThreadAttitudeBins.size();
+
+  // Split the attitude bins between the threads
+  unsigned int NUsedThreads = m_NThreads;
+  if (NUsedThreads > m_ThreadAttitudeBins.size()) NUsedThreads = m_ThreadAttitudeBins.size();
+  unsigned int Split = m_ThreadAttitudeBins.size() / NUsedThreads;
+
+  m_ThreadExposures.clear();
+  m_ThreadExposures.resize(NUsedThreads, vector<double>(m_NImageBins, 0.0));
+
+  vector<thread> Threads(NUsedThreads);
+  for (unsigned int t = 0; t < NUsedThreads; ++t) {
+    unsigned int Start = t*Split;
+    unsigned int Stop = (t == NUsedThreads - 1) ? m_ThreadAttitudeBins.size() - 1 : (t+1)*Split - 1;
+    Threads[t] = thread(&MExposure::ApplyAttitudeHistogramThreadEntry, this, t, Start, Stop);
+  }
+  for (unsigned int t = 0; t < NUsedThreads; ++t) {
+    Threads[t].join();
+  }
+
+  // Merge the thread maps in a fixed order to stay reproducible
+  for (unsigned int t = 0; t < NUsedThreads; ++t) {
+    for (unsigned int i = 0; i < m_NImageBins; ++i) {
+      m_Exposure[i] += m_ThreadExposures[t][i];
+    }
+  }
+
+  m_ThreadExposures.clear();
+  m_ThreadAttitudeBins.clear();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Thread entry: Calculate the exposure of the attitude bins [Start, Stop] into the thread's own map
+void MExposure::ApplyAttitudeHistogramThreadEntry(unsigned int ThreadID, unsigned int Start, unsigned int Stop)
+{
+  vector<double>& Exposure = m_ThreadExposures[ThreadID];
+
+  for (unsigned int b = Start; b <= Stop; ++b) {
+    MRotation Inv = m_ThreadAttitudeBins[b].m_Rotation.GetInvers();
+    double DwellTime = m_ThreadAttitudeBins[b].m_DwellTime;
+
+    for (unsigned int i = 0; i < m_NImageBins; ++i) {
+      // Rotate the bin center vectors into detector coordinates
+      MVector D = Inv*m_BinCenterVectors[i];
+
+      // Get the efficiency value
+      double EfficiencyValue = m_Efficiency->Get(D.ThetaApproximateMaths(), D.PhiApproximateMaths());
+      if (std::isnan(EfficiencyValue)) continue;
+
+      Exposure[i] += EfficiencyValue*DwellTime;
+    }
+  }
+}
+
+
 // MExposure.cxx: the end...
 ////////////////////////////////////////////////////////////////////////////////
@@ -81,7 +81,7 @@ void MGUIAnimation::Create()
   // We start with a name and an icon...
   SetWindowName("Animation");  
 
-  AddSubTitle("Create an animated gif from either backprojections or the iteration process"); 
+  AddSubTitle("Create an animated gif from either backprojections or the iteration process\nWhen imaging in time slices, each deconvolved time slice becomes one frame instead"); 
   
   TGLayoutHints* FrameLayout = new TGLayoutHints(kLHintsLeft | kLHintsTop | kLHintsExpandX, 40, 20, 2, 2);
   TGLayoutHints* MainLayout = new TGLayoutHints(kLHintsLeft | kLHintsTop, 20, 20, 10, 2);
@@ -91,6 +91,16 @@ void MGUIExposure::Create()
 
   AddFrame(m_FileSelector, m_FileSelectorLayout);
 
+  TGLayoutHints* AttitudeLayout = new TGLayoutHints(kLHintsLeft | kLHintsTop | kLHintsExpandX, 20, 20, 10, 2);
+  m_UseAttitudeHistogram = new TGCheckButton(this, "Accumulate the dwell time in an attitude histogram and calculate the exposure once per attitude bin (multi-threaded)", m_UseAttitudeHistogramID);
+  m_UseAttitudeHistogram->SetWrapLength(400);
+  m_UseAttitudeHistogram->SetState(m_Settings->GetExposureUseAttitudeHistogram() ? kButtonDown : kButtonUp);
+  AddFrame(m_UseAttitudeHistogram, AttitudeLayout);
+
+  TGLayoutHints* AttitudeBinWidthLayout = new TGLayoutHints(kLHintsLeft | kLHintsTop | kLHintsExpandX, 40, 20, 2, 2);
+  m_AttitudeBinWidth = new MGUIEEntry(this, "Attitude bin width [deg]:", false, m_Settings->GetExposureAttitudeBinWidth());
+  AddFrame(m_AttitudeBinWidth, AttitudeBinWidthLayout);
+
 
   AddButtons();
 
@@ -113,6 +123,13 @@ bool MGUIExposure::OnApply()
 {
   // The Apply button has been pressed
 
+  if (m_AttitudeBinWidth->IsDouble(0.01, 90) == false) {
+    return false;
+  }
+
+  m_Settings->SetExposureUseAttitudeHistogram(m_UseAttitudeHistogram->GetState() == kButtonDown ? true : false);
+  m_Settings->SetExposureAttitudeBinWidth(m_AttitudeBinWidth->GetAsDouble());
+
   m_Settings->SetExposureEfficiencyFile(m_FileSelector->GetFileName());
   if (m_FileSelector->GetFileName().IsEmpty() == false) {
     m_Settings->SetExposureMode(MExposureMode::CalculateFromEfficiency);
@@ -92,9 +92,11 @@ void MGUIMemory::Create()
   AddFrame(m_MaxRAM, StandardLayout);
 
 
-  m_Bytes = new MGUIERBList(this, "The dynamic range of the response slice corresponding to one event can be represented either in 1 byte (256 intensity steps) or in 4 bytes (float accuracy). While a 1-byte-depth results in marginally worse images, it allows to store roughly 4 times more events:");
+  m_Bytes = new MGUIERBList(this, "The dynamic range of the response slice corresponding to one event can be represented either in 1 byte (256 intensity steps) or in 4 bytes (float accuracy). While a 1-byte-depth results in marginally worse images, it allows to store roughly 4 times more events. The compressed storage chooses the most compact representation for each event, which allows to store several times more events of large images:");
   m_Bytes->Add("1 byte");
   m_Bytes->Add("4 byte");
+  m_Bytes->Add("1 byte, compressed");
+  m_Bytes->Add("4 byte, compressed");
   m_Bytes->SetSelected(m_GUIData->GetBytes());
   m_Bytes->SetWrapLength(Width - m_FontScaler*40);
   m_Bytes->Create();
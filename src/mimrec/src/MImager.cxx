@@ -35,6 +35,10 @@
 #include <iomanip>
 #include <limits>
 #include <cstring>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <fstream>
 using namespace std;
 
 // ROOT libs:
@@ -52,6 +56,7 @@ using namespace std;
 #include "MPhysicalEvent.h"
 #include "MBPDataImage.h"
 #include "MBPDataImageOneByte.h"
+#include "MBPDataCompressed.h"
 #include "MGUIProgressBar.h"
 #include "MSystem.h"
 #include "MResponse.h"
@@ -85,6 +90,7 @@ ClassImp(MImager)
 const int MImager::c_AnimateNothing = 0;
 const int MImager::c_AnimateBackprojections = 1;
 const int MImager::c_AnimateIterations = 2;
+const unsigned int MImager::c_MaxNDisplayedCubeImages = 16;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -132,12 +138,28 @@ MImager::MImager(MCoordinateSystem CoordinateSystem, unsigned int NThreads)
   }
 
   m_Exposure = new MExposure();
+  m_TimeSliceExposures.clear();
+  m_ExposureEfficiencyFileName = "";
+  m_ExposureUseAttitudeHistogram = false;
+  m_ExposureAttitudeBinWidth = 1.0*c_Rad;
+
+  m_xAxis = MVector(1.0, 0.0, 0.0);
+  m_zAxis = MVector(0.0, 0.0, 1.0);
 
   m_EM = nullptr;
+  m_EMAlgorithm = MLMLAlgorithms::c_ClassicEM;
+  m_EMNSubSets = 1;
+  m_EMNIterations = 0;
 
   m_UseAbsorptions = false;
 
   m_BPEvents.clear();
+  m_BPEventCubeIndices.clear();
+  m_EnergyBands.clear();
+  m_TimeSliceStart = MTime(0);
+  m_TimeSliceStop = MTime(0);
+  m_NTimeSlices = 0;
+  m_TimeSliceWarmStart = false;
 
   m_UsedBytes = 0;
   m_UsedBins = 0;
@@ -177,6 +199,7 @@ MImager::~MImager()
 
   delete m_EM;
   delete m_Exposure;
+  DeleteTimeSliceExposures();
 }
 
 
@@ -320,6 +343,10 @@ bool MImager::SetImagingSettings(MSettingsImaging* Settings)
     if (SetExposureEfficiencyFile(Settings->GetExposureEfficiencyFile()) == false) {
       return false;
     }
+    m_Exposure->SetNumberOfThreads(m_NThreads);
+    m_Exposure->UseAttitudeHistogram(Settings->GetExposureUseAttitudeHistogram(), Settings->GetExposureAttitudeBinWidth()*c_Rad);
+    m_ExposureUseAttitudeHistogram = Settings->GetExposureUseAttitudeHistogram();
+    m_ExposureAttitudeBinWidth = Settings->GetExposureAttitudeBinWidth()*c_Rad;
   }
 
   // Memory management...
@@ -331,6 +358,12 @@ bool MImager::SetImagingSettings(MSettingsImaging* Settings)
   // Set the deconvolution settings 
   SetDeconvolutionSettings(Settings);
 
+  // Energy bands
+  SetEnergyBands(Settings->GetImagingEnergyBands());
+
+  // Time slices
+  SetTimeSlices(MTime(Settings->GetImagingTimeSliceStart()), MTime(Settings->GetImagingTimeSliceStop()), Settings->GetImagingNTimeSlices());
+
   return true;
 }
 
@@ -357,6 +390,8 @@ bool MImager::SetDeconvolutionSettings(MSettingsImaging* Settings)
     merr<<"Unknown stop criterion. Stopping after 0 iterations."<<error;
     SetStopCriterionByIterations(0);
   }
+
+  SetTimeSliceWarmStart(Settings->GetImagingTimeSliceWarmStart());
   
   return true;
 }
@@ -414,6 +449,9 @@ void MImager::SetViewport(double x1Min, double x1Max, int x1NBins,
     m_TwoDAxis = 2;
   }
 
+  m_xAxis = xAxis;
+  m_zAxis = zAxis;
+
   // Set the viewport also for the exposure calculation
   m_Exposure->SetDimensions(x1Min, x1Max, x1NBins,
                             x2Min, x2Max, x2NBins,
@@ -476,6 +514,7 @@ bool MImager::SetExposureEfficiencyFile(MString FileName)
   // Set the exposure mode efficiency file
 
   if (m_Exposure->SetEfficiencyFile(FileName) == false) return false;
+  m_ExposureEfficiencyFileName = FileName;
 
   for (unsigned int t = 0; t < m_NThreads; ++t) {
     m_BPs[t]->SetEfficiency(m_Exposure->GetEfficiency());
@@ -646,6 +685,7 @@ void MImager::SetDeconvolutionAlgorithmClassicEM()
 {
   //! Use the classic EM algorithm for deconvolution
 
+  m_EMAlgorithm = MLMLAlgorithms::c_ClassicEM;
   m_EM = new MLMLClassicEM();
 }
 
@@ -657,6 +697,9 @@ void MImager::SetDeconvolutionAlgorithmOSEM(unsigned int NSubSets)
 {
  //! Use the OSEM algorithm for deconvolution
 
+  m_EMAlgorithm = MLMLAlgorithms::c_OSEM;
+  m_EMNSubSets = NSubSets;
+
   MLMLOSEM* EM = new MLMLOSEM();
   EM->SetNSubSets(NSubSets);
 
@@ -671,6 +714,8 @@ void MImager::SetStopCriterionByIterations(int NIterations)
 {
   //! Use a stop criterion by
 
+  m_EMNIterations = NIterations;
+
   if (m_EM == 0) {
     merr<<"You need to set a EM algorithm first!"<<show;
   } else {
@@ -682,11 +727,185 @@ void MImager::SetStopCriterionByIterations(int NIterations)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-void MImager::AddResponseSlice(MBPData* Slice)
+MLMLAlgorithms* MImager::CreateDeconvolutionAlgorithm()
+{
+  //! Create a new deconvolution algorithm with the stored algorithm settings and stop criterion
+
+  MLMLAlgorithms* EM = nullptr;
+  if (m_EMAlgorithm == MLMLAlgorithms::c_OSEM) {
+    MLMLOSEM* OSEM = new MLMLOSEM();
+    OSEM->SetNSubSets(m_EMNSubSets);
+    EM = dynamic_cast<MLMLAlgorithms*>(OSEM);
+  } else {
+    EM = new MLMLClassicEM();
+  }
+  EM->UseStopCriterionByIterations(m_EMNIterations);
+
+  return EM;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::SetEnergyBands(const vector<double>& Edges)
+{
+  //! Set the edges of the energy bands in keV
+
+  vector<double> EnergyBands = Edges;
+  sort(EnergyBands.begin(), EnergyBands.end());
+  EnergyBands.erase(unique(EnergyBands.begin(), EnergyBands.end()), EnergyBands.end());
+  if (EnergyBands.size() < 2) {
+    EnergyBands.clear();
+  }
+
+  if (EnergyBands != m_EnergyBands) {
+    // The band assignment of already computed response slices is no longer valid
+    ClearResponseSlices();
+  }
+
+  m_EnergyBands = EnergyBands;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::SetTimeSlices(const MTime& Start, const MTime& Stop, unsigned int NSlices)
+{
+  //! Split the time from Start to Stop into NSlices equally long time slices
+
+  if (Stop <= Start) NSlices = 0;
+
+  if (NSlices != m_NTimeSlices || (NSlices > 0 && (Start != m_TimeSliceStart || Stop != m_TimeSliceStop))) {
+    // The slice assignment of already computed response slices is no longer valid
+    ClearResponseSlices();
+  }
+
+  m_TimeSliceStart = Start;
+  m_TimeSliceStop = Stop;
+  m_NTimeSlices = NSlices;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MTime MImager::GetTimeSliceMinimum(unsigned int Slice) const
+{
+  //! Return the start of the given time slice
+
+  double Duration = m_TimeSliceStop.GetAsSeconds() - m_TimeSliceStart.GetAsSeconds();
+
+  MTime Minimum = m_TimeSliceStart;
+  Minimum += MTime(Duration*Slice/m_NTimeSlices);
+
+  return Minimum;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MImager::GetTimeSlice(MPhysicalEvent* Event) const
+{
+  //! Return the time slice of the event, or -1 if it is in none of them
+
+  if (UsesTimeSlices() == false) return 0;
+
+  MTime Time = Event->GetTime();
+  if (Time < m_TimeSliceStart || Time >= m_TimeSliceStop) return -1;
+
+  double Duration = m_TimeSliceStop.GetAsSeconds() - m_TimeSliceStart.GetAsSeconds();
+  unsigned int Slice = (unsigned int) ((Time - m_TimeSliceStart).GetAsSeconds()/Duration*m_NTimeSlices);
+
+  return (Slice < m_NTimeSlices) ? int(Slice) : int(m_NTimeSlices) - 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MImager::GetImageCubeIndex(MPhysicalEvent* Event) const
+{
+  //! Return the index of the event in the image cube, or -1 if it is in none of the images
+
+  int Band = GetEnergyBand(Event);
+  if (Band < 0) return -1;
+  int Slice = GetTimeSlice(Event);
+  if (Slice < 0) return -1;
+
+  return Band*max(1U, m_NTimeSlices) + Slice;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MImager::GetImageCubeSuffix(unsigned int Index) const
+{
+  //! Return a file name suffix for the image with the given image cube index
+
+  unsigned int NSlices = max(1U, m_NTimeSlices);
+
+  MString Suffix;
+  if (UsesEnergyBands() == true) {
+    Suffix += ".band";
+    Suffix += Index / NSlices;
+  }
+  if (UsesTimeSlices() == true) {
+    Suffix += ".slice";
+    Suffix += Index % NSlices;
+  }
+
+  return Suffix;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::ClearResponseSlices()
+{
+  //! Delete all response slices
+
+  for (unsigned int i = 0; i < m_BPEvents.size(); ++i) {
+    delete m_BPEvents[i];
+  }
+  m_BPEvents.clear();
+  m_BPEventCubeIndices.clear();
+  m_UsedBytes = 0;
+  m_UsedBins = 0;
+
+  DeleteTimeSliceExposures();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+int MImager::GetEnergyBand(MPhysicalEvent* Event) const
+{
+  //! Return the energy band of the event, or -1 if it is in none of them
+
+  if (UsesEnergyBands() == false) return 0;
+
+  double Energy = Event->GetEnergy();
+  if (Energy < m_EnergyBands.front() || Energy >= m_EnergyBands.back()) return -1;
+
+  return int(upper_bound(m_EnergyBands.begin(), m_EnergyBands.end(), Energy) - m_EnergyBands.begin()) - 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::AddResponseSlice(MBPData* Slice, unsigned int CubeIndex)
 {
   // Add a response slice
 
   m_BPEvents.push_back(Slice);
+  m_BPEventCubeIndices.push_back(CubeIndex);
   m_UsedBytes += Slice->GetUsedBytes();
   m_UsedBins += Slice->GetUsedBins();
 }
@@ -880,6 +1099,10 @@ bool MImager::Analyze(bool CalculateResponse)
     return false;
   }
 
+  if (UsesImageCube() == true) {
+    return AnalyzeImageCube();
+  }
+
   mout<<"Preparing the first image... Please stand by..."<<endl;
 
   // Reset the stop criterion
@@ -1081,6 +1304,413 @@ bool MImager::Analyze(bool CalculateResponse)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MImager::AnalyzeImageCube()
+{
+  //! Deconvolve all images of the image cube concurrently, each with its own algorithm
+  //! The response slices have been computed in one pass through the events and are only split here
+
+  unsigned int NBands = max(1U, GetNEnergyBands());
+  unsigned int NSlices = max(1U, GetNTimeSlices());
+  unsigned int NImages = NBands*NSlices;
+
+  if (m_AnimationMode != c_AnimateNothing && UsesTimeSlices() == false) {
+    mout<<"Animations of an image cube need time slices - ignoring the animation of the energy bands"<<endl;
+  }
+
+  // Split the response slices into the images of the cube:
+  vector<vector<MBPData*>> CubeEvents(NImages);
+  for (unsigned int e = 0; e < m_BPEvents.size(); ++e) {
+    if (m_BPEventCubeIndices[e] < NImages) {
+      CubeEvents[m_BPEventCubeIndices[e]].push_back(m_BPEvents[e]);
+    }
+  }
+
+  // The algorithms are multi-threaded themselves, thus distribute the threads onto the images deconvolved in parallel
+  unsigned int NParallel = min(NImages, m_NThreads);
+  unsigned int NThreadsPerImage = max(1U, m_NThreads/NParallel);
+
+  mout<<"Preparing the deconvolution of "<<NImages<<" images ("<<NBands<<" energy band(s), "<<NSlices<<" time slice(s))... Please stand by..."<<endl;
+
+  vector<MLMLAlgorithms*> EMs(NImages, nullptr);
+  unsigned int NDeconvolutions = 0;
+  for (unsigned int i = 0; i < NImages; ++i) {
+    mout<<GetImageCubeDescription(i)<<": "<<CubeEvents[i].size()<<" events"<<endl;
+    if (CubeEvents[i].size() == 0) continue;
+
+    EMs[i] = CreateDeconvolutionAlgorithm();
+    // Only the main thread is allowed to interact with the GUI
+    EMs[i]->EnableGUIInteractions(false);
+    EMs[i]->SetResponseSlices(CubeEvents[i], m_NBins);
+    EMs[i]->SetNumberOfThreads(NThreadsPerImage);
+    // Each time slice is normalized by the exposure accumulated during its own time interval
+    if (m_TimeSliceExposures.size() == NSlices) {
+      EMs[i]->SetExposure(m_TimeSliceExposures[i % NSlices]);
+    } else {
+      EMs[i]->SetExposure(m_Exposure);
+    }
+    ++NDeconvolutions;
+  }
+
+  if (m_Exposure->GetMode() != MExposureMode::Flat) {
+    // Display the exposure map
+    double* Map = m_Exposure->GetExposure();
+    MImage* ExposureMap = CreateImage("Exposure Map", Map);
+    delete [] Map;
+    if (ExposureMap == nullptr) {
+      // Error message already displayed
+      for (unsigned int i = 0; i < NImages; ++i) delete EMs[i];
+      return false;
+    }
+    ExposureMap->Display();
+  }
+
+  // With warm start, first every second time slice is deconvolved starting from a flat image,
+  // then the others starting from the mean image of their neighbours
+  vector<vector<unsigned int>> Waves(1);
+  if (m_TimeSliceWarmStart == true && NSlices > 1) {
+    Waves.resize(2);
+  }
+  for (unsigned int i = 0; i < NImages; ++i) {
+    if (EMs[i] == nullptr) continue;
+    if (Waves.size() == 2 && (i % NSlices) % 2 == 1) {
+      Waves[1].push_back(i);
+    } else {
+      Waves[0].push_back(i);
+    }
+  }
+
+  MTimer IterationTimer;
+
+  vector<double*> Results(NImages, nullptr);
+  vector<unsigned int> NIterations(NImages, 0);
+  atomic<unsigned int> NPerformedIterations(0);
+  atomic<bool> Cancel(false);
+
+  auto Deconvolve = [&](unsigned int i, bool WarmStart) {
+    if (WarmStart == true) {
+      vector<double> Start(m_NBins, 0.0);
+      unsigned int NNeighbours = 0;
+      unsigned int Slice = i % NSlices;
+      if (Slice > 0 && Results[i-1] != nullptr) {
+        for (int b = 0; b < m_NBins; ++b) Start[b] += Results[i-1][b];
+        ++NNeighbours;
+      }
+      if (Slice+1 < NSlices && Results[i+1] != nullptr) {
+        for (int b = 0; b < m_NBins; ++b) Start[b] += Results[i+1][b];
+        ++NNeighbours;
+      }
+      if (NNeighbours > 0) {
+        for (int b = 0; b < m_NBins; ++b) Start[b] /= NNeighbours;
+        EMs[i]->SetInitialImage(&Start[0]);
+      }
+    }
+    EMs[i]->ResetStopCriterion();
+    Results[i] = EMs[i]->GetInitialImage();
+    while (EMs[i]->IsStopCriterionFullfilled() == false && Cancel == false) {
+      EMs[i]->DoOneIteration();
+      Results[i] = EMs[i]->GetImage();
+      ++NIterations[i];
+      ++NPerformedIterations;
+    }
+  };
+
+  MGUIProgressBar* Progress = nullptr;
+  if (gROOT->IsBatch() == false) {
+    Progress = new MGUIProgressBar();
+    Progress->SetTitles("Progress", "Progress of deconvolution iterations of all images");
+    Progress->SetMinMax(0, NDeconvolutions*max(m_EMNIterations, 1));
+  }
+  for (unsigned int w = 0; w < Waves.size() && Cancel == false; ++w) {
+    atomic<unsigned int> NextTask(0);
+    atomic<unsigned int> NFinishedWorkers(0);
+    unsigned int NWorkers = min(NParallel, (unsigned int) Waves[w].size());
+    vector<thread> Workers;
+    for (unsigned int t = 0; t < NWorkers; ++t) {
+      Workers.push_back(thread([&, w]() {
+        unsigned int Task = 0;
+        while ((Task = NextTask++) < Waves[w].size() && Cancel == false) {
+          Deconvolve(Waves[w][Task], w > 0);
+        }
+        ++NFinishedWorkers;
+      }));
+    }
+    while (NFinishedWorkers < NWorkers) {
+      // Sleep for a while...
+      TThread::Sleep(0, 10000000);
+      if (gROOT->IsBatch() == false) {
+        Progress->SetValue(NPerformedIterations);
+        gSystem->ProcessEvents();
+        if (Progress->TestCancel() == true) {
+          Cancel = true;
+        }
+      }
+    }
+    for (unsigned int t = 0; t < Workers.size(); ++t) {
+      Workers[t].join();
+    }
+  }
+  delete Progress;
+
+  IterationTimer.Pause();
+  if (NPerformedIterations > 0) {
+    mout<<"Performed "<<NPerformedIterations<<" iterations for "<<NImages<<" images in "<<IterationTimer.GetElapsed()<<" seconds"<<endl;
+  }
+  mout<<endl;
+
+
+  // Store the image cube, and create and display the final images:
+  m_ImageCube.assign(NImages, vector<double>(m_NBins, 0.0));
+  m_ImageCubeNEvents.resize(NImages);
+  m_ImageCubeNIterations = NIterations;
+  for (unsigned int i = 0; i < NImages; ++i) {
+    if (Results[i] != nullptr) {
+      copy(Results[i], Results[i] + m_NBins, m_ImageCube[i].begin());
+    }
+    m_ImageCubeNEvents[i] = CubeEvents[i].size();
+    delete EMs[i];
+  }
+
+  for (unsigned int i = 0; i < m_Images.size(); ++i) {
+    delete m_Images[i];
+  }
+  m_Images.clear();
+
+  bool DisplayImages = (NImages <= c_MaxNDisplayedCubeImages);
+  if (DisplayImages == false) {
+    mout<<"The image cube consists of "<<NImages<<" images, too many to display all of them - save the image cube to look at them"<<endl;
+  }
+  for (unsigned int i = 0; i < NImages; ++i) {
+    ostringstream Title;
+    Title<<"Image - "<<GetImageCubeDescription(i)<<" - iteration: "<<NIterations[i];
+
+    MImage* Image = CreateImage(Title.str().c_str(), &m_ImageCube[i][0]);
+    if (Image == nullptr) {
+      // Error message already displayed
+      return false;
+    }
+    Image->Normalize(true);
+    if (DisplayImages == true) {
+      Image->Display();
+    }
+    m_Images.push_back(Image->Clone());
+    delete Image;
+  }
+
+  if (m_AnimationMode != c_AnimateNothing && UsesTimeSlices() == true) {
+    AnimateImageCube();
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::AnimateImageCube()
+{
+  //! Write one animation frame per time slice of each energy band of the image cube
+  //! All frames come from the one pass through the events, thus no imaging is repeated per frame
+
+  unsigned int NBands = max(1U, GetNEnergyBands());
+  unsigned int NSlices = max(1U, GetNTimeSlices());
+  if (m_ImageCube.size() != NBands*NSlices) return;
+
+  for (unsigned int b = 0; b < NBands; ++b) {
+    // Create a temporary file prefix:
+    MString Prefix = "/tmp/MimrecAnimation_";
+    TRandom R;
+    R.SetSeed(0); // 0 = Random seed defined by clock time
+    for (unsigned int i = 0; i < 20; ++i) {
+      Prefix += char(int('a') + R.Integer(26));
+    }
+    Prefix += "_";
+
+    // The frames are rendered in one canvas, which needs to be displayed to be saved
+    MImage* Image = CreateImage("Animation", &m_ImageCube[b*NSlices][0]);
+    if (Image == nullptr) {
+      // Error message already displayed
+      return;
+    }
+    Image->Normalize(true);
+    Image->Display();
+
+    for (unsigned int s = 0; s < NSlices; ++s) {
+      if (Image->CanvasExists() == false) break;
+
+      unsigned int i = b*NSlices + s;
+      ostringstream Title;
+      Title<<"t = ["<<GetTimeSliceMinimum(s).GetAsSeconds()<<", "<<GetTimeSliceMaximum(s).GetAsSeconds()<<"] sec";
+      if (UsesEnergyBands() == true) {
+        Title<<", E = ["<<GetEnergyBandMinimum(b)<<", "<<GetEnergyBandMaximum(b)<<"] keV";
+      }
+      Image->SetTitle(Title.str().c_str());
+      Image->SetImageArray(&m_ImageCube[i][0]);
+
+      ostringstream Save;
+      Save<<Prefix<<setw(5)<<setfill('0')<<s<<".gif";
+      Image->SaveAs(Save.str().c_str());
+      gSystem->ProcessEvents();
+    }
+    delete Image;
+
+    MString FileName = m_AnimationFileName;
+    if (NBands > 1) {
+      MString Suffix = ".band";
+      Suffix += b;
+      Suffix += ".gif";
+      FileName = FileName.ReplaceAll(".gif", Suffix);
+      if (FileName == m_AnimationFileName) FileName.Append(Suffix);
+    }
+
+    // Concatenate images
+    mout<<"Started creating animation... please wait a while..."<<endl;
+    ostringstream command1;
+    command1<<"convert -loop 2 -delay 20 "<<Prefix<<"*.gif "<<FileName<<endl;
+    gSystem->Exec(command1.str().c_str());
+    ostringstream command2;
+    command2<<"rm "<<Prefix<<"*.gif "<<endl;
+    gSystem->Exec(command2.str().c_str());
+
+    mout<<"The file "<<FileName<<" with one frame per time slice has been generated."<<endl;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MImager::CreateTimeSliceExposures()
+{
+  //! Create one exposure calculator per time slice with the settings of the main exposure calculator
+
+  DeleteTimeSliceExposures();
+
+  // Only the exposure of a moving far-field instrument depends on time, the flat and the static near-field exposure are the same for all time slices
+  if (UsesTimeSlices() == false || m_Exposure->GetMode() != MExposureMode::CalculateFromEfficiencyFarFieldMoving) return true;
+
+  for (unsigned int s = 0; s < m_NTimeSlices; ++s) {
+    MExposure* Exposure = new MExposure();
+    m_TimeSliceExposures.push_back(Exposure);
+    if (Exposure->SetEfficiencyFile(m_ExposureEfficiencyFileName) == false) return false;
+    Exposure->SetNumberOfThreads(m_NThreads);
+    if (Exposure->SetDimensions(m_x1Min, m_x1Max, m_x1NBins,
+                                m_x2Min, m_x2Max, m_x2NBins,
+                                m_x3Min, m_x3Max, m_x3NBins,
+                                m_xAxis, m_zAxis) == false) return false;
+    Exposure->UseAttitudeHistogram(m_ExposureUseAttitudeHistogram, m_ExposureAttitudeBinWidth);
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MImager::DeleteTimeSliceExposures()
+{
+  //! Delete the exposure calculators of the time slices
+
+  for (unsigned int s = 0; s < m_TimeSliceExposures.size(); ++s) {
+    delete m_TimeSliceExposures[s];
+  }
+  m_TimeSliceExposures.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MImager::GetImageCubeDescription(unsigned int Index) const
+{
+  //! Return a description of the image with the given image cube index, e.g. "energy band [200, 500] keV, time slice [10, 20] sec"
+
+  unsigned int NSlices = max(1U, m_NTimeSlices);
+
+  ostringstream Description;
+  if (UsesEnergyBands() == true) {
+    unsigned int Band = Index / NSlices;
+    Description<<"energy band ["<<GetEnergyBandMinimum(Band)<<", "<<GetEnergyBandMaximum(Band)<<"] keV";
+  }
+  if (UsesTimeSlices() == true) {
+    unsigned int Slice = Index % NSlices;
+    if (UsesEnergyBands() == true) Description<<", ";
+    Description<<"time slice ["<<GetTimeSliceMinimum(Slice).GetAsSeconds()<<", "<<GetTimeSliceMaximum(Slice).GetAsSeconds()<<"] sec";
+  }
+
+  return Description.str().c_str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MImager::SaveImageCube(const MString& FileName)
+{
+  //! Save all images of the image cube together with the number of events per image in one file
+
+  if (m_ImageCube.size() == 0) {
+    merr<<"There is no image cube to save"<<show;
+    return false;
+  }
+
+  ofstream out;
+  out.open(FileName);
+  if (out.is_open() == false) {
+    merr<<"Unable to open file \""<<FileName<<"\" for writing."<<show;
+    return false;
+  }
+
+  // The axes in the units of the displayed images
+  double x1Min = m_x1Min, x1Max = m_x1Max, x2Min = m_x2Min, x2Max = m_x2Max;
+  if (m_CoordinateSystem == MCoordinateSystem::c_Spheric) {
+    x1Min *= c_Deg; x1Max *= c_Deg; x2Min *= c_Deg; x2Max *= c_Deg;
+  } else if (m_CoordinateSystem == MCoordinateSystem::c_Galactic) {
+    x1Min *= c_Deg; x1Max *= c_Deg; x2Min = x2Min*c_Deg - 90; x2Max = x2Max*c_Deg - 90;
+  }
+
+  out<<"# Image cube of mimrec"<<endl;
+  out<<endl;
+  out<<"Type ImageCube"<<endl;
+  out<<"Version 1"<<endl;
+  out<<endl;
+  out<<"CS "<<m_CoordinateSystem<<endl;
+  out<<setprecision(10);
+  out<<"XA "<<x1Min<<" "<<x1Max<<" "<<m_x1NBins<<endl;
+  out<<"YA "<<x2Min<<" "<<x2Max<<" "<<m_x2NBins<<endl;
+  out<<"ZA "<<m_x3Min<<" "<<m_x3Max<<" "<<m_x3NBins<<endl;
+  if (UsesEnergyBands() == true) {
+    out<<"EB";
+    for (unsigned int b = 0; b < m_EnergyBands.size(); ++b) out<<" "<<m_EnergyBands[b];
+    out<<endl;
+  }
+  if (UsesTimeSlices() == true) {
+    out<<"TS "<<m_TimeSliceStart.GetLongIntsString()<<" "<<m_TimeSliceStop.GetLongIntsString()<<" "<<m_NTimeSlices<<endl;
+  }
+  out<<endl;
+
+  // One line per image: index, energy band, time slice, number of events (the light curve), performed iterations, image data
+  unsigned int NSlices = max(1U, m_NTimeSlices);
+  for (unsigned int i = 0; i < m_ImageCube.size(); ++i) {
+    out<<"IM "<<i<<" "<<i/NSlices<<" "<<i%NSlices<<" "<<m_ImageCubeNEvents[i]<<" "<<m_ImageCubeNIterations[i];
+    for (unsigned int b = 0; b < m_ImageCube[i].size(); ++b) {
+      out<<" "<<m_ImageCube[i][b];
+    }
+    out<<endl;
+  }
+  out<<"EN"<<endl;
+  out.close();
+
+  mout<<"Image cube with "<<m_ImageCube.size()<<" images saved as \""<<FileName<<"\""<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 bool MImager::ComputeResponseSlices()
 {
   // Computes and stores the system-matrix
@@ -1102,6 +1732,12 @@ bool MImager::ComputeResponseSlices()
     m_BPs[t]->PrepareBackprojection();
   }
 
+  // The exposure of the time slices is accumulated during the same pass as the response slices
+  if (CreateTimeSliceExposures() == false) {
+    mout<<"Unable to set up the exposure calculation of the time slices - all time slices will use the exposure of the full observation"<<endl;
+    DeleteTimeSliceExposures();
+  }
+
   m_EventFile.ShowProgress(true);
   m_EventFile.SetProgressTitle("Progress", "Progress of response slice generation");
 
@@ -1175,6 +1811,7 @@ bool MImager::ComputeResponseSlices()
       m_UsedBins -= (*Iter)->GetUsedBins();
       delete *Iter;
       m_BPEvents.erase(Iter);
+      m_BPEventCubeIndices.erase(m_BPEventCubeIndices.begin());
     }
   }
 
@@ -1237,13 +1874,16 @@ void* MImager::ResponseSliceComputationThread(unsigned int ThreadID)
 
     /// IsQualified is NOT reentrant --- but the only thing modified are its counters, which we do not use here...
     if (m_Selector.IsQualifiedEventFast(Event) == true) {
+      // In image cube mode, the events outside all energy bands and time slices are not backprojected
+      int CubeIndex = GetImageCubeIndex(Event);
+
       // Reinitialize the array keeping the events backprojection
       // Memcopy is only faster if the parallism of modern CPUs cannot be used. With gcc -O3 this is fastest:
       //for (int i = 0; i < m_NBins; ++i) BackprojectionImage[i] = 0.0;
 
       // Try to backproject the data and store the computed t_ij in BackprojectionImage
       NUsedBins = 0;
-      if (m_BPs[ThreadID]->Backproject(Event, BackprojectionImage, BackprojectionBins, NUsedBins, Maximum) == true && NUsedBins > 0) {
+      if (CubeIndex >= 0 && m_BPs[ThreadID]->Backproject(Event, BackprojectionImage, BackprojectionBins, NUsedBins, Maximum) == true && NUsedBins > 0) {
 
         // It might happen that we go out of memory during imaging, catch it!
         // 1-byte-storage:
@@ -1283,9 +1923,18 @@ void* MImager::ResponseSliceComputationThread(unsigned int ThreadID)
               EnoughMemory = false;
             }
          }
+        }
+        // 1-byte or 4-byte storage, representation chosen per event:
+        else if (m_ComputationAccuracy == 2 || m_ComputationAccuracy == 3) {
+          Data = new(nothrow) MBPDataCompressed(m_ComputationAccuracy == 2);
+          if (Data != 0) {
+            EnoughMemory = Data->Initialize(BackprojectionImage, BackprojectionBins, m_NBins, NUsedBins, Maximum);
+          } else {
+            EnoughMemory = false;
+          }
         } else {
           // "merr" not thread safe --- but we crash anyway ;-)
-          merr<<"m_ComputationAccuracy must be 0 (1 byte storage) or 1 (4 byte storage): "<<m_ComputationAccuracy<<fatal;
+          merr<<"m_ComputationAccuracy must be 0 (1 byte storage), 1 (4 byte storage), 2 (1 byte compressed storage), or 3 (4 byte compressed storage): "<<m_ComputationAccuracy<<fatal;
         }
 
         if (EnoughMemory == false) {
@@ -1295,7 +1944,7 @@ void* MImager::ResponseSliceComputationThread(unsigned int ThreadID)
         }
 
         m_Mutex.Lock();
-        AddResponseSlice(Data);
+        AddResponseSlice(Data, CubeIndex);
         if (GetUsedBytes() > m_MaxBytes) {
           cout<<"Thread "<<ThreadID<<": Used RAM exceeds the user set maximum ("<<m_MaxBytes/1024/1024<<" MB)  --- finishing..."<<endl;
           m_Mutex.UnLock();
@@ -1308,6 +1957,16 @@ void* MImager::ResponseSliceComputationThread(unsigned int ThreadID)
       if (ThreadID == 0) {
         m_Exposure->Expose(Event);
       }
+
+      // A short time slice might not see any event of the first thread, thus its exposure is accumulated from the events of all threads
+      if (m_TimeSliceExposures.size() > 0) {
+        int Slice = GetTimeSlice(Event);
+        if (Slice >= 0 && (unsigned int) Slice < m_TimeSliceExposures.size()) {
+          m_Mutex.Lock();
+          m_TimeSliceExposures[Slice]->Expose(Event);
+          m_Mutex.UnLock();
+        }
+      }
     }
 
     //m_Mutex.Lock();
@@ -52,6 +52,7 @@ using namespace std;
 #include "MPhysicalEvent.h"
 #include "MBPDataImage.h"
 #include "MBPDataImageOneByte.h"
+#include "MBPDataCompressed.h"
 #include "MGUIProgressBar.h"
 #include "MSystem.h"
 #include "MResponse.h"
@@ -194,8 +195,8 @@ MBPData* MImagerExternallyManaged::CalculateResponseSlice(MPhysicalEvent* Event)
 
   MBPData* Data = 0;
 
-  // Switch to four byte storage if we exceed 2^16 bins:
-  if (m_NBins >= 65536) {
+  // Switch to four byte storage if we exceed 2^16 bins -- the compressed storage has no such limit:
+  if (m_NBins >= 65536 && m_ComputationAccuracy < 2) {
     m_ComputationAccuracy = 1;
   }
 
@@ -253,8 +254,17 @@ MBPData* MImagerExternallyManaged::CalculateResponseSlice(MPhysicalEvent* Event)
             EnoughMemory = false;
           }
         }
+      }
+      // 1-byte or 4-byte storage, representation chosen per event:
+      else if (m_ComputationAccuracy == 2 || m_ComputationAccuracy == 3) {
+        Data = new(nothrow) MBPDataCompressed(m_ComputationAccuracy == 2);
+        if (Data != 0) {
+          EnoughMemory = Data->Initialize(BackprojectionImage, BackprojectionBins, m_NBins, NUsedBins, Maximum);
+        } else {
+          EnoughMemory = false;
+        }
       } else {
-        merr<<"m_ComputationAccuracy must be 0 (1 byte storage) or 1 (4 byte storage): "<<m_ComputationAccuracy<<fatal;
+        merr<<"m_ComputationAccuracy must be 0 (1 byte storage), 1 (4 byte storage), 2 (1 byte compressed storage), or 3 (4 byte compressed storage): "<<m_ComputationAccuracy<<fatal;
       }
     }
 
@@ -58,6 +58,7 @@ using namespace std;
 #include "MStreams.h"
 #include "MEventSelector.h"
 #include "MPrelude.h"
+#include "MDGeometry.h"
 #include "MDDetector.h"
 #include "MDVolumeSequence.h"
 #include "MFitFunctions.h"
@@ -75,6 +76,7 @@ using namespace std;
 #include "MResponseEnergyLeakage.h"
 #include "MBinnerBayesianBlocks.h"
 #include "MARMFitter.h"
+#include "MSignificanceMap.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -180,6 +182,8 @@ bool MInterfaceMimrec::ParseCommandLine(int argc, char** argv)
   Usage<<"             Do not use a graphical user interface"<<endl;
   Usage<<"      -k --keep-alive:"<<endl;
   Usage<<"             Do not quit after executing a batch run, if we do have a gui"<<endl;
+  Usage<<"         --no-geometry-cache:"<<endl;
+  Usage<<"             Do not read or write the cache of the preprocessed geometry setup file"<<endl;
   //Usage<<"         --special:"<<endl;
   //Usage<<"             Activate special mode"<<endl;
   //Usage<<"      -  --:"<<endl;
@@ -239,6 +243,9 @@ bool MInterfaceMimrec::ParseCommandLine(int argc, char** argv)
     } else if (Option == "--debug" || Option == "-d") {
       if (g_Verbosity < 2) g_Verbosity = 2;
       cout<<"Command-line parser: Use debug mode"<<endl;
+    } else if (Option == "--no-geometry-cache") {
+      MDGeometry::UseCache(false);
+      cout<<"Command-line parser: Do not use the geometry cache"<<endl;
     } else if (Option == "--configuration" || Option == "-c") {
       MString FileName = argv[++i];
       if (MFile::Exists(FileName) == false) {
@@ -666,13 +673,31 @@ void MInterfaceMimrec::Reconstruct(bool Animate)
     //     m_Imager->GetImage(i)->Display();
     //   }
   } else {
-    if (m_Imager->GetNImages() > 0) {
+    if (m_Imager->UsesImageCube() == true) {
+      for (unsigned int i = 0; i < m_Imager->GetNImages() && i < MImager::c_MaxNDisplayedCubeImages; ++i) {
+        m_Imager->GetImage(i)->Display();
+      }
+    } else if (m_Imager->GetNImages() > 0) {
       m_Imager->GetImage(m_Imager->GetNImages() - 1)->Display();
     }
   }
 
   if (m_OutputFileName.IsEmpty() == false) {
-    if (m_Imager->GetNImages() > 0) {
+    if (m_Imager->UsesImageCube() == true) {
+      size_t Dot = m_OutputFileName.Last('.');
+      MString Base = (Dot != string::npos) ? m_OutputFileName.GetSubString(0, Dot) : m_OutputFileName;
+      MString Extension = (Dot != string::npos) ? m_OutputFileName.GetSubString(Dot) : MString("");
+
+      // All images in one file, e.g. Image.png -> Image.cube ...
+      m_Imager->SaveImageCube(Base + ".cube");
+      // ... and if there are not too many, each in its own file, e.g. Image.png -> Image.band0.slice3.png
+      if (m_Imager->GetNImages() <= MImager::c_MaxNDisplayedCubeImages) {
+        for (unsigned int i = 0; i < m_Imager->GetNImages(); ++i) {
+          m_Imager->GetImage(i)->Display();
+          m_Imager->GetImage(i)->SaveAs(Base + m_Imager->GetImageCubeSuffix(i) + Extension);
+        }
+      }
+    } else if (m_Imager->GetNImages() > 0) {
       m_Imager->GetImage(m_Imager->GetNImages() - 1)->Display();
       m_Imager->GetImage(m_Imager->GetNImages() - 1)->SaveAs(m_OutputFileName);
     }
@@ -754,16 +779,18 @@ bool MInterfaceMimrec::InitializeEventLoader(MString File)
   if (m_EventFile != nullptr) delete m_EventFile;
   m_EventFile = new MFileEventsTra();
   
+  m_Selector->Reset();
+  m_Selector->SetGeometry(m_Geometry);
+  m_Selector->SetSettings(m_Settings);
+
   m_EventFile->SetFastFileParsing(m_Settings->GetFastFileParsing());
+  // If the file has a time index, only the blocks overlapping with the selected time intervals are read
+  m_EventFile->SetTimeSelection(m_Selector->GetTimeSelection());
   if (m_EventFile->Open(File) == false) return false;
   m_EventFile->ShowProgress(m_UseGui);
   if (m_Settings->GetNThreads() > 1) {
     m_EventFile->StartThread();
   }
-  
-  m_Selector->Reset();
-  m_Selector->SetGeometry(m_Geometry);
-  m_Selector->SetSettings(m_Settings);
 
   return true;
 }
@@ -2284,9 +2311,6 @@ void MInterfaceMimrec::SignificanceMap()
   double Radius = m_Settings->GetSignificanceMapRadius();
   double Distance = m_Settings->GetSignificanceMapDistance();
 
-  double dX = (XMax-XMin)/((double)NBinsXAngle);
-  double dY = (YMax-YMin)/((double)NBinsYAngle);
-  
   // Initalize the image size (x-axis)
   TH2D* Hist_CenterCounts = new TH2D("SignificanceMap_C", "Counts at each point within ARM cut", 
       NBinsXAngle, XMin, XMax,
@@ -2387,148 +2411,68 @@ void MInterfaceMimrec::SignificanceMap()
           NBinsXAngle, XMin, XMax,
           NBinsYAngle, YMin, YMax);
 
-  MVector BinCenter, TestPoint1, TestPoint2, TestPoint3, TestPoint4,
-    TestPoint5, TestPoint6, TestPoint7, TestPoint8;
-  int n_testpoints;
-  double DistDiag = Distance/sqrt(2.);
   mout << "  Distance: " << Distance << endl;
   mout << "  Radius:   " << Radius << endl;
 
+  // The counting only tests the bins in the band around each Compton cone, and uses several threads
+  MSignificanceMap Counter;
+  Counter.SetBinning(XMin, XMax, NBinsXAngle, YMin, YMax, NBinsYAngle);
+  Counter.SetTestPoints(Radius, Distance);
+  Counter.SetCoordinateSystem(m_Settings->GetCoordinateSystem());
+  Counter.SetNumberOfThreads(m_Settings->GetNThreads() > 0 ? m_Settings->GetNThreads() : 1);
+  Counter.Initialize();
+
+  const unsigned int NEventsPerBlock = 10000;
+  vector<MComptonEvent*> ComptonEvents;
+  ComptonEvents.reserve(NEventsPerBlock);
+
   MPhysicalEvent* Event = nullptr;
-  MComptonEvent* ComptonEvent = nullptr; 
-  // ... loop over all events and save a count in the belonging bin ...
+  // ... loop over all events and count them in blocks ...
   while ((Event = GetNextEvent()) != 0) {
     
     // Only accept Comptons within the selected ranges...
-    if (m_Selector->IsQualifiedEventFast(Event) == true) {
-      if (Event->GetType() == MPhysicalEvent::c_Compton) {
-        ComptonEvent = dynamic_cast<MComptonEvent*>(Event);
-        // Go through each bin and record the counts
-        for (int i_X=0; i_X<NBinsXAngle; i_X++) {
-          double L = XMin + dX*(double)i_X + dX/2.;
-          for (int i_Y=0; i_Y<NBinsYAngle; i_Y++) {
-            double B = YMin + dY*(double)i_Y + dY/2.;
-            // add Compton events that fall within the Radius of the center of each bin
-            BinCenter.SetMagThetaPhi(c_FarAway, (B+90)*c_Rad, L*c_Rad);
-            // Fix these test points... just using simple formulae for now, should use rotations
-            TestPoint1.SetMagThetaPhi(c_FarAway, (90+B+Distance)*c_Rad, (L         )*c_Rad);
-            TestPoint2.SetMagThetaPhi(c_FarAway, (90+B+DistDiag)*c_Rad, (L-DistDiag)*c_Rad);
-            TestPoint3.SetMagThetaPhi(c_FarAway, (90+B         )*c_Rad, (L-Distance)*c_Rad);
-            TestPoint4.SetMagThetaPhi(c_FarAway, (90+B-DistDiag)*c_Rad, (L-DistDiag)*c_Rad);
-            TestPoint5.SetMagThetaPhi(c_FarAway, (90+B-Distance)*c_Rad, (L         )*c_Rad);
-            TestPoint6.SetMagThetaPhi(c_FarAway, (90+B-DistDiag)*c_Rad, (L+DistDiag)*c_Rad);
-            TestPoint7.SetMagThetaPhi(c_FarAway, (90+B         )*c_Rad, (L+Distance)*c_Rad);
-            TestPoint8.SetMagThetaPhi(c_FarAway, (90+B+DistDiag)*c_Rad, (L+DistDiag)*c_Rad);
-            bool at_center = (fabs(ComptonEvent->GetARMGamma(BinCenter, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP1 = (fabs(ComptonEvent->GetARMGamma(TestPoint1, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP2 = (fabs(ComptonEvent->GetARMGamma(TestPoint2, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP3 = (fabs(ComptonEvent->GetARMGamma(TestPoint3, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP4 = (fabs(ComptonEvent->GetARMGamma(TestPoint4, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP5 = (fabs(ComptonEvent->GetARMGamma(TestPoint5, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP6 = (fabs(ComptonEvent->GetARMGamma(TestPoint6, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP7 = (fabs(ComptonEvent->GetARMGamma(TestPoint7, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            bool at_TP8 = (fabs(ComptonEvent->GetARMGamma(TestPoint8, m_Settings->GetCoordinateSystem())*c_Deg)<=Radius);
-            n_testpoints = 0;
-            if (at_TP1) n_testpoints++;
-            if (at_TP2) n_testpoints++;
-            if (at_TP3) n_testpoints++;
-            if (at_TP4) n_testpoints++;
-            if (at_TP5) n_testpoints++;
-            if (at_TP6) n_testpoints++;
-            if (at_TP7) n_testpoints++;
-            if (at_TP8) n_testpoints++;
-            // Counts at center and test point
-            if (at_center) {
-              Hist_CenterCounts->Fill(L,B);
-            }
-            if (at_TP1) {
-              Hist_Counts1->Fill(L,B);
-            }
-            if (at_TP2) {
-              Hist_Counts2->Fill(L,B);
-            }
-            if (at_TP3) {
-              Hist_Counts3->Fill(L,B);
-            }
-            if (at_TP4) {
-              Hist_Counts4->Fill(L,B);
-            }
-            if (at_TP5) {
-              Hist_Counts5->Fill(L,B);
-            }
-            if (at_TP6) {
-              Hist_Counts6->Fill(L,B);
-            }
-            if (at_TP7) {
-              Hist_Counts7->Fill(L,B);
-            }
-            if (at_TP8) {
-              Hist_Counts8->Fill(L,B);
-            }
-            // Counts at center and K test points
-            if (at_center && (n_testpoints==0)) {
-              Hist_Center_0->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==1)) {
-              Hist_Center_1->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==2)) {
-              Hist_Center_2->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==3)) {
-              Hist_Center_3->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==4)) {
-              Hist_Center_4->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==5)) {
-              Hist_Center_5->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==6)) {
-              Hist_Center_6->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==7)) {
-              Hist_Center_7->Fill(L,B);
-            }
-            if (at_center && (n_testpoints==8)) {
-              Hist_Center_8->Fill(L,B);
-            }
-            // No counts at center, but at K test points
-            if (!at_center && (n_testpoints==1)) {
-              Hist_NoCenter_1->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==2)) {
-              Hist_NoCenter_2->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==3)) {
-              Hist_NoCenter_3->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==4)) {
-              Hist_NoCenter_4->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==5)) {
-              Hist_NoCenter_5->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==6)) {
-              Hist_NoCenter_6->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==7)) {
-              Hist_NoCenter_7->Fill(L,B);
-            }
-            if (!at_center && (n_testpoints==8)) {
-              Hist_NoCenter_8->Fill(L,B);
-            }
-          }
-        }
-      } 
+    if (m_Selector->IsQualifiedEventFast(Event) == true && Event->GetType() == MPhysicalEvent::c_Compton) {
+      ComptonEvents.push_back(dynamic_cast<MComptonEvent*>(Event));
+      if (ComptonEvents.size() == NEventsPerBlock) {
+        Counter.AddEvents(ComptonEvents);
+        for (MComptonEvent* E: ComptonEvents) delete E;
+        ComptonEvents.clear();
+      }
+    } else {
+      delete Event;
     }
-    
-    delete Event;
   } 
+  Counter.AddEvents(ComptonEvents);
+  for (MComptonEvent* E: ComptonEvents) delete E;
+  ComptonEvents.clear();
   
   // Close the event loader
   FinalizeEventLoader();
 
+  // Transfer the counts into the histograms
+  vector<TH2D*> Hist_Counts = { Hist_Counts1, Hist_Counts2, Hist_Counts3, Hist_Counts4, Hist_Counts5, Hist_Counts6, Hist_Counts7, Hist_Counts8 };
+  vector<TH2D*> Hist_Center = { Hist_Center_0, Hist_Center_1, Hist_Center_2, Hist_Center_3, Hist_Center_4, Hist_Center_5, Hist_Center_6, Hist_Center_7, Hist_Center_8 };
+  vector<TH2D*> Hist_NoCenter = { Hist_NoCenter_1, Hist_NoCenter_2, Hist_NoCenter_3, Hist_NoCenter_4, Hist_NoCenter_5, Hist_NoCenter_6, Hist_NoCenter_7, Hist_NoCenter_8 };
+  for (int i_X=0; i_X<NBinsXAngle; i_X++) {
+    for (int i_Y=0; i_Y<NBinsYAngle; i_Y++) {
+      Hist_CenterCounts->SetBinContent(i_X+1, i_Y+1, Counter.GetCenterCounts(i_X, i_Y));
+      for (unsigned int k = 1; k <= 8; ++k) {
+        Hist_Counts[k-1]->SetBinContent(i_X+1, i_Y+1, Counter.GetTestPointCounts(k, i_X, i_Y));
+        Hist_NoCenter[k-1]->SetBinContent(i_X+1, i_Y+1, Counter.GetNoCenterAndTestPointsCounts(k, i_X, i_Y));
+      }
+      for (unsigned int k = 0; k <= 8; ++k) {
+        Hist_Center[k]->SetBinContent(i_X+1, i_Y+1, Counter.GetCenterAndTestPointsCounts(k, i_X, i_Y));
+      }
+    }
+  }
+  vector<TH2D*> Hists = Hist_Counts;
+  Hists.insert(Hists.end(), Hist_Center.begin(), Hist_Center.end());
+  Hists.insert(Hists.end(), Hist_NoCenter.begin(), Hist_NoCenter.end());
+  Hists.push_back(Hist_CenterCounts);
+  for (TH2D* H: Hists) {
+    H->SetEntries(H->GetSumOfWeights());
+  }
+
   if (Hist_CenterCounts->GetMaximum() == 0) {
     mgui<<"No events passed the event selections or file is empty!"<<error;
     return;
@@ -6330,6 +6274,7 @@ void MInterfaceMimrec::CreateExposureMap()
     mgui<<"ERROR: Unable to load exposure efficiency file: \""<<m_Settings->GetExposureEfficiencyFile()<<"\""<<show;
     return;    
   }
+  Exposure.SetNumberOfThreads(m_Settings->GetNThreads());
   Exposure.SetDimensions(m_Settings->GetGalLongitudeMin()*c_Rad, 
                         m_Settings->GetGalLongitudeMax()*c_Rad, 
                         m_Settings->GetBinsGalLongitude(),
@@ -6339,6 +6284,7 @@ void MInterfaceMimrec::CreateExposureMap()
                         c_FarAway/10, 
                         c_FarAway, 
                         1);
+  Exposure.UseAttitudeHistogram(m_Settings->GetExposureUseAttitudeHistogram(), m_Settings->GetExposureAttitudeBinWidth()*c_Rad);
   
   
   MPhysicalEvent* Event;
@@ -318,5 +318,27 @@ double* MLMLAlgorithms::GetImage()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MLMLAlgorithms::SetInitialImage(const double* Image)
+{
+  // Start the iterations from the given image instead of a flat one (warm start)
+
+  massert(m_Lj != 0);
+
+  double Mean = 0.0;
+  for (unsigned int i = 0; i < m_NBins; ++i) Mean += Image[i];
+  Mean /= m_NBins;
+  if (Mean <= 0.0) return; // Keep the flat image
+
+  // The multiplicative updates can never change an empty bin, thus give all bins a minimum content
+  double Minimum = 0.01*Mean;
+  for (unsigned int i = 0; i < m_NBins; ++i) {
+    m_Lj[i] = (Image[i] > Minimum) ? Image[i] : Minimum;
+  }
+}
+
+
 // MLMLAlgorithms.cxx: the end...
 ////////////////////////////////////////////////////////////////////////////////
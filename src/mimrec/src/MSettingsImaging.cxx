@@ -66,6 +66,11 @@ MSettingsImaging::MSettingsImaging() : MSettingsInterface()
   m_LHIncrease = 0.0001;
   m_Penalty = 0;
   m_NIterations = 5;
+  m_ImagingEnergyBands.clear();
+  m_ImagingTimeSliceStart = 0;
+  m_ImagingTimeSliceStop = 0;
+  m_ImagingNTimeSlices = 0;
+  m_ImagingTimeSliceWarmStart = false;
   m_PenaltyAlpha = 0;
 
   // Dimensions spherical
@@ -129,6 +134,8 @@ MSettingsImaging::MSettingsImaging() : MSettingsInterface()
 
   m_ExposureMode = MExposureMode::Flat;
   m_ExposureEfficiencyFile = "";
+  m_ExposureUseAttitudeHistogram = false;
+  m_ExposureAttitudeBinWidth = 1.0;
 
 
   // Memory management
@@ -165,6 +172,7 @@ bool MSettingsImaging::WriteXml(MXmlNode* Node)
 
   MXmlNode* aNode = 0;
   MXmlNode* bNode = 0;
+  MXmlNode* cNode = 0;
 
   // Section image algorithms:
   //////////////////////
@@ -178,6 +186,15 @@ bool MSettingsImaging::WriteXml(MXmlNode* Node)
   new MXmlNode(bNode, "StopCriteria", m_LHStopCriteria);
   new MXmlNode(bNode, "Increase", m_LHIncrease);
   new MXmlNode(bNode, "NIterations", m_NIterations);
+  cNode = new MXmlNode(bNode, "EnergyBands");
+  for (unsigned int i = 0; i < m_ImagingEnergyBands.size(); ++i) {
+    new MXmlNode(cNode, "EnergyBandEdge", m_ImagingEnergyBands[i]);
+  }
+  cNode = new MXmlNode(bNode, "TimeSlices");
+  new MXmlNode(cNode, "Start", m_ImagingTimeSliceStart);
+  new MXmlNode(cNode, "Stop", m_ImagingTimeSliceStop);
+  new MXmlNode(cNode, "NSlices", m_ImagingNTimeSlices);
+  new MXmlNode(cNode, "WarmStart", m_ImagingTimeSliceWarmStart);
 
   // Menu penalty
   new MXmlNode(bNode, "PenaltyType", m_Penalty);
@@ -205,6 +222,8 @@ bool MSettingsImaging::WriteXml(MXmlNode* Node)
   // Menu Exposure:
   new MXmlNode(bNode, "ExposureMode", static_cast<int>(m_ExposureMode));
   new MXmlNode(bNode, "ExposureEfficiencyFile", CleanPath(m_ExposureEfficiencyFile));
+  new MXmlNode(bNode, "ExposureUseAttitudeHistogram", m_ExposureUseAttitudeHistogram);
+  new MXmlNode(bNode, "ExposureAttitudeBinWidth", m_ExposureAttitudeBinWidth);
 
 
 
@@ -297,6 +316,27 @@ bool MSettingsImaging::ReadXml(MXmlNode* Node)
       if ((cNode = bNode->GetNode("NIterations")) != 0) {
         m_NIterations = cNode->GetValueAsUnsignedInt();
       }
+      if ((cNode = bNode->GetNode("EnergyBands")) != 0) {
+        m_ImagingEnergyBands.clear();
+        for (unsigned int n = 0; n < cNode->GetNNodes(); ++n) {
+          m_ImagingEnergyBands.push_back(cNode->GetNode(n)->GetValueAsDouble());
+        }
+      }
+      if ((cNode = bNode->GetNode("TimeSlices")) != 0) {
+        MXmlNode* dNode = 0;
+        if ((dNode = cNode->GetNode("Start")) != 0) {
+          m_ImagingTimeSliceStart = dNode->GetValueAsDouble();
+        }
+        if ((dNode = cNode->GetNode("Stop")) != 0) {
+          m_ImagingTimeSliceStop = dNode->GetValueAsDouble();
+        }
+        if ((dNode = cNode->GetNode("NSlices")) != 0) {
+          m_ImagingNTimeSlices = dNode->GetValueAsUnsignedInt();
+        }
+        if ((dNode = cNode->GetNode("WarmStart")) != 0) {
+          m_ImagingTimeSliceWarmStart = dNode->GetValueAsBoolean();
+        }
+      }
       if ((cNode = bNode->GetNode("PenaltyType")) != 0) {
         m_Penalty = cNode->GetValueAsInt();
       }
@@ -348,6 +388,12 @@ bool MSettingsImaging::ReadXml(MXmlNode* Node)
       if ((cNode = bNode->GetNode("ExposureEfficiencyFile")) != 0) {
         m_ExposureEfficiencyFile = cNode->GetValue();
       }
+      if ((cNode = bNode->GetNode("ExposureUseAttitudeHistogram")) != 0) {
+        m_ExposureUseAttitudeHistogram = cNode->GetValueAsBoolean();
+      }
+      if ((cNode = bNode->GetNode("ExposureAttitudeBinWidth")) != 0) {
+        m_ExposureAttitudeBinWidth = cNode->GetValueAsDouble();
+      }
     }
   }
 
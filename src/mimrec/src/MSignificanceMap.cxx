@@ -0,0 +1,344 @@
+/*
+ * MSignificanceMap.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MSignificanceMap
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MSignificanceMap.h"
+
+// Standard libs:
+#include <cmath>
+#include <thread>
+#include <algorithm>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MRotation.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MSignificanceMap)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The safety margin of the band around the cone in radians - covers the rounding of the angle calculations and the offset of the cone apex
+static const double c_BandMargin = 1E-5;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MSignificanceMap::MSignificanceMap()
+{
+  // Construct an instance of MSignificanceMap
+
+  m_XMin = -180;
+  m_XMax = 180;
+  m_NBinsX = 360;
+  m_YMin = -90;
+  m_YMax = 90;
+  m_NBinsY = 180;
+  m_Radius = 3;
+  m_Distance = 6;
+  m_CoordinateSystem = MCoordinateSystem::c_Galactic;
+  m_NThreads = 1;
+  m_MaximumOffset = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MSignificanceMap::~MSignificanceMap()
+{
+  // Delete this instance of MSignificanceMap
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::SetBinning(double XMin, double XMax, unsigned int NBinsX, double YMin, double YMax, unsigned int NBinsY)
+{
+  // Set the binning in longitude (x) and latitude (y) in degrees
+
+  m_XMin = XMin;
+  m_XMax = XMax;
+  m_NBinsX = NBinsX;
+  m_YMin = YMin;
+  m_YMax = YMax;
+  m_NBinsY = NBinsY;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::SetTestPoints(double Radius, double Distance)
+{
+  // Set the maximum ARM (radius) and the distance of the test points from the bin center in degrees
+
+  m_Radius = Radius;
+  m_Distance = Distance;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::Initialize()
+{
+  // Calculate the bin center and test point vectors and reset all counts
+
+  unsigned int NBins = m_NBinsX*m_NBinsY;
+
+  double dX = (m_XMax-m_XMin)/((double)m_NBinsX);
+  double dY = (m_YMax-m_YMin)/((double)m_NBinsY);
+  double DistDiag = m_Distance/sqrt(2.);
+
+  // The points are exactly the ones of the original all-bins loop, thus the ARM values are identical
+  m_Points.resize(c_NPoints*NBins);
+  m_BinCenters.resize(NBins);
+  m_RowThetas.resize(m_NBinsY);
+  for (unsigned int i_Y = 0; i_Y < m_NBinsY; ++i_Y) {
+    double B = m_YMin + dY*(double)i_Y + dY/2.;
+    m_RowThetas[i_Y] = (B+90)*c_Rad;
+    for (unsigned int i_X = 0; i_X < m_NBinsX; ++i_X) {
+      double L = m_XMin + dX*(double)i_X + dX/2.;
+      unsigned int Bin = i_X + i_Y*m_NBinsX;
+      MVector* P = &m_Points[c_NPoints*Bin];
+      P[0].SetMagThetaPhi(c_FarAway, (B+90)*c_Rad, L*c_Rad);
+      P[1].SetMagThetaPhi(c_FarAway, (90+B+m_Distance)*c_Rad, (L         )*c_Rad);
+      P[2].SetMagThetaPhi(c_FarAway, (90+B+DistDiag)*c_Rad, (L-DistDiag)*c_Rad);
+      P[3].SetMagThetaPhi(c_FarAway, (90+B         )*c_Rad, (L-m_Distance)*c_Rad);
+      P[4].SetMagThetaPhi(c_FarAway, (90+B-DistDiag)*c_Rad, (L-DistDiag)*c_Rad);
+      P[5].SetMagThetaPhi(c_FarAway, (90+B-m_Distance)*c_Rad, (L         )*c_Rad);
+      P[6].SetMagThetaPhi(c_FarAway, (90+B-DistDiag)*c_Rad, (L+DistDiag)*c_Rad);
+      P[7].SetMagThetaPhi(c_FarAway, (90+B         )*c_Rad, (L+m_Distance)*c_Rad);
+      P[8].SetMagThetaPhi(c_FarAway, (90+B+DistDiag)*c_Rad, (L+DistDiag)*c_Rad);
+      m_BinCenters[Bin].SetMagThetaPhi(1.0, (B+90)*c_Rad, L*c_Rad);
+    }
+  }
+
+  // Each test point is one step along the meridian and one along the parallel away from the center,
+  // each at most Distance/sqrt(2) for the diagonal ones, thus at most sqrt(2)*Distance in total
+  m_MaximumOffset = sqrt(2.)*fabs(m_Distance)*c_Rad;
+
+  unsigned int NThreads = m_NThreads;
+  if (NThreads == 0) {
+    NThreads = thread::hardware_concurrency();
+    if (NThreads == 0) NThreads = 1;
+  }
+  m_ThreadCounts.clear();
+  m_ThreadCounts.resize(NThreads, vector<unsigned int>(c_NCountTypes*NBins, 0));
+  m_ThreadNTestedBins.clear();
+  m_ThreadNTestedBins.resize(NThreads, 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::AddEvents(const vector<MComptonEvent*>& Events)
+{
+  // Count the events, the events are not deleted
+
+  if (m_ThreadCounts.size() == 0) Initialize();
+  if (Events.size() == 0) return;
+
+  // Split the events between the threads
+  unsigned int NUsedThreads = m_ThreadCounts.size();
+  if (NUsedThreads > Events.size()) NUsedThreads = Events.size();
+  unsigned int Split = Events.size() / NUsedThreads;
+
+  if (NUsedThreads == 1) {
+    AddEventsThreadEntry(0, &Events, 0, Events.size());
+    return;
+  }
+
+  vector<thread> Threads(NUsedThreads);
+  for (unsigned int t = 0; t < NUsedThreads; ++t) {
+    unsigned int Start = t*Split;
+    unsigned int Stop = (t == NUsedThreads - 1) ? Events.size() : (t+1)*Split;
+    Threads[t] = thread(&MSignificanceMap::AddEventsThreadEntry, this, t, &Events, Start, Stop);
+  }
+  for (unsigned int t = 0; t < NUsedThreads; ++t) {
+    Threads[t].join();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Thread entry: Count the events [Start, Stop[ into the thread's own counts
+void MSignificanceMap::AddEventsThreadEntry(unsigned int ThreadID, const vector<MComptonEvent*>* Events, unsigned int Start, unsigned int Stop)
+{
+  for (unsigned int e = Start; e < Stop; ++e) {
+    AddEvent((*Events)[e], m_ThreadCounts[ThreadID], m_ThreadNTestedBins[ThreadID]);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::AddEvent(MComptonEvent* Event, vector<unsigned int>& Counts, unsigned long& NTestedBins)
+{
+  // Count one event: only the bins whose center is within the band around the cone can have
+  // the center or a test point within the radius
+
+  unsigned int NBins = m_NBinsX*m_NBinsY;
+
+  // The ARM is the angle between the cone axis and the sky position rotated by the inverse rotation R into event coordinates:
+  // axis * (R P) = (R^T axis) * P, thus the angle to the rotated back axis is the same if R is orthogonal.
+  // Deviations from orthogonality (e.g. rounded pointing axes) widen the band accordingly
+  MRotation Inverse;
+  if (Event->HasDetectorRotation() == true) Inverse = Event->GetDetectorInverseRotationMatrix();
+  if (m_CoordinateSystem == MCoordinateSystem::c_Galactic && Event->HasGalacticPointing() == true) {
+    Inverse = Event->GetGalacticPointingInverseRotationMatrix()*Inverse;
+  }
+  MVector C = Event->C1() - Event->C2();
+  MVector Axis(Inverse.GetX().Dot(C), Inverse.GetY().Dot(C), Inverse.GetZ().Dot(C));
+  double Phi = Event->Phi();
+
+  if (Axis.Mag() == 0 || std::isfinite(Axis.Mag()) == false || std::isfinite(Phi) == false) {
+    // Degenerated cone: test all bins
+    for (unsigned int Bin = 0; Bin < NBins; ++Bin) {
+      TestBin(Event, Bin, Counts);
+    }
+    NTestedBins += NBins;
+    return;
+  }
+  Axis.Unitize();
+
+  double NonOrthogonality = 0;
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetX().Dot(Inverse.GetX()) - 1));
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetY().Dot(Inverse.GetY()) - 1));
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetZ().Dot(Inverse.GetZ()) - 1));
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetX().Dot(Inverse.GetY())));
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetX().Dot(Inverse.GetZ())));
+  NonOrthogonality = max(NonOrthogonality, fabs(Inverse.GetY().Dot(Inverse.GetZ())));
+  // The singular values are within sqrt(1 +- 3*NonOrthogonality), thus the cosines of the angles differ by at most ~3*NonOrthogonality
+  double RotationMargin = acos(1.0 - min(2.0, 4*NonOrthogonality));
+
+  double Width = fabs(m_Radius)*c_Rad + m_MaximumOffset + c_BandMargin + RotationMargin;
+  double Low = Phi - Width;
+  double High = Phi + Width;
+  double CosLow = (Low <= 0) ? 2.0 : cos(Low);
+  double CosHigh = (High >= c_Pi) ? -2.0 : cos(High);
+
+  double AxisTheta = Axis.Theta();
+  for (unsigned int y = 0; y < m_NBinsY; ++y) {
+    // All bin centers of a latitude row are at least the difference of their polar angles away from the axis
+    double RowTheta = m_RowThetas[y];
+    if (RowTheta >= 0 && RowTheta <= c_Pi) {
+      double Minimum = fabs(RowTheta - AxisTheta);
+      double Maximum = min(RowTheta + AxisTheta, 2*c_Pi - RowTheta - AxisTheta);
+      if (Minimum > High || Maximum < Low) continue;
+    }
+
+    for (unsigned int x = 0; x < m_NBinsX; ++x) {
+      unsigned int Bin = x + y*m_NBinsX;
+      double Cos = m_BinCenters[Bin].Dot(Axis);
+      if (Cos > CosLow || Cos < CosHigh) continue;
+      TestBin(Event, Bin, Counts);
+      ++NTestedBins;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSignificanceMap::TestBin(MComptonEvent* Event, unsigned int Bin, vector<unsigned int>& Counts)
+{
+  // Test the center and test points of one bin and count the event
+
+  const MVector* P = &m_Points[c_NPoints*Bin];
+  unsigned int* C = &Counts[c_NCountTypes*Bin];
+
+  bool AtCenter = (fabs(Event->GetARMGamma(P[0], m_CoordinateSystem)*c_Deg) <= m_Radius);
+  unsigned int NTestPoints = 0;
+  for (unsigned int t = 1; t < c_NPoints; ++t) {
+    if (fabs(Event->GetARMGamma(P[t], m_CoordinateSystem)*c_Deg) <= m_Radius) {
+      ++C[c_TestPoint + t - 1];
+      ++NTestPoints;
+    }
+  }
+
+  if (AtCenter == true) {
+    ++C[c_Center];
+    ++C[c_CenterAndTestPoints + NTestPoints];
+  } else if (NTestPoints > 0) {
+    ++C[c_NoCenterAndTestPoints + NTestPoints - 1];
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MSignificanceMap::GetCounts(unsigned int Type, unsigned int x, unsigned int y) const
+{
+  // Return the counts of the given type in bin (x, y) summed over all threads
+
+  if (x >= m_NBinsX || y >= m_NBinsY) return 0;
+
+  unsigned int Index = Type + c_NCountTypes*(x + y*m_NBinsX);
+  unsigned int Counts = 0;
+  for (const vector<unsigned int>& ThreadCounts: m_ThreadCounts) {
+    Counts += ThreadCounts[Index];
+  }
+
+  return Counts;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned long MSignificanceMap::GetNTestedBins() const
+{
+  // Return the number of bins which have been tested
+
+  unsigned long NTestedBins = 0;
+  for (unsigned long N: m_ThreadNTestedBins) {
+    NTestedBins += N;
+  }
+
+  return NTestedBins;
+}
+
+
+// MSignificanceMap.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -65,6 +65,8 @@ protected:
   double TestSingleFit();
   //! Test bootstrapping
   double TestBootstrapping();
+  //! Test binned bootstrapping against bootstrapping the ARM values, and the reproducibility of the random streams
+  bool TestBinnedBootstrapping();
 
 
 
@@ -117,6 +119,7 @@ bool UTARMFitter::Run()
 {
   //cout<<"Test single fit: "<<TestSingleFit()<<endl;
   cout<<"Test bootstrapping: "<<TestBootstrapping()<<endl;
+  cout<<"Test binned bootstrapping: "<<(TestBinnedBootstrapping() == true ? "passed" : "FAILED")<<endl;
 
 
 
@@ -327,6 +330,86 @@ double UTARMFitter::TestBootstrapping()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Test binned bootstrapping against bootstrapping the ARM values, and the reproducibility of the random streams
+bool UTARMFitter::TestBinnedBootstrapping()
+{
+  cout<<"Started test binned bootstrapping"<<endl;
+
+  // Basics
+  constexpr unsigned int Counts = 100000;
+  constexpr unsigned int NumberOfBins = 201;
+  constexpr unsigned int NumberOfFits = 100;
+  constexpr double MaxARM = 20;
+
+  TF1* Sampler = new TF1("DoubleLorentzAsymGausArmBinned", DoubleLorentzAsymGausArm, -MaxARM, MaxARM, 9);
+  Sampler->SetParameters(0, 1.0, 2.0, 150, 3.0, 800, 500, 2.5, 5.5);
+  vector<double> ARMValues;
+  ARMValues.reserve(Counts);
+  for (unsigned int i = 0; i < Counts; ++i) {
+    ARMValues.push_back(Sampler->GetRandom(-MaxARM, MaxARM));
+  }
+  delete Sampler;
+
+  // Bootstrapping the ARM values, bootstrapping the histogram, and the same with a single thread
+  vector<double> FWHM;
+  vector<double> Uncertainty;
+  vector<vector<double>> Samples;
+  vector<double> Times;
+  for (unsigned int Mode = 0; Mode < 3; ++Mode) {
+    MARMFitter Fitter;
+    Fitter.SetNumberOfBins(NumberOfBins);
+    Fitter.SetMaximumARMValue(MaxARM);
+    Fitter.SetFitFunction(MARMFitFunctionID::c_AsymmetricGaussLorentzLorentz);
+    Fitter.UseBinnedFitting();
+    Fitter.UseBinnedBootstrapping(Mode > 0);
+    Fitter.SetRandomSeed(4711);
+    if (Mode == 2) Fitter.SetNumberOfThreads(1);
+
+    for (double A: ARMValues) {
+      Fitter.AddARMValue(A);
+    }
+
+    auto Start = chrono::steady_clock::now();
+    Fitter.Fit(NumberOfFits);
+    Times.push_back(chrono::duration<double>(chrono::steady_clock::now() - Start).count());
+
+    if (Fitter.WasFittingSuccessful() == false) {
+      cout<<"Failed: Fit in mode "<<Mode<<" was not successful"<<endl;
+      return false;
+    }
+    FWHM.push_back(Fitter.GetAverageFWHM());
+    Uncertainty.push_back(Fitter.GetAverageFWHMUncertainty());
+    Samples.push_back(Fitter.GetBootstrappedFWHMSamples());
+  }
+
+  cout<<"Bootstrapped ARM values: FWHM: "<<FWHM[0]<<" +- "<<Uncertainty[0]<<" deg ("<<Times[0]<<" sec)"<<endl;
+  cout<<"Bootstrapped histogram:  FWHM: "<<FWHM[1]<<" +- "<<Uncertainty[1]<<" deg ("<<Times[1]<<" sec, single thread: "<<Times[2]<<" sec)"<<endl;
+
+  bool Passed = true;
+
+  // Both bootstraps resample the same binned data, thus they must agree within their uncertainties
+  if (fabs(FWHM[0] - FWHM[1]) > 3*sqrt(Uncertainty[0]*Uncertainty[0] + Uncertainty[1]*Uncertainty[1])) {
+    cout<<"Failed: The FWHM of binned and unbinned bootstrapping differ"<<endl;
+    Passed = false;
+  }
+  if (Uncertainty[1] < 0.5*Uncertainty[0] || Uncertainty[1] > 2.0*Uncertainty[0]) {
+    cout<<"Failed: The FWHM uncertainty of binned and unbinned bootstrapping differ"<<endl;
+    Passed = false;
+  }
+
+  // Same seed: the samples must not depend on the number of threads
+  if (Samples[1] != Samples[2]) {
+    cout<<"Failed: The bootstrap samples depend on the number of threads"<<endl;
+    Passed = false;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Main program
 int main(int argc, char** argv)
 {
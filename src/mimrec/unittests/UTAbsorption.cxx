@@ -0,0 +1,213 @@
+/*
+ * UTAbsorption.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MDGeometryQuest.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <map>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the batched ray tracing of MDGeometryQuest compared to the single-ray interface
+//! Usage: UTAbsorption [geometry setup file]
+class UTAbsorption
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTAbsorption() {};
+  //! Default destructor
+  virtual ~UTAbsorption() {};
+
+  //! Run all tests
+  bool Run(MString FileName);
+
+  // protected methods:
+protected:
+  //! Check the flat path lengths against the material map
+  bool TestPathLengths(MDGeometryQuest& Geometry);
+  //! Check the batched absorption probabilities against the single-ray ones, and time both
+  bool TestAbsorptionProbabilities(MDGeometryQuest& Geometry, int Mode);
+
+  //! Create random rays through the world volume
+  void CreateRays(MDGeometryQuest& Geometry, unsigned int NRays, vector<MVector>& Starts, vector<MVector>& Stops, vector<double>& Energies);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create random rays through the world volume
+void UTAbsorption::CreateRays(MDGeometryQuest& Geometry, unsigned int NRays, vector<MVector>& Starts, vector<MVector>& Stops, vector<double>& Energies)
+{
+  // Rays between random points in a box around the center, with energies repeating as in a Compton sequence
+  MVector Size = Geometry.GetWorldVolume()->GetShape()->GetSize();
+  double Extent = min(Size.Mag(), 100.0);
+
+  Starts.clear();
+  Stops.clear();
+  Energies.clear();
+  for (unsigned int r = 0; r < NRays; ++r) {
+    Starts.push_back(MVector(gRandom->Uniform(-Extent, Extent), gRandom->Uniform(-Extent, Extent), gRandom->Uniform(-Extent, Extent)));
+    Stops.push_back(MVector(gRandom->Uniform(-Extent, Extent), gRandom->Uniform(-Extent, Extent), gRandom->Uniform(-Extent, Extent)));
+    Energies.push_back(100.0 + 100.0*(r/4));
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the flat path lengths against the material map
+bool UTAbsorption::TestPathLengths(MDGeometryQuest& Geometry)
+{
+  vector<MVector> Starts;
+  vector<MVector> Stops;
+  vector<double> Energies;
+  CreateRays(Geometry, 2000, Starts, Stops, Energies);
+
+  vector<double> Lengths;
+  if (Geometry.GetPathLengths(Starts, Stops, Lengths, 0) == false) {
+    cout<<"Failed: GetPathLengths (batched) returned false"<<endl;
+    return false;
+  }
+
+  unsigned int NMaterials = Geometry.GetNMaterials();
+  for (unsigned int r = 0; r < Starts.size(); ++r) {
+    map<MDMaterial*, double> Map = Geometry.GetPathLengths(Starts[r], Stops[r]);
+    for (unsigned int m = 0; m < NMaterials; ++m) {
+      double Reference = 0.0;
+      auto Iter = Map.find(Geometry.GetMaterialAt(m));
+      if (Iter != Map.end()) Reference = Iter->second;
+      if (fabs(Lengths[r*NMaterials + m] - Reference) > 1E-9*max(1.0, Reference)) {
+        cout<<"Failed: Path length of ray "<<r<<" in "<<Geometry.GetMaterialAt(m)->GetName()<<": "<<Lengths[r*NMaterials + m]<<" instead of "<<Reference<<endl;
+        return false;
+      }
+    }
+  }
+
+  cout<<"Path lengths: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the batched absorption probabilities against the single-ray ones, and time both
+bool UTAbsorption::TestAbsorptionProbabilities(MDGeometryQuest& Geometry, int Mode)
+{
+  vector<MVector> Starts;
+  vector<MVector> Stops;
+  vector<double> Energies;
+  CreateRays(Geometry, 20000, Starts, Stops, Energies);
+
+  MTimer Timer;
+  vector<double> Reference;
+  for (unsigned int r = 0; r < Starts.size(); ++r) {
+    if (Mode == MDGeometryQuest::c_AbsorptionPhoto) {
+      Reference.push_back(Geometry.GetPhotoAbsorptionProbability(Starts[r], Stops[r], Energies[r]));
+    } else if (Mode == MDGeometryQuest::c_AbsorptionCompton) {
+      Reference.push_back(Geometry.GetComptonAbsorptionProbability(Starts[r], Stops[r], Energies[r]));
+    } else {
+      Reference.push_back(Geometry.GetAbsorptionProbability(Starts[r], Stops[r], Energies[r]));
+    }
+  }
+  double TimeSingle = Timer.GetElapsed();
+
+  bool Passed = true;
+  for (unsigned int NThreads: { 1U, 0U }) {
+    vector<double> Probabilities;
+    Timer.Reset();
+    if (Geometry.GetAbsorptionProbabilities(Starts, Stops, Energies, Probabilities, Mode, NThreads) == false) {
+      cout<<"Failed: GetAbsorptionProbabilities returned false"<<endl;
+      return false;
+    }
+    double TimeBatched = Timer.GetElapsed();
+
+    for (unsigned int r = 0; r < Starts.size(); ++r) {
+      if (fabs(Probabilities[r] - Reference[r]) > 1E-10) {
+        cout<<"Failed: Absorption probability (mode "<<Mode<<") of ray "<<r<<": "<<Probabilities[r]<<" instead of "<<Reference[r]<<endl;
+        Passed = false;
+        break;
+      }
+    }
+
+    cout<<"Absorption probabilities (mode "<<Mode<<", "<<(NThreads == 0 ? "all cores if TGeo is multi-threaded" : "one thread")<<"): "
+        <<(Passed == true ? "passed" : "FAILED")<<" - single rays: "<<TimeSingle<<" sec, batched: "<<TimeBatched<<" sec"<<endl;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTAbsorption::Run(MString FileName)
+{
+  MDGeometryQuest Geometry;
+  if (Geometry.ScanSetupFile(FileName) == false) {
+    cout<<"Failed: Unable to load geometry "<<FileName<<endl;
+    return false;
+  }
+
+  gRandom->SetSeed(12345);
+
+  bool Passed = true;
+  Passed = TestPathLengths(Geometry) && Passed;
+  Passed = TestAbsorptionProbabilities(Geometry, MDGeometryQuest::c_AbsorptionTotal) && Passed;
+  Passed = TestAbsorptionProbabilities(Geometry, MDGeometryQuest::c_AbsorptionPhoto) && Passed;
+  Passed = TestAbsorptionProbabilities(Geometry, MDGeometryQuest::c_AbsorptionCompton) && Passed;
+
+  cout<<"Absorption test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("Absorption", "unit test and benchmark of the batched ray tracing");
+
+  MString FileName = "$(MEGALIB)/resource/examples/geomega/simplifiedprototype/Prototype.geo.setup";
+  if (argc > 1) FileName = argv[1];
+
+  UTAbsorption Test;
+
+  return (Test.Run(FileName) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
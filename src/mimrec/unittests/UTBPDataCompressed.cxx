@@ -0,0 +1,292 @@
+/*
+ * UTBPDataCompressed.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MBPDataCompressed.h"
+#include "MBPDataSparseImage.h"
+#include "MBPDataSparseImageOneByte.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the list-mode response slices compressed per event
+class UTBPDataCompressed
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTBPDataCompressed() : m_NBinsX(360), m_NBinsY(180) {};
+  //! Default destructor
+  virtual ~UTBPDataCompressed() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! The types of the generated responses
+  enum class Shape { c_Cone, c_Scattered, c_Full };
+
+  //! Create the response of one event: the used bins in ascending order, their values and the maximum
+  void CreateResponse(Shape S, vector<int>& Bins, vector<double>& Values, double& Maximum);
+  //! Compare convolution, deconvolution and sum with the ones of the sparse store, check the chosen representation
+  bool TestResponse(Shape S, bool OneByte, bool Shuffle);
+  //! Benchmark memory and speed of the compressed store with the sparse one for cone-like responses
+  void Benchmark(unsigned int NEvents);
+
+  //! Return true if both images agree
+  bool IsEqual(const vector<double>& A, const vector<double>& B);
+
+  //! The image binning
+  int m_NBinsX;
+  int m_NBinsY;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create the response of one event: the used bins in ascending order, their values and the maximum
+void UTBPDataCompressed::CreateResponse(Shape S, vector<int>& Bins, vector<double>& Values, double& Maximum)
+{
+  Bins.clear();
+  Values.clear();
+  Maximum = 0;
+
+  // A Compton cone: a ring of given radius and width around a random center
+  double CenterX = gRandom->Uniform(0, m_NBinsX);
+  double CenterY = gRandom->Uniform(0, m_NBinsY);
+  double Radius = gRandom->Uniform(10, 60);
+  double Width = gRandom->Uniform(1, 4);
+
+  for (int y = 0; y < m_NBinsY; ++y) {
+    for (int x = 0; x < m_NBinsX; ++x) {
+      double Value = 0;
+      if (S == Shape::c_Cone) {
+        double Distance = sqrt((x - CenterX)*(x - CenterX) + (y - CenterY)*(y - CenterY)) - Radius;
+        if (fabs(Distance) < 3*Width) Value = exp(-0.5*Distance*Distance/Width/Width);
+      } else if (S == Shape::c_Scattered) {
+        if (gRandom->Rndm() < 0.1) Value = gRandom->Rndm();
+      } else {
+        Value = gRandom->Uniform(0.01, 1);
+      }
+      if (Value > 0) {
+        Bins.push_back(x + y*m_NBinsX);
+        Values.push_back(Value);
+        Maximum = max(Maximum, Value);
+      }
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return true if both images agree
+bool UTBPDataCompressed::IsEqual(const vector<double>& A, const vector<double>& B)
+{
+  for (unsigned int i = 0; i < A.size(); ++i) {
+    if (fabs(A[i] - B[i]) > 1E-9*max(1.0, fabs(A[i]))) return false;
+  }
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Compare convolution, deconvolution and sum with the ones of the sparse store, check the chosen representation
+bool UTBPDataCompressed::TestResponse(Shape S, bool OneByte, bool Shuffle)
+{
+  int NBins = m_NBinsX*m_NBinsY;
+
+  vector<int> Bins;
+  vector<double> Values;
+  double Maximum;
+  CreateResponse(S, Bins, Values, Maximum);
+
+  MBPData* Reference = nullptr;
+  if (OneByte == true) {
+    Reference = new MBPDataSparseImageOneByte();
+  } else {
+    Reference = new MBPDataSparseImage();
+  }
+  Reference->Initialize(Values.data(), Bins.data(), NBins, Bins.size(), Maximum);
+
+  if (Shuffle == true) {
+    vector<unsigned int> Order(Bins.size());
+    for (unsigned int i = 0; i < Order.size(); ++i) Order[i] = i;
+    for (unsigned int i = Order.size(); i > 1; --i) swap(Order[i-1], Order[gRandom->Integer(i)]);
+    vector<int> ShuffledBins;
+    vector<double> ShuffledValues;
+    for (unsigned int i: Order) {
+      ShuffledBins.push_back(Bins[i]);
+      ShuffledValues.push_back(Values[i]);
+    }
+    Bins = ShuffledBins;
+    Values = ShuffledValues;
+  }
+
+  MBPDataCompressed Compressed(OneByte);
+  Compressed.Initialize(Values.data(), Bins.data(), NBins, Bins.size(), Maximum);
+
+  MString Name = MString(S == Shape::c_Cone ? "cone" : (S == Shape::c_Scattered ? "scattered" : "full")) + ", " + (OneByte == true ? "1 byte" : "4 byte") + (Shuffle == true ? ", unsorted bins" : "");
+
+  bool Passed = true;
+
+  int Expected = (S == Shape::c_Cone) ? MBPDataCompressed::c_Runs : (S == Shape::c_Scattered ? MBPDataCompressed::c_Mask : MBPDataCompressed::c_Dense);
+  if (Compressed.GetRepresentation() != Expected) {
+    cout<<"Failed ("<<Name<<"): Representation "<<Compressed.GetRepresentation()<<" instead of "<<Expected<<endl;
+    Passed = false;
+  }
+  if (Compressed.GetUsedBins() != Reference->GetUsedBins()) {
+    cout<<"Failed ("<<Name<<"): "<<Compressed.GetUsedBins()<<" used bins instead of "<<Reference->GetUsedBins()<<endl;
+    Passed = false;
+  }
+
+  vector<double> Image(NBins);
+  for (double& I: Image) I = gRandom->Rndm();
+
+  vector<double> YReference(2, 0), YCompressed(2, 0);
+  Reference->Convolve(YReference.data(), 1, Image.data(), NBins);
+  Compressed.Convolve(YCompressed.data(), 1, Image.data(), NBins);
+  if (IsEqual(YReference, YCompressed) == false) {
+    cout<<"Failed ("<<Name<<"): Convolution gives "<<YCompressed[1]<<" instead of "<<YReference[1]<<endl;
+    Passed = false;
+  }
+
+  vector<double> InvYnew = { 0.0, 1.0/YReference[1] };
+  vector<double> EReference = Image, ECompressed = Image;
+  Reference->Deconvolve(EReference.data(), InvYnew.data(), 1);
+  Compressed.Deconvolve(ECompressed.data(), InvYnew.data(), 1);
+  if (IsEqual(EReference, ECompressed) == false) {
+    cout<<"Failed ("<<Name<<"): Deconvolution gives a different expectation"<<endl;
+    Passed = false;
+  }
+
+  vector<double> SReference(NBins, 0), SCompressed(NBins, 0);
+  Reference->Sum(SReference.data(), NBins);
+  Compressed.Sum(SCompressed.data(), NBins);
+  if (IsEqual(SReference, SCompressed) == false) {
+    cout<<"Failed ("<<Name<<"): Sum gives a different image"<<endl;
+    Passed = false;
+  }
+
+  if (Passed == true) {
+    cout<<"Response ("<<Name<<"): passed - "<<Compressed.GetUsedBytes()<<" instead of "<<Reference->GetUsedBytes()<<" bytes"<<endl;
+  }
+
+  delete Reference;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark memory and speed of the compressed store with the sparse one for cone-like responses
+void UTBPDataCompressed::Benchmark(unsigned int NEvents)
+{
+  int NBins = m_NBinsX*m_NBinsY;
+
+  vector<MBPData*> Sparse, Compressed;
+  long SparseBytes = 0, CompressedBytes = 0;
+  vector<int> Bins;
+  vector<double> Values;
+  double Maximum;
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    CreateResponse(Shape::c_Cone, Bins, Values, Maximum);
+    Sparse.push_back(new MBPDataSparseImageOneByte());
+    Sparse.back()->Initialize(Values.data(), Bins.data(), NBins, Bins.size(), Maximum);
+    SparseBytes += Sparse.back()->GetUsedBytes();
+    Compressed.push_back(new MBPDataCompressed(true));
+    Compressed.back()->Initialize(Values.data(), Bins.data(), NBins, Bins.size(), Maximum);
+    CompressedBytes += Compressed.back()->GetUsedBytes();
+  }
+
+  vector<double> Image(NBins, 1.0);
+  vector<double> Y(NEvents);
+  vector<double> Expectation(NBins);
+  for (vector<MBPData*>* Store: { &Sparse, &Compressed }) {
+    MTimer Timer;
+    // One iteration of the list-mode ML-EM
+    for (unsigned int e = 0; e < NEvents; ++e) (*Store)[e]->Convolve(Y.data(), e, Image.data(), NBins);
+    for (double& y: Y) y = 1.0/y;
+    for (unsigned int e = 0; e < NEvents; ++e) (*Store)[e]->Deconvolve(Expectation.data(), Y.data(), e);
+    cout<<"Iteration with "<<NEvents<<" cones ("<<(Store == &Sparse ? "sparse 1 byte" : "compressed 1 byte")<<"): "<<Timer.GetElapsed()<<" sec, "
+        <<(Store == &Sparse ? SparseBytes : CompressedBytes)/NEvents<<" bytes/event"<<endl;
+  }
+
+  for (MBPData* D: Sparse) delete D;
+  for (MBPData* D: Compressed) delete D;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTBPDataCompressed::Run()
+{
+  gRandom->SetSeed(4711);
+
+  bool Passed = true;
+  for (bool OneByte: { true, false }) {
+    for (Shape S: { Shape::c_Cone, Shape::c_Scattered, Shape::c_Full }) {
+      for (bool Shuffle: { false, true }) {
+        Passed = TestResponse(S, OneByte, Shuffle) && Passed;
+      }
+    }
+  }
+
+  Benchmark(5000);
+
+  cout<<"Compressed response slice test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("BPDataCompressed", "unit test and benchmark of the list-mode response slices compressed per event");
+
+  UTBPDataCompressed Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,368 @@
+/*
+ * UTBlockedCompression.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MFile.h"
+#include "MFileBGZF.h"
+
+// Standard lib:
+#include <sstream>
+#include <vector>
+#include <utility>
+using namespace std;
+
+// Other:
+#include <zlib.h>
+
+
+//! Unit test for blocked gzip (BGZF) files: writing, reading back with parallel decompression, and seeking
+class UTBlockedCompression
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTBlockedCompression() {};
+  //! Default destructor
+  virtual ~UTBlockedCompression() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Check that the written file is a valid BGZF and gzip file with block index
+  bool TestWriting(const MString& FileName);
+  //! Check that reading back gives the written lines with one and with several decompression threads
+  bool TestReading(const MString& FileName);
+  //! Check that seeking to virtual offsets and uncompressed positions lands on the right lines
+  bool TestSeeking(const MString& FileName);
+  //! Check that reading and seeking still works after the block index file has been removed
+  bool TestIndexRebuild(const MString& FileName);
+
+  //! Return the content of a line of the test file
+  MString CreateLine(unsigned int Line);
+  //! Write the test file
+  bool WriteFile(const MString& FileName);
+  //! Read the file with the given number of decompression threads and compare all lines
+  bool ReadAndCompare(const MString& FileName, unsigned int NThreads);
+
+  //! The number of lines in the test file -- several hundred 64 kB blocks
+  static const unsigned int c_NLines = 300000;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the content of a line of the test file
+MString UTBlockedCompression::CreateLine(unsigned int Line)
+{
+  // Not too regular, thus not too many lines fit in one block
+  ostringstream out;
+  out<<"SE "<<Line<<" "<<(Line*7919UL)%100003<<" "<<(Line*104729UL)%65537<<" "<<(Line*31UL)%997;
+
+  return MString(out);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write the test file
+bool UTBlockedCompression::WriteFile(const MString& FileName)
+{
+  MFile File;
+  File.SetBlockedCompression(true);
+  if (File.Open(FileName, MFile::c_Write) == false) return false;
+  for (unsigned int l = 0; l < c_NLines; ++l) {
+    File.Write(CreateLine(l) + "\n");
+  }
+  File.Close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the written file is a valid BGZF and gzip file with block index
+bool UTBlockedCompression::TestWriting(const MString& FileName)
+{
+  bool Passed = true;
+
+  if (MFileBGZF::IsBGZF(FileName) == false) {
+    cout<<"Failed: The written file is not recognized as blocked gzip file"<<endl;
+    Passed = false;
+  }
+  if (MFile::Exists(MFileBGZF::GetIndexFileName(FileName)) == false) {
+    cout<<"Failed: No block index file has been written"<<endl;
+    Passed = false;
+  }
+
+  // Any gzip reader must be able to read it
+  gzFile Zip = gzopen(FileName.Data(), "rb");
+  if (Zip == nullptr) {
+    cout<<"Failed: zlib cannot open the file"<<endl;
+    Passed = false;
+  } else {
+    char Buffer[1000];
+    unsigned int l = 0;
+    while (gzgets(Zip, Buffer, sizeof(Buffer)) != nullptr && Passed == true) {
+      MString Line(Buffer);
+      Line.StripBackInPlace('\n');
+      if (l >= c_NLines || Line != CreateLine(l)) {
+        cout<<"Failed: zlib reads line "<<l<<" as \""<<Line<<"\""<<endl;
+        Passed = false;
+      }
+      ++l;
+    }
+    gzclose(Zip);
+    if (Passed == true && l != c_NLines) {
+      cout<<"Failed: zlib reads "<<l<<" instead of "<<c_NLines<<" lines"<<endl;
+      Passed = false;
+    }
+  }
+
+  MFileBGZF BGZF;
+  if (BGZF.OpenForReading(FileName, 1) == false) {
+    cout<<"Failed: Unable to open the file as blocked gzip file"<<endl;
+    Passed = false;
+  } else {
+    // The file must be larger than a few blocks, otherwise the other tests are pointless
+    if (BGZF.GetUncompressedLength() < 10*MFileBGZF::c_MaximumUncompressedBlockSize) {
+      cout<<"Failed: The file only has "<<BGZF.GetUncompressedLength()<<" bytes"<<endl;
+      Passed = false;
+    }
+    BGZF.Close();
+  }
+
+  cout<<"BGZF writing test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read the file with the given number of decompression threads and compare all lines
+bool UTBlockedCompression::ReadAndCompare(const MString& FileName, unsigned int NThreads)
+{
+  MFile File;
+  File.SetNumberOfCompressionThreads(NThreads);
+  if (File.Open(FileName) == false) {
+    cout<<"Failed: Unable to open the file with "<<NThreads<<" threads"<<endl;
+    return false;
+  }
+  if (File.IsBlockedCompressed() == false) {
+    cout<<"Failed: The file is not read as blocked gzip file with "<<NThreads<<" threads"<<endl;
+    File.Close();
+    return false;
+  }
+
+  bool Passed = true;
+  MString Line;
+  for (unsigned int l = 0; l < c_NLines; ++l) {
+    if (File.ReadLine(Line) == false || Line != CreateLine(l)) {
+      cout<<"Failed: Line "<<l<<" read with "<<NThreads<<" threads is \""<<Line<<"\""<<endl;
+      Passed = false;
+      break;
+    }
+  }
+  if (Passed == true && File.ReadLine(Line) == true && Line != "") {
+    cout<<"Failed: Additional line after the end of the file with "<<NThreads<<" threads: \""<<Line<<"\""<<endl;
+    Passed = false;
+  }
+  File.Close();
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that reading back gives the written lines with one and with several decompression threads
+bool UTBlockedCompression::TestReading(const MString& FileName)
+{
+  bool Passed = true;
+
+  Passed = ReadAndCompare(FileName, 1) && Passed;
+  Passed = ReadAndCompare(FileName, 4) && Passed;
+  Passed = ReadAndCompare(FileName, 0) && Passed;
+
+  cout<<"BGZF parallel reading test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that seeking to virtual offsets and uncompressed positions lands on the right lines
+bool UTBlockedCompression::TestSeeking(const MString& FileName)
+{
+  bool Passed = true;
+
+  MFile File;
+  File.SetNumberOfCompressionThreads(4);
+  if (File.Open(FileName) == false) {
+    cout<<"Failed: Unable to open the file for seeking"<<endl;
+    return false;
+  }
+
+  // Remember the positions of some lines while reading sequentially
+  vector<unsigned int> Lines;
+  vector<uint64_t> VirtualOffsets;
+  vector<streampos> Positions;
+  MString Line;
+  for (unsigned int l = 0; l < c_NLines; ++l) {
+    if (l % 9973 == 0 || l == c_NLines - 1) {
+      Lines.push_back(l);
+      VirtualOffsets.push_back(File.GetVirtualFilePosition());
+      Positions.push_back(File.GetUncompressedFilePosition());
+    }
+    if (File.ReadLine(Line) == false) {
+      cout<<"Failed: Unable to read line "<<l<<endl;
+      File.Close();
+      return false;
+    }
+  }
+
+  // Jump backwards and forwards: last to first, then alternating between the ends
+  vector<unsigned int> Order;
+  for (unsigned int i = Lines.size(); i > 0; --i) Order.push_back(i - 1);
+  for (unsigned int i = 0; i < Lines.size(); ++i) Order.push_back((i % 2 == 0) ? i/2 : Lines.size() - 1 - i/2);
+
+  for (unsigned int i: Order) {
+    if (File.SeekVirtualFilePosition(VirtualOffsets[i]) == false || File.ReadLine(Line) == false || Line != CreateLine(Lines[i])) {
+      cout<<"Failed: Seeking the virtual offset of line "<<Lines[i]<<" gives \""<<Line<<"\""<<endl;
+      Passed = false;
+    }
+    // Continue reading across the next block boundaries
+    for (unsigned int l = Lines[i] + 1; l < Lines[i] + 2000 && l < c_NLines && Passed == true; ++l) {
+      if (File.ReadLine(Line) == false || Line != CreateLine(l)) {
+        cout<<"Failed: Line "<<l<<" after seeking line "<<Lines[i]<<" is \""<<Line<<"\""<<endl;
+        Passed = false;
+      }
+    }
+    File.Seek(Positions[i]);
+    if (File.ReadLine(Line) == false || Line != CreateLine(Lines[i])) {
+      cout<<"Failed: Seeking the uncompressed position of line "<<Lines[i]<<" gives \""<<Line<<"\""<<endl;
+      Passed = false;
+    }
+    if (Passed == false) break;
+  }
+
+  File.Close();
+
+  cout<<"BGZF seeking test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that reading and seeking still works after the block index file has been removed
+bool UTBlockedCompression::TestIndexRebuild(const MString& FileName)
+{
+  bool Passed = true;
+
+  MFile::Remove(MFileBGZF::GetIndexFileName(FileName));
+
+  Passed = ReadAndCompare(FileName, 4) && Passed;
+
+  MFileBGZF BGZF;
+  if (BGZF.OpenForReading(FileName, 2) == false) {
+    cout<<"Failed: Unable to open the file without block index"<<endl;
+    Passed = false;
+  } else {
+    // Seek to the middle via the uncompressed position and back via the virtual offset
+    unsigned int Middle = c_NLines/2;
+    uint64_t Position = 0;
+    for (unsigned int l = 0; l < Middle; ++l) Position += CreateLine(l).Length() + 1;
+    if (BGZF.Seek(Position) == false) {
+      cout<<"Failed: Unable to seek position "<<Position<<" without block index"<<endl;
+      Passed = false;
+    } else {
+      uint64_t VirtualOffset = BGZF.GetVirtualOffset();
+      char Buffer[1000];
+      for (unsigned int Pass = 0; Pass < 2 && Passed == true; ++Pass) {
+        if (Pass == 1) BGZF.SeekVirtualOffset(VirtualOffset);
+        if (BGZF.Gets(Buffer, sizeof(Buffer)) == nullptr || MString(Buffer) != CreateLine(Middle) + "\n") {
+          cout<<"Failed: Line "<<Middle<<" without block index"<<(Pass == 1 ? " after seeking the virtual offset" : "")<<endl;
+          Passed = false;
+        }
+      }
+    }
+    BGZF.Close();
+  }
+
+  cout<<"BGZF index rebuild test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTBlockedCompression::Run()
+{
+  bool Passed = true;
+
+  MString FileName = MFile::CreateTemporaryFile("UTBlockedCompression.tra.gz");
+  if (FileName == "" || WriteFile(FileName) == false) {
+    cout<<"Failed: Unable to write the blocked gzip file"<<endl;
+    return false;
+  }
+
+  Passed = TestWriting(FileName) && Passed;
+  Passed = TestReading(FileName) && Passed;
+  Passed = TestSeeking(FileName) && Passed;
+  Passed = TestIndexRebuild(FileName) && Passed;
+
+  MFile::Remove(FileName);
+  MFile::Remove(MFileBGZF::GetIndexFileName(FileName));
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("BlockedCompression", "unit test of blocked gzip files");
+
+  UTBlockedCompression Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
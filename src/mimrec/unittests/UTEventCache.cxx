@@ -0,0 +1,426 @@
+/*
+ * UTEventCache.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MFile.h"
+#include "MFileEventCache.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the cache of decompressed event files
+//! Usage: UTEventCache [number of events for the benchmark, default: 200000]
+class UTEventCache
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTEventCache() {};
+  //! Default destructor
+  virtual ~UTEventCache() {};
+
+  //! Run all tests
+  bool Run(unsigned int NEvents);
+
+  // protected methods:
+protected:
+  //! Check that cached files are read identically to the compressed files, for gzip and blocked gzip
+  bool TestReading(bool Blocked);
+  //! Check that a changed file is not read from its outdated cache entry
+  bool TestInvalidation();
+  //! Check that the least recently used entries are removed and too large files are not cached
+  bool TestEviction();
+  //! Benchmark reading a compressed file with and without cache
+  void BenchmarkReading(unsigned int NEvents);
+
+  //! Create the text of NEvents tra-like events
+  MString CreateContent(unsigned int NEvents, unsigned int Seed);
+  //! Write the text as compressed file
+  bool WriteFile(const MString& FileName, const MString& Content, bool Blocked);
+  //! Read the content of a file line by line, optionally via the event cache, and return if it was read from the cache
+  MString ReadFile(const MString& FileName, bool UseEventCache, bool& IsCached);
+
+  //! The cache directory
+  MString m_Directory;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create the text of NEvents tra-like events
+MString UTEventCache::CreateContent(unsigned int NEvents, unsigned int Seed)
+{
+  gRandom->SetSeed(Seed);
+
+  ostringstream out;
+  out<<"TY tra"<<endl<<"VE 1"<<endl<<endl;
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    out<<"SE"<<endl;
+    out<<"ET CO"<<endl;
+    out<<"ID "<<e+1<<endl;
+    out<<"TI "<<e*0.001<<endl;
+    out<<"CE "<<gRandom->Rndm()*1000<<" "<<gRandom->Rndm()<<" "<<gRandom->Rndm()*500<<" "<<gRandom->Rndm()<<endl;
+    out<<"CD "<<gRandom->Rndm()<<" "<<gRandom->Rndm()<<" "<<gRandom->Rndm()<<" 0 0 0 "<<gRandom->Rndm()<<" "<<gRandom->Rndm()<<" "<<gRandom->Rndm()<<" 0 0 0"<<endl;
+  }
+  out<<"EN"<<endl;
+
+  return out.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write the text as compressed file
+bool UTEventCache::WriteFile(const MString& FileName, const MString& Content, bool Blocked)
+{
+  MFile File;
+  File.SetBlockedCompression(Blocked);
+  if (File.Open(FileName, MFile::c_Write) == false) return false;
+  File.Write(Content);
+  File.Close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read the content of a file line by line, optionally via the event cache, and return if it was read from the cache
+MString UTEventCache::ReadFile(const MString& FileName, bool UseEventCache, bool& IsCached)
+{
+  ostringstream Content;
+  IsCached = false;
+
+  MFile File;
+  File.SetEventCache(UseEventCache);
+  if (File.Open(FileName, MFile::c_Read) == false) return "";
+  IsCached = File.IsReadFromEventCache();
+
+  MString Line;
+  while (File.ReadLine(Line) == true) {
+    Content<<Line<<'\n';
+  }
+  File.Close();
+
+  return Content.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that cached files are read identically to the compressed files, for gzip and blocked gzip
+bool UTEventCache::TestReading(bool Blocked)
+{
+  MFileEventCache::Enable(m_Directory, MFileEventCache::c_DefaultMaximumSize);
+  MFileEventCache::Clear();
+
+  MString FileName = MFile::CreateTemporaryFile("UTEventCache.tra.gz");
+  WriteFile(FileName, CreateContent(20000, 1), Blocked);
+
+  bool IsCached = false;
+  MString Reference = ReadFile(FileName, false, IsCached);
+  if (IsCached == true || MFileEventCache::GetNEntries() != 0) {
+    cout<<"Failed: The file has been read via the cache although the cache was not requested"<<endl;
+    MFile::Remove(FileName);
+    return false;
+  }
+
+  bool Passed = true;
+  error_code Error;
+  filesystem::file_time_type Created;
+  for (unsigned int r = 0; r < 2; ++r) {
+    MString Content = ReadFile(FileName, true, IsCached);
+    if (IsCached == false || MFileEventCache::GetNEntries() != 1) {
+      cout<<"Failed: Reading "<<r+1<<" has not been done via the cache"<<endl;
+      Passed = false;
+    }
+    // The second reading uses the existing entry instead of decompressing again
+    filesystem::file_time_type Modified = filesystem::last_write_time(MFileEventCache::Attach(FileName).Data(), Error);
+    if (r == 0) {
+      Created = Modified;
+    } else if (Modified != Created) {
+      cout<<"Failed: The file has been decompressed again although it is in the cache"<<endl;
+      Passed = false;
+    }
+    if (Content != Reference) {
+      cout<<"Failed: Reading "<<r+1<<" via the cache gives a different content"<<endl;
+      Passed = false;
+    }
+  }
+
+  // Seeking and rewinding work on the cached file as on the uncompressed content
+  MFile File;
+  File.SetEventCache(true);
+  File.Open(FileName, MFile::c_Read);
+  MString First, Line;
+  File.ReadLine(First);
+  while (File.ReadLine(Line) == true);
+  File.Rewind();
+  File.ReadLine(Line);
+  if (Line != First || File.GetFileLength() != File.GetUncompressedFileLength()) {
+    cout<<"Failed: Rewinding the cached file does not return to its beginning"<<endl;
+    Passed = false;
+  }
+  File.Close();
+
+  MFile::Remove(FileName);
+  MFileEventCache::Clear();
+
+  if (Passed == true) {
+    cout<<"Reading ("<<(Blocked == true ? "blocked gzip" : "gzip")<<"): passed"<<endl;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that a changed file is not read from its outdated cache entry
+bool UTEventCache::TestInvalidation()
+{
+  MFileEventCache::Enable(m_Directory, MFileEventCache::c_DefaultMaximumSize);
+  MFileEventCache::Clear();
+
+  MString FileName = MFile::CreateTemporaryFile("UTEventCache.tra.gz");
+  WriteFile(FileName, CreateContent(5000, 1), true);
+  bool IsCached = false;
+  ReadFile(FileName, true, IsCached);
+
+  // Same number of events, different content - possibly written within the resolution of the modification time
+  MString Changed = CreateContent(5000, 2);
+  WriteFile(FileName, Changed, true);
+  MString Content = ReadFile(FileName, true, IsCached);
+
+  bool Passed = true;
+  if (Content != Changed) {
+    cout<<"Failed: The changed file has been read from its outdated cache entry"<<endl;
+    Passed = false;
+  }
+  if (MFileEventCache::GetNEntries() != 1) {
+    cout<<"Failed: The outdated cache entry has not been replaced"<<endl;
+    Passed = false;
+  }
+
+  MFile::Remove(FileName);
+  MFileEventCache::Clear();
+
+  if (Passed == true) {
+    cout<<"Invalidation: passed"<<endl;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the least recently used entries are removed and too large files are not cached
+bool UTEventCache::TestEviction()
+{
+  MString Content = CreateContent(5000, 3);
+  vector<MString> FileNames;
+  for (unsigned int f = 0; f < 3; ++f) {
+    FileNames.push_back(MFile::CreateTemporaryFile(MString("UTEventCache") + f + ".tra.gz"));
+    WriteFile(FileNames.back(), Content, true);
+  }
+
+  bool Passed = true;
+  bool IsCached = false;
+
+  // Room for two files
+  MFileEventCache::Enable(m_Directory, 2*Content.Length() + Content.Length()/2);
+  MFileEventCache::Clear();
+  ReadFile(FileNames[0], true, IsCached);
+  ReadFile(FileNames[1], true, IsCached);
+  ReadFile(FileNames[0], true, IsCached); // 1 is now the least recently used one
+  ReadFile(FileNames[2], true, IsCached);
+  if (MFileEventCache::GetNEntries() != 2 || MFileEventCache::GetSize() > MFileEventCache::GetMaximumSize()) {
+    cout<<"Failed: The cache contains "<<MFileEventCache::GetNEntries()<<" entries with "<<MFileEventCache::GetSize()<<" bytes instead of 2 entries"<<endl;
+    Passed = false;
+  }
+  // Reading 0 and 2 again leaves the cache unchanged, thus 1 must have been removed
+  ReadFile(FileNames[0], true, IsCached);
+  bool IsCached0 = IsCached;
+  ReadFile(FileNames[2], true, IsCached);
+  if (IsCached0 == false || IsCached == false || MFileEventCache::GetNEntries() != 2) {
+    cout<<"Failed: Not the least recently used entry has been removed"<<endl;
+    Passed = false;
+  }
+
+  // Too large for the cache: read directly, and the entry records it
+  for (bool Blocked: { true, false }) {
+    WriteFile(FileNames[0], Content, Blocked);
+    MFileEventCache::Enable(m_Directory, Content.Length()/2);
+    MFileEventCache::Clear();
+    MString Read = ReadFile(FileNames[0], true, IsCached);
+    if (IsCached == true || MFileEventCache::GetNEntries() != 0 || Read != Content) {
+      cout<<"Failed: A file larger than the cache has not been read directly"<<endl;
+      Passed = false;
+    }
+    unsigned int NDescriptions = 0;
+    unsigned int NOthers = 0;
+    error_code Error;
+    for (auto& E: filesystem::directory_iterator(m_Directory.Data(), Error)) {
+      if (E.path().extension().string() == ".ecache") {
+        ++NDescriptions;
+      } else {
+        ++NOthers;
+      }
+    }
+    if (NDescriptions != 1 || NOthers != 0) {
+      cout<<"Failed: A file larger than the cache has not been recorded as such ("<<(Blocked == true ? "blocked gzip" : "gzip")<<")"<<endl;
+      Passed = false;
+    }
+    // Once the cache is large enough, it is cached
+    MFileEventCache::Enable(m_Directory, 2*Content.Length());
+    ReadFile(FileNames[0], true, IsCached);
+    Read = ReadFile(FileNames[0], true, IsCached);
+    if (IsCached == false || Read != Content) {
+      cout<<"Failed: A file recorded as too large is not cached after enlarging the cache"<<endl;
+      Passed = false;
+    }
+  }
+
+  // Files which are currently decompressed count against the maximum size
+  MFileEventCache::Enable(m_Directory, 2*Content.Length());
+  MFileEventCache::Clear();
+  {
+    ofstream InProgress((m_Directory + "/MEGAlib_0123456789_0000000000000000.data.tmp").Data());
+    InProgress<<MString(Content).Data()<<MString(Content).Data();
+  }
+  ReadFile(FileNames[1], true, IsCached);
+  ReadFile(FileNames[1], true, IsCached);
+  if (IsCached == true) {
+    cout<<"Failed: A file being decompressed by another process has not been counted against the maximum size"<<endl;
+    Passed = false;
+  }
+  MFile::Remove(m_Directory + "/MEGAlib_0123456789_0000000000000000.data.tmp");
+
+  for (MString& F: FileNames) MFile::Remove(F);
+  MFileEventCache::Clear();
+
+  if (Passed == true) {
+    cout<<"Eviction: passed"<<endl;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark reading a compressed file with and without cache
+void UTEventCache::BenchmarkReading(unsigned int NEvents)
+{
+  MFileEventCache::Enable(m_Directory, MFileEventCache::c_DefaultMaximumSize);
+  MFileEventCache::Clear();
+
+  for (bool Blocked: { false, true }) {
+    MString FileName = MFile::CreateTemporaryFile("UTEventCacheBenchmark.tra.gz");
+    WriteFile(FileName, CreateContent(NEvents, 4), Blocked);
+
+    bool IsCached = false;
+    MTimer Timer;
+    ReadFile(FileName, false, IsCached);
+    double TimeDirect = Timer.GetElapsed();
+
+    Timer.Reset();
+    ReadFile(FileName, true, IsCached);
+    double TimeFirst = Timer.GetElapsed();
+
+    Timer.Reset();
+    ReadFile(FileName, true, IsCached);
+    double TimeCached = Timer.GetElapsed();
+
+    cout<<"Reading "<<NEvents<<" events ("<<(Blocked == true ? "blocked gzip" : "gzip")<<") - compressed: "<<TimeDirect
+        <<" sec, first run with cache: "<<TimeFirst<<" sec, cached: "<<TimeCached<<" sec"<<endl;
+
+    MFile::Remove(FileName);
+  }
+
+  MFileEventCache::Clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTEventCache::Run(unsigned int NEvents)
+{
+  m_Directory = MFile::CreateTemporaryDirectory("UTEventCache");
+  if (m_Directory.IsEmpty() == true) {
+    cout<<"Failed: Unable to create the cache directory"<<endl;
+    return false;
+  }
+
+  bool Passed = true;
+  Passed = TestReading(false) && Passed;
+  Passed = TestReading(true) && Passed;
+  Passed = TestInvalidation() && Passed;
+  Passed = TestEviction() && Passed;
+  BenchmarkReading(NEvents);
+
+  MFileEventCache::Disable();
+  error_code Error;
+  filesystem::remove_all(m_Directory.Data(), Error);
+
+  cout<<"Event cache test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("EventCache", "unit test and benchmark of the cache of decompressed event files");
+
+  unsigned int NEvents = 200000;
+  if (argc > 1) NEvents = atoi(argv[1]);
+
+  UTEventCache Test;
+
+  return (Test.Run(NEvents) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
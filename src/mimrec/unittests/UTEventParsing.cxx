@@ -0,0 +1,331 @@
+/*
+ * UTEventParsing.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MTokenizer.h"
+#include "MFastTokenizer.h"
+#include "MComptonEvent.h"
+#include "MFileEventsTra.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+
+//! Unit test and benchmark for the event line parsing
+//! Usage: UTEventParsing [tra file] -- with a file, also the time to read it is measured
+class UTEventParsing
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTEventParsing();
+  //! Default destructor
+  virtual ~UTEventParsing() {};
+
+  //! Run all tests
+  bool Run(const MString& FileName);
+
+  // protected methods:
+protected:
+  //! Create representative lines
+  void CreateLines();
+  //! Check that the fast parsers give the same values as sscanf
+  bool TestConsistency();
+  //! Benchmark the CE/CD lines of tra files
+  void BenchmarkTraLines();
+  //! Benchmark the tokenizers on the HTsim/IA lines of sim files
+  void BenchmarkSimLines();
+  //! Benchmark reading a full tra file
+  void BenchmarkFile(const MString& FileName);
+
+  // private members:
+private:
+  //! The number of lines per type
+  unsigned int m_NLines;
+  //! The CE lines
+  vector<MString> m_CELines;
+  //! The CD lines
+  vector<MString> m_CDLines;
+  //! The HTsim lines
+  vector<MString> m_HTLines;
+  //! The IA lines
+  vector<MString> m_IALines;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default constructor
+UTEventParsing::UTEventParsing()
+{
+  m_NLines = 200000;
+  gRandom->SetSeed(0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create representative lines in the format written by cosima and revan
+void UTEventParsing::CreateLines()
+{
+  auto R = []() { return gRandom->Uniform(-50.0, 50.0); };
+
+  char Buffer[1024];
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    snprintf(Buffer, sizeof(Buffer), "CE %.5f %.5f %.5f %.5f", gRandom->Uniform(0, 2000), gRandom->Uniform(0, 5), gRandom->Uniform(0, 2000), gRandom->Uniform(0, 5));
+    m_CELines.push_back(Buffer);
+
+    snprintf(Buffer, sizeof(Buffer), "CD %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f",
+             R(), R(), R(), 0.1, 0.1, 0.1, R(), R(), R(), 0.1, 0.1, 0.1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    m_CDLines.push_back(Buffer);
+
+    snprintf(Buffer, sizeof(Buffer), "HTsim 5;%10.5f;%10.5f;%10.5f;%10.5f;%16.12f;%d;%d", R(), R(), R(), gRandom->Uniform(0, 1000), gRandom->Uniform(0, 1), 2, 3);
+    m_HTLines.push_back(Buffer);
+
+    snprintf(Buffer, sizeof(Buffer), "IA COMP %d;%6d;%2d;%16.12f;%10.5f;%10.5f;%10.5f;%3d;%8.5f;%8.5f;%8.5f;%8.5f;%8.5f;%8.5f;%10.3f;%3d;%8.5f;%8.5f;%8.5f;%8.5f;%8.5f;%8.5f;%10.3f",
+             2, 1, 1, gRandom->Uniform(0, 1), R(), R(), R(), 1, 0.0, 0.0, -1.0, 0.0, 0.0, 0.0, 511.0, 3, 0.3, 0.4, 0.5, 0.0, 0.0, 0.0, 200.0);
+    m_IALines.push_back(Buffer);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the fast parsers give the same values as sscanf
+bool UTEventParsing::TestConsistency()
+{
+  bool Passed = true;
+
+  MComptonEvent C;
+  for (unsigned int i = 0; i < 1000; ++i) {
+    double Eg, dEg, Ee, dEe;
+    sscanf(m_CELines[i].Data(), "CE %lf %lf %lf %lf", &Eg, &dEg, &Ee, &dEe);
+    for (bool Fast: { false, true }) {
+      if (C.ParseLine(m_CELines[i].Data(), Fast) != 0 || C.Eg() != Eg || C.dEg() != dEg || C.Ee() != Ee || C.dEe() != dEe) {
+        cout<<"Failed: CE line not correctly parsed: "<<m_CELines[i]<<endl;
+        Passed = false;
+      }
+    }
+
+    double V[18];
+    sscanf(m_CDLines[i].Data(), "CD %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+           &V[0], &V[1], &V[2], &V[3], &V[4], &V[5], &V[6], &V[7], &V[8], &V[9], &V[10], &V[11], &V[12], &V[13], &V[14], &V[15], &V[16], &V[17]);
+    if (C.ParseLine(m_CDLines[i].Data(), false) != 0 || C.C1() != MVector(V[0], V[1], V[2]) || C.C2() != MVector(V[6], V[7], V[8])) {
+      cout<<"Failed: CD line not correctly parsed: "<<m_CDLines[i]<<endl;
+      Passed = false;
+    }
+  }
+
+  if (C.ParseLine("CE 1.0 2.0 3.0", false) != 1) {
+    cout<<"Failed: Incomplete CE line has not been rejected"<<endl;
+    Passed = false;
+  }
+
+  // The common lines of all events in MPhysicalEvent::ParseLine
+  for (bool Fast: { false, true }) {
+    if (C.ParseLine("ID 123456789012", Fast) != 0 || C.GetId() != 123456789012L ||
+        C.ParseLine("TW -17", Fast) != 0 || C.GetTimeWalk() != -17 ||
+        C.ParseLine("OI 1.5 -2 3e1 0 0 -1 1 0 0 661.657", Fast) != 0 ||
+        C.GetOIPosition() != MVector(1.5, -2, 30) || C.GetOIDirection() != MVector(0, 0, -1) ||
+        C.GetOIPolarization() != MVector(1, 0, 0) || C.GetOIEnergy() != 661.657) {
+      cout<<"Failed: ID, TW, or OI line not correctly parsed"<<endl;
+      Passed = false;
+    }
+  }
+  if (C.ParseLine("OI 1.5 -2 3e1 0 0", false) != 1 || C.ParseLine("ID abc", false) != 1) {
+    cout<<"Failed: Incomplete OI or ID line has not been rejected"<<endl;
+    Passed = false;
+  }
+
+  MTokenizer Slow(';', false);
+  MFastTokenizer Fast(';');
+  for (unsigned int i = 0; i < 1000; ++i) {
+    Slow.AnalyzeFast(m_HTLines[i]);
+    Fast.Analyze(m_HTLines[i]);
+    if (Slow.GetNTokens() != Fast.GetNTokens()) {
+      cout<<"Failed: Different number of tokens: "<<m_HTLines[i]<<endl;
+      Passed = false;
+      continue;
+    }
+    for (unsigned int t = 1; t < Fast.GetNTokens(); ++t) {
+      if (Slow.GetTokenAtAsDouble(t) != Fast.GetTokenAtAsDouble(t)) {
+        cout<<"Failed: Different value for token "<<t<<": "<<m_HTLines[i]<<endl;
+        Passed = false;
+      }
+    }
+  }
+
+  cout<<"Consistency test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark the CE/CD lines of tra files
+void UTEventParsing::BenchmarkTraLines()
+{
+  MComptonEvent C;
+  double Sum = 0;
+
+  MTimer Timer;
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    double V[18];
+    sscanf(m_CELines[i].Data(), "CE %lf %lf %lf %lf", &V[0], &V[1], &V[2], &V[3]);
+    sscanf(m_CDLines[i].Data(), "CD %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+           &V[0], &V[1], &V[2], &V[3], &V[4], &V[5], &V[6], &V[7], &V[8], &V[9], &V[10], &V[11], &V[12], &V[13], &V[14], &V[15], &V[16], &V[17]);
+    Sum += V[0];
+  }
+  double TimeScanf = Timer.GetElapsed();
+
+  Timer.Start();
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    C.ParseLine(m_CELines[i].Data(), false);
+    C.ParseLine(m_CDLines[i].Data(), false);
+    Sum += C.Eg();
+  }
+  double TimeFast = Timer.GetElapsed();
+
+  cout<<"CE+CD lines:    sscanf: "<<setw(8)<<TimeScanf<<" sec   MComptonEvent::ParseLine: "<<setw(8)<<TimeFast<<" sec   speed-up: "<<TimeScanf/TimeFast<<" (checksum: "<<Sum<<")"<<endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark the tokenizers on the HTsim/IA lines of sim files
+void UTEventParsing::BenchmarkSimLines()
+{
+  double Sum = 0;
+
+  MTimer Timer;
+  MTokenizer Slow(';', false);
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    Slow.AnalyzeFast(m_HTLines[i]);
+    for (unsigned int t = 1; t < Slow.GetNTokens(); ++t) Sum += Slow.GetTokenAtAsDouble(t);
+    Slow.AnalyzeFast(m_IALines[i]);
+    for (unsigned int t = 1; t < Slow.GetNTokens(); ++t) Sum += Slow.GetTokenAtAsDouble(t);
+  }
+  double TimeSlow = Timer.GetElapsed();
+
+  Timer.Start();
+  MFastTokenizer Fast(';');
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    Fast.Analyze(m_HTLines[i]);
+    for (unsigned int t = 1; t < Fast.GetNTokens(); ++t) Sum += Fast.GetTokenAtAsDouble(t);
+    Fast.Analyze(m_IALines[i]);
+    for (unsigned int t = 1; t < Fast.GetNTokens(); ++t) Sum += Fast.GetTokenAtAsDouble(t);
+  }
+  double TimeFast = Timer.GetElapsed();
+
+  Timer.Start();
+  for (unsigned int i = 0; i < m_NLines; ++i) {
+    const char* Position = m_HTLines[i].Data() + 5;
+    const char* End = m_HTLines[i].Data() + m_HTLines[i].Length();
+    int Detector = 0;
+    double V[5];
+    MFastTokenizer::ParseInt(Position, End, Detector);
+    MFastTokenizer::ParseDoubles(Position, End, V, 5, ';');
+    Sum += V[0];
+  }
+  double TimeDirect = Timer.GetElapsed();
+
+  cout<<"HTsim+IA lines: MTokenizer: "<<setw(8)<<TimeSlow<<" sec   MFastTokenizer: "<<setw(8)<<TimeFast<<" sec   speed-up: "<<TimeSlow/TimeFast<<endl;
+  cout<<"HTsim lines:    direct fixed-layout parsing: "<<setw(8)<<TimeDirect<<" sec (checksum: "<<Sum<<")"<<endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark reading a full tra file
+void UTEventParsing::BenchmarkFile(const MString& FileName)
+{
+  MFileEventsTra File;
+  if (File.Open(FileName) == false) {
+    cout<<"Unable to open file "<<FileName<<endl;
+    return;
+  }
+
+  MTimer Timer;
+  long NEvents = 0;
+  MPhysicalEvent* Event = nullptr;
+  while ((Event = File.GetNextEvent()) != nullptr) {
+    ++NEvents;
+    delete Event;
+  }
+  double Time = Timer.GetElapsed();
+  File.Close();
+
+  cout<<"File "<<FileName<<": "<<NEvents<<" events in "<<Time<<" sec ("<<(Time > 0 ? NEvents/Time : 0)<<" events/sec)"<<endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTEventParsing::Run(const MString& FileName)
+{
+  CreateLines();
+
+  bool Passed = TestConsistency();
+
+  BenchmarkTraLines();
+  BenchmarkSimLines();
+
+  if (FileName != "") {
+    BenchmarkFile(FileName);
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("EventParsing", "unit test and benchmark of the event parsing");
+
+  UTEventParsing Test;
+
+  return (Test.Run(argc > 1 ? argv[1] : "") == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
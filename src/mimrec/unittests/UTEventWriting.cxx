@@ -0,0 +1,414 @@
+/*
+ * UTEventWriting.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MFile.h"
+#include "MFileEventsTra.h"
+#include "MFileTimeIndex.h"
+#include "MComptonEvent.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <vector>
+using namespace std;
+
+
+//! Unit test and benchmark for the event output: the fast number formatting and the background writer
+//! Usage: UTEventWriting [number of events for the benchmark, default: 200000]
+class UTEventWriting
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTEventWriting() {};
+  //! Default destructor
+  virtual ~UTEventWriting() {};
+
+  //! Run all tests
+  bool Run(unsigned int NEvents);
+
+  // protected methods:
+protected:
+  //! Check that the fast number formatting is identical to ostream
+  bool TestFormatting();
+  //! Check that files written in the background are identical to files written directly
+  bool TestBackgroundWriting();
+  //! Check that the background writer creates the same time index seek points as direct writing
+  bool TestTimeIndexBackgroundWriting();
+  //! Benchmark writing tra events with and without background writer
+  void BenchmarkWriting(unsigned int NEvents);
+
+  //! Create a random Compton event
+  MComptonEvent CreateEvent(unsigned int ID);
+  //! Write the text into the file in the given mode
+  bool WriteFile(const MString& FileName, const vector<MString>& Lines, bool Background);
+  //! Read the (uncompressed) content of a file
+  MString ReadFile(const MString& FileName);
+  //! Write a tra file with time index in the given mode
+  bool WriteTraFile(const MString& FileName, unsigned int NEvents, bool Background);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the fast number formatting is identical to ostream
+bool UTEventWriting::TestFormatting()
+{
+  bool Passed = true;
+
+  vector<double> Values = { 0.0, -0.0, 1.0, -1.0, 0.5, 2.5, 1E300, -1E300, 1E-300, 123456.789, 0.000049999, 9.99999995,
+                            numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN() };
+  for (unsigned int i = 0; i < 100000; ++i) {
+    Values.push_back(gRandom->Uniform(-1, 1) * pow(10.0, gRandom->Integer(61) - 30.0));
+  }
+
+  for (double V: Values) {
+    for (int Precision: { 0, 1, 3, 5, 7, 12 }) {
+      for (int Width: { 0, 8, 16 }) {
+        ostringstream Fixed;
+        ostringstream Scientific;
+        ostringstream General;
+        Fixed<<fixed<<setprecision(Precision)<<setw(Width)<<V;
+        Scientific<<scientific<<setprecision(Precision)<<setw(Width)<<V;
+        General<<setprecision(Precision)<<setw(Width)<<V;
+
+        MString FastFixed;
+        MString FastScientific;
+        MString FastGeneral;
+        FastFixed.AppendFixed(V, Precision, Width);
+        FastScientific.AppendScientific(V, Precision, Width);
+        FastGeneral.AppendGeneral(V, Precision, Width);
+
+        if (FastFixed != MString(Fixed.str()) || FastScientific != MString(Scientific.str()) || FastGeneral != MString(General.str())) {
+          cout<<"Failed: Formatting of "<<setprecision(17)<<V<<" (precision "<<Precision<<", width "<<Width<<"): "
+              <<Fixed.str()<<" vs. "<<FastFixed<<", "<<Scientific.str()<<" vs. "<<FastScientific<<", "<<General.str()<<" vs. "<<FastGeneral<<endl;
+          Passed = false;
+          break;
+        }
+      }
+    }
+    if (Passed == false) break;
+  }
+
+  for (long I: { 0L, -1L, 7L, 123456789L, numeric_limits<long>::min(), numeric_limits<long>::max() }) {
+    ostringstream Integer;
+    Integer<<setw(4)<<I;
+    MString FastInteger;
+    FastInteger.AppendInteger(I, 4);
+    if (FastInteger != MString(Integer.str())) {
+      cout<<"Failed: Formatting of "<<I<<": "<<Integer.str()<<" vs. "<<FastInteger<<endl;
+      Passed = false;
+    }
+  }
+
+  cout<<"Formatting test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create a random Compton event
+MComptonEvent UTEventWriting::CreateEvent(unsigned int ID)
+{
+  MComptonEvent Event;
+  Event.SetId(ID);
+  Event.SetTime(MTime(gRandom->Uniform(0, 1000)));
+  Event.SetEg(gRandom->Uniform(10, 1000));
+  Event.SetdEg(gRandom->Uniform(0, 5));
+  Event.SetEe(gRandom->Uniform(10, 1000));
+  Event.SetdEe(gRandom->Uniform(0, 5));
+  Event.SetC1(MVector(gRandom->Gaus(0, 10), gRandom->Gaus(0, 10), gRandom->Gaus(0, 10)));
+  Event.SetC2(MVector(gRandom->Gaus(0, 10), gRandom->Gaus(0, 10), gRandom->Gaus(0, 10)));
+  Event.SetSequenceLength(2 + gRandom->Integer(5));
+  Event.SetComptonQualityFactor1(gRandom->Uniform());
+  Event.SetComptonQualityFactor2(gRandom->Uniform());
+  Event.SetLeverArm(gRandom->Uniform(0, 20));
+  Event.Validate();
+
+  return Event;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write the text into the file in the given mode
+bool UTEventWriting::WriteFile(const MString& FileName, const vector<MString>& Lines, bool Background)
+{
+  MFile File;
+  File.SetBackgroundWriting(Background);
+  if (File.Open(FileName, MFile::c_Write) == false) return false;
+  for (unsigned int l = 0; l < Lines.size(); ++l) {
+    File.Write(Lines[l]);
+    if (l % 1000 == 0) File.Flush();
+  }
+  File.Close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Read the (uncompressed) content of a file
+MString UTEventWriting::ReadFile(const MString& FileName)
+{
+  MString Content;
+
+  MFile File;
+  if (File.Open(FileName, MFile::c_Read) == false) return Content;
+  MString Line;
+  while (File.ReadLine(Line) == true) {
+    Content += Line;
+    Content += '\n';
+  }
+  File.Close();
+
+  return Content;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that files written in the background are identical to files written directly
+bool UTEventWriting::TestBackgroundWriting()
+{
+  bool Passed = true;
+
+  // Enough events to fill several blocks of the background writer
+  vector<MString> Lines;
+  for (unsigned int e = 0; e < 20000; ++e) {
+    Lines.push_back(MString("SE\n") + CreateEvent(e).ToTraString());
+  }
+
+  for (MString Suffix: { ".tra", ".tra.gz" }) {
+    MString Direct = MFile::CreateTemporaryFile(MString("UTEventWritingDirect") + Suffix);
+    MString Background = MFile::CreateTemporaryFile(MString("UTEventWritingBackground") + Suffix);
+    if (Direct == "" || Background == "") {
+      cout<<"Failed: Unable to create temporary files"<<endl;
+      return false;
+    }
+
+    if (WriteFile(Direct, Lines, false) == false || WriteFile(Background, Lines, true) == false) {
+      cout<<"Failed: Unable to write "<<Direct<<" or "<<Background<<endl;
+      Passed = false;
+    } else {
+      MString DirectContent = ReadFile(Direct);
+      MString BackgroundContent = ReadFile(Background);
+      if (DirectContent.Length() == 0 || DirectContent != BackgroundContent) {
+        cout<<"Failed: The content of the files differs for "<<Suffix<<": "<<DirectContent.Length()<<" vs. "<<BackgroundContent.Length()<<" characters"<<endl;
+        Passed = false;
+      }
+    }
+
+    MFile::Remove(Direct);
+    MFile::Remove(Background);
+  }
+
+  cout<<"Background writing test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a tra file with time index in the given mode
+bool UTEventWriting::WriteTraFile(const MString& FileName, unsigned int NEvents, bool Background)
+{
+  MFileEventsTra File;
+  File.SetBackgroundWriting(Background);
+  File.SetTimeIndexEventsPerBlock(100);
+  if (File.Open(FileName, MFile::c_Write) == false) return false;
+  File.WriteHeader();
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    MComptonEvent Event = CreateEvent(e);
+    Event.SetTime(MTime(e));
+    File.AddEvent(&Event);
+  }
+  File.CloseEventList();
+  File.Close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the background writer creates the same time index seek points as direct writing
+bool UTEventWriting::TestTimeIndexBackgroundWriting()
+{
+  bool Passed = true;
+
+  for (MString Suffix: { ".tra", ".tra.gz" }) {
+    MString Direct = MFile::CreateTemporaryFile(MString("UTEventWritingIndexDirect") + Suffix);
+    MString Background = MFile::CreateTemporaryFile(MString("UTEventWritingIndexBackground") + Suffix);
+    if (Direct == "" || Background == "") {
+      cout<<"Failed: Unable to create temporary files"<<endl;
+      return false;
+    }
+
+    // The seed is reset, thus both files contain the same events
+    gRandom->SetSeed(54321);
+    bool Written = WriteTraFile(Direct, 2000, false);
+    gRandom->SetSeed(54321);
+    Written = WriteTraFile(Background, 2000, true) && Written;
+
+    MFileTimeIndex DirectIndex;
+    MFileTimeIndex BackgroundIndex;
+    if (Written == false ||
+        DirectIndex.Load(MFileTimeIndex::GetIndexFileName(Direct), Direct) == false ||
+        BackgroundIndex.Load(MFileTimeIndex::GetIndexFileName(Background), Background) == false) {
+      cout<<"Failed: Unable to write the files or their time index for "<<Suffix<<endl;
+      Passed = false;
+    } else if (DirectIndex.GetNBlocks() < 20 || DirectIndex.GetNBlocks() != BackgroundIndex.GetNBlocks()) {
+      cout<<"Failed: Different number of time index blocks for "<<Suffix<<": "<<DirectIndex.GetNBlocks()<<" vs. "<<BackgroundIndex.GetNBlocks()<<endl;
+      Passed = false;
+    } else {
+      for (unsigned int b = 0; b < DirectIndex.GetNBlocks(); ++b) {
+        const MFileTimeIndexBlock& D = DirectIndex.GetBlock(b);
+        const MFileTimeIndexBlock& B = BackgroundIndex.GetBlock(b);
+        if (D.m_UncompressedOffset != B.m_UncompressedOffset || D.m_CompressedOffset != B.m_CompressedOffset || D.m_NEvents != B.m_NEvents) {
+          cout<<"Failed: Time index block "<<b<<" differs for "<<Suffix<<": offsets "<<D.m_UncompressedOffset<<"/"<<D.m_CompressedOffset
+              <<" vs. "<<B.m_UncompressedOffset<<"/"<<B.m_CompressedOffset<<endl;
+          Passed = false;
+          break;
+        }
+      }
+
+      // Every block with events starts with an event
+      MFile File;
+      if (File.Open(Background, MFile::c_Read) == false) {
+        cout<<"Failed: Unable to read "<<Background<<endl;
+        Passed = false;
+      } else {
+        for (unsigned int b = 1; b < BackgroundIndex.GetNBlocks() && Passed == true; ++b) {
+          const MFileTimeIndexBlock& B = BackgroundIndex.GetBlock(b);
+          if (B.m_NEvents == 0) continue;
+          MString Line;
+          if (File.JumpToSeekPoint(B.m_UncompressedOffset, B.m_CompressedOffset) == false || File.ReadLine(Line) == false || Line != "SE") {
+            cout<<"Failed: Time index block "<<b<<" of "<<Background<<" does not start with an event: \""<<Line<<"\""<<endl;
+            Passed = false;
+          }
+        }
+        File.Close();
+      }
+    }
+
+    MFile::Remove(Direct);
+    MFile::Remove(Background);
+    MFile::Remove(MFileTimeIndex::GetIndexFileName(Direct));
+    MFile::Remove(MFileTimeIndex::GetIndexFileName(Background));
+  }
+
+  cout<<"Time index background writing test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark writing tra events with and without background writer
+void UTEventWriting::BenchmarkWriting(unsigned int NEvents)
+{
+  vector<MComptonEvent> Events;
+  for (unsigned int e = 0; e < 1000; ++e) {
+    Events.push_back(CreateEvent(e));
+  }
+
+  for (MString Suffix: { ".tra", ".tra.gz" }) {
+    for (bool Background: { false, true }) {
+      MString FileName = MFile::CreateTemporaryFile(MString("UTEventWritingBenchmark") + Suffix);
+
+      MTimer Timer;
+      MFile File;
+      File.SetBackgroundWriting(Background);
+      File.Open(FileName, MFile::c_Write);
+      double TimeWrite = 0;
+      for (unsigned int e = 0; e < NEvents; ++e) {
+        File.Write(MString("SE\n"));
+        File.Write(Events[e % Events.size()].ToTraString());
+      }
+      TimeWrite = Timer.GetElapsed();
+      File.Close();
+      double TimeTotal = Timer.GetElapsed();
+
+      cout<<setw(7)<<Suffix<<(Background == true ? " background: " : " direct:     ")
+          <<"calling thread: "<<setw(8)<<TimeWrite<<" sec ("<<NEvents/TimeWrite<<" events/sec), including close: "<<TimeTotal<<" sec"<<endl;
+
+      MFile::Remove(FileName);
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTEventWriting::Run(unsigned int NEvents)
+{
+  bool Passed = true;
+
+  gRandom->SetSeed(12345);
+
+  Passed = TestFormatting() && Passed;
+  Passed = TestBackgroundWriting() && Passed;
+  Passed = TestTimeIndexBackgroundWriting() && Passed;
+
+  BenchmarkWriting(NEvents);
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("EventWriting", "unit test and benchmark of the event output");
+
+  UTEventWriting Test;
+
+  return (Test.Run(argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
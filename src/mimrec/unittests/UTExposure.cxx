@@ -0,0 +1,247 @@
+/*
+ * UTExposure.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MFile.h"
+#include "MExposure.h"
+#include "MResponseMatrixO2.h"
+#include "MComptonEvent.h"
+
+// Standard lib:
+#include <cmath>
+#include <iomanip>
+#include <vector>
+using namespace std;
+
+
+//! Unit test for the exposure calculation: the attitude histogram against the per-event calculation
+class UTExposure
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTExposure() {};
+  //! Default destructor
+  virtual ~UTExposure() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Write a smooth far-field efficiency file
+  bool CreateEfficiencyFile(const MString& FileName);
+  //! Calculate the exposure of a slowly drifting pointing with or without attitude histogram
+  double* CalculateExposure(const MString& EfficiencyFile, bool UseAttitudeHistogram, double& Time);
+  //! Check that the attitude histogram gives the same exposure as the per-event calculation
+  bool TestAttitudeHistogram();
+  //! Check that setting the attitude histogram before the dimensions is safe
+  bool TestSettingOrder();
+
+  //! The number of longitude bins of the exposure map
+  static const unsigned int c_NLongitudeBins = 72;
+  //! The number of latitude bins of the exposure map
+  static const unsigned int c_NLatitudeBins = 36;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a smooth far-field efficiency file
+bool UTExposure::CreateEfficiencyFile(const MString& FileName)
+{
+  vector<float> Longitudes;
+  for (unsigned int i = 0; i <= 72; ++i) Longitudes.push_back(5.0*i);
+  vector<float> Latitudes;
+  for (unsigned int i = 0; i <= 36; ++i) Latitudes.push_back(5.0*i);
+
+  MResponseMatrixO2 Efficiency("Efficiency", Longitudes, Latitudes);
+  for (unsigned int lo = 0; lo < Longitudes.size() - 1; ++lo) {
+    for (unsigned int la = 0; la < Latitudes.size() - 1; ++la) {
+      double Lo = Efficiency.GetAxisBinCenter(lo, 1)*c_Rad;
+      double La = Efficiency.GetAxisBinCenter(la, 2)*c_Rad;
+      Efficiency.SetBinContent(lo, la, 1000.0*(2.0 + cos(La)) + 100.0*cos(Lo));
+    }
+  }
+  Efficiency.SetSimulatedEvents(10000000);
+  Efficiency.SetFarFieldStartArea(1000.0);
+
+  return Efficiency.Write(FileName);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Calculate the exposure of a slowly drifting pointing with or without attitude histogram
+double* UTExposure::CalculateExposure(const MString& EfficiencyFile, bool UseAttitudeHistogram, double& Time)
+{
+  MExposure Exposure;
+  if (Exposure.SetEfficiencyFile(EfficiencyFile) == false) return nullptr;
+  Exposure.SetDimensions(-180*c_Rad, 180*c_Rad, c_NLongitudeBins, 0*c_Rad, 180*c_Rad, c_NLatitudeBins, c_FarAway/10, c_FarAway, 1);
+  Exposure.UseAttitudeHistogram(UseAttitudeHistogram, 0.25*c_Rad);
+
+  // One event per second, the z-axis tilted by 40 deg and circling around the galactic pole by 0.05 deg per second
+  MTimer Timer;
+  const double Tilt = 40.0*c_Rad;
+  for (unsigned int e = 0; e < 7200; ++e) {
+    double Angle = 0.05*c_Rad*e;
+    MComptonEvent Event;
+    Event.SetTime(MTime(1000.0 + e));
+    Event.SetGalacticPointingZAxis(MVector(sin(Tilt)*cos(Angle), sin(Tilt)*sin(Angle), cos(Tilt)));
+    Event.SetGalacticPointingXAxis(MVector(cos(Tilt)*cos(Angle), cos(Tilt)*sin(Angle), -sin(Tilt)));
+    Exposure.Expose(&Event);
+  }
+  double* Map = Exposure.GetExposure();
+  Time = Timer.GetElapsed();
+
+  return Map;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the attitude histogram gives the same exposure as the per-event calculation
+bool UTExposure::TestAttitudeHistogram()
+{
+  bool Passed = true;
+
+  MString FileName = MFile::CreateTemporaryFile("UTExposure.efficiency.90y.rsp");
+  if (FileName == "" || CreateEfficiencyFile(FileName) == false) {
+    cout<<"Failed: Unable to create the efficiency file"<<endl;
+    return false;
+  }
+
+  double TimePerEvent = 0;
+  double TimeHistogram = 0;
+  double* PerEvent = CalculateExposure(FileName, false, TimePerEvent);
+  double* Histogram = CalculateExposure(FileName, true, TimeHistogram);
+
+  if (PerEvent == nullptr || Histogram == nullptr) {
+    cout<<"Failed: Unable to calculate the exposure maps"<<endl;
+    Passed = false;
+  } else {
+    // Both maps are normalized to 1 -- the per-event calculation attributes the dwell time to the
+    // attitude at the last update (every 1 deg), thus allow a small deviation in the exposed bins
+    unsigned int NBins = c_NLongitudeBins*c_NLatitudeBins;
+    double Maximum = 0;
+    for (unsigned int i = 0; i < NBins; ++i) {
+      if (PerEvent[i] > Maximum) Maximum = PerEvent[i];
+    }
+    if (Maximum <= 0) {
+      cout<<"Failed: The per-event exposure map is empty"<<endl;
+      Passed = false;
+    }
+    for (unsigned int i = 0; i < NBins && Passed == true; ++i) {
+      if (PerEvent[i] < 0.1*Maximum) continue;
+      double Deviation = fabs(Histogram[i] - PerEvent[i])/PerEvent[i];
+      if (Deviation > 0.03) {
+        cout<<"Failed: Exposure bin "<<i<<" differs by "<<100*Deviation<<"%: "<<Histogram[i]<<" (attitude histogram) vs. "<<PerEvent[i]<<" (per event)"<<endl;
+        Passed = false;
+      }
+    }
+  }
+
+  delete [] PerEvent;
+  delete [] Histogram;
+  MFile::Remove(FileName);
+
+  cout<<"Attitude histogram test: "<<(Passed == true ? "passed" : "FAILED")
+      <<" - per event: "<<TimePerEvent<<" sec, attitude histogram: "<<TimeHistogram<<" sec"<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that setting the attitude histogram before the dimensions is safe
+bool UTExposure::TestSettingOrder()
+{
+  bool Passed = true;
+
+  MString FileName = MFile::CreateTemporaryFile("UTExposureOrder.efficiency.90y.rsp");
+  if (FileName == "" || CreateEfficiencyFile(FileName) == false) {
+    cout<<"Failed: Unable to create the efficiency file"<<endl;
+    return false;
+  }
+
+  // No dimensions yet -- nothing may be applied
+  MExposure Exposure;
+  if (Exposure.SetEfficiencyFile(FileName) == false) {
+    cout<<"Failed: Unable to load the efficiency file"<<endl;
+    Passed = false;
+  } else {
+    Exposure.UseAttitudeHistogram(true, 1.0*c_Rad);
+    Exposure.UseAttitudeHistogram(false);
+    Exposure.SetDimensions(-180*c_Rad, 180*c_Rad, c_NLongitudeBins, 0*c_Rad, 180*c_Rad, c_NLatitudeBins, c_FarAway/10, c_FarAway, 1);
+    double* Map = Exposure.GetExposure();
+    for (unsigned int i = 0; i < c_NLongitudeBins*c_NLatitudeBins; ++i) {
+      if (Map[i] != 0.0) {
+        cout<<"Failed: The exposure map without events is not empty in bin "<<i<<endl;
+        Passed = false;
+        break;
+      }
+    }
+    delete [] Map;
+  }
+
+  MFile::Remove(FileName);
+
+  cout<<"Setting order test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTExposure::Run()
+{
+  bool Passed = true;
+
+  Passed = TestSettingOrder() && Passed;
+  Passed = TestAttitudeHistogram() && Passed;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("Exposure", "unit test of the exposure calculation");
+
+  UTExposure Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
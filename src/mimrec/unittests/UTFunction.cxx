@@ -0,0 +1,277 @@
+/*
+ * UTFunction.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MFunction.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for MFunction: evaluation and random numbers compared to the original linear-scan implementation
+class UTFunction
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTFunction() {};
+  //! Default destructor
+  virtual ~UTFunction() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Create the data points on a uniform (0), log-uniform (1), or irregular (2) grid
+  void CreateData(unsigned int Grid, vector<double>& X, vector<double>& Y);
+  //! The original evaluation: linear scan for the interval and the interpolation line calculated on each call
+  long double EvaluateReference(const vector<double>& X, const vector<double>& Y, unsigned int Type, long double x);
+  //! Check the evaluation against the reference
+  bool TestEvaluate(unsigned int Grid, unsigned int Type);
+  //! Check the distribution of the random numbers against the integrals of the intervals
+  bool TestGetRandom(unsigned int Grid, unsigned int Type);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create the data points on a uniform (0), log-uniform (1), or irregular (2) grid
+void UTFunction::CreateData(unsigned int Grid, vector<double>& X, vector<double>& Y)
+{
+  X.clear();
+  Y.clear();
+
+  const unsigned int N = 1000;
+  for (unsigned int i = 0; i < N; ++i) {
+    double x = 0;
+    if (Grid == 0) {
+      x = 1 + 0.5*i;
+    } else if (Grid == 1) {
+      x = pow(10.0, 0.005*i);
+    } else {
+      x = 1 + i + 0.3*sin(double(i*i));
+    }
+    X.push_back(x);
+    Y.push_back(1 + 100*fabs(sin(0.1*i))*pow(x, -1.5));
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The original evaluation: linear scan for the interval and the interpolation line calculated on each call
+long double UTFunction::EvaluateReference(const vector<double>& X, const vector<double>& Y, unsigned int Type, long double x)
+{
+  int Position = -1;
+  for (unsigned int i = 0; i < X.size(); ++i) {
+    if (X[i] > x) break;
+    Position = (int) i;
+  }
+
+  if (Type == MFunction::c_InterpolationNone) {
+    if (Position < 0) Position = 0;
+    if (Position >= (int) X.size()-1) Position = (int) (X.size()-2);
+    if (x > X[Position] + 0.5*(X[Position+1] - X[Position])) Position += 1;
+    return Y[Position];
+  }
+
+  long double x1, x2, y1, y2;
+  if (Position == -1) {
+    x1 = X[0]; x2 = X[1]; y1 = Y[0]; y2 = Y[1];
+  } else if (Position >= (int) X.size()-1) {
+    x1 = X[Position-1]; x2 = X[Position]; y1 = Y[Position-1]; y2 = Y[Position];
+  } else {
+    x1 = X[Position]; x2 = X[Position+1]; y1 = Y[Position]; y2 = Y[Position+1];
+  }
+
+  if (Type == MFunction::c_InterpolationLinLog || Type == MFunction::c_InterpolationLogLog) {
+    y1 = log(y1);
+    y2 = log(y2);
+  }
+  if (Type == MFunction::c_InterpolationLogLin || Type == MFunction::c_InterpolationLogLog) {
+    x = log(x);
+    x1 = log(x1);
+    x2 = log(x2);
+  }
+
+  long double m = (y2-y1)/(x2-x1);
+  long double t = y2 - m*x2;
+
+  if (Type == MFunction::c_InterpolationLinLog || Type == MFunction::c_InterpolationLogLog) {
+    return exp(m*x+t);
+  }
+  return m*x+t;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the evaluation against the reference
+bool UTFunction::TestEvaluate(unsigned int Grid, unsigned int Type)
+{
+  vector<double> X;
+  vector<double> Y;
+  CreateData(Grid, X, Y);
+
+  MFunction F;
+  F.Set(X, Y, Type);
+
+  // Random positions including extrapolation on both sides, and all data points exactly
+  vector<long double> Positions;
+  for (unsigned int i = 0; i < 100000; ++i) {
+    Positions.push_back(0.5*X.front() + gRandom->Rndm()*1.2*X.back());
+  }
+  for (unsigned int i = 0; i < X.size(); ++i) {
+    Positions.push_back(X[i]);
+  }
+
+  for (long double x: Positions) {
+    long double Value = F.Evaluate(x);
+    long double Reference = EvaluateReference(X, Y, Type, x);
+    if (fabs(Value - Reference) > 1E-12*fabs(Reference)) {
+      cout<<"Failed: Evaluate for grid "<<Grid<<" and interpolation "<<Type<<" at x="<<double(x)<<": "<<double(Value)<<" instead of "<<double(Reference)<<endl;
+      return false;
+    }
+  }
+
+  // Timing
+  const unsigned int NCalls = 200000;
+  long double Sum = 0;
+  MTimer Timer;
+  for (unsigned int i = 0; i < NCalls; ++i) {
+    Sum += F.Evaluate(Positions[i % Positions.size()]);
+  }
+  double Time = Timer.GetElapsed();
+  Timer.Reset();
+  for (unsigned int i = 0; i < NCalls/10; ++i) {
+    Sum += EvaluateReference(X, Y, Type, Positions[i % Positions.size()]);
+  }
+  double ReferenceTime = 10*Timer.GetElapsed();
+
+  cout<<"Evaluate - grid "<<Grid<<", interpolation "<<Type<<": "<<1E9*Time/NCalls<<" ns per call (original: "<<1E9*ReferenceTime/NCalls<<" ns)"<<(Sum == 0 ? " " : "")<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the distribution of the random numbers against the integrals of the intervals
+bool UTFunction::TestGetRandom(unsigned int Grid, unsigned int Type)
+{
+  vector<double> X;
+  vector<double> Y;
+  CreateData(Grid, X, Y);
+
+  MFunction F;
+  F.Set(X, Y, Type);
+
+  const unsigned int NSamples = 2000000;
+  vector<double> Counts(X.size() - 1, 0);
+  MTimer Timer;
+  for (unsigned int i = 0; i < NSamples; ++i) {
+    double x = F.GetRandom();
+    int Bin = int(upper_bound(X.begin(), X.end(), x) - X.begin()) - 1;
+    if (Bin == int(X.size()) - 1 && x == X.back()) --Bin;
+    if (Bin < 0 || Bin >= int(X.size()) - 1) {
+      cout<<"Failed: GetRandom for grid "<<Grid<<" and interpolation "<<Type<<" is outside the data range: "<<x<<endl;
+      return false;
+    }
+    Counts[Bin]++;
+  }
+  double Time = Timer.GetElapsed();
+
+  // Chi-square of the counts per interval compared to the integral of the interval
+  double Total = F.Integrate();
+  double ChiSquare = 0;
+  for (unsigned int b = 0; b < Counts.size(); ++b) {
+    double Expected = NSamples*F.Integrate(X[b], X[b+1])/Total;
+    if (Expected > 0) ChiSquare += (Counts[b] - Expected)*(Counts[b] - Expected)/Expected;
+  }
+  double ReducedChiSquare = ChiSquare/Counts.size();
+
+  cout<<"GetRandom - grid "<<Grid<<", interpolation "<<Type<<": "<<1E9*Time/NSamples<<" ns per call, chi-square/ndf: "<<ReducedChiSquare<<endl;
+
+  if (ReducedChiSquare > 1.3) {
+    cout<<"Failed: GetRandom for grid "<<Grid<<" and interpolation "<<Type<<" does not follow the function"<<endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTFunction::Run()
+{
+  bool Passed = true;
+
+  gRandom->SetSeed(12345);
+
+  vector<unsigned int> Types = { MFunction::c_InterpolationNone, MFunction::c_InterpolationLinLin, MFunction::c_InterpolationLinLog,
+                                 MFunction::c_InterpolationLogLin, MFunction::c_InterpolationLogLog };
+
+  for (unsigned int Grid = 0; Grid < 3; ++Grid) {
+    for (unsigned int Type: Types) {
+      Passed = TestEvaluate(Grid, Type) && Passed;
+      // The inversion of log-lin intervals relies on an approximation of Lambert's W function, thus it is not tested here
+      if (Type != MFunction::c_InterpolationNone && Type != MFunction::c_InterpolationLogLin) {
+        Passed = TestGetRandom(Grid, Type) && Passed;
+      }
+    }
+  }
+
+  cout<<"MFunction test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("Function", "unit test and benchmark of MFunction");
+
+  UTFunction Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
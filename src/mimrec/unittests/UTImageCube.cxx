@@ -0,0 +1,344 @@
+/*
+ * UTImageCube.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MFile.h"
+#include "MImager.h"
+#include "MPhotoEvent.h"
+
+// Standard lib:
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! An imager, which allows to set the image cube directly
+class UTImageCubeImager : public MImager
+{
+public:
+  //! Default constructor
+  UTImageCubeImager() : MImager(MCoordinateSystem::c_Spheric) {}
+
+  //! Set the image cube as if it had been reconstructed
+  void SetImageCube(const vector<vector<double>>& Cube, const vector<unsigned int>& NEvents, const vector<unsigned int>& NIterations) {
+    m_ImageCube = Cube;
+    m_ImageCubeNEvents = NEvents;
+    m_ImageCubeNIterations = NIterations;
+  }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Unit test for the image cube of the imager: energy bands, time slices, and the image cube file
+class UTImageCube
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTImageCube() {};
+  //! Default destructor
+  virtual ~UTImageCube() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Check the energy band assignment at the band edges
+  bool TestEnergyBands();
+  //! Check the time slice assignment at the slice edges
+  bool TestTimeSlices();
+  //! Check the image cube index of events inside and outside the cube
+  bool TestImageCubeIndex();
+  //! Check the format of a saved image cube
+  bool TestSaveImageCube();
+
+  //! Return an event with the given energy and time
+  MPhotoEvent CreateEvent(double Energy, double Time);
+  //! Compare a value with the expectation and report a failure
+  bool Check(const MString& What, int Value, int Expected);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return an event with the given energy and time
+MPhotoEvent UTImageCube::CreateEvent(double Energy, double Time)
+{
+  MPhotoEvent Event;
+  Event.SetEnergy(Energy);
+  Event.SetTime(MTime(Time));
+
+  return Event;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Compare a value with the expectation and report a failure
+bool UTImageCube::Check(const MString& What, int Value, int Expected)
+{
+  if (Value != Expected) {
+    cout<<"Failed: "<<What<<": "<<Value<<" instead of "<<Expected<<endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the energy band assignment at the band edges
+bool UTImageCube::TestEnergyBands()
+{
+  bool Passed = true;
+
+  UTImageCubeImager Imager;
+
+  // Without bands everything is in band 0
+  MPhotoEvent Event = CreateEvent(1E6, 0);
+  Passed = Check("Energy band without bands", Imager.GetEnergyBand(&Event), 0) && Passed;
+
+  // The edges are sorted and duplicates removed
+  Imager.SetEnergyBands({ 500, 100, 200, 200 });
+  Passed = Check("Number of energy bands", Imager.GetNEnergyBands(), 2) && Passed;
+
+  vector<pair<double, int>> Expectations = { { 99.999, -1 }, { 100.0, 0 }, { 199.999, 0 }, { 200.0, 1 }, { 499.999, 1 }, { 500.0, -1 } };
+  for (auto E: Expectations) {
+    Event = CreateEvent(E.first, 0);
+    MString What = "Energy band of ";
+    What += E.first;
+    Passed = Check(What, Imager.GetEnergyBand(&Event), E.second) && Passed;
+  }
+
+  // A single edge means no bands
+  Imager.SetEnergyBands({ 100 });
+  Passed = Check("Number of energy bands with a single edge", Imager.GetNEnergyBands(), 0) && Passed;
+
+  cout<<"Energy band test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the time slice assignment at the slice edges
+bool UTImageCube::TestTimeSlices()
+{
+  bool Passed = true;
+
+  UTImageCubeImager Imager;
+
+  // Without slices everything is in slice 0
+  MPhotoEvent Event = CreateEvent(100, 1E6);
+  Passed = Check("Time slice without slices", Imager.GetTimeSlice(&Event), 0) && Passed;
+
+  // Four slices of 2.5 seconds
+  Imager.SetTimeSlices(MTime(10.0), MTime(20.0), 4);
+  Passed = Check("Number of time slices", Imager.GetNTimeSlices(), 4) && Passed;
+
+  vector<pair<double, int>> Expectations = { { 9.999, -1 }, { 10.0, 0 }, { 12.499, 0 }, { 12.5, 1 }, { 17.5, 3 }, { 19.999, 3 }, { 20.0, -1 } };
+  for (auto T: Expectations) {
+    Event = CreateEvent(100, T.first);
+    MString What = "Time slice of ";
+    What += T.first;
+    Passed = Check(What, Imager.GetTimeSlice(&Event), T.second) && Passed;
+  }
+
+  if (fabs(Imager.GetTimeSliceMinimum(1).GetAsSeconds() - 12.5) > 1E-6 || fabs(Imager.GetTimeSliceMaximum(3).GetAsSeconds() - 20.0) > 1E-6) {
+    cout<<"Failed: Time slice edges: "<<Imager.GetTimeSliceMinimum(1)<<" and "<<Imager.GetTimeSliceMaximum(3)<<" instead of 12.5 and 20"<<endl;
+    Passed = false;
+  }
+
+  // An empty time range means no slices
+  Imager.SetTimeSlices(MTime(20.0), MTime(10.0), 4);
+  Passed = Check("Number of time slices with stop before start", Imager.GetNTimeSlices(), 0) && Passed;
+
+  cout<<"Time slice test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the image cube index of events inside and outside the cube
+bool UTImageCube::TestImageCubeIndex()
+{
+  bool Passed = true;
+
+  UTImageCubeImager Imager;
+  Imager.SetEnergyBands({ 100, 200, 500 });
+  Imager.SetTimeSlices(MTime(10.0), MTime(20.0), 4);
+
+  // Index = band * number of slices + slice
+  MPhotoEvent Event = CreateEvent(150, 10.0);
+  Passed = Check("Image cube index of the first image", Imager.GetImageCubeIndex(&Event), 0) && Passed;
+  Event = CreateEvent(300, 15.0);
+  Passed = Check("Image cube index of band 1, slice 2", Imager.GetImageCubeIndex(&Event), 6) && Passed;
+  Event = CreateEvent(499.999, 19.999);
+  Passed = Check("Image cube index of the last image", Imager.GetImageCubeIndex(&Event), 7) && Passed;
+  Event = CreateEvent(50, 15.0);
+  Passed = Check("Image cube index outside the bands", Imager.GetImageCubeIndex(&Event), -1) && Passed;
+  Event = CreateEvent(300, 25.0);
+  Passed = Check("Image cube index outside the slices", Imager.GetImageCubeIndex(&Event), -1) && Passed;
+
+  if (Imager.GetImageCubeSuffix(6) != ".band1.slice2") {
+    cout<<"Failed: Image cube suffix of image 6: "<<Imager.GetImageCubeSuffix(6)<<" instead of .band1.slice2"<<endl;
+    Passed = false;
+  }
+
+  cout<<"Image cube index test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the format of a saved image cube
+bool UTImageCube::TestSaveImageCube()
+{
+  bool Passed = true;
+
+  const unsigned int NBins = 6;
+  const unsigned int NImages = 8;
+
+  UTImageCubeImager Imager;
+  Imager.SetViewport(0, 3*c_Rad, 3, 0, 2*c_Rad, 2);
+  Imager.SetEnergyBands({ 100, 200, 500 });
+  Imager.SetTimeSlices(MTime(10.0), MTime(20.0), 4);
+
+  vector<vector<double>> Cube(NImages, vector<double>(NBins));
+  vector<unsigned int> NEvents(NImages);
+  vector<unsigned int> NIterations(NImages);
+  for (unsigned int i = 0; i < NImages; ++i) {
+    for (unsigned int b = 0; b < NBins; ++b) Cube[i][b] = 0.5*i + 0.25*b;
+    NEvents[i] = 10*i;
+    NIterations[i] = i + 1;
+  }
+  Imager.SetImageCube(Cube, NEvents, NIterations);
+
+  MString FileName = MFile::CreateTemporaryFile("UTImageCube.cube");
+  if (FileName == "" || Imager.SaveImageCube(FileName) == false) {
+    cout<<"Failed: Unable to save the image cube"<<endl;
+    return false;
+  }
+
+  ifstream in(FileName.Data());
+  string Line;
+  bool FoundType = false, FoundEB = false, FoundTS = false, FoundEN = false;
+  unsigned int NFoundImages = 0;
+  while (getline(in, Line)) {
+    istringstream Tokens(Line);
+    string Keyword;
+    Tokens>>Keyword;
+    if (Keyword == "Type") {
+      string Type;
+      Tokens>>Type;
+      FoundType = (Type == "ImageCube");
+    } else if (Keyword == "EB") {
+      double E1 = 0, E2 = 0, E3 = 0;
+      Tokens>>E1>>E2>>E3;
+      FoundEB = (E1 == 100 && E2 == 200 && E3 == 500);
+    } else if (Keyword == "TS") {
+      string Start, Stop;
+      unsigned int N = 0;
+      Tokens>>Start>>Stop>>N;
+      FoundTS = (N == 4 && fabs(atof(Start.c_str()) - 10.0) < 1E-6 && fabs(atof(Stop.c_str()) - 20.0) < 1E-6);
+    } else if (Keyword == "IM") {
+      unsigned int Index = 0, Band = 0, Slice = 0, N = 0, Iterations = 0;
+      Tokens>>Index>>Band>>Slice>>N>>Iterations;
+      vector<double> Data;
+      double Value;
+      while (Tokens>>Value) Data.push_back(Value);
+      if (Index != NFoundImages || Band != Index/4 || Slice != Index%4 || N != NEvents[Index] || Iterations != NIterations[Index] || Data != Cube[Index]) {
+        cout<<"Failed: Image line "<<NFoundImages<<" differs: "<<Line<<endl;
+        Passed = false;
+      }
+      ++NFoundImages;
+    } else if (Keyword == "EN") {
+      FoundEN = true;
+    }
+  }
+  in.close();
+
+  if (FoundType == false || FoundEB == false || FoundTS == false || FoundEN == false || NFoundImages != NImages) {
+    cout<<"Failed: Image cube file is incomplete: type "<<FoundType<<", energy bands "<<FoundEB<<", time slices "<<FoundTS
+        <<", end "<<FoundEN<<", "<<NFoundImages<<" of "<<NImages<<" images"<<endl;
+    Passed = false;
+  }
+
+  MFile::Remove(FileName);
+
+  cout<<"Image cube file test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTImageCube::Run()
+{
+  bool Passed = true;
+
+  Passed = TestEnergyBands() && Passed;
+  Passed = TestTimeSlices() && Passed;
+  Passed = TestImageCubeIndex() && Passed;
+  Passed = TestSaveImageCube() && Passed;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("ImageCube", "unit test of the image cube of the imager");
+
+  UTImageCube Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,311 @@
+/*
+ * UTNeuralNetworkBatch.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MNeuralNetworkIO.h"
+#include "MNeuralNetworkBackpropagation.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the dense mini-batch training of MNeuralNetworkBackpropagation compared to the per-sample learning
+class UTNeuralNetworkBatch
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTNeuralNetworkBatch() {};
+  //! Default destructor
+  virtual ~UTNeuralNetworkBatch() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Check that a batch size of one follows the per-sample learning
+  bool TestSingleSampleBatches();
+  //! Check that the result does not depend on the number of threads
+  bool TestThreadIndependence();
+  //! Check that the network learns a simple classification, and time the per-sample and the batched learning
+  bool TestLearning();
+
+  //! Create a network with the given layout and random weights
+  void CreateNetwork(MNeuralNetworkBackpropagation& NN, unsigned int NInputs, unsigned int NMiddle, unsigned int NOutputs);
+  //! Create samples: the outputs are 0.25 or 0.75 depending on whether the inputs are inside a sphere around the center
+  void CreateSamples(unsigned int NSamples, unsigned int NInputs, unsigned int NOutputs, vector<MNeuralNetworkIO>& Samples);
+  //! Learn all samples one by one with the object interface
+  void LearnSequentially(MNeuralNetworkBackpropagation& NN, vector<MNeuralNetworkIO>& Samples);
+  //! Return the fraction of samples for which the first output is on the correct side of 0.5
+  double GetAccuracy(MNeuralNetworkBackpropagation& NN, vector<MNeuralNetworkIO>& Samples);
+  //! Return the largest difference between the outputs of the two networks for the samples
+  double GetMaximumDifference(MNeuralNetworkBackpropagation& A, MNeuralNetworkBackpropagation& B, vector<MNeuralNetworkIO>& Samples);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create a network with the given layout and random weights
+void UTNeuralNetworkBatch::CreateNetwork(MNeuralNetworkBackpropagation& NN, unsigned int NInputs, unsigned int NMiddle, unsigned int NOutputs)
+{
+  NN.SetNInputNodes(NInputs);
+  NN.SetNMiddleNodes(NMiddle);
+  NN.SetNOutputNodes(NOutputs);
+  NN.SetLearningRate(0.4);
+  NN.SetMomentum(0.4);
+  NN.Create();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create samples: the outputs are 0.25 or 0.75 depending on whether the inputs are inside a sphere around the center
+void UTNeuralNetworkBatch::CreateSamples(unsigned int NSamples, unsigned int NInputs, unsigned int NOutputs, vector<MNeuralNetworkIO>& Samples)
+{
+  Samples.clear();
+  for (unsigned int s = 0; s < NSamples; ++s) {
+    MNeuralNetworkIO IO;
+    IO.SetNInputs(NInputs);
+    double Distance = 0;
+    for (unsigned int i = 0; i < NInputs; ++i) {
+      double Value = 0.01 + 0.98*gRandom->Rndm();
+      IO.SetInput(i, Value);
+      Distance += (Value - 0.5)*(Value - 0.5);
+    }
+    bool Inside = sqrt(Distance) < 0.25*sqrt(double(NInputs));
+    IO.SetNOutputs(NOutputs);
+    for (unsigned int o = 0; o < NOutputs; ++o) {
+      IO.SetOutput(o, ((Inside == true) == (o % 2 == 0)) ? 0.75 : 0.25);
+    }
+    Samples.push_back(IO);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Learn all samples one by one with the object interface
+void UTNeuralNetworkBatch::LearnSequentially(MNeuralNetworkBackpropagation& NN, vector<MNeuralNetworkIO>& Samples)
+{
+  for (MNeuralNetworkIO& IO: Samples) {
+    NN.SetInput(IO);
+    NN.Run();
+    NN.SetOutputError(IO);
+    NN.Learn();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the fraction of samples for which the first output is on the correct side of 0.5
+double UTNeuralNetworkBatch::GetAccuracy(MNeuralNetworkBackpropagation& NN, vector<MNeuralNetworkIO>& Samples)
+{
+  unsigned int NCorrect = 0;
+  for (MNeuralNetworkIO& IO: Samples) {
+    NN.SetInput(IO);
+    NN.Run();
+    if ((NN.GetOutput(0) > 0.5) == (IO.GetOutput(0) > 0.5)) ++NCorrect;
+  }
+
+  return double(NCorrect)/Samples.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the largest difference between the outputs of the two networks for the samples
+double UTNeuralNetworkBatch::GetMaximumDifference(MNeuralNetworkBackpropagation& A, MNeuralNetworkBackpropagation& B, vector<MNeuralNetworkIO>& Samples)
+{
+  double Maximum = 0;
+  for (MNeuralNetworkIO& IO: Samples) {
+    A.SetInput(IO);
+    A.Run();
+    B.SetInput(IO);
+    B.Run();
+    for (unsigned int o = 0; o < A.GetNOutputNodes(); ++o) {
+      Maximum = max(Maximum, fabs(A.GetOutput(o) - B.GetOutput(o)));
+    }
+  }
+
+  return Maximum;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that a batch size of one follows the per-sample learning
+bool UTNeuralNetworkBatch::TestSingleSampleBatches()
+{
+  vector<MNeuralNetworkIO> Samples;
+  CreateSamples(200, 5, 3, Samples);
+
+  MNeuralNetworkBackpropagation Sequential;
+  CreateNetwork(Sequential, 5, 10, 3);
+  MNeuralNetworkBackpropagation Batched(Sequential);
+
+  LearnSequentially(Sequential, Samples);
+  if (Batched.LearnBatches(Samples, 1, 1) == false) {
+    cout<<"Failed: LearnBatches returned false"<<endl;
+    return false;
+  }
+
+  // The only difference is that the middle layer error is calculated with the output weights before instead of after their update,
+  // which is a second order effect accumulating slowly over the samples
+  double Difference = GetMaximumDifference(Sequential, Batched, Samples);
+  if (Difference > 0.01) {
+    cout<<"Failed: The outputs after learning with a batch size of one differ by up to "<<Difference<<" from the per-sample learning"<<endl;
+    return false;
+  }
+
+  cout<<"Single sample batches (max. output difference: "<<Difference<<"): passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the result does not depend on the number of threads
+bool UTNeuralNetworkBatch::TestThreadIndependence()
+{
+  vector<MNeuralNetworkIO> Samples;
+  CreateSamples(5000, 8, 2, Samples);
+
+  MNeuralNetworkBackpropagation Reference;
+  CreateNetwork(Reference, 8, 20, 2);
+  MNeuralNetworkBackpropagation Copy(Reference);
+  Reference.LearnBatches(Samples, 100, 1);
+
+  for (unsigned int NThreads: { 2U, 7U, 0U }) {
+    MNeuralNetworkBackpropagation Multi(Copy);
+    Multi.LearnBatches(Samples, 100, NThreads);
+
+    // Only the summation order of the gradients differs
+    double Difference = GetMaximumDifference(Reference, Multi, Samples);
+    if (Difference > 1E-10) {
+      cout<<"Failed: The outputs after learning with "<<NThreads<<" threads differ by up to "<<Difference<<" from the ones with one thread"<<endl;
+      return false;
+    }
+  }
+
+  cout<<"Thread independence: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the network learns a simple classification, and time the per-sample and the batched learning
+bool UTNeuralNetworkBatch::TestLearning()
+{
+  vector<MNeuralNetworkIO> Training;
+  CreateSamples(20000, 4, 2, Training);
+  vector<MNeuralNetworkIO> Verification;
+  CreateSamples(5000, 4, 2, Verification);
+
+  MNeuralNetworkBackpropagation Sequential;
+  CreateNetwork(Sequential, 4, 30, 2);
+  MNeuralNetworkBackpropagation Batched(Sequential);
+  double Initial = GetAccuracy(Sequential, Verification);
+
+  const unsigned int NEpochs = 20;
+
+  MTimer Timer;
+  for (unsigned int e = 0; e < NEpochs; ++e) {
+    LearnSequentially(Sequential, Training);
+  }
+  double TimeSequential = Timer.GetElapsed();
+
+  Timer.Reset();
+  for (unsigned int e = 0; e < NEpochs; ++e) {
+    if (Batched.LearnBatches(Training, 16, 0) == false) {
+      cout<<"Failed: LearnBatches returned false"<<endl;
+      return false;
+    }
+  }
+  double TimeBatched = Timer.GetElapsed();
+
+  double AccuracySequential = GetAccuracy(Sequential, Verification);
+  double AccuracyBatched = GetAccuracy(Batched, Verification);
+
+  cout<<"Learning (accuracy before: "<<Initial<<", per sample: "<<AccuracySequential<<", batched: "<<AccuracyBatched<<")"
+      <<" - per sample: "<<TimeSequential<<" sec, batched: "<<TimeBatched<<" sec"<<endl;
+
+  if (AccuracyBatched < 0.85 || AccuracyBatched < AccuracySequential - 0.05) {
+    cout<<"Failed: The batched learning did not learn the classification"<<endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTNeuralNetworkBatch::Run()
+{
+  gRandom->SetSeed(12345);
+
+  bool Passed = true;
+  Passed = TestSingleSampleBatches() && Passed;
+  Passed = TestThreadIndependence() && Passed;
+  Passed = TestLearning() && Passed;
+
+  cout<<"Neural network batch learning test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("NeuralNetworkBatch", "unit test and benchmark of the mini-batch training of neural networks");
+
+  UTNeuralNetworkBatch Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
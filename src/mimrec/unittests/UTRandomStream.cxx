@@ -0,0 +1,288 @@
+/*
+ * UTRandomStream.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MDRandom.h"
+#include "MDRandomStream.h"
+
+// Standard lib:
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test for the counter-based random streams used for noising
+class UTRandomStream
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTRandomStream() {};
+  //! Default destructor
+  virtual ~UTRandomStream() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Check the first random number against the Philox4x32-10 known-answer test
+  bool TestKnownAnswer();
+  //! Check that the random numbers are uniformly distributed and the streams are uncorrelated
+  bool TestDistribution();
+  //! Check that noising events in several threads gives the same results as in one thread
+  bool TestThreadIndependence();
+  //! Check that the run ID and the seed select independent streams for the same event and hit
+  bool TestRunsAndSeeds();
+
+  //! "Noise" the events First, First+Step, ... with MDRandom streams and store the results
+  static void NoiseEvents(unsigned int First, unsigned int Step, vector<double>& Results);
+
+  //! The number of events for the thread test
+  static const unsigned int c_NEvents = 20000;
+  //! The number of hits per event for the thread test
+  static const unsigned int c_NHits = 8;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the first random number against the Philox4x32-10 known-answer test
+bool UTRandomStream::TestKnownAnswer()
+{
+  // Philox4x32-10 with counter 0 and key 0 gives: 6627e8d5 e169c58d bc57ac4c 9b00dbd8
+  MDRandomStream Stream;
+  Stream.SetStream(0, 0, 0);
+
+  uint64_t Expected1 = ((uint64_t(0x6627e8d5) << 32) | 0xe169c58d) >> 11;
+  uint64_t Expected2 = ((uint64_t(0xbc57ac4c) << 32) | 0x9b00dbd8) >> 11;
+
+  double R1 = Stream.Rndm();
+  double R2 = Stream.Rndm();
+  if (R1 != (Expected1 + 0.5) / 9007199254740992.0 || R2 != (Expected2 + 0.5) / 9007199254740992.0) {
+    cout<<"Failed: The first random numbers do not match the Philox4x32-10 known answer"<<endl;
+    return false;
+  }
+
+  // Restarting a stream gives the same numbers
+  Stream.SetStream(0, 0, 0);
+  if (Stream.Rndm() != R1) {
+    cout<<"Failed: Restarting the stream does not reproduce it"<<endl;
+    return false;
+  }
+
+  cout<<"Known answer: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the random numbers are uniformly distributed and the streams are uncorrelated
+bool UTRandomStream::TestDistribution()
+{
+  bool Passed = true;
+
+  // Uniformity: one long stream
+  const unsigned int NBins = 100;
+  const unsigned int NSamples = 10000000;
+  vector<double> Counts(NBins, 0);
+  MDRandomStream Stream;
+  Stream.SetStream(4711, 123456789012UL, 3);
+  for (unsigned int i = 0; i < NSamples; ++i) {
+    double R = Stream.Rndm();
+    if (R <= 0.0 || R >= 1.0) {
+      cout<<"Failed: Random number outside ]0, 1[: "<<R<<endl;
+      return false;
+    }
+    Counts[static_cast<unsigned int>(R*NBins)]++;
+  }
+  double ChiSquare = 0;
+  double Expected = double(NSamples)/NBins;
+  for (double C: Counts) {
+    ChiSquare += (C - Expected)*(C - Expected)/Expected;
+  }
+  cout<<"Uniformity: chi-square/ndf: "<<ChiSquare/(NBins-1)<<endl;
+  if (ChiSquare/(NBins-1) > 1.5) {
+    cout<<"Failed: The random numbers are not uniformly distributed"<<endl;
+    Passed = false;
+  }
+
+  // Neighbouring streams, as they are used for consecutive events and hits, must be uncorrelated
+  const unsigned int NStreams = 1000000;
+  double SumX = 0, SumY = 0, SumXY = 0, SumXX = 0, SumYY = 0;
+  for (unsigned int s = 0; s < NStreams; ++s) {
+    Stream.SetStream(0, s, 1);
+    double X = Stream.Rndm();
+    Stream.SetStream(0, s+1, 1);
+    double Y = Stream.Rndm();
+    SumX += X; SumY += Y; SumXY += X*Y; SumXX += X*X; SumYY += Y*Y;
+  }
+  double Correlation = (SumXY/NStreams - SumX*SumY/NStreams/NStreams) /
+    sqrt((SumXX/NStreams - SumX*SumX/NStreams/NStreams)*(SumYY/NStreams - SumY*SumY/NStreams/NStreams));
+  cout<<"Correlation of neighbouring streams: "<<Correlation<<endl;
+  if (fabs(Correlation) > 5.0/sqrt(double(NStreams))) {
+    cout<<"Failed: Neighbouring streams are correlated"<<endl;
+    Passed = false;
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! "Noise" the events First, First+Step, ... with MDRandom streams and store the results
+void UTRandomStream::NoiseEvents(unsigned int First, unsigned int Step, vector<double>& Results)
+{
+  for (unsigned int e = First; e < c_NEvents; e += Step) {
+    for (unsigned int h = 0; h < c_NHits; ++h) {
+      MDRandom::SetStream(e, h+1);
+      // Rejection loops as in the detector noising consume a varying number of random numbers
+      double Energy = 0;
+      do {
+        Energy = MDRandom::Get()->Gaus(100.0, 10.0);
+      } while (MDRandom::Get()->Rndm() < 0.3);
+      Results[e*c_NHits + h] = Energy;
+    }
+  }
+  MDRandom::ClearStream();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that noising events in several threads gives the same results as in one thread
+bool UTRandomStream::TestThreadIndependence()
+{
+  vector<double> Single(c_NEvents*c_NHits, 0);
+  NoiseEvents(0, 1, Single);
+
+  if (MDRandom::HasStream() == true) {
+    cout<<"Failed: The stream is still active after ClearStream"<<endl;
+    return false;
+  }
+
+  for (unsigned int NThreads: { 2U, 7U }) {
+    vector<double> Multi(c_NEvents*c_NHits, 0);
+    vector<thread> Threads;
+    for (unsigned int t = 0; t < NThreads; ++t) {
+      Threads.emplace_back(&UTRandomStream::NoiseEvents, t, NThreads, std::ref(Multi));
+    }
+    for (thread& T: Threads) {
+      T.join();
+    }
+
+    if (Multi != Single) {
+      cout<<"Failed: The results with "<<NThreads<<" threads differ from the ones with one thread"<<endl;
+      return false;
+    }
+  }
+
+  cout<<"Thread independence: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the run ID and the seed select independent streams for the same event and hit
+bool UTRandomStream::TestRunsAndSeeds()
+{
+  MDRandomStream Stream;
+
+  Stream.SetStream(0, 4711, 1, 0);
+  double Reference = Stream.Rndm();
+  Stream.SetStream(0, 4711, 1, 1);
+  double OtherRun = Stream.Rndm();
+  Stream.SetStream(1, 4711, 1, 0);
+  double OtherSeed = Stream.Rndm();
+  if (OtherRun == Reference || OtherSeed == Reference) {
+    cout<<"Failed: Different runs or seeds give the same random numbers"<<endl;
+    return false;
+  }
+
+  // Changing the seed keeps the run
+  Stream.SetStream(1, 4711, 1, 1);
+  double SeedAndRun = Stream.Rndm();
+  Stream.SetStream(0, 4711, 1, 1);
+  Stream.SetSeed(1);
+  if (Stream.Rndm() != SeedAndRun) {
+    cout<<"Failed: Setting the seed does not keep the run"<<endl;
+    return false;
+  }
+
+  // The run ID of a file does not depend on its directory, but on its name
+  if (MDRandom::GetStreamRunID("/data/run1/Sim.p1.inc1.id1.sim.gz") != MDRandom::GetStreamRunID("Sim.p1.inc1.id1.sim.gz") ||
+      MDRandom::GetStreamRunID("Sim.p1.inc1.id1.sim.gz") == MDRandom::GetStreamRunID("Sim.p1.inc2.id1.sim.gz")) {
+    cout<<"Failed: The run IDs of the file names are not as expected"<<endl;
+    return false;
+  }
+
+  cout<<"Runs and seeds: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTRandomStream::Run()
+{
+  bool Passed = true;
+
+  Passed = TestKnownAnswer() && Passed;
+  Passed = TestDistribution() && Passed;
+  Passed = TestThreadIndependence() && Passed;
+  Passed = TestRunsAndSeeds() && Passed;
+
+  cout<<"Random stream test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("RandomStream", "unit test of the counter-based random streams");
+
+  UTRandomStream Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
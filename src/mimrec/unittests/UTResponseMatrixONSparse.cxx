@@ -0,0 +1,225 @@
+/*
+ * UTResponseMatrixONSparse.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MResponseMatrixON.h"
+
+// Standard lib:
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+using namespace std;
+
+
+//! Unit test and benchmark for the sparse accumulation of MResponseMatrixON
+//! Usage: UTResponseMatrixONSparse [number of entries for the benchmark, default: 10^8]
+class UTResponseMatrixONSparse
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTResponseMatrixONSparse();
+  //! Default destructor
+  virtual ~UTResponseMatrixONSparse() {};
+
+  //! Run all tests
+  bool Run(unsigned long NEntries);
+
+  // protected methods:
+protected:
+  //! A fast random number generator (xorshift), which does not dominate the timing
+  uint64_t Random();
+  //! Check that sparse and non-sparse accumulation give identical matrices
+  bool TestConsistency();
+  //! Benchmark filling the sparse matrix
+  void BenchmarkFill(unsigned long NEntries);
+
+  // private members:
+private:
+  //! The state of the random number generator
+  uint64_t m_State;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Default constructor
+UTResponseMatrixONSparse::UTResponseMatrixONSparse()
+{
+  m_State = 88172645463325252ULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! A fast random number generator (xorshift)
+uint64_t UTResponseMatrixONSparse::Random()
+{
+  m_State ^= m_State << 13;
+  m_State ^= m_State >> 7;
+  m_State ^= m_State << 17;
+  return m_State;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that sparse and non-sparse accumulation give identical matrices
+bool UTResponseMatrixONSparse::TestConsistency()
+{
+  bool Passed = true;
+
+  MResponseMatrixON Dense("Dense", false);
+  MResponseMatrixON Sparse("Sparse", true);
+  for (MResponseMatrixON* R: { &Dense, &Sparse }) {
+    R->AddAxisLinear("x", 200, 0, 200);
+    R->AddAxisLinear("y", 200, 0, 200);
+    R->AddAxisLinear("z", 100, 0, 100);
+  }
+
+  // Enough entries to trigger several merges, and many repeated bins
+  unsigned long NBins = Dense.GetNBins();
+  for (unsigned long e = 0; e < 10000000; ++e) {
+    unsigned long Bin = (e % 3 == 0) ? Random() % 1000 : Random() % NBins;
+    float Value = 0.001f * (Random() % 1000 + 1);
+    Dense.Add(Bin, Value);
+    Sparse.Add(Bin, Value);
+    if (e == 5000000) {
+      // A Set in between needs all previous additions
+      Dense.Set(Bin, 1.0f);
+      Sparse.Set(Bin, 1.0f);
+    }
+  }
+
+  unsigned long NNonZero = 0;
+  for (unsigned long b = 0; b < NBins; ++b) {
+    if (Dense.Get(b) != Sparse.Get(b)) {
+      cout<<"Failed: Bin "<<b<<" differs: dense="<<Dense.Get(b)<<" vs. sparse="<<Sparse.Get(b)<<endl;
+      Passed = false;
+      break;
+    }
+    if (Dense.Get(b) != 0) ++NNonZero;
+  }
+
+  if (Sparse.GetNumberOfSparseBins() != NNonZero) {
+    cout<<"Failed: Number of sparse bins: "<<Sparse.GetNumberOfSparseBins()<<" vs. "<<NNonZero<<" non-zero bins"<<endl;
+    Passed = false;
+  }
+
+  for (unsigned long s = 1; s < Sparse.GetNumberOfSparseBins(); ++s) {
+    if (Sparse.FindBin(Sparse.FindBinsSparse(s-1)) >= Sparse.FindBin(Sparse.FindBinsSparse(s))) {
+      cout<<"Failed: Sparse bins are not sorted at "<<s<<endl;
+      Passed = false;
+      break;
+    }
+  }
+
+  MResponseMatrixON Copy = Sparse;
+  if (Copy.GetSum() != Sparse.GetSum()) {
+    cout<<"Failed: The copy has a different sum"<<endl;
+    Passed = false;
+  }
+
+  cout<<"Consistency test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Benchmark filling the sparse matrix
+void UTResponseMatrixONSparse::BenchmarkFill(unsigned long NEntries)
+{
+  // For reference: the previous approach with one sorted insertion per entry - only feasible for a small number of entries
+  unsigned long NReference = 200000;
+  unsigned long NBins = 1000UL*1000UL*100UL;
+
+  MTimer Timer;
+  vector<unsigned long> Bins;
+  vector<float> Values;
+  for (unsigned long e = 0; e < NReference; ++e) {
+    unsigned long Bin = Random() % NBins;
+    auto IterBins = lower_bound(Bins.begin(), Bins.end(), Bin);
+    auto IterValues = Values.begin() + distance(Bins.begin(), IterBins);
+    if (IterBins != Bins.end() && *IterBins == Bin) {
+      (*IterValues) += 1.0f;
+    } else {
+      Bins.insert(IterBins, Bin);
+      Values.insert(IterValues, 1.0f);
+    }
+  }
+  double TimeReference = Timer.GetElapsed();
+
+  Timer.Start();
+  MResponseMatrixON Sparse("Sparse", true);
+  Sparse.AddAxisLinear("x", 1000, 0, 1000);
+  Sparse.AddAxisLinear("y", 1000, 0, 1000);
+  Sparse.AddAxisLinear("z", 100, 0, 100);
+  for (unsigned long e = 0; e < NEntries; ++e) {
+    Sparse.Add(Random() % NBins, 1.0f);
+  }
+  double TimeFill = Timer.GetElapsed();
+  Timer.Start();
+  Sparse.MergePendingSparse();
+  double TimeMerge = Timer.GetElapsed();
+
+  cout<<"Sorted insertion:      "<<setw(10)<<NReference<<" entries in "<<setw(8)<<TimeReference<<" sec ("<<NReference/TimeReference<<" entries/sec)"<<endl;
+  cout<<"Buffered accumulation: "<<setw(10)<<NEntries<<" entries in "<<setw(8)<<TimeFill + TimeMerge<<" sec ("<<NEntries/(TimeFill + TimeMerge)<<" entries/sec, final merge: "<<TimeMerge<<" sec)"<<endl;
+  cout<<"Sparse bins: "<<Sparse.GetNumberOfSparseBins()<<", sum: "<<Sparse.GetSum()<<endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTResponseMatrixONSparse::Run(unsigned long NEntries)
+{
+  bool Passed = TestConsistency();
+
+  BenchmarkFill(NEntries);
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("ResponseMatrixONSparse", "unit test and benchmark of the sparse response matrix accumulation");
+
+  UTResponseMatrixONSparse Test;
+
+  return (Test.Run(argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000000UL) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
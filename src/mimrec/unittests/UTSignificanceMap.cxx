@@ -0,0 +1,266 @@
+/*
+ * UTSignificanceMap.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MVector.h"
+#include "MCoordinateSystem.h"
+#include "MComptonEvent.h"
+#include "MSignificanceMap.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the cone-indexed significance map counting compared to testing all bins
+class UTSignificanceMap
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTSignificanceMap() {};
+  //! Default destructor
+  virtual ~UTSignificanceMap() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Create random Compton events, some of them with detector rotation and galactic pointing
+  void CreateEvents(unsigned int NEvents, vector<MComptonEvent*>& Events);
+  //! Count the events by testing all bins as the original significance map: center, 8 test points, center and 0..8, no center and 1..8 test points
+  void CountAllBins(const vector<MComptonEvent*>& Events, vector<vector<unsigned int>>& Counts);
+  //! Compare the cone-indexed counts with the ones of all bins for the given number of threads, and time both
+  bool TestCounts(const vector<MComptonEvent*>& Events, MCoordinateSystem CoordinateSystem);
+
+  //! The binning
+  double m_XMin, m_XMax, m_YMin, m_YMax;
+  unsigned int m_NBinsX, m_NBinsY;
+  //! The maximum ARM and the test point distance
+  double m_Radius, m_Distance;
+  //! The coordinate system
+  MCoordinateSystem m_CoordinateSystem;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create random Compton events, some of them with detector rotation and galactic pointing
+void UTSignificanceMap::CreateEvents(unsigned int NEvents, vector<MComptonEvent*>& Events)
+{
+  Events.clear();
+
+  while (Events.size() < NEvents) {
+    MVector C1(gRandom->Uniform(-10, 10), gRandom->Uniform(-10, 10), gRandom->Uniform(-10, 10));
+    MVector Direction;
+    Direction.SetMagThetaPhi(gRandom->Uniform(1, 20), acos(gRandom->Uniform(-1, 1)), gRandom->Uniform(0, 2*c_Pi));
+    MVector C2 = C1 + Direction;
+    MVector De(0, 0, 1);
+    double Ee = gRandom->Uniform(20, 1000);
+    double Eg = gRandom->Uniform(100, 2000);
+
+    MComptonEvent* Event = new MComptonEvent();
+    if (Event->Assimilate(C1, C2, De, Ee, Eg) == false) {
+      delete Event;
+      continue;
+    }
+
+    if (gRandom->Rndm() < 0.3) {
+      double Angle = gRandom->Uniform(0, 2*c_Pi);
+      Event->SetDetectorRotationXAxis(MVector(cos(Angle), sin(Angle), 0));
+      Event->SetDetectorRotationZAxis(MVector(0, 0, 1));
+    }
+    if (gRandom->Rndm() < 0.5) {
+      // Orthogonal axes: Z at (L+180, 90-B) is perpendicular to X at (L, B)
+      double L = gRandom->Uniform(0, 360);
+      double B = gRandom->Uniform(-90, 90);
+      Event->SetGalacticPointingXAxis(L, B);
+      Event->SetGalacticPointingZAxis(L+180, 90-B);
+    }
+
+    Events.push_back(Event);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Count the events by testing all bins as the original significance map: center, 8 test points, center and 0..8, no center and 1..8 test points
+void UTSignificanceMap::CountAllBins(const vector<MComptonEvent*>& Events, vector<vector<unsigned int>>& Counts)
+{
+  Counts.assign(26, vector<unsigned int>(m_NBinsX*m_NBinsY, 0));
+
+  double dX = (m_XMax-m_XMin)/((double)m_NBinsX);
+  double dY = (m_YMax-m_YMin)/((double)m_NBinsY);
+  double DistDiag = m_Distance/sqrt(2.);
+
+  vector<MVector> P(9);
+  for (MComptonEvent* Event: Events) {
+    for (unsigned int i_X=0; i_X<m_NBinsX; i_X++) {
+      double L = m_XMin + dX*(double)i_X + dX/2.;
+      for (unsigned int i_Y=0; i_Y<m_NBinsY; i_Y++) {
+        double B = m_YMin + dY*(double)i_Y + dY/2.;
+        P[0].SetMagThetaPhi(c_FarAway, (B+90)*c_Rad, L*c_Rad);
+        P[1].SetMagThetaPhi(c_FarAway, (90+B+m_Distance)*c_Rad, (L           )*c_Rad);
+        P[2].SetMagThetaPhi(c_FarAway, (90+B+DistDiag  )*c_Rad, (L-DistDiag  )*c_Rad);
+        P[3].SetMagThetaPhi(c_FarAway, (90+B           )*c_Rad, (L-m_Distance)*c_Rad);
+        P[4].SetMagThetaPhi(c_FarAway, (90+B-DistDiag  )*c_Rad, (L-DistDiag  )*c_Rad);
+        P[5].SetMagThetaPhi(c_FarAway, (90+B-m_Distance)*c_Rad, (L           )*c_Rad);
+        P[6].SetMagThetaPhi(c_FarAway, (90+B-DistDiag  )*c_Rad, (L+DistDiag  )*c_Rad);
+        P[7].SetMagThetaPhi(c_FarAway, (90+B           )*c_Rad, (L+m_Distance)*c_Rad);
+        P[8].SetMagThetaPhi(c_FarAway, (90+B+DistDiag  )*c_Rad, (L+DistDiag  )*c_Rad);
+
+        unsigned int Bin = i_X + i_Y*m_NBinsX;
+        bool AtCenter = (fabs(Event->GetARMGamma(P[0], m_CoordinateSystem)*c_Deg) <= m_Radius);
+        unsigned int NTestPoints = 0;
+        for (unsigned int t = 1; t <= 8; ++t) {
+          if (fabs(Event->GetARMGamma(P[t], m_CoordinateSystem)*c_Deg) <= m_Radius) {
+            Counts[t][Bin]++;
+            NTestPoints++;
+          }
+        }
+        if (AtCenter == true) {
+          Counts[0][Bin]++;
+          Counts[9 + NTestPoints][Bin]++;
+        } else if (NTestPoints > 0) {
+          Counts[18 + NTestPoints - 1][Bin]++;
+        }
+      }
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Compare the cone-indexed counts with the ones of all bins for the given number of threads, and time both
+bool UTSignificanceMap::TestCounts(const vector<MComptonEvent*>& Events, MCoordinateSystem CoordinateSystem)
+{
+  m_CoordinateSystem = CoordinateSystem;
+
+  MTimer Timer;
+  vector<vector<unsigned int>> Reference;
+  CountAllBins(Events, Reference);
+  double TimeAllBins = Timer.GetElapsed();
+
+  for (unsigned int NThreads: { 1U, 3U, 0U }) {
+    Timer.Reset();
+    MSignificanceMap Map;
+    Map.SetBinning(m_XMin, m_XMax, m_NBinsX, m_YMin, m_YMax, m_NBinsY);
+    Map.SetTestPoints(m_Radius, m_Distance);
+    Map.SetCoordinateSystem(m_CoordinateSystem);
+    Map.SetNumberOfThreads(NThreads);
+    Map.Initialize();
+    // In two blocks as in the significance map of mimrec
+    vector<MComptonEvent*> First(Events.begin(), Events.begin() + Events.size()/2);
+    vector<MComptonEvent*> Second(Events.begin() + Events.size()/2, Events.end());
+    Map.AddEvents(First);
+    Map.AddEvents(Second);
+    double TimeIndexed = Timer.GetElapsed();
+
+    for (unsigned int x = 0; x < m_NBinsX; ++x) {
+      for (unsigned int y = 0; y < m_NBinsY; ++y) {
+        unsigned int Bin = x + y*m_NBinsX;
+        vector<unsigned int> Indexed(26, 0);
+        Indexed[0] = Map.GetCenterCounts(x, y);
+        for (unsigned int k = 1; k <= 8; ++k) {
+          Indexed[k] = Map.GetTestPointCounts(k, x, y);
+          Indexed[18 + k - 1] = Map.GetNoCenterAndTestPointsCounts(k, x, y);
+        }
+        for (unsigned int k = 0; k <= 8; ++k) {
+          Indexed[9 + k] = Map.GetCenterAndTestPointsCounts(k, x, y);
+        }
+        for (unsigned int t = 0; t < 26; ++t) {
+          if (Indexed[t] != Reference[t][Bin]) {
+            cout<<"Failed: Count type "<<t<<" in bin ("<<x<<", "<<y<<") with "<<NThreads<<" threads is "<<Indexed[t]<<" instead of "<<Reference[t][Bin]<<endl;
+            return false;
+          }
+        }
+      }
+    }
+
+    cout<<"Counts ("<<(m_CoordinateSystem == MCoordinateSystem::c_Galactic ? "galactic" : "spheric")<<", "<<NThreads<<" threads, "
+        <<double(Map.GetNTestedBins())/Events.size()/(m_NBinsX*m_NBinsY)*100<<"% of the bins tested): passed"
+        <<" - all bins: "<<TimeAllBins<<" sec, cone-indexed: "<<TimeIndexed<<" sec"<<endl;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTSignificanceMap::Run()
+{
+  gRandom->SetSeed(12345);
+
+  vector<MComptonEvent*> Events;
+  CreateEvents(2000, Events);
+
+  bool Passed = true;
+
+  // Full sky
+  m_XMin = -180; m_XMax = 180; m_NBinsX = 180;
+  m_YMin = -90; m_YMax = 90; m_NBinsY = 90;
+  m_Radius = 3; m_Distance = 2;
+  Passed = TestCounts(Events, MCoordinateSystem::c_Galactic) && Passed;
+  Passed = TestCounts(Events, MCoordinateSystem::c_Spheric) && Passed;
+
+  // Partial sky with test points beyond the poles
+  m_XMin = -60; m_XMax = 40; m_NBinsX = 50;
+  m_YMin = 30; m_YMax = 90; m_NBinsY = 30;
+  m_Radius = 5; m_Distance = 4;
+  Passed = TestCounts(Events, MCoordinateSystem::c_Galactic) && Passed;
+
+  for (MComptonEvent* E: Events) delete E;
+
+  cout<<"Significance map test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("SignificanceMap", "unit test and benchmark of the cone-indexed significance map");
+
+  UTSignificanceMap Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,311 @@
+/*
+ * UTSpectralAnalyzer.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MDGeometryQuest.h"
+#include "MDDetector.h"
+#include "MDTrigger.h"
+#include "MSpectralAnalyzer.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <cmath>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+//! Unit test for the incremental mode of the spectral analyzer: feeding the events incrementally
+//! has to give the same isotope identification as the batch analysis of the same spectrum
+//! Usage: UTSpectralAnalyzer [geometry setup file]
+class UTSpectralAnalyzer
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTSpectralAnalyzer() {};
+  //! Default destructor
+  virtual ~UTSpectralAnalyzer() {};
+
+  //! Run all tests
+  bool Run(MString FileName);
+
+  // protected methods:
+protected:
+  //! Check a growing spectrum: the events are added in chunks with an identification after each chunk
+  bool TestGrowingSpectrum(MDGeometryQuest& Geometry);
+  //! Check a sliding window: new events with a different isotope mix are added and the old ones removed
+  bool TestSlidingWindow(MDGeometryQuest& Geometry);
+
+  //! Create the energies of a continuum plus the given lines, smeared with the detector resolution
+  vector<double> CreateEnergies(MDGeometryQuest& Geometry, unsigned int NEvents, const vector<double>& Lines, double LineFraction);
+  //! Set up a spectral analyzer
+  void SetUp(MSpectralAnalyzer& Analyzer, MDGeometryQuest& Geometry, bool Incremental);
+  //! Return the sorted names of the identified isotopes
+  vector<MString> GetIsotopeNames(MSpectralAnalyzer& Analyzer);
+  //! Compare the results of the incremental and the batch analysis
+  bool Compare(const MString& What, MSpectralAnalyzer& Incremental, MSpectralAnalyzer& Batch, const vector<MString>& Required);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create the energies of a continuum plus the given lines, smeared with the detector resolution
+vector<double> UTSpectralAnalyzer::CreateEnergies(MDGeometryQuest& Geometry, unsigned int NEvents, const vector<double>& Lines, double LineFraction)
+{
+  // The same average resolution of the triggering detectors as used by the analyzer
+  vector<MDDetector*> Detectors;
+  for (unsigned int d = 0; d < Geometry.GetNDetectors(); ++d) {
+    for (unsigned int t = 0; t < Geometry.GetNTriggers(); ++t) {
+      if (Geometry.GetTriggerAt(t)->IsTriggering(Geometry.GetDetectorAt(d)) == true) {
+        Detectors.push_back(Geometry.GetDetectorAt(d));
+        break;
+      }
+    }
+  }
+
+  vector<double> Energies;
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    if (Lines.size() > 0 && gRandom->Rndm() < LineFraction) {
+      double Line = Lines[gRandom->Integer(Lines.size())];
+      double Sigma = 0.0;
+      for (unsigned int d = 0; d < Detectors.size(); ++d) {
+        double R = Detectors[d]->GetEnergyResolution(Line/Detectors.size(), MVector(0.0, 0.0, 0.0));
+        Sigma += R*R;
+      }
+      Sigma = sqrt(Sigma);
+      Energies.push_back(gRandom->Gaus(Line, Sigma));
+    } else {
+      Energies.push_back(50.0 + gRandom->Exp(400.0));
+    }
+  }
+
+  return Energies;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Set up a spectral analyzer
+void UTSpectralAnalyzer::SetUp(MSpectralAnalyzer& Analyzer, MDGeometryQuest& Geometry, bool Incremental)
+{
+  Analyzer.SetBatch(true);
+  Analyzer.SetGeometry(&Geometry);
+  Analyzer.SetSpectrum(1000, 20.0, 2000.0, 2);
+  Analyzer.SetSignaltoNoiseRatio(3);
+  Analyzer.SetPoissonLimit(20);
+  Analyzer.SetIsotopeFileName("$(MEGALIB)/resource/libraries/Calibration.isotopes");
+  Analyzer.SetEnergyRange(1.0);
+  Analyzer.UseIncrementalMode(Incremental);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return the sorted names of the identified isotopes
+vector<MString> UTSpectralAnalyzer::GetIsotopeNames(MSpectralAnalyzer& Analyzer)
+{
+  vector<MString> Names;
+  for (const MQualifiedIsotope& I: Analyzer.GetIsotopes()) {
+    Names.push_back(I.GetName());
+  }
+  sort(Names.begin(), Names.end(), [](const MString& A, const MString& B) { return A.GetString() < B.GetString(); });
+
+  return Names;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Compare the results of the incremental and the batch analysis
+bool UTSpectralAnalyzer::Compare(const MString& What, MSpectralAnalyzer& Incremental, MSpectralAnalyzer& Batch, const vector<MString>& Required)
+{
+  bool Passed = true;
+
+  vector<MString> IncrementalNames = GetIsotopeNames(Incremental);
+  vector<MString> BatchNames = GetIsotopeNames(Batch);
+
+  // Otherwise the test is pointless
+  for (const MString& R: Required) {
+    if (find(BatchNames.begin(), BatchNames.end(), R) == BatchNames.end()) {
+      cout<<"Failed: "<<What<<": The batch analysis did not identify "<<R<<endl;
+      Passed = false;
+    }
+  }
+
+  if (IncrementalNames != BatchNames) {
+    cout<<"Failed: "<<What<<": Different isotopes - incremental:";
+    for (const MString& N: IncrementalNames) cout<<" "<<N;
+    cout<<", batch:";
+    for (const MString& N: BatchNames) cout<<" "<<N;
+    cout<<endl;
+    Passed = false;
+  }
+
+  // The peak search runs on the same spectrum, thus the same peaks have to be accepted
+  vector<MPeak*> IncrementalPeaks = Incremental.GetPeaks();
+  vector<MPeak*> BatchPeaks = Batch.GetPeaks();
+  if (IncrementalPeaks.size() != BatchPeaks.size()) {
+    cout<<"Failed: "<<What<<": "<<IncrementalPeaks.size()<<" peaks in incremental mode, but "<<BatchPeaks.size()<<" in batch mode"<<endl;
+    Passed = false;
+  } else {
+    for (unsigned int p = 0; p < BatchPeaks.size(); ++p) {
+      if (IncrementalPeaks[p]->GetEnergy() != BatchPeaks[p]->GetEnergy()) {
+        cout<<"Failed: "<<What<<": Peak "<<p<<" at "<<IncrementalPeaks[p]->GetEnergy()<<" keV in incremental mode, but at "<<BatchPeaks[p]->GetEnergy()<<" keV in batch mode"<<endl;
+        Passed = false;
+      }
+    }
+  }
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check a growing spectrum: the events are added in chunks with an identification after each chunk
+bool UTSpectralAnalyzer::TestGrowingSpectrum(MDGeometryQuest& Geometry)
+{
+  gRandom->SetSeed(12345);
+  vector<double> Energies = CreateEnergies(Geometry, 200000, { 661.657, 1173.237, 1332.501 }, 0.15);
+
+  MSpectralAnalyzer Batch;
+  SetUp(Batch, Geometry, false);
+  Batch.FillSpectrum(Energies);
+  if (Batch.FindIsotopes() == false) {
+    cout<<"Failed: Batch analysis of the growing spectrum"<<endl;
+    return false;
+  }
+
+  MSpectralAnalyzer Incremental;
+  SetUp(Incremental, Geometry, true);
+  const unsigned int NChunks = 10;
+  for (unsigned int c = 0; c < NChunks; ++c) {
+    for (unsigned int e = c*Energies.size()/NChunks; e < (c+1)*Energies.size()/NChunks; ++e) {
+      Incremental.FillSpectrum(Energies[e]);
+    }
+    if (Incremental.FindIsotopes() == false) {
+      cout<<"Failed: Incremental analysis of chunk "<<c<<" of the growing spectrum"<<endl;
+      return false;
+    }
+  }
+
+  bool Passed = Compare("Growing spectrum", Incremental, Batch, { "Cs-137", "Co-60" });
+
+  cout<<"Incremental identification of a growing spectrum: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check a sliding window: new events with a different isotope mix are added and the old ones removed
+bool UTSpectralAnalyzer::TestSlidingWindow(MDGeometryQuest& Geometry)
+{
+  gRandom->SetSeed(54321);
+  vector<double> Old = CreateEnergies(Geometry, 100000, { 661.657, 1173.237, 1332.501 }, 0.15);
+  vector<double> New = CreateEnergies(Geometry, 100000, { 661.657, 510.99, 1274.577 }, 0.15);
+
+  MSpectralAnalyzer Batch;
+  SetUp(Batch, Geometry, false);
+  Batch.FillSpectrum(New);
+  if (Batch.FindIsotopes() == false) {
+    cout<<"Failed: Batch analysis of the sliding window"<<endl;
+    return false;
+  }
+
+  // Like realta: per update add the new events and remove the same number of the oldest ones
+  MSpectralAnalyzer Incremental;
+  SetUp(Incremental, Geometry, true);
+  Incremental.FillSpectrum(Old);
+  Incremental.FindIsotopes();
+  const unsigned int NUpdates = 10;
+  for (unsigned int u = 0; u < NUpdates; ++u) {
+    for (unsigned int e = u*New.size()/NUpdates; e < (u+1)*New.size()/NUpdates; ++e) {
+      Incremental.FillSpectrum(New[e]);
+      Incremental.RemoveFromSpectrum(Old[e]);
+    }
+    if (Incremental.FindIsotopes() == false) {
+      cout<<"Failed: Incremental analysis of update "<<u<<" of the sliding window"<<endl;
+      return false;
+    }
+  }
+
+  bool Passed = Compare("Sliding window", Incremental, Batch, { "Cs-137", "Na-22" });
+
+  vector<MString> Names = GetIsotopeNames(Incremental);
+  if (find(Names.begin(), Names.end(), "Co-60") != Names.end()) {
+    cout<<"Failed: Sliding window: Co-60 is still identified after all its events have been removed"<<endl;
+    Passed = false;
+  }
+
+  cout<<"Incremental identification of a sliding window: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTSpectralAnalyzer::Run(MString FileName)
+{
+  MDGeometryQuest Geometry;
+  if (Geometry.ScanSetupFile(FileName) == false) {
+    cout<<"Failed: Unable to load geometry "<<FileName<<endl;
+    return false;
+  }
+
+  bool Passed = true;
+  Passed = TestGrowingSpectrum(Geometry) && Passed;
+  Passed = TestSlidingWindow(Geometry) && Passed;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("SpectralAnalyzer", "unit test of the incremental isotope identification");
+
+  MString FileName = "$(MEGALIB)/resource/examples/geomega/mpesatellitebaseline/SatelliteWithACS.geo.setup";
+  if (argc > 1) FileName = argv[1];
+
+  UTSpectralAnalyzer Test;
+
+  return (Test.Run(FileName) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
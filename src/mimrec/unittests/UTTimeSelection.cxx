@@ -0,0 +1,350 @@
+/*
+ * UTTimeSelection.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MFile.h"
+#include "MGTI.h"
+#include "MFileEventsTra.h"
+#include "MFileTimeIndex.h"
+#include "MComptonEvent.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <vector>
+using namespace std;
+
+
+//! Unit test for the time selection: merging good and bad time intervals, the GTI cursors, and seeking via the time index
+class UTTimeSelection
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTTimeSelection() {};
+  //! Default destructor
+  virtual ~UTTimeSelection() {};
+
+  //! Run all tests
+  bool Run();
+
+  // protected methods:
+protected:
+  //! Check merging overlapping good intervals and cutting out bad intervals
+  bool TestMerging();
+  //! Check that the cursor searches give the same result as the binary searches
+  bool TestCursors();
+  //! Check that reading with a time selection jumps to the first event of each good interval
+  bool TestTimeIndexSeeking();
+
+  //! Check a merged interval and report a failure
+  bool CheckInterval(const MGTI& GTI, unsigned int i, const MTime& Start, const MTime& Stop);
+  //! Write a tra file with one event per second starting at time 0
+  bool WriteTraFile(const MString& FileName, unsigned int NEvents);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check a merged interval and report a failure
+bool UTTimeSelection::CheckInterval(const MGTI& GTI, unsigned int i, const MTime& Start, const MTime& Stop)
+{
+  if (i >= GTI.GetNMergedIntervals()) {
+    cout<<"Failed: Merged interval "<<i<<" is missing"<<endl;
+    return false;
+  }
+  if (GTI.GetMergedIntervalStart(i) != Start || GTI.GetMergedIntervalStop(i) != Stop) {
+    cout<<"Failed: Merged interval "<<i<<": ["<<GTI.GetMergedIntervalStart(i)<<", "<<GTI.GetMergedIntervalStop(i)<<"] instead of ["<<Start<<", "<<Stop<<"]"<<endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check merging overlapping good intervals and cutting out bad intervals
+bool UTTimeSelection::TestMerging()
+{
+  bool Passed = true;
+
+  const MTime OneNanoSecond(0L, 1L);
+
+  // Overlapping, touching, unsorted, and disjoint good intervals
+  MGTI GTI;
+  GTI.Reset(false);
+  GTI.AddGoodTimeInterval(MTime(50.0), MTime(60.0));
+  GTI.AddGoodTimeInterval(MTime(15.0), MTime(30.0));
+  GTI.AddGoodTimeInterval(MTime(10.0), MTime(20.0));
+  GTI.AddGoodTimeInterval(MTime(30.0), MTime(40.0));
+  GTI.AddGoodTimeInterval(MTime(52.0), MTime(55.0));
+  if (GTI.GetNMergedIntervals() != 2) {
+    cout<<"Failed: "<<GTI.GetNMergedIntervals()<<" instead of 2 merged good intervals"<<endl;
+    Passed = false;
+  }
+  Passed = CheckInterval(GTI, 0, MTime(10.0), MTime(40.0)) && Passed;
+  Passed = CheckInterval(GTI, 1, MTime(50.0), MTime(60.0)) && Passed;
+
+  // A bad interval splits a good one, another one cuts off its end, a third one covers a good one completely
+  GTI.AddBadTimeInterval(MTime(20.0), MTime(25.0));
+  GTI.AddBadTimeInterval(MTime(38.0), MTime(45.0));
+  GTI.AddBadTimeInterval(MTime(49.0), MTime(61.0));
+  MTime Stop1(20.0);
+  Stop1 -= OneNanoSecond;
+  MTime Start2(25.0);
+  Start2 += OneNanoSecond;
+  MTime Stop2(38.0);
+  Stop2 -= OneNanoSecond;
+  if (GTI.GetNMergedIntervals() != 2) {
+    cout<<"Failed: "<<GTI.GetNMergedIntervals()<<" instead of 2 merged intervals after removing the bad intervals"<<endl;
+    Passed = false;
+  }
+  Passed = CheckInterval(GTI, 0, MTime(10.0), Stop1) && Passed;
+  Passed = CheckInterval(GTI, 1, Start2, Stop2) && Passed;
+
+  // The edges are inclusive
+  if (GTI.IsGood(MTime(10.0)) == false || GTI.IsGood(Stop1) == false || GTI.IsGood(MTime(20.0)) == true ||
+      GTI.IsGood(MTime(25.0)) == true || GTI.IsGood(Start2) == false || GTI.IsGood(MTime(55.0)) == true) {
+    cout<<"Failed: Wrong good/bad decision at the edges of the merged intervals"<<endl;
+    Passed = false;
+  }
+
+  // Adding a GTI merges its intervals with ours
+  MGTI Other;
+  Other.Reset(false);
+  Other.AddGoodTimeInterval(MTime(39.0), MTime(70.0));
+  GTI.Add(Other);
+  MTime Start3(45.0);
+  Start3 += OneNanoSecond;
+  MTime Start4(61.0);
+  Start4 += OneNanoSecond;
+  Passed = CheckInterval(GTI, 2, Start3, MTime(49.0) - OneNanoSecond) && Passed;
+  Passed = CheckInterval(GTI, 3, Start4, MTime(70.0)) && Passed;
+
+  cout<<"GTI merging test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that the cursor searches give the same result as the binary searches
+bool UTTimeSelection::TestCursors()
+{
+  bool Passed = true;
+
+  MGTI GTI;
+  GTI.Reset(false);
+  for (unsigned int i = 0; i < 200; ++i) {
+    double Start = gRandom->Uniform(0, 10000);
+    GTI.AddGoodTimeInterval(MTime(Start), MTime(Start + gRandom->Uniform(0, 50)));
+  }
+  for (unsigned int i = 0; i < 50; ++i) {
+    double Start = gRandom->Uniform(0, 10000);
+    GTI.AddBadTimeInterval(MTime(Start), MTime(Start + gRandom->Uniform(0, 20)));
+  }
+
+  // A time-ordered stream with occasional jumps backwards
+  unsigned int Cursor = 0;
+  double Time = -10;
+  for (unsigned int i = 0; i < 100000 && Passed == true; ++i) {
+    Time += gRandom->Uniform(0, 0.2);
+    if (gRandom->Rndm() < 0.001) Time -= gRandom->Uniform(0, 1000);
+    MTime T(Time);
+    if (GTI.IsGood(T, Cursor) != GTI.IsGood(T)) {
+      cout<<"Failed: Cursor and binary search disagree for time "<<T<<endl;
+      Passed = false;
+    }
+  }
+
+  // Time ranges: compare with testing all merged intervals
+  Cursor = 0;
+  Time = -10;
+  for (unsigned int i = 0; i < 20000 && Passed == true; ++i) {
+    Time += gRandom->Uniform(0, 1);
+    if (gRandom->Rndm() < 0.001) Time -= gRandom->Uniform(0, 1000);
+    MTime Start(Time);
+    MTime Stop(Time + gRandom->Uniform(0, 30));
+    bool Expected = false;
+    for (unsigned int m = 0; m < GTI.GetNMergedIntervals(); ++m) {
+      if (GTI.GetMergedIntervalStart(m) <= Stop && GTI.GetMergedIntervalStop(m) >= Start) {
+        Expected = true;
+        break;
+      }
+    }
+    if (GTI.Overlaps(Start, Stop, Cursor) != Expected) {
+      cout<<"Failed: Overlap of ["<<Start<<", "<<Stop<<"] is "<<(Expected == true ? "missed" : "wrongly found")<<endl;
+      Passed = false;
+    }
+  }
+
+  cout<<"GTI cursor test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Write a tra file with one event per second starting at time 0
+bool UTTimeSelection::WriteTraFile(const MString& FileName, unsigned int NEvents)
+{
+  MFileEventsTra File;
+  File.SetTimeIndexEventsPerBlock(100);
+  if (File.Open(FileName, MFile::c_Write) == false) return false;
+  File.WriteHeader();
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    MComptonEvent Event;
+    Event.SetId(e + 1);
+    Event.SetTime(MTime(double(e)));
+    Event.SetEg(300);
+    Event.SetEe(200);
+    Event.SetC1(MVector(0, 0, 0));
+    Event.SetC2(MVector(1, 2, -5));
+    Event.SetSequenceLength(2);
+    Event.Validate();
+    File.AddEvent(&Event);
+  }
+  File.CloseEventList();
+  File.Close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that reading with a time selection jumps to the first event of each good interval
+bool UTTimeSelection::TestTimeIndexSeeking()
+{
+  bool Passed = true;
+
+  const unsigned int NEvents = 2000;
+
+  // Two good intervals, both starting in the middle of a time index block
+  MGTI GTI;
+  GTI.Reset(false);
+  GTI.AddGoodTimeInterval(MTime(1234.5), MTime(1300.0));
+  GTI.AddGoodTimeInterval(MTime(1700.2), MTime(1750.0));
+
+  vector<double> Expected;
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    if (GTI.IsGood(MTime(double(e))) == true) Expected.push_back(e);
+  }
+
+  for (MString Suffix: { ".tra", ".tra.gz" }) {
+    MString FileName = MFile::CreateTemporaryFile(MString("UTTimeSelection") + Suffix);
+    if (FileName == "" || WriteTraFile(FileName, NEvents) == false) {
+      cout<<"Failed: Unable to write the tra file for "<<Suffix<<endl;
+      Passed = false;
+      continue;
+    }
+
+    MFileEventsTra File;
+    File.SetTimeSelection(GTI);
+    if (File.Open(FileName) == false) {
+      cout<<"Failed: Unable to read "<<FileName<<endl;
+      Passed = false;
+    } else {
+      unsigned int NRead = 0;
+      double FirstRead = -1;
+      vector<double> Selected;
+      unsigned int Cursor = 0;
+      MPhysicalEvent* Event = nullptr;
+      while ((Event = File.GetNextEvent()) != nullptr) {
+        if (NRead == 0) FirstRead = Event->GetTime().GetAsSeconds();
+        ++NRead;
+        if (GTI.IsGood(Event->GetTime(), Cursor) == true) {
+          Selected.push_back(Event->GetTime().GetAsSeconds());
+        }
+        delete Event;
+      }
+      File.Close();
+
+      // The blocks before the first good interval are skipped: reading starts at the block containing it
+      if (FirstRead != 1200.0) {
+        cout<<"Failed: Reading "<<Suffix<<" started at time "<<FirstRead<<" instead of the start of the block containing the first good interval (1200)"<<endl;
+        Passed = false;
+      }
+      if (Selected.size() == 0 || Selected.front() != 1235.0) {
+        cout<<"Failed: The first selected event of "<<Suffix<<" is not the first event in the good interval (1235)"<<endl;
+        Passed = false;
+      }
+      if (Selected != Expected) {
+        cout<<"Failed: "<<Selected.size()<<" instead of "<<Expected.size()<<" selected events for "<<Suffix<<endl;
+        Passed = false;
+      }
+      if (NRead >= NEvents/2) {
+        cout<<"Failed: "<<NRead<<" of "<<NEvents<<" events read for "<<Suffix<<" - the time index has not been used"<<endl;
+        Passed = false;
+      }
+    }
+
+    MFile::Remove(FileName);
+    MFile::Remove(MFileTimeIndex::GetIndexFileName(FileName));
+  }
+
+  cout<<"Time index seeking test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTTimeSelection::Run()
+{
+  bool Passed = true;
+
+  gRandom->SetSeed(12345);
+
+  Passed = TestMerging() && Passed;
+  Passed = TestCursors() && Passed;
+  Passed = TestTimeIndexSeeking() && Passed;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("TimeSelection", "unit test of the time selection");
+
+  UTTimeSelection Test;
+
+  return (Test.Run() == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
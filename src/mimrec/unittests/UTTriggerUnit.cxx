@@ -0,0 +1,318 @@
+/*
+ * UTTriggerUnit.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+// MEGAlib:
+#include "MGlobal.h"
+#include "MTimer.h"
+#include "MDGeometry.h"
+#include "MDDetector.h"
+#include "MDVolume.h"
+#include "MDVolumeSequence.h"
+#include "MDTriggerUnit.h"
+#include "MDRandom.h"
+
+// ROOT:
+#include "TRandom.h"
+
+// Standard lib:
+#include <vector>
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+
+//! Unit test and benchmark for the compiled trigger tables of MDTriggerUnit compared to the loop over all triggers
+//! Usage: UTTriggerUnit [geometry setup file]
+class UTTriggerUnit
+{
+  // public interface:
+public:
+  //! Default constructor
+  UTTriggerUnit() {};
+  //! Default destructor
+  virtual ~UTTriggerUnit() {};
+
+  //! Run all tests
+  bool Run(MString FileName);
+
+  // protected methods:
+protected:
+  //! The trigger decisions of one event
+  struct Decision {
+    bool m_HasTriggered;
+    bool m_HasVetoed;
+    vector<MString> m_Triggers;
+    vector<MString> m_Vetoes;
+  };
+
+  //! Create volume sequences of random positions in all sensitive volumes of all detectors
+  void CreateHitPool(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool);
+  //! Create random events as lists of indices into the pool, negative indices are guard ring hits, and their energies
+  void CreateEvents(const vector<MDVolumeSequence>& Pool, unsigned int NEvents, vector<vector<int>>& Events, vector<vector<double>>& Energies);
+  //! Evaluate all events with the trigger unit
+  void Evaluate(MDTriggerUnit* Unit, vector<MDVolumeSequence>& Pool, const vector<vector<int>>& Events, const vector<vector<double>>& Energies, vector<Decision>& Decisions);
+  //! Check the compiled decisions against the loop over all triggers, and time both
+  //! With thresholds, both evaluations start from the same seed and have to draw the same noised thresholds
+  bool TestDecisions(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool, bool IgnoreVetoes, bool IgnoreThresholds);
+  //! Check that copies of the trigger unit keep their own event data, i.e. give the decisions of the original
+  //! even if their hits are added interleaved
+  bool TestCopies(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create volume sequences of random positions in all sensitive volumes of all detectors
+void UTTriggerUnit::CreateHitPool(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool)
+{
+  Pool.clear();
+
+  vector<MDDetector*> Detectors = Geometry.GetDetectorList();
+  for (MDDetector* D: Detectors) {
+    for (unsigned int v = 0; v < D->GetNSensitiveVolumes(); ++v) {
+      for (unsigned int i = 0; i < 20; ++i) {
+        MVector Position = Geometry.GetRandomPositionInVolume(D->GetSensitiveVolume(v)->GetName());
+        if (Position == g_VectorNotDefined) continue;
+        MDVolumeSequence VS = Geometry.GetVolumeSequence(Position, false, true);
+        if (VS.GetDetector() != 0) {
+          Pool.push_back(VS);
+        }
+      }
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Create random events as lists of indices into the pool, negative indices are guard ring hits, and their energies
+void UTTriggerUnit::CreateEvents(const vector<MDVolumeSequence>& Pool, unsigned int NEvents, vector<vector<int>>& Events, vector<vector<double>>& Energies)
+{
+  Events.clear();
+  Energies.clear();
+
+  for (unsigned int e = 0; e < NEvents; ++e) {
+    vector<int> Event;
+    vector<double> Energy;
+    // Including empty events
+    unsigned int NHits = gRandom->Integer(7);
+    for (unsigned int h = 0; h < NHits; ++h) {
+      int Index = int(gRandom->Integer(Pool.size()));
+      if (Pool[Index].GetDetector()->HasGuardRing() == true && gRandom->Rndm() < 0.2) {
+        Event.push_back(-Index-1);
+      } else {
+        Event.push_back(Index);
+      }
+      // Around typical trigger thresholds
+      Energy.push_back(gRandom->Uniform(0.0, 100.0));
+    }
+    Events.push_back(Event);
+    Energies.push_back(Energy);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Evaluate all events with the trigger unit
+void UTTriggerUnit::Evaluate(MDTriggerUnit* Unit, vector<MDVolumeSequence>& Pool, const vector<vector<int>>& Events, const vector<vector<double>>& Energies, vector<Decision>& Decisions)
+{
+  Decisions.resize(Events.size());
+
+  for (unsigned int e = 0; e < Events.size(); ++e) {
+    Unit->Reset();
+    for (unsigned int h = 0; h < Events[e].size(); ++h) {
+      int Index = Events[e][h];
+      if (Index >= 0) {
+        Unit->AddHit(Energies[e][h], Pool[Index]);
+      } else {
+        Unit->AddGuardRingHit(Energies[e][h], Pool[-Index-1]);
+      }
+    }
+    Decisions[e].m_HasTriggered = Unit->HasTriggered();
+    Decisions[e].m_HasVetoed = Unit->HasVetoed();
+    Decisions[e].m_Triggers = Unit->GetTriggerNameList();
+    Decisions[e].m_Vetoes = Unit->GetVetoNameList();
+  }
+  Unit->Reset();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check the compiled decisions against the loop over all triggers, and time both
+bool UTTriggerUnit::TestDecisions(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool, bool IgnoreVetoes, bool IgnoreThresholds)
+{
+  MDTriggerUnit* Unit = Geometry.GetTriggerUnit();
+  Unit->IgnoreThresholds(IgnoreThresholds);
+  Unit->IgnoreVetoes(IgnoreVetoes);
+
+  vector<vector<int>> Events;
+  vector<vector<double>> Energies;
+  CreateEvents(Pool, 200000, Events, Energies);
+
+  MTimer Timer;
+  vector<Decision> Reference;
+  Unit->UseCompiledEvaluation(false);
+  MDRandom::SetSeed(4711);
+  Evaluate(Unit, Pool, Events, Energies, Reference);
+  double TimeLoop = Timer.GetElapsed();
+
+  Timer.Reset();
+  vector<Decision> Compiled;
+  Unit->UseCompiledEvaluation(true);
+  MDRandom::SetSeed(4711);
+  Evaluate(Unit, Pool, Events, Energies, Compiled);
+  double TimeCompiled = Timer.GetElapsed();
+
+  Unit->IgnoreVetoes(false);
+  Unit->IgnoreThresholds(false);
+
+  unsigned int NTriggered = 0;
+  unsigned int NVetoed = 0;
+  for (unsigned int e = 0; e < Events.size(); ++e) {
+    if (Compiled[e].m_HasTriggered != Reference[e].m_HasTriggered || Compiled[e].m_HasVetoed != Reference[e].m_HasVetoed ||
+        Compiled[e].m_Triggers != Reference[e].m_Triggers || Compiled[e].m_Vetoes != Reference[e].m_Vetoes) {
+      cout<<"Failed: The compiled decisions for event "<<e<<" with "<<Events[e].size()<<" hits differ: triggered "
+          <<Compiled[e].m_HasTriggered<<" instead of "<<Reference[e].m_HasTriggered<<", vetoed "
+          <<Compiled[e].m_HasVetoed<<" instead of "<<Reference[e].m_HasVetoed<<endl;
+      return false;
+    }
+    if (Reference[e].m_HasTriggered == true) ++NTriggered;
+    if (Reference[e].m_HasVetoed == true) ++NVetoed;
+  }
+
+  cout<<"Decisions ("<<(IgnoreVetoes == true ? "ignoring vetoes" : "with vetoes")<<", "<<(IgnoreThresholds == true ? "ignoring thresholds" : "with thresholds")<<", "<<NTriggered<<" triggered, "<<NVetoed<<" vetoed): passed"
+      <<" - all triggers: "<<TimeLoop<<" sec, compiled: "<<TimeCompiled<<" sec"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Check that copies of the trigger unit keep their own event data
+bool UTTriggerUnit::TestCopies(MDGeometry& Geometry, vector<MDVolumeSequence>& Pool)
+{
+  MDTriggerUnit* Unit = Geometry.GetTriggerUnit();
+  Unit->IgnoreThresholds(true);
+
+  vector<vector<int>> Events;
+  vector<vector<double>> Energies;
+  CreateEvents(Pool, 20000, Events, Energies);
+
+  vector<Decision> Reference;
+  Evaluate(Unit, Pool, Events, Energies, Reference);
+
+  MDTriggerUnit First(*Unit);
+  MDTriggerUnit Second(*Unit);
+  Unit->IgnoreThresholds(false);
+
+  // Event e goes to the first copy, event e+1 to the second one, with their hits alternating
+  for (unsigned int e = 0; e + 1 < Events.size(); e += 2) {
+    First.Reset();
+    Second.Reset();
+    unsigned int NHits = max(Events[e].size(), Events[e+1].size());
+    for (unsigned int h = 0; h < NHits; ++h) {
+      for (unsigned int c = 0; c < 2; ++c) {
+        MDTriggerUnit& Copy = (c == 0) ? First : Second;
+        unsigned int i = e + c;
+        if (h >= Events[i].size()) continue;
+        int Index = Events[i][h];
+        if (Index >= 0) {
+          Copy.AddHit(Energies[i][h], Pool[Index]);
+        } else {
+          Copy.AddGuardRingHit(Energies[i][h], Pool[-Index-1]);
+        }
+      }
+    }
+    for (unsigned int c = 0; c < 2; ++c) {
+      MDTriggerUnit& Copy = (c == 0) ? First : Second;
+      unsigned int i = e + c;
+      if (Copy.HasTriggered() != Reference[i].m_HasTriggered || Copy.HasVetoed() != Reference[i].m_HasVetoed ||
+          Copy.GetTriggerNameList() != Reference[i].m_Triggers || Copy.GetVetoNameList() != Reference[i].m_Vetoes) {
+        cout<<"Failed: The decisions of copy "<<c<<" for event "<<i<<" differ from the ones of the original trigger unit"<<endl;
+        return false;
+      }
+    }
+  }
+
+  cout<<"Copies of the trigger unit: passed"<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Run all tests
+bool UTTriggerUnit::Run(MString FileName)
+{
+  MDGeometry Geometry;
+  if (Geometry.ScanSetupFile(FileName) == false) {
+    cout<<"Failed: Unable to load geometry "<<FileName<<endl;
+    return false;
+  }
+
+  gRandom->SetSeed(12345);
+
+  vector<MDVolumeSequence> Pool;
+  CreateHitPool(Geometry, Pool);
+  if (Pool.size() == 0) {
+    cout<<"Failed: No hits in detectors could be created for geometry "<<FileName<<endl;
+    return false;
+  }
+
+  bool Passed = true;
+  Passed = TestDecisions(Geometry, Pool, false, true) && Passed;
+  Passed = TestDecisions(Geometry, Pool, true, true) && Passed;
+  Passed = TestDecisions(Geometry, Pool, false, false) && Passed;
+  Passed = TestDecisions(Geometry, Pool, true, false) && Passed;
+  Passed = TestCopies(Geometry, Pool) && Passed;
+
+  cout<<"Trigger unit test: "<<(Passed == true ? "passed" : "FAILED")<<endl;
+
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Main program
+int main(int argc, char** argv)
+{
+  // Initialize global MEGAlib variables, especially mgui, etc.
+  MGlobal::Initialize("TriggerUnit", "unit test and benchmark of the compiled trigger tables");
+
+  MString FileName = "$(MEGALIB)/resource/examples/geomega/mpesatellitebaseline/SatelliteWithACS.geo.setup";
+  if (argc > 1) FileName = argv[1];
+
+  UTTriggerUnit Test;
+
+  return (Test.Run(FileName) == true) ? 0 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
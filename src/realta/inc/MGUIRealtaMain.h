@@ -48,6 +48,9 @@ class MGUIRealtaMain : public TGMainFrame
   void Display();
   void DisplayWindow();
 
+  //! Return the real-time analyzer
+  MRealTimeAnalyzer* GetAnalyzer() { return m_Analyzer; }
+
   //! Run the main control loop
   void DoControlLoop();
   
@@ -67,6 +67,9 @@ class MRealTimeAnalyzer
   void SetSettings(MSettingsRealta* Settings);
   //! Set the accumulation time
   void SetAccumulationTime(double AccumulationTime);
+  //! Record a latency profile of the event reconstruction, which is printed and (if a file name is given) written
+  //! when the reconstruction thread ends - events slower than SlowEventThreshold (in seconds) are logged individually
+  void SetProfiling(bool Profiling, const MString& FileName = "", double SlowEventThreshold = 0.1);
   
   //! Start all the analysis
   void StartAnalysis();
@@ -169,6 +172,10 @@ class MRealTimeAnalyzer
   double m_TransmissionThreadCpuUsage;
   //! The ID of the last transmitted event 
   unsigned int m_TransmissionThreadLastEventID;
+  //! The number of started transmission threads, used as run ID for the random streams of the noising
+  unsigned int m_TransmissionThreadNRuns;
+  //! The geometry shared by all threads - it is loaded once in StartAnalysis
+  MGeometryRevan* m_Geometry;
   //! The geometry for the transmission thread
   MGeometryRevan* m_TransmissionGeometry;
   
@@ -256,6 +263,13 @@ class MRealTimeAnalyzer
   //! The geometry file name
   MString m_GeometryFileName;
   
+  //! True if the latency profile of the event reconstruction is recorded
+  bool m_Profiling;
+  //! The file to which the latency profile is written
+  MString m_ProfileFileName;
+  //! Events slower than this (in seconds) go into the slow-event log of the profile
+  double m_SlowEventThreshold;
+  
   //! The accumulation time in seconds 
   double m_AccumulationTime;
   //! And a guarding mutex for the accumulation time
@@ -30,6 +30,7 @@
 #include <sstream>
 #include <iomanip>
 #include <iostream>
+#include <deque>
 using namespace std;
 
 // ROOT libs:
@@ -162,10 +163,16 @@ MRealTimeAnalyzer::MRealTimeAnalyzer()
   
   m_GeometryFileName = "$(MEGALIB)/resource/examples/geomega/mpesatellitebaseline/SatelliteWithACS.geo.setup";
   
+  m_Profiling = false;
+  m_ProfileFileName = "";
+  m_SlowEventThreshold = 0.1;
+  
   m_TransmissionThread = nullptr;
   m_IsTransmissionThreadRunning = false;
   m_TransmissionThreadCpuUsage = 0.0;
   m_TransmissionThreadLastEventID = 0;  
+  m_TransmissionThreadNRuns = 0;
+  m_Geometry = nullptr;
   m_TransmissionGeometry = nullptr;
    
   m_CoincidenceThread = nullptr;
@@ -224,6 +231,8 @@ MRealTimeAnalyzer::MRealTimeAnalyzer()
 MRealTimeAnalyzer::~MRealTimeAnalyzer()
 {
   // Delete this instance of MRealTimeAnalyzer
+
+  delete m_Geometry;
 }
 
 
@@ -243,6 +252,19 @@ void MRealTimeAnalyzer::SetAccumulationTime(double AccumulationTime)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void MRealTimeAnalyzer::SetProfiling(bool Profiling, const MString& FileName, double SlowEventThreshold)
+{
+  //! Record a latency profile of the event reconstruction
+
+  m_Profiling = Profiling;
+  m_ProfileFileName = FileName;
+  m_SlowEventThreshold = SlowEventThreshold;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void MRealTimeAnalyzer::SetSettings(MSettingsRealta* Settings) 
 { 
   //! Set all the user definable settings
@@ -276,11 +298,23 @@ void MRealTimeAnalyzer::StartAnalysis()
   m_IsIdentificationThreadRunning = false;
   m_IsCleanUpThreadRunning = false;
   
-  m_TransmissionGeometry = nullptr;
-  m_CoincidenceGeometry = nullptr;
-  m_ReconstructionGeometry = nullptr;
-  m_ImagingGeometry = nullptr;
-  m_IdentificationGeometry = nullptr;
+  // Load the geometry once - all threads share it, since its queries are reentrant
+  // and the noising uses its own trigger unit and random numbers
+  delete m_Geometry;
+  m_Geometry = new MGeometryRevan();
+  if (m_Geometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
+    merr<<"Loading of geometry "<<m_Settings->GetGeometryFileName()<<" failed!"<<show;
+    delete m_Geometry;
+    m_Geometry = nullptr;
+    m_IsInitializing = false;
+    return;
+  }
+  
+  m_TransmissionGeometry = m_Geometry;
+  m_CoincidenceGeometry = m_Geometry;
+  m_ReconstructionGeometry = m_Geometry;
+  m_ImagingGeometry = m_Geometry;
+  m_IdentificationGeometry = m_Geometry;
   
   if (m_TransmissionThread == 0) {
     m_ThreadId++;
@@ -449,25 +483,21 @@ void MRealTimeAnalyzer::StopAnalysis()
   if (m_TransmissionThread != nullptr) m_TransmissionThread->Kill();
   m_TransmissionThread = nullptr;
   m_IsTransmissionThreadRunning = false;
-  delete m_TransmissionGeometry;
   m_TransmissionGeometry = nullptr;
   
   if (m_CoincidenceThread != nullptr) m_CoincidenceThread->Kill();
   m_CoincidenceThread = nullptr;
   m_IsCoincidenceThreadRunning = false;
-  delete m_CoincidenceGeometry;
   m_CoincidenceGeometry = nullptr;
   
   if (m_ReconstructionThread != nullptr) m_ReconstructionThread->Kill();
   m_ReconstructionThread = nullptr;
   m_IsReconstructionThreadRunning = false;
-  delete m_ReconstructionGeometry;
   m_ReconstructionGeometry = nullptr;
   
   if (m_ImagingThread != nullptr) m_ImagingThread->Kill();
   m_ImagingThread = nullptr;
   m_IsImagingThreadRunning = false;
-  delete m_ImagingGeometry;
   m_ImagingGeometry = nullptr;
 
   if (m_HistogrammingThread != nullptr) m_HistogrammingThread->Kill();
@@ -477,13 +507,15 @@ void MRealTimeAnalyzer::StopAnalysis()
   if (m_IdentificationThread != nullptr) m_IdentificationThread->Kill();
   m_IdentificationThread = nullptr;
   m_IsIdentificationThreadRunning = false;
-  delete m_IdentificationGeometry;
   m_IdentificationGeometry = nullptr;
 
   if (m_CleanUpThread != nullptr) m_CleanUpThread->Kill();
   m_CleanUpThread = nullptr;
   m_IsCleanUpThreadRunning = false;
 
+  delete m_Geometry;
+  m_Geometry = nullptr;
+
   m_IsAnalysisRunning = false;
     
   cout<<"All threads stopped safely!"<<endl;
@@ -550,13 +582,8 @@ void MRealTimeAnalyzer::OneTransmissionLoop()
   // To make sure we don't add a fake time if there are events with time'
   bool FoundEventWithTime = false;
 
-  // Load geometry:
-  m_TransmissionGeometry = new MGeometryRevan();
-
-  if (m_TransmissionGeometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
-    cout<<"Loading of geometry "<<m_TransmissionGeometry->GetName()<<" failed!!"<<endl;
-    return;
-  }  
+  // The geometry has been loaded in StartAnalysis
+  if (m_TransmissionGeometry == nullptr) return;
 
     
   MTransceiverTcpIp Transceiver("Realta", m_Settings->GetHostName(), m_Settings->GetPort(), m_Settings->GetTransceiverMode());
@@ -687,6 +714,8 @@ void MRealTimeAnalyzer::OneTransmissionLoop()
               Noising = new MERNoising();
               Noising->SetGeometry(m_TransmissionGeometry);
               Noising->PreAnalysis();
+              // Each run gets its own random streams, thus repeated event IDs are noised independently
+              Noising->SetStreamRunID(++m_TransmissionThreadNRuns);
               cout<<"Activate noising of input events"<<endl;
             } else {
               cout<<"NO noising of input events"<<endl;
@@ -862,13 +891,8 @@ void MRealTimeAnalyzer::OneCoincidenceLoop()
 
   bool DoCoincidence = m_Settings->GetDoCoincidence();
   
-  // Load geometry:
-  m_CoincidenceGeometry = new MGeometryRevan();
-
-  if (m_CoincidenceGeometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
-    cout<<"Loading of geometry "<<m_CoincidenceGeometry->GetName()<<" failed!!"<<endl;
-    return;
-  }  
+  // The geometry has been loaded in StartAnalysis
+  if (m_CoincidenceGeometry == nullptr) return;
 
   // Initialize the raw event analyzer for HEMI:
   MRawEventAnalyzer* RawEventAnalyzer = new MRawEventAnalyzer();
@@ -1031,13 +1055,8 @@ void MRealTimeAnalyzer::OneReconstructionLoop()
   // Do the event reconstruction...
 
 
-  // Load geometry:
-  m_ReconstructionGeometry = new MGeometryRevan();
-
-  if (m_ReconstructionGeometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
-    cout<<"Loading of geometry "<<m_ReconstructionGeometry->GetName()<<" failed!!"<<endl;
-    return;
-  }  
+  // The geometry has been loaded in StartAnalysis
+  if (m_ReconstructionGeometry == nullptr) return;
 
   MFile File;
   bool SaveEvents = false;
@@ -1068,6 +1087,7 @@ void MRealTimeAnalyzer::OneReconstructionLoop()
   MRawEventAnalyzer* RawEventAnalyzer = new MRawEventAnalyzer();
   RawEventAnalyzer->SetGeometry(m_ReconstructionGeometry);
   RawEventAnalyzer->SetSettings(m_Settings);
+  RawEventAnalyzer->SetProfiling(m_Profiling, m_ProfileFileName, m_SlowEventThreshold);
   
   RawEventAnalyzer->SetHitClusteringAlgorithm(MRawEventAnalyzer::c_HitClusteringAlgoNone);
   
@@ -1216,6 +1236,8 @@ void MRealTimeAnalyzer::OneReconstructionLoop()
     File.Close();
   }
   
+  // The analyzer is never post-analyzed, thus write the profile here
+  RawEventAnalyzer->WriteProfile();
   delete RawEventAnalyzer;
   
   m_IsReconstructionThreadRunning = false;
@@ -1230,13 +1252,8 @@ void MRealTimeAnalyzer::OneReconstructionLoop()
 MImagerExternallyManaged* MRealTimeAnalyzer::InitializeImager()
 {
   
-  // Load geometry:
-  m_ImagingGeometry = new MDGeometryQuest();
-
-  if (m_ImagingGeometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
-    cout<<"Loading of geometry "<<m_ImagingGeometry->GetName()<<" failed!!"<<endl;
-    return 0;
-  }  
+  // The geometry has been loaded in StartAnalysis
+  if (m_ImagingGeometry == nullptr) return 0;
 
   MImagerExternallyManaged* Imager = 
     new MImagerExternallyManaged(m_Settings->GetCoordinateSystem());
@@ -1747,12 +1764,8 @@ vector<MQualifiedIsotope> MRealTimeAnalyzer::GetIsotopes()
 
 void MRealTimeAnalyzer::OneIdentificationLoop()
 {
-  // First set up the geometry
-  m_IdentificationGeometry = new MDGeometryQuest();
-  if (m_IdentificationGeometry->ScanSetupFile(m_Settings->GetGeometryFileName(), false) == false) {
-    cout<<"Loading of geometry "<<m_IdentificationGeometry->GetName()<<" failed!!"<<endl;
-    return;
-  }
+  // The geometry has been loaded in StartAnalysis
+  if (m_IdentificationGeometry == nullptr) return;
 
   bool DoIdentification = m_Settings->GetDoIdentification();
 
@@ -1791,6 +1804,17 @@ void MRealTimeAnalyzer::OneIdentificationLoop()
   S.SetIsotopeFileName(m_Settings->GetSpectralIsotopeFileName());
   S.SetEnergyRange(m_Settings->GetSpectralEnergyRange());
 
+  // The spectrum is updated with the events entering and leaving the accumulation window, 
+  // thus only peak regions with significant changes have to be re-evaluated
+  S.UseIncrementalMode(true);
+  
+  // The time and energy of the events in the spectrum - the newest at the front
+  deque<pair<double, double>> Window;
+  double WindowAccumulationTime = -1.0;
+  // The ID of the newest event scanned during the last update
+  bool HasScanned = false;
+  unsigned int LastScannedID = 0;
+
   
   cout<<"Identification thread started..."<<endl<<flush;
   m_IsIdentificationThreadRunning = true;
@@ -1862,30 +1886,47 @@ void MRealTimeAnalyzer::OneIdentificationLoop()
       continue;
     }
 
-    // Reset the spectrum:
-    if (DoIdentification == true) {
+    // Rebuild the spectrum if the accumulation time has changed:
+    if (AccumulationTime != WindowAccumulationTime) {
       S.Reset();
       S.SetSpectrum(1000, Emin, Emax, 2);
+      Window.clear();
+      HasScanned = false;
+      WindowAccumulationTime = AccumulationTime;
     }
 
     list<MRealTimeEvent*>::iterator Event = EventHorizon.base();
     EventHorizonTime = (*EventHorizon)->GetTime().GetAsDouble();
 
-    int NEvents = 0;
+    // Add the events between the event horizon and the newest event of the last update
+    unsigned int FirstScannedID = (Event != m_Events.end()) ? (*Event)->GetID() : LastScannedID;
+    vector<pair<double, double>> NewEvents;
     while (Event != m_Events.end() && EventHorizonTime - (*Event)->GetTime().GetAsDouble() < AccumulationTime) {
+      if (HasScanned == true && (*Event)->GetID() == LastScannedID) break;
       // And fill...
       if ((*Event)->IsCoincident() == true && (*Event)->IsMerged() == false && (*Event)->GetCoincidentRawEvent() != 0) {
-        S.FillSpectrum((*Event)->GetCoincidentRawEvent()->GetEnergy());
-        ++NEvents;
+        double Energy = (*Event)->GetCoincidentRawEvent()->GetEnergy();
+        S.FillSpectrum(Energy);
+        NewEvents.push_back(make_pair((*Event)->GetTime().GetAsDouble(), Energy));
       }
 
       Event++;
     }
+    Window.insert(Window.begin(), NewEvents.begin(), NewEvents.end());
+    if (EventHorizon.base() != m_Events.end()) {
+      LastScannedID = FirstScannedID;
+      HasScanned = true;
+    }
     
+    // Remove the events which have fallen out of the accumulation window
+    while (Window.empty() == false && EventHorizonTime - Window.back().first >= AccumulationTime) {
+      S.RemoveFromSpectrum(Window.back().second);
+      Window.pop_back();
+    }
    
-    // Now update everything:
-    if (Event != m_Events.end()) {
-      m_IdentificationThreadFirstEventID = (*Event)->GetID();
+    // Now update everything -- all events older than the newest scanned one are no longer needed:
+    if (HasScanned == true) {
+      m_IdentificationThreadFirstEventID = LastScannedID;
     } else {
       m_IdentificationThreadFirstEventID = m_Events.back()->GetID();
     }
@@ -28,7 +28,9 @@
 
 // Standard libs:
 #include <iostream>
+#include <sstream>
 #include <csignal>
+#include <cstdlib>
 using namespace std;
 
 // ROOT libs:
@@ -38,6 +40,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MGlobal.h"
 #include "MGUIRealtaMain.h"
+#include "MDRandom.h"
 
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +49,10 @@ using namespace std;
 MGUIRealtaMain* g_Realta = 0;
 int g_NInterruptCatches = 1;
 
+bool g_Profiling = false;
+MString g_ProfileFileName = "";
+double g_SlowEventThreshold = 0.1;
+
 
 //////////////////////////////////////////////////////////////////////////////////
 
@@ -65,10 +72,71 @@ void CatchSignal(int a)
 //////////////////////////////////////////////////////////////////////////////////
 
 
+bool ParseCommandLine(int argc, char** argv)
+{
+  ostringstream Usage;
+  Usage<<endl;
+  Usage<<"  Usage: realta <options>"<<endl;
+  Usage<<endl;
+  Usage<<"         --noise-seed <seed>:"<<endl;
+  Usage<<"             Seed of the random streams used for noising simulated events (default: 0)"<<endl;
+  Usage<<"         --profile <file name>:"<<endl;
+  Usage<<"             Record per-stage latency histograms of the event reconstruction and write them to this file"<<endl;
+  Usage<<"             when the analysis is stopped (CSV, or JSON if the name ends with .json)"<<endl;
+  Usage<<"         --slow-event-threshold <milli-seconds>:"<<endl;
+  Usage<<"             Log all events with a larger reconstruction time in the profile's slow-event log (default: 100 ms)"<<endl;
+  Usage<<"      -h --help:"<<endl;
+  Usage<<"             You know the answer..."<<endl;
+  Usage<<endl;
+
+  string Option;
+  for (int i = 1; i < argc; i++) {
+    Option = argv[i];
+    if (Option == "-h" || Option == "--help" || Option == "?" || Option == "-?") {
+      cout<<Usage.str()<<endl;
+      return false;
+    } else if (Option == "--noise-seed") {
+      if (!((argc > i+1) && argv[i+1][0] != '-')){
+        cout<<"Error: Option "<<Option<<" needs a second argument!"<<endl;
+        cout<<Usage.str()<<endl;
+        return false;
+      }
+      MDRandom::SetStreamSeed(strtoul(argv[++i], nullptr, 10));
+      cout<<"Command-line parser: Use noise seed "<<MDRandom::GetStreamSeed()<<endl;
+    } else if (Option == "--profile" || Option == "--slow-event-threshold") {
+      if (!((argc > i+1) && argv[i+1][0] != '-')){
+        cout<<"Error: Option "<<Option<<" needs a second argument!"<<endl;
+        cout<<Usage.str()<<endl;
+        return false;
+      }
+      g_Profiling = true;
+      if (Option == "--profile") {
+        g_ProfileFileName = argv[++i];
+        cout<<"Command-line parser: Write the latency profile to "<<g_ProfileFileName<<endl;
+      } else {
+        g_SlowEventThreshold = 0.001*atof(argv[++i]);
+        cout<<"Command-line parser: Log events slower than "<<1000*g_SlowEventThreshold<<" ms"<<endl;
+      }
+    } else {
+      cout<<"Error: Unknown option \""<<Option<<"\"!"<<endl;
+      cout<<Usage.str()<<endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////
+
+
 int main(int argc, char** argv)
 {
   // Main function... the beginning...
 
+  if (ParseCommandLine(argc, argv) == false) return 0;
+
   // Setup the interrupt catcher
   signal(SIGINT, CatchSignal);
 
@@ -80,6 +148,7 @@ int main(int argc, char** argv)
 
   // Launch Realta GUI:
   g_Realta = new MGUIRealtaMain();
+  g_Realta->GetAnalyzer()->SetProfiling(g_Profiling, g_ProfileFileName, g_SlowEventThreshold);
   g_Realta->DoControlLoop();
 
   // Start the main event loop... Is this needed since we have our own loop??
@@ -26,6 +26,7 @@ using namespace std;
 #include "MGlobal.h"
 
 // Forward declarations:
+class MResponseMatrix;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,8 +51,12 @@ public:
 protected:
   //! Dump the statistics
   bool Statistics();
-  //! Append files
+  //! Append files - they are read in parallel and added up in a reduction tree
   bool Append();
+  //! Return true if the two responses have the same type and the same axes
+  static bool AreCompatible(MResponseMatrix* A, MResponseMatrix* B);
+  //! Add the content (and the simulated events) of the second response to the first one - they must be compatible
+  static bool AddResponse(MResponseMatrix* To, MResponseMatrix* From);
   //! Show the content of a file
   bool Show();
   //! Collapse a few dimensions
@@ -132,6 +137,8 @@ private:
   bool m_Append;
   //! The file names
   vector<MString> m_AppendFileNames;
+  //! The number of threads used for appending (0: one per core)
+  unsigned int m_NThreads;
 
   // Viewing options
 
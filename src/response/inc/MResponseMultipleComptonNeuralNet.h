@@ -47,6 +47,18 @@ class MResponseMultipleComptonNeuralNet : public MResponseMultipleCompton
   //! Default destructor
   virtual ~MResponseMultipleComptonNeuralNet();
   
+  //! Return a brief description of this response class
+  static MString Description();
+  //! Return information on the parsable options for this response class
+  static MString Options();
+  //! Parse the options
+  virtual bool ParseOptions(const MString& Options);
+  
+  //! Set the number of samples the neural networks learn in one batch
+  void SetBatchSize(unsigned int BatchSize) { m_BatchSize = BatchSize; }
+  //! Set the number of threads the neural networks learn with (0: as many as there are cores)
+  void SetNLearningThreads(unsigned int NThreads) { m_NLearningThreads = NThreads; }
+  
   //! Initialize the response matrices and their generation
   virtual bool Initialize();
   
@@ -134,6 +146,11 @@ class MResponseMultipleComptonNeuralNet : public MResponseMultipleCompton
   bool m_UseComptonScatterAngles;
   bool m_UseDPhiCriterion;
 
+  //! The number of samples the neural networks learn in one batch
+  unsigned int m_BatchSize;
+  //! The number of threads the neural networks learn with (0: as many as there are cores)
+  unsigned int m_NLearningThreads;
+
   //! Desired output value for good
   const double m_GoodValue = 0.1;
   //! Desired output value for bad
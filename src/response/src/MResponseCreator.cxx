@@ -30,6 +30,7 @@
 #include <iostream>
 #include <sstream>
 #include <limits>
+#include <cstdlib>
 using namespace std;
 
 // ROOT libs:
@@ -42,6 +43,7 @@ using namespace std;
 #include "MResponseMultipleComptonBayes.h"
 #include "MResponseMultipleComptonEventFile.h"
 #include "MResponseMultipleComptonLens.h"
+#include "MResponseMultipleComptonNeuralNet.h"
 #include "MResponseMultipleComptonTMVA.h"
 #include "MResponseFirstInteractionPosition.h"
 #include "MResponseSpectral.h"
@@ -58,6 +60,8 @@ using namespace std;
 #include "MResponseEventQualityTMVAEventFile.h"
 #include "MResponseStripPairingTMVAEventFile.h"
 #include "MResponseComptelDataSpace.h"
+#include "MDRandom.h"
+#include "MDGeometry.h"
 #include "MResponseEventClusterizerTMVAEventFile.h"
 #include "MResponseEventClusterizerTMVA.h"
 
@@ -143,6 +147,8 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
   Usage<<"      -b  --mimrec-config   file     use this mimrec configuration file instead of defaults for the imaging response"<<endl;
   Usage<<"      -s  --save            int      save after this amount of entries"<<endl;
   Usage<<"      -z                             gzip the generated files"<<endl;
+  Usage<<"          --no-geometry-cache        do not read or write the cache of the preprocessed geometry setup file"<<endl;
+  Usage<<"          --noise-seed      int      seed of the random streams used for noising the simulated events (default: 0)"<<endl;
   Usage<<"          --test                     Perform a test run. On success, the output will contain the string \">>> TEST RUN SUCCESSFUL <<<\""<<endl;
   Usage<<"          --verbosity       int      Verbosity level"<<endl;
   Usage<<"      -h  --help                     print this help"<<endl;
@@ -164,6 +170,8 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
   Usage<<MResponseMultipleComptonBayes::Options()<<endl;
   Usage<<"      ct : "<<MResponseMultipleComptonTMVA::Description()<<endl;
   Usage<<MResponseMultipleComptonTMVA::Options()<<endl;
+  Usage<<"      cn : "<<MResponseMultipleComptonNeuralNet::Description()<<endl;
+  Usage<<MResponseMultipleComptonNeuralNet::Options()<<endl;
   Usage<<"      cl : compton (Laue lens or collimated)"<<endl;
   Usage<<"      a  : ARM"<<endl;
   Usage<<"      ib : "<<MResponseImagingBinnedMode::Description()<<endl;
@@ -215,7 +223,7 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
         Option == "-i" || Option == "--max-id" ||
         Option == "-c" || Option == "--revan-config" ||
         Option == "-b" || Option == "--mimrec-config" ||
-        Option == "--verbosity" ||
+        Option == "--verbosity" || Option == "--noise-seed" ||
         Option == "-s" || Option == "--save") {
       if (!((argc > i+1) && argv[i+1][0] != '-')){
         cout<<"Error: Option "<<argv[i][1]<<" needs a second argument!"<<endl;
@@ -271,6 +279,9 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
       } else if (SubOption == "ct") {
         m_Mode = c_ModeComptonsTMVA;
         cout<<"Choosing Compton mode (TMVA)"<<endl;
+      } else if (SubOption == "cn") {
+        m_Mode = c_ModeComptonsNeuralNetwork;
+        cout<<"Choosing Compton mode (neural network)"<<endl;
       } else if (SubOption == "cf") {
         m_Mode = c_ModeComptonsEventFile;
         cout<<"Choosing Compton mode (Create events file)"<<endl;
@@ -347,6 +358,12 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
       g_Verbosity = atoi(argv[++i]);
       if (g_Verbosity < 0) g_Verbosity = c_Quiet;
       cout<<"Setting verbosity to "<<g_Verbosity<<endl;
+    } else if (Option == "--no-geometry-cache") {
+      MDGeometry::UseCache(false);
+      cout<<"Not using the geometry cache"<<endl;
+    } else if (Option == "--noise-seed") {
+      MDRandom::SetStreamSeed(strtoul(argv[++i], nullptr, 10));
+      cout<<"Using noise seed "<<MDRandom::GetStreamSeed()<<endl;
     } else if (Option == "--test") {
       m_TestRun = true;
       cout<<"Performing a test run"<<endl;
@@ -517,6 +534,32 @@ bool MResponseCreator::ParseCommandLine(int argc, char** argv)
     while (m_TestRun == false && m_Interrupt == false && Response.Analyze() == true);
     if (Response.Finalize() == false) return false;
     
+  } else if (m_Mode == c_ModeComptonsNeuralNetwork) {
+
+    if (m_RevanCfgFileName == g_StringNotDefined) {
+      cout<<"Error: No revan configuration file name given!"<<endl;
+      cout<<Usage.str()<<endl;
+      return false;
+    }
+
+    MResponseMultipleComptonNeuralNet Response;
+
+    Response.SetDataFileName(m_FileName);
+    Response.SetGeometryFileName(m_GeometryFileName);
+    Response.SetResponseName(m_ResponseName);
+    Response.SetCompression(m_Compress);
+
+    Response.SetMaxNumberOfEvents(m_MaxNEvents);
+    Response.SetSaveAfterNumberOfEvents(m_SaveAfter);
+
+    Response.SetRevanSettingsFileName(m_RevanCfgFileName);
+    Response.SetDoAbsorptions(!m_NoAbsorptions);
+
+    if (Response.ParseOptions(ResponseOptions) == false) return false;
+    if (Response.Initialize() == false) return false;
+    while (m_TestRun == false && m_Interrupt == false && Response.Analyze() == true);
+    if (Response.Finalize() == false) return false;
+
   } else if (m_Mode == c_ModeComptonsLens) {
 
     if (m_RevanCfgFileName == g_StringNotDefined) {
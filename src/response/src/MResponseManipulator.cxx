@@ -33,6 +33,11 @@
 #include <csignal>
 #include <cctype>
 #include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <typeinfo>
 using namespace std;
 
 // ROOT
@@ -91,6 +96,7 @@ MResponseManipulator::MResponseManipulator() : m_Interrupt(false)
   m_Probability = false;
   
   m_Append = false;
+  m_NThreads = 1;
   m_Join = false;
   
   m_Normalized = false;
@@ -181,6 +187,7 @@ bool MResponseManipulator::ParseCommandLine(int argc, char** argv)
   Usage<<endl;
   Usage<<"      Operations on multiple files:"<<endl;
   Usage<<"         -a:   append <long list of file name>"<<endl;
+  Usage<<"         -t:   number of threads used for appending <int> (0: one per core, default: 1)"<<endl;
   Usage<<"         -j:   join <file name prefix>"<<endl;
   Usage<<endl;
   Usage<<"      Modifiers on everything which shows figures:"<<endl;
@@ -208,7 +215,7 @@ bool MResponseManipulator::ParseCommandLine(int argc, char** argv)
 
     // First check if each option has sufficient arguments:
     // Single argument
-    if (Option == "-f" || Option == "-a" || Option  == "-j" || Option == "-e") {
+    if (Option == "-f" || Option == "-a" || Option  == "-j" || Option == "-e" || Option == "-t") {
       if (!((argc > i+1) && (argv[i+1][0] != '-' || isalpha(argv[i+1][1]) == 0))){
         cout<<"Error: Option "<<argv[i][1]<<" needs an argument!"<<endl;
         cout<<Usage.str()<<endl;
@@ -258,6 +265,9 @@ bool MResponseManipulator::ParseCommandLine(int argc, char** argv)
       m_AppendFileNames.push_back(argv[++i]);
       m_Append = true;
       cout<<"Accepting file name for appending: "<<m_AppendFileNames.back()<<endl;
+    } else if (Option == "-t") {
+      m_NThreads = atoi(argv[++i]);
+      cout<<"Accepting number of threads for appending: "<<m_NThreads<<endl;
     } else if (Option == "-d") {
       m_DividendFileName = argv[++i];
       m_DivisorFileName = argv[++i];
@@ -557,6 +567,8 @@ bool MResponseManipulator::Analyze()
  */
 bool MResponseManipulator::Append()
 {
+  MTimer Timer;
+
   MFileResponse File;
   MResponseMatrix* R = File.Read(m_FileName);
   if (R == nullptr) {
@@ -564,77 +576,87 @@ bool MResponseManipulator::Append()
     return false;
   }
 
-  for (unsigned int f = 0; f < m_AppendFileNames.size(); ++f) {
-    MFileResponse AppendFile;
-    MResponseMatrix* RAppend = AppendFile.Read(m_AppendFileNames[f]);
-    if (RAppend == nullptr) {
-      merr<<"Error: Unable to read response file \""<<m_AppendFileNames[f]<<"\" - aborting..."<<endl;
-      return false;
-    }
+  // The files are read concurrently by the worker threads, each adds them up in its own partial sum,
+  // thus at most two responses per thread are in memory. The partial sums are combined in a reduction tree at the end.
+  unsigned int NThreads = m_NThreads;
+  if (NThreads == 0) NThreads = thread::hardware_concurrency();
+  if (NThreads == 0) NThreads = 1;
+  if (NThreads > m_AppendFileNames.size()) NThreads = m_AppendFileNames.size();
+
+  atomic<unsigned int> NextFile(0);
+  atomic<bool> Failed(false);
+  mutex OutputMutex;
+  vector<MResponseMatrix*> Partials(NThreads, nullptr);
+
+  auto Worker = [&](unsigned int ThreadID) {
+    while (m_Interrupt == false && Failed == false) {
+      unsigned int f = NextFile++;
+      if (f >= m_AppendFileNames.size()) break;
+
+      MFileResponse AppendFile;
+      MResponseMatrix* RAppend = AppendFile.Read(m_AppendFileNames[f]);
+      if (RAppend == nullptr) {
+        lock_guard<mutex> Lock(OutputMutex);
+        merr<<"Error: Unable to read response file \""<<m_AppendFileNames[f]<<"\" - aborting..."<<endl;
+        Failed = true;
+        break;
+      }
+      // Verify the compatibility once when the file is read, and not only in the middle of the reduction
+      if (AreCompatible(R, RAppend) == false) {
+        lock_guard<mutex> Lock(OutputMutex);
+        merr<<"Error: The response file \""<<m_AppendFileNames[f]<<"\" has not the same type, order, or axes as \""<<m_FileName<<"\" - aborting..."<<endl;
+        delete RAppend;
+        Failed = true;
+        break;
+      }
 
-    mout<<"Appending: "<<m_AppendFileNames[f]<<endl;
+      {
+        lock_guard<mutex> Lock(OutputMutex);
+        mout<<"Appending: "<<m_AppendFileNames[f]<<endl;
+      }
 
-    if (R->GetOrder() != RAppend->GetOrder()) {
-      mout<<"Cannot append file, because they are of different order!"<<endl;
-    } else {
-      if (R->GetOrder() == 1) {
-        *dynamic_cast<MResponseMatrixO1*>(R) +=
-          *dynamic_cast<MResponseMatrixO1*>(RAppend);
-      } else if (R->GetOrder() == 2) {
-        *dynamic_cast<MResponseMatrixO2*>(R) +=
-          *dynamic_cast<MResponseMatrixO2*>(RAppend);
-      } else if (R->GetOrder() == 3) {
-        *dynamic_cast<MResponseMatrixO3*>(R) +=
-          *dynamic_cast<MResponseMatrixO3*>(RAppend);
-      } else if (R->GetOrder() == 4) {
-        *dynamic_cast<MResponseMatrixO4*>(R) +=
-          *dynamic_cast<MResponseMatrixO4*>(RAppend);
-      } else if (R->GetOrder() == 5) {
-        *dynamic_cast<MResponseMatrixO5*>(R) +=
-          *dynamic_cast<MResponseMatrixO5*>(RAppend);
-      } else if (R->GetOrder() == 6) {
-        *dynamic_cast<MResponseMatrixO6*>(R) +=
-          *dynamic_cast<MResponseMatrixO6*>(RAppend);
-      } else if (R->GetOrder() == 7) {
-        *dynamic_cast<MResponseMatrixO7*>(R) +=
-          *dynamic_cast<MResponseMatrixO7*>(RAppend);
-      } else if (R->GetOrder() == 8) {
-        *dynamic_cast<MResponseMatrixO8*>(R) +=
-          *dynamic_cast<MResponseMatrixO8*>(RAppend);
-      } else if (R->GetOrder() == 9) {
-        *dynamic_cast<MResponseMatrixO9*>(R) +=
-          *dynamic_cast<MResponseMatrixO9*>(RAppend);
-      } else if (R->GetOrder() == 10) {
-        *dynamic_cast<MResponseMatrixO10*>(R) +=
-          *dynamic_cast<MResponseMatrixO10*>(RAppend);
-      } else if (R->GetOrder() == 11) {
-        *dynamic_cast<MResponseMatrixO11*>(R) +=
-          *dynamic_cast<MResponseMatrixO11*>(RAppend);
-      } else if (R->GetOrder() == 12) {
-        *dynamic_cast<MResponseMatrixO12*>(R) +=
-          *dynamic_cast<MResponseMatrixO12*>(RAppend);
-      } else if (R->GetOrder() == 13) {
-        *dynamic_cast<MResponseMatrixO13*>(R) +=
-          *dynamic_cast<MResponseMatrixO13*>(RAppend);
-      } else if (R->GetOrder() == 14) {
-        *dynamic_cast<MResponseMatrixO14*>(R) +=
-          *dynamic_cast<MResponseMatrixO14*>(RAppend);
-      } else if (R->GetOrder() == 15) {
-        *dynamic_cast<MResponseMatrixO15*>(R) +=
-          *dynamic_cast<MResponseMatrixO15*>(RAppend);
-      } else if (R->GetOrder() == 16) {
-        *dynamic_cast<MResponseMatrixO16*>(R) +=
-          *dynamic_cast<MResponseMatrixO16*>(RAppend);
-      } else if (R->GetOrder() == 17) {
-        *dynamic_cast<MResponseMatrixO17*>(R) +=
-          *dynamic_cast<MResponseMatrixO17*>(RAppend);
+      if (Partials[ThreadID] == nullptr) {
+        Partials[ThreadID] = RAppend;
       } else {
-        merr<<"Unsupported matrix order: "<<R->GetOrder()<<endl;
+        AddResponse(Partials[ThreadID], RAppend);
+        delete RAppend;
       }
     }
+  };
 
-    delete RAppend;
+  vector<thread> Threads;
+  for (unsigned int t = 0; t < NThreads; ++t) {
+    Threads.push_back(thread(Worker, t));
   }
+  for (auto& T: Threads) T.join();
+  Threads.clear();
+
+  // Reduction tree: in each level add the partial sum of the second half to the first half in parallel
+  Partials.erase(remove(Partials.begin(), Partials.end(), nullptr), Partials.end());
+  while (Failed == false && Partials.size() > 1) {
+    unsigned int Half = (Partials.size() + 1) / 2;
+    for (unsigned int p = Half; p < Partials.size(); ++p) {
+      Threads.push_back(thread([&Partials, Half, p]() { AddResponse(Partials[p - Half], Partials[p]); }));
+    }
+    for (auto& T: Threads) T.join();
+    Threads.clear();
+    for (unsigned int p = Half; p < Partials.size(); ++p) {
+      delete Partials[p];
+    }
+    Partials.resize(Half);
+  }
+
+  if (Failed == false && m_Interrupt == false && Partials.size() == 1) {
+    AddResponse(R, Partials[0]);
+  }
+  for (auto P: Partials) delete P;
+
+  if (Failed == true || m_Interrupt == true) {
+    delete R;
+    return false;
+  }
+
+  mout<<"Appended "<<m_AppendFileNames.size()<<" files with "<<NThreads<<" threads in "<<Timer.GetElapsed()<<" seconds"<<endl;
 
   R->Write((m_FileName + ".new"), true);
   delete R;
@@ -643,6 +665,109 @@ bool MResponseManipulator::Append()
 }
 
 
+/******************************************************************************
+ * Return true if the two responses have the same type and the same axes
+ */
+bool MResponseManipulator::AreCompatible(MResponseMatrix* A, MResponseMatrix* B)
+{
+  if (A->GetOrder() != B->GetOrder()) return false;
+  if (typeid(*A) != typeid(*B)) return false;
+
+  if (dynamic_cast<MResponseMatrixON*>(A) != nullptr) {
+    return *dynamic_cast<MResponseMatrixON*>(A) == *dynamic_cast<MResponseMatrixON*>(B);
+  } else if (A->GetOrder() == 1) {
+    return *dynamic_cast<MResponseMatrixO1*>(A) == *dynamic_cast<MResponseMatrixO1*>(B);
+  } else if (A->GetOrder() == 2) {
+    return *dynamic_cast<MResponseMatrixO2*>(A) == *dynamic_cast<MResponseMatrixO2*>(B);
+  } else if (A->GetOrder() == 3) {
+    return *dynamic_cast<MResponseMatrixO3*>(A) == *dynamic_cast<MResponseMatrixO3*>(B);
+  } else if (A->GetOrder() == 4) {
+    return *dynamic_cast<MResponseMatrixO4*>(A) == *dynamic_cast<MResponseMatrixO4*>(B);
+  } else if (A->GetOrder() == 5) {
+    return *dynamic_cast<MResponseMatrixO5*>(A) == *dynamic_cast<MResponseMatrixO5*>(B);
+  } else if (A->GetOrder() == 6) {
+    return *dynamic_cast<MResponseMatrixO6*>(A) == *dynamic_cast<MResponseMatrixO6*>(B);
+  } else if (A->GetOrder() == 7) {
+    return *dynamic_cast<MResponseMatrixO7*>(A) == *dynamic_cast<MResponseMatrixO7*>(B);
+  } else if (A->GetOrder() == 8) {
+    return *dynamic_cast<MResponseMatrixO8*>(A) == *dynamic_cast<MResponseMatrixO8*>(B);
+  } else if (A->GetOrder() == 9) {
+    return *dynamic_cast<MResponseMatrixO9*>(A) == *dynamic_cast<MResponseMatrixO9*>(B);
+  } else if (A->GetOrder() == 10) {
+    return *dynamic_cast<MResponseMatrixO10*>(A) == *dynamic_cast<MResponseMatrixO10*>(B);
+  } else if (A->GetOrder() == 11) {
+    return *dynamic_cast<MResponseMatrixO11*>(A) == *dynamic_cast<MResponseMatrixO11*>(B);
+  } else if (A->GetOrder() == 12) {
+    return *dynamic_cast<MResponseMatrixO12*>(A) == *dynamic_cast<MResponseMatrixO12*>(B);
+  } else if (A->GetOrder() == 13) {
+    return *dynamic_cast<MResponseMatrixO13*>(A) == *dynamic_cast<MResponseMatrixO13*>(B);
+  } else if (A->GetOrder() == 14) {
+    return *dynamic_cast<MResponseMatrixO14*>(A) == *dynamic_cast<MResponseMatrixO14*>(B);
+  } else if (A->GetOrder() == 15) {
+    return *dynamic_cast<MResponseMatrixO15*>(A) == *dynamic_cast<MResponseMatrixO15*>(B);
+  } else if (A->GetOrder() == 16) {
+    return *dynamic_cast<MResponseMatrixO16*>(A) == *dynamic_cast<MResponseMatrixO16*>(B);
+  } else if (A->GetOrder() == 17) {
+    return *dynamic_cast<MResponseMatrixO17*>(A) == *dynamic_cast<MResponseMatrixO17*>(B);
+  }
+
+  return false;
+}
+
+
+/******************************************************************************
+ * Add the content of the second response to the first one - they must be compatible
+ */
+bool MResponseManipulator::AddResponse(MResponseMatrix* To, MResponseMatrix* From)
+{
+  if (dynamic_cast<MResponseMatrixON*>(To) != nullptr) {
+    *dynamic_cast<MResponseMatrixON*>(To) += *dynamic_cast<MResponseMatrixON*>(From);
+  } else if (To->GetOrder() == 1) {
+    *dynamic_cast<MResponseMatrixO1*>(To) += *dynamic_cast<MResponseMatrixO1*>(From);
+  } else if (To->GetOrder() == 2) {
+    *dynamic_cast<MResponseMatrixO2*>(To) += *dynamic_cast<MResponseMatrixO2*>(From);
+  } else if (To->GetOrder() == 3) {
+    *dynamic_cast<MResponseMatrixO3*>(To) += *dynamic_cast<MResponseMatrixO3*>(From);
+  } else if (To->GetOrder() == 4) {
+    *dynamic_cast<MResponseMatrixO4*>(To) += *dynamic_cast<MResponseMatrixO4*>(From);
+  } else if (To->GetOrder() == 5) {
+    *dynamic_cast<MResponseMatrixO5*>(To) += *dynamic_cast<MResponseMatrixO5*>(From);
+  } else if (To->GetOrder() == 6) {
+    *dynamic_cast<MResponseMatrixO6*>(To) += *dynamic_cast<MResponseMatrixO6*>(From);
+  } else if (To->GetOrder() == 7) {
+    *dynamic_cast<MResponseMatrixO7*>(To) += *dynamic_cast<MResponseMatrixO7*>(From);
+  } else if (To->GetOrder() == 8) {
+    *dynamic_cast<MResponseMatrixO8*>(To) += *dynamic_cast<MResponseMatrixO8*>(From);
+  } else if (To->GetOrder() == 9) {
+    *dynamic_cast<MResponseMatrixO9*>(To) += *dynamic_cast<MResponseMatrixO9*>(From);
+  } else if (To->GetOrder() == 10) {
+    *dynamic_cast<MResponseMatrixO10*>(To) += *dynamic_cast<MResponseMatrixO10*>(From);
+  } else if (To->GetOrder() == 11) {
+    *dynamic_cast<MResponseMatrixO11*>(To) += *dynamic_cast<MResponseMatrixO11*>(From);
+  } else if (To->GetOrder() == 12) {
+    *dynamic_cast<MResponseMatrixO12*>(To) += *dynamic_cast<MResponseMatrixO12*>(From);
+  } else if (To->GetOrder() == 13) {
+    *dynamic_cast<MResponseMatrixO13*>(To) += *dynamic_cast<MResponseMatrixO13*>(From);
+  } else if (To->GetOrder() == 14) {
+    *dynamic_cast<MResponseMatrixO14*>(To) += *dynamic_cast<MResponseMatrixO14*>(From);
+  } else if (To->GetOrder() == 15) {
+    *dynamic_cast<MResponseMatrixO15*>(To) += *dynamic_cast<MResponseMatrixO15*>(From);
+  } else if (To->GetOrder() == 16) {
+    *dynamic_cast<MResponseMatrixO16*>(To) += *dynamic_cast<MResponseMatrixO16*>(From);
+  } else if (To->GetOrder() == 17) {
+    *dynamic_cast<MResponseMatrixO17*>(To) += *dynamic_cast<MResponseMatrixO17*>(From);
+  } else {
+    merr<<"Unsupported matrix order: "<<To->GetOrder()<<endl;
+    return false;
+  }
+
+  // Add up the simulated events
+  To->SetSimulatedEvents(To->GetSimulatedEvents() + From->GetSimulatedEvents());
+
+  return true;
+}
+
+
 /******************************************************************************
  * Find and join *.rsp files:
  */
@@ -718,67 +843,9 @@ bool MResponseManipulator::JoinRSPFiles(MString Prefix, vector<MString> Types)
         mout<<"Cannot append file, because they are of different order!"<<endl;
       } else {
         mout<<"Appending file "<<f<<"/"<<SortedFiles[t].size()-1<<": "<<SortedFiles[t][f]<<endl;
-        if (dynamic_cast<MResponseMatrixON*>(First) != nullptr) {
-          MTimer AppendTimer;
-          *dynamic_cast<MResponseMatrixON*>(First) += *dynamic_cast<MResponseMatrixON*>(Append);
-          mout<<" --> Done in "<<AppendTimer.GetElapsed()<<" seconds"<<endl;
-        } else if (First->GetOrder() == 1) {
-          *dynamic_cast<MResponseMatrixO1*>(First) +=
-          *dynamic_cast<MResponseMatrixO1*>(Append);
-        } else if (First->GetOrder() == 2) {
-          *dynamic_cast<MResponseMatrixO2*>(First) +=
-          *dynamic_cast<MResponseMatrixO2*>(Append);
-        } else if (First->GetOrder() == 3) {
-          *dynamic_cast<MResponseMatrixO3*>(First) +=
-          *dynamic_cast<MResponseMatrixO3*>(Append);
-        } else if (First->GetOrder() == 4) {
-          *dynamic_cast<MResponseMatrixO4*>(First) +=
-          *dynamic_cast<MResponseMatrixO4*>(Append);
-        } else if (First->GetOrder() == 5) {
-          *dynamic_cast<MResponseMatrixO5*>(First) +=
-          *dynamic_cast<MResponseMatrixO5*>(Append);
-        } else if (First->GetOrder() == 6) {
-          *dynamic_cast<MResponseMatrixO6*>(First) +=
-          *dynamic_cast<MResponseMatrixO6*>(Append);
-        } else if (First->GetOrder() == 7) {
-          *dynamic_cast<MResponseMatrixO7*>(First) +=
-          *dynamic_cast<MResponseMatrixO7*>(Append);
-        } else if (First->GetOrder() == 8) {
-          *dynamic_cast<MResponseMatrixO8*>(First) +=
-          *dynamic_cast<MResponseMatrixO8*>(Append);
-        } else if (First->GetOrder() == 9) {
-          *dynamic_cast<MResponseMatrixO9*>(First) +=
-          *dynamic_cast<MResponseMatrixO9*>(Append);
-        } else if (First->GetOrder() == 10) {
-          *dynamic_cast<MResponseMatrixO10*>(First) +=
-          *dynamic_cast<MResponseMatrixO10*>(Append);
-        } else if (First->GetOrder() == 11) {
-          *dynamic_cast<MResponseMatrixO11*>(First) +=
-          *dynamic_cast<MResponseMatrixO11*>(Append);
-        } else if (First->GetOrder() == 12) {
-          *dynamic_cast<MResponseMatrixO12*>(First) +=
-          *dynamic_cast<MResponseMatrixO12*>(Append);
-        } else if (First->GetOrder() == 13) {
-          *dynamic_cast<MResponseMatrixO13*>(First) +=
-          *dynamic_cast<MResponseMatrixO13*>(Append);
-        } else if (First->GetOrder() == 14) {
-          *dynamic_cast<MResponseMatrixO14*>(First) +=
-          *dynamic_cast<MResponseMatrixO14*>(Append);
-        } else if (First->GetOrder() == 15) {
-          *dynamic_cast<MResponseMatrixO15*>(First) +=
-          *dynamic_cast<MResponseMatrixO15*>(Append);
-        } else if (First->GetOrder() == 16) {
-          *dynamic_cast<MResponseMatrixO16*>(First) +=
-          *dynamic_cast<MResponseMatrixO16*>(Append);
-        } else if (First->GetOrder() == 17) {
-          *dynamic_cast<MResponseMatrixO17*>(First) +=
-          *dynamic_cast<MResponseMatrixO17*>(Append);
-        } else {
-          merr<<"Unsupported matrix order: "<<First->GetOrder()<<endl;
-        }
-        
-        // Add up the simulated events
-        First->SetSimulatedEvents(First->GetSimulatedEvents() + Append->GetSimulatedEvents());
+        MTimer AppendTimer;
+        AddResponse(First, Append);
+        mout<<" --> Done in "<<AppendTimer.GetElapsed()<<" seconds"<<endl;
       }
             
       delete Append;
@@ -30,6 +30,7 @@
 #include <limits>
 #include <algorithm>
 #include <vector>
+#include <sstream>
 using namespace std;
 
 // ROOT libs:
@@ -93,6 +94,9 @@ MResponseMultipleComptonNeuralNet::MResponseMultipleComptonNeuralNet()
   m_UseComptonScatterAngles = true;
   m_UseDPhiCriterion = true;
   
+  m_BatchSize = 32;
+  m_NLearningThreads = 0;
+  
   //   m_UseRawData = false;
   //   m_UseDistances = false;
   //   m_UseInteractionProbabilities = false;
@@ -114,6 +118,92 @@ MResponseMultipleComptonNeuralNet::~MResponseMultipleComptonNeuralNet()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+//! Return a brief description of this response class
+MString MResponseMultipleComptonNeuralNet::Description()
+{
+  return MString("Compton event reconstruction (neural network)");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Return information on the parsable options for this response class
+MString MResponseMultipleComptonNeuralNet::Options()
+{
+  ostringstream out;
+  out<<"             batchsize:             the number of events the neural networks learn in one batch (default: 32)"<<endl;
+  out<<"             threads:               the number of threads used for learning, 0 for all cores (default: 0)"<<endl;
+
+  return MString(out);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Parse the options
+bool MResponseMultipleComptonNeuralNet::ParseOptions(const MString& Options)
+{
+  // Split the different options
+  vector<MString> Split1 = Options.Tokenize(":");
+  // Split Option <-> Value
+  vector<vector<MString>> Split2;
+  for (MString S: Split1) {
+    Split2.push_back(S.Tokenize("="));
+  }
+
+  // Basic sanity check and to lower for all options
+  for (unsigned int i = 0; i < Split2.size(); ++i) {
+    if (Split2[i].size() == 0) {
+      mout<<"Error: Empty option in string "<<Options<<endl;
+      return false;
+    }
+    if (Split2[i].size() == 1) {
+      mout<<"Error: Option has no value: "<<Split2[i][0]<<endl;
+      return false;
+    }
+    if (Split2[i].size() > 2) {
+      mout<<"Error: Option has more than one value or you used the wrong separator (not \":\"): "<<Split1[i]<<endl;
+      return false;
+    }
+    Split2[i][0].ToLowerInPlace();
+  }
+
+  // Parse
+  for (unsigned int i = 0; i < Split2.size(); ++i) {
+    string Value = Split2[i][1].Data();
+
+    if (Split2[i][0] == "batchsize") {
+      m_BatchSize = stoi(Value);
+    } else if (Split2[i][0] == "threads") {
+      m_NLearningThreads = stoi(Value);
+    } else {
+      mout<<"Error: Unrecognized option "<<Split2[i][0]<<endl;
+      return false;
+    }
+  }
+
+  // Sanity checks:
+  if (m_BatchSize == 0) {
+    mout<<"Error: The batch size must be at least 1"<<endl;
+    return false;
+  }
+
+  // Dump it for user info
+  mout<<endl;
+  mout<<"Choosen options for the neural network Compton response:"<<endl;
+  mout<<"  Batch size:                                         "<<m_BatchSize<<endl;
+  mout<<"  Learning threads:                                   "<<m_NLearningThreads<<endl;
+  mout<<endl;
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 //! Initialize the response matrices and their generation
 bool MResponseMultipleComptonNeuralNet::Initialize() 
 { 
@@ -1141,6 +1231,8 @@ void MResponseMultipleComptonNeuralNet::Teach()
       cout<<" + size quality store: "<<m_QualityNNIOStore[e][s].Size()<<endl;
       
       // Loop A-1: Learn Sequence 
+      // The performance is evaluated with the network of the previous epoch, then all training data is learned in batches
+      vector<MNeuralNetworkIO> SequenceTraining;
       for (unsigned int io = 0; io < m_SequenceNNIOStore[e][s].Size(); ++io) {
         
         // Get and check input:
@@ -1178,10 +1270,8 @@ void MResponseMultipleComptonNeuralNet::Teach()
           SequenceBad[e][s]++;
         }
       
-        // ... prepare for learning ...
-        m_SequenceNNs[e][s].SetOutputError(SequenceIOStore);
-        // ... and learn ...
-        m_SequenceNNs[e][s].Learn();
+        // ... and keep for learning
+        SequenceTraining.push_back(SequenceIOStore);
       
         // Dump some text:
         if (VerboseLevel > 0) {
@@ -1197,6 +1287,8 @@ void MResponseMultipleComptonNeuralNet::Teach()
       
         if (m_Interrupt == true) break;
       } // sequenced IO loop for learning
+      
+      m_SequenceNNs[e][s].LearnBatches(SequenceTraining, m_BatchSize, m_NLearningThreads);
            
       
       
@@ -1225,6 +1317,7 @@ void MResponseMultipleComptonNeuralNet::Teach()
       }
       
       // Now do the learning
+      vector<MNeuralNetworkIO> QualityTraining;
       for (unsigned int io = 0; io < m_QualityNNIOStore[e][s].Size(); ++io) {
         
         // Get and check input:
@@ -1266,10 +1359,8 @@ void MResponseMultipleComptonNeuralNet::Teach()
           QualityBad[e][s]++;
         }
       
-        // ... prepare for learning ...
-        m_QualityNNs[e][s].SetOutputError(IO);
-        // ... and learn ...
-        m_QualityNNs[e][s].Learn();
+        // ... and keep for learning
+        QualityTraining.push_back(IO);
       
         // Dump some text:
         if (VerboseLevel > 0) {
@@ -1285,6 +1376,8 @@ void MResponseMultipleComptonNeuralNet::Teach()
       
         if (m_Interrupt == true) break;
       } // sequenced IO loop for learning
+      
+      m_QualityNNs[e][s].LearnBatches(QualityTraining, m_BatchSize, m_NLearningThreads);
            
            
       // -------
@@ -40,6 +40,7 @@ using namespace std;
 #include "MStreams.h"
 #include "MSystem.h"
 #include "MRESEIterator.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -323,9 +324,14 @@ bool MResponseStripPairingTMVAEventFile::Analyze()
   
   
   // (3) Noise & thresholds
+  // The run ID distinguishes the input files and the blocks of restarted event IDs in concatenated files
+  unsigned int StreamRunID = MDRandom::GetStreamRunID(m_DataFileName) + m_SivanLevel;
   m_ReGeometry->ActivateNoising(true);
   for (unsigned int s1 = 0; s1 < VolumeTree.size(); ++s1) {
     if (Ignore[s1] == true) continue;
+
+    // Each strip has its own random stream, thus the noise does not depend on the thread
+    MDRandom::SetStream(m_SiEvent->GetID(), s1, StreamRunID);
    
     MVector Pos = StripVolumeSequences[s1]->GetPositionInDetector();
     double Energy = StripEnergy[s1];
@@ -338,6 +344,7 @@ bool MResponseStripPairingTMVAEventFile::Analyze()
     StripEnergy[s1] = Energy;
     if (Energy == 0) Ignore[s1] = true;
   }
+  MDRandom::ClearStream();
   m_ReGeometry->ActivateNoising(false);
 
   
@@ -113,6 +113,9 @@ class MERCSR : public MERConstruction
   /// An iterator over the sorted list of quality factors
   map<double, vector<MRESE*>, less_equal<double> >::iterator m_QualityFactorsIterator;
 
+  /// Storage for the path lengths per material of one ray
+  vector<double> m_PathLengths;
+
 
 #ifdef ___CLING___
  public:
@@ -114,6 +114,15 @@ class MERCSRDataSet
   vector<Float_t> m_StoreAbsorptionProbabilityToFirstIAMaximum;
   //! The minimum column density to first IA
   vector<Float_t> m_StoreAbsorptionProbabilityToFirstIAMinimum;
+
+  //! The start positions of the absorption rays of one sequence
+  vector<MVector> m_RayStarts;
+  //! The stop positions of the absorption rays of one sequence
+  vector<MVector> m_RayStops;
+  //! The energies of the absorption rays of one sequence
+  vector<double> m_RayEnergies;
+  //! The absorption probabilities of the rays of one sequence
+  vector<double> m_RayProbabilities;
   //! The Zenith angle
   vector<Float_t> m_StoreZenithAngle;
   //! The Nadir angle
@@ -26,6 +26,7 @@
 #include "MRawEventIncarnations.h"
 
 // Forward declarations:
+class MDTriggerUnit;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -48,6 +49,12 @@ class MERNoising : public MERConstruction
 
   //! Add the statistics of the given MERNoising to this one
   void AddStatistics(MERNoising* Noising);
+
+  //! Set the run ID of the random streams, e.g. MDRandom::GetStreamRunID(<input file name>),
+  //! thus files with the same event IDs are noised independently
+  void SetStreamRunID(unsigned int RunID) { m_StreamRunID = RunID; }
+  //! Return the run ID of the random streams
+  unsigned int GetStreamRunID() const { return m_StreamRunID; }
   
   //! Return the number
   long GetNTriggeredEvents() const { return m_NTriggeredEvents; }
@@ -96,6 +103,12 @@ class MERNoising : public MERConstruction
 
   //! The number of events which have not triggered
   long m_NNotTriggeredOrVetoedEvents;
+
+  //! The run ID of the random streams
+  unsigned int m_StreamRunID;
+
+  //! Our own copy of the geometry's trigger unit, thus several noisings can share one geometry
+  MDTriggerUnit* m_TriggerUnit;
   
 
 #ifdef ___CLING___
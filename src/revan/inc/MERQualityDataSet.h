@@ -128,6 +128,15 @@ class MERQualityDataSet
   bool m_UsePathToFirstIA;
   //! The number of samples along the path
   unsigned int m_NumberOfPathSamples;
+
+  //! The start positions of the absorption rays of one sequence
+  vector<MVector> m_RayStarts;
+  //! The stop positions of the absorption rays of one sequence
+  vector<MVector> m_RayStops;
+  //! The energies of the absorption rays of one sequence
+  vector<double> m_RayEnergies;
+  //! The absorption probabilities of the rays of one sequence
+  vector<double> m_RayProbabilities;
   
   
 #ifdef ___CLING___
@@ -88,6 +88,10 @@ class MFileEventsEvta : public MFileEvents
   
   //! The ER responsible for noising the data
   MERNoising* m_Noising;
+  //! The run ID of the random streams of the currently read file
+  unsigned int m_FileStreamRunID;
+  //! The run ID of the random streams of the file in which the current event started
+  unsigned int m_EventStreamRunID;
   
   static const long c_NoId;
 
@@ -124,6 +124,13 @@ class MInterfaceRevan : public MInterface
   //! Default output file name
   MString m_OutputFilenName;
 
+  //! True if the event reconstruction is profiled
+  bool m_Profiling;
+  //! The file name of the latency profile
+  MString m_ProfileFileName;
+  //! The threshold in seconds above which events are logged as slow in the profile
+  double m_SlowEventThreshold;
+
 #ifdef ___CLING___
  public:
   ClassDef(MInterfaceRevan, 0) // interface to the Revan-part of MEGAlib
@@ -27,6 +27,7 @@
 #include "MDDetector.h"
 #include "MDVolumeSequence.h"
 #include "MPhysicalEventHit.h"
+#include "MRESEPool.h"
 
 // Forward declarations:
 
@@ -47,6 +48,11 @@ class MRESE
   //! If you want this behaviour, call DeleteAll() before calling delete
   virtual ~MRESE();
 
+  //! All RESEs (hits, clusters, tracks, raw events) are allocated from the RESE pool
+  static void* operator new(size_t Size) { return MRESEPool::Allocate(Size); }
+  //! All RESEs (hits, clusters, tracks, raw events) are released to the RESE pool
+  static void operator delete(void* Pointer) { MRESEPool::Release(Pointer); }
+
   static void ResetIDCounter();
 
   bool operator==(MRESE& RESE);
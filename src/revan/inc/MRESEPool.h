@@ -0,0 +1,129 @@
+/*
+ * MRESEPool.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MRESEPool__
+#define __MRESEPool__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! The memory pool for the RESEs (hits, clusters, tracks, raw events) of the event reconstruction:
+//! During the reconstruction of one event many incarnations of the raw event are created and deleted again.
+//! Instead of going through malloc/free for each of them, the RESEs are carved out of large chunks owned
+//! by a pool per thread, and deleted RESEs are kept in free lists per size class for the next ones.
+//! The chunks are never given back, thus the memory stays at the maximum needed by one event (or coincidence window).
+//! A RESE deleted by another thread is handed back to its owning pool via a lock-free list.
+class MRESEPool
+{
+  // public interface:
+ public:
+  //! Allocate memory for a RESE of the given size
+  static void* Allocate(size_t Size);
+  //! Give back the memory of a RESE
+  static void Release(void* Pointer);
+
+  //! Switch the pool on or off - when off, the standard allocator is used (e.g. for comparisons)
+  //! This can be done at any time, since each block remembers where it comes from
+  static void SetEnabled(bool Enabled) { s_Enabled = Enabled; }
+  //! Return true if the pool is used
+  static bool IsEnabled() { return s_Enabled; }
+
+  // protected methods:
+ protected:
+  //! Only created on demand, one per thread
+  MRESEPool();
+  //! Never deleted, since other threads might still hold RESEs from it
+  virtual ~MRESEPool() {}
+
+  //! Return the pool of this thread
+  static MRESEPool* GetThreadPool();
+
+  //! Allocate a block of the given size class
+  void* AllocateBlock(unsigned int SizeClass);
+  //! Put a block back into the free list
+  void ReleaseBlock(void* Block);
+  //! Move the blocks released by other threads into the free lists
+  void CollectRemoteBlocks();
+
+  // private methods:
+ private:
+
+
+  // protected members:
+ protected:
+  //! The header in front of each RESE - 16 bytes to keep the alignment
+  struct MBlockHeader {
+    //! The owning pool, or nullptr if the memory comes from the standard allocator
+    MRESEPool* m_Owner;
+    //! The size class
+    uint32_t m_SizeClass;
+    //! Padding
+    uint32_t m_Padding;
+  };
+  //! A released block, the link is stored in the (no longer used) memory of the RESE
+  struct MFreeBlock {
+    MFreeBlock* m_Next;
+  };
+
+  //! The granularity of the size classes in bytes
+  static const unsigned int c_Granularity = 64;
+  //! The number of size classes - larger objects use the standard allocator
+  static const unsigned int c_NSizeClasses = 64;
+  //! The size of one chunk in bytes
+  static const unsigned int c_ChunkSize = 1 << 20;
+
+  // private members:
+ private:
+  //! True if the pool is used
+  static atomic<bool> s_Enabled;
+
+  //! The free lists per size class
+  MFreeBlock* m_FreeLists[c_NSizeClasses];
+  //! The blocks released by other threads
+  atomic<MFreeBlock*> m_RemoteFreeList;
+  //! The current position in the current chunk
+  char* m_ChunkPosition;
+  //! The end of the current chunk
+  char* m_ChunkEnd;
+  //! All chunks
+  vector<char*> m_Chunks;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MRESEPool, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
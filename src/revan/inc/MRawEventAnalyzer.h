@@ -26,6 +26,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MGlobal.h"
 #include "MRERawEvent.h"
+#include "MRawEventAnalyzerProfile.h"
 #include "MRawEventIncarnations.h"
 #include "MRawEventIncarnationList.h"
 #include "MGeometryRevan.h"
@@ -138,6 +139,15 @@ class MRawEventAnalyzer
   //! If multiple raw event analyzer have been started, e.g. for multi threading, the analysis statistics can be joinded with this function
   void JoinStatistics(const MRawEventAnalyzer& A);
 
+  //! Record the time of each stage of each event in a latency profile, which is printed and (if a file name is given) written in PostAnalysis
+  //! Events slower than SlowEventThreshold (in seconds) are logged individually
+  void SetProfiling(bool Profiling, const MString& FileName = "", double SlowEventThreshold = 0.1);
+  //! Return the latency profile
+  const MRawEventAnalyzerProfile& GetProfile() const { return m_Profile; }
+  //! Print the latency profile and write it to the file given in SetProfiling - done in PostAnalysis,
+  //! analyzers which are never post-analyzed (e.g. in realta) have to call it themselves
+  void WriteProfile() const;
+
   
   // Interface for the basic reconstruction algorithms
   
@@ -472,6 +482,15 @@ class MRawEventAnalyzer
   double m_TimeCSR;
   double m_TimeFinalize;
 
+  //! True if the per-event latency profile is recorded
+  bool m_UseProfile;
+  //! The file to which the latency profile is written
+  MString m_ProfileFileName;
+  //! The latency profile
+  MRawEventAnalyzerProfile m_Profile;
+  //! The stage times of the current event
+  vector<double> m_StageTimes;
+
   bool m_IsBatch;
 
 #ifdef ___CLING___
@@ -0,0 +1,175 @@
+/*
+ * MRawEventAnalyzerProfile.h
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ * Please see the source-file for the copyright-notice.
+ *
+ */
+
+
+#ifndef __MRawEventAnalyzerProfile__
+#define __MRawEventAnalyzerProfile__
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Standard libs:
+#include <vector>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MGlobal.h"
+#include "MString.h"
+
+// Forward declarations:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+//! Per-event timing profile of the event reconstruction:
+//! The time spent in each stage of every event is filled into logarithmic latency histograms,
+//! which are split by hit multiplicity and by the type of the reconstructed event.
+//! Events slower than a threshold are stored in a slow-event log with all their stage times.
+//! Profiles of several analyzers (threads) can be joined, and the result written as CSV or JSON.
+class MRawEventAnalyzerProfile
+{
+  // public interface:
+ public:
+  //! Default constructor
+  MRawEventAnalyzerProfile();
+  //! Default destuctor
+  virtual ~MRawEventAnalyzerProfile();
+
+  //! Reset all data
+  void Clear();
+
+  //! Set the threshold in seconds above which an event is logged as slow (default: 0.1 sec)
+  void SetSlowEventThreshold(double Threshold) { m_SlowEventThreshold = Threshold; }
+  //! Return the threshold in seconds above which an event is logged as slow
+  double GetSlowEventThreshold() const { return m_SlowEventThreshold; }
+
+  //! Add one event: the stage times (in seconds) must have c_NStages entries, the total is calculated here
+  void Add(long EventID, unsigned int NHits, int EventType, const vector<double>& StageTimes);
+  //! Add the data of another profile, e.g. of another thread
+  void Join(const MRawEventAnalyzerProfile& Profile);
+
+  //! Return the number of profiled events
+  unsigned long GetNEvents() const { return m_NEvents; }
+
+  //! Return a summary: events, mean, median, 99% and maximum latency per stage
+  MString ToString() const;
+  //! Write the profile - the format is selected by the suffix: ".json" or CSV otherwise
+  //! For CSV the slow events are written into a second file with the suffix ".slowevents.csv"
+  bool Write(const MString& FileName) const;
+
+  //! Return the name of a stage
+  static MString GetStageName(unsigned int Stage);
+
+  //! The stages of the event reconstruction
+  static const unsigned int c_StageLoad = 0;
+  static const unsigned int c_StageCoincidence = 1;
+  static const unsigned int c_StageEventClustering = 2;
+  static const unsigned int c_StageHitClustering = 3;
+  static const unsigned int c_StageTracking = 4;
+  static const unsigned int c_StageCSR = 5;
+  static const unsigned int c_StageDecay = 6;
+  static const unsigned int c_StageFinalize = 7;
+  static const unsigned int c_StageTotal = 8;
+  //! The number of stages including the total
+  static const unsigned int c_NStages = 9;
+
+  // protected methods:
+ protected:
+  //! Return the multiplicity class of the number of hits
+  static unsigned int GetMultiplicityClass(unsigned int NHits);
+  //! Return the name of a multiplicity class
+  static MString GetMultiplicityClassName(unsigned int Class);
+  //! Return the type class of the event type (MPhysicalEvent types, or not reconstructed)
+  static unsigned int GetTypeClass(int EventType);
+  //! Return the name of a type class
+  static MString GetTypeClassName(unsigned int Class);
+  //! Return the histogram bin of the time
+  static unsigned int GetBin(double Time);
+  //! Return the lower edge of a bin in seconds
+  static double GetBinLowEdge(unsigned int Bin);
+  //! Return the index of the histogram
+  static unsigned int GetIndex(unsigned int Stage, unsigned int MultiplicityClass, unsigned int TypeClass) {
+    return (Stage*c_NMultiplicityClasses + MultiplicityClass)*c_NTypeClasses + TypeClass;
+  }
+  //! Return the quantile (0..1) of the latency of a stage summed over all multiplicities and types
+  double GetQuantile(unsigned int Stage, double Quantile) const;
+
+  //! Write as CSV
+  bool WriteCSV(const MString& FileName) const;
+  //! Write as JSON
+  bool WriteJSON(const MString& FileName) const;
+
+  // private methods:
+ private:
+
+
+  // protected members:
+ protected:
+  //! The number of multiplicity classes
+  static const unsigned int c_NMultiplicityClasses = 9;
+  //! The number of event type classes
+  static const unsigned int c_NTypeClasses = 9;
+  //! Histogram: the lowest time (1 microsecond) as power of ten
+  static const int c_MinimumDecade = -6;
+  //! Histogram: the number of decades (up to 1000 seconds)
+  static const unsigned int c_NDecades = 9;
+  //! Histogram: the number of bins per decade
+  static const unsigned int c_BinsPerDecade = 10;
+  //! Histogram: the number of bins including under- and overflow
+  static const unsigned int c_NBins = c_NDecades*c_BinsPerDecade + 2;
+  //! The maximum number of entries in the slow-event log
+  static const unsigned int c_MaximumSlowEvents = 100000;
+
+  //! One entry of the slow-event log
+  struct MSlowEvent {
+    //! The event ID
+    long m_EventID;
+    //! The number of hits
+    unsigned int m_NHits;
+    //! The event type
+    int m_EventType;
+    //! The stage times
+    vector<double> m_StageTimes;
+  };
+
+  // private members:
+ private:
+  //! The number of profiled events
+  unsigned long m_NEvents;
+  //! The latency histograms: stage x multiplicity class x type class x bins
+  vector<unsigned long> m_Histograms;
+  //! The summed times per stage
+  vector<double> m_SumTimes;
+  //! The maximum times per stage
+  vector<double> m_MaximumTimes;
+
+  //! The threshold in seconds above which an event is logged as slow
+  double m_SlowEventThreshold;
+  //! The slow-event log
+  vector<MSlowEvent> m_SlowEvents;
+  //! The number of slow events which did not fit into the log
+  unsigned long m_NDroppedSlowEvents;
+
+
+#ifdef ___CLING___
+ public:
+  ClassDef(MRawEventAnalyzerProfile, 0) // no description
+#endif
+
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
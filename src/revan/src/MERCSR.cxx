@@ -607,10 +607,13 @@ double MERCSR::CalculateComptonDistance(const MVector& Start,
 
 double MERCSR::CalculateReach(const MVector& Start, const MVector& Stop, double Etot)
 {
+  // Trace the ray only once for all three processes
+  m_Geometry->GetPathLengths(Start, Stop, m_PathLengths);
+
   double ReachProbability = 1.0;
-  ReachProbability *= (1 - m_Geometry->GetPairAbsorptionProbability(Start, Stop, Etot));
-  ReachProbability *= (1 - m_Geometry->GetComptonAbsorptionProbability(Start, Stop, Etot));
-  ReachProbability *= (1 - m_Geometry->GetPhotoAbsorptionProbability(Start, Stop, Etot));
+  ReachProbability *= (1 - m_Geometry->GetAbsorptionProbability(m_PathLengths.data(), Etot, MDGeometryQuest::c_AbsorptionPair));
+  ReachProbability *= (1 - m_Geometry->GetAbsorptionProbability(m_PathLengths.data(), Etot, MDGeometryQuest::c_AbsorptionCompton));
+  ReachProbability *= (1 - m_Geometry->GetAbsorptionProbability(m_PathLengths.data(), Etot, MDGeometryQuest::c_AbsorptionPhoto));
 
   return ReachProbability;
 }
@@ -281,12 +281,21 @@ void MERCSRDataSet::Fill(Long64_t ID, vector<MRESE*>& SequencedRESEs, MDGeometry
     m_CosComptonScatterAngleDifference[SequenceLength-3][r] = CosPhiGeo - m_CosComptonScatterAngles[SequenceLength-2][r+1]; // "SequenceLength-3" for first argument since we only start for 3-site events
   }
   
-  // (e) Absorption probabilities
+  // (e) Absorption probabilities --- all rays of the sequence in one batch
   EnergyIncomingGamma = FullEnergy;
+  m_RayStarts.clear();
+  m_RayStops.clear();
+  m_RayEnergies.clear();
   for (unsigned int r = 0; r < SequenceLength-1; ++r) {
     EnergyIncomingGamma -= SequencedRESEs[r]->GetEnergy();
     
-    m_AbsorptionProbabilities[SequenceLength-2][r] = Geometry->GetAbsorptionProbability(SequencedRESEs[r]->GetPosition(), SequencedRESEs[r+1]->GetPosition(), EnergyIncomingGamma);
+    m_RayStarts.push_back(SequencedRESEs[r]->GetPosition());
+    m_RayStops.push_back(SequencedRESEs[r+1]->GetPosition());
+    m_RayEnergies.push_back(EnergyIncomingGamma);
+  }
+  Geometry->GetAbsorptionProbabilities(m_RayStarts, m_RayStops, m_RayEnergies, m_RayProbabilities);
+  for (unsigned int r = 0; r < m_RayProbabilities.size(); ++r) {
+    m_AbsorptionProbabilities[SequenceLength-2][r] = m_RayProbabilities[r];
   }
   
   // (f) Incoming probabilities
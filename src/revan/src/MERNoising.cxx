@@ -48,6 +48,8 @@ using namespace std;
 #include "MDVoxel3D.h"
 #include "MDStrip3DDirectional.h"
 #include "MDGuardRing.h"
+#include "MDTriggerUnit.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +66,9 @@ ClassImp(MERNoising)
 MERNoising::MERNoising()
 {
   // Construct an instance of MERNoising
+
+  m_StreamRunID = 0;
+  m_TriggerUnit = nullptr;
 }
 
 
@@ -73,6 +78,8 @@ MERNoising::MERNoising()
 MERNoising::~MERNoising()
 {
   // Delete this instance of MERNoising
+
+  delete m_TriggerUnit;
 }
 
 
@@ -89,6 +96,10 @@ bool MERNoising::PreAnalysis()
   m_VetoMapTriggerNames.clear();
   m_VetoMapVetoNames.clear();
   
+  // The triggers store the hits of the current event, thus we evaluate our own copy
+  delete m_TriggerUnit;
+  m_TriggerUnit = new MDTriggerUnit(*(m_Geometry->GetTriggerUnit()));
+  
   return true;
 }
 
@@ -102,10 +113,16 @@ bool MERNoising::Analyze(MRERawEvent* Event)
 
   MRESE* RESE = 0;
   MString TriggerName;
-  MDTriggerUnit* Trigger = m_Geometry->GetTriggerUnit();
+  MDTriggerUnit* Trigger = m_TriggerUnit;
 
   // Step 1: Noise
 
+  // All random numbers come from streams keyed by the run ID (the input file), the event ID and the hit index,
+  // thus the result does not depend on the thread or the order in which the events are noised:
+  // Sub-stream 0 is used for the event time, 1..N for the N hits, and N+1 for everything else
+  unsigned long EventID = Event->GetEventID();
+  MDRandom::SetStream(EventID, 0, m_StreamRunID);
+
   // Noise the system time
   MDSystem* System = m_Geometry->GetSystem();
   if (System != 0) {
@@ -117,6 +134,7 @@ bool MERNoising::Analyze(MRERawEvent* Event)
   // Step 1.1: Noise hits:
   int h_max = Event->GetNRESEs();
   for (int h = 0; h < h_max; ++h) {
+    MDRandom::SetStream(EventID, h + 1, m_StreamRunID);
     if (Event->GetRESEAt(h)->GetType() == MRESE::c_Hit) {
       //if (((MREHit *) (Event->GetRESEAt(h)))->GetDetector() != MDDetector::c_Scintillator) {
       mdebug<<"TG - Event: "<<Event->GetEventID()<<": Noising..."<<Event->GetRESEAt(h)->GetEnergy()<<endl;
@@ -133,6 +151,7 @@ bool MERNoising::Analyze(MRERawEvent* Event)
     }
   }
   Event->CompressRESEs();
+  MDRandom::SetStream(EventID, h_max + 1, m_StreamRunID);
 
   // Step 1.2: Noise additional measurements:
   for (vector<MREAM*>::iterator Iter = Event->GetREAMBegin();
@@ -318,6 +337,8 @@ bool MERNoising::Analyze(MRERawEvent* Event)
     }
   }
 
+  MDRandom::ClearStream();
+
   return true;
 }
 
@@ -248,12 +248,21 @@ void MERQualityDataSet::FillEventData(Long64_t ID, vector<MRESE*>& SequencedRESE
     m_CosComptonScatterAngleDifference[r] = CosPhiGeo - m_CosComptonScatterAngles[r+1]; // "SequenceLength-3" for first argument since we only start for 3-site events
   }
   
-  // (e) Absorption probabilities
+  // (e) Absorption probabilities --- all rays of the sequence in one batch
   EnergyIncomingGamma = FullEnergy;
+  m_RayStarts.clear();
+  m_RayStops.clear();
+  m_RayEnergies.clear();
   for (int r = 0; r < m_SequenceLength-1; ++r) {
     EnergyIncomingGamma -= SequencedRESEs[r]->GetEnergy();
     
-    m_AbsorptionProbabilities[r] = Geometry->GetAbsorptionProbability(SequencedRESEs[r]->GetPosition(), SequencedRESEs[r+1]->GetPosition(), EnergyIncomingGamma);
+    m_RayStarts.push_back(SequencedRESEs[r]->GetPosition());
+    m_RayStops.push_back(SequencedRESEs[r+1]->GetPosition());
+    m_RayEnergies.push_back(EnergyIncomingGamma);
+  }
+  Geometry->GetAbsorptionProbabilities(m_RayStarts, m_RayStops, m_RayEnergies, m_RayProbabilities);
+  for (unsigned int r = 0; r < m_RayProbabilities.size(); ++r) {
+    m_AbsorptionProbabilities[r] = m_RayProbabilities[r];
   }
   
   // (f) Minimum Nadir distance of the Compton cone
@@ -46,6 +46,7 @@
 #include "MBinaryStore.h"
 #include "MSimEvent.h"
 #include "MSimHT.h"
+#include "MDRandom.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -78,6 +79,8 @@ MFileEventsEvta::MFileEventsEvta(MGeometryRevan* Geometry) : MFileEvents()
   
   m_Noising = new MERNoising();
   m_Noising->SetGeometry(m_Geometry);
+  m_FileStreamRunID = 0;
+  m_EventStreamRunID = 0;
   
   m_SaveOI = false;
 }
@@ -129,6 +132,10 @@ bool MFileEventsEvta::Open(MString FileName, unsigned int Way, bool IsBinary)
   m_IsFirstEvent = true;
   m_ReachedBinarySection = false;
   
+  // Files with the same event IDs (e.g. from parallel simulations) must not get the same noise
+  m_FileStreamRunID = MDRandom::GetStreamRunID(m_FileName);
+  m_EventStreamRunID = m_FileStreamRunID;
+  
   m_Noising->PreAnalysis();
 
   return true;
@@ -236,6 +243,8 @@ MRERawEvent* MFileEventsEvta::GetNextEventASCII()
             <<"However, the file could not be found or read!!"<<show;
         return 0;
       }
+      // The event completed by this line is still noised with the run ID of the previous file
+      m_FileStreamRunID = MDRandom::GetStreamRunID(m_FileName);
     } else if (Line[0] == 'I' && Line[1] == 'N') {
 
       if (OpenIncludeFile(Line) == true) {
@@ -261,12 +270,14 @@ MRERawEvent* MFileEventsEvta::GetNextEventASCII()
 
         // If this is simulation, then noise all hits:
         if (m_IsSimulation == true && m_Geometry != 0) {
+          m_Noising->SetStreamRunID(m_EventStreamRunID);
           m_Noising->Analyze(Event);
         } // Is simulation
       } // not first event
       
       // Backward compatibility: The SE keyword may contain the event ID
       if (Line[0] == 'S' && Line[1] == 'E') {
+        m_EventStreamRunID = m_FileStreamRunID;
         if (sscanf(Line.Data(), "SE%lu", &m_EventId) != 1) {
           m_EventId = c_NoId;
         }
@@ -501,6 +512,7 @@ MRERawEvent* MFileEventsEvta::GetNextEventBinary()
         
         // If this is simulation, then noise all hits:
         if (m_IsSimulation == true && m_Geometry != nullptr) {
+          m_Noising->SetStreamRunID(m_FileStreamRunID);
           m_Noising->Analyze(Event);
         } // Is simulation
         
@@ -33,6 +33,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 using namespace std;
 
 // ROOT libs:
@@ -74,6 +75,8 @@ using namespace std;
 #include "MPeak.h"
 #include "MIsotope.h"
 #include "MPrelude.h"
+#include "MDRandom.h"
+#include "MDGeometry.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -97,6 +100,9 @@ MInterfaceRevan::MInterfaceRevan() : MInterface()
   m_TestRun = false;
 
   m_OutputFilenName = "";
+  m_Profiling = false;
+  m_ProfileFileName = "";
+  m_SlowEventThreshold = 0.1;
 }
 
 
@@ -149,6 +155,18 @@ bool MInterfaceRevan::ParseCommandLine(int argc, char** argv)
   Usage<<endl;
   Usage<<"      -t  --test:"<<endl;
   Usage<<"             Perform a test run."<<endl;
+  Usage<<"         --profile <file name>:"<<endl;
+  Usage<<"             Record per-stage latency histograms of the event reconstruction, split by hit multiplicity and event type,"<<endl;
+  Usage<<"             and write them to this file (CSV, or JSON if the name ends with .json)"<<endl;
+  Usage<<"         --slow-event-threshold <milli-seconds>:"<<endl;
+  Usage<<"             Log all events with a larger reconstruction time in the profile's slow-event log (default: 100 ms)"<<endl;
+  Usage<<"         --noise-seed <seed>:"<<endl;
+  Usage<<"             Seed of the random streams used for noising simulated events (default: 0)."<<endl;
+  Usage<<"             The same seed and input file give identical noise independent of the number of threads"<<endl;
+  Usage<<"         --no-geometry-cache:"<<endl;
+  Usage<<"             Do not read or write the cache of the preprocessed geometry setup file"<<endl;
+  Usage<<"         --no-rese-pool:"<<endl;
+  Usage<<"             Allocate the hits, clusters, tracks, etc. with the standard allocator instead of the RESE pool (for comparisons)"<<endl;
   Usage<<"      -d --debug:"<<endl;
   Usage<<"             Use debug mode"<<endl;
   Usage<<"      -n --no-gui:"<<endl;
@@ -177,6 +195,8 @@ bool MInterfaceRevan::ParseCommandLine(int argc, char** argv)
         Option == "-o" || Option == "--output-filename" ||
         Option == "-c" || Option == "--configuration" ||
         Option == "-j" || Option == "--jobs" ||
+        Option == "--profile" || Option == "--slow-event-threshold" ||
+        Option == "--noise-seed" ||
         Option == "-g" || Option == "--geometry") {
       if (!((argc > i+1) && argv[i+1][0] != '-')){
         cout<<"Error: Option "<<argv[i][1]<<" needs a second argument!"<<endl;
@@ -208,6 +228,15 @@ bool MInterfaceRevan::ParseCommandLine(int argc, char** argv)
     } else if (Option == "--debug" || Option == "-d") {
       g_Verbosity = 2;
       cout<<"Command-line parser: Use debug mode"<<endl;
+    } else if (Option == "--no-geometry-cache") {
+      MDGeometry::UseCache(false);
+      cout<<"Command-line parser: Do not use the geometry cache"<<endl;
+    } else if (Option == "--no-rese-pool") {
+      MRESEPool::SetEnabled(false);
+      cout<<"Command-line parser: Do not use the RESE pool"<<endl;
+    } else if (Option == "--noise-seed") {
+      MDRandom::SetStreamSeed(strtoul(argv[++i], nullptr, 10));
+      cout<<"Command-line parser: Use noise seed "<<MDRandom::GetStreamSeed()<<endl;
     } else if (Option == "--configuration" || Option == "-c") {
       m_Data->Read(argv[++i]);
       cout<<"Command-line parser: Use configuration file "<<m_Data->GetSettingsFileName()<<endl;
@@ -258,6 +287,14 @@ bool MInterfaceRevan::ParseCommandLine(int argc, char** argv)
     } else if (Option == "--jobs" || Option == "-j") {
       m_Data->SetNJobs(atoi(argv[++i]));
       cout<<"Command-line parser: Use file "<<m_Data->GetCurrentFileName()<<endl;
+    } else if (Option == "--profile") {
+      m_Profiling = true;
+      m_ProfileFileName = argv[++i];
+      cout<<"Command-line parser: Write the latency profile to "<<m_ProfileFileName<<endl;
+    } else if (Option == "--slow-event-threshold") {
+      m_Profiling = true;
+      m_SlowEventThreshold = 0.001*atof(argv[++i]);
+      cout<<"Command-line parser: Log events slower than "<<1000*m_SlowEventThreshold<<" ms"<<endl;
     } else if (Option == "--special" || Option == "--development") {
       m_Data->SetSpecialMode(true);
       cout<<"Command-line parser: Activating development extras mode - hope, you know what you are doing..."<<endl;
@@ -424,6 +461,7 @@ void MInterfaceRevan::SetGuiData(MRawEventAnalyzer& REA)
 
   REA.SetSettings(m_Data);
   REA.SetBatch(!m_UseGui);
+  REA.SetProfiling(m_Profiling, m_ProfileFileName, m_SlowEventThreshold);
 
   m_Data->Write();
 }
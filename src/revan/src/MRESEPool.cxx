@@ -0,0 +1,195 @@
+/*
+ * MRESEPool.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MRESEPool
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MRESEPool.h"
+
+// Standard libs:
+#include <new>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MRESEPool)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+atomic<bool> MRESEPool::s_Enabled(true);
+
+//! The pool of the current thread
+static thread_local MRESEPool* g_ThreadPool = nullptr;
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MRESEPool::MRESEPool() : m_RemoteFreeList(nullptr), m_ChunkPosition(nullptr), m_ChunkEnd(nullptr)
+{
+  // Construct an instance of MRESEPool
+
+  for (unsigned int s = 0; s < c_NSizeClasses; ++s) {
+    m_FreeLists[s] = nullptr;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MRESEPool* MRESEPool::GetThreadPool()
+{
+  // Return the pool of this thread - it is intentionally never deleted, since RESEs can outlive their thread
+
+  if (g_ThreadPool == nullptr) {
+    g_ThreadPool = new MRESEPool();
+  }
+
+  return g_ThreadPool;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void* MRESEPool::Allocate(size_t Size)
+{
+  // Allocate memory for a RESE of the given size
+
+  size_t Total = Size + sizeof(MBlockHeader);
+
+  if (s_Enabled == false || Total > c_Granularity*c_NSizeClasses) {
+    MBlockHeader* Header = static_cast<MBlockHeader*>(::operator new(Total));
+    Header->m_Owner = nullptr;
+    Header->m_SizeClass = 0;
+    return Header + 1;
+  }
+
+  return GetThreadPool()->AllocateBlock((Total - 1) / c_Granularity);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRESEPool::Release(void* Pointer)
+{
+  // Give back the memory of a RESE
+
+  if (Pointer == nullptr) return;
+
+  MBlockHeader* Header = static_cast<MBlockHeader*>(Pointer) - 1;
+
+  if (Header->m_Owner == nullptr) {
+    ::operator delete(Header);
+  } else if (Header->m_Owner == g_ThreadPool) {
+    g_ThreadPool->ReleaseBlock(Pointer);
+  } else {
+    // Another thread owns it: push it onto its remote list, it is picked up there when its free lists run empty
+    MFreeBlock* Block = static_cast<MFreeBlock*>(Pointer);
+    MRESEPool* Owner = Header->m_Owner;
+    Block->m_Next = Owner->m_RemoteFreeList.load(memory_order_relaxed);
+    while (Owner->m_RemoteFreeList.compare_exchange_weak(Block->m_Next, Block, memory_order_release, memory_order_relaxed) == false);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void* MRESEPool::AllocateBlock(unsigned int SizeClass)
+{
+  // Allocate a block of the given size class
+
+  if (m_FreeLists[SizeClass] == nullptr && m_RemoteFreeList.load(memory_order_relaxed) != nullptr) {
+    CollectRemoteBlocks();
+  }
+
+  // Reuse a released block
+  if (m_FreeLists[SizeClass] != nullptr) {
+    MFreeBlock* Block = m_FreeLists[SizeClass];
+    m_FreeLists[SizeClass] = Block->m_Next;
+    return Block;
+  }
+
+  // Otherwise carve a new one out of the current chunk
+  size_t BlockSize = (SizeClass + 1) * c_Granularity;
+  if (m_ChunkPosition == nullptr || m_ChunkPosition + BlockSize > m_ChunkEnd) {
+    m_ChunkPosition = static_cast<char*>(::operator new(c_ChunkSize));
+    m_ChunkEnd = m_ChunkPosition + c_ChunkSize;
+    m_Chunks.push_back(m_ChunkPosition);
+  }
+
+  MBlockHeader* Header = reinterpret_cast<MBlockHeader*>(m_ChunkPosition);
+  Header->m_Owner = this;
+  Header->m_SizeClass = SizeClass;
+  m_ChunkPosition += BlockSize;
+
+  return Header + 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRESEPool::ReleaseBlock(void* Pointer)
+{
+  // Put a block back into the free list
+
+  MBlockHeader* Header = static_cast<MBlockHeader*>(Pointer) - 1;
+  MFreeBlock* Block = static_cast<MFreeBlock*>(Pointer);
+
+  Block->m_Next = m_FreeLists[Header->m_SizeClass];
+  m_FreeLists[Header->m_SizeClass] = Block;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRESEPool::CollectRemoteBlocks()
+{
+  // Move the blocks released by other threads into the free lists
+
+  MFreeBlock* Block = m_RemoteFreeList.exchange(nullptr, memory_order_acquire);
+  while (Block != nullptr) {
+    MFreeBlock* Next = Block->m_Next;
+    ReleaseBlock(Block);
+    Block = Next;
+  }
+}
+
+
+// MRESEPool.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
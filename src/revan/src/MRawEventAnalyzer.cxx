@@ -36,6 +36,7 @@
 
 // Standard lib
 #include <iomanip>
+#include <algorithm>
 #include <limits>
 using namespace std;
 
@@ -69,6 +70,7 @@ using namespace std;
 #include "MERCSRBayesian.h"
 #include "MERCSRTMVA.h"
 #include "MERDecay.h"
+#include "MPhysicalEvent.h"
 
 
 #ifdef ___CLING___
@@ -225,6 +227,10 @@ MRawEventAnalyzer::MRawEventAnalyzer()
   m_TimeCSR = 0;
   m_TimeFinalize = 0;
 
+  m_UseProfile = false;
+  m_ProfileFileName = "";
+  m_StageTimes.resize(MRawEventAnalyzerProfile::c_NStages, 0.0);
+
   m_IsBatch = false;
 
   m_Coincidence = nullptr;
@@ -437,6 +443,7 @@ bool MRawEventAnalyzer::SetOutputModeFile(MString Filename)
   m_FilenameOut = Filename;
   
   m_PhysFile = new MFileEventsTra();
+  m_PhysFile->SetBackgroundWriting(true);
   if (m_PhysFile->Open(m_FilenameOut, MFile::c_Write) == false) {
     mout<<"MRawEventAnalyzer: Unable to open output file \""<<m_FilenameOut<<"\""<<endl;
     delete m_PhysFile;
@@ -507,6 +514,7 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
 {
   // A event timer...
   MTimer Timer;
+  fill(m_StageTimes.begin(), m_StageTimes.end(), 0.0);
   
   // this flag indicates that we have no more events in file, and the coincidence search has to "clear the store"
   bool ClearStore = false;
@@ -527,7 +535,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     }
     
     // Event timing...
-    m_TimeLoad += Timer.ElapsedTime();
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageLoad] = Timer.ElapsedTime();
+    m_TimeLoad += m_StageTimes[MRawEventAnalyzerProfile::c_StageLoad];
     Timer.Start();
   }
   
@@ -588,6 +597,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     return c_AnalysisUndefinedError;
   }
   
+  m_StageTimes[MRawEventAnalyzerProfile::c_StageCoincidence] = Timer.ElapsedTime();
+  
   mdebug<<endl;
   mdebug<<endl;
   mdebug<<endl;
@@ -656,7 +667,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     
     if (m_RawEvents->IsAnyEventValid() == false) SelectionsPassed = false;
     
-    m_TimeEventClusterize += Timer.ElapsedTime();
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageEventClustering] = Timer.ElapsedTime();
+    m_TimeEventClusterize += m_StageTimes[MRawEventAnalyzerProfile::c_StageEventClustering];
   }
   
   
@@ -682,7 +694,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     
     if (m_RawEvents->IsAnyEventValid() == false) SelectionsPassed = false;
     
-    m_TimeHitClusterize += Timer.ElapsedTime();  
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageHitClustering] = Timer.ElapsedTime();
+    m_TimeHitClusterize += m_StageTimes[MRawEventAnalyzerProfile::c_StageHitClustering];
   }
   
   
@@ -703,7 +716,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     
     if (m_RawEvents->IsAnyEventValid() == false) SelectionsPassed = false;    
     
-    m_TimeTrack += Timer.ElapsedTime();
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageTracking] = Timer.ElapsedTime();
+    m_TimeTrack += m_StageTimes[MRawEventAnalyzerProfile::c_StageTracking];
     
   } else {
     mdebug<<"I am not doing Tracking!"<<endl;
@@ -731,6 +745,9 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     
     if (m_RawEvents->IsAnyEventValid() == false) SelectionsPassed = false;    
     
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageCSR] = Timer.ElapsedTime();
+    m_TimeCSR += m_StageTimes[MRawEventAnalyzerProfile::c_StageCSR];
+    
   } else {
     mdebug<<"I am not doing CSR!"<<endl;
   }
@@ -740,6 +757,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
   // Section F: Decay algorithm
   if (SelectionsPassed == true && m_DecayAlgorithm > c_DecayAlgoNone) {
     
+    Timer.Start();
+    
     if (m_Decay == nullptr) {
       merr<<"Decay pointer is zero. You changed the event reconstruction setup without calling PreAnalysis()!"<<show;
       return c_AnalysisUndefinedError;
@@ -752,6 +771,8 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     
     if (m_RawEvents->IsAnyEventValid() == false) SelectionsPassed = false;    
     
+    m_StageTimes[MRawEventAnalyzerProfile::c_StageDecay] = Timer.ElapsedTime();
+    
   } else {
     mdebug<<"I am not doing Decay!"<<endl;
   }
@@ -830,7 +851,12 @@ unsigned int MRawEventAnalyzer::AnalyzeEvent()
     m_NPassedEventSelection++;  
   }
   
-  m_TimeFinalize += Timer.ElapsedTime();
+  m_StageTimes[MRawEventAnalyzerProfile::c_StageFinalize] = Timer.ElapsedTime();
+  m_TimeFinalize += m_StageTimes[MRawEventAnalyzerProfile::c_StageFinalize];
+  
+  if (m_UseProfile == true) {
+    m_Profile.Add(m_InitialRawEvent->GetEventID(), m_InitialRawEvent->GetNRESEs(), (Event != nullptr) ? Event->GetType() : MPhysicalEvent::c_Unknown, m_StageTimes);
+  }
   
   return c_AnalysisSucess;
 }
@@ -952,6 +978,39 @@ void MRawEventAnalyzer::JoinStatistics(const MRawEventAnalyzer& A)
   for (unsigned int r = 0; r < m_Rejections.size(); ++r) {
     m_Rejections[r] += A.m_Rejections[r];
   }
+  
+  m_Profile.Join(A.m_Profile);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRawEventAnalyzer::SetProfiling(bool Profiling, const MString& FileName, double SlowEventThreshold)
+{
+  // Record the time of each stage of each event in a latency profile
+  
+  m_UseProfile = Profiling;
+  m_ProfileFileName = FileName;
+  m_Profile.SetSlowEventThreshold(SlowEventThreshold);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRawEventAnalyzer::WriteProfile() const
+{
+  // Print the latency profile and write it to file
+
+  if (m_UseProfile == false) return;
+
+  mout<<m_Profile.ToString()<<endl;
+  if (m_ProfileFileName != "") {
+    if (m_Profile.Write(m_ProfileFileName) == true) {
+      mout<<"Latency profile written to "<<m_ProfileFileName<<endl<<endl;
+    }
+  }
 }
 
 
@@ -1076,6 +1135,8 @@ bool MRawEventAnalyzer::PostAnalysis()
 
   mout<<out.str().c_str()<<endl;
 
+  WriteProfile();
+  
   /*
   mout<<"General timings:"<<endl;
   mout<<"Timer Load     "<<m_TimeLoad<<endl;
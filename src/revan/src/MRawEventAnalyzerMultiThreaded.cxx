@@ -94,6 +94,7 @@ bool MRawEventAnalyzerMultiThreaded::PreAnalysis()
   }
 
   m_FileOut = new MFileEventsTra();
+  m_FileOut->SetBackgroundWriting(true);
   if (m_FileOut->Open(m_FileNameOut, MFile::c_Write) == false) {
     mout<<"MRawEventAnalyzerMultiThreaded: Unable to open output file!"<<endl;
     delete m_FileOut;
@@ -0,0 +1,465 @@
+/*
+ * MRawEventAnalyzerProfile.cxx
+ *
+ *
+ * Copyright (C) by Andreas Zoglauer.
+ * All rights reserved.
+ *
+ *
+ * This code implementation is the intellectual property of
+ * Andreas Zoglauer.
+ *
+ * By copying, distributing or modifying the Program (or any work
+ * based on the Program) you indicate your acceptance of this statement,
+ * and all its terms.
+ *
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MRawEventAnalyzerProfile
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// Include the header:
+#include "MRawEventAnalyzerProfile.h"
+
+// Standard libs:
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+// ROOT libs:
+
+// MEGAlib libs:
+#include "MStreams.h"
+#include "MPhysicalEvent.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef ___CLING___
+ClassImp(MRawEventAnalyzerProfile)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MRawEventAnalyzerProfile::MRawEventAnalyzerProfile()
+{
+  // Construct an instance of MRawEventAnalyzerProfile
+
+  m_SlowEventThreshold = 0.1;
+
+  Clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MRawEventAnalyzerProfile::~MRawEventAnalyzerProfile()
+{
+  // Delete this instance of MRawEventAnalyzerProfile
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRawEventAnalyzerProfile::Clear()
+{
+  // Reset all data
+
+  m_NEvents = 0;
+  m_Histograms.assign(c_NStages*c_NMultiplicityClasses*c_NTypeClasses*c_NBins, 0);
+  m_SumTimes.assign(c_NStages, 0.0);
+  m_MaximumTimes.assign(c_NStages, 0.0);
+  m_SlowEvents.clear();
+  m_NDroppedSlowEvents = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MRawEventAnalyzerProfile::GetStageName(unsigned int Stage)
+{
+  // Return the name of a stage
+
+  switch (Stage) {
+  case c_StageLoad: return "Load";
+  case c_StageCoincidence: return "Coincidence";
+  case c_StageEventClustering: return "EventClustering";
+  case c_StageHitClustering: return "HitClustering";
+  case c_StageTracking: return "Tracking";
+  case c_StageCSR: return "CSR";
+  case c_StageDecay: return "Decay";
+  case c_StageFinalize: return "Finalize";
+  case c_StageTotal: return "Total";
+  default: return "Unknown";
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MRawEventAnalyzerProfile::GetMultiplicityClass(unsigned int NHits)
+{
+  // Return the multiplicity class of the number of hits
+
+  if (NHits <= 4) return (NHits == 0) ? 0 : NHits - 1;
+  if (NHits <= 7) return 4;
+  if (NHits <= 12) return 5;
+  if (NHits <= 20) return 6;
+  if (NHits <= 50) return 7;
+  return 8;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MRawEventAnalyzerProfile::GetMultiplicityClassName(unsigned int Class)
+{
+  // Return the name of a multiplicity class
+
+  const char* Names[c_NMultiplicityClasses] = { "1", "2", "3", "4", "5-7", "8-12", "13-20", "21-50", ">50" };
+
+  return (Class < c_NMultiplicityClasses) ? Names[Class] : "Unknown";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MRawEventAnalyzerProfile::GetTypeClass(int EventType)
+{
+  // Return the type class of the event type - the last one is for not reconstructed events
+
+  if (EventType == MPhysicalEvent::c_Photo) return 0;
+  if (EventType == MPhysicalEvent::c_Compton) return 1;
+  if (EventType == MPhysicalEvent::c_Pair) return 2;
+  if (EventType == MPhysicalEvent::c_Muon) return 3;
+  if (EventType == MPhysicalEvent::c_PET) return 4;
+  if (EventType == MPhysicalEvent::c_Multi) return 5;
+  if (EventType == MPhysicalEvent::c_Unidentifiable) return 6;
+  if (EventType == MPhysicalEvent::c_Unknown) return 8;
+  return 7;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MRawEventAnalyzerProfile::GetTypeClassName(unsigned int Class)
+{
+  // Return the name of a type class
+
+  const char* Names[c_NTypeClasses] = { "Photo", "Compton", "Pair", "Muon", "PET", "Multi", "Unidentifiable", "Other", "NotReconstructed" };
+
+  return (Class < c_NTypeClasses) ? Names[Class] : "Unknown";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int MRawEventAnalyzerProfile::GetBin(double Time)
+{
+  // Return the histogram bin of the time: 0 is the underflow, c_NBins-1 the overflow
+
+  if (Time <= 0) return 0;
+
+  double Position = (log10(Time) - c_MinimumDecade)*c_BinsPerDecade;
+  if (Position < 0) return 0;
+  if (Position >= c_NDecades*c_BinsPerDecade) return c_NBins - 1;
+
+  return (unsigned int) Position + 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MRawEventAnalyzerProfile::GetBinLowEdge(unsigned int Bin)
+{
+  // Return the lower edge of a bin in seconds
+
+  if (Bin == 0) return 0;
+
+  return pow(10.0, c_MinimumDecade + double(Bin - 1)/c_BinsPerDecade);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRawEventAnalyzerProfile::Add(long EventID, unsigned int NHits, int EventType, const vector<double>& StageTimes)
+{
+  // Add one event
+
+  if (StageTimes.size() != c_NStages) {
+    merr<<"The number of stage times is not "<<c_NStages<<" but "<<StageTimes.size()<<endl;
+    return;
+  }
+
+  vector<double> Times = StageTimes;
+  Times[c_StageTotal] = 0;
+  for (unsigned int s = 0; s < c_StageTotal; ++s) {
+    Times[c_StageTotal] += Times[s];
+  }
+
+  unsigned int MultiplicityClass = GetMultiplicityClass(NHits);
+  unsigned int TypeClass = GetTypeClass(EventType);
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    m_Histograms[GetIndex(s, MultiplicityClass, TypeClass)*c_NBins + GetBin(Times[s])]++;
+    m_SumTimes[s] += Times[s];
+    if (Times[s] > m_MaximumTimes[s]) m_MaximumTimes[s] = Times[s];
+  }
+  ++m_NEvents;
+
+  if (Times[c_StageTotal] > m_SlowEventThreshold) {
+    if (m_SlowEvents.size() < c_MaximumSlowEvents) {
+      m_SlowEvents.push_back(MSlowEvent{ EventID, NHits, EventType, Times });
+    } else {
+      ++m_NDroppedSlowEvents;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MRawEventAnalyzerProfile::Join(const MRawEventAnalyzerProfile& Profile)
+{
+  // Add the data of another profile, e.g. of another thread
+
+  m_NEvents += Profile.m_NEvents;
+  for (unsigned long i = 0; i < m_Histograms.size(); ++i) {
+    m_Histograms[i] += Profile.m_Histograms[i];
+  }
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    m_SumTimes[s] += Profile.m_SumTimes[s];
+    m_MaximumTimes[s] = max(m_MaximumTimes[s], Profile.m_MaximumTimes[s]);
+  }
+
+  for (const MSlowEvent& E: Profile.m_SlowEvents) {
+    if (m_SlowEvents.size() < c_MaximumSlowEvents) {
+      m_SlowEvents.push_back(E);
+    } else {
+      ++m_NDroppedSlowEvents;
+    }
+  }
+  m_NDroppedSlowEvents += Profile.m_NDroppedSlowEvents;
+
+  // Keep the log in event order
+  sort(m_SlowEvents.begin(), m_SlowEvents.end(), [](const MSlowEvent& A, const MSlowEvent& B) { return A.m_EventID < B.m_EventID; });
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+double MRawEventAnalyzerProfile::GetQuantile(unsigned int Stage, double Quantile) const
+{
+  // Return the quantile of the latency of a stage - the upper edge of the bin containing it
+
+  vector<unsigned long> Summed(c_NBins, 0);
+  unsigned long Total = 0;
+  for (unsigned int m = 0; m < c_NMultiplicityClasses; ++m) {
+    for (unsigned int t = 0; t < c_NTypeClasses; ++t) {
+      unsigned long Offset = GetIndex(Stage, m, t)*c_NBins;
+      for (unsigned int b = 0; b < c_NBins; ++b) {
+        Summed[b] += m_Histograms[Offset + b];
+        Total += m_Histograms[Offset + b];
+      }
+    }
+  }
+  if (Total == 0) return 0;
+
+  unsigned long Counts = 0;
+  for (unsigned int b = 0; b < c_NBins; ++b) {
+    Counts += Summed[b];
+    if (Counts >= Quantile*Total) {
+      return (b + 1 < c_NBins) ? GetBinLowEdge(b + 1) : m_MaximumTimes[Stage];
+    }
+  }
+
+  return m_MaximumTimes[Stage];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+MString MRawEventAnalyzerProfile::ToString() const
+{
+  // Return a summary
+
+  ostringstream out;
+  out<<"Event reconstruction latencies of "<<m_NEvents<<" events (in milliseconds, quantiles are upper bin edges):"<<endl;
+  out<<"  "<<setw(16)<<left<<"Stage"<<right<<setw(12)<<"Mean"<<setw(12)<<"Median"<<setw(12)<<"99%"<<setw(12)<<"Maximum"<<endl;
+  out<<setprecision(4);
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    out<<"  "<<setw(16)<<left<<GetStageName(s)<<right
+       <<setw(12)<<((m_NEvents > 0) ? 1000*m_SumTimes[s]/m_NEvents : 0)
+       <<setw(12)<<1000*GetQuantile(s, 0.5)
+       <<setw(12)<<1000*GetQuantile(s, 0.99)
+       <<setw(12)<<1000*m_MaximumTimes[s]<<endl;
+  }
+  out<<"  Slow events (above "<<1000*m_SlowEventThreshold<<" ms): "<<m_SlowEvents.size() + m_NDroppedSlowEvents<<endl;
+
+  return out.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MRawEventAnalyzerProfile::Write(const MString& FileName) const
+{
+  // Write the profile - the format is selected by the suffix
+
+  if (FileName.EndsWith(".json") == true) {
+    return WriteJSON(FileName);
+  }
+
+  return WriteCSV(FileName);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MRawEventAnalyzerProfile::WriteCSV(const MString& FileName) const
+{
+  // Write the non-empty histogram bins, and the slow events into a second file
+
+  ofstream out;
+  out.open(FileName);
+  if (out.is_open() == false) {
+    merr<<"Unable to open profile file \""<<FileName<<"\""<<endl;
+    return false;
+  }
+
+  out<<"stage,multiplicity,type,bin_min_sec,bin_max_sec,count"<<endl;
+  out<<setprecision(6);
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    for (unsigned int m = 0; m < c_NMultiplicityClasses; ++m) {
+      for (unsigned int t = 0; t < c_NTypeClasses; ++t) {
+        unsigned long Offset = GetIndex(s, m, t)*c_NBins;
+        for (unsigned int b = 0; b < c_NBins; ++b) {
+          if (m_Histograms[Offset + b] == 0) continue;
+          out<<GetStageName(s)<<","<<GetMultiplicityClassName(m)<<","<<GetTypeClassName(t)<<","<<GetBinLowEdge(b)<<",";
+          if (b + 1 < c_NBins) out<<GetBinLowEdge(b + 1); else out<<"inf";
+          out<<","<<m_Histograms[Offset + b]<<endl;
+        }
+      }
+    }
+  }
+  out.close();
+
+  MString SlowFileName = FileName;
+  if (SlowFileName.EndsWith(".csv") == true) SlowFileName.RemoveLastInPlace(4);
+  SlowFileName += ".slowevents.csv";
+
+  out.open(SlowFileName);
+  if (out.is_open() == false) {
+    merr<<"Unable to open profile file \""<<SlowFileName<<"\""<<endl;
+    return false;
+  }
+
+  out<<"event_id,hits,type";
+  for (unsigned int s = 0; s < c_NStages; ++s) out<<","<<GetStageName(s)<<"_sec";
+  out<<endl;
+  for (const MSlowEvent& E: m_SlowEvents) {
+    out<<E.m_EventID<<","<<E.m_NHits<<","<<GetTypeClassName(GetTypeClass(E.m_EventType));
+    for (unsigned int s = 0; s < c_NStages; ++s) out<<","<<E.m_StageTimes[s];
+    out<<endl;
+  }
+  out.close();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool MRawEventAnalyzerProfile::WriteJSON(const MString& FileName) const
+{
+  // Write everything as one JSON object
+
+  ofstream out;
+  out.open(FileName);
+  if (out.is_open() == false) {
+    merr<<"Unable to open profile file \""<<FileName<<"\""<<endl;
+    return false;
+  }
+
+  out<<setprecision(6);
+  out<<"{"<<endl;
+  out<<"  \"events\": "<<m_NEvents<<","<<endl;
+  out<<"  \"slow_event_threshold_sec\": "<<m_SlowEventThreshold<<","<<endl;
+  out<<"  \"dropped_slow_events\": "<<m_NDroppedSlowEvents<<","<<endl;
+
+  out<<"  \"bin_min_sec\": [";
+  for (unsigned int b = 0; b < c_NBins; ++b) out<<(b > 0 ? ", " : "")<<GetBinLowEdge(b);
+  out<<"],"<<endl;
+
+  out<<"  \"stages\": [";
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    out<<(s > 0 ? ", " : "")<<"{\"name\": \""<<GetStageName(s)<<"\", \"sum_sec\": "<<m_SumTimes[s]<<", \"max_sec\": "<<m_MaximumTimes[s]<<"}";
+  }
+  out<<"],"<<endl;
+
+  out<<"  \"histograms\": ["<<endl;
+  bool First = true;
+  for (unsigned int s = 0; s < c_NStages; ++s) {
+    for (unsigned int m = 0; m < c_NMultiplicityClasses; ++m) {
+      for (unsigned int t = 0; t < c_NTypeClasses; ++t) {
+        unsigned long Offset = GetIndex(s, m, t)*c_NBins;
+        bool Empty = true;
+        for (unsigned int b = 0; b < c_NBins; ++b) {
+          if (m_Histograms[Offset + b] != 0) { Empty = false; break; }
+        }
+        if (Empty == true) continue;
+
+        if (First == false) out<<","<<endl;
+        First = false;
+        out<<"    {\"stage\": \""<<GetStageName(s)<<"\", \"multiplicity\": \""<<GetMultiplicityClassName(m)<<"\", \"type\": \""<<GetTypeClassName(t)<<"\", \"counts\": [";
+        for (unsigned int b = 0; b < c_NBins; ++b) out<<(b > 0 ? ", " : "")<<m_Histograms[Offset + b];
+        out<<"]}";
+      }
+    }
+  }
+  out<<endl<<"  ],"<<endl;
+
+  out<<"  \"slow_events\": ["<<endl;
+  for (unsigned long e = 0; e < m_SlowEvents.size(); ++e) {
+    const MSlowEvent& E = m_SlowEvents[e];
+    out<<"    {\"id\": "<<E.m_EventID<<", \"hits\": "<<E.m_NHits<<", \"type\": \""<<GetTypeClassName(GetTypeClass(E.m_EventType))<<"\", \"sec\": {";
+    for (unsigned int s = 0; s < c_NStages; ++s) out<<(s > 0 ? ", " : "")<<"\""<<GetStageName(s)<<"\": "<<E.m_StageTimes[s];
+    out<<"}}"<<(e + 1 < m_SlowEvents.size() ? "," : "")<<endl;
+  }
+  out<<"  ]"<<endl;
+  out<<"}"<<endl;
+
+  out.close();
+
+  return true;
+}
+
+
+// MRawEventAnalyzerProfile.cxx: the end...
+////////////////////////////////////////////////////////////////////////////////
@@ -38,6 +38,7 @@ using namespace std;
 #include "MRotationInterface.h"
 #include "MBinaryStore.h"
 #include "MSimBinaryOptions.h"
+#include "MFastTokenizer.h"
 
 // Forward declarations:
 
@@ -89,8 +90,8 @@ class MSimEvent : public MRotationInterface
   bool Add(const MSimEvent& Event);
   
   //! Parse a single line from a sim file to this event
-  bool ParseLine(MString Line, int Version = 1);
-  bool AddRawInput(MString Line, int Version = 1) { return ParseLine(Line, Version); }
+  bool ParseLine(const MString& Line, int Version = 1);
+  bool AddRawInput(const MString& Line, int Version = 1) { return ParseLine(Line, Version); }
   
   //! Parse a full (i.e. multi-line) event from a sim file to this event
   bool ParseEvent(MString Line, int Version = 1);  
@@ -424,6 +425,9 @@ class MSimEvent : public MRotationInterface
   //! Number of ignored hits (energy below threshold, no detector)
   int m_NIgnoredHTs;
 
+  //! The tokenizer for the lines with a variable number of tokens - kept to reuse its token storage
+  MFastTokenizer m_Tokenizer;
+
   
   
 #ifdef ___CLING___
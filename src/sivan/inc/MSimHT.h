@@ -49,7 +49,7 @@ class MSimHT
   virtual ~MSimHT();
 
   //! Set everything via one line of input from sim file - noising will be applied automatically if set in the geometry
-  bool AddRawInput(MString LineBuffer, int Version = 100);
+  bool AddRawInput(const MString& LineBuffer, int Version = 100);
 
   //! Convert the *key* content to binary
   bool ParseBinary(MBinaryStore& Out, const bool StoreOrigins, const bool StoreTime, const int OriginIDPrecision = 32, const int BinaryPrecision = 32, const int Version = 25);
@@ -43,7 +43,7 @@ class MSimIA
   virtual ~MSimIA();
 
   //! Parse a text line to fill this event
-  bool AddRawInput(MString LineBuffer, int Version = 0);
+  bool AddRawInput(const MString& LineBuffer, int Version = 0);
 
   //! Convert the *key* content to binary
   bool ParseBinary(MBinaryStore& Out, const bool HasTime, const bool IsSingleINIT, const int OriginIDPrecision = 32, const int BinaryPrecision = 32, const int Version = 25);
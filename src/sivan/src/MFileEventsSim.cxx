@@ -273,7 +273,7 @@ MSimEvent* MFileEventsSim::GetNextEventBinary(bool Analyze)
     }
   }
 
-  if (GetFilePosition() == 0) {
+  if (GetUncompressedFilePosition() == 0) {
   
     MString Line;
     while (IsGood() == true) {
@@ -411,7 +411,12 @@ MSimEvent* MFileEventsSim::GetNextEventASCII(bool Analyze)
   }
   
   bool BeyondFirstSE = true;
-  if (GetFilePosition() == 0) BeyondFirstSE = false;
+  if (GetUncompressedFilePosition() == 0) BeyondFirstSE = false;
+
+  // Jump over blocks of events outside the time selection - we land right before an "SE"
+  bool NoMoreBlocks = false;
+  if (SkipUnselectedTimeBlocks(NoMoreBlocks) == true) BeyondFirstSE = false;
+  if (NoMoreBlocks == true) return nullptr;
   
   MString Line;
   while (IsGood() == true) {
@@ -568,6 +573,7 @@ bool MFileEventsSim::AddEvent(MSimEvent* Event)
       return CreateIncludeFile();
     }
   } else {
+    AddToTimeIndex(Event->GetTime());
     if (m_IsBinary == true) {
       MBinaryStore Store;
       Event->ToBinary(Store, MSimEvent::c_StoreSimulationInfoAll, true, 25);
@@ -613,6 +619,8 @@ bool MFileEventsSim::CloseEventList()
     return false;
   }
 
+  CloseTimeIndex();
+
   ostringstream out;
   if (m_IsBinary == true) {
     MBinaryStore S;
@@ -42,6 +42,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MFastTokenizer.h"
 #include "MDDetector.h"
 #include "MDACS.h"
 #include "MDStrip2D.h"
@@ -351,7 +352,7 @@ bool MSimEvent::ParseEvent(MString Line, int Version)
   
   vector<MString> Lines = Line.Tokenize("\n");
   
-  for (MString L: Lines) {
+  for (const MString& L: Lines) {
     if (ParseLine(L, Version) == false) {
       return false; 
     }
@@ -364,7 +365,7 @@ bool MSimEvent::ParseEvent(MString Line, int Version)
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool MSimEvent::ParseLine(MString LineBuffer, int Version)
+bool MSimEvent::ParseLine(const MString& LineBuffer, int Version)
 {
   // Analyze one line of text input...
   // Return true if all event data is available
@@ -393,14 +394,15 @@ bool MSimEvent::ParseLine(MString LineBuffer, int Version)
 
   // Start Event:
   if (LineBuffer[0] == 'I' && LineBuffer[1] == 'D') {
-    if (sscanf(LineBuffer.Data(),"ID %lu %lu\n",&m_NEvent, &m_NStartedEvent) != 2) {
-      if (sscanf(LineBuffer.Data(),"ID %lu\n",&m_NEvent) != 1) {
-        mout<<"Error during scanning of sim file in token ID!"<<endl;
-        mout<<"  "<<LineBuffer<<endl;
-        Ret = false;
-      } else {
-        m_NStartedEvent = m_NEvent;
-      }
+    // The number of started events is optional
+    m_Tokenizer.Analyze(LineBuffer);
+    if (m_Tokenizer.GetNTokens() < 2) {
+      mout<<"Error during scanning of sim file in token ID!"<<endl;
+      mout<<"  "<<LineBuffer<<endl;
+      Ret = false;
+    } else {
+      m_NEvent = m_Tokenizer.GetTokenAtAsUnsignedLong(1);
+      m_NStartedEvent = (m_Tokenizer.GetNTokens() > 2) ? m_Tokenizer.GetTokenAtAsUnsignedLong(2) : m_NEvent;
     }
     Reset();
   }
@@ -450,12 +452,9 @@ bool MSimEvent::ParseLine(MString LineBuffer, int Version)
   }
   // Add bad event flags
   else if (LineBuffer[0] == 'B' && LineBuffer[1] == 'D') {
-    istringstream iss(LineBuffer.GetString());
-    string s;
-    while (getline(iss, s, ' ')) {
-      if (s != "BD" && s != " " && s != "") {
-        m_BDs.push_back(s);
-      }
+    m_Tokenizer.Analyze(LineBuffer);
+    for (unsigned int t = 1; t < m_Tokenizer.GetNTokens(); ++t) {
+      m_BDs.push_back(m_Tokenizer.GetTokenAtAsString(t));
     }
   }
   // Add comment
@@ -464,13 +463,15 @@ bool MSimEvent::ParseLine(MString LineBuffer, int Version)
   }
   // Add total detector energy:
   else if (LineBuffer[0] == 'X' && LineBuffer[1] == 'E') {
-    double x, y, z, E;
-    if (sscanf(LineBuffer.Data(), "XE %lf;%lf;%lf;%lf\n", &x, &y, &z, &E) != 4) {
+    double Values[4];
+    const char* Position = LineBuffer.Data() + 2;
+    if (MFastTokenizer::ParseDoubles(Position, LineBuffer.Data() + LineBuffer.Length(), Values, 4, ';') != 4) {
       mout<<"Error during scanning of sim file in token XE:"<<endl;
       mout<<"  "<<LineBuffer<<endl;
       Ret = false;
+    } else {
+      m_TotalDetectorEnergy[MVector(Values[0], Values[1], Values[2])] += Values[3];
     }
-    m_TotalDetectorEnergy[MVector(x, y, z)] += E;
   }
   // Add the time:
   else if (LineBuffer[0] == 'T' && LineBuffer[1] == 'I') {
@@ -482,7 +483,8 @@ bool MSimEvent::ParseLine(MString LineBuffer, int Version)
   }
   // Add TOF:
   else if (LineBuffer[0] == 'T' && LineBuffer[1] == 'F') {
-    if (sscanf(LineBuffer.Data(), "TF%lf\n",&m_TOF) != 1) {
+    const char* Position = LineBuffer.Data() + 2;
+    if (MFastTokenizer::ParseDouble(Position, LineBuffer.Data() + LineBuffer.Length(), m_TOF) == false) {
       mout<<"Error during scanning of sim file in token TF:"<<endl;
       mout<<"  "<<LineBuffer<<endl;
       Ret = false;
@@ -490,9 +492,10 @@ bool MSimEvent::ParseLine(MString LineBuffer, int Version)
   }
   // Add Veto:
   else if (LineBuffer[0] == 'V' && LineBuffer[1] == 'T') {
-    double E1, E2, E3, E4;
-    if (sscanf(LineBuffer.Data(), "VT%lf;%lf;%lf;%lf\n", &E1, &E2, &E3, &E4) == 4) {
-      if (E1 > 100 || E2 > 100 || E3 > 100 || E4 > 100) {
+    double E[4];
+    const char* Position = LineBuffer.Data() + 2;
+    if (MFastTokenizer::ParseDoubles(Position, LineBuffer.Data() + LineBuffer.Length(), E, 4, ';') == 4) {
+      if (E[0] > 100 || E[1] > 100 || E[2] > 100 || E[3] > 100) {
         m_Veto = true;
       } else {
         m_Veto = false;
@@ -3515,20 +3518,22 @@ MString MSimEvent::ToSimString(const int WhatToStore, const int Precision, const
 {
   // Convert this SimEvent to the original *.sim file format...
 
-  ostringstream out;
-  out<<"SE"<<endl;
-  out<<"ID "<<m_NEvent<<" "<<m_NStartedEvent<<endl;
+  // The numbers are formatted directly and not via streams, the output is identical
+  MString out;
+  out.Reserve(256*(m_IAs.size() + m_HTs.size() + 4));
+  out += "SE\n";
+  out += "ID "; out += m_NEvent; out += ' '; out += m_NStartedEvent; out += '\n';
   if (m_Veto == true) {
-    out<<"VT"<<endl;
+    out += "VT\n";
   } else {
-    out<<"TI "<<m_Time.GetLongIntsString()<<endl;
+    out += "TI "; out += m_Time.GetLongIntsString(); out += '\n';
     
     if (m_BDs.size() > 0) {
-      out<<"BD ";
+      out += "BD ";
       for (unsigned int b = 0; b < m_BDs.size(); ++b) {
-        out<<m_BDs[b]<<" "; 
+        out += m_BDs[b]; out += ' '; 
       }
-      out<<endl;
+      out += '\n';
     }
     
     MRotationInterface::Stream(out);
@@ -3542,7 +3547,7 @@ MString MSimEvent::ToSimString(const int WhatToStore, const int Precision, const
       for (unsigned int i = 0; i < GetNGRs(); ++i) {
         ED += GetGRAt(i)->GetEnergy();
       }
-      out<<"ED "<<ED<<endl;
+      out += "ED "; out.AppendGeneral(ED); out += '\n';
       
       // The EC keyword (Escapes)
       double EC = 0.0;
@@ -3551,23 +3556,23 @@ MString MSimEvent::ToSimString(const int WhatToStore, const int Precision, const
           EC += GetIAAt(i)->GetMotherEnergy();
         }
       }
-      out<<"EC "<<EC<<endl;
+      out += "EC "; out.AppendGeneral(EC); out += '\n';
       
       // Deposits in not sensitive material - summary
       double NS = 0.0;
       for (unsigned int i = 0; i < GetNPMs(); ++i) {
         NS += GetPMAt(i)->GetEnergy();
       }
-      out<<"NS "<<NS<<endl;
+      out += "NS "; out.AppendGeneral(NS); out += '\n';
       
       // Deposits in not sensitive material - detailed
       for (unsigned int i = 0; i < GetNPMs(); ++i) {
-        out<<GetPMAt(i)->ToSimString(WhatToStore, Precision, Version)<<endl;;
+        out += GetPMAt(i)->ToSimString(WhatToStore, Precision, Version); out += '\n';
       }
       
       // Comments
       for (unsigned int c = 0; c < m_CCs.size(); ++c) {
-        out<<"CC "<<m_CCs[c]<<endl; 
+        out += "CC "; out += m_CCs[c]; out += '\n'; 
       }
     }
 
@@ -3580,27 +3585,27 @@ MString MSimEvent::ToSimString(const int WhatToStore, const int Precision, const
             WhatToStore == c_StoreSimulationInfoInitOnly) {
           continue;
         }
-        out<<GetIAAt(i)->ToSimString(WhatToStore, Precision, Version)<<endl;
+        out += GetIAAt(i)->ToSimString(WhatToStore, Precision, Version); out += '\n';
       }
     }
     if (WhatToStore != c_StoreSimulationInfoIAOnly) {
       for (unsigned int i = 0; i < GetNHTs(); ++i) {
-        out<<GetHTAt(i)->ToSimString(WhatToStore, Precision, Version)<<endl;
+        out += GetHTAt(i)->ToSimString(WhatToStore, Precision, Version); out += '\n';
       }
 
       for (unsigned int i = 0; i < GetNGRs(); ++i) {
-        out<<GetGRAt(i)->ToSimString(WhatToStore, Precision, Version)<<endl;
+        out += GetGRAt(i)->ToSimString(WhatToStore, Precision, Version); out += '\n';
       }
 
       map<MVector, double>::iterator Iter;
       for (Iter = m_TotalDetectorEnergy.begin();
            Iter != m_TotalDetectorEnergy.end(); ++Iter) {
         mimp<<"XE only hacked!!! --- But anyway not used..."<<endl;
-        out<<"XE "<<(*Iter).first.X()<<";"<<(*Iter).first.Y()<<";"<<(*Iter).first.Z()<<";"<<(*Iter).second<<endl;
+        out += "XE "; out.AppendGeneral((*Iter).first.X()); out += ';'; out.AppendGeneral((*Iter).first.Y()); out += ';'; out.AppendGeneral((*Iter).first.Z()); out += ';'; out.AppendGeneral((*Iter).second); out += '\n';
       }
 
       for (unsigned int i = 0; i < GetNDRs(); ++i) {
-        out<<GetDRAt(i)->ToSimString(WhatToStore, Precision, Version)<<endl;
+        out += GetDRAt(i)->ToSimString(WhatToStore, Precision, Version); out += '\n';
       }
     }
   }
@@ -37,6 +37,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MFastTokenizer.h"
 #include "MSimEvent.h"
 
 
@@ -166,9 +167,11 @@ void MSimHT::Set(const int Detector, const MVector& Position, const double Energ
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool MSimHT::AddRawInput(MString LineBuffer, int Version)
+bool MSimHT::AddRawInput(const MString& LineBuffer, int Version)
 {
   // Analyze one line of text input...
+  // The layout is fixed: "HTsim" or "HT", the detector type, position, energy, (time), (uncertainties), origins -- all separated by ";"
+  // Thus we parse it directly instead of going through sscanf and repeated sub-string copies for the origins
 
   // Handle the most common MEGAlib 2.x sim / evta file versions
   if (Version == 25 && LineBuffer.BeginsWith("HTsim ")) {
@@ -177,68 +180,57 @@ bool MSimHT::AddRawInput(MString LineBuffer, int Version)
     Version = 200;
   }
 
+  const char* Position = LineBuffer.Data();
+  const char* End = Position + LineBuffer.Length();
 
-  int Reads = 0;
+  unsigned int NValues = 0;
+  bool HasTime = false;
   if (Version == 100) { // No time
-    if (sscanf(LineBuffer.Data(), "HTsim %d;%lf;%lf;%lf;%lf",
-               &m_DetectorType, &m_Position[0], &m_Position[1], &m_Position[2], &m_Energy) != 6) {
-      mout<<"MSimHT: Unable to parse hit of version "<<Version<<": "<<LineBuffer<<endl;
-      return false;
-    }
-    Reads = 5;
+    if (LineBuffer.BeginsWith("HTsim") == false) return false;
+    Position += 5;
+    NValues = 4;
   } else if (Version == 101) { // with time 
-    if (sscanf(LineBuffer.Data(), "HTsim %d;%lf;%lf;%lf;%lf;%lf",
-               &m_DetectorType, &m_Position[0], &m_Position[1], &m_Position[2], &m_Energy, &m_Time) != 6) {
-      mout<<"MSimHT: Unable to parse hit of version "<<Version<<": "<<LineBuffer<<endl;
-      return false;
-    }
-    Reads = 6;
+    if (LineBuffer.BeginsWith("HTsim") == false) return false;
+    Position += 5;
+    NValues = 5;
+    HasTime = true;
   } else if (Version == 200) { // no time, with uncertainties
-    double dx,dy,dz,dE;
-    if (sscanf(LineBuffer.Data(), "HT %d;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf",
-               &m_DetectorType, &m_Position[0], &m_Position[1], &m_Position[2], &m_Energy, &dx, &dy, &dz, &dE) != 9) {
-      mout<<"MSimHT: Unable to parse hit of version "<<Version<<": "<<LineBuffer<<endl;
-      return false;
-    }
-    m_Time = 0;
-    Reads = 9;
+    if (LineBuffer.BeginsWith("HT") == false) return false;
+    Position += 2;
+    NValues = 8;
   } else if (Version == 201) {// with time & uncertainties
-    double dx, dy, dz, dE, dT;
-    if (sscanf(LineBuffer.Data(), "HT %d;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf",
-               &m_DetectorType, &m_Position[0], &m_Position[1], &m_Position[2], &m_Energy, &m_Time, &dx, &dy, &dz, &dE, &dT) != 11) {
-      mout<<"MSimHT: Unable to parse hit of version "<<Version<<": "<<LineBuffer<<endl;
-      return false;
-    }
-    Reads = 10;
+    if (LineBuffer.BeginsWith("HT") == false) return false;
+    Position += 2;
+    NValues = 10;
+    HasTime = true;
   } else {
     merr<<"Unknown version of sim/evta file (version: "<<Version<<"), please upgrade (or use old version of MEGAlib prior to 3.0)"<<endl;
     return false;
   }
+
+  double Values[10];
+  if (MFastTokenizer::ParseInt(Position, End, m_DetectorType) == false ||
+      MFastTokenizer::ParseDoubles(Position, End, Values, NValues, ';') != NValues) {
+    mout<<"MSimHT: Unable to parse hit of version "<<Version<<": "<<LineBuffer<<endl;
+    return false;
+  }
+  m_Position.SetXYZ(Values[0], Values[1], Values[2]);
+  m_Energy = Values[3];
+  m_Time = (HasTime == true) ? Values[4] : 0;
   
   m_OriginalPosition = m_Position;
   m_OriginalEnergy = m_Energy;
   m_OriginalTime = m_Time;
 
-  // Remove everything but the (variable) origin part...
-  MString Origin(LineBuffer);
-  for (int i = 0; i < Reads; ++i) {
-    if (Origin.First(';') == MString::npos) {
-      Origin = "";
-    } else {
-      Origin.Remove(0, Origin.First(';')+1);
-    }
-  }
-
-  // Search for the number of origins:
-  int OriginIA = 0;
+  // The remaining (variable) part are the origins - as before there is always at least one:
   m_Origins.clear();
-  while (Origin.First(';') != MString::npos) {
-    sscanf((char *) Origin.Data(), "%d", &OriginIA);
+  int OriginIA = 0;
+  while (MFastTokenizer::ParseInt(Position, End, OriginIA, ';') == true) {
     m_Origins.push_back(OriginIA);
-    Origin.Remove(0, Origin.First(';')+1);
   }
-  sscanf((char *) Origin.Data(), "%d", &OriginIA); 
-  m_Origins.push_back(OriginIA);
+  if (m_Origins.size() == 0) {
+    m_Origins.push_back(0);
+  }
 
   // Reset to calculate the volume sequence:
   if (Noise(true) == false) {
@@ -375,7 +367,8 @@ MString MSimHT::ToSimString(const int WhatToStore, const int ScientificPrecision
   // If there is a significant change, make sure you make new sim version,
   // and update all reading functions
 
-  ostringstream S;
+  // This is called for every hit, thus the numbers are formatted directly and not via streams
+  // The output is identical to fixed/scientific, setprecision and setw of an ostream
 
   int WidthPos;
   int WidthEnergy;
@@ -386,26 +379,40 @@ MString MSimHT::ToSimString(const int WhatToStore, const int ScientificPrecision
     WidthEnergy = ScientificPrecision+6;
     WidthTime = ScientificPrecision+6;
     Precision = ScientificPrecision;
-    S.setf(ios_base::scientific, ios_base::floatfield);
   } else {
     WidthPos = 10;
     WidthEnergy = 10;
     WidthTime = 11;
     Precision = 5;
-    S.setf(ios_base::fixed, ios_base::floatfield);
   }
 
-  S<<"HTsim "<<m_DetectorType<<";";
-  S<<setprecision(Precision);
-  S<<setw(WidthPos)<<m_Position[0]<<";";
-  S<<setw(WidthPos)<<m_Position[1]<<";";
-  S<<setw(WidthPos)<<m_Position[2]<<";";
-  S<<setw(WidthEnergy)<<m_Energy<<";";
-  S<<scientific;
-  S<<setw(WidthTime)<<m_Time;
+  MString S;
+  S.Reserve(128);
+  
+  auto AppendReal = [&S, ScientificPrecision, Precision](double Value, int Width) {
+    if (ScientificPrecision > 0) {
+      S.AppendScientific(Value, Precision, Width);
+    } else {
+      S.AppendFixed(Value, Precision, Width);
+    }
+  };
+
+  S += "HTsim ";
+  S += m_DetectorType;
+  S += ';';
+  AppendReal(m_Position[0], WidthPos);
+  S += ';';
+  AppendReal(m_Position[1], WidthPos);
+  S += ';';
+  AppendReal(m_Position[2], WidthPos);
+  S += ';';
+  AppendReal(m_Energy, WidthEnergy);
+  S += ';';
+  S.AppendScientific(m_Time, Precision, WidthTime);
   if (WhatToStore == MSimEvent::c_StoreSimulationInfoAll) {
     for (unsigned int o = 0; o < m_Origins.size(); ++o) {
-      S<<";"<<m_Origins[o];
+      S += ';';
+      S += m_Origins[o];
     }
   }
 
@@ -35,6 +35,7 @@ using namespace std;
 // MEGAlib libs:
 #include "MAssert.h"
 #include "MStreams.h"
+#include "MFastTokenizer.h"
 
 #ifdef ___CLING___
 ClassImp(MSimIA)
@@ -107,11 +108,10 @@ MSimIA::~MSimIA()
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool MSimIA::AddRawInput(MString LineBuffer, int Version)
+bool MSimIA::AddRawInput(const MString& LineBuffer, int Version)
 {
   // Analyze one line of text input...
-
-  char Type[10] = "????\0";
+  // The layout is fixed: "IA", the process, and then 23 values separated by ";"
 
   // Handle the most common MEGAlib 2.x sim / evta file versions
   if (Version == 25) {
@@ -121,34 +121,45 @@ bool MSimIA::AddRawInput(MString LineBuffer, int Version)
   }
 
   if (Version == 101 || Version == 100 || Version == 200 || Version == 201) {
-    if (sscanf(LineBuffer.Data(), "IA %4s %d;%d;%d;%lf;%lf;%lf;%lf;%d;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%d;%lf;%lf;%lf;%lf;%lf;%lf;%lf",
-               Type, 
-               &m_ID, 
-               &m_OriginID, 
-               &m_DetectorType, 
-               &m_Time,
-               &m_Position[0], 
-               &m_Position[1], 
-               &m_Position[2], 
-               &m_MotherParticleID, 
-               &m_MotherParticleDirection[0], 
-               &m_MotherParticleDirection[1], 
-               &m_MotherParticleDirection[2], 
-               &m_MotherParticlePolarisation[0], 
-               &m_MotherParticlePolarisation[1], 
-               &m_MotherParticlePolarisation[2], 
-               &m_MotherParticleEnergy,
-               &m_SecondaryParticleID, 
-               &m_SecondaryParticleDirection[0], 
-               &m_SecondaryParticleDirection[1], 
-               &m_SecondaryParticleDirection[2], 
-               &m_SecondaryParticlePolarisation[0], 
-               &m_SecondaryParticlePolarisation[1], 
-               &m_SecondaryParticlePolarisation[2], 
-               &m_SecondaryParticleEnergy) != 24) {
+    if (LineBuffer.Length() < 4 || LineBuffer[0] != 'I' || LineBuffer[1] != 'A') return false;
+
+    const char* Position = LineBuffer.Data() + 2;
+    const char* End = LineBuffer.Data() + LineBuffer.Length();
+
+    // The process - at most 4 characters like the original "%4s"
+    while (Position < End && (*Position == ' ' || *Position == '\t')) ++Position;
+    const char* TypeStart = Position;
+    while (Position < End && Position - TypeStart < 4 && *Position != ' ' && *Position != '\t' && *Position != '\n') ++Position;
+    const char* TypeEnd = Position;
+    if (TypeEnd == TypeStart) return false;
+
+    double Values[7];
+    if (MFastTokenizer::ParseInt(Position, End, m_ID) == false ||
+        MFastTokenizer::ParseInt(Position, End, m_OriginID, ';') == false ||
+        MFastTokenizer::ParseInt(Position, End, m_DetectorType, ';') == false ||
+        MFastTokenizer::ParseDouble(Position, End, m_Time, ';') == false ||
+        MFastTokenizer::ParseDoubles(Position, End, Values, 3, ';') != 3) {
+      return false;
+    }
+    m_Position.SetXYZ(Values[0], Values[1], Values[2]);
+
+    if (MFastTokenizer::ParseInt(Position, End, m_MotherParticleID, ';') == false ||
+        MFastTokenizer::ParseDoubles(Position, End, Values, 7, ';') != 7) {
+      return false;
+    }
+    m_MotherParticleDirection.SetXYZ(Values[0], Values[1], Values[2]);
+    m_MotherParticlePolarisation.SetXYZ(Values[3], Values[4], Values[5]);
+    m_MotherParticleEnergy = Values[6];
+
+    if (MFastTokenizer::ParseInt(Position, End, m_SecondaryParticleID, ';') == false ||
+        MFastTokenizer::ParseDoubles(Position, End, Values, 7, ';') != 7) {
       return false;
     }
-    m_Process = MString(Type);
+    m_SecondaryParticleDirection.SetXYZ(Values[0], Values[1], Values[2]);
+    m_SecondaryParticlePolarisation.SetXYZ(Values[3], Values[4], Values[5]);
+    m_SecondaryParticleEnergy = Values[6];
+
+    m_Process = MString(TypeStart, TypeEnd - TypeStart);
   } else {
     merr<<"Unknown version of sim/evta file (version: "<<Version<<"), please upgrade (or use old version of MEGAlib prior to 3.0)"<<endl;
     return false;
@@ -225,62 +236,76 @@ MString MSimIA::ToSimString(const int WhatToStore, const int ScientificPrecision
     PrecisionTime   = 12;
   }
 
-  ostringstream Text;
-  Text.setf(ios_base::fixed, ios_base::floatfield);
-  Text.precision(4);
+  // This is called for every interaction, thus the numbers are formatted directly and not via streams
+  // The output is identical to fixed/scientific, setprecision and setw of an ostream
+  MString Text;
+  Text.Reserve(256);
 
-  // The compact version
+  auto AppendReal = [&Text, ScientificPrecision](double Value, int Precision, int Width) {
+    if (ScientificPrecision != 0) {
+      Text.AppendScientific(Value, Precision, Width);
+    } else {
+      Text.AppendFixed(Value, Precision, Width);
+    }
+  };
+
+  Text += "IA ";
+  Text += m_Process;
+  Text += ' ';
+  Text.AppendInteger(m_ID, 2);
+  Text += ';';
+  Text.AppendInteger(m_OriginID, 2);
+  Text += ';';
+  Text += m_DetectorType;
+  Text += ';';
+  // The compact version has no time
+  if (Version != 15) {
+    Text.AppendScientific(m_Time, PrecisionTime, WidthTime);
+    Text += ';';
+  }
+  AppendReal(m_Position[0], PrecisionPos, WidthPos);
+  Text += ';';
+  AppendReal(m_Position[1], PrecisionPos, WidthPos);
+  Text += ';';
+  AppendReal(m_Position[2], PrecisionPos, WidthPos);
+  Text += ';';
+  Text += m_MotherParticleID;
+  Text += ';';
+  AppendReal(m_MotherParticleDirection[0], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_MotherParticleDirection[1], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_MotherParticleDirection[2], PrecisionDir, WidthDir);
+  Text += ';';
+  // The compact version ends with the energy of the mother particle
   if (Version == 15) {
-    Text<<"IA "<<m_Process<<" "
-        <<setw(2)<<m_ID<<";"
-        <<setw(2)<<m_OriginID<<";"
-        <<setw(1)<<m_DetectorType<<";"
-        <<((ScientificPrecision == 0) ? fixed : scientific)
-        <<setprecision(PrecisionPos)
-        <<setw(WidthPos)<<m_Position[0]<<";"
-        <<setw(WidthPos)<<m_Position[1]<<";"
-        <<setw(WidthPos)<<m_Position[2]<<";"
-        <<setw(1)<<m_MotherParticleID<<";"
-        <<setprecision(PrecisionDir)
-        <<setw(WidthDir)<<m_MotherParticleDirection[0]<<";"
-        <<setw(WidthDir)<<m_MotherParticleDirection[1]<<";"
-        <<setw(WidthDir)<<m_MotherParticleDirection[2]<<";"
-        <<setprecision(PrecisionEnergy)
-        <<setw(WidthEnergy)<<m_MotherParticleEnergy;  
-   } 
-  // The standard version given in MSimEvent::g_OutputVersion
-  else {
-    Text<<"IA "<<m_Process<<" "
-        <<setw(2)<<m_ID<<";"
-        <<setw(2)<<m_OriginID<<";"
-        <<setw(1)<<m_DetectorType<<";"
-        <<scientific<<setprecision(PrecisionTime)<<setw(WidthTime)<<m_Time<<";"
-        <<((ScientificPrecision == 0) ? fixed : scientific)
-        <<setprecision(PrecisionPos)
-        <<setw(WidthPos)<<m_Position[0]<<";"
-        <<setw(WidthPos)<<m_Position[1]<<";"
-        <<setw(WidthPos)<<m_Position[2]<<";"
-        <<setw(1)<<m_MotherParticleID<<";"
-        <<setprecision(PrecisionDir)
-        <<setw(WidthDir)<<m_MotherParticleDirection[0]<<";"
-        <<setw(WidthDir)<<m_MotherParticleDirection[1]<<";"
-        <<setw(WidthDir)<<m_MotherParticleDirection[2]<<";"
-        <<setw(WidthDir)<<m_MotherParticlePolarisation[0]<<";"
-        <<setw(WidthDir)<<m_MotherParticlePolarisation[1]<<";"
-        <<setw(WidthDir)<<m_MotherParticlePolarisation[2]<<";"
-        <<setprecision(PrecisionEnergy)
-        <<setw(WidthEnergy)<<m_MotherParticleEnergy<<";"
-        <<setw(1)<<m_SecondaryParticleID<<";"
-        <<setprecision(PrecisionDir)
-        <<setw(WidthDir)<<m_SecondaryParticleDirection[0]<<";"
-        <<setw(WidthDir)<<m_SecondaryParticleDirection[1]<<";"
-        <<setw(WidthDir)<<m_SecondaryParticleDirection[2]<<";"
-        <<setw(WidthDir)<<m_SecondaryParticlePolarisation[0]<<";"
-        <<setw(WidthDir)<<m_SecondaryParticlePolarisation[1]<<";"
-        <<setw(WidthDir)<<m_SecondaryParticlePolarisation[2]<<";"
-        <<setprecision(PrecisionEnergy)
-        <<setw(WidthEnergy)<<m_SecondaryParticleEnergy;
+    AppendReal(m_MotherParticleEnergy, PrecisionEnergy, WidthEnergy);
+    return Text;
   }
+  // The standard version given in MSimEvent::g_OutputVersion
+  AppendReal(m_MotherParticlePolarisation[0], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_MotherParticlePolarisation[1], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_MotherParticlePolarisation[2], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_MotherParticleEnergy, PrecisionEnergy, WidthEnergy);
+  Text += ';';
+  Text += m_SecondaryParticleID;
+  Text += ';';
+  AppendReal(m_SecondaryParticleDirection[0], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticleDirection[1], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticleDirection[2], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticlePolarisation[0], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticlePolarisation[1], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticlePolarisation[2], PrecisionDir, WidthDir);
+  Text += ';';
+  AppendReal(m_SecondaryParticleEnergy, PrecisionEnergy, WidthEnergy);
 
   return Text;
 }
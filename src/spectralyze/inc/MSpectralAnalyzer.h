@@ -87,6 +87,8 @@ class MSpectralAnalyzer
   bool FillSpectrum(double Energy);
   //! Adds the given energies to an existing (!) spectrum
   bool FillSpectrum(vector<double> Energy);
+  //! Removes the given energy from an existing (!) spectrum, e.g. when it falls out of an accumulation window
+  bool RemoveFromSpectrum(double Energy);
   //! Resets the spectrum
   void ResetSpectrum();
   
@@ -111,6 +113,12 @@ class MSpectralAnalyzer
   
   // Interface to run the analysis
 
+  //! Incremental mode for repeated identifications on an evolving spectrum: 
+  //! The evaluation (background, peak fit) of a peak region is only redone if its counts changed significantly
+  void UseIncrementalMode(bool Incremental) { m_IsIncremental = Incremental; m_PeakRegions.clear(); }
+  //! Redo the evaluation of a peak region if its counts changed by more than this number of Poisson sigmas (incremental mode)
+  void SetRefitThreshold(double Sigmas) { m_RefitThreshold = Sigmas; }
+
   //! Do all the analysis and find the peaks & isotopes
   bool FindIsotopes();
   
@@ -136,7 +144,10 @@ class MSpectralAnalyzer
 
   // private methods:
  private:
-
+  //! Clear the peaks and isotopes found by the last analysis
+  void ResetResults();
+  //! Build the energy-sorted index of all lines of all comparison isotopes
+  void BuildLineIndex();
 
 
   // protected members:
@@ -180,6 +191,37 @@ class MSpectralAnalyzer
   //! the list of found isotopes
   vector<MQualifiedIsotope*> m_ComparisonIsotopes;
 
+  //! A line of a comparison isotope in the energy-sorted line index
+  struct MLineIndexEntry {
+    //! The line energy
+    double m_Energy;
+    //! The index of the isotope in m_ComparisonIsotopes
+    unsigned int m_Isotope;
+    //! The line ID in the isotope
+    unsigned int m_Line;
+  };
+  //! All lines of all comparison isotopes sorted by energy
+  vector<MLineIndexEntry> m_LineIndex;
+
+  //! The cached evaluation of a peak region
+  struct MPeakRegion {
+    //! The bin of the peak candidate
+    int m_Bin;
+    //! The counts in the background window of the peak at the time of the evaluation
+    double m_RegionCounts;
+    //! True if the fitted peak width is compatible with the detector resolution
+    bool m_WidthAccepted;
+    //! The estimated background counts in the peak
+    double m_BackgroundCounts;
+  };
+
+  //! True if we are in incremental mode
+  bool m_IsIncremental;
+  //! The number of Poisson sigmas the counts in a peak region have to change to redo its evaluation
+  double m_RefitThreshold;
+  //! The peak regions evaluated in the last analysis (incremental mode)
+  vector<MPeakRegion> m_PeakRegions;
+
 
 #ifdef ___CLING___
  public:
@@ -61,6 +61,9 @@ MSpectralAnalyzer::MSpectralAnalyzer()
   
   m_InitialSpectrum = 0;
   m_IsBatch = false;
+
+  m_IsIncremental = false;
+  m_RefitThreshold = 3.0;
 }
 
 
@@ -89,6 +92,20 @@ bool MSpectralAnalyzer::Reset()
   delete m_InitialSpectrum;
   m_InitialSpectrum = 0;
   
+  ResetResults();
+  m_PeakRegions.clear();
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSpectralAnalyzer::ResetResults()
+{
+  //! Clear the peaks and isotopes found by the last analysis
+  
   m_Isotopes.clear();
   for (unsigned int p = 0; p < m_Peaks.size(); ++p) {
     delete m_Peaks[p];  
@@ -100,8 +117,6 @@ bool MSpectralAnalyzer::Reset()
       m_ComparisonIsotopes[i]->SetLineFound(l, false);
     }
   }
-
-  return true;
 }
 
 
@@ -210,6 +225,7 @@ bool MSpectralAnalyzer::SetSpectrum(int NBins, double EnergyMin, double EnergyMa
     
 
   // Create histogram
+  m_PeakRegions.clear();
   m_InitialSpectrum = new TH1D("InitialSpectrum", "Initial Spectrum", NBins, Bins);
   m_InitialSpectrum->SetStats(false);
   m_InitialSpectrum->SetXTitle("Energy [keV]");
@@ -264,11 +280,27 @@ bool MSpectralAnalyzer::FillSpectrum(vector<double> Energies)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool MSpectralAnalyzer::RemoveFromSpectrum(double Energy)
+{
+  //! Removes the given energy from an existing (!) spectrum, e.g. when it falls out of an accumulation window
+  
+  if (m_InitialSpectrum == 0) return false;
+  
+  m_InitialSpectrum->Fill(Energy, -1.0);
+  
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void MSpectralAnalyzer::ResetSpectrum()
 {
   //! Resets the spectrum
   
   m_InitialSpectrum->Reset();
+  m_PeakRegions.clear();
 }
 
 
@@ -322,9 +354,28 @@ bool MSpectralAnalyzer::SetIsotopeFileName(MString IsotopeFileName)
   //  cout<<*m_ComparisonIsotopes[i];
   //}
   
+  BuildLineIndex();
+  
   return true;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void MSpectralAnalyzer::BuildLineIndex()
+{
+  //! Build the energy-sorted index of all lines of all comparison isotopes
+  
+  m_LineIndex.clear();
+  for (unsigned int i = 0; i < m_ComparisonIsotopes.size(); ++i) {
+    for (unsigned int l = 0; l < m_ComparisonIsotopes[i]->GetNLines(); ++l) {
+      m_LineIndex.push_back({ m_ComparisonIsotopes[i]->GetLineEnergy(l), i, l });
+    }
+  }
+  sort(m_LineIndex.begin(), m_LineIndex.end(), [](const MLineIndexEntry& A, const MLineIndexEntry& B) { return A.m_Energy < B.m_Energy; });
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 
@@ -372,6 +423,9 @@ bool MSpectralAnalyzer::FindIsotopes()
     return false;
   }
   
+  // Start from scratch in case this is a repeated analysis of an evolving spectrum
+  ResetResults();
+  
 
   TH1D* PeakHist = new TH1D(*m_InitialSpectrum);
   PeakHist->SetTitle("PeakHist");
@@ -423,6 +477,7 @@ bool MSpectralAnalyzer::FindIsotopes()
   
   // Step 2: Get peak energies, detector energy resolutions, etc. at the peaks
  
+  vector<MPeakRegion> NewPeakRegions;
   for (int p = 0; p < NPeaksFound; ++p) {
     double PeakEnergy = PeakEnergies[p];
     double PeakBinContent = PeakHist->GetBinContent(PeakHist->GetXaxis()->FindBin(PeakEnergy));  // <- That's definitely wrong -- need to integrate!!
@@ -438,104 +493,139 @@ bool MSpectralAnalyzer::FindIsotopes()
     // Upper limit whould include Compton peak belong to this peak just in case this is a Compton edge...
     double BackgroundMax = PeakEnergy + max(12*PeakOneSigmaWidth, 6*PeakOneSigmaWidth + 0.5*(PeakEnergy + sqrt(PeakEnergy*PeakEnergy + 2*c_E0*PeakEnergy)));
 
+    // Determine all counts
+    int PeakShapeMin = PeakHist->GetXaxis()->FindBin(PeakEnergy - 1.4*PeakOneSigmaWidth);
+    int PeakShapeMax = PeakHist->GetXaxis()->FindBin(PeakEnergy + 1.4*PeakOneSigmaWidth);
+    double IntegralTotalCounts = m_InitialSpectrum->Integral(PeakShapeMin, PeakShapeMax);
+    double IntegralBackgroundCounts = 0.0;
+
+    // In incremental mode, reuse the evaluation of this region if its counts did not change significantly
+    double RegionCounts = m_InitialSpectrum->Integral(m_InitialSpectrum->FindBin(BackgroundMin), m_InitialSpectrum->FindBin(BackgroundMax));
+    MPeakRegion Region;
+    Region.m_Bin = PeakHist->GetXaxis()->FindBin(PeakEnergy);
+    Region.m_RegionCounts = RegionCounts;
+    Region.m_WidthAccepted = false;
+    Region.m_BackgroundCounts = 0.0;
+    bool IsCached = false;
+    if (m_IsIncremental == true) {
+      for (const MPeakRegion& Cached: m_PeakRegions) {
+        if (Cached.m_Bin == Region.m_Bin && fabs(RegionCounts - Cached.m_RegionCounts) <= m_RefitThreshold*sqrt(max(Cached.m_RegionCounts, 1.0))) {
+          // Keep the counts of the original evaluation as reference, thus slow drifts accumulate until they trigger a refit
+          Region = Cached;
+          IsCached = true;
+          break;
+        }
+      }
+    }
     
-    /* eliminate background estimate errors where energy falls to 0 below threshold
-     * EnergyMin is first energy above threshold
-     * could find with detector thresholds in geometry file? */
+    if (IsCached == true) {
+      NewPeakRegions.push_back(Region);
+      if (Region.m_WidthAccepted == false) continue;
+      // Scale the background estimate to the current counts in the region
+      IntegralBackgroundCounts = Region.m_BackgroundCounts;
+      if (Region.m_RegionCounts > 0) IntegralBackgroundCounts *= RegionCounts/Region.m_RegionCounts;
+    } else {
+      /* eliminate background estimate errors where energy falls to 0 below threshold
+       * EnergyMin is first energy above threshold
+       * could find with detector thresholds in geometry file? */
     
-    double LowEnd = 0;
-    double HighEnd = 0;
-    double EnergyMin = 0;
-
-    if (PeakEnergy > 50) {
-      LowEnd = BackgroundMin;
-    } else if (PeakEnergy < 50) {
-      EnergyMin = m_InitialSpectrum->GetBinContent(m_InitialSpectrum->FindBin(BackgroundMin));
-      if (EnergyMin > 1) {
+      double LowEnd = 0;
+      double HighEnd = 0;
+      double EnergyMin = 0;
+
+      if (PeakEnergy > 50) {
         LowEnd = BackgroundMin;
-      }
-      else if (EnergyMin < 1) {
-        for (double i = BackgroundMin; i < PeakEnergy; i++){
-          double set = m_InitialSpectrum->GetBinContent(m_InitialSpectrum->FindBin(i));
-          if (set < 1) {
-            continue;
-          }
-          else if (set > 1) {
-            LowEnd = i;
-            break;
+      } else if (PeakEnergy < 50) {
+        EnergyMin = m_InitialSpectrum->GetBinContent(m_InitialSpectrum->FindBin(BackgroundMin));
+        if (EnergyMin > 1) {
+          LowEnd = BackgroundMin;
+        }
+        else if (EnergyMin < 1) {
+          for (double i = BackgroundMin; i < PeakEnergy; i++){
+            double set = m_InitialSpectrum->GetBinContent(m_InitialSpectrum->FindBin(i));
+            if (set < 1) {
+              continue;
+            }
+            else if (set > 1) {
+              LowEnd = i;
+              break;
+            }
           }
         }
       }
-    }
     
           
-    // check this           
-    double EnergyMax = m_InitialSpectrum->GetMaximumBin();
-    if (BackgroundMax < EnergyMax) {
-      HighEnd = BackgroundMax;
-    } else if (BackgroundMax > EnergyMax) {
-      HighEnd = EnergyMax;
-    }
+      // check this           
+      double EnergyMax = m_InitialSpectrum->GetMaximumBin();
+      if (BackgroundMax < EnergyMax) {
+        HighEnd = BackgroundMax;
+      } else if (BackgroundMax > EnergyMax) {
+        HighEnd = EnergyMax;
+      }
     
-    // set clipping window for bkgrd, roughly 2*FWHM
-    //int Bkgrdsigma = (2.355*PeakOneSigmaWidth);
+      // set clipping window for bkgrd, roughly 2*FWHM
+      //int Bkgrdsigma = (2.355*PeakOneSigmaWidth);
     
-    BkgrdHist->GetXaxis()->SetRange(BkgrdHist->GetXaxis()->FindBin(LowEnd), BkgrdHist->GetXaxis()->FindBin(HighEnd));
+      BkgrdHist->GetXaxis()->SetRange(BkgrdHist->GetXaxis()->FindBin(LowEnd), BkgrdHist->GetXaxis()->FindBin(HighEnd));
     
-    TH1* BackgroundHist = PeakFinder->Background(BkgrdHist, 20, "BackSmoothing3 BackOrder8 Compton"); //Bkgrdsigma, "Compton" "R" "+");
-    BackgroundHist->GetXaxis()->SetRange(BackgroundHist->GetXaxis()->FindBin(BackgroundMin), BackgroundHist->GetXaxis()->FindBin(BackgroundMax));
+      TH1* BackgroundHist = PeakFinder->Background(BkgrdHist, 20, "BackSmoothing3 BackOrder8 Compton"); //Bkgrdsigma, "Compton" "R" "+");
+      BackgroundHist->GetXaxis()->SetRange(BackgroundHist->GetXaxis()->FindBin(BackgroundMin), BackgroundHist->GetXaxis()->FindBin(BackgroundMax));
     
-    // Fit to compare to estimates sigma:
-    for (int b = 1; b <= FittingHist->GetXaxis()->GetNbins(); ++b) {
-      FittingHist->SetBinContent(b, m_InitialSpectrum->GetBinContent(b) - BackgroundHist->GetBinContent(b));
-    }
-    TF1* GaussFit = new TF1("GaussPeakFitter", Gauss2, PeakEnergy - 4*PeakOneSigmaWidth, PeakEnergy + 4*PeakOneSigmaWidth, 4);
-    GaussFit->SetParameters(10, 1000, PeakEnergy, PeakOneSigmaWidth);
-    GaussFit->SetParLimits(3, 0.1*PeakOneSigmaWidth, 10*PeakOneSigmaWidth);
-    FittingHist->Fit(GaussFit, "RNQ");
-    //TCanvas* FC = new TCanvas();
-    //FC->cd();
-    //FittingHist->DrawCopy();
-    //FC->Update();
-    double FittedPeakOneSigmaWidth = GaussFit->GetParameter(3);
-    delete GaussFit;
-
-    // Elimiate all peak which have at least a factor of 2 divation between measuremenets and expectations
-    double Acceptance = 1.75;
-    if (FittedPeakOneSigmaWidth < PeakOneSigmaWidth/Acceptance || FittedPeakOneSigmaWidth > Acceptance*PeakOneSigmaWidth) {
-      //cout<<"Eliminating peak "<<PeakEnergy<<" due to sigma difference: "<<FittedPeakOneSigmaWidth<<" vs. "<<PeakOneSigmaWidth<<endl;
-      continue;
-    } else {
-      //cout<<"Passing peak "<<PeakEnergy<<" due to sigma difference: "<<FittedPeakOneSigmaWidth<<" vs. "<<PeakOneSigmaWidth<<endl;
-    }
+      // Fit to compare to estimates sigma:
+      for (int b = 1; b <= FittingHist->GetXaxis()->GetNbins(); ++b) {
+        FittingHist->SetBinContent(b, m_InitialSpectrum->GetBinContent(b) - BackgroundHist->GetBinContent(b));
+      }
+      TF1* GaussFit = new TF1("GaussPeakFitter", Gauss2, PeakEnergy - 4*PeakOneSigmaWidth, PeakEnergy + 4*PeakOneSigmaWidth, 4);
+      GaussFit->SetParameters(10, 1000, PeakEnergy, PeakOneSigmaWidth);
+      GaussFit->SetParLimits(3, 0.1*PeakOneSigmaWidth, 10*PeakOneSigmaWidth);
+      FittingHist->Fit(GaussFit, "RNQ");
+      //TCanvas* FC = new TCanvas();
+      //FC->cd();
+      //FittingHist->DrawCopy();
+      //FC->Update();
+      double FittedPeakOneSigmaWidth = GaussFit->GetParameter(3);
+      delete GaussFit;
+
+      // Elimiate all peak which have at least a factor of 2 divation between measuremenets and expectations
+      double Acceptance = 1.75;
+      if (FittedPeakOneSigmaWidth < PeakOneSigmaWidth/Acceptance || FittedPeakOneSigmaWidth > Acceptance*PeakOneSigmaWidth) {
+        //cout<<"Eliminating peak "<<PeakEnergy<<" due to sigma difference: "<<FittedPeakOneSigmaWidth<<" vs. "<<PeakOneSigmaWidth<<endl;
+        NewPeakRegions.push_back(Region);
+        if (m_IsBatch == true) delete BackgroundHist;
+        continue;
+      } else {
+        //cout<<"Passing peak "<<PeakEnergy<<" due to sigma difference: "<<FittedPeakOneSigmaWidth<<" vs. "<<PeakOneSigmaWidth<<endl;
+      }
 
-    if (m_IsBatch == false) {
-      PeakCanvas->cd(2);
-      BkgrdHist->GetXaxis()->SetRange(LowEnd, HighEnd);
-      BkgrdHist->Draw("SAME");  //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
-      //PeakHist->Draw("SAME") // does not zoom in for each estimate, but shows all estimates at end (messy)
-      //PeakHist->DrawCopy(); //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
-      //PeakHist->DrawCopy("SAME"); //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
-      //BackgroundHist->SetFillColor(10);
-      BackgroundHist->Draw("SAME");
-      PeakCanvas->Modified();
-      PeakCanvas->Update();
+      if (m_IsBatch == false) {
+        PeakCanvas->cd(2);
+        BkgrdHist->GetXaxis()->SetRange(LowEnd, HighEnd);
+        BkgrdHist->Draw("SAME");  //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
+        //PeakHist->Draw("SAME") // does not zoom in for each estimate, but shows all estimates at end (messy)
+        //PeakHist->DrawCopy(); //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
+        //PeakHist->DrawCopy("SAME"); //zooms in for each bkgrd estimate, but only shows last one at end (does not preserve info)
+        //BackgroundHist->SetFillColor(10);
+        BackgroundHist->Draw("SAME");
+        PeakCanvas->Modified();
+        PeakCanvas->Update();
     
-      PeakCanvas->cd(1);
-      BackgroundHist->SetFillColor(0);
-      m_InitialSpectrum->Draw();
-      BackgroundHist->DrawCopy("SAME");
-      PeakCanvas->Modified();
-      PeakCanvas->Update();   
-    }
+        PeakCanvas->cd(1);
+        BackgroundHist->SetFillColor(0);
+        m_InitialSpectrum->Draw();
+        BackgroundHist->DrawCopy("SAME");
+        PeakCanvas->Modified();
+        PeakCanvas->Update();   
+      }
 
-    // Determine all counts
-    int PeakShapeMin = PeakHist->GetXaxis()->FindBin(PeakEnergy - 1.4*PeakOneSigmaWidth);
-    int PeakShapeMax = PeakHist->GetXaxis()->FindBin(PeakEnergy + 1.4*PeakOneSigmaWidth);
+      IntegralBackgroundCounts = BackgroundHist->Integral(PeakShapeMin, PeakShapeMax);
+      if (m_IsBatch == true) delete BackgroundHist;
+
+      Region.m_WidthAccepted = true;
+      Region.m_BackgroundCounts = IntegralBackgroundCounts;
+      NewPeakRegions.push_back(Region);
+    }
 
     // Calculate all counts -- make sure we have at least one to prevent div by zero later on
-    double IntegralTotalCounts = m_InitialSpectrum->Integral(PeakShapeMin, PeakShapeMax);
-    double IntegralBackgroundCounts = BackgroundHist->Integral(PeakShapeMin, PeakShapeMax);
     if (IntegralBackgroundCounts < 1) IntegralBackgroundCounts = 1;
     double IntegralSignalCounts = IntegralTotalCounts - IntegralBackgroundCounts;
     if (IntegralSignalCounts < 1) IntegralSignalCounts = 1;
@@ -574,34 +664,56 @@ bool MSpectralAnalyzer::FindIsotopes()
     m_Peaks.push_back(P);
   }
   
+  // Only the regions of the current peak candidates are kept for the next analysis
+  if (m_IsIncremental == true) {
+    m_PeakRegions = NewPeakRegions;
+  }
+  
+  if (m_IsBatch == true) {
+    delete PeakFinder;
+    delete PeakHist;
+    delete BkgrdHist;
+    delete FittingHist;
+  }
+  
 
 
   // Step 2: isotope matching:
 
+  if (m_LineIndex.size() == 0) BuildLineIndex();
+
   double Interval = 0.0;
+  vector<pair<unsigned int, unsigned int>> Matches;
   for (unsigned int p = 0; p < m_Peaks.size(); ++p) {
-    // Compare with each line from each isotope in the list:
-    for (unsigned int i = 0; i < m_ComparisonIsotopes.size(); ++i) {
-      for (unsigned int l = 0; l < m_ComparisonIsotopes[i]->GetNLines(); ++l) {
-        // The interval size is defined by ... see below
-        Interval = m_EnergyRange*m_Peaks[p]->GetEnergySigma()/sqrt(m_Peaks[p]->GetSignificance());
-        // Add one histogram bin size to account for histogramming uncertainty:
-        Interval += m_InitialSpectrum->GetBinWidth(m_InitialSpectrum->FindBin(m_Peaks[p]->GetEnergy()));
-        if ((m_ComparisonIsotopes[i]->GetLineEnergy(l) > m_Peaks[p]->GetEnergy() - Interval) &&
-            (m_ComparisonIsotopes[i]->GetLineEnergy(l) < m_Peaks[p]->GetEnergy() + Interval)) {
-          m_Peaks[p]->AddIsotope(m_ComparisonIsotopes[i], l);
-          bool Found = false;
-          for (unsigned int s = 0; s < m_Isotopes.size(); ++s) {
-            if (m_ComparisonIsotopes[i]->GetElement() == m_Isotopes[s]->GetElement() && m_ComparisonIsotopes[i]->GetNucleons() == m_Isotopes[s]->GetNucleons()) {
-              Found = true;
-              break;
-            }
-          }
-          if (Found == false) {
-            m_Isotopes.push_back(m_ComparisonIsotopes[i]);
-          }
+    // The interval size is defined by ... see below
+    Interval = m_EnergyRange*m_Peaks[p]->GetEnergySigma()/sqrt(m_Peaks[p]->GetSignificance());
+    // Add one histogram bin size to account for histogramming uncertainty:
+    Interval += m_InitialSpectrum->GetBinWidth(m_InitialSpectrum->FindBin(m_Peaks[p]->GetEnergy()));
+    
+    // Find all lines within the interval in the energy-sorted line index:
+    double LowerEnergy = m_Peaks[p]->GetEnergy() - Interval;
+    double UpperEnergy = m_Peaks[p]->GetEnergy() + Interval;
+    Matches.clear();
+    auto Line = upper_bound(m_LineIndex.begin(), m_LineIndex.end(), LowerEnergy, [](double E, const MLineIndexEntry& L) { return E < L.m_Energy; });
+    for (; Line != m_LineIndex.end() && (*Line).m_Energy < UpperEnergy; ++Line) {
+      Matches.push_back(make_pair((*Line).m_Isotope, (*Line).m_Line));
+    }
+    // Keep the isotope & line order of the comparison list, since the later clean-up depends on it
+    sort(Matches.begin(), Matches.end());
+    
+    for (unsigned int m = 0; m < Matches.size(); ++m) {
+      unsigned int i = Matches[m].first;
+      m_Peaks[p]->AddIsotope(m_ComparisonIsotopes[i], Matches[m].second);
+      bool Found = false;
+      for (unsigned int s = 0; s < m_Isotopes.size(); ++s) {
+        if (m_ComparisonIsotopes[i]->GetElement() == m_Isotopes[s]->GetElement() && m_ComparisonIsotopes[i]->GetNucleons() == m_Isotopes[s]->GetNucleons()) {
+          Found = true;
+          break;
         }
       }
+      if (Found == false) {
+        m_Isotopes.push_back(m_ComparisonIsotopes[i]);
+      }
     }
   }
 